@@ -0,0 +1,195 @@
+/*
+ * Copyright 2019 Xilinx, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * usage: ./gemm_async_example.exe PATH_TO_XCLBIN/gemx.xclbin PATH_TO_XCLBIN/config_info.dat
+ *
+ */
+
+#include <iomanip>
+#include <cmath>
+#include "xf_blas.hpp"
+
+#define IDX2R(i, j, ld) (((i) * (ld)) + (j))
+#define m 128 // a - mxk matrix
+#define n 128 // b - kxn matrix
+#define k 128 // c - mxn matrix
+
+using namespace std;
+
+XFBLAS_dataType* getGoldenMat(XFBLAS_dataType* a, XFBLAS_dataType* b, XFBLAS_dataType* c) {
+    XFBLAS_dataType* goldenC;
+    goldenC = (XFBLAS_dataType*)malloc(m * n * sizeof(XFBLAS_dataType));
+    for (int row = 0; row < m; row++) {
+        for (int col = 0; col < n; col++) {
+            XFBLAS_dataType l_val = 0;
+            for (int i = 0; i < k; i++) {
+                l_val += a[IDX2R(row, i, k)] * b[IDX2R(i, col, n)];
+            }
+            goldenC[IDX2R(row, col, n)] = l_val + c[IDX2R(row, col, n)];
+        }
+    }
+    return goldenC;
+}
+
+bool compareGemm(XFBLAS_dataType* c, XFBLAS_dataType* goldenC, float p_TolRel = 1e-3, float p_TolAbs = 1e-5) {
+    bool l_check = true;
+    for (int row = 0; row < m; row++) {
+        for (int col = 0; col < n; col++) {
+            XFBLAS_dataType l_ref = goldenC[IDX2R(row, col, n)];
+            XFBLAS_dataType l_result = c[IDX2R(row, col, n)];
+            float l_diffAbs = abs(l_ref - l_result);
+            float l_diffRel = l_diffAbs;
+            if (goldenC[IDX2R(row, col, n)] != 0) {
+                l_diffRel /= abs(l_ref);
+            }
+            bool check = (l_diffRel <= p_TolRel) || (l_diffAbs <= p_TolAbs);
+            if (!check) {
+                cout << "golden result " << setprecision(10) << goldenC[IDX2R(row, col, n)]
+                     << " is not equal to fpga result " << setprecision(10) << c[IDX2R(row, col, n)] << "\n";
+                l_check = false;
+            }
+        }
+    }
+    return l_check;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        cerr << " usage: \n"
+             << " gemm_async_example.exe gemx.xclbin config_info.dat\n";
+        return EXIT_FAILURE;
+    }
+    unsigned int l_argIdx = 1;
+    string l_xclbinFile(argv[l_argIdx++]);
+    string l_configFile(argv[l_argIdx++]);
+    string l_logFile;
+    ofstream logFile("xrt_report.txt");
+    logFile.close();
+    l_logFile = "xrt_report.txt";
+
+    xfblasEngine_t engineName = XFBLAS_ENGINE_GEMM;
+    xfblasStatus_t status = xfblasCreate(l_xclbinFile.c_str(), l_configFile, l_logFile.c_str(), engineName);
+    if (status != XFBLAS_STATUS_SUCCESS) {
+        cout << "Create Handle failed with error code: " << status << "\n";
+        return EXIT_FAILURE;
+    }
+
+    // two independent multiplications, the second one is prepared while the first one runs
+    XFBLAS_dataType *a[2], *b[2], *c[2], *goldenC[2];
+    for (int l = 0; l < 2; l++) {
+        posix_memalign((void**)&a[l], 4096, m * k * sizeof(XFBLAS_dataType));
+        posix_memalign((void**)&b[l], 4096, k * n * sizeof(XFBLAS_dataType));
+        posix_memalign((void**)&c[l], 4096, m * n * sizeof(XFBLAS_dataType));
+        for (int i = 0; i < m * k; i++) {
+            a[l][i] = (XFBLAS_dataType)((i + l) % 7);
+        }
+        for (int i = 0; i < k * n; i++) {
+            b[l][i] = (XFBLAS_dataType)((i * (l + 1)) % 5);
+        }
+        for (int i = 0; i < m * n; i++) {
+            c[l][i] = (XFBLAS_dataType)l;
+        }
+        goldenC[l] = getGoldenMat(a[l], b[l], c[l]);
+
+        status = xfblasMallocRestricted(m, k, sizeof(*a[l]), a[l], k);
+        if (status == XFBLAS_STATUS_SUCCESS) {
+            status = xfblasMallocRestricted(k, n, sizeof(*b[l]), b[l], n);
+        }
+        if (status == XFBLAS_STATUS_SUCCESS) {
+            status = xfblasMallocRestricted(m, n, sizeof(*c[l]), c[l], n);
+        }
+        if (status != XFBLAS_STATUS_SUCCESS) {
+            cout << "Malloc memory for the matrices failed with error code: " << status << "\n";
+            xfblasDestroy();
+            return EXIT_FAILURE;
+        }
+    }
+
+    status = xfblasSetMatrixRestricted(a[0]);
+    status = xfblasSetMatrixRestricted(b[0]);
+    status = xfblasSetMatrixRestricted(c[0]);
+    if (status != XFBLAS_STATUS_SUCCESS) {
+        cout << "Set Matrix failed with error code: " << status << "\n";
+        xfblasDestroy();
+        return EXIT_FAILURE;
+    }
+
+    status = xfblasGemm(XFBLAS_OP_N, XFBLAS_OP_N, m, n, k, 1, a[0], k, b[0], n, 1, c[0], n);
+    if (status != XFBLAS_STATUS_SUCCESS) {
+        cout << "Matrix Multiplication failed with error code: " << status << "\n";
+        xfblasDestroy();
+        return EXIT_FAILURE;
+    }
+    future<bool> l_run0 = xfblasExecuteAsync();
+    // the instructions of the first run are already on the device
+    xfblasFreeInstr();
+
+    status = xfblasSetMatrixRestricted(a[1]);
+    status = xfblasSetMatrixRestricted(b[1]);
+    status = xfblasSetMatrixRestricted(c[1]);
+    if (status != XFBLAS_STATUS_SUCCESS) {
+        cout << "Set Matrix failed with error code: " << status << "\n";
+        xfblasDestroy();
+        return EXIT_FAILURE;
+    }
+
+    status = xfblasGemm(XFBLAS_OP_N, XFBLAS_OP_N, m, n, k, 1, a[1], k, b[1], n, 1, c[1], n);
+    if (status != XFBLAS_STATUS_SUCCESS) {
+        cout << "Matrix Multiplication failed with error code: " << status << "\n";
+        xfblasDestroy();
+        return EXIT_FAILURE;
+    }
+    // waits for the first run before it is launched
+    future<bool> l_run1 = xfblasExecuteAsync();
+
+    if (!l_run0.get() || !l_run1.get()) {
+        cout << "Kernel run failed\n";
+        xfblasDestroy();
+        return EXIT_FAILURE;
+    }
+
+    bool l_pass = true;
+    for (int l = 0; l < 2; l++) {
+        status = xfblasGetMatrixRestricted(c[l]);
+        if (status != XFBLAS_STATUS_SUCCESS) {
+            cout << "Get Matirx failed with error code: " << status << "\n";
+            xfblasDestroy();
+            return EXIT_FAILURE;
+        }
+        l_pass = compareGemm(c[l], goldenC[l]) && l_pass;
+    }
+
+    if (l_pass) {
+        cout << "Test passed!\n";
+    } else {
+        cout << "Test failed!\n";
+    }
+
+    for (int l = 0; l < 2; l++) {
+        xfblasFree(a[l]);
+        xfblasFree(b[l]);
+        xfblasFree(c[l]);
+        free(a[l]);
+        free(b[l]);
+        free(c[l]);
+        free(goldenC[l]);
+    }
+
+    xfblasDestroy();
+
+    return EXIT_SUCCESS;
+}
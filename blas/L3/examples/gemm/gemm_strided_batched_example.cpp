@@ -0,0 +1,162 @@
+/*
+ * Copyright 2019 Xilinx, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * usage: ./gemm_strided_batched_example.exe PATH_TO_XCLBIN/gemx.xclbin PATH_TO_XCLBIN/config_info.dat
+ *
+ */
+
+#include <iomanip>
+#include <cmath>
+#include "xf_blas.hpp"
+
+#define IDX2R(i, j, ld) (((i) * (ld)) + (j))
+#define m 128 // a - mxk matrix
+#define n 128 // b - kxn matrix
+#define k 128 // c - mxn matrix
+#define batchCount 8
+
+using namespace std;
+
+bool compareGemm(XFBLAS_dataType* a,
+                 XFBLAS_dataType* b,
+                 XFBLAS_dataType* c,
+                 XFBLAS_dataType* c0,
+                 float p_TolRel = 1e-3,
+                 float p_TolAbs = 1e-5) {
+    bool l_check = true;
+    for (int row = 0; row < m; row++) {
+        for (int col = 0; col < n; col++) {
+            XFBLAS_dataType l_ref = 0;
+            for (int i = 0; i < k; i++) {
+                l_ref += a[IDX2R(row, i, k)] * b[IDX2R(i, col, n)];
+            }
+            l_ref += c0[IDX2R(row, col, n)];
+            XFBLAS_dataType l_result = c[IDX2R(row, col, n)];
+            float l_diffAbs = abs(l_ref - l_result);
+            float l_diffRel = l_diffAbs;
+            if (l_ref != 0) {
+                l_diffRel /= abs(l_ref);
+            }
+            bool check = (l_diffRel <= p_TolRel) || (l_diffAbs <= p_TolAbs);
+            if (!check) {
+                cout << "golden result " << setprecision(10) << l_ref << " is not equal to fpga result "
+                     << setprecision(10) << l_result << "\n";
+                l_check = false;
+            }
+        }
+    }
+    return l_check;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        cerr << " usage: \n"
+             << " gemm_strided_batched_example.exe gemx.xclbin config_info.dat\n";
+        return EXIT_FAILURE;
+    }
+    unsigned int l_argIdx = 1;
+    string l_xclbinFile(argv[l_argIdx++]);
+    string l_configFile(argv[l_argIdx++]);
+    string l_logFile;
+    ofstream logFile("xrt_report.txt");
+    logFile.close();
+    l_logFile = "xrt_report.txt";
+
+    xfblasEngine_t engineName = XFBLAS_ENGINE_GEMM;
+    xfblasStatus_t status = xfblasCreate(l_xclbinFile.c_str(), l_configFile, l_logFile.c_str(), engineName);
+    if (status != XFBLAS_STATUS_SUCCESS) {
+        cout << "Create Handle failed with error code: " << status << "\n";
+        return EXIT_FAILURE;
+    }
+
+    // all the matrices of an operand are in one buffer, one after another
+    const long long strideA = m * k, strideB = k * n, strideC = m * n;
+    XFBLAS_dataType *a, *b, *c, *c0;
+
+    posix_memalign((void**)&a, 4096, batchCount * strideA * sizeof(XFBLAS_dataType));
+    posix_memalign((void**)&b, 4096, batchCount * strideB * sizeof(XFBLAS_dataType));
+    posix_memalign((void**)&c, 4096, batchCount * strideC * sizeof(XFBLAS_dataType));
+    c0 = (XFBLAS_dataType*)malloc(batchCount * strideC * sizeof(XFBLAS_dataType));
+
+    for (long long i = 0; i < batchCount * strideA; i++) a[i] = (XFBLAS_dataType)(i % 7);
+    for (long long i = 0; i < batchCount * strideB; i++) b[i] = (XFBLAS_dataType)(i % 5);
+    for (long long i = 0; i < batchCount * strideC; i++) c0[i] = c[i] = (XFBLAS_dataType)(i % 3);
+
+    status = xfblasMallocRestricted(batchCount * m, k, sizeof(*a), a, k);
+    if (status != XFBLAS_STATUS_SUCCESS) {
+        cout << "Malloc memory for matrix A failed with error code: " << status << "\n";
+        return EXIT_FAILURE;
+    }
+    status = xfblasMallocRestricted(batchCount * k, n, sizeof(*b), b, n);
+    if (status != XFBLAS_STATUS_SUCCESS) {
+        cout << "Malloc memory for matrix B failed with error code: " << status << "\n";
+        xfblasDestroy();
+        return EXIT_FAILURE;
+    }
+    status = xfblasMallocRestricted(batchCount * m, n, sizeof(*c), c, n);
+    if (status != XFBLAS_STATUS_SUCCESS) {
+        cout << "Malloc memory for matrix C failed with error code: " << status << "\n";
+        xfblasDestroy();
+        return EXIT_FAILURE;
+    }
+
+    status = xfblasSetMatrixRestricted(a);
+    status = xfblasSetMatrixRestricted(b);
+    status = xfblasSetMatrixRestricted(c);
+    if (status != XFBLAS_STATUS_SUCCESS) {
+        cout << "Set Matrix failed with error code: " << status << "\n";
+        xfblasDestroy();
+        return EXIT_FAILURE;
+    }
+
+    status = xfblasGemmStridedBatched(XFBLAS_OP_N, XFBLAS_OP_N, m, n, k, 1, a, k, strideA, b, n, strideB, 1, c, n,
+                                      strideC, batchCount);
+    if (status != XFBLAS_STATUS_SUCCESS) {
+        cout << "Batched Matrix Multiplication failed with error code: " << status << "\n";
+        xfblasDestroy();
+        return EXIT_FAILURE;
+    }
+
+    status = xfblasGetMatrixRestricted(c);
+    if (status != XFBLAS_STATUS_SUCCESS) {
+        cout << "Get Matirx failed with error code: " << status << "\n";
+        xfblasDestroy();
+        return EXIT_FAILURE;
+    }
+
+    bool l_pass = true;
+    for (int i = 0; i < batchCount; i++) {
+        l_pass = compareGemm(a + i * strideA, b + i * strideB, c + i * strideC, c0 + i * strideC) && l_pass;
+    }
+    if (l_pass) {
+        cout << "Test passed!\n";
+    } else {
+        cout << "Test failed!\n";
+    }
+
+    xfblasFree(a);
+    xfblasFree(b);
+    xfblasFree(c);
+    free(a);
+    free(b);
+    free(c);
+    free(c0);
+
+    xfblasDestroy();
+
+    return EXIT_SUCCESS;
+}
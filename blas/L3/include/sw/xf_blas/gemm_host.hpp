@@ -43,9 +43,11 @@ class GemmArgs : public BLASArgs {
              int p_postShift)
         : m_GemmArgs({int(OpGemm), p_aOffset, p_bOffset, p_cOffset, p_xOffset, p_m, p_k, p_n, p_lda, p_ldb, p_ldc,
                       p_ldx, 0, 0, 0, 0}) {
-        m_GemmArgs.m_postScaleVal = (p_postScale << 8) | (p_postShift & 0x000000ff);
+        // shifted as unsigned, a negative postScale keeps its two's complement bits
+        m_GemmArgs.m_postScaleVal = int(((unsigned int)p_postScale << 8) | (p_postShift & 0x000000ff));
     }
     size_t sizeInBytes() { return sizeof(m_GemmArgs); }
+    static size_t instrSizeInBytes() { return sizeof(m_GemmArgs); }
     char* asByteArray() { return reinterpret_cast<char*>(&m_GemmArgs); }
 
    protected:
@@ -88,35 +90,13 @@ class GEMMHost : public BLASHost {
             this->m_bufHandle.find(p_bias) == this->m_bufHandle.end()) {
             return XFBLAS_STATUS_ALLOC_FAILED;
         }
-        unsigned int handle_A, handle_B, handle_C, handle_bias;
-        auto& l_devPtr = this->m_bufHandle;
-
-        handle_A = l_devPtr[p_a];
-        handle_B = l_devPtr[p_b];
-        handle_C = l_devPtr[p_c];
-        handle_bias = l_devPtr[p_bias];
-
-        xclBOProperties p;
-        uint64_t address_A = !xclGetBOProperties(this->m_fpga->m_handle, handle_A, &p) ? p.paddr : -1;
-        uint64_t address_B = !xclGetBOProperties(this->m_fpga->m_handle, handle_B, &p) ? p.paddr : -1;
-        uint64_t address_C = !xclGetBOProperties(this->m_fpga->m_handle, handle_C, &p) ? p.paddr : -1;
-        uint64_t address_bias = !xclGetBOProperties(this->m_fpga->m_handle, handle_bias, &p) ? p.paddr : -1;
-
-        unsigned long long l_aOff, l_bOff, l_cOff, l_xOff;
-        l_aOff = (unsigned long long)address_A;
-        l_bOff = (unsigned long long)address_B;
-        l_cOff = (unsigned long long)address_C;
-        l_xOff = (unsigned long long)address_bias;
-
-        l_aOff -= this->m_fpga->m_baseAddress[this->m_cuIndex];
-        l_bOff -= this->m_fpga->m_baseAddress[this->m_cuIndex];
-        l_cOff -= this->m_fpga->m_baseAddress[this->m_cuIndex];
-        l_xOff -= this->m_fpga->m_baseAddress[this->m_cuIndex];
-
-        l_aOff /= this->PAGE_SIZE;
-        l_bOff /= this->PAGE_SIZE;
-        l_cOff /= this->PAGE_SIZE;
-        l_xOff /= this->PAGE_SIZE;
+        if (!this->hasInstrSpace(1, GemmArgs::instrSizeInBytes())) {
+            return XFBLAS_STATUS_ALLOC_FAILED;
+        }
+        unsigned long long l_aOff = getPageOffset(p_a);
+        unsigned long long l_bOff = getPageOffset(p_b);
+        unsigned long long l_cOff = getPageOffset(p_c);
+        unsigned long long l_xOff = getPageOffset(p_bias);
 
         GemmArgs l_gargs(l_aOff, l_bOff, l_cOff, l_xOff, p_m, p_k, p_n, p_lda, p_ldb, p_ldc, p_ldx, p_postScale,
                          p_postShift);
@@ -125,8 +105,142 @@ class GEMMHost : public BLASHost {
 
         return XFBLAS_STATUS_SUCCESS;
     }
+
+    virtual xfblasStatus_t addGEMMBatchOp(void** p_a,
+                                          void** p_b,
+                                          void** p_c,
+                                          unsigned int p_m,
+                                          unsigned int p_n,
+                                          unsigned int p_k,
+                                          unsigned int p_lda,
+                                          unsigned int p_ldb,
+                                          unsigned int p_ldc,
+                                          unsigned int p_batchCount,
+                                          int p_postScale,
+                                          int p_postShift) {
+        for (unsigned int i = 0; i < p_batchCount; i++) {
+            if (this->m_bufHandle.find(p_a[i]) == this->m_bufHandle.end() ||
+                this->m_bufHandle.find(p_b[i]) == this->m_bufHandle.end() ||
+                this->m_bufHandle.find(p_c[i]) == this->m_bufHandle.end()) {
+                return XFBLAS_STATUS_ALLOC_FAILED;
+            }
+        }
+        for (unsigned int i = 0; i < p_batchCount; i++) {
+            unsigned long long l_cOff = getPageOffset(p_c[i]);
+            GemmArgs l_gargs(getPageOffset(p_a[i]), getPageOffset(p_b[i]), l_cOff, l_cOff, p_m, p_k, p_n, p_lda,
+                             p_ldb, p_ldc, p_ldc, p_postScale, p_postShift);
+            xfblasStatus_t l_status = addBatchInstr(&l_gargs);
+            if (l_status != XFBLAS_STATUS_SUCCESS) {
+                return l_status;
+            }
+        }
+
+        return XFBLAS_STATUS_SUCCESS;
+    }
+
+    virtual xfblasStatus_t addGEMMStridedBatchOp(void* p_a,
+                                                 void* p_b,
+                                                 void* p_c,
+                                                 unsigned int p_m,
+                                                 unsigned int p_n,
+                                                 unsigned int p_k,
+                                                 unsigned int p_lda,
+                                                 unsigned int p_ldb,
+                                                 unsigned int p_ldc,
+                                                 unsigned long long p_strideA,
+                                                 unsigned long long p_strideB,
+                                                 unsigned long long p_strideC,
+                                                 unsigned int p_batchCount,
+                                                 unsigned int p_elemSize,
+                                                 int p_postScale,
+                                                 int p_postShift) {
+        if (this->m_bufHandle.find(p_a) == this->m_bufHandle.end() ||
+            this->m_bufHandle.find(p_b) == this->m_bufHandle.end() ||
+            this->m_bufHandle.find(p_c) == this->m_bufHandle.end()) {
+            return XFBLAS_STATUS_ALLOC_FAILED;
+        }
+        // instructions address matrices in pages, so each stride must be a whole number of pages
+        unsigned long long l_strideA = p_strideA * p_elemSize;
+        unsigned long long l_strideB = p_strideB * p_elemSize;
+        unsigned long long l_strideC = p_strideC * p_elemSize;
+        if (l_strideA % this->PAGE_SIZE != 0 || l_strideB % this->PAGE_SIZE != 0 ||
+            l_strideC % this->PAGE_SIZE != 0) {
+            return XFBLAS_STATUS_INVALID_VALUE;
+        }
+        unsigned long long l_last = p_batchCount - 1;
+        if (l_last * l_strideA + (unsigned long long)p_m * p_lda * p_elemSize > this->m_hostMatSz[p_a] ||
+            l_last * l_strideB + (unsigned long long)p_k * p_ldb * p_elemSize > this->m_hostMatSz[p_b] ||
+            l_last * l_strideC + (unsigned long long)p_m * p_ldc * p_elemSize > this->m_hostMatSz[p_c]) {
+            return XFBLAS_STATUS_INVALID_VALUE;
+        }
+        unsigned long long l_aOff = getPageOffset(p_a);
+        unsigned long long l_bOff = getPageOffset(p_b);
+        unsigned long long l_cOff = getPageOffset(p_c);
+        for (unsigned int i = 0; i < p_batchCount; i++) {
+            GemmArgs l_gargs(l_aOff, l_bOff, l_cOff, l_cOff, p_m, p_k, p_n, p_lda, p_ldb, p_ldc, p_ldc, p_postScale,
+                             p_postShift);
+            xfblasStatus_t l_status = addBatchInstr(&l_gargs);
+            if (l_status != XFBLAS_STATUS_SUCCESS) {
+                return l_status;
+            }
+            l_aOff += l_strideA / this->PAGE_SIZE;
+            l_bOff += l_strideB / this->PAGE_SIZE;
+            l_cOff += l_strideC / this->PAGE_SIZE;
+        }
+
+        return XFBLAS_STATUS_SUCCESS;
+    }
+
+   protected:
+    // queues one GEMM of a batch, a full instruction buffer is run and cleared first
+    xfblasStatus_t addBatchInstr(GemmArgs* p_args) {
+        if (!this->hasInstrSpace(1, GemmArgs::instrSizeInBytes())) {
+            xfblasStatus_t l_status = this->execute();
+            if (l_status != XFBLAS_STATUS_SUCCESS) {
+                return l_status;
+            }
+            this->clearInstrBuf();
+            if (!this->hasInstrSpace(1, GemmArgs::instrSizeInBytes())) {
+                return XFBLAS_STATUS_ALLOC_FAILED;
+            }
+        }
+        this->addInstr(p_args);
+        this->enableRun();
+        return XFBLAS_STATUS_SUCCESS;
+    }
+
+    // offset of a device buffer from the memory base address of the CU, in pages
+    unsigned long long getPageOffset(void* p_ptr) {
+        xclBOProperties p;
+        uint64_t l_address = !xclGetBOProperties(this->m_fpga->m_handle, this->m_bufHandle[p_ptr], &p) ? p.paddr : -1;
+        return (l_address - this->m_fpga->m_baseAddress[this->m_cuIndex]) / this->PAGE_SIZE;
+    }
 };
 
+/**
+ * @brief Maps alpha and beta of a GEMM call onto the output scaling of the engine. Integer engines scale
+ * (A*B + C) by postScale, which covers alpha == beta.
+ */
+xfblasStatus_t getGemmPostScale(
+    xfblasOperation_t p_transa, xfblasOperation_t p_transb, int p_alpha, int p_beta, int& p_postScale) {
+    p_postScale = 1;
+    if (p_transa != XFBLAS_OP_N || p_transb != XFBLAS_OP_N) {
+        return XFBLAS_STATUS_NOT_SUPPORTED;
+    }
+    if (p_alpha == 1 && p_beta == 1) {
+        return XFBLAS_STATUS_SUCCESS;
+    }
+    if (p_alpha == p_beta && ConfigDict::instance().m_dict["GEMX_dataType"] != "float") {
+        // postScale is a signed 24-bit field
+        if (p_alpha < -(1 << 23) || p_alpha >= (1 << 23)) {
+            return XFBLAS_STATUS_INVALID_VALUE;
+        }
+        p_postScale = p_alpha;
+        return XFBLAS_STATUS_SUCCESS;
+    }
+    return XFBLAS_STATUS_NOT_SUPPORTED;
+}
+
 } // namespace blas
 
 } // namespace xf
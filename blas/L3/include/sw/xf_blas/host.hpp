@@ -23,6 +23,11 @@
 #include <string>
 #include <unordered_map>
 #include <iostream>
+#include <list>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <future>
 
 #include "ert.h"
 #include "xclhal2.h"
@@ -46,7 +51,6 @@ class XFpga {
     uuid_t m_xclbinId;
     vector<int> m_mem;
     vector<unsigned long long> m_baseAddress;
-    vector<unsigned int> m_execHandles;
     bool m_init = false;
 
     XFpga() = delete;
@@ -91,7 +95,7 @@ class XFpga {
         delete[] l_header;
     }
 
-    ~XFpga() {}
+    ~XFpga() { stopPolling(); }
 
     bool openContext(unsigned int p_cuIndex) {
         if (xclOpenContext(m_handle, m_xclbinId, p_cuIndex, true)) {
@@ -118,10 +122,15 @@ class XFpga {
         return true;
     }
 
-    bool execKernel(unsigned int p_kernelIndex) {
-        unsigned int m_execHandle = xclAllocBO(m_handle, 4096 + 4096, xclBOKind(0), (1 << 31));
-        void* execData = xclMapBO(m_handle, m_execHandle, true);
-        auto ecmd = reinterpret_cast<ert_start_kernel_cmd*>(execData);
+    future<bool> execKernelAsync(unsigned int p_kernelIndex) {
+        promise<bool> l_done;
+        future<bool> l_future = l_done.get_future();
+        int l_buf = acquireExecBuf();
+        if (l_buf < 0) {
+            l_done.set_value(false);
+            return l_future;
+        }
+        auto ecmd = m_execPool[l_buf].second;
         auto rsz = XGEMXKERNEL_0_GEMXKERNEL_0_CONTROL_ADDR_P_DDRWR_M_VAL_DATA / 4 + 2; // regmap array size
         memset(ecmd, 0, (sizeof *ecmd) + rsz);
         ecmd->state = ERT_CMD_STATE_NEW;
@@ -136,16 +145,117 @@ class XFpga {
         ecmd->data[XGEMXKERNEL_0_GEMXKERNEL_0_CONTROL_ADDR_P_DDRWR_M_VAL_DATA / 4 + 1] =
             m_baseAddress[p_kernelIndex] >> 32;
 
-        if (xclExecBuf(m_handle, m_execHandle)) {
-            return false;
+        unique_lock<mutex> l_lock(m_execMutex);
+        if (xclExecBuf(m_handle, m_execPool[l_buf].first)) {
+            m_freeExecBufs.push_back(l_buf);
+            m_execCond.notify_all();
+            l_done.set_value(false);
+            return l_future;
+        }
+        m_pendingExecs.emplace_back(l_buf, move(l_done));
+        if (!m_pollThread.joinable()) {
+            m_pollThread = thread(&XFpga::pollExecs, this);
         }
+        m_execCond.notify_all();
+        return l_future;
+    }
 
-        while (xclExecWait(m_handle, 1) == 0)
-            ;
+    bool execKernel(unsigned int p_kernelIndex) { return execKernelAsync(p_kernelIndex).get(); }
 
-        m_execHandles.push_back(m_execHandle);
+    // blocks until no command launched on the CU is pending
+    void waitIdle(unsigned int p_kernelIndex) {
+        unique_lock<mutex> l_lock(m_execMutex);
+        m_execCond.wait(l_lock, [this, p_kernelIndex] {
+            for (auto& l_exec : m_pendingExecs) {
+                if (m_execPool[l_exec.first].second->cu_mask & (0x1 << p_kernelIndex)) {
+                    return false;
+                }
+            }
+            return true;
+        });
+    }
 
-        return true;
+    void stopPolling() {
+        {
+            lock_guard<mutex> l_lock(m_execMutex);
+            m_stopPoll = true;
+            m_execCond.notify_all();
+        }
+        if (m_pollThread.joinable()) {
+            m_pollThread.join();
+        }
+    }
+
+    void closeExecPool() {
+        stopPolling();
+        for (auto& l_buf : m_execPool) {
+            xclFreeBO(m_handle, l_buf.first);
+        }
+        m_execPool.clear();
+        m_freeExecBufs.clear();
+    }
+
+   private:
+    static const unsigned int EXEC_BUF_SIZE = 4096 + 4096;
+    static const unsigned int EXEC_POOL_SIZE = 16;
+    static const int EXEC_WAIT_MS = 100;
+
+    // exec buffers are mapped once and reused, at most EXEC_POOL_SIZE commands are in flight
+    vector<pair<unsigned int, ert_start_kernel_cmd*> > m_execPool;
+    vector<int> m_freeExecBufs;
+    list<pair<int, promise<bool> > > m_pendingExecs;
+    mutex m_execMutex;
+    condition_variable m_execCond;
+    thread m_pollThread;
+    bool m_stopPoll = false;
+
+    int acquireExecBuf() {
+        unique_lock<mutex> l_lock(m_execMutex);
+        while (m_freeExecBufs.empty()) {
+            if (m_stopPoll) {
+                return -1;
+            }
+            if (m_execPool.size() < EXEC_POOL_SIZE) {
+                unsigned int l_execHandle = xclAllocBO(m_handle, EXEC_BUF_SIZE, xclBOKind(0), (1 << 31));
+                void* l_execData = xclMapBO(m_handle, l_execHandle, true);
+                if (l_execData == nullptr) {
+                    xclFreeBO(m_handle, l_execHandle);
+                    return -1;
+                }
+                m_execPool.emplace_back(l_execHandle, reinterpret_cast<ert_start_kernel_cmd*>(l_execData));
+                return m_execPool.size() - 1;
+            }
+            m_execCond.wait(l_lock);
+        }
+        int l_buf = m_freeExecBufs.back();
+        m_freeExecBufs.pop_back();
+        return l_buf;
+    }
+
+    // completes the futures of finished commands, sleeps in xclExecWait while any is running
+    void pollExecs() {
+        unique_lock<mutex> l_lock(m_execMutex);
+        while (true) {
+            m_execCond.wait(l_lock, [this] { return m_stopPoll || !m_pendingExecs.empty(); });
+            if (m_pendingExecs.empty()) {
+                break;
+            }
+            l_lock.unlock();
+            xclExecWait(m_handle, EXEC_WAIT_MS);
+            l_lock.lock();
+            for (auto it = m_pendingExecs.begin(); it != m_pendingExecs.end();) {
+                auto l_state = m_execPool[it->first].second->state;
+                if (l_state == ERT_CMD_STATE_COMPLETED || l_state == ERT_CMD_STATE_ERROR ||
+                    l_state == ERT_CMD_STATE_ABORT) {
+                    it->second.set_value(l_state == ERT_CMD_STATE_COMPLETED);
+                    m_freeExecBufs.push_back(it->first);
+                    it = m_pendingExecs.erase(it);
+                    m_execCond.notify_all();
+                } else {
+                    ++it;
+                }
+            }
+        }
     }
 };
 
@@ -177,6 +287,7 @@ class XHost {
     unsigned int m_instrOffset;
     unsigned int m_instrBufHandle;
     unsigned int m_cuIndex;
+    unsigned int m_numInstr = 0;
 
    public:
     XHost() = delete;
@@ -297,6 +408,17 @@ class XHost {
         m_instrOffset += p_args->sizeInBytes();
     }
 
+    void setNumInstr(unsigned int p_numInstr) { m_numInstr = p_numInstr; }
+
+    bool hasInstrSpace(unsigned int p_numInstr, size_t p_instrSize) {
+        // the last slot stays zeroed to end the program, and the kernel runs at most m_numInstr slots
+        unsigned int l_slots = m_instrOffset / p_instrSize + p_numInstr + 1;
+        if (m_numInstr != 0 && l_slots > m_numInstr) {
+            return false;
+        }
+        return l_slots * p_instrSize <= INSTR_BUF_SIZE;
+    }
+
     template <typename t_dataType>
     xfblasStatus_t getMat(
         void* p_hostHandle, int p_rows, int p_lda, int p_paddedLda, t_dataType& p_hostPtr, t_dataType& p_devPtr) {
@@ -375,13 +497,13 @@ class XHost {
     xfblasStatus_t closeContext(unsigned int p_kernelIndex) {
         free(m_progBuf);
         xclFreeBO(m_fpga->m_handle, m_instrBufHandle);
-        if (p_kernelIndex < (unsigned int)m_fpga->m_execHandles.size()) {
-            xclFreeBO(m_fpga->m_handle, m_fpga->m_execHandles[p_kernelIndex]);
-        }
         xclCloseContext(m_fpga->m_handle, m_fpga->m_xclbinId, this->m_cuIndex);
         return XFBLAS_STATUS_SUCCESS;
     }
-    void closeDevice() { xclClose(m_fpga->m_handle); }
+    void closeDevice() {
+        m_fpga->closeExecPool();
+        xclClose(m_fpga->m_handle);
+    }
 };
 
 class BLASHost : public XHost {
@@ -400,20 +522,26 @@ class BLASHost : public XHost {
              unsigned int p_deviceIndex)
         : XHost(p_xclbin, p_logFile, p_status, p_kernelIndex, p_deviceIndex) {}
 
-    xfblasStatus_t execute() {
-        xfblasStatus_t l_status = XFBLAS_STATUS_SUCCESS;
-        if (m_execControl) {
-            if (!this->m_fpga->copyToFpga(this->m_instrBufHandle, this->INSTR_BUF_SIZE + this->KERN_DBG_BUF_SIZE)) {
-                l_status = XFBLAS_STATUS_ALLOC_FAILED;
-            }
-            if (!this->m_fpga->execKernel(this->m_cuIndex)) {
-                l_status = XFBLAS_STATUS_ALLOC_FAILED;
-            }
-            m_execControl = false;
+    future<bool> executeAsync() {
+        if (!m_execControl) {
+            promise<bool> l_done;
+            l_done.set_value(true);
+            return l_done.get_future();
         }
-        return l_status;
+        // the CU reads its instructions from the device copy of the buffer until the launch completes,
+        // so the next batch is synced once the previous one is done
+        this->m_fpga->waitIdle(this->m_cuIndex);
+        m_execControl = false;
+        if (!this->m_fpga->copyToFpga(this->m_instrBufHandle, this->INSTR_BUF_SIZE + this->KERN_DBG_BUF_SIZE)) {
+            promise<bool> l_done;
+            l_done.set_value(false);
+            return l_done.get_future();
+        }
+        return this->m_fpga->execKernelAsync(this->m_cuIndex);
     }
 
+    xfblasStatus_t execute() { return executeAsync().get() ? XFBLAS_STATUS_SUCCESS : XFBLAS_STATUS_ALLOC_FAILED; }
+
     void enableRun() { m_execControl = true; }
 };
 
@@ -69,6 +69,10 @@ xfblasStatus_t xfblasCreate(const char* xclbin,
         for (unsigned int i = 0; i < kernelNumber; i++) {
             BLASHostHandle::instance().m_handlePtr[deviceIndex].push_back(
                 shared_ptr<BLASHost>(new GEMMHost(xclbin, logFile, &l_status, i, deviceIndex)));
+            if (ConfigDict::instance().m_dict.find("GEMX_numInstr") != ConfigDict::instance().m_dict.end()) {
+                BLASHostHandle::instance().m_handlePtr[deviceIndex].back()->setNumInstr(
+                    stoi(ConfigDict::instance().m_dict["GEMX_numInstr"]));
+            }
         }
         return l_status;
     } else if (engineName == XFBLAS_ENGINE_GEMV) {
@@ -829,7 +833,8 @@ xfblasStatus_t xfblasDestroy(unsigned int kernelNumber = 1, unsigned int deviceI
 }
 
 /**
- * @brief This function performs the matrix-matrix multiplication C = alpha*op(A)op(B) + beta*C
+ * @brief This function performs the matrix-matrix multiplication C = alpha*op(A)op(B) + beta*C. Integer engines
+ * support alpha == beta by scaling their output
  * @param transa operation op(A) that is non- or (conj.) transpose
  * @param transb operation op(B) that is non- or (conj.) transpose
  * @param m number of rows in matrix A, matrix C
@@ -847,8 +852,9 @@ xfblasStatus_t xfblasDestroy(unsigned int kernelNumber = 1, unsigned int deviceI
  * @param deviceIndex index of device that is being used, default is 0
  * @retval xfblasStatus_t 0 if the operation completed successfully
  * @retval xfblasStatus_t 1 if the library was not initialized
+ * @retval xfblasStatus_t 2 if alpha == beta is out of the range of the output scaling
  * @retval xfblasStatus_t 3 if not all the matrices have FPGA devie memory allocated
- * @retval xfblasStatus_t 4 if the engine is not supported for now
+ * @retval xfblasStatus_t 4 if the engine, op(A), op(B) or alpha and beta are not supported for now
  */
 xfblasStatus_t xfblasGemm(xfblasOperation_t transa,
                           xfblasOperation_t transb,
@@ -869,27 +875,177 @@ xfblasStatus_t xfblasGemm(xfblasOperation_t transa,
         return XFBLAS_STATUS_NOT_INITIALIZED;
     }
     if (ConfigDict::instance().m_dict["GEMX_runGemm"] == "1") {
-        if (transa == XFBLAS_OP_N && transb == XFBLAS_OP_N && alpha == 1 && beta == 1) {
-            GEMMHost* l_gemmPtr =
-                static_cast<GEMMHost*>(BLASHostHandle::instance().m_handlePtr[deviceIndex][kernelIndex].get());
-            xfblasStatus_t l_status;
-            int l_minSize = stoi(ConfigDict::instance().m_dict["minSize"]);
-            if (m % l_minSize != 0 || n % l_minSize != 0 || k % l_minSize != 0) {
-                int padded_m = getPaddedSize(m, l_minSize);
-                int padded_n = getPaddedSize(n, l_minSize);
-                int padded_k = getPaddedSize(k, l_minSize);
-                int paddedLda = getPaddedSize(lda, l_minSize);
-                int paddedLdb = getPaddedSize(ldb, l_minSize);
-                int paddedLdc = getPaddedSize(ldc, l_minSize);
-                l_status = l_gemmPtr->addGEMMOp(A, B, C, C, padded_m, padded_n, padded_k, paddedLda, paddedLdb,
-                                                paddedLdc, paddedLdc, 1, 0);
-            } else {
-                l_status = l_gemmPtr->addGEMMOp(A, B, C, C, m, n, k, lda, ldb, ldc, ldc, 1, 0);
-            }
+        int l_postScale;
+        xfblasStatus_t l_status = getGemmPostScale(transa, transb, alpha, beta, l_postScale);
+        if (l_status != XFBLAS_STATUS_SUCCESS) {
             return l_status;
+        }
+        GEMMHost* l_gemmPtr =
+            static_cast<GEMMHost*>(BLASHostHandle::instance().m_handlePtr[deviceIndex][kernelIndex].get());
+        int l_minSize = stoi(ConfigDict::instance().m_dict["minSize"]);
+        if (m % l_minSize != 0 || n % l_minSize != 0 || k % l_minSize != 0) {
+            int padded_m = getPaddedSize(m, l_minSize);
+            int padded_n = getPaddedSize(n, l_minSize);
+            int padded_k = getPaddedSize(k, l_minSize);
+            int paddedLda = getPaddedSize(lda, l_minSize);
+            int paddedLdb = getPaddedSize(ldb, l_minSize);
+            int paddedLdc = getPaddedSize(ldc, l_minSize);
+            l_status = l_gemmPtr->addGEMMOp(A, B, C, C, padded_m, padded_n, padded_k, paddedLda, paddedLdb, paddedLdc,
+                                            paddedLdc, l_postScale, 0);
         } else {
-            return XFBLAS_STATUS_NOT_SUPPORTED;
+            l_status = l_gemmPtr->addGEMMOp(A, B, C, C, m, n, k, lda, ldb, ldc, ldc, l_postScale, 0);
+        }
+        return l_status;
+    } else {
+        return XFBLAS_STATUS_NOT_SUPPORTED;
+    }
+}
+
+/**
+ * @brief This function performs a batch of matrix-matrix multiplications C[i] = alpha*op(A[i])op(B[i]) + beta*C[i],
+ * a batch larger than the instruction buffer runs in several kernel runs
+ * @param transa operation op(A[i]) that is non- or (conj.) transpose
+ * @param transb operation op(B[i]) that is non- or (conj.) transpose
+ * @param m number of rows in matrices A[i], C[i]
+ * @param n number of cols in matrices B[i], C[i]
+ * @param k number of cols in matrices A[i], number of rows in matrices B[i]
+ * @param alpha scalar used for multiplication
+ * @param A array of pointers to matrices A[i] in the host memory
+ * @param lda leading dimension of matirces A[i]
+ * @param B array of pointers to matrices B[i] in the host memory
+ * @param ldb leading dimension of matrices B[i]
+ * @param beta scalar used for multiplication
+ * @param C array of pointers to matrices C[i] in the host memory
+ * @param ldc leading dimension of matrices C[i]
+ * @param batchCount number of multiplications in the batch
+ * @param kernelIndex index of kernel that is being used, default is 0
+ * @param deviceIndex index of device that is being used, default is 0
+ * @retval xfblasStatus_t 0 if the operation completed successfully
+ * @retval xfblasStatus_t 1 if the library was not initialized
+ * @retval xfblasStatus_t 2 if batchCount <= 0 or alpha == beta is out of the range of the output scaling
+ * @retval xfblasStatus_t 3 if not all the matrices have FPGA devie memory allocated or a kernel run failed
+ * @retval xfblasStatus_t 4 if the engine, op(A), op(B) or alpha and beta are not supported for now
+ */
+xfblasStatus_t xfblasGemmBatched(xfblasOperation_t transa,
+                                 xfblasOperation_t transb,
+                                 int m,
+                                 int n,
+                                 int k,
+                                 int alpha,
+                                 void** A,
+                                 int lda,
+                                 void** B,
+                                 int ldb,
+                                 int beta,
+                                 void** C,
+                                 int ldc,
+                                 int batchCount,
+                                 unsigned int kernelIndex = 0,
+                                 unsigned int deviceIndex = 0) {
+    if (ConfigDict::instance().m_dict.empty()) {
+        return XFBLAS_STATUS_NOT_INITIALIZED;
+    }
+    if (batchCount <= 0) {
+        return XFBLAS_STATUS_INVALID_VALUE;
+    }
+    if (ConfigDict::instance().m_dict["GEMX_runGemm"] == "1") {
+        int l_postScale;
+        xfblasStatus_t l_status = getGemmPostScale(transa, transb, alpha, beta, l_postScale);
+        if (l_status != XFBLAS_STATUS_SUCCESS) {
+            return l_status;
+        }
+        GEMMHost* l_gemmPtr =
+            static_cast<GEMMHost*>(BLASHostHandle::instance().m_handlePtr[deviceIndex][kernelIndex].get());
+        int l_minSize = stoi(ConfigDict::instance().m_dict["minSize"]);
+        if (m % l_minSize != 0 || n % l_minSize != 0 || k % l_minSize != 0) {
+            m = getPaddedSize(m, l_minSize);
+            n = getPaddedSize(n, l_minSize);
+            k = getPaddedSize(k, l_minSize);
+            lda = getPaddedSize(lda, l_minSize);
+            ldb = getPaddedSize(ldb, l_minSize);
+            ldc = getPaddedSize(ldc, l_minSize);
+        }
+        return l_gemmPtr->addGEMMBatchOp(A, B, C, m, n, k, lda, ldb, ldc, batchCount, l_postScale, 0);
+    } else {
+        return XFBLAS_STATUS_NOT_SUPPORTED;
+    }
+}
+
+/**
+ * @brief This function performs a batch of matrix-matrix multiplications C[i] = alpha*op(A[i])op(B[i]) + beta*C[i]
+ * where the matrices of each operand are stored at a fixed stride in one allocation, a batch larger than the
+ * instruction buffer runs in several kernel runs
+ * @param transa operation op(A[i]) that is non- or (conj.) transpose
+ * @param transb operation op(B[i]) that is non- or (conj.) transpose
+ * @param m number of rows in matrices A[i], C[i]
+ * @param n number of cols in matrices B[i], C[i]
+ * @param k number of cols in matrices A[i], number of rows in matrices B[i]
+ * @param alpha scalar used for multiplication
+ * @param A pointer to matrix A[0] in the host memory
+ * @param lda leading dimension of matirces A[i]
+ * @param strideA number of elements between A[i] and A[i+1]
+ * @param B pointer to matrix B[0] in the host memory
+ * @param ldb leading dimension of matrices B[i]
+ * @param strideB number of elements between B[i] and B[i+1]
+ * @param beta scalar used for multiplication
+ * @param C pointer to matrix C[0] in the host memory
+ * @param ldc leading dimension of matrices C[i]
+ * @param strideC number of elements between C[i] and C[i+1]
+ * @param batchCount number of multiplications in the batch
+ * @param kernelIndex index of kernel that is being used, default is 0
+ * @param deviceIndex index of device that is being used, default is 0
+ * @retval xfblasStatus_t 0 if the operation completed successfully
+ * @retval xfblasStatus_t 1 if the library was not initialized
+ * @retval xfblasStatus_t 2 if batchCount <= 0, a stride is not a multiple of 4KB, the batch exceeds the allocation or
+ * alpha == beta is out of the range of the output scaling
+ * @retval xfblasStatus_t 3 if not all the matrices have FPGA devie memory allocated or a kernel run failed
+ * @retval xfblasStatus_t 4 if the engine, op(A), op(B) or alpha and beta are not supported for now
+ */
+xfblasStatus_t xfblasGemmStridedBatched(xfblasOperation_t transa,
+                                        xfblasOperation_t transb,
+                                        int m,
+                                        int n,
+                                        int k,
+                                        int alpha,
+                                        void* A,
+                                        int lda,
+                                        long long strideA,
+                                        void* B,
+                                        int ldb,
+                                        long long strideB,
+                                        int beta,
+                                        void* C,
+                                        int ldc,
+                                        long long strideC,
+                                        int batchCount,
+                                        unsigned int kernelIndex = 0,
+                                        unsigned int deviceIndex = 0) {
+    if (ConfigDict::instance().m_dict.empty()) {
+        return XFBLAS_STATUS_NOT_INITIALIZED;
+    }
+    if (batchCount <= 0 || strideA < 0 || strideB < 0 || strideC < 0) {
+        return XFBLAS_STATUS_INVALID_VALUE;
+    }
+    if (ConfigDict::instance().m_dict["GEMX_runGemm"] == "1") {
+        int l_postScale;
+        xfblasStatus_t l_status = getGemmPostScale(transa, transb, alpha, beta, l_postScale);
+        if (l_status != XFBLAS_STATUS_SUCCESS) {
+            return l_status;
+        }
+        GEMMHost* l_gemmPtr =
+            static_cast<GEMMHost*>(BLASHostHandle::instance().m_handlePtr[deviceIndex][kernelIndex].get());
+        int l_minSize = stoi(ConfigDict::instance().m_dict["minSize"]);
+        int l_elemSize = getTypeSize(ConfigDict::instance().m_dict["GEMX_dataType"]);
+        if (m % l_minSize != 0 || n % l_minSize != 0 || k % l_minSize != 0) {
+            m = getPaddedSize(m, l_minSize);
+            n = getPaddedSize(n, l_minSize);
+            k = getPaddedSize(k, l_minSize);
+            lda = getPaddedSize(lda, l_minSize);
+            ldb = getPaddedSize(ldb, l_minSize);
+            ldc = getPaddedSize(ldc, l_minSize);
         }
+        return l_gemmPtr->addGEMMStridedBatchOp(A, B, C, m, n, k, lda, ldb, ldc, strideA, strideB, strideC, batchCount,
+                                                l_elemSize, l_postScale, 0);
     } else {
         return XFBLAS_STATUS_NOT_SUPPORTED;
     }
@@ -199,6 +199,23 @@ void xfblasGetVectorRestrictedAsync(void* x, unsigned int kernelIndex = 0, unsig
     fuStatus.push_back(async(launch::async, xfblasGetVectorRestricted, x, kernelIndex, deviceIndex));
 }
 
+/**
+ * @brief This function launches the operations added to a kernel without waiting for them to finish. Launching the
+ * kernel again, e.g. by xfblasExecuteAsync() or xfblasGetMatrix(), waits for the running launch first.
+ * @param kernelIndex index of kernel that is being used, default is 0
+ * @param deviceIndex index of device that is being used, default is 0
+ * @retval future<bool> true once the kernel run completed, false if the library was not initialized or the launch
+ * failed
+ */
+future<bool> xfblasExecuteAsync(unsigned int kernelIndex = 0, unsigned int deviceIndex = 0) {
+    if (ConfigDict::instance().m_dict.empty()) {
+        promise<bool> l_done;
+        l_done.set_value(false);
+        return l_done.get_future();
+    }
+    return BLASHostHandle::instance().m_handlePtr[deviceIndex][kernelIndex]->executeAsync();
+}
+
 void xfblasKernelSynchronize() {
     for (auto& fu : fuStatus) {
         fu.wait();
@@ -71,38 +71,40 @@ class gemv(BLAS_L2):
     return self.alpha * np.matmul(self.a_in, self.x_in) + self.beta * self.y_in; 
 
 class BLAS_L3():
-  def writeBins(self,m,n,k,cnt):
-    write2Bin(self.a_in, self.out_dir+"matA_in"+str(cnt)+"_"+str(m)+"_"+str(k)+".bin")  
-    write2Bin(self.b_in, self.out_dir+"matB_in"+str(cnt)+"_"+str(k)+"_"+str(n)+".bin")
-    write2Bin(self.c_in, self.out_dir+"matC_in"+str(cnt)+"_"+str(m)+"_"+str(n)+".bin")
-    write2Bin(self.c_out, self.out_dir+"matC_out"+str(cnt)+"_"+str(m)+"_"+str(n)+".bin")
+  def writeBins(self,m,n,k,cnt,batch=1):
+    # the matrices of a batch are stacked by rows in one file
+    write2Bin(self.a_in, self.out_dir+"matA_in"+str(cnt)+"_"+str(batch*m)+"_"+str(k)+".bin")  
+    write2Bin(self.b_in, self.out_dir+"matB_in"+str(cnt)+"_"+str(batch*k)+"_"+str(n)+".bin")
+    write2Bin(self.c_in, self.out_dir+"matC_in"+str(cnt)+"_"+str(batch*m)+"_"+str(n)+".bin")
+    write2Bin(self.c_out, self.out_dir+"matC_out"+str(cnt)+"_"+str(batch*m)+"_"+str(n)+".bin")
     write2Bin(self.param, self.out_dir+"param_in"+str(cnt)+".bin")
     
 class gemm(BLAS_L3):
   def __init__(self):
     print("***** Generating golden reference for GEMM ******")
     
-  def genBin(self, cnt, dataType, cppDataType, size, maxValue, minValue):
-    if not len(size) == 3:
+  def genBin(self, cnt, dataType, cppDataType, size, maxValue, minValue, alpha=1, beta=1):
+    if not len(size) in (3, 4):
         raise OP_ERROR("[ERROR] GEMM wrong matrix size: "+str(size))
 
-    [m, n, k] = size;
-    self.a_in = dataGen(dataType, [m, k], maxValue, minValue);
-    self.b_in = dataGen(dataType, [k, n], maxValue, minValue);
-    self.c_in = dataGen(dataType, [m, n], maxValue, minValue);
+    [m, n, k] = size[0:3];
+    batch = size[3] if len(size) == 4 else 1
+    self.a_in = dataGen(dataType, [batch, m, k], maxValue, minValue);
+    self.b_in = dataGen(dataType, [batch, k, n], maxValue, minValue);
+    self.c_in = dataGen(dataType, [batch, m, n], maxValue, minValue);
     
-    self.alpha = 1
-    self.beta = 1
+    self.alpha = alpha
+    self.beta = beta
     
     self.c_out = self.compute();
     
-    # transa, transb, m, n, k, alpha, lda, ldb, beta, ldc, kernelIndex
-    self.param = np.asarray([0, 0, m, n, k, self.alpha, k, n, self.beta, n, 0], dtype=np.int32)
+    # transa, transb, m, n, k, alpha, lda, ldb, beta, ldc, kernelIndex, batchCount
+    self.param = np.asarray([0, 0, m, n, k, self.alpha, k, n, self.beta, n, 0, batch], dtype=np.int32)
     
     self.out_dir = "out_test/gemm/data/"+cppDataType+"/"
     if not os.path.exists(self.out_dir):
       os.makedirs(self.out_dir)
-    self.writeBins(m,n,k,cnt)
+    self.writeBins(m,n,k,cnt,batch)
 
   def compute(self):
     return self.alpha * np.matmul(self.a_in, self.b_in) + self.beta * self.c_in; 
@@ -40,6 +40,8 @@ class RunTest:
     self.minValue = self.profile['valueRange'][0]
     self.maxValue = self.profile['valueRange'][1]
     self.dimList = self.profile['matrixDims']
+    self.alpha = self.profile.get('alpha', 1)
+    self.beta = self.profile.get('beta', 1)
     self.shell = shell
     
   def build(self): 
@@ -53,7 +55,7 @@ class RunTest:
       i = 0
       for dim in self.dimList:
         if self.opName == 'gemm':
-          gemm().genBin(i, dataType, typeDict[dataType], dim, self.maxValue, self.minValue)
+          gemm().genBin(i, dataType, typeDict[dataType], dim, self.maxValue, self.minValue, self.alpha, self.beta)
         elif self.opName == 'gemv':
           gemv().genBin(i, dataType, typeDict[dataType], dim, self.maxValue, self.minValue)
         else:
@@ -43,9 +43,9 @@ int main(int argc, char** argv) {
     ifstream l_instrFile;
     l_instrFile.open(l_dataDir + "param_in" + to_string(iterIndex) + ".bin");
     int* l_instr;
-    posix_memalign((void**)&l_instr, 4096, 11 * sizeof(int));
+    posix_memalign((void**)&l_instr, 4096, 12 * sizeof(int));
     if (l_instrFile.is_open()) {
-        l_instrFile.read((char*)l_instr, 11 * sizeof(int));
+        l_instrFile.read((char*)l_instr, 12 * sizeof(int));
         l_instrFile.close();
     } else {
         cerr << "could not find instruction file " << (l_dataDir + "param_in" + to_string(iterIndex) + ".bin") << "\n";
@@ -61,20 +61,22 @@ int main(int argc, char** argv) {
     int beta = l_instr[8];
     int ldc = l_instr[9];
     int l_numKernel = l_instr[10] + 1;
+    // the matrices of a batch are stacked by rows in the data files
+    int batchCount = l_instr[11];
 
-    posix_memalign((void**)&a, 4096, m * k * sizeof(XFBLAS_dataType));
-    posix_memalign((void**)&b, 4096, k * n * sizeof(XFBLAS_dataType));
-    posix_memalign((void**)&c, 4096, m * n * sizeof(XFBLAS_dataType));
-    posix_memalign((void**)&goldenC, 4096, m * n * sizeof(XFBLAS_dataType));
+    posix_memalign((void**)&a, 4096, batchCount * m * k * sizeof(XFBLAS_dataType));
+    posix_memalign((void**)&b, 4096, batchCount * k * n * sizeof(XFBLAS_dataType));
+    posix_memalign((void**)&c, 4096, batchCount * m * n * sizeof(XFBLAS_dataType));
+    posix_memalign((void**)&goldenC, 4096, batchCount * m * n * sizeof(XFBLAS_dataType));
 
-    readMatBin((char*)a, iterIndex, m, k, l_dataDir, "matA_in", sizeof(XFBLAS_dataType));
-    readMatBin((char*)b, iterIndex, k, n, l_dataDir, "matB_in", sizeof(XFBLAS_dataType));
-    readMatBin((char*)c, iterIndex, m, n, l_dataDir, "matC_in", sizeof(XFBLAS_dataType));
-    readMatBin((char*)goldenC, iterIndex, m, n, l_dataDir, "matC_out", sizeof(XFBLAS_dataType));
+    readMatBin((char*)a, iterIndex, batchCount * m, k, l_dataDir, "matA_in", sizeof(XFBLAS_dataType));
+    readMatBin((char*)b, iterIndex, batchCount * k, n, l_dataDir, "matB_in", sizeof(XFBLAS_dataType));
+    readMatBin((char*)c, iterIndex, batchCount * m, n, l_dataDir, "matC_in", sizeof(XFBLAS_dataType));
+    readMatBin((char*)goldenC, iterIndex, batchCount * m, n, l_dataDir, "matC_out", sizeof(XFBLAS_dataType));
 
-    XFBLAS_dataType* d_a = NULL;
-    XFBLAS_dataType* d_b = NULL;
-    XFBLAS_dataType* d_c = NULL;
+    vector<XFBLAS_dataType*> d_a(batchCount, NULL);
+    vector<XFBLAS_dataType*> d_b(batchCount, NULL);
+    vector<XFBLAS_dataType*> d_c(batchCount, NULL);
 
     xfblasEngine_t engineName = XFBLAS_ENGINE_GEMM;
     xfblasStatus_t status =
@@ -84,63 +86,76 @@ int main(int argc, char** argv) {
         return EXIT_FAILURE;
     }
 
-    status = xfblasMalloc(&d_a, m, k, sizeof(*a), l_numKernel - 1);
-    if (status != XFBLAS_STATUS_SUCCESS) {
-        cout << "Malloc memory for matrix A failed with error code: " << status << "\n";
-        xfblasDestroy();
-        return EXIT_FAILURE;
-    }
-
-    status = xfblasMalloc(&d_b, k, n, sizeof(*b), l_numKernel - 1);
-
-    if (status != XFBLAS_STATUS_SUCCESS) {
-        cout << "Malloc memory for matrix B failed with error code: " << status << "\n";
-        xfblasDestroy();
-        return EXIT_FAILURE;
-    }
-
-    status = xfblasMalloc(&d_c, m, n, sizeof(*c), l_numKernel - 1);
-    if (status != XFBLAS_STATUS_SUCCESS) {
-        cout << "Malloc memory for matrix C failed with error code: " << status << "\n";
-        xfblasDestroy();
-        return EXIT_FAILURE;
+    for (i = 0; i < batchCount; i++) {
+        status = xfblasMalloc(&d_a[i], m, k, sizeof(*a), l_numKernel - 1);
+        if (status != XFBLAS_STATUS_SUCCESS) {
+            cout << "Malloc memory for matrix A failed with error code: " << status << "\n";
+            xfblasDestroy();
+            return EXIT_FAILURE;
+        }
+
+        status = xfblasMalloc(&d_b[i], k, n, sizeof(*b), l_numKernel - 1);
+
+        if (status != XFBLAS_STATUS_SUCCESS) {
+            cout << "Malloc memory for matrix B failed with error code: " << status << "\n";
+            xfblasDestroy();
+            return EXIT_FAILURE;
+        }
+
+        status = xfblasMalloc(&d_c[i], m, n, sizeof(*c), l_numKernel - 1);
+        if (status != XFBLAS_STATUS_SUCCESS) {
+            cout << "Malloc memory for matrix C failed with error code: " << status << "\n";
+            xfblasDestroy();
+            return EXIT_FAILURE;
+        }
+
+        status = xfblasSetMatrix(m, k, sizeof(*a), a + i * m * k, k, d_a[i], l_numKernel - 1);
+        status = xfblasSetMatrix(k, n, sizeof(*b), b + i * k * n, n, d_b[i], l_numKernel - 1);
+        status = xfblasSetMatrix(m, n, sizeof(*c), c + i * m * n, n, d_c[i], l_numKernel - 1);
+
+        if (status != XFBLAS_STATUS_SUCCESS) {
+            cout << "Set Matrix failed with error code: " << status << "\n";
+            xfblasDestroy();
+            return EXIT_FAILURE;
+        }
     }
 
-    status = xfblasSetMatrix(m, k, sizeof(*a), a, k, d_a, l_numKernel - 1);
-    status = xfblasSetMatrix(k, n, sizeof(*b), b, n, d_b, l_numKernel - 1);
-    status = xfblasSetMatrix(m, n, sizeof(*c), c, n, d_c, l_numKernel - 1);
-
-    if (status != XFBLAS_STATUS_SUCCESS) {
-        cout << "Set Matrix failed with error code: " << status << "\n";
-        xfblasDestroy();
-        return EXIT_FAILURE;
+    // a batch larger than the instruction buffer runs in several kernel runs
+    if (batchCount == 1) {
+        status = xfblasGemm(XFBLAS_OP_N, XFBLAS_OP_N, m, n, k, alpha, d_a[0], lda, d_b[0], ldb, beta, d_c[0], ldc,
+                            l_numKernel - 1);
+    } else {
+        status = xfblasGemmBatched(XFBLAS_OP_N, XFBLAS_OP_N, m, n, k, alpha, (void**)d_a.data(), lda,
+                                   (void**)d_b.data(), ldb, beta, (void**)d_c.data(), ldc, batchCount, l_numKernel - 1);
     }
 
-    status = xfblasGemm(XFBLAS_OP_N, XFBLAS_OP_N, m, n, k, 1, d_a, k, d_b, n, 1, d_c, n, l_numKernel - 1);
-
     if (status != XFBLAS_STATUS_SUCCESS) {
         cout << "Matrix Multiplication failed with error code: " << status << "\n";
         xfblasDestroy();
         return EXIT_FAILURE;
     }
 
-    status = xfblasGetMatrix(m, n, sizeof(*c), d_c, c, n, l_numKernel - 1);
+    for (i = 0; i < batchCount; i++) {
+        status = xfblasGetMatrix(m, n, sizeof(*c), d_c[i], c + i * m * n, n, l_numKernel - 1);
 
-    if (status != XFBLAS_STATUS_SUCCESS) {
-        cout << "Get Matirx failed with error code: " << status << "\n";
-        xfblasDestroy();
-        return EXIT_FAILURE;
+        if (status != XFBLAS_STATUS_SUCCESS) {
+            cout << "Get Matirx failed with error code: " << status << "\n";
+            xfblasDestroy();
+            return EXIT_FAILURE;
+        }
     }
 
-    if (compareMat<XFBLAS_dataType>(c, goldenC, m, n)) {
+    if (compareMat<XFBLAS_dataType>(c, goldenC, batchCount * m, n)) {
         cout << "Test passed!\n";
     } else {
         cout << "Test failed!\n";
     }
 
-    xfblasFree(d_a, l_numKernel - 1);
-    xfblasFree(d_b, l_numKernel - 1);
-    xfblasFree(d_c, l_numKernel - 1);
+    for (i = 0; i < batchCount; i++) {
+        xfblasFree(d_a[i], l_numKernel - 1);
+        xfblasFree(d_b[i], l_numKernel - 1);
+        xfblasFree(d_c[i], l_numKernel - 1);
+    }
     free(a);
     free(b);
     free(c);
@@ -0,0 +1,122 @@
+/*
+ * (c) Copyright 2019 Xilinx, Inc. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef _XFCOMPRESSION_CRC32_HPP_
+#define _XFCOMPRESSION_CRC32_HPP_
+
+/**
+ * @file crc32.hpp
+ * @brief Header for streaming CRC32 module used in gzip compression.
+ *
+ * This file is part of Vitis Data Compression Library.
+ */
+#include "hls_stream.h"
+
+#include <ap_int.h>
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+
+// Reflected CRC32 polynomial used by gzip
+#define CRC32_POLYNOMIAL 0xEDB88320
+
+namespace xf {
+namespace compression {
+
+/**
+ * @brief Generates the slice-by-N lookup tables for CRC32. Table 0 is
+ * the classic byte-wise table, table k advances a CRC by k more zero bytes.
+ *
+ * @tparam PARALLEL_BYTE number of bytes processed per cycle
+ *
+ * @param crcTable lookup tables
+ */
+template <int PARALLEL_BYTE>
+void crc32GenTable(ap_uint<32> crcTable[PARALLEL_BYTE][256]) {
+crc32_table_0:
+    for (uint32_t i = 0; i < 256; i++) {
+        ap_uint<32> crc = i;
+        for (uint32_t j = 0; j < 8; j++) {
+#pragma HLS UNROLL
+            crc = (crc[0]) ? (ap_uint<32>)((crc >> 1) ^ CRC32_POLYNOMIAL) : (ap_uint<32>)(crc >> 1);
+        }
+        crcTable[0][i] = crc;
+    }
+
+crc32_table_n:
+    for (uint32_t k = 1; k < PARALLEL_BYTE; k++) {
+        for (uint32_t i = 0; i < 256; i++) {
+#pragma HLS PIPELINE II = 1
+            ap_uint<32> prev = crcTable[k - 1][i];
+            crcTable[k][i] = (prev >> 8) ^ crcTable[0][prev.range(7, 0)];
+        }
+    }
+}
+
+/**
+ * @brief CRC32 module computes the gzip checksum of a raw data stream.
+ * PARALLEL_BYTE bytes are folded into the checksum every cycle using
+ * slice-by-N lookup tables, trailing bytes of the last word are folded one
+ * byte at a time. Output is the final (inverted) CRC32 of the input block.
+ *
+ * @tparam PARALLEL_BYTE number of bytes per input word, at least 4
+ *
+ * @param inStream input raw data stream
+ * @param outStream output checksum
+ * @param input_size input size in bytes
+ */
+template <int PARALLEL_BYTE>
+void crc32(hls::stream<ap_uint<PARALLEL_BYTE * 8> >& inStream,
+           hls::stream<ap_uint<32> >& outStream,
+           uint32_t input_size) {
+    ap_uint<32> crcTable[PARALLEL_BYTE][256];
+#pragma HLS ARRAY_PARTITION variable = crcTable dim = 1 complete
+
+    crc32GenTable<PARALLEL_BYTE>(crcTable);
+
+    ap_uint<32> crc = 0xFFFFFFFF;
+    uint32_t fullWords = input_size / PARALLEL_BYTE;
+    uint32_t leftBytes = input_size % PARALLEL_BYTE;
+
+crc32_slice:
+    for (uint32_t i = 0; i < fullWords; i++) {
+#pragma HLS PIPELINE II = 1
+        ap_uint<PARALLEL_BYTE * 8> inValue = inStream.read();
+        inValue.range(31, 0) = inValue.range(31, 0) ^ crc;
+        ap_uint<32> nextCrc = 0;
+        for (int k = 0; k < PARALLEL_BYTE; k++) {
+#pragma HLS UNROLL
+            nextCrc ^= crcTable[PARALLEL_BYTE - 1 - k][inValue.range(k * 8 + 7, k * 8)];
+        }
+        crc = nextCrc;
+    }
+
+    if (leftBytes) {
+        ap_uint<PARALLEL_BYTE * 8> inValue = inStream.read();
+    crc32_left_over:
+        for (uint32_t k = 0; k < leftBytes; k++) {
+#pragma HLS PIPELINE II = 1
+            crc = (crc >> 8) ^ crcTable[0][crc.range(7, 0) ^ inValue.range(k * 8 + 7, k * 8)];
+        }
+    }
+
+    outStream << (crc ^ 0xFFFFFFFF);
+}
+
+} // namespace compression
+} // namespace xf
+
+#endif // _XFCOMPRESSION_CRC32_HPP_
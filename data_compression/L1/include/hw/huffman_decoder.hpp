@@ -46,15 +46,19 @@ typedef ap_uint<32> compressd_dt;
 #define READBITS(n) \
     while (bits_cntr < (uint32_t)(n)) NEXTBYTE();
 
-#define NEXTBYTE()                                      \
-    {                                                   \
-        curInSize -= 2;                                 \
-        uint16_t temp_lcl = (uint16_t)inStream.read();  \
-        in_cntr += 2;                                   \
-        bitbuffer += (uint64_t)(temp_lcl) << bits_cntr; \
-        bits_cntr += 16;                                \
+// Reads past the end of the input give zeros
+#define NEXTBYTE()                                                                  \
+    {                                                                               \
+        curInSize -= 2;                                                             \
+        uint16_t temp_lcl = (in_cntr < input_size) ? (uint16_t)inStream.read() : 0; \
+        in_cntr += 2;                                                               \
+        bitbuffer += (uint64_t)(temp_lcl) << bits_cntr;                             \
+        bits_cntr += 16;                                                            \
     }
 
+// Slack for the bits buffered ahead, a stream reading further ends before its final block
+#define INPUT_SLACK 8
+
 #define BITS(n) ((uint32_t)bitbuffer & ((1 << (n)) - 1))
 
 #define DUMPBITS(n)    \
@@ -277,11 +281,14 @@ code_gen:
  * @param outStream output lz77 compressed output in the form of 32bit packets
  * (Literals, Match Length, Distances)
  * @param endOfStream output completion of execution
+ * @param endSizeStream input bytes up to the end of the final block, 0 when
+ * the input ends before it
  * @param input_size input data size
  */
 void huffmanDecoder(hls::stream<ap_uint<2 * BIT> >& inStream,
                     hls::stream<compressd_dt>& outStream,
                     hls::stream<bool>& endOfStream,
+                    hls::stream<uint32_t>& endSizeStream,
                     uint32_t input_size) {
     uint64_t bitbuffer = 0;
     uint32_t curInSize = input_size;
@@ -318,6 +325,7 @@ void huffmanDecoder(hls::stream<ap_uint<2 * BIT> >& inStream,
     int cntr = 0;
     uint32_t used = 0;
     uint8_t next_state = HEADER_STATE;
+    bool complete = false;
 
     while (done) {
         done = false;
@@ -497,7 +505,7 @@ void huffmanDecoder(hls::stream<ap_uint<2 * BIT> >& inStream,
 
                 // Read from inStream
                 if (bits_cntr < 15) {
-                    uint16_t temp = inStream.read();
+                    uint16_t temp = (in_cntr < input_size) ? (uint16_t)inStream.read() : 0;
                     in_cntr += 2;
                     bitbuffer += (uint64_t)(temp) << bits_cntr;
                     bits_cntr += 16;
@@ -538,7 +546,7 @@ void huffmanDecoder(hls::stream<ap_uint<2 * BIT> >& inStream,
                             curr_stage = LITERAL_STAGE;
 
                             if (bits_cntr < 15) {
-                                uint16_t temp = inStream.read();
+                                uint16_t temp = (in_cntr < input_size) ? (uint16_t)inStream.read() : 0;
                                 in_cntr += 2;
                                 bitbuffer += (uint64_t)(temp) << bits_cntr;
                                 bits_cntr += 16;
@@ -568,7 +576,7 @@ void huffmanDecoder(hls::stream<ap_uint<2 * BIT> >& inStream,
                             curr_stage = MATCH_DIST_STAGE;
 
                             if (bits_cntr < 15) {
-                                uint16_t temp = inStream.read();
+                                uint16_t temp = (in_cntr < input_size) ? (uint16_t)inStream.read() : 0;
                                 in_cntr += 2;
                                 bitbuffer += (uint64_t)(temp) << bits_cntr;
                                 bits_cntr += (2 * BIT);
@@ -581,8 +589,8 @@ void huffmanDecoder(hls::stream<ap_uint<2 * BIT> >& inStream,
                             lidx = current_val + (bitbuffer & ((1 << ml_op) - 1));
                             read_ml_bram = true;
                         } else if (ml_op & 32) {
-                            // Termination Condition
-                            next_state = 2;
+                            // End of block, the final one completes the stream
+                            next_state = dynamic_last ? COMPLETE_STATE : TREE_PMBL_STATE;
                             done = 1;
                         }
 
@@ -621,7 +629,7 @@ void huffmanDecoder(hls::stream<ap_uint<2 * BIT> >& inStream,
                         curr_stage = LITERAL_STAGE;
 
                         if (bits_cntr < 15) {
-                            uint16_t temp = inStream.read();
+                            uint16_t temp = (in_cntr < input_size) ? (uint16_t)inStream.read() : 0;
                             in_cntr += 2;
                             bitbuffer += (uint64_t)(temp) << bits_cntr;
                             bits_cntr += (2 * BIT);
@@ -647,12 +655,16 @@ void huffmanDecoder(hls::stream<ap_uint<2 * BIT> >& inStream,
 
                     // Read inStream
                     if (bits_cntr < 15) {
-                        uint16_t temp = inStream.read();
+                        uint16_t temp = (in_cntr < input_size) ? (uint16_t)inStream.read() : 0;
                         in_cntr += 2;
                         bitbuffer += (uint64_t)(temp) << bits_cntr;
                         bits_cntr += (2 * BIT);
                     }
 
+                    if (in_cntr > input_size + INPUT_SLACK) {
+                        next_state = 77;
+                        done = 1;
+                    }
                 } // Top for-loop ends hre
 
                 if (next_state == 77) done = false;
@@ -660,21 +672,43 @@ void huffmanDecoder(hls::stream<ap_uint<2 * BIT> >& inStream,
                 done = false;
         } else if (next_state == COMPLETE_STATE) {
             done = false;
+            complete = true;
             break;
         }
 
+        if (in_cntr > input_size + INPUT_SLACK) done = false;
     } // While end
 
-    uint32_t leftover = input_size - in_cntr;
-    if (leftover) {
-        for (int i = 0; i < leftover; i += 2) {
-            uint16_t c = inStream.read();
-        }
+    // Whole bytes still buffered follow the final block
+    uint32_t end = in_cntr - bits_cntr / 8;
+    endSizeStream << ((complete && end <= input_size) ? end : 0);
+
+    for (uint32_t i = in_cntr; i < input_size; i += 2) {
+        uint16_t c = inStream.read();
     }
 
     outStream << 0; // Adding Dummy Data for last end of stream case
     endOfStream << 1;
 }
+
+/**
+ * @brief This module is zlib/gzip huffman decoder it generates a LZ77 byte compressed
+ * data and trasfer to lz_decompress_eos module for further byte unpacking
+ *
+ * @param inStream input bit packed data
+ * @param outStream output lz77 compressed output in the form of 32bit packets
+ * (Literals, Match Length, Distances)
+ * @param endOfStream output completion of execution
+ * @param input_size input data size
+ */
+void huffmanDecoder(hls::stream<ap_uint<2 * BIT> >& inStream,
+                    hls::stream<compressd_dt>& outStream,
+                    hls::stream<bool>& endOfStream,
+                    uint32_t input_size) {
+    hls::stream<uint32_t> endSizeStream("endSizeStream");
+    huffmanDecoder(inStream, outStream, endOfStream, endSizeStream, input_size);
+    endSizeStream.read();
+}
 } // Compression
 } // XF
 #endif // _XFCOMPRESSION_INFLATE_HUFFMAN_HPP_
@@ -64,6 +64,37 @@ const auto BSIZE_NCOMP_256 = 4;
 const auto BSIZE_NCOMP_1024 = 16;
 const auto BSIZE_NCOMP_4096 = 64;
 
+/**
+ * FLG byte bits enabling the optional
+ * xxHash32 checksums of the frame
+ */
+const auto FLG_BLOCK_CHECKSUM = 0x10;
+const auto FLG_CONTENT_CHECKSUM = 0x04;
+
+/**
+ * FLG byte bit announcing the content
+ * size field in the frame header
+ */
+const auto FLG_CONTENT_SIZE = 0x08;
+
+/**
+ * FLG byte bit announcing the dictionary ID
+ * field, set for frames compressed against
+ * a preset dictionary
+ */
+const auto FLG_DICT_ID = 0x01;
+
+/**
+ * Seekable frames are followed by a skippable
+ * frame holding the block index. It ends in a
+ * footer of original size (8 bytes), block size
+ * in KB (4 bytes) and SEEK_INDEX_MAGIC (4 bytes)
+ * so readers can locate it from the file end.
+ */
+const uint32_t SKIPPABLE_MAGIC = 0x184D2A5E;
+const uint32_t SEEK_INDEX_MAGIC = 0x8F92EAB1;
+const auto SEEK_FOOTER_SIZE = 16;
+
 } // end namespace compression
 } // end namespace xf
 
@@ -113,6 +113,103 @@ lz_decompress:
     }
 }
 
+/**
+ * @brief This module writes the literals to the output stream as is
+ * and when match length and offset are read, the literals will be read from
+ * the local dictionary based on offset until match length. The history
+ * is preloaded with dict_size bytes of a preset dictionary read from
+ * dictStream, matches may reach back into it as if it directly preceded
+ * the block.
+ *
+ * @tparam HISTORY_SIZE history size
+ * @tparam READ_STATE read state
+ * @tparam MATCH_STATE match state
+ * @tparam LOW_OFFSET_STATE low offset state
+ * @tparam LOW_OFFSET low offset
+ *
+ * @param inStream input stream
+ * @param dictStream preset dictionary stream
+ * @param outStream output stream
+ * @param original_size original size
+ * @param dict_size preset dictionary size, 0 for none
+ */
+
+template <int HISTORY_SIZE, int READ_STATE, int MATCH_STATE, int LOW_OFFSET_STATE, int LOW_OFFSET>
+void lzDecompressDict(hls::stream<compressd_dt>& inStream,
+                      hls::stream<ap_uint<8> >& dictStream,
+                      hls::stream<ap_uint<8> >& outStream,
+                      uint32_t original_size,
+                      uint32_t dict_size) {
+    uint8_t local_buf[HISTORY_SIZE];
+#pragma HLS dependence variable = local_buf inter false
+
+    uint32_t match_len = 0;
+    uint32_t out_len = 0;
+    uint32_t match_loc = 0;
+    uint32_t length_extract = 0;
+    uint8_t next_states = READ_STATE;
+    uint16_t offset = 0;
+    compressd_dt nextValue;
+    ap_uint<8> outValue = 0;
+    ap_uint<8> prevValue[LOW_OFFSET];
+#pragma HLS ARRAY PARTITION variable = prevValue dim = 0 complete
+dict_preload:
+    for (uint32_t i = 0; i < dict_size; i++) {
+#pragma HLS PIPELINE II = 1
+        outValue = dictStream.read();
+        local_buf[i % HISTORY_SIZE] = outValue;
+        for (uint32_t pIdx = LOW_OFFSET - 1; pIdx > 0; pIdx--) {
+#pragma HLS UNROLL
+            prevValue[pIdx] = prevValue[pIdx - 1];
+        }
+        prevValue[0] = outValue;
+    }
+lz_decompress:
+    for (uint32_t i = dict_size; i < dict_size + original_size; i++) {
+#pragma HLS PIPELINE II = 1
+        if (next_states == READ_STATE) {
+            nextValue = inStream.read();
+            offset = nextValue.range(15, 0);
+            length_extract = nextValue.range(31, 16);
+            if (length_extract) {
+                match_loc = i - offset - 1;
+                match_len = length_extract + 1;
+                // printf("HISTORY=%x\n",(uint8_t)outValue);
+                out_len = 1;
+                if (offset >= LOW_OFFSET) {
+                    next_states = MATCH_STATE;
+                    outValue = local_buf[match_loc % HISTORY_SIZE];
+                } else {
+                    next_states = LOW_OFFSET_STATE;
+                    outValue = prevValue[offset];
+                }
+                match_loc++;
+            } else {
+                outValue = nextValue.range(7, 0);
+                // printf("LITERAL=%x\n",(uint8_t)outValue);
+            }
+        } else if (next_states == LOW_OFFSET_STATE) {
+            outValue = prevValue[offset];
+            match_loc++;
+            out_len++;
+            if (out_len == match_len) next_states = READ_STATE;
+        } else {
+            outValue = local_buf[match_loc % HISTORY_SIZE];
+            // printf("HISTORY=%x\n",(uint8_t)outValue);
+            match_loc++;
+            out_len++;
+            if (out_len == match_len) next_states = READ_STATE;
+        }
+        local_buf[i % HISTORY_SIZE] = outValue;
+        outStream << outValue;
+        for (uint32_t pIdx = LOW_OFFSET - 1; pIdx > 0; pIdx--) {
+#pragma HLS UNROLL
+            prevValue[pIdx] = prevValue[pIdx - 1];
+        }
+        prevValue[0] = outValue;
+    }
+}
+
 template <int HISTORY_SIZE, int READ_STATE, int MATCH_STATE, int LOW_OFFSET_STATE, int LOW_OFFSET>
 uint32_t lzDecompressZlibEos(hls::stream<compressd_dt>& inStream,
                              hls::stream<bool>& inStream_eos,
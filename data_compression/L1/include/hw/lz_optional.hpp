@@ -99,6 +99,77 @@ lz_bestMatchFilter_left_over:
     }
 }
 
+/**
+ * @brief Lazy match evaluation in the manner of zlib levels 4 to 9.
+ * A match is turned into a literal when one of the next LAZY_DEPTH
+ * positions starts a longer match, the following position is then
+ * evaluated the same way. Matches of MAX_LAZY_LEN or longer are taken
+ * right away. The last left_bytes literals carry no matches and are
+ * passed through as lzCompress emits them.
+ *
+ * @tparam LAZY_DEPTH number of following positions searched for a better match
+ * @tparam MAX_LAZY_LEN match length which stops the lazy search
+ *
+ * @param inStream input stream, one match per literal
+ * @param outStream output stream
+ * @param input_size input stream size
+ * @param left_bytes bytes left in block
+ */
+template <int LAZY_DEPTH, int MAX_LAZY_LEN>
+void lzLazyMatch(hls::stream<compressd_dt>& inStream,
+                 hls::stream<compressd_dt>& outStream,
+                 uint32_t input_size,
+                 uint32_t left_bytes) {
+    if (input_size == 0) return;
+
+    compressd_dt lazy_window[LAZY_DEPTH + 1];
+#pragma HLS array_partition variable = lazy_window
+
+    // Blocks shorter than the window only prime part of it
+    uint32_t lazy_size = (input_size > left_bytes) ? (input_size - left_bytes) : 0;
+    uint32_t depth = (lazy_size < LAZY_DEPTH) ? lazy_size : LAZY_DEPTH;
+lz_lazy_match_prime:
+    for (uint32_t i = 0; i < depth; i++) {
+#pragma HLS PIPELINE II = 1
+        lazy_window[i + 1] = inStream.read();
+    }
+
+lz_lazy_match:
+    for (uint32_t i = LAZY_DEPTH; i < lazy_size; i++) {
+#pragma HLS PIPELINE II = 1
+        for (uint32_t j = 0; j < LAZY_DEPTH; j++) {
+#pragma HLS UNROLL
+            lazy_window[j] = lazy_window[j + 1];
+        }
+        lazy_window[LAZY_DEPTH] = inStream.read();
+
+        compressd_dt outValue = lazy_window[0];
+        uint8_t match_length = outValue.range(15, 8);
+        bool defer = false;
+        for (uint32_t j = 1; j <= LAZY_DEPTH; j++) {
+#pragma HLS UNROLL
+            uint8_t nextLen = lazy_window[j].range(15, 8);
+            // Deferring by j literals needs a match at least j bytes longer
+            if (match_length + j <= nextLen) defer = true;
+        }
+        if (match_length && match_length < MAX_LAZY_LEN && defer) {
+            outValue.range(15, 8) = 0;
+            outValue.range(31, 16) = 0;
+        }
+        outStream << outValue;
+    }
+
+lz_lazy_match_left_over:
+    for (uint32_t i = 1; i <= depth; i++) {
+        outStream << lazy_window[i];
+    }
+
+lz_lazy_match_left_bytes:
+    for (uint32_t i = lazy_size; i < input_size; i++) {
+        outStream << inStream.read();
+    }
+}
+
 /**
  * @brief This module helps in improving the compression ratio.
  * Finds a better match length by performing more character matches
@@ -178,6 +249,98 @@ lz_booster_left_bytes:
     }
 }
 
+/**
+ * @brief This module helps in improving the compression ratio.
+ * Finds a better match length by performing more character matches
+ * with supported max match, while maintaining an offset window.
+ * The window is preloaded with the preset dictionary given to
+ * lzCompressDict, so matches into it are extended as well.
+ *
+ * @tparam MAX_MATCH_LEN maximum length allowed for character match
+ * @tparam BOOSTER_OFFSET_WINDOW offset window to store/match the character
+ *
+ * @param inStream input stream 32bit per read
+ * @param dictStream preset dictionary stream
+ * @param outStream output stream 32bit per write
+ * @param input_size intput size
+ * @param left_bytes last 64 left over bytes
+ * @param dict_size preset dictionary size, 0 for none and for empty blocks
+ *
+*/
+template <int MAX_MATCH_LEN, int BOOSTER_OFFSET_WINDOW>
+void lzBoosterDict(hls::stream<compressd_dt>& inStream,
+                   hls::stream<ap_uint<8> >& dictStream,
+                   hls::stream<compressd_dt>& outStream,
+                   uint32_t input_size,
+                   uint32_t left_bytes,
+                   uint32_t dict_size) {
+    if (input_size == 0) return;
+    uint8_t local_mem[BOOSTER_OFFSET_WINDOW];
+    uint32_t match_loc = 0;
+    uint32_t match_len = 0;
+    compressd_dt outValue;
+    compressd_dt outStreamValue;
+    bool matchFlag = false;
+    bool outFlag = false;
+    bool boostFlag = false;
+    uint16_t skip_len = 0;
+    // Dictionary byte j sits at position j, input byte i at dict_size + i
+booster_dict_preload:
+    for (uint32_t j = 0; j < dict_size; j++) {
+#pragma HLS PIPELINE II = 1
+        local_mem[j % BOOSTER_OFFSET_WINDOW] = dictStream.read();
+    }
+lz_booster:
+    for (uint32_t i = 0; i < (input_size - left_bytes); i++) {
+#pragma HLS PIPELINE II = 1
+#pragma HLS dependence variable = local_mem inter false
+        uint32_t pos = dict_size + i;
+        compressd_dt inValue = inStream.read();
+        uint8_t tCh = inValue.range(7, 0);
+        uint8_t tLen = inValue.range(15, 8);
+        uint16_t tOffset = inValue.range(31, 16);
+        if ((tOffset < BOOSTER_OFFSET_WINDOW) && (tOffset < pos)) {
+            boostFlag = true;
+        } else {
+            boostFlag = false;
+        }
+        uint8_t match_ch = local_mem[match_loc % BOOSTER_OFFSET_WINDOW];
+        local_mem[pos % BOOSTER_OFFSET_WINDOW] = tCh;
+        outFlag = false;
+
+        if (skip_len) {
+            skip_len--;
+        } else if (matchFlag && (match_len < MAX_MATCH_LEN) && (tCh == match_ch)) {
+            match_len++;
+            match_loc++;
+            outValue.range(15, 8) = match_len;
+        } else {
+            match_len = 1;
+            match_loc = pos - tOffset;
+            if (i) outFlag = true;
+            outStreamValue = outValue;
+            outValue = inValue;
+            if (tLen) {
+                if (boostFlag) {
+                    matchFlag = true;
+                    skip_len = 0;
+                } else {
+                    matchFlag = false;
+                    skip_len = tLen - 1;
+                }
+            } else {
+                matchFlag = false;
+            }
+        }
+        if (outFlag) outStream << outStreamValue;
+    }
+    outStream << outValue;
+lz_booster_left_bytes:
+    for (uint32_t i = 0; i < left_bytes; i++) {
+        outStream << inStream.read();
+    }
+}
+
 /**
  * @brief This module checks if match length exists, and if
  * match length exists it filters the match length -1 characters
@@ -0,0 +1,194 @@
+/*
+ * (c) Copyright 2019 Xilinx, Inc. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef _XFCOMPRESSION_XXHASH32_HPP_
+#define _XFCOMPRESSION_XXHASH32_HPP_
+
+/**
+ * @file xxhash32.hpp
+ * @brief Header for streaming xxHash32 modules used for LZ4 frame checksums.
+ *
+ * This file is part of Vitis Data Compression Library.
+ */
+#include "hls_stream.h"
+
+#include <ap_int.h>
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#define XXH32_PRIME1 2654435761U
+#define XXH32_PRIME2 2246822519U
+#define XXH32_PRIME3 3266489917U
+#define XXH32_PRIME4 668265263U
+#define XXH32_PRIME5 374761393U
+
+// Bytes consumed per xxHash32 stripe (4 lanes of 32bit)
+#define XXH32_STRIPE_BYTES 16
+
+namespace xf {
+namespace compression {
+
+namespace details {
+
+inline ap_uint<32> xxh32Rotl(ap_uint<32> value, int count) {
+#pragma HLS INLINE
+    return (value << count) | (value >> (32 - count));
+}
+
+inline ap_uint<32> xxh32Round(ap_uint<32> acc, ap_uint<32> lane) {
+#pragma HLS INLINE
+    acc += lane * (ap_uint<32>)XXH32_PRIME2;
+    acc = xxh32Rotl(acc, 13);
+    acc *= (ap_uint<32>)XXH32_PRIME1;
+    return acc;
+}
+
+/**
+ * @brief Merges the lane accumulators, folds the trailing bytes of the
+ * stripe buffer and applies the final avalanche.
+ *
+ * @param acc lane accumulators
+ * @param tail trailing bytes which do not fill a stripe
+ * @param tailBytes number of valid bytes in tail
+ * @param totalBytes total number of bytes hashed
+ */
+inline ap_uint<32> xxh32Finalize(ap_uint<32> acc[4],
+                                 ap_uint<XXH32_STRIPE_BYTES * 8> tail,
+                                 uint32_t tailBytes,
+                                 uint32_t totalBytes) {
+    ap_uint<32> hash;
+    if (totalBytes >= XXH32_STRIPE_BYTES) {
+        hash = xxh32Rotl(acc[0], 1) + xxh32Rotl(acc[1], 7) + xxh32Rotl(acc[2], 12) + xxh32Rotl(acc[3], 18);
+    } else {
+        hash = (ap_uint<32>)XXH32_PRIME5;
+    }
+    hash += totalBytes;
+
+    uint32_t idx = 0;
+xxh32_tail_word:
+    for (; idx + 4 <= tailBytes; idx += 4) {
+#pragma HLS LOOP_TRIPCOUNT min = 0 max = 3
+        ap_uint<32> word = tail.range(idx * 8 + 31, idx * 8);
+        hash += word * (ap_uint<32>)XXH32_PRIME3;
+        hash = xxh32Rotl(hash, 17) * (ap_uint<32>)XXH32_PRIME4;
+    }
+xxh32_tail_byte:
+    for (; idx < tailBytes; idx++) {
+#pragma HLS LOOP_TRIPCOUNT min = 0 max = 3
+        ap_uint<32> byte = tail.range(idx * 8 + 7, idx * 8);
+        hash += byte * (ap_uint<32>)XXH32_PRIME5;
+        hash = xxh32Rotl(hash, 11) * (ap_uint<32>)XXH32_PRIME1;
+    }
+
+    hash ^= hash >> 15;
+    hash *= (ap_uint<32>)XXH32_PRIME2;
+    hash ^= hash >> 13;
+    hash *= (ap_uint<32>)XXH32_PRIME3;
+    hash ^= hash >> 16;
+    return hash;
+}
+
+inline void xxh32Init(ap_uint<32> acc[4]) {
+#pragma HLS INLINE
+    acc[0] = (ap_uint<32>)XXH32_PRIME1 + (ap_uint<32>)XXH32_PRIME2;
+    acc[1] = (ap_uint<32>)XXH32_PRIME2;
+    acc[2] = 0;
+    acc[3] = (ap_uint<32>)0 - (ap_uint<32>)XXH32_PRIME1;
+}
+
+inline void xxh32Stripe(ap_uint<32> acc[4], ap_uint<XXH32_STRIPE_BYTES * 8> stripe) {
+#pragma HLS INLINE
+    for (int l = 0; l < 4; l++) {
+#pragma HLS UNROLL
+        acc[l] = xxh32Round(acc[l], stripe.range(l * 32 + 31, l * 32));
+    }
+}
+
+} // namespace details
+
+/**
+ * @brief xxHash32 (seed 0) of a raw block of known size. One 16 byte
+ * stripe is consumed per cycle, all four lanes are updated in parallel.
+ *
+ * @param inStream input stream of 16 byte stripes
+ * @param outStream output hash
+ * @param input_size input size in bytes
+ */
+inline void xxhash32(hls::stream<ap_uint<XXH32_STRIPE_BYTES * 8> >& inStream,
+                     hls::stream<ap_uint<32> >& outStream,
+                     uint32_t input_size) {
+    ap_uint<32> acc[4];
+#pragma HLS ARRAY_PARTITION variable = acc dim = 0 complete
+    details::xxh32Init(acc);
+
+    uint32_t stripes = input_size / XXH32_STRIPE_BYTES;
+    uint32_t tailBytes = input_size % XXH32_STRIPE_BYTES;
+
+xxh32_stripe:
+    for (uint32_t i = 0; i < stripes; i++) {
+#pragma HLS PIPELINE II = 1
+        details::xxh32Stripe(acc, inStream.read());
+    }
+
+    ap_uint<XXH32_STRIPE_BYTES * 8> tail = 0;
+    if (tailBytes) tail = inStream.read();
+
+    outStream << details::xxh32Finalize(acc, tail, tailBytes, input_size);
+}
+
+/**
+ * @brief xxHash32 (seed 0) of a byte stream terminated by end of stream
+ * flag, e.g., the compressed block emitted by lz4Compress. Bytes are
+ * gathered into stripes and hashed as soon as a stripe is complete.
+ *
+ * @param inStream input byte stream
+ * @param inStreamEos input end of stream flag
+ * @param outStream output hash
+ */
+inline void xxhash32Eos(hls::stream<ap_uint<8> >& inStream,
+                        hls::stream<bool>& inStreamEos,
+                        hls::stream<ap_uint<32> >& outStream) {
+    ap_uint<32> acc[4];
+#pragma HLS ARRAY_PARTITION variable = acc dim = 0 complete
+    details::xxh32Init(acc);
+
+    ap_uint<XXH32_STRIPE_BYTES * 8> stripe = 0;
+    uint32_t byteIdx = 0;
+    uint32_t totalBytes = 0;
+
+xxh32_eos_stripe:
+    for (bool eos = inStreamEos.read(); eos == false; eos = inStreamEos.read()) {
+#pragma HLS PIPELINE II = 1
+        stripe.range(byteIdx * 8 + 7, byteIdx * 8) = inStream.read();
+        totalBytes++;
+        if (byteIdx == XXH32_STRIPE_BYTES - 1) {
+            details::xxh32Stripe(acc, stripe);
+            byteIdx = 0;
+        } else {
+            byteIdx++;
+        }
+    }
+    // Dummy data paired with end of stream
+    inStream.read();
+
+    outStream << details::xxh32Finalize(acc, stripe, byteIdx, totalBytes);
+}
+
+} // namespace compression
+} // namespace xf
+
+#endif // _XFCOMPRESSION_XXHASH32_HPP_
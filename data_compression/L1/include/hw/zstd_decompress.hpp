@@ -0,0 +1,1011 @@
+/*
+ * (c) Copyright 2019 Xilinx, Inc. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef _XFCOMPRESSION_ZSTD_DECOMPRESS_HPP_
+#define _XFCOMPRESSION_ZSTD_DECOMPRESS_HPP_
+
+/**
+ * @file zstd_decompress.hpp
+ * @brief Header for modules used in zstd decompression kernel.
+ *
+ * This file is part of Vitis Data Compression Library.
+ */
+#include "hls_stream.h"
+
+#include <ap_int.h>
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+
+// Frame magic numbers
+#define ZSTD_MAGIC 0xFD2FB528
+#define ZSTD_SKIPPABLE_MAGIC 0x184D2A50
+#define ZSTD_SKIPPABLE_MASK 0xFFFFFFF0
+
+// Largest block carried by a frame
+#define ZSTD_BLOCK_SIZE_MAX (128 * 1024)
+
+// FSE table accuracy limits per symbol type
+#define ZSTD_LL_MAX_LOG 9
+#define ZSTD_ML_MAX_LOG 9
+#define ZSTD_OF_MAX_LOG 8
+#define ZSTD_HUF_WEIGHT_MAX_LOG 6
+
+// Symbol alphabet sizes
+#define ZSTD_LL_MAX_SYMBOL 35
+#define ZSTD_ML_MAX_SYMBOL 52
+#define ZSTD_OF_MAX_SYMBOL 31
+#define ZSTD_HUF_MAX_WEIGHT 11
+
+// Huffman codes of literals are at most 11 bits
+#define ZSTD_HUF_MAX_BITS 11
+
+// Decoder status codes
+#define ZSTD_OK 0
+#define ZSTD_ERR_MAGIC 1
+#define ZSTD_ERR_WINDOW 2
+#define ZSTD_ERR_DICTIONARY 3
+#define ZSTD_ERR_CORRUPT 4
+#define ZSTD_ERR_OVERFLOW 5
+
+namespace xf {
+namespace compression {
+
+/**
+ * FSE decoding table, one entry per state
+ */
+template <int MAX_LOG>
+struct zstdFseTable {
+    uint8_t symbol[1 << MAX_LOG];
+    uint8_t nbBits[1 << MAX_LOG];
+    uint16_t base[1 << MAX_LOG];
+    uint8_t accuracyLog;
+};
+
+/**
+ * Huffman decoding table of literals, indexed by the next maxBits bits
+ */
+struct zstdHufTable {
+    uint8_t symbol[1 << ZSTD_HUF_MAX_BITS];
+    uint8_t nbBits[1 << ZSTD_HUF_MAX_BITS];
+    uint8_t maxBits;
+};
+
+namespace details {
+
+// Predefined distributions (RFC 8878 section 3.1.1.3.2.2)
+const int16_t c_zstdLlDefaultNorm[36] = {4, 3, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 1, 1, 1, 2, 2,
+                                         2, 2, 2, 2, 2, 2, 2, 3, 2, 1, 1, 1, 1, 1, -1, -1, -1, -1};
+const int16_t c_zstdMlDefaultNorm[53] = {1, 4, 3, 2, 2, 2, 2, 2, 2, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+                                         1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+                                         1, 1, 1, 1, 1, 1, 1, 1, 1, 1, -1, -1, -1, -1, -1, -1, -1};
+const int16_t c_zstdOfDefaultNorm[29] = {1, 1, 1, 1, 1, 1, 2, 2, 2, 1, 1, 1, 1, 1, 1,
+                                         1, 1, 1, 1, 1, 1, 1, 1, 1, -1, -1, -1, -1, -1};
+
+// Literal length and match length codes: baseline and number of extra bits
+const uint32_t c_zstdLlBase[36] = {0,  1,  2,  3,  4,  5,  6,  7,   8,   9,   10,  11,   12,   13,   14,   15,   16,   18,
+                                   20, 22, 24, 28, 32, 40, 48, 64, 128, 256, 512, 1024, 2048, 4096, 8192, 16384, 32768, 65536};
+const uint8_t c_zstdLlBits[36] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,  0,  1,  1,
+                                  1, 1, 2, 2, 3, 3, 4, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16};
+const uint32_t c_zstdMlBase[53] = {3,  4,  5,  6,  7,  8,  9,  10,  11,  12,  13,  14,   15,   16,   17,   18,   19,   20,
+                                   21, 22, 23, 24, 25, 26, 27, 28,  29,  30,  31,  32,   33,   34,   35,   37,   39,   41,
+                                   43, 47, 51, 59, 67, 83, 99, 131, 259, 515, 1027, 2051, 4099, 8195, 16387, 32771, 65539};
+const uint8_t c_zstdMlBits[53] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,  0,  0,  0,  0,  0,  0,  0,  0,  0, 0,
+                                  0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 3, 3, 4, 4, 5, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16};
+
+inline uint32_t zstdHighBit(uint32_t value) {
+#pragma HLS INLINE
+    uint32_t bit = 0;
+    for (int i = 31; i > 0; i--) {
+#pragma HLS UNROLL
+        if ((value >> i) && bit == 0) bit = i;
+    }
+    return bit;
+}
+
+/**
+ * @brief Reads up to 32 bits, least significant bit first, starting at
+ * bit position bitPos of buf. Buffers are padded by 8 bytes so the
+ * 64bit window never runs past the array.
+ */
+inline uint32_t zstdPeekBits(const uint8_t* buf, uint32_t bitPos, uint32_t nbBits) {
+#pragma HLS INLINE
+    if (nbBits == 0) return 0;
+    uint32_t bytePos = bitPos >> 3;
+    uint64_t window = 0;
+    for (int i = 0; i < 8; i++) {
+#pragma HLS UNROLL
+        window |= (uint64_t)buf[bytePos + i] << (8 * i);
+    }
+    window >>= (bitPos & 7);
+    return (uint32_t)(window & (((uint64_t)1 << nbBits) - 1));
+}
+
+/**
+ * Bitstream read backward from its last byte, used by FSE and Huffman
+ * coded payloads. Bits below the first byte read as zero, overflow tells
+ * the stream has been consumed past its start.
+ */
+struct zstdBackStream {
+    int64_t bitPos;
+    int64_t startBit;
+};
+
+inline bool zstdBackInit(zstdBackStream& bs, const uint8_t* buf, uint32_t start, uint32_t end) {
+    if (end <= start) return false;
+    uint8_t last = buf[end - 1];
+    if (last == 0) return false;
+    bs.startBit = (int64_t)start * 8;
+    bs.bitPos = (int64_t)(end - 1) * 8 + zstdHighBit(last);
+    return true;
+}
+
+inline uint32_t zstdBackRead(zstdBackStream& bs, const uint8_t* buf, uint32_t nbBits) {
+#pragma HLS INLINE
+    bs.bitPos -= nbBits;
+    if (bs.bitPos >= bs.startBit) return zstdPeekBits(buf, (uint32_t)bs.bitPos, nbBits);
+    int64_t missing = bs.startBit - bs.bitPos;
+    if (missing >= nbBits) return 0;
+    return zstdPeekBits(buf, (uint32_t)bs.startBit, nbBits - (uint32_t)missing) << missing;
+}
+
+inline bool zstdBackOverflow(zstdBackStream& bs) {
+#pragma HLS INLINE
+    return bs.bitPos < bs.startBit;
+}
+
+/**
+ * @brief Spreads a normalized distribution over the FSE states.
+ *
+ * @param norm normalized counts, -1 marks a "less than 1" probability
+ * @param nbSymbols number of entries in norm
+ * @param accuracyLog table log
+ * @param table output decoding table
+ */
+template <int MAX_LOG>
+bool zstdFseBuildTable(const int16_t* norm, uint32_t nbSymbols, uint32_t accuracyLog, zstdFseTable<MAX_LOG>& table) {
+    const uint32_t tableSize = 1 << accuracyLog;
+    uint16_t nextState[256];
+    uint32_t highThreshold = tableSize;
+
+    table.accuracyLog = accuracyLog;
+fse_low_prob:
+    for (uint32_t s = 0; s < nbSymbols; s++) {
+#pragma HLS LOOP_TRIPCOUNT min = 1 max = 256
+        if (norm[s] == -1) {
+            table.symbol[--highThreshold] = s;
+            nextState[s] = 1;
+        } else {
+            nextState[s] = norm[s];
+        }
+    }
+
+    const uint32_t step = (tableSize >> 1) + (tableSize >> 3) + 3;
+    const uint32_t mask = tableSize - 1;
+    uint32_t position = 0;
+fse_spread:
+    for (uint32_t s = 0; s < nbSymbols; s++) {
+#pragma HLS LOOP_TRIPCOUNT min = 1 max = 256
+        for (int16_t i = 0; i < norm[s]; i++) {
+#pragma HLS LOOP_TRIPCOUNT min = 1 max = 512
+            table.symbol[position] = s;
+            do {
+                position = (position + step) & mask;
+            } while (position >= highThreshold);
+        }
+    }
+    if (position != 0) return false;
+
+fse_states:
+    for (uint32_t i = 0; i < tableSize; i++) {
+#pragma HLS LOOP_TRIPCOUNT min = 1 max = 512
+        uint8_t s = table.symbol[i];
+        uint32_t state = nextState[s]++;
+        uint8_t nbBits = accuracyLog - zstdHighBit(state);
+        table.nbBits[i] = nbBits;
+        table.base[i] = (state << nbBits) - tableSize;
+    }
+    return true;
+}
+
+/**
+ * @brief Reads an FSE table description (normalized counts) starting at
+ * byte pos and builds the decoding table. pos is moved past the description.
+ */
+template <int MAX_LOG>
+bool zstdFseReadTable(const uint8_t* buf,
+                      uint32_t& pos,
+                      uint32_t end,
+                      uint32_t maxSymbol,
+                      zstdFseTable<MAX_LOG>& table) {
+    int16_t norm[256];
+    uint32_t bitPos = pos * 8;
+
+    uint32_t accuracyLog = zstdPeekBits(buf, bitPos, 4) + 5;
+    bitPos += 4;
+    if (accuracyLog > MAX_LOG) return false;
+
+    int32_t remaining = (1 << accuracyLog) + 1;
+    int32_t threshold = 1 << accuracyLog;
+    uint32_t nbBits = accuracyLog + 1;
+    uint32_t symbol = 0;
+    bool previous0 = false;
+
+fse_read_count:
+    while (remaining > 1 && symbol <= maxSymbol) {
+#pragma HLS LOOP_TRIPCOUNT min = 1 max = 256
+        if (previous0) {
+            // Runs of zero probabilities, 2 bit repeat flags
+            uint32_t repeat;
+            do {
+                repeat = zstdPeekBits(buf, bitPos, 2);
+                bitPos += 2;
+                for (uint32_t r = 0; r < repeat && symbol <= maxSymbol; r++) norm[symbol++] = 0;
+            } while (repeat == 3);
+            if (symbol > maxSymbol) break;
+        }
+        int32_t max = (2 * threshold - 1) - remaining;
+        int32_t value = zstdPeekBits(buf, bitPos, nbBits);
+        int32_t count;
+        if ((value & (threshold - 1)) < max) {
+            count = value & (threshold - 1);
+            bitPos += nbBits - 1;
+        } else {
+            count = value & (2 * threshold - 1);
+            if (count >= threshold) count -= max;
+            bitPos += nbBits;
+        }
+        count--;
+        remaining -= count < 0 ? -count : count;
+        norm[symbol++] = count;
+        previous0 = (count == 0);
+        while (remaining < threshold) {
+            nbBits--;
+            threshold >>= 1;
+        }
+    }
+    if (remaining != 1 || symbol > maxSymbol + 1) return false;
+
+    pos = (bitPos + 7) >> 3;
+    if (pos > end) return false;
+    return zstdFseBuildTable<MAX_LOG>(norm, symbol, accuracyLog, table);
+}
+
+template <int MAX_LOG>
+void zstdFseRleTable(uint8_t symbol, zstdFseTable<MAX_LOG>& table) {
+    table.accuracyLog = 0;
+    table.symbol[0] = symbol;
+    table.nbBits[0] = 0;
+    table.base[0] = 0;
+}
+
+/**
+ * @brief Sets up the table of one sequence symbol type according to its
+ * compression mode: predefined, RLE, FSE compressed or repeat.
+ */
+template <int MAX_LOG>
+bool zstdFseSelectTable(uint32_t mode,
+                        const uint8_t* buf,
+                        uint32_t& pos,
+                        uint32_t end,
+                        const int16_t* defaultNorm,
+                        uint32_t defaultSymbols,
+                        uint32_t defaultLog,
+                        uint32_t maxSymbol,
+                        zstdFseTable<MAX_LOG>& table,
+                        bool& valid) {
+    if (mode == 0) {
+        valid = zstdFseBuildTable<MAX_LOG>(defaultNorm, defaultSymbols, defaultLog, table);
+    } else if (mode == 1) {
+        if (pos >= end || buf[pos] > maxSymbol) return false;
+        zstdFseRleTable<MAX_LOG>(buf[pos++], table);
+        valid = true;
+    } else if (mode == 2) {
+        valid = zstdFseReadTable<MAX_LOG>(buf, pos, end, maxSymbol, table);
+    }
+    // Repeat mode keeps the table of the previous block
+    return valid;
+}
+
+/**
+ * @brief Reads the Huffman tree description of a literals section and
+ * builds the decoding table. Weights are either stored as 4 bit values or
+ * FSE compressed with two interleaved states.
+ */
+inline bool zstdHufReadTable(const uint8_t* buf, uint32_t& pos, uint32_t end, zstdHufTable& table) {
+    uint8_t weight[256];
+    uint32_t nbWeights = 0;
+
+    if (pos >= end) return false;
+    uint32_t header = buf[pos++];
+    if (header < 128) {
+        uint32_t areaEnd = pos + header;
+        if (areaEnd > end) return false;
+        zstdFseTable<ZSTD_HUF_WEIGHT_MAX_LOG> weightTable;
+        uint32_t streamStart = pos;
+        if (!zstdFseReadTable<ZSTD_HUF_WEIGHT_MAX_LOG>(buf, streamStart, areaEnd, ZSTD_HUF_MAX_WEIGHT, weightTable))
+            return false;
+        zstdBackStream bs;
+        if (!zstdBackInit(bs, buf, streamStart, areaEnd)) return false;
+        uint32_t log = weightTable.accuracyLog;
+        uint32_t state1 = zstdBackRead(bs, buf, log);
+        uint32_t state2 = zstdBackRead(bs, buf, log);
+    huf_weights_fse:
+        while (true) {
+#pragma HLS LOOP_TRIPCOUNT min = 1 max = 128
+            if (nbWeights > 253) return false;
+            weight[nbWeights++] = weightTable.symbol[state1];
+            state1 = weightTable.base[state1] + zstdBackRead(bs, buf, weightTable.nbBits[state1]);
+            if (zstdBackOverflow(bs)) {
+                weight[nbWeights++] = weightTable.symbol[state2];
+                break;
+            }
+            weight[nbWeights++] = weightTable.symbol[state2];
+            state2 = weightTable.base[state2] + zstdBackRead(bs, buf, weightTable.nbBits[state2]);
+            if (zstdBackOverflow(bs)) {
+                weight[nbWeights++] = weightTable.symbol[state1];
+                break;
+            }
+        }
+        pos = areaEnd;
+    } else {
+        nbWeights = header - 127;
+        uint32_t bytes = (nbWeights + 1) / 2;
+        if (pos + bytes > end) return false;
+    huf_weights_direct:
+        for (uint32_t i = 0; i < nbWeights; i++) {
+#pragma HLS LOOP_TRIPCOUNT min = 1 max = 128
+            uint8_t packed = buf[pos + i / 2];
+            weight[i] = (i & 1) ? (packed & 0xF) : (packed >> 4);
+        }
+        pos += bytes;
+    }
+
+    // The weight of the last symbol is implied by the others
+    uint32_t total = 0;
+huf_weight_sum:
+    for (uint32_t i = 0; i < nbWeights; i++) {
+#pragma HLS LOOP_TRIPCOUNT min = 1 max = 255
+        if (weight[i] > ZSTD_HUF_MAX_WEIGHT) return false;
+        if (weight[i]) total += 1 << (weight[i] - 1);
+    }
+    if (total == 0) return false;
+    uint32_t maxBits = zstdHighBit(total) + 1;
+    uint32_t leftOver = (1 << maxBits) - total;
+    if (leftOver & (leftOver - 1)) return false;
+    if (maxBits > ZSTD_HUF_MAX_BITS) return false;
+    weight[nbWeights] = zstdHighBit(leftOver) + 1;
+    uint32_t nbSymbols = nbWeights + 1;
+
+    // Canonical code assignment, longest codes first
+    uint32_t rankCount[ZSTD_HUF_MAX_BITS + 1];
+    uint32_t rankIdx[ZSTD_HUF_MAX_BITS + 1];
+    for (uint32_t i = 0; i <= ZSTD_HUF_MAX_BITS; i++) {
+#pragma HLS UNROLL
+        rankCount[i] = 0;
+    }
+    for (uint32_t i = 0; i < nbSymbols; i++) {
+#pragma HLS LOOP_TRIPCOUNT min = 1 max = 256
+        if (weight[i]) rankCount[maxBits + 1 - weight[i]]++;
+    }
+
+    rankIdx[maxBits] = 0;
+huf_rank:
+    for (uint32_t len = maxBits; len >= 1; len--) {
+#pragma HLS LOOP_TRIPCOUNT min = 1 max = 11
+        rankIdx[len - 1] = rankIdx[len] + rankCount[len] * (1 << (maxBits - len));
+        for (uint32_t j = rankIdx[len]; j < rankIdx[len - 1]; j++) {
+#pragma HLS LOOP_TRIPCOUNT min = 1 max = 2048
+            table.nbBits[j] = len;
+        }
+    }
+    if (rankIdx[0] != (1U << maxBits)) return false;
+
+huf_fill:
+    for (uint32_t s = 0; s < nbSymbols; s++) {
+#pragma HLS LOOP_TRIPCOUNT min = 1 max = 256
+        if (weight[s]) {
+            uint32_t len = maxBits + 1 - weight[s];
+            uint32_t code = rankIdx[len];
+            uint32_t span = 1 << (maxBits - len);
+            for (uint32_t j = 0; j < span; j++) {
+#pragma HLS LOOP_TRIPCOUNT min = 1 max = 1024
+                table.symbol[code + j] = s;
+            }
+            rankIdx[len] += span;
+        }
+    }
+    table.maxBits = maxBits;
+    return true;
+}
+
+/**
+ * @brief Decodes one Huffman coded literal stream stored in [start, end)
+ * into count literals at lit + litPos.
+ */
+inline bool zstdHufDecodeStream(const uint8_t* buf,
+                                uint32_t start,
+                                uint32_t end,
+                                const zstdHufTable& table,
+                                uint8_t* lit,
+                                uint32_t litPos,
+                                uint32_t count) {
+    zstdBackStream bs;
+    if (!zstdBackInit(bs, buf, start, end)) return false;
+    const uint32_t maxBits = table.maxBits;
+    const uint32_t mask = (1 << maxBits) - 1;
+    uint32_t state = zstdBackRead(bs, buf, maxBits);
+huf_decode:
+    for (uint32_t i = 0; i < count; i++) {
+#pragma HLS LOOP_TRIPCOUNT min = 1 max = 32768
+#pragma HLS PIPELINE II = 1
+        uint32_t nbBits = table.nbBits[state];
+        lit[litPos + i] = table.symbol[state];
+        state = ((state << nbBits) + zstdBackRead(bs, buf, nbBits)) & mask;
+    }
+    // All payload bits consumed, only the state lookahead is left over
+    return bs.bitPos == bs.startBit - (int64_t)maxBits;
+}
+
+/**
+ * @brief Decodes the literals section of a compressed block into lit.
+ * pos is moved to the sequences section.
+ */
+inline bool zstdDecodeLiterals(const uint8_t* buf,
+                               uint32_t& pos,
+                               uint32_t end,
+                               zstdHufTable& hufTable,
+                               bool& hufValid,
+                               uint8_t* lit,
+                               uint32_t& litSize) {
+    if (pos >= end) return false;
+    uint32_t b0 = buf[pos];
+    uint32_t type = b0 & 3;
+    uint32_t sizeFormat = (b0 >> 2) & 3;
+
+    if (type < 2) {
+        // Raw or RLE literals
+        uint32_t regen;
+        if ((sizeFormat & 1) == 0) {
+            regen = b0 >> 3;
+            pos += 1;
+        } else if (sizeFormat == 1) {
+            regen = (b0 >> 4) + ((uint32_t)buf[pos + 1] << 4);
+            pos += 2;
+        } else {
+            regen = (b0 >> 4) + ((uint32_t)buf[pos + 1] << 4) + ((uint32_t)buf[pos + 2] << 12);
+            pos += 3;
+        }
+        if (regen > ZSTD_BLOCK_SIZE_MAX) return false;
+        if (type == 0) {
+            if (pos + regen > end) return false;
+        lit_raw:
+            for (uint32_t i = 0; i < regen; i++) {
+#pragma HLS LOOP_TRIPCOUNT min = 1 max = 131072
+#pragma HLS PIPELINE II = 1
+                lit[i] = buf[pos + i];
+            }
+            pos += regen;
+        } else {
+            if (pos + 1 > end) return false;
+            uint8_t value = buf[pos++];
+        lit_rle:
+            for (uint32_t i = 0; i < regen; i++) {
+#pragma HLS LOOP_TRIPCOUNT min = 1 max = 131072
+#pragma HLS PIPELINE II = 1
+                lit[i] = value;
+            }
+        }
+        litSize = regen;
+        return true;
+    }
+
+    // Huffman compressed or treeless literals
+    uint32_t headerBytes = (sizeFormat < 2) ? 3 : sizeFormat + 2;
+    uint32_t fieldBits = (sizeFormat < 2) ? 10 : (sizeFormat == 2 ? 14 : 18);
+    uint32_t nbStreams = (sizeFormat == 0) ? 1 : 4;
+    if (pos + headerBytes > end) return false;
+    uint64_t header = 0;
+    for (uint32_t i = 0; i < headerBytes; i++) header |= (uint64_t)buf[pos + i] << (8 * i);
+    uint32_t fieldMask = (1 << fieldBits) - 1;
+    uint32_t regen = (header >> 4) & fieldMask;
+    uint32_t compSize = (header >> (4 + fieldBits)) & fieldMask;
+    pos += headerBytes;
+    if (regen > ZSTD_BLOCK_SIZE_MAX || pos + compSize > end) return false;
+    uint32_t litEnd = pos + compSize;
+
+    if (type == 2) {
+        if (!zstdHufReadTable(buf, pos, litEnd, hufTable)) return false;
+        hufValid = true;
+    } else if (!hufValid) {
+        return false;
+    }
+
+    if (nbStreams == 1) {
+        if (!zstdHufDecodeStream(buf, pos, litEnd, hufTable, lit, 0, regen)) return false;
+    } else {
+        if (pos + 6 > litEnd) return false;
+        uint32_t size1 = buf[pos] | ((uint32_t)buf[pos + 1] << 8);
+        uint32_t size2 = buf[pos + 2] | ((uint32_t)buf[pos + 3] << 8);
+        uint32_t size3 = buf[pos + 4] | ((uint32_t)buf[pos + 5] << 8);
+        uint32_t start1 = pos + 6;
+        uint32_t start2 = start1 + size1;
+        uint32_t start3 = start2 + size2;
+        uint32_t start4 = start3 + size3;
+        uint32_t segment = (regen + 3) / 4;
+        if (start4 >= litEnd || 3 * segment > regen) return false;
+        if (!zstdHufDecodeStream(buf, start1, start2, hufTable, lit, 0, segment)) return false;
+        if (!zstdHufDecodeStream(buf, start2, start3, hufTable, lit, segment, segment)) return false;
+        if (!zstdHufDecodeStream(buf, start3, start4, hufTable, lit, 2 * segment, segment)) return false;
+        if (!zstdHufDecodeStream(buf, start4, litEnd, hufTable, lit, 3 * segment, regen - 3 * segment)) return false;
+    }
+    pos = litEnd;
+    litSize = regen;
+    return true;
+}
+
+inline void zstdEmitLiterals(const uint8_t* lit,
+                             uint32_t start,
+                             uint32_t count,
+                             hls::stream<ap_uint<64> >& outStream,
+                             hls::stream<bool>& outStreamEos) {
+zstd_emit_lit:
+    for (uint32_t i = 0; i < count; i++) {
+#pragma HLS LOOP_TRIPCOUNT min = 1 max = 131072
+#pragma HLS PIPELINE II = 1
+        outStream << (ap_uint<64>)lit[start + i];
+        outStreamEos << 0;
+    }
+}
+
+/**
+ * Decoder state carried from block to block within a frame
+ */
+struct zstdFrameState {
+    zstdHufTable hufTable;
+    zstdFseTable<ZSTD_LL_MAX_LOG> llTable;
+    zstdFseTable<ZSTD_OF_MAX_LOG> ofTable;
+    zstdFseTable<ZSTD_ML_MAX_LOG> mlTable;
+    bool hufValid;
+    bool llValid;
+    bool ofValid;
+    bool mlValid;
+    uint32_t repOffset[3];
+    uint64_t frameOut;
+    // Bytes emitted over all frames and the output buffer capacity
+    uint64_t totalOut;
+    uint64_t outputLimit;
+};
+
+/**
+ * @brief Decodes one compressed block held in buf and emits its literal
+ * and match tokens in the order they have to be executed.
+ *
+ * @tparam HISTORY_SIZE largest offset the sequence executor can reach
+ */
+template <int HISTORY_SIZE>
+uint32_t zstdDecodeBlock(const uint8_t* buf,
+                         uint32_t blockSize,
+                         uint8_t* lit,
+                         zstdFrameState& fs,
+                         hls::stream<ap_uint<64> >& outStream,
+                         hls::stream<bool>& outStreamEos) {
+    uint32_t pos = 0;
+    uint32_t litSize = 0;
+    if (!zstdDecodeLiterals(buf, pos, blockSize, fs.hufTable, fs.hufValid, lit, litSize)) return ZSTD_ERR_CORRUPT;
+
+    // Sequences section header
+    if (pos >= blockSize) return ZSTD_ERR_CORRUPT;
+    uint32_t nbSeq = buf[pos++];
+    if (nbSeq >= 128) {
+        if (nbSeq == 255) {
+            nbSeq = buf[pos] + ((uint32_t)buf[pos + 1] << 8) + 0x7F00;
+            pos += 2;
+        } else {
+            nbSeq = ((nbSeq - 128) << 8) + buf[pos];
+            pos += 1;
+        }
+    }
+    if (nbSeq == 0) {
+        if (fs.totalOut + litSize > fs.outputLimit) return ZSTD_ERR_OVERFLOW;
+        zstdEmitLiterals(lit, 0, litSize, outStream, outStreamEos);
+        fs.frameOut += litSize;
+        fs.totalOut += litSize;
+        return ZSTD_OK;
+    }
+
+    if (pos >= blockSize) return ZSTD_ERR_CORRUPT;
+    uint32_t modes = buf[pos++];
+    if (modes & 3) return ZSTD_ERR_CORRUPT;
+    if (!zstdFseSelectTable<ZSTD_LL_MAX_LOG>(modes >> 6, buf, pos, blockSize, c_zstdLlDefaultNorm, 36, 6,
+                                             ZSTD_LL_MAX_SYMBOL, fs.llTable, fs.llValid))
+        return ZSTD_ERR_CORRUPT;
+    if (!zstdFseSelectTable<ZSTD_OF_MAX_LOG>((modes >> 4) & 3, buf, pos, blockSize, c_zstdOfDefaultNorm, 29, 5,
+                                             ZSTD_OF_MAX_SYMBOL, fs.ofTable, fs.ofValid))
+        return ZSTD_ERR_CORRUPT;
+    if (!zstdFseSelectTable<ZSTD_ML_MAX_LOG>((modes >> 2) & 3, buf, pos, blockSize, c_zstdMlDefaultNorm, 53, 6,
+                                             ZSTD_ML_MAX_SYMBOL, fs.mlTable, fs.mlValid))
+        return ZSTD_ERR_CORRUPT;
+
+    zstdBackStream bs;
+    if (!zstdBackInit(bs, buf, pos, blockSize)) return ZSTD_ERR_CORRUPT;
+    uint32_t llState = zstdBackRead(bs, buf, fs.llTable.accuracyLog);
+    uint32_t ofState = zstdBackRead(bs, buf, fs.ofTable.accuracyLog);
+    uint32_t mlState = zstdBackRead(bs, buf, fs.mlTable.accuracyLog);
+
+    uint32_t litPos = 0;
+zstd_sequences:
+    for (uint32_t s = 0; s < nbSeq; s++) {
+#pragma HLS LOOP_TRIPCOUNT min = 1 max = 32768
+        uint32_t llCode = fs.llTable.symbol[llState];
+        uint32_t ofCode = fs.ofTable.symbol[ofState];
+        uint32_t mlCode = fs.mlTable.symbol[mlState];
+        if (llCode > ZSTD_LL_MAX_SYMBOL || mlCode > ZSTD_ML_MAX_SYMBOL || ofCode > ZSTD_OF_MAX_SYMBOL)
+            return ZSTD_ERR_CORRUPT;
+
+        // Extra bits are read offset first, then match length, then literal length
+        uint32_t ofValue = (1U << ofCode) + zstdBackRead(bs, buf, ofCode);
+        uint32_t matchLen = c_zstdMlBase[mlCode] + zstdBackRead(bs, buf, c_zstdMlBits[mlCode]);
+        uint32_t litLen = c_zstdLlBase[llCode] + zstdBackRead(bs, buf, c_zstdLlBits[llCode]);
+
+        // Repeat offsets
+        uint32_t offset;
+        if (ofValue > 3) {
+            offset = ofValue - 3;
+            fs.repOffset[2] = fs.repOffset[1];
+            fs.repOffset[1] = fs.repOffset[0];
+        } else {
+            uint32_t idx = ofValue - 1 + (litLen == 0 ? 1 : 0);
+            if (idx == 0) {
+                offset = fs.repOffset[0];
+            } else {
+                offset = (idx < 3) ? fs.repOffset[idx] : fs.repOffset[0] - 1;
+                if (idx > 1) fs.repOffset[2] = fs.repOffset[1];
+                fs.repOffset[1] = fs.repOffset[0];
+            }
+        }
+        fs.repOffset[0] = offset;
+
+        // State update order is literal length, match length, offset
+        if (s + 1 < nbSeq) {
+            llState = fs.llTable.base[llState] + zstdBackRead(bs, buf, fs.llTable.nbBits[llState]);
+            mlState = fs.mlTable.base[mlState] + zstdBackRead(bs, buf, fs.mlTable.nbBits[mlState]);
+            ofState = fs.ofTable.base[ofState] + zstdBackRead(bs, buf, fs.ofTable.nbBits[ofState]);
+        }
+
+        if (litPos + litLen > litSize) return ZSTD_ERR_CORRUPT;
+        if (fs.totalOut + litLen + matchLen > fs.outputLimit) return ZSTD_ERR_OVERFLOW;
+        zstdEmitLiterals(lit, litPos, litLen, outStream, outStreamEos);
+        litPos += litLen;
+        fs.frameOut += litLen;
+        fs.totalOut += litLen;
+
+        if (offset == 0 || offset > fs.frameOut) return ZSTD_ERR_CORRUPT;
+        if (offset > HISTORY_SIZE) return ZSTD_ERR_WINDOW;
+        ap_uint<64> token = ((uint64_t)matchLen << 32) | offset;
+        outStream << token;
+        outStreamEos << 0;
+        fs.frameOut += matchLen;
+        fs.totalOut += matchLen;
+    }
+    if (bs.bitPos != bs.startBit) return ZSTD_ERR_CORRUPT;
+
+    uint32_t lastLiterals = litSize - litPos;
+    if (fs.totalOut + lastLiterals > fs.outputLimit) return ZSTD_ERR_OVERFLOW;
+    zstdEmitLiterals(lit, litPos, lastLiterals, outStream, outStreamEos);
+    fs.frameOut += lastLiterals;
+    fs.totalOut += lastLiterals;
+    return ZSTD_OK;
+}
+
+template <int N>
+uint32_t zstdReadLE(hls::stream<ap_uint<8> >& inStream, uint32_t& consumed) {
+#pragma HLS INLINE
+    uint32_t value = 0;
+    for (int i = 0; i < N; i++) {
+        value |= (uint32_t)inStream.read() << (8 * i);
+    }
+    consumed += N;
+    return value;
+}
+
+} // namespace details
+
+/**
+ * @brief zstdFrameDecoder parses the zstd frames of the input and decodes
+ * their blocks. Raw and RLE blocks are forwarded as literals, compressed
+ * blocks are buffered, their literals section is decoded (raw, RLE or
+ * Huffman with 1 or 4 streams) and their FSE coded sequences are turned
+ * into literal and match tokens for zstdSequenceExecute. A token holds the
+ * match length in bits 63..32 and the offset in bits 31..0, a zero length
+ * marks a literal carried in bits 7..0. Skippable frames are dropped,
+ * frames referring to a dictionary are rejected.
+ *
+ * @tparam HISTORY_SIZE largest offset the sequence executor can reach
+ *
+ * @param inStream input compressed byte stream
+ * @param outStream output token stream
+ * @param outStreamEos output token end of stream flag
+ * @param status decoder status, ZSTD_OK on success
+ * @param input_size input size
+ * @param output_limit capacity of the output buffer
+ */
+template <int HISTORY_SIZE>
+void zstdFrameDecoder(hls::stream<ap_uint<8> >& inStream,
+                      hls::stream<ap_uint<64> >& outStream,
+                      hls::stream<bool>& outStreamEos,
+                      hls::stream<uint32_t>& status,
+                      uint32_t input_size,
+                      uint32_t output_limit) {
+    uint8_t blockBuf[ZSTD_BLOCK_SIZE_MAX + 8];
+    uint8_t litBuf[ZSTD_BLOCK_SIZE_MAX];
+    details::zstdFrameState fs;
+
+    uint32_t consumed = 0;
+    uint32_t state = ZSTD_OK;
+    fs.totalOut = 0;
+    fs.outputLimit = output_limit;
+
+zstd_frame:
+    while (state == ZSTD_OK && consumed + 4 <= input_size) {
+        uint32_t magic = details::zstdReadLE<4>(inStream, consumed);
+        if ((magic & ZSTD_SKIPPABLE_MASK) == ZSTD_SKIPPABLE_MAGIC) {
+            if (consumed + 4 > input_size) {
+                state = ZSTD_ERR_CORRUPT;
+                break;
+            }
+            uint32_t skip = details::zstdReadLE<4>(inStream, consumed);
+            if (skip > input_size - consumed) {
+                state = ZSTD_ERR_CORRUPT;
+                break;
+            }
+            for (uint32_t i = 0; i < skip; i++) inStream.read();
+            consumed += skip;
+            continue;
+        }
+        if (magic != ZSTD_MAGIC) {
+            state = ZSTD_ERR_MAGIC;
+            break;
+        }
+
+        // Frame header
+        if (consumed + 1 > input_size) {
+            state = ZSTD_ERR_CORRUPT;
+            break;
+        }
+        uint32_t descriptor = details::zstdReadLE<1>(inStream, consumed);
+        uint32_t fcsFlag = descriptor >> 6;
+        uint32_t singleSegment = (descriptor >> 5) & 1;
+        uint32_t checksumFlag = (descriptor >> 2) & 1;
+        uint32_t dictFlag = descriptor & 3;
+        uint32_t dictBytes = (dictFlag == 3) ? 4 : dictFlag;
+        uint32_t fcsBytes = (fcsFlag == 0) ? singleSegment : (1 << fcsFlag);
+        uint32_t headerBytes = (singleSegment ? 0 : 1) + dictBytes + fcsBytes;
+        if ((descriptor & 0x08) || consumed + headerBytes > input_size) {
+            state = ZSTD_ERR_CORRUPT;
+            break;
+        }
+        // Window size is enforced per match against HISTORY_SIZE
+        if (!singleSegment) details::zstdReadLE<1>(inStream, consumed);
+        uint32_t dictId = 0;
+        for (uint32_t i = 0; i < dictBytes; i++) dictId |= (uint32_t)inStream.read() << (8 * i);
+        consumed += dictBytes;
+        for (uint32_t i = 0; i < fcsBytes; i++) inStream.read();
+        consumed += fcsBytes;
+        if (dictId != 0) {
+            state = ZSTD_ERR_DICTIONARY;
+            break;
+        }
+
+        fs.hufValid = false;
+        fs.llValid = false;
+        fs.ofValid = false;
+        fs.mlValid = false;
+        fs.repOffset[0] = 1;
+        fs.repOffset[1] = 4;
+        fs.repOffset[2] = 8;
+        fs.frameOut = 0;
+
+        bool lastBlock = false;
+    zstd_block:
+        while (!lastBlock && state == ZSTD_OK) {
+            if (consumed + 3 > input_size) {
+                state = ZSTD_ERR_CORRUPT;
+                break;
+            }
+            uint32_t blockHeader = details::zstdReadLE<3>(inStream, consumed);
+            lastBlock = blockHeader & 1;
+            uint32_t blockType = (blockHeader >> 1) & 3;
+            uint32_t blockSize = blockHeader >> 3;
+            uint32_t payload = (blockType == 1) ? 1 : blockSize;
+
+            if (blockType == 3 || blockSize > ZSTD_BLOCK_SIZE_MAX || payload > input_size - consumed) {
+                state = ZSTD_ERR_CORRUPT;
+            } else if (blockType != 2 && fs.totalOut + blockSize > fs.outputLimit) {
+                state = ZSTD_ERR_OVERFLOW;
+            } else if (blockType == 0) {
+            zstd_raw_block:
+                for (uint32_t i = 0; i < blockSize; i++) {
+#pragma HLS LOOP_TRIPCOUNT min = 1 max = 131072
+#pragma HLS PIPELINE II = 1
+                    outStream << (ap_uint<64>)inStream.read();
+                    outStreamEos << 0;
+                }
+                consumed += blockSize;
+                fs.frameOut += blockSize;
+                fs.totalOut += blockSize;
+            } else if (blockType == 1) {
+                ap_uint<64> value = inStream.read();
+                consumed += 1;
+            zstd_rle_block:
+                for (uint32_t i = 0; i < blockSize; i++) {
+#pragma HLS LOOP_TRIPCOUNT min = 1 max = 131072
+#pragma HLS PIPELINE II = 1
+                    outStream << value;
+                    outStreamEos << 0;
+                }
+                fs.frameOut += blockSize;
+                fs.totalOut += blockSize;
+            } else {
+            zstd_load_block:
+                for (uint32_t i = 0; i < blockSize; i++) {
+#pragma HLS LOOP_TRIPCOUNT min = 1 max = 131072
+#pragma HLS PIPELINE II = 1
+                    blockBuf[i] = inStream.read();
+                }
+                for (uint32_t i = 0; i < 8; i++) blockBuf[blockSize + i] = 0;
+                consumed += blockSize;
+                state = details::zstdDecodeBlock<HISTORY_SIZE>(blockBuf, blockSize, litBuf, fs, outStream, outStreamEos);
+            }
+        }
+
+        if (state == ZSTD_OK && checksumFlag) {
+            // Content checksum (XXH64) is verified by the host
+            if (consumed + 4 > input_size) {
+                state = ZSTD_ERR_CORRUPT;
+            } else {
+                details::zstdReadLE<4>(inStream, consumed);
+            }
+        }
+    }
+    if (state == ZSTD_OK && consumed != input_size) state = ZSTD_ERR_CORRUPT;
+
+// Drop whatever is left of the input after an error
+zstd_drain:
+    for (; consumed < input_size; consumed++) inStream.read();
+
+    outStream << 0;
+    outStreamEos << 1;
+    status << state;
+}
+
+/**
+ * @brief zstdSequenceExecute reconstructs the output from the literal and
+ * match tokens of zstdFrameDecoder, one byte per cycle. It follows the
+ * history buffer scheme of lzDecompressZlibEos, the token carries a 32bit
+ * offset as zstd windows go far beyond the 16bit offsets of compressd_dt.
+ *
+ * @tparam HISTORY_SIZE history buffer size, power of 2
+ * @tparam LOW_OFFSET offsets up to this value are served from registers
+ *
+ * @param inStream input token stream
+ * @param inStreamEos input token end of stream flag
+ * @param outStream output byte stream
+ * @param outStreamEos output end of stream flag
+ * @param outSize output size
+ */
+template <int HISTORY_SIZE, int LOW_OFFSET>
+void zstdSequenceExecute(hls::stream<ap_uint<64> >& inStream,
+                         hls::stream<bool>& inStreamEos,
+                         hls::stream<ap_uint<8> >& outStream,
+                         hls::stream<bool>& outStreamEos,
+                         hls::stream<uint32_t>& outSize) {
+    ap_uint<8> local_buf[HISTORY_SIZE];
+#pragma HLS RESOURCE variable = local_buf core = XPM_MEMORY uram
+    ap_uint<8> prevValue[LOW_OFFSET];
+#pragma HLS ARRAY_PARTITION variable = prevValue dim = 0 complete
+
+    uint32_t out_cntr = 0;
+    uint32_t match_len = 0;
+    uint32_t match_offset = 0;
+    uint32_t match_loc = 0;
+    bool done = false;
+
+zstd_execute:
+    while (!done) {
+#pragma HLS PIPELINE II = 1
+#pragma HLS DEPENDENCE variable = local_buf inter false
+        ap_uint<8> outValue = 0;
+        bool valid = true;
+        if (match_len == 0) {
+            bool eos = inStreamEos.read();
+            uint64_t token = inStream.read();
+            if (eos) {
+                done = true;
+                valid = false;
+            } else if ((token >> 32) == 0) {
+                outValue = token & 0xFF;
+            } else {
+                match_len = token >> 32;
+                match_offset = (uint32_t)token;
+                match_loc = out_cntr - match_offset;
+            }
+        }
+        if (valid && match_len) {
+            if (match_offset <= LOW_OFFSET) {
+                outValue = prevValue[match_offset - 1];
+            } else {
+                outValue = local_buf[match_loc % HISTORY_SIZE];
+            }
+            match_loc++;
+            match_len--;
+        }
+        if (valid) {
+            local_buf[out_cntr % HISTORY_SIZE] = outValue;
+            for (int k = LOW_OFFSET - 1; k > 0; k--) {
+#pragma HLS UNROLL
+                prevValue[k] = prevValue[k - 1];
+            }
+            prevValue[0] = outValue;
+            outStream << outValue;
+            outStreamEos << 0;
+            out_cntr++;
+        }
+    }
+
+    outStream << 0;
+    outStreamEos << 1;
+    outSize << out_cntr;
+}
+
+/**
+ * @brief zstdDecompressCore decodes a stream of zstd frames. Frame and
+ * block parsing, entropy decoding and sequence execution run as a dataflow
+ * pipeline connected by the token stream.
+ *
+ * @tparam HISTORY_SIZE history buffer size, bounds the usable window
+ * @tparam LOW_OFFSET offsets up to this value are served from registers
+ *
+ * @param inStream input compressed byte stream
+ * @param outStream output byte stream
+ * @param outStreamEos output end of stream flag
+ * @param outSize output size
+ * @param status decoder status, ZSTD_OK on success
+ * @param input_size input size
+ * @param output_limit capacity of the output buffer
+ */
+template <int HISTORY_SIZE, int LOW_OFFSET>
+void zstdDecompressCore(hls::stream<ap_uint<8> >& inStream,
+                        hls::stream<ap_uint<8> >& outStream,
+                        hls::stream<bool>& outStreamEos,
+                        hls::stream<uint32_t>& outSize,
+                        hls::stream<uint32_t>& status,
+                        uint32_t input_size,
+                        uint32_t output_limit) {
+    hls::stream<ap_uint<64> > tokenStream("tokenStream");
+    hls::stream<bool> tokenStreamEos("tokenStreamEos");
+#pragma HLS STREAM variable = tokenStream depth = 32
+#pragma HLS STREAM variable = tokenStreamEos depth = 32
+
+#pragma HLS dataflow
+    zstdFrameDecoder<HISTORY_SIZE>(inStream, tokenStream, tokenStreamEos, status, input_size, output_limit);
+    zstdSequenceExecute<HISTORY_SIZE, LOW_OFFSET>(tokenStream, tokenStreamEos, outStream, outStreamEos, outSize);
+}
+
+} // namespace compression
+} // namespace xf
+
+#endif // _XFCOMPRESSION_ZSTD_DECOMPRESS_HPP_
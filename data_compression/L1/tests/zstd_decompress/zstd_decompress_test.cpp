@@ -0,0 +1,102 @@
+/*
+ * Copyright 2019 Xilinx, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "zstd_decompress.hpp"
+#include <fstream>
+#include <iostream>
+#include <stdlib.h>
+#include <string>
+
+#define ZSTD_WINDOW_LOG 17
+#define HISTORY_SIZE (1 << ZSTD_WINDOW_LOG)
+#define LOW_OFFSET 10
+#define OUTPUT_LIMIT (1 << 24)
+
+void zstdDecompressEngineRun(hls::stream<ap_uint<8> >& inStream,
+                             hls::stream<ap_uint<8> >& outStream,
+                             hls::stream<bool>& outStreamEos,
+                             hls::stream<uint32_t>& outSize,
+                             hls::stream<uint32_t>& status,
+                             const uint32_t input_size,
+                             const uint32_t output_limit) {
+    xf::compression::zstdDecompressCore<HISTORY_SIZE, LOW_OFFSET>(inStream, outStream, outStreamEos, outSize, status,
+                                                                  input_size, output_limit);
+}
+
+int main(int argc, char* argv[]) {
+    hls::stream<ap_uint<8> > dec_bytestr_in("decompressIn");
+    hls::stream<ap_uint<8> > dec_bytestr_out("decompressOut");
+    hls::stream<bool> dec_eos_out("decompressEos");
+    hls::stream<uint32_t> dec_size_out("decompressSize");
+    hls::stream<uint32_t> dec_status("decompressStatus");
+
+    std::ifstream originalFile;
+    std::ifstream inputFile;
+
+    inputFile.open(argv[1], std::ifstream::binary);
+    if (!inputFile.is_open()) {
+        printf("Cannot open the compressed file!!\n");
+        exit(1);
+    }
+    inputFile.seekg(0, std::ios::end);
+    uint32_t comp_length = (uint32_t)inputFile.tellg();
+    inputFile.seekg(0, std::ios::beg);
+    for (uint32_t i = 0; i < comp_length; i++) {
+        uint8_t x;
+        inputFile.read((char*)&x, 1);
+        dec_bytestr_in << x;
+    }
+
+    // DECOMPRESSION CALL
+    zstdDecompressEngineRun(dec_bytestr_in, dec_bytestr_out, dec_eos_out, dec_size_out, dec_status, comp_length,
+                            OUTPUT_LIMIT);
+
+    originalFile.open(argv[2], std::ifstream::binary);
+    if (!originalFile.is_open()) {
+        printf("Cannot open the original file!!\n");
+        exit(1);
+    }
+    originalFile.seekg(0, std::ios::end);
+    uint32_t original_length = (uint32_t)originalFile.tellg();
+    originalFile.seekg(0, std::ios::beg);
+
+    bool pass = true;
+    uint32_t outputsize = 0;
+    for (bool eos = dec_eos_out.read(); !eos; eos = dec_eos_out.read()) {
+        uint8_t s = dec_bytestr_out.read();
+        uint8_t t = 0;
+        if (outputsize < original_length) originalFile.read((char*)&t, 1);
+        if (outputsize++ >= original_length || s != t) pass = false;
+    }
+    uint32_t status = dec_status.read();
+    uint32_t reported_size = dec_size_out.read();
+    if (status != ZSTD_OK || outputsize != original_length || reported_size != original_length) pass = false;
+
+    if (pass) {
+        printf(
+            "\n-----TEST PASSED: Original file and the file after decompression "
+            "are same.-------\n");
+    } else {
+        printf(
+            "\n-----TEST FAILED: The input file and the file after "
+            "decompression are not similar (status %u, %u of %u bytes)!-----\n",
+            status, outputsize, original_length);
+    }
+    printf("\n");
+    originalFile.close();
+    inputFile.close();
+    return pass ? 0 : 1;
+}
@@ -38,6 +38,7 @@
 #include "stream_upsizer.hpp"
 
 #include "lz4_compress.hpp"
+#include "xxhash32.hpp"
 
 #define MIN_BLOCK_SIZE 128
 #define GMEM_DWIDTH 512
@@ -60,20 +61,29 @@
 extern "C" {
 /**
  * @brief LZ4 compression kernel takes the raw data as input and compresses the data
- * in block based fashion and writes the output to global memory.
+ * in block based fashion and writes the output to global memory. xxHash32 of
+ * every raw and compressed block is computed in parallel for LZ4 frame
+ * block checksums. Every block may be compressed against a preset
+ * dictionary of up to 64 KB which is kept resident per compute unit.
  *
  * @param in input raw data
  * @param out output compressed data
  * @param compressd_size compressed output size of each block
  * @param in_block_size input block size of each block
+ * @param block_checksum raw (even index) and compressed (odd index) xxHash32 of each block
+ * @param dict preset dictionary
  * @param block_size_in_kb input block size in bytes
  * @param input_size input data size
+ * @param dict_size preset dictionary size, 0 for none
  */
 void xilLz4Compress(const xf::compression::uintMemWidth_t* in,
                     xf::compression::uintMemWidth_t* out,
                     uint32_t* compressd_size,
                     uint32_t* in_block_size,
+                    uint32_t* block_checksum,
+                    const xf::compression::uintMemWidth_t* dict,
                     uint32_t block_size_in_kb,
-                    uint32_t input_size);
+                    uint32_t input_size,
+                    uint32_t dict_size);
 }
 #endif
@@ -55,21 +55,26 @@ extern "C" {
 
 /**
  * @brief LZ4 decompression kernel takes compressed data as input and process in
- * block based fashion and writes the raw data to global memory.
+ * block based fashion and writes the raw data to global memory. The history
+ * of every block is preloaded with the preset dictionary, if any.
  *
  * @param in input compressed data
  * @param out output raw data
  * @param in_block_size input block size of each block
  * @param in_compress_size compress size of each block
+ * @param dict preset dictionary
  * @param block_size_in_kb block size in bytes
  * @param no_blocks number of blocks
+ * @param dict_size preset dictionary size, 0 for none
  */
 void xilLz4Decompress(const xf::compression::uintMemWidth_t* in,
                       xf::compression::uintMemWidth_t* out,
                       uint32_t* in_block_size,
                       uint32_t* in_compress_size,
+                      const xf::compression::uintMemWidth_t* dict,
                       uint32_t block_size_in_kb,
-                      uint32_t no_blocks);
+                      uint32_t no_blocks,
+                      uint32_t dict_size);
 }
 
 #endif
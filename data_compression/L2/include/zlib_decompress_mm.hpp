@@ -56,11 +56,14 @@ extern "C" {
  * @param in input stream
  * @param out output stream
  * @param encoded_size decompressed size output
+ * @param end_size input bytes up to the end of the final deflate block,
+ * 0 when the input ends before it
  * @param input_size input size
  */
 void xilDecompressZlib(xf::compression::uintMemWidth_t* in,
                        xf::compression::uintMemWidth_t* out,
                        uint32_t* encoded_size,
+                       uint32_t* end_size,
                        uint32_t input_size);
 }
 
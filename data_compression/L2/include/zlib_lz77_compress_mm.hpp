@@ -28,6 +28,7 @@
 #include "zlib_config.hpp"
 #include "lz_compress.hpp"
 #include "lz_optional.hpp"
+#include "crc32.hpp"
 #include "stream_downsizer.hpp"
 #include "stream_upsizer.hpp"
 #include "mm2s.hpp"
@@ -58,10 +59,31 @@
 #define MATCH_LEN 6
 //#define MIN_MATCH 4
 
+// Compression level 1-9 the kernel is built for, levels are grouped
+// into fast (1-3), default (4-6) and best (7-9) configurations
+#ifndef ZLIB_LEVEL
+#define ZLIB_LEVEL 6
+#endif
+
+#if ZLIB_LEVEL <= 3
+// Short hash chain, greedy matching
+#define MATCH_LEVEL 2
+#define LAZY_DEPTH 0
+#elif ZLIB_LEVEL <= 6
 #define MATCH_LEVEL 6
+#define LAZY_DEPTH 0
+#else
+// Deep hash chain, lazy matching over the next two positions
+#define MATCH_LEVEL 12
+#define LAZY_DEPTH 2
+#endif
+
 #define DICT_ELE_WIDTH (MATCH_LEN * BIT + 24)
 #define OUT_BYTES (4)
 
+// Bytes folded into CRC32 per cycle
+#define CRC_PARALLEL_BYTE 8
+
 #define MAX_MATCH 258
 #define MIN_MATCH 3
 #define LENGTH_CODES 29
@@ -76,7 +98,10 @@ extern "C" {
  * represented in packet form of 32bit length <Literal, Match Length, Distance>.
  * It also generates output of literal and distance frequencies for dynamic
  * huffman tree generation. The output generated by this kernel is referred by
- * TreeGen and Huffman Kernels.
+ * TreeGen and Huffman Kernels. CRC32 of each raw input block is computed in
+ * parallel to LZ77 and written to checksum for the gzip trailer. Hash
+ * chain depth and lazy matching follow the ZLIB_LEVEL the kernel is
+ * built for.
  *
  * @param in input stream
  * @param out output stream
@@ -84,6 +109,7 @@ extern "C" {
  * @param in_block_size input block size of each block
  * @param dyn_ltree_freq literal frequency data
  * @param dyn_dtree_freq distance frequency data
+ * @param checksum CRC32 of each input block
  * @param block_size_in_kb input block size in bytes
  * @param input_size input data size
  *
@@ -94,6 +120,7 @@ void xilLz77Compress(const xf::compression::uintMemWidth_t* in,
                      uint32_t* in_block_size,
                      uint32_t* dyn_ltree_freq,
                      uint32_t* dyn_dtree_freq,
+                     uint32_t* checksum,
                      uint32_t block_size_in_kb,
                      uint32_t input_size);
 }
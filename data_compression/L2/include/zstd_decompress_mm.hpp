@@ -0,0 +1,66 @@
+/*
+ * (c) Copyright 2019 Xilinx, Inc. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef _XFCOMPRESSION_ZSTD_DECOMPRESS_MM_HPP_
+#define _XFCOMPRESSION_ZSTD_DECOMPRESS_MM_HPP_
+
+/**
+ * @file zstd_decompress_mm.hpp
+ * @brief Header for zstd decompression kernel.
+ *
+ * This file is part of Vitis Data Compression Library.
+ */
+#include "zstd_decompress.hpp"
+#include "mm2s.hpp"
+#include "s2mm.hpp"
+#include "stream_upsizer.hpp"
+#include "stream_downsizer.hpp"
+
+#include <stdio.h>
+#include <stdint.h>
+#include <assert.h>
+#include "hls_stream.h"
+#include <ap_int.h>
+
+// History buffer bounds the largest match offset (2MB window)
+#ifndef ZSTD_WINDOW_LOG
+#define ZSTD_WINDOW_LOG 21
+#endif
+#define HISTORY_SIZE (1 << ZSTD_WINDOW_LOG)
+#define LOW_OFFSET 10
+
+extern "C" {
+/**
+ * @brief Zstd decompression kernel top function. It decodes a buffer of
+ * zstd frames: frame and block parsing, Huffman literal decoding, FSE
+ * sequence decoding and sequence execution over a history buffer.
+ *
+ * @param in input stream
+ * @param out output stream
+ * @param encoded_size decompressed size output
+ * @param status decoder status output, ZSTD_OK on success
+ * @param input_size input size
+ * @param output_size capacity of the output buffer
+ */
+void xilZstdDecompress(xf::compression::uintMemWidth_t* in,
+                       xf::compression::uintMemWidth_t* out,
+                       uint32_t* encoded_size,
+                       uint32_t* status,
+                       uint32_t input_size,
+                       uint32_t output_size);
+}
+
+#endif // _XFCOMPRESSION_ZSTD_DECOMPRESS_MM_HPP_
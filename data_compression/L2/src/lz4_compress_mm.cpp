@@ -29,15 +29,95 @@ const int c_lz4MaxLiteralCount = MAX_LIT_COUNT;
 
 // namespace hw_compress {
 
+void lz4OutDup(hls::stream<ap_uint<8> >& inStream,
+               hls::stream<bool>& inStreamEos,
+               hls::stream<ap_uint<8> >& outStream,
+               hls::stream<bool>& outStreamEos,
+               hls::stream<ap_uint<8> >& hashStream,
+               hls::stream<bool>& hashStreamEos) {
+lz4_out_dup:
+    for (bool eos = false; eos == false;) {
+#pragma HLS PIPELINE II = 1
+        ap_uint<8> outValue = inStream.read();
+        eos = inStreamEos.read();
+        outStream << outValue;
+        outStreamEos << eos;
+        hashStream << outValue;
+        hashStreamEos << eos;
+    }
+}
+
+void lz4InputDup(hls::stream<xf::compression::uintMemWidth_t>& inStream,
+                 hls::stream<xf::compression::uintMemWidth_t>& outStream,
+                 hls::stream<xf::compression::uintMemWidth_t>& hashStream,
+                 uint32_t input_size) {
+    const uint32_t c_wordBytes = GMEM_DWIDTH / 8;
+    uint32_t sizeV = (input_size == 0) ? 0 : ((input_size - 1) / c_wordBytes + 1);
+lz4_input_dup:
+    for (uint32_t i = 0; i < sizeV; i++) {
+#pragma HLS PIPELINE II = 1
+        xf::compression::uintMemWidth_t inValue = inStream.read();
+        outStream << inValue;
+        hashStream << inValue;
+    }
+}
+
+void lz4DictDup(hls::stream<ap_uint<BIT> >& inStream,
+                hls::stream<ap_uint<BIT> >& lzStream,
+                hls::stream<ap_uint<BIT> >& boosterStream,
+                uint32_t dict_size) {
+lz4_dict_dup:
+    for (uint32_t i = 0; i < dict_size; i++) {
+#pragma HLS PIPELINE II = 1
+        ap_uint<BIT> inValue = inStream.read();
+        lzStream << inValue;
+        boosterStream << inValue;
+    }
+}
+
+void lz4RawHash(hls::stream<xf::compression::uintMemWidth_t>& inStream512,
+                hls::stream<ap_uint<32> >& hashOut,
+                uint32_t input_size) {
+    uint32_t input_size1 = input_size;
+    hls::stream<ap_uint<XXH32_STRIPE_BYTES * 8> > stripeStream("stripeStream");
+#pragma HLS STREAM variable = stripeStream depth = 8
+#pragma HLS RESOURCE variable = stripeStream core = FIFO_SRL
+
+#pragma HLS dataflow
+    xf::compression::streamDownsizer<uint32_t, GMEM_DWIDTH, XXH32_STRIPE_BYTES * 8>(inStream512, stripeStream,
+                                                                                   input_size);
+    xf::compression::xxhash32(stripeStream, hashOut, input_size1);
+}
+
+void lz4HashCollect(hls::stream<ap_uint<32> > rawHash[PARALLEL_BLOCK],
+                    hls::stream<ap_uint<32> > compHash[PARALLEL_BLOCK],
+                    uint32_t raw_hash[PARALLEL_BLOCK],
+                    uint32_t comp_hash[PARALLEL_BLOCK]) {
+    for (uint8_t i = 0; i < PARALLEL_BLOCK; i++) {
+#pragma HLS PIPELINE II = 1
+        raw_hash[i] = rawHash[i].read();
+        comp_hash[i] = compHash[i].read();
+    }
+}
+
 void lz4Core(hls::stream<xf::compression::uintMemWidth_t>& inStreamMemWidth,
+             hls::stream<xf::compression::uintMemWidth_t>& dictStreamMemWidth,
              hls::stream<xf::compression::uintMemWidth_t>& outStreamMemWidth,
              hls::stream<bool>& outStreamMemWidthEos,
              hls::stream<uint32_t>& compressedSize,
+             hls::stream<ap_uint<32> >& compHash,
              uint32_t max_lit_limit[PARALLEL_BLOCK],
              uint32_t input_size,
+             uint32_t dict_size,
              uint32_t core_idx) {
     uint32_t left_bytes = 64;
+    uint32_t dict_size1 = dict_size;
+    uint32_t dict_size2 = dict_size;
+    uint32_t dict_size3 = dict_size;
     hls::stream<ap_uint<BIT> > inStream("inStream");
+    hls::stream<ap_uint<BIT> > dictStream("dictStream");
+    hls::stream<ap_uint<BIT> > lzDictStream("lzDictStream");
+    hls::stream<ap_uint<BIT> > boosterDictStream("boosterDictStream");
     hls::stream<xf::compression::compressd_dt> compressdStream("compressdStream");
     hls::stream<xf::compression::compressd_dt> bestMatchStream("bestMatchStream");
     hls::stream<xf::compression::compressd_dt> boosterStream("boosterStream");
@@ -45,7 +125,14 @@ void lz4Core(hls::stream<xf::compression::uintMemWidth_t>& inStreamMemWidth,
     hls::stream<xf::compression::lz4_compressd_dt> lenOffsetOut("lenOffsetOut");
     hls::stream<ap_uint<8> > lz4Out("lz4Out");
     hls::stream<bool> lz4Out_eos("lz4Out_eos");
+    hls::stream<ap_uint<8> > packOut("packOut");
+    hls::stream<bool> packOut_eos("packOut_eos");
+    hls::stream<ap_uint<8> > hashOut("hashOut");
+    hls::stream<bool> hashOut_eos("hashOut_eos");
 #pragma HLS STREAM variable = inStream depth = 8
+#pragma HLS STREAM variable = dictStream depth = 8
+#pragma HLS STREAM variable = lzDictStream depth = 8
+#pragma HLS STREAM variable = boosterDictStream depth = 8
 #pragma HLS STREAM variable = compressdStream depth = 8
 #pragma HLS STREAM variable = bestMatchStream depth = 8
 #pragma HLS STREAM variable = boosterStream depth = 8
@@ -53,26 +140,44 @@ void lz4Core(hls::stream<xf::compression::uintMemWidth_t>& inStreamMemWidth,
 #pragma HLS STREAM variable = lenOffsetOut depth = c_gmemBurstSize
 #pragma HLS STREAM variable = lz4Out depth = 8
 #pragma HLS STREAM variable = lz4Out_eos depth = 8
+#pragma HLS STREAM variable = packOut depth = 8
+#pragma HLS STREAM variable = packOut_eos depth = 8
+#pragma HLS STREAM variable = hashOut depth = 8
+#pragma HLS STREAM variable = hashOut_eos depth = 8
 
 #pragma HLS RESOURCE variable = inStream core = FIFO_SRL
+#pragma HLS RESOURCE variable = dictStream core = FIFO_SRL
+#pragma HLS RESOURCE variable = lzDictStream core = FIFO_SRL
+#pragma HLS RESOURCE variable = boosterDictStream core = FIFO_SRL
 #pragma HLS RESOURCE variable = compressdStream core = FIFO_SRL
 #pragma HLS RESOURCE variable = boosterStream core = FIFO_SRL
 #pragma HLS RESOURCE variable = lenOffsetOut core = FIFO_SRL
 #pragma HLS RESOURCE variable = lz4Out core = FIFO_SRL
 #pragma HLS RESOURCE variable = lz4Out_eos core = FIFO_SRL
+#pragma HLS RESOURCE variable = packOut core = FIFO_SRL
+#pragma HLS RESOURCE variable = packOut_eos core = FIFO_SRL
+#pragma HLS RESOURCE variable = hashOut core = FIFO_SRL
+#pragma HLS RESOURCE variable = hashOut_eos core = FIFO_SRL
 
 #pragma HLS dataflow
+    xf::compression::streamDownsizer<uint32_t, GMEM_DWIDTH, 8>(dictStreamMemWidth, dictStream, dict_size);
+    // Preset dictionary feeds both the hash dictionary and the booster window
+    lz4DictDup(dictStream, lzDictStream, boosterDictStream, dict_size1);
     xf::compression::streamDownsizer<uint32_t, GMEM_DWIDTH, 8>(inStreamMemWidth, inStream, input_size);
-    xf::compression::lzCompress<MATCH_LEN, MATCH_LEVEL, LZ_DICT_SIZE, BIT, MIN_OFFSET, MIN_MATCH, LZ_MAX_OFFSET_LIMIT>(
-        inStream, compressdStream, input_size, left_bytes);
+    xf::compression::lzCompressDict<MATCH_LEN, MATCH_LEVEL, LZ_DICT_SIZE, BIT, MIN_OFFSET, MIN_MATCH,
+                                    LZ_MAX_OFFSET_LIMIT>(inStream, lzDictStream, compressdStream, input_size,
+                                                         left_bytes, dict_size2);
     xf::compression::lzBestMatchFilter<MATCH_LEN, OFFSET_WINDOW>(compressdStream, bestMatchStream, input_size,
                                                                  left_bytes);
-    xf::compression::lzBooster<MAX_MATCH_LEN, BOOSTER_OFFSET_WINDOW>(bestMatchStream, boosterStream, input_size,
-                                                                     left_bytes);
+    xf::compression::lzBoosterDict<MAX_MATCH_LEN, BOOSTER_OFFSET_WINDOW>(
+        bestMatchStream, boosterDictStream, boosterStream, input_size, left_bytes, dict_size3);
     xf::compression::lz4Divide<MAX_LIT_COUNT, PARALLEL_BLOCK>(boosterStream, litOut, lenOffsetOut, input_size,
                                                               max_lit_limit, core_idx);
     xf::compression::lz4Compress(litOut, lenOffsetOut, lz4Out, lz4Out_eos, compressedSize, input_size);
-    xf::compression::upsizerEos<uint16_t, BIT, GMEM_DWIDTH>(lz4Out, lz4Out_eos, outStreamMemWidth,
+    // Compressed block is hashed on the fly for the LZ4 block checksum
+    lz4OutDup(lz4Out, lz4Out_eos, packOut, packOut_eos, hashOut, hashOut_eos);
+    xf::compression::xxhash32Eos(hashOut, hashOut_eos, compHash);
+    xf::compression::upsizerEos<uint16_t, BIT, GMEM_DWIDTH>(packOut, packOut_eos, outStreamMemWidth,
                                                             outStreamMemWidthEos);
 }
 
@@ -85,6 +190,10 @@ void lz4Core(hls::stream<xf::compression::uintMemWidth_t>& inStreamMemWidth,
  * @param output_idx intput size
  * @param input_size input size
  * @param max_lit_limit intput size
+ * @param raw_hash xxHash32 of raw input blocks
+ * @param comp_hash xxHash32 of compressed blocks
+ * @param dict preset dictionary
+ * @param dict_size preset dictionary size per block
  */
 void lz4(const xf::compression::uintMemWidth_t* in,
          xf::compression::uintMemWidth_t* out,
@@ -92,8 +201,28 @@ void lz4(const xf::compression::uintMemWidth_t* in,
          const uint32_t output_idx[PARALLEL_BLOCK],
          const uint32_t input_size[PARALLEL_BLOCK],
          uint32_t output_size[PARALLEL_BLOCK],
-         uint32_t max_lit_limit[PARALLEL_BLOCK]) {
+         uint32_t max_lit_limit[PARALLEL_BLOCK],
+         uint32_t raw_hash[PARALLEL_BLOCK],
+         uint32_t comp_hash[PARALLEL_BLOCK],
+         const xf::compression::uintMemWidth_t* dict,
+         const uint32_t dict_size[PARALLEL_BLOCK]) {
+    const uint32_t dict_idx[PARALLEL_BLOCK] = {0};
     hls::stream<xf::compression::uintMemWidth_t> inStreamMemWidth[PARALLEL_BLOCK];
+    hls::stream<xf::compression::uintMemWidth_t> dictStreamMemWidth[PARALLEL_BLOCK];
+    hls::stream<xf::compression::uintMemWidth_t> lzStreamMemWidth[PARALLEL_BLOCK];
+    hls::stream<xf::compression::uintMemWidth_t> hashStreamMemWidth[PARALLEL_BLOCK];
+    hls::stream<ap_uint<32> > rawHash[PARALLEL_BLOCK];
+    hls::stream<ap_uint<32> > compHash[PARALLEL_BLOCK];
+#pragma HLS STREAM variable = lzStreamMemWidth depth = c_gmemBurstSize
+#pragma HLS STREAM variable = dictStreamMemWidth depth = c_gmemBurstSize
+#pragma HLS STREAM variable = hashStreamMemWidth depth = c_gmemBurstSize
+#pragma HLS STREAM variable = rawHash depth = 2
+#pragma HLS STREAM variable = compHash depth = 2
+#pragma HLS RESOURCE variable = lzStreamMemWidth core = FIFO_SRL
+#pragma HLS RESOURCE variable = dictStreamMemWidth core = FIFO_SRL
+#pragma HLS RESOURCE variable = hashStreamMemWidth core = FIFO_SRL
+#pragma HLS RESOURCE variable = rawHash core = FIFO_SRL
+#pragma HLS RESOURCE variable = compHash core = FIFO_SRL
     hls::stream<bool> outStreamMemWidthEos[PARALLEL_BLOCK];
     hls::stream<xf::compression::uintMemWidth_t> outStreamMemWidth[PARALLEL_BLOCK];
 #pragma HLS STREAM variable = outStreamMemWidthEos depth = 2
@@ -109,13 +238,20 @@ void lz4(const xf::compression::uintMemWidth_t* in,
 
 #pragma HLS dataflow
     xf::compression::mm2sNb<GMEM_DWIDTH, GMEM_BURST_SIZE, PARALLEL_BLOCK>(in, input_idx, inStreamMemWidth, input_size);
+    xf::compression::mm2sNb<GMEM_DWIDTH, GMEM_BURST_SIZE, PARALLEL_BLOCK>(dict, dict_idx, dictStreamMemWidth, dict_size);
     for (uint8_t i = 0; i < PARALLEL_BLOCK; i++) {
 #pragma HLS UNROLL
+        // Raw input is tapped for block checksum in parallel to LZ4
+        lz4InputDup(inStreamMemWidth[i], lzStreamMemWidth[i], hashStreamMemWidth[i], input_size[i]);
+        lz4RawHash(hashStreamMemWidth[i], rawHash[i], input_size[i]);
+
         // lz4Core is instantiated based on the PARALLEL_BLOCK
-        lz4Core(inStreamMemWidth[i], outStreamMemWidth[i], outStreamMemWidthEos[i], compressedSize[i], max_lit_limit,
-                input_size[i], i);
+        lz4Core(lzStreamMemWidth[i], dictStreamMemWidth[i], outStreamMemWidth[i], outStreamMemWidthEos[i],
+                compressedSize[i], compHash[i], max_lit_limit, input_size[i], dict_size[i], i);
     }
 
+    lz4HashCollect(rawHash, compHash, raw_hash, comp_hash);
+
     xf::compression::s2mmEosNb<uint32_t, GMEM_BURST_SIZE, GMEM_DWIDTH, PARALLEL_BLOCK>(
         out, output_idx, outStreamMemWidth, outStreamMemWidthEos, compressedSize, output_size);
 }
@@ -129,8 +265,11 @@ extern "C" {
  * @param out output stream width
  * @param compressd_size output size
  * @param in_block_size intput size
+ * @param block_checksum raw and compressed xxHash32 of each block
+ * @param dict preset dictionary
  * @param block_size_in_kb intput size
  * @param input_size input size
+ * @param dict_size preset dictionary size
  */
 void xilLz4Compress
 
@@ -138,22 +277,31 @@ void xilLz4Compress
      xf::compression::uintMemWidth_t* out,
      uint32_t* compressd_size,
      uint32_t* in_block_size,
+     uint32_t* block_checksum,
+     const xf::compression::uintMemWidth_t* dict,
      uint32_t block_size_in_kb,
-     uint32_t input_size) {
+     uint32_t input_size,
+     uint32_t dict_size) {
 #pragma HLS INTERFACE m_axi port = in offset = slave bundle = gmem0
 #pragma HLS INTERFACE m_axi port = out offset = slave bundle = gmem0
 #pragma HLS INTERFACE m_axi port = compressd_size offset = slave bundle = gmem1
 #pragma HLS INTERFACE m_axi port = in_block_size offset = slave bundle = gmem1
+#pragma HLS INTERFACE m_axi port = block_checksum offset = slave bundle = gmem1
+#pragma HLS INTERFACE m_axi port = dict offset = slave bundle = gmem1
 #pragma HLS INTERFACE s_axilite port = in bundle = control
 #pragma HLS INTERFACE s_axilite port = out bundle = control
 #pragma HLS INTERFACE s_axilite port = compressd_size bundle = control
 #pragma HLS INTERFACE s_axilite port = in_block_size bundle = control
+#pragma HLS INTERFACE s_axilite port = block_checksum bundle = control
+#pragma HLS INTERFACE s_axilite port = dict bundle = control
 #pragma HLS INTERFACE s_axilite port = block_size_in_kb bundle = control
 #pragma HLS INTERFACE s_axilite port = input_size bundle = control
+#pragma HLS INTERFACE s_axilite port = dict_size bundle = control
 #pragma HLS INTERFACE s_axilite port = return bundle = control
 
 #pragma HLS data_pack variable = in
 #pragma HLS data_pack variable = out
+#pragma HLS data_pack variable = dict
 
     uint32_t block_idx = 0;
     uint32_t block_length = block_size_in_kb * 1024;
@@ -167,11 +315,17 @@ void xilLz4Compress
     uint32_t output_block_size[PARALLEL_BLOCK];
     uint32_t max_lit_limit[PARALLEL_BLOCK];
     uint32_t small_block_inSize[PARALLEL_BLOCK];
+    uint32_t raw_hash[PARALLEL_BLOCK];
+    uint32_t comp_hash[PARALLEL_BLOCK];
+    uint32_t dict_block_size[PARALLEL_BLOCK];
 #pragma HLS ARRAY_PARTITION variable = input_block_size dim = 0 complete
+#pragma HLS ARRAY_PARTITION variable = dict_block_size dim = 0 complete
 #pragma HLS ARRAY_PARTITION variable = input_idx dim = 0 complete
 #pragma HLS ARRAY_PARTITION variable = output_idx dim = 0 complete
 #pragma HLS ARRAY_PARTITION variable = output_block_size dim = 0 complete
 #pragma HLS ARRAY_PARTITION variable = max_lit_limit dim = 0 complete
+#pragma HLS ARRAY_PARTITION variable = raw_hash dim = 0 complete
+#pragma HLS ARRAY_PARTITION variable = comp_hash dim = 0 complete
 
     // Figure out total blocks & block sizes
     for (uint32_t i = 0; i < no_blocks; i += PARALLEL_BLOCK) {
@@ -200,10 +354,13 @@ void xilLz4Compress
             }
             output_block_size[j] = 0;
             max_lit_limit[j] = 0;
+            // Idle engines must not consume the dictionary
+            dict_block_size[j] = (input_block_size[j] == 0) ? 0 : dict_size;
         }
 
         // Call for parallel compression
-        lz4(in, out, input_idx, output_idx, input_block_size, output_block_size, max_lit_limit);
+        lz4(in, out, input_idx, output_idx, input_block_size, output_block_size, max_lit_limit, raw_hash, comp_hash,
+            dict, dict_block_size);
 
         for (uint32_t k = 0; k < nblocks; k++) {
             if (max_lit_limit[k]) {
@@ -215,6 +372,9 @@ void xilLz4Compress
             if (small_block[k] == 1) {
                 compressd_size[block_idx] = small_block_inSize[k];
             }
+            // Small blocks bypass the engines, host hashes them
+            block_checksum[2 * block_idx] = raw_hash[k];
+            block_checksum[2 * block_idx + 1] = comp_hash[k];
             block_idx++;
         }
     }
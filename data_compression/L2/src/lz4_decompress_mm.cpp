@@ -31,28 +31,36 @@ typedef ap_uint<BIT> uintV_t;
 // namespace hw_decompress {
 
 void lz4CoreDec(hls::stream<xf::compression::uintMemWidth_t>& inStreamMemWidth,
+                hls::stream<xf::compression::uintMemWidth_t>& dictStreamMemWidth,
                 hls::stream<xf::compression::uintMemWidth_t>& outStreamMemWidth,
                 const uint32_t _input_size,
-                const uint32_t _output_size) {
+                const uint32_t _output_size,
+                const uint32_t _dict_size) {
     uint32_t input_size = _input_size;
     uint32_t output_size = _output_size;
     uint32_t input_size1 = input_size;
     uint32_t output_size1 = output_size;
+    uint32_t dict_size = _dict_size;
+    uint32_t dict_size1 = _dict_size;
     hls::stream<uintV_t> instreamV("instreamV");
+    hls::stream<uintV_t> dictstreamV("dictstreamV");
     hls::stream<xf::compression::compressd_dt> decompressd_stream("decompressd_stream");
     hls::stream<uintV_t> decompressed_stream("decompressed_stream");
 #pragma HLS STREAM variable = instreamV depth = 8
+#pragma HLS STREAM variable = dictstreamV depth = 8
 #pragma HLS STREAM variable = decompressd_stream depth = 8
 #pragma HLS STREAM variable = decompressed_stream depth = 8
 #pragma HLS RESOURCE variable = instreamV core = FIFO_SRL
+#pragma HLS RESOURCE variable = dictstreamV core = FIFO_SRL
 #pragma HLS RESOURCE variable = decompressd_stream core = FIFO_SRL
 #pragma HLS RESOURCE variable = decompressed_stream core = FIFO_SRL
 
 #pragma HLS dataflow
+    xf::compression::streamDownsizer<uint32_t, GMEM_DWIDTH, 8>(dictStreamMemWidth, dictstreamV, dict_size);
     xf::compression::streamDownsizer<uint32_t, GMEM_DWIDTH, 8>(inStreamMemWidth, instreamV, input_size);
     xf::compression::lz4Decompress(instreamV, decompressd_stream, input_size1);
-    xf::compression::lzDecompress<HISTORY_SIZE, READ_STATE, MATCH_STATE, LOW_OFFSET_STATE, LOW_OFFSET>(
-        decompressd_stream, decompressed_stream, output_size);
+    xf::compression::lzDecompressDict<HISTORY_SIZE, READ_STATE, MATCH_STATE, LOW_OFFSET_STATE, LOW_OFFSET>(
+        decompressd_stream, dictstreamV, decompressed_stream, output_size, dict_size1);
     xf::compression::streamUpsizer<uint32_t, 8, GMEM_DWIDTH>(decompressed_stream, outStreamMemWidth, output_size1);
 }
 
@@ -62,21 +70,29 @@ void lz4Dec(const xf::compression::uintMemWidth_t* in,
             const uint32_t input_size[PARALLEL_BLOCK],
             const uint32_t output_size[PARALLEL_BLOCK],
             const uint32_t input_size1[PARALLEL_BLOCK],
-            const uint32_t output_size1[PARALLEL_BLOCK]) {
+            const uint32_t output_size1[PARALLEL_BLOCK],
+            const xf::compression::uintMemWidth_t* dict,
+            const uint32_t dict_size[PARALLEL_BLOCK]) {
+    const uint32_t dict_idx[PARALLEL_BLOCK] = {0};
     hls::stream<xf::compression::uintMemWidth_t> inStreamMemWidth[PARALLEL_BLOCK];
+    hls::stream<xf::compression::uintMemWidth_t> dictStreamMemWidth[PARALLEL_BLOCK];
     hls::stream<xf::compression::uintMemWidth_t> outStreamMemWidth[PARALLEL_BLOCK];
 #pragma HLS STREAM variable = inStreamMemWidth depth = c_gmemBurstSize
+#pragma HLS STREAM variable = dictStreamMemWidth depth = c_gmemBurstSize
 #pragma HLS STREAM variable = outStreamMemWidth depth = c_gmemBurstSize
 #pragma HLS RESOURCE variable = inStreamMemWidth core = FIFO_SRL
+#pragma HLS RESOURCE variable = dictStreamMemWidth core = FIFO_SRL
 #pragma HLS RESOURCE variable = outStreamMemWidth core = FIFO_SRL
 
 #pragma HLS dataflow
     // Transfer data from global memory to kernel
     xf::compression::mm2sNb<GMEM_DWIDTH, GMEM_BURST_SIZE, PARALLEL_BLOCK>(in, input_idx, inStreamMemWidth, input_size);
+    xf::compression::mm2sNb<GMEM_DWIDTH, GMEM_BURST_SIZE, PARALLEL_BLOCK>(dict, dict_idx, dictStreamMemWidth, dict_size);
     for (uint8_t i = 0; i < PARALLEL_BLOCK; i++) {
 #pragma HLS UNROLL
         // lz4CoreDec is instantiated based on the PARALLEL_BLOCK
-        lz4CoreDec(inStreamMemWidth[i], outStreamMemWidth[i], input_size1[i], output_size1[i]);
+        lz4CoreDec(inStreamMemWidth[i], dictStreamMemWidth[i], outStreamMemWidth[i], input_size1[i], output_size1[i],
+                   dict_size[i]);
     }
 
     // Transfer data from kernel to global memory
@@ -91,29 +107,37 @@ void xilLz4Decompress(const xf::compression::uintMemWidth_t* in,
                       xf::compression::uintMemWidth_t* out,
                       uint32_t* in_block_size,
                       uint32_t* in_compress_size,
+                      const xf::compression::uintMemWidth_t* dict,
                       uint32_t block_size_in_kb,
-                      uint32_t no_blocks) {
+                      uint32_t no_blocks,
+                      uint32_t dict_size) {
 #pragma HLS INTERFACE m_axi port = in offset = slave bundle = gmem0
 #pragma HLS INTERFACE m_axi port = out offset = slave bundle = gmem0
 #pragma HLS INTERFACE m_axi port = in_block_size offset = slave bundle = gmem1
 #pragma HLS INTERFACE m_axi port = in_compress_size offset = slave bundle = gmem1
+#pragma HLS INTERFACE m_axi port = dict offset = slave bundle = gmem1
 #pragma HLS INTERFACE s_axilite port = in bundle = control
 #pragma HLS INTERFACE s_axilite port = out bundle = control
 #pragma HLS INTERFACE s_axilite port = in_block_size bundle = control
 #pragma HLS INTERFACE s_axilite port = in_compress_size bundle = control
+#pragma HLS INTERFACE s_axilite port = dict bundle = control
 #pragma HLS INTERFACE s_axilite port = block_size_in_kb bundle = control
 #pragma HLS INTERFACE s_axilite port = no_blocks bundle = control
+#pragma HLS INTERFACE s_axilite port = dict_size bundle = control
 #pragma HLS INTERFACE s_axilite port = return bundle = control
 
 #pragma HLS data_pack variable = in
 #pragma HLS data_pack variable = out
+#pragma HLS data_pack variable = dict
     uint32_t max_block_size = block_size_in_kb * 1024;
     uint32_t compress_size[PARALLEL_BLOCK];
     uint32_t compress_size1[PARALLEL_BLOCK];
     uint32_t block_size[PARALLEL_BLOCK];
     uint32_t block_size1[PARALLEL_BLOCK];
     uint32_t input_idx[PARALLEL_BLOCK];
+    uint32_t dict_block_size[PARALLEL_BLOCK];
 #pragma HLS ARRAY_PARTITION variable = input_idx dim = 0 complete
+#pragma HLS ARRAY_PARTITION variable = dict_block_size dim = 0 complete
 #pragma HLS ARRAY_PARTITION variable = compress_size dim = 0 complete
 #pragma HLS ARRAY_PARTITION variable = compress_size1 dim = 0 complete
 #pragma HLS ARRAY_PARTITION variable = block_size dim = 0 complete
@@ -137,16 +161,18 @@ void xilLz4Decompress(const xf::compression::uintMemWidth_t* in,
                 compress_size1[j] = iSize;
                 block_size1[j] = oSize;
                 input_idx[j] = (i + j) * max_block_size;
+                dict_block_size[j] = dict_size;
             } else {
                 compress_size[j] = 0;
                 block_size[j] = 0;
                 compress_size1[j] = 0;
                 block_size1[j] = 0;
                 input_idx[j] = 0;
+                dict_block_size[j] = 0;
             }
         }
 
-        lz4Dec(in, out, input_idx, compress_size, block_size, compress_size1, block_size1);
+        lz4Dec(in, out, input_idx, compress_size, block_size, compress_size1, block_size1, dict, dict_block_size);
     }
 }
 }
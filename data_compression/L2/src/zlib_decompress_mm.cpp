@@ -28,7 +28,15 @@ const int kGMemBurstSize = 16;
 typedef ap_uint<kGMemDWidth> uintMemWidth_t;
 typedef ap_uint<32> compressd_dt;
 
-void xil_inflate(const uintMemWidth_t* in, uintMemWidth_t* out, uint32_t* encoded_size, uint32_t input_size) {
+void zlibWriteEndSize(hls::stream<uint32_t>& endSizeStream, uint32_t* end_size) {
+    end_size[0] = endSizeStream.read();
+}
+
+void xil_inflate(const uintMemWidth_t* in,
+                 uintMemWidth_t* out,
+                 uint32_t* encoded_size,
+                 uint32_t* end_size,
+                 uint32_t input_size) {
     hls::stream<uintMemWidth_t> inStream512("inputStream");
     hls::stream<ap_uint<16> > outDownStream("outDownStream");
     hls::stream<ap_uint<8> > uncompOutStream("unCompOutStream");
@@ -49,13 +57,14 @@ void xil_inflate(const uintMemWidth_t* in, uintMemWidth_t* out, uint32_t* encode
 #pragma HLS STREAM variable = byte_eos depth = 32
 
     hls::stream<uint32_t> outsize_val;
+    hls::stream<uint32_t> endsize_val;
     hls::stream<bool> outStreamWidth_eos[PARALLEL_BLOCK];
 
 #pragma HLS dataflow
     xf::compression::mm2sSimple<kGMemDWidth, kGMemBurstSize>(in, inStream512, input_size);
     xf::compression::streamDownsizer<uint32_t, kGMemDWidth, 16>(inStream512, outDownStream, input_size);
 
-    xf::compression::huffmanDecoder(outDownStream, bitUnPackStream, bitEndOfStream, input_size);
+    xf::compression::huffmanDecoder(outDownStream, bitUnPackStream, bitEndOfStream, endsize_val, input_size);
 
     xf::compression::lzDecompressZlibEos_new<HISTORY_SIZE, LOW_OFFSET>(bitUnPackStream, bitEndOfStream, uncompOutStream,
                                                                        byte_eos, outsize_val);
@@ -63,21 +72,25 @@ void xil_inflate(const uintMemWidth_t* in, uintMemWidth_t* out, uint32_t* encode
     xf::compression::upsizerEos<uint16_t, 8, kGMemDWidth>(uncompOutStream, byte_eos, outStream512, outStream512_eos);
     xf::compression::s2mmEosSimple<uint32_t, kGMemBurstSize, kGMemDWidth, 1>(out, outStream512, outStream512_eos,
                                                                              outsize_val, encoded_size);
+    zlibWriteEndSize(endsize_val, end_size);
 }
 
 extern "C" {
-void xilDecompressZlib(uintMemWidth_t* in, uintMemWidth_t* out, uint32_t* encoded_size, uint32_t input_size) {
+void xilDecompressZlib(
+    uintMemWidth_t* in, uintMemWidth_t* out, uint32_t* encoded_size, uint32_t* end_size, uint32_t input_size) {
 #pragma HLS INTERFACE m_axi port = in offset = slave bundle = gmem0
 #pragma HLS INTERFACE m_axi port = out offset = slave bundle = gmem0
 #pragma HLS INTERFACE m_axi port = encoded_size offset = slave bundle = gmem1
+#pragma HLS INTERFACE m_axi port = end_size offset = slave bundle = gmem1
 #pragma HLS INTERFACE s_axilite port = in bundle = control
 #pragma HLS INTERFACE s_axilite port = out bundle = control
 #pragma HLS INTERFACE s_axilite port = encoded_size bundle = control
+#pragma HLS INTERFACE s_axilite port = end_size bundle = control
 #pragma HLS INTERFACE s_axilite port = input_size bundle = control
 #pragma HLS INTERFACE s_axilite port = return bundle = control
 
     ////printme("In decompress kernel \n");
     // Call for parallel compression
-    xil_inflate(in, out, encoded_size, input_size);
+    xil_inflate(in, out, encoded_size, end_size, input_size);
 }
 }
@@ -125,6 +125,7 @@ void lz77Core(hls::stream<uintMemWidth_t>& inStream512,
     uint32_t left_bytes = 64;
     hls::stream<ap_uint<BIT> > inStream("inStream");
     hls::stream<compressd_dt> compressdStream("compressdStream");
+    hls::stream<compressd_dt> lazyStream("lazyStream");
     hls::stream<compressd_dt> boosterStream("boosterStream");
     hls::stream<compressd_dt> boosterStream_freq("boosterStream");
     hls::stream<uint8_t> litOut("litOut");
@@ -133,6 +134,7 @@ void lz77Core(hls::stream<uintMemWidth_t>& inStream512,
     hls::stream<bool> lz77Out_eos("lz77Out_eos");
 #pragma HLS STREAM variable = inStream depth = c_gmemBurstSize
 #pragma HLS STREAM variable = compressdStream depth = c_gmemBurstSize
+#pragma HLS STREAM variable = lazyStream depth = c_gmemBurstSize
 #pragma HLS STREAM variable = boosterStream depth = c_gmemBurstSize
 #pragma HLS STREAM variable = litOut depth = max_literal_count
 #pragma HLS STREAM variable = lenOffsetOut depth = c_gmemBurstSize
@@ -141,6 +143,7 @@ void lz77Core(hls::stream<uintMemWidth_t>& inStream512,
 
 #pragma HLS RESOURCE variable = inStream core = FIFO_SRL
 #pragma HLS RESOURCE variable = compressdStream core = FIFO_SRL
+#pragma HLS RESOURCE variable = lazyStream core = FIFO_SRL
 #pragma HLS RESOURCE variable = boosterStream core = FIFO_SRL
 #pragma HLS RESOURCE variable = litOut core = FIFO_SRL
 #pragma HLS RESOURCE variable = lenOffsetOut core = FIFO_SRL
@@ -151,11 +154,50 @@ void lz77Core(hls::stream<uintMemWidth_t>& inStream512,
     xf::compression::streamDownsizer<uint32_t, GMEM_DWIDTH, 8>(inStream512, inStream, input_size);
     xf::compression::lzCompress<MATCH_LEN, MATCH_LEVEL, LZ_DICT_SIZE, BIT, MIN_OFFSET, MIN_MATCH, LZ_MAX_OFFSET_LIMIT>(
         inStream, compressdStream, input_size, left_bytes);
+#if LAZY_DEPTH
+    xf::compression::lzLazyMatch<LAZY_DEPTH, MATCH_LEN>(compressdStream, lazyStream, input_size, left_bytes);
+    xf::compression::lzBooster<MAX_MATCH_LEN, OFFSET_WINDOW>(lazyStream, boosterStream, input_size, left_bytes);
+#else
     xf::compression::lzBooster<MAX_MATCH_LEN, OFFSET_WINDOW>(compressdStream, boosterStream, input_size, left_bytes);
+#endif
     lz77Divide(boosterStream, lz77Out, lz77Out_eos, outStreamTree, compressedSize, input_size, core_idx);
     xf::compression::upsizerEos<uint16_t, 32, GMEM_DWIDTH>(lz77Out, lz77Out_eos, outStream512, outStream512Eos);
 }
 
+void lz77InputDup(hls::stream<uintMemWidth_t>& inStream,
+                  hls::stream<uintMemWidth_t>& outStream,
+                  hls::stream<uintMemWidth_t>& crcStream,
+                  uint32_t input_size) {
+    const uint32_t c_wordBytes = GMEM_DWIDTH / 8;
+    uint32_t sizeV = (input_size == 0) ? 0 : ((input_size - 1) / c_wordBytes + 1);
+lz77_input_dup:
+    for (uint32_t i = 0; i < sizeV; i++) {
+#pragma HLS PIPELINE II = 1
+        uintMemWidth_t inValue = inStream.read();
+        outStream << inValue;
+        crcStream << inValue;
+    }
+}
+
+void lz77Checksum(hls::stream<uintMemWidth_t>& inStream512, hls::stream<ap_uint<32> >& crcOut, uint32_t input_size) {
+    uint32_t input_size1 = input_size;
+    hls::stream<ap_uint<CRC_PARALLEL_BYTE * 8> > crcInStream("crcInStream");
+#pragma HLS STREAM variable = crcInStream depth = c_gmemBurstSize
+#pragma HLS RESOURCE variable = crcInStream core = FIFO_SRL
+
+#pragma HLS dataflow
+    xf::compression::streamDownsizer<uint32_t, GMEM_DWIDTH, CRC_PARALLEL_BYTE * 8>(inStream512, crcInStream,
+                                                                                  input_size);
+    xf::compression::crc32<CRC_PARALLEL_BYTE>(crcInStream, crcOut, input_size1);
+}
+
+void lz77ChecksumCollect(hls::stream<ap_uint<32> > crcStream[PARALLEL_BLOCK], uint32_t block_crc[PARALLEL_BLOCK]) {
+    for (uint8_t i = 0; i < PARALLEL_BLOCK; i++) {
+#pragma HLS PIPELINE II = 1
+        block_crc[i] = crcStream[i].read();
+    }
+}
+
 void lz77(const uintMemWidth_t* in,
           uintMemWidth_t* out,
           const uint32_t input_idx[PARALLEL_BLOCK],
@@ -163,21 +205,31 @@ void lz77(const uintMemWidth_t* in,
           const uint32_t input_size[PARALLEL_BLOCK],
           uint32_t output_size[PARALLEL_BLOCK],
           uint32_t max_lit_limit[PARALLEL_BLOCK],
+          uint32_t block_crc[PARALLEL_BLOCK],
           uint32_t* dyn_ltree_freq,
           uint32_t* dyn_dtree_freq) {
     const uint32_t c_gmemBSize = 32;
 
     hls::stream<uintMemWidth_t> inStreamMemWidth[PARALLEL_BLOCK];
+    hls::stream<uintMemWidth_t> lzStreamMemWidth[PARALLEL_BLOCK];
+    hls::stream<uintMemWidth_t> crcStreamMemWidth[PARALLEL_BLOCK];
+    hls::stream<ap_uint<32> > crcStream[PARALLEL_BLOCK];
     hls::stream<bool> outStreamMemWidthEos[PARALLEL_BLOCK];
     hls::stream<uintMemWidth_t> outStreamMemWidth[PARALLEL_BLOCK];
     hls::stream<uint32_t> outStreamTreeData[PARALLEL_BLOCK];
 #pragma HLS STREAM variable = outStreamMemWidthEos depth = c_gmemBSize
 #pragma HLS STREAM variable = inStreamMemWidth depth = c_gmemBSize
+#pragma HLS STREAM variable = lzStreamMemWidth depth = c_gmemBSize
+#pragma HLS STREAM variable = crcStreamMemWidth depth = c_gmemBSize
+#pragma HLS STREAM variable = crcStream depth = 2
 #pragma HLS STREAM variable = outStreamMemWidth depth = c_gmemBSize
 #pragma HLS STREAM variable = outStreamTreeData depth = c_gmemBSize
 
 #pragma HLS RESOURCE variable = outStreamMemWidthEos core = FIFO_SRL
 #pragma HLS RESOURCE variable = inStreamMemWidth core = FIFO_SRL
+#pragma HLS RESOURCE variable = lzStreamMemWidth core = FIFO_SRL
+#pragma HLS RESOURCE variable = crcStreamMemWidth core = FIFO_SRL
+#pragma HLS RESOURCE variable = crcStream core = FIFO_SRL
 #pragma HLS RESOURCE variable = outStreamMemWidth core = FIFO_SRL
 #pragma HLS RESOURCE variable = outStreamTreeData core = FIFO_SRL
 
@@ -189,11 +241,17 @@ void lz77(const uintMemWidth_t* in,
 
     for (uint8_t i = 0; i < PARALLEL_BLOCK; i++) {
 #pragma HLS UNROLL
+        // Raw input is tapped for checksum in parallel to LZ77
+        lz77InputDup(inStreamMemWidth[i], lzStreamMemWidth[i], crcStreamMemWidth[i], input_size[i]);
+        lz77Checksum(crcStreamMemWidth[i], crcStream[i], input_size[i]);
+
         // lz77Core is instantiated based on the PARALLEL BLOCK
-        lz77Core(inStreamMemWidth[i], outStreamMemWidth[i], outStreamMemWidthEos[i], outStreamTreeData[i],
+        lz77Core(lzStreamMemWidth[i], outStreamMemWidth[i], outStreamMemWidthEos[i], outStreamTreeData[i],
                  compressedSize[i], max_lit_limit, input_size[i], i);
     }
 
+    lz77ChecksumCollect(crcStream, block_crc);
+
     // S2MM Call
     xf::compression::s2mmEosNbFreq<uint32_t, GMEM_BURST_SIZE, GMEM_DWIDTH, PARALLEL_BLOCK>(
         out, output_idx, outStreamMemWidth, outStreamMemWidthEos, outStreamTreeData, compressedSize, output_size,
@@ -207,6 +265,7 @@ void xilLz77Compress(const uintMemWidth_t* in,
                      uint32_t* in_block_size,
                      uint32_t* dyn_ltree_freq,
                      uint32_t* dyn_dtree_freq,
+                     uint32_t* checksum,
                      uint32_t block_size_in_kb,
                      uint32_t input_size) {
 #pragma HLS INTERFACE m_axi port = in offset = slave bundle = gmem0
@@ -215,12 +274,14 @@ void xilLz77Compress(const uintMemWidth_t* in,
 #pragma HLS INTERFACE m_axi port = in_block_size offset = slave bundle = gmem1
 #pragma HLS INTERFACE m_axi port = dyn_ltree_freq offset = slave bundle = gmem1
 #pragma HLS INTERFACE m_axi port = dyn_dtree_freq offset = slave bundle = gmem1
+#pragma HLS INTERFACE m_axi port = checksum offset = slave bundle = gmem1
 #pragma HLS INTERFACE s_axilite port = in bundle = control
 #pragma HLS INTERFACE s_axilite port = out bundle = control
 #pragma HLS INTERFACE s_axilite port = compressd_size bundle = control
 #pragma HLS INTERFACE s_axilite port = in_block_size bundle = control
 #pragma HLS INTERFACE s_axilite port = dyn_ltree_freq bundle = control
 #pragma HLS INTERFACE s_axilite port = dyn_dtree_freq bundle = control
+#pragma HLS INTERFACE s_axilite port = checksum bundle = control
 #pragma HLS INTERFACE s_axilite port = block_size_in_kb bundle = control
 #pragma HLS INTERFACE s_axilite port = input_size bundle = control
 #pragma HLS INTERFACE s_axilite port = return bundle = control
@@ -237,11 +298,13 @@ void xilLz77Compress(const uintMemWidth_t* in,
     uint32_t output_block_size[PARALLEL_BLOCK];
     uint32_t max_lit_limit[PARALLEL_BLOCK];
     uint32_t small_block_inSize[PARALLEL_BLOCK];
+    uint32_t block_crc[PARALLEL_BLOCK];
 #pragma HLS ARRAY_PARTITION variable = input_block_size dim = 0 complete
 #pragma HLS ARRAY_PARTITION variable = input_idx dim = 0 complete
 #pragma HLS ARRAY_PARTITION variable = output_idx dim = 0 complete
 #pragma HLS ARRAY_PARTITION variable = output_block_size dim = 0 complete
 #pragma HLS ARRAY_PARTITION variable = max_lit_limit dim = 0 complete
+#pragma HLS ARRAY_PARTITION variable = block_crc dim = 0 complete
 
     // Figure out total blocks & block sizes
     for (int i = 0; i < no_blocks; i += PARALLEL_BLOCK) {
@@ -273,8 +336,8 @@ void xilLz77Compress(const uintMemWidth_t* in,
         }
 
         // Call for parallel compression
-        lz77(in, out, input_idx, output_idx, input_block_size, output_block_size, max_lit_limit, dyn_ltree_freq,
-             dyn_dtree_freq);
+        lz77(in, out, input_idx, output_idx, input_block_size, output_block_size, max_lit_limit, block_crc,
+             dyn_ltree_freq, dyn_dtree_freq);
 
         for (int k = 0; k < nblocks; k++) {
             if (max_lit_limit[k]) {
@@ -286,6 +349,8 @@ void xilLz77Compress(const uintMemWidth_t* in,
             if (small_block[k] == 1) {
                 compressd_size[block_idx] = small_block_inSize[k];
             }
+            // Small blocks bypass the engines, host checksums them
+            checksum[block_idx] = block_crc[k];
             block_idx++;
         }
     }
@@ -0,0 +1,89 @@
+/*
+ * (c) Copyright 2019 Xilinx, Inc. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+/**
+ * @file zstd_decompress_mm.cpp
+ * @brief Source for zstd decompression kernel.
+ *
+ * This file is part of Vitis Data Compression Library.
+ */
+#include "zstd_decompress_mm.hpp"
+
+const int kGMemDWidth = 512;
+const int kGMemBurstSize = 16;
+typedef ap_uint<kGMemDWidth> uintMemWidth_t;
+
+void zstdWriteStatus(hls::stream<uint32_t>& statusStream, uint32_t* status) {
+    status[0] = statusStream.read();
+}
+
+void xil_zstd_inflate(const uintMemWidth_t* in,
+                      uintMemWidth_t* out,
+                      uint32_t* encoded_size,
+                      uint32_t* status,
+                      uint32_t input_size,
+                      uint32_t output_size) {
+    hls::stream<uintMemWidth_t> inStream512("inputStream");
+    hls::stream<ap_uint<8> > inStream8("inStream8");
+    hls::stream<ap_uint<8> > uncompOutStream("unCompOutStream");
+    hls::stream<bool> byte_eos("byteEndOfStream");
+    hls::stream<uintMemWidth_t> outStream512("outputStream");
+    hls::stream<bool> outStream512_eos("outputStreamSize");
+    hls::stream<uint32_t> outsize_val("outsize_val");
+    hls::stream<uint32_t> status_val("status_val");
+
+#pragma HLS STREAM variable = inStream512 depth = 32
+#pragma HLS STREAM variable = inStream8 depth = 32
+#pragma HLS STREAM variable = uncompOutStream depth = 32
+#pragma HLS STREAM variable = byte_eos depth = 32
+#pragma HLS STREAM variable = outStream512 depth = 32
+#pragma HLS STREAM variable = outStream512_eos depth = 32
+
+#pragma HLS dataflow
+    xf::compression::mm2sSimple<kGMemDWidth, kGMemBurstSize>(in, inStream512, input_size);
+    xf::compression::streamDownsizer<uint32_t, kGMemDWidth, 8>(inStream512, inStream8, input_size);
+
+    xf::compression::zstdDecompressCore<HISTORY_SIZE, LOW_OFFSET>(inStream8, uncompOutStream, byte_eos, outsize_val,
+                                                                  status_val, input_size, output_size);
+
+    xf::compression::upsizerEos<uint16_t, 8, kGMemDWidth>(uncompOutStream, byte_eos, outStream512, outStream512_eos);
+    xf::compression::s2mmEosSimple<uint32_t, kGMemBurstSize, kGMemDWidth, 1>(out, outStream512, outStream512_eos,
+                                                                             outsize_val, encoded_size);
+    zstdWriteStatus(status_val, status);
+}
+
+extern "C" {
+void xilZstdDecompress(uintMemWidth_t* in,
+                       uintMemWidth_t* out,
+                       uint32_t* encoded_size,
+                       uint32_t* status,
+                       uint32_t input_size,
+                       uint32_t output_size) {
+#pragma HLS INTERFACE m_axi port = in offset = slave bundle = gmem0
+#pragma HLS INTERFACE m_axi port = out offset = slave bundle = gmem0
+#pragma HLS INTERFACE m_axi port = encoded_size offset = slave bundle = gmem1
+#pragma HLS INTERFACE m_axi port = status offset = slave bundle = gmem1
+#pragma HLS INTERFACE s_axilite port = in bundle = control
+#pragma HLS INTERFACE s_axilite port = out bundle = control
+#pragma HLS INTERFACE s_axilite port = encoded_size bundle = control
+#pragma HLS INTERFACE s_axilite port = status bundle = control
+#pragma HLS INTERFACE s_axilite port = input_size bundle = control
+#pragma HLS INTERFACE s_axilite port = output_size bundle = control
+#pragma HLS INTERFACE s_axilite port = return bundle = control
+
+    xil_zstd_inflate(in, out, encoded_size, status, input_size, output_size);
+}
+}
@@ -165,6 +165,7 @@ xil_gzip::xil_gzip(const std::string& binaryFileName) {
             h_buf_gzipout[i][j].resize(PARALLEL_ENGINES * HOST_BUFFER_SIZE * 2);
             h_blksize[i][j].resize(MAX_NUMBER_BLOCKS);
             h_compressSize[i][j].resize(MAX_NUMBER_BLOCKS);
+            h_checksum[i][j].resize(MAX_NUMBER_BLOCKS);
             h_dyn_ltree_freq[i][j].resize(PARALLEL_ENGINES * LTREE_SIZE);
             h_dyn_dtree_freq[i][j].resize(PARALLEL_ENGINES * DTREE_SIZE);
             h_dyn_bltree_freq[i][j].resize(PARALLEL_ENGINES * BLTREE_SIZE);
@@ -194,6 +195,10 @@ xil_gzip::xil_gzip(const std::string& binaryFileName) {
                 new cl::Buffer(*m_context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_WRITE, temp_nblocks * sizeof(uint32_t),
                                h_compressSize[cu][flag].data());
 
+            buffer_checksum[cu][flag] =
+                new cl::Buffer(*m_context, CL_MEM_USE_HOST_PTR | CL_MEM_WRITE_ONLY, temp_nblocks * sizeof(uint32_t),
+                               h_checksum[cu][flag].data());
+
             buffer_inblk_size[cu][flag] = new cl::Buffer(*m_context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY,
                                                          temp_nblocks * sizeof(uint32_t), h_blksize[cu][flag].data());
 
@@ -257,6 +262,7 @@ xil_gzip::~xil_gzip() {
             delete (buffer_gzip_output[cu][flag]);
             delete (buffer_compress_size[cu][flag]);
             delete (buffer_inblk_size[cu][flag]);
+            delete (buffer_checksum[cu][flag]);
 
             delete (buffer_dyn_ltree_freq[cu][flag]);
             delete (buffer_dyn_dtree_freq[cu][flag]);
@@ -432,6 +438,7 @@ uint32_t xil_gzip::decompress(uint8_t* in, uint8_t* out, uint32_t input_size, in
     cl::Buffer* buffer_in;
     cl::Buffer* buffer_out;
     cl::Buffer* buffer_size;
+    cl::Buffer* buffer_end;
     if (flag) {
         // printme("before buffer creation \n");
         buffer_in = new cl::Buffer(*m_context, CL_MEM_READ_ONLY, input_size);
@@ -456,6 +463,9 @@ uint32_t xil_gzip::decompress(uint8_t* in, uint8_t* out, uint32_t input_size, in
         outP = h_dbuf_gzipout[cu].data();
         outSize = h_dcompressSize[cu].data();
     }
+    // Device only, the stream is not split here
+    buffer_end = new cl::Buffer(*m_context, CL_MEM_READ_WRITE, sizeof(uint32_t));
+
     // printme("Entered incopy \n");
     // Copy compressed input to h_buf_in
     std::memcpy(inP, &in[0], input_size);
@@ -466,6 +476,7 @@ uint32_t xil_gzip::decompress(uint8_t* in, uint8_t* out, uint32_t input_size, in
     (decompress_kernel[cu])->setArg(narg++, *(buffer_in));
     (decompress_kernel[cu])->setArg(narg++, *(buffer_out));
     (decompress_kernel[cu])->setArg(narg++, *(buffer_size));
+    (decompress_kernel[cu])->setArg(narg++, *(buffer_end));
     (decompress_kernel[cu])->setArg(narg++, input_size);
 
     // Migrate Memory - Map host to device buffers
@@ -496,6 +507,7 @@ uint32_t xil_gzip::decompress(uint8_t* in, uint8_t* out, uint32_t input_size, in
     delete (buffer_in);
     delete (buffer_out);
     delete (buffer_size);
+    delete (buffer_end);
 
     // printme("Done with decompress \n");
     return raw_size;
@@ -623,6 +635,7 @@ overlap:
             (compress_kernel[cu])->setArg(narg++, *(buffer_inblk_size[cu][flag]));
             (compress_kernel[cu])->setArg(narg++, *(buffer_dyn_ltree_freq[cu][flag]));
             (compress_kernel[cu])->setArg(narg++, *(buffer_dyn_dtree_freq[cu][flag]));
+            (compress_kernel[cu])->setArg(narg++, *(buffer_checksum[cu][flag]));
             (compress_kernel[cu])->setArg(narg++, block_size_in_kb);
             (compress_kernel[cu])->setArg(narg++, sizeOfChunk[brick + cu]);
 
@@ -86,6 +86,7 @@ class xil_gzip {
     std::vector<uint8_t, aligned_allocator<uint8_t> > h_buf_gzipout[MAX_CCOMP_UNITS][OVERLAP_BUF_COUNT];
     std::vector<uint32_t, aligned_allocator<uint32_t> > h_blksize[MAX_CCOMP_UNITS][OVERLAP_BUF_COUNT];
     std::vector<uint32_t, aligned_allocator<uint32_t> > h_compressSize[MAX_CCOMP_UNITS][OVERLAP_BUF_COUNT];
+    std::vector<uint32_t, aligned_allocator<uint32_t> > h_checksum[MAX_CCOMP_UNITS][OVERLAP_BUF_COUNT];
 
     // Decompression Related
     std::vector<uint8_t, aligned_allocator<uint8_t> > h_dbuf_in[MAX_DDCOMP_UNITS];
@@ -123,6 +124,7 @@ class xil_gzip {
     cl::Buffer* buffer_gzip_output[MAX_CCOMP_UNITS][OVERLAP_BUF_COUNT];
     cl::Buffer* buffer_compress_size[MAX_CCOMP_UNITS][OVERLAP_BUF_COUNT];
     cl::Buffer* buffer_inblk_size[MAX_CCOMP_UNITS][OVERLAP_BUF_COUNT];
+    cl::Buffer* buffer_checksum[MAX_CCOMP_UNITS][OVERLAP_BUF_COUNT];
 
     cl::Buffer* buffer_dyn_ltree_freq[MAX_CCOMP_UNITS][OVERLAP_BUF_COUNT];
     cl::Buffer* buffer_dyn_dtree_freq[MAX_CCOMP_UNITS][OVERLAP_BUF_COUNT];
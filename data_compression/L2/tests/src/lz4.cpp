@@ -392,8 +392,12 @@ uint64_t xfLz4::decompressSequential(
         decompress_kernel_lz4->setArg(narg++, *(buffer_output));
         decompress_kernel_lz4->setArg(narg++, *(buffer_block_size));
         decompress_kernel_lz4->setArg(narg++, *(buffer_compressed_size));
+        // No preset dictionary, any buffer on the same port will do
+        const uint32_t c_noDictSize = 0;
+        decompress_kernel_lz4->setArg(narg++, *(buffer_compressed_size));
         decompress_kernel_lz4->setArg(narg++, m_block_size_in_kb);
         decompress_kernel_lz4->setArg(narg++, bufblocks);
+        decompress_kernel_lz4->setArg(narg++, c_noDictSize);
 
         std::vector<cl::Memory> inBufVec;
         inBufVec.push_back(*(buffer_input));
@@ -548,14 +552,21 @@ uint64_t xfLz4::compressSequential(uint8_t* in, uint8_t* out, uint64_t input_siz
         buffer_block_size = new cl::Buffer(*m_context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY,
                                            sizeof(uint32_t) * total_blocks_cu, h_blksize.data());
 
+        buffer_checksum = new cl::Buffer(*m_context, CL_MEM_WRITE_ONLY, 2 * sizeof(uint32_t) * total_blocks_cu);
+
         // Set kernel arguments
         uint32_t narg = 0;
         compress_kernel_lz4->setArg(narg++, *(buffer_input));
         compress_kernel_lz4->setArg(narg++, *(buffer_output));
         compress_kernel_lz4->setArg(narg++, *(buffer_compressed_size));
         compress_kernel_lz4->setArg(narg++, *(buffer_block_size));
+        compress_kernel_lz4->setArg(narg++, *(buffer_checksum));
+        // No preset dictionary, any buffer on the same port will do
+        const uint32_t c_noDictSize = 0;
+        compress_kernel_lz4->setArg(narg++, *(buffer_checksum));
         compress_kernel_lz4->setArg(narg++, block_size_in_kb);
         compress_kernel_lz4->setArg(narg++, hostChunk_cu);
+        compress_kernel_lz4->setArg(narg++, c_noDictSize);
         std::vector<cl::Memory> inBufVec;
 
         inBufVec.push_back(*(buffer_input));
@@ -635,6 +646,7 @@ uint64_t xfLz4::compressSequential(uint8_t* in, uint8_t* out, uint64_t input_siz
         delete (buffer_output);
         delete (buffer_compressed_size);
         delete (buffer_block_size);
+        delete (buffer_checksum);
     }
     float throughput_in_mbps_1 = (float)input_size * 1000 / kernel_time_ns_1.count();
     std::cout << std::fixed << std::setprecision(2) << throughput_in_mbps_1;
@@ -205,6 +205,7 @@ class xfLz4 {
     cl::Buffer* buffer_output;
     cl::Buffer* buffer_compressed_size;
     cl::Buffer* buffer_block_size;
+    cl::Buffer* buffer_checksum;
 
     // Decompression related
     std::vector<uint32_t> m_blkSize;
@@ -30,10 +30,11 @@ void xil_compress_decompress_list(std::string& file_list,
                                   std::string& ext2,
                                   int cu,
                                   std::string& single_bin,
+                                  int level,
                                   enum list_mode mode = BOTH) {
     // Create xfZlib object
     xfZlib* xlz;
-    xlz = new xfZlib(single_bin);
+    xlz = new xfZlib(single_bin, level);
 
     if (mode != ONLY_DECOMPRESS) {
         std::cout << "--------------------------------------------------------------" << std::endl;
@@ -112,7 +113,7 @@ void xil_compress_decompress_list(std::string& file_list,
     }
 }
 
-void xil_batch_verify(std::string& file_list, int cu, enum list_mode mode, std::string& single_bin) {
+void xil_batch_verify(std::string& file_list, int cu, enum list_mode mode, std::string& single_bin, int level) {
     std::string ext1;
     std::string ext2;
 
@@ -120,7 +121,7 @@ void xil_batch_verify(std::string& file_list, int cu, enum list_mode mode, std::
     ext1 = ".xe2xd.zlib";
     ext2 = ".xe2xd.zlib";
 
-    xil_compress_decompress_list(file_list, ext1, ext2, cu, single_bin, mode);
+    xil_compress_decompress_list(file_list, ext1, ext2, cu, single_bin, level, mode);
 
     // Validate
     std::cout << "\n";
@@ -160,10 +161,10 @@ void xil_decompress_top(std::string& decompress_mod, int cu, std::string& single
               << "File Name\t\t:" << lz_decompress_in << std::endl;
 }
 
-void xil_compress_top(std::string& compress_mod, std::string& single_bin) {
+void xil_compress_top(std::string& compress_mod, std::string& single_bin, int level) {
     // Xilinx ZLIB object
     xfZlib* xlz;
-    xlz = new xfZlib(single_bin);
+    xlz = new xfZlib(single_bin, level);
 
     std::cout << std::fixed << std::setprecision(2) << "E2E\t\t\t:";
 
@@ -214,10 +215,10 @@ void xil_validate(std::string& file_list, std::string& ext) {
     }
 }
 
-void xilCompressDecompressTop(std::string& compress_decompress_mod, std::string& single_bin) {
+void xilCompressDecompressTop(std::string& compress_decompress_mod, std::string& single_bin, int level) {
     // Create xfZlib object
     xfZlib* xlz;
-    xlz = new xfZlib(single_bin);
+    xlz = new xfZlib(single_bin, level);
 
     std::cout << "--------------------------------------------------------------" << std::endl;
     std::cout << "                     Xilinx Zlib Compress                          " << std::endl;
@@ -304,6 +305,7 @@ int main(int argc, char* argv[]) {
 
     parser.addSwitch("--file_list", "-l", "List of Input Files", "");
     parser.addSwitch("--cu", "-k", "CU", "0");
+    parser.addSwitch("--level", "-lv", "Compression Level 1-9", "6");
     parser.parse(argc, argv);
 
     std::string compress_mod = parser.value("compress");
@@ -312,6 +314,7 @@ int main(int argc, char* argv[]) {
     std::string single_bin = parser.value("single_xclbin");
     std::string compress_decompress_mod = parser.value("compress_decompress");
     std::string cu = parser.value("cu");
+    int level = atoi(parser.value("level").c_str());
 
     if (cu.empty()) {
         printf("please give -k option for cu\n");
@@ -320,7 +323,7 @@ int main(int argc, char* argv[]) {
         cu_run = atoi(cu.c_str());
     }
 
-    if (!compress_decompress_mod.empty()) xilCompressDecompressTop(compress_decompress_mod, single_bin);
+    if (!compress_decompress_mod.empty()) xilCompressDecompressTop(compress_decompress_mod, single_bin, level);
 
     if (!filelist.empty()) {
         list_mode lMode;
@@ -332,10 +335,10 @@ int main(int argc, char* argv[]) {
         } else {
             lMode = BOTH;
         }
-        xil_batch_verify(filelist, cu_run, lMode, single_bin);
+        xil_batch_verify(filelist, cu_run, lMode, single_bin, level);
     } else if (!compress_mod.empty()) {
         // "-c" - Compress Mode
-        xil_compress_top(compress_mod, single_bin);
+        xil_compress_top(compress_mod, single_bin, level);
     } else if (!decompress_mod.empty())
         // "-d" - DeCompress Mode
         xil_decompress_top(decompress_mod, cu_run, single_bin);
@@ -0,0 +1,151 @@
+/*
+ * (c) Copyright 2019 Xilinx, Inc. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#include "zstd.hpp"
+#include <fstream>
+#include <vector>
+#include "cmdlineparser.h"
+
+using namespace xf::compression;
+
+uint64_t get_file_size(std::ifstream& file) {
+    file.seekg(0, file.end);
+    uint64_t file_size = file.tellg();
+    file.seekg(0, file.beg);
+    return file_size;
+}
+
+int validate(std::string& inFile_name, std::string& outFile_name) {
+    std::string command = "cmp " + inFile_name + " " + outFile_name;
+    int ret = system(command.c_str());
+    return ret;
+}
+
+void xil_decompress_list(std::string& file_list, int cu, std::string& single_bin) {
+    // Create xfZstd object
+    xfZstd* xlz;
+    xlz = new xfZstd(single_bin);
+
+    std::cout << "--------------------------------------------------------------" << std::endl;
+    std::cout << "                     Xilinx Zstd DeCompress                       " << std::endl;
+    std::cout << "--------------------------------------------------------------" << std::endl;
+    std::cout << "\n";
+    std::cout << "E2E(MBps)\tFile Size(MB)\t\tFile Name" << std::endl;
+    std::cout << "\n";
+
+    std::ifstream infilelist_dec(file_list.c_str());
+    std::string line_dec;
+
+    // Decompress list of files, each entry names the original file
+    // and its compressed copy is expected next to it with .zst suffix
+    while (std::getline(infilelist_dec, line_dec)) {
+        std::string decompress_in = line_dec + ".zst";
+        std::string decompress_out = decompress_in + ".orig";
+
+        std::ifstream inFile_dec(decompress_in.c_str(), std::ifstream::binary);
+        if (!inFile_dec) {
+            std::cout << "Unable to open file";
+            exit(1);
+        }
+
+        uint64_t input_size = get_file_size(inFile_dec);
+        inFile_dec.close();
+
+        // Call Zstd decompression
+        xlz->decompress_file(decompress_in, decompress_out, input_size, cu);
+
+        std::cout << std::fixed << std::setprecision(3) << "\t\t" << (double)input_size / 1000000 << "\t\t"
+                  << decompress_in << std::endl;
+    }
+
+    delete xlz;
+
+    // Validate
+    std::cout << "\n";
+    std::cout << "Status\t\tFile Name" << std::endl;
+    std::cout << "\n";
+
+    std::ifstream infilelist_val(file_list.c_str());
+    std::string line_val;
+    while (std::getline(infilelist_val, line_val)) {
+        std::string line_out = line_val + ".zst.orig";
+        int ret = validate(line_val, line_out);
+        if (ret == 0) {
+            std::cout << "PASSED\t\t" << line_val << std::endl;
+        } else {
+            std::cout << "Validation Failed" << line_out.c_str() << std::endl;
+            exit(1);
+        }
+    }
+}
+
+void xil_decompress_top(std::string& decompress_mod, int cu, std::string& single_bin) {
+    // Xilinx Zstd object
+    xfZstd* xlz;
+    xlz = new xfZstd(single_bin);
+
+    std::cout << std::fixed << std::setprecision(2) << "E2E\t\t\t:";
+
+    std::ifstream inFile(decompress_mod.c_str(), std::ifstream::binary);
+    if (!inFile) {
+        std::cout << "Unable to open file";
+        exit(1);
+    }
+    uint64_t input_size = get_file_size(inFile);
+    inFile.close();
+
+    std::string decompress_in = decompress_mod;
+    std::string decompress_out = decompress_mod + ".orig";
+
+    // Call Zstd decompression
+    uint64_t debytes = xlz->decompress_file(decompress_in, decompress_out, input_size, cu);
+    std::cout << std::fixed << std::setprecision(3) << std::endl
+              << "Output Size(MB)\t\t:" << (double)debytes / 1000000 << std::endl
+              << "File Size(MB)\t\t:" << (double)input_size / 1000000 << std::endl
+              << "File Name\t\t:" << decompress_in << std::endl;
+
+    delete xlz;
+}
+
+int main(int argc, char* argv[]) {
+    int cu_run;
+    sda::utils::CmdLineParser parser;
+    parser.addSwitch("--decompress", "-d", "DeCompress", "");
+    parser.addSwitch("--single_xclbin", "-sx", "Single XCLBIN", "single");
+    parser.addSwitch("--file_list", "-l", "List of Input Files", "");
+    parser.addSwitch("--cu", "-k", "CU", "0");
+    parser.parse(argc, argv);
+
+    std::string filelist = parser.value("file_list");
+    std::string decompress_mod = parser.value("decompress");
+    std::string single_bin = parser.value("single_xclbin");
+    std::string cu = parser.value("cu");
+
+    if (cu.empty()) {
+        printf("please give -k option for cu\n");
+        exit(0);
+    } else {
+        cu_run = atoi(cu.c_str());
+    }
+
+    if (!filelist.empty()) {
+        // "-l" - List of files
+        xil_decompress_list(filelist, cu_run, single_bin);
+    } else if (!decompress_mod.empty()) {
+        // "-d" - DeCompress Mode
+        xil_decompress_top(decompress_mod, cu_run, single_bin);
+    }
+}
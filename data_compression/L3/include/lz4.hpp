@@ -24,8 +24,10 @@
 #ifndef _XFCOMPRESSION_XIL_LZ4_HPP_
 #define _XFCOMPRESSION_XIL_LZ4_HPP_
 
+#include <functional>
 #include <iomanip>
 #include "xcl2.hpp"
+#include "xxhash.h"
 
 /**
  * Maximum compute units supported
@@ -54,6 +56,29 @@
  */
 #define OVERLAP_BUF_COUNT 2
 
+/**
+ * Alignment required for buffers mapped directly
+ * to device memory (zero-copy)
+ */
+#define ZERO_COPY_ALIGN 4096
+
+/**
+ * Blocks smaller than this bypass the compress
+ * engines, their checksums are computed on host
+ */
+#define MIN_BLOCK_SIZE 128
+
+/**
+ * Largest preset dictionary, LZ4 offsets
+ * cannot reach further back than this
+ */
+#define MAX_DICT_SIZE (64 * 1024)
+
+/**
+ * Largest message accepted by the batched API
+ */
+#define MAX_BATCH_MSG_SIZE (64 * 1024)
+
 namespace xf {
 namespace compression {
 /**
@@ -134,6 +159,132 @@ class xfLz4 {
                           uint64_t actual_size,
                           bool file_list_flag);
 
+    /**
+     * @brief Decompress a byte range of a seekable .lz4 file, i.e.,
+     * one written with m_block_index set. Only the blocks covering the
+     * range are read and dispatched to the compute units.
+     *
+     * @param inFile_name input file name
+     * @param out output byte sequence, receives length bytes
+     * @param offset offset of the range in the original content
+     * @param length length of the range
+     * @param file_list_flag flag for list of files
+     */
+    uint64_t decompressRange(
+        std::string& inFile_name, uint8_t* out, uint64_t offset, uint64_t length, bool file_list_flag);
+
+    /**
+     * @brief Register a caller owned host buffer for zero-copy operation.
+     * compress/decompress map each chunk of a registered input (compress)
+     * or output (decompress) buffer to its own device buffer in the bank of
+     * the compute unit processing it, instead of staging every chunk through
+     * internal host buffers.
+     *
+     * @param ptr host buffer, must be 4 KB aligned
+     * @param size size of the host buffer in bytes
+     */
+    int registerBuffer(uint8_t* ptr, uint64_t size);
+
+    /**
+     * @brief Release a buffer registered with registerBuffer.
+     *
+     * @param ptr host buffer
+     */
+    int unregisterBuffer(uint8_t* ptr);
+
+    /**
+     * @brief Preload a trained dictionary into the LZ history of every
+     * compute unit. It is moved to the device once and stays resident,
+     * all later compress and decompress calls use it and frames carry
+     * its ID (FLG DictID). Only the last MAX_DICT_SIZE bytes are used,
+     * a size of 0 drops the dictionary.
+     *
+     * @param dict dictionary bytes
+     * @param size dictionary size
+     */
+    int setDictionary(const uint8_t* dict, uint32_t size);
+
+    /**
+     * @brief Compress a batch of small messages with a single kernel
+     * invocation per HOST_BUFFER_SIZE worth of messages. Every message
+     * becomes an independent LZ4 block written as a 4 byte little endian
+     * size, high bit set for stored messages, followed by the block data.
+     * out must hold the sum of msg_sizes plus 4 bytes per message.
+     *
+     * @param in messages packed back to back
+     * @param msg_sizes size of each message, at most MAX_BATCH_MSG_SIZE
+     * @param msg_count number of messages
+     * @param out output byte sequence
+     * @param out_offsets offset of each block in out, msg_count + 1 entries
+     * @param cu compute unit number
+     *
+     * @return total output size, 0 on error
+     */
+    uint64_t compressBatch(const uint8_t* in,
+                           const uint32_t* msg_sizes,
+                           uint32_t msg_count,
+                           uint8_t* out,
+                           uint64_t* out_offsets,
+                           int cu);
+
+    /**
+     * @brief Decompress a batch of blocks produced by compressBatch with a
+     * single kernel invocation per HOST_BUFFER_SIZE worth of messages.
+     * Messages are written to out back to back.
+     *
+     * @param in blocks produced by compressBatch
+     * @param in_offsets offset of each block in in
+     * @param msg_sizes original size of each message
+     * @param msg_count number of messages
+     * @param out output byte sequence
+     * @param cu compute unit number
+     *
+     * @return total output size, 0 on error
+     */
+    uint64_t decompressBatch(const uint8_t* in,
+                             const uint64_t* in_offsets,
+                             const uint32_t* msg_sizes,
+                             uint32_t msg_count,
+                             uint8_t* out,
+                             int cu);
+
+    /**
+     * Receives the compressed frame produced by the streaming API
+     */
+    typedef std::function<void(const uint8_t* data, uint64_t size)> streamSink;
+
+    /**
+     * @brief Start compression of a stream of unknown length. The frame
+     * header, without content size, is handed to sink right away.
+     *
+     * @param sink receives the frame as it is produced
+     */
+    int begin(streamSink sink);
+
+    /**
+     * @brief Push input to the stream. Every filled chunk is dispatched
+     * to the next compute unit, compressed blocks are handed to sink as
+     * soon as their chunk completes. Host memory stays bounded by the
+     * overlapped chunk buffers regardless of stream length.
+     *
+     * @param in input byte sequence
+     * @param size input size
+     */
+    int write(const uint8_t* in, uint64_t size);
+
+    /**
+     * @brief Compress the partially filled chunk and wait until every
+     * byte written so far has been handed to sink.
+     */
+    int flush();
+
+    /**
+     * @brief Flush the stream and hand the frame footer to sink.
+     *
+     * @return total size of the frame
+     */
+    uint64_t end();
+
     /**
      * Binary flow compress/decompress
      */
@@ -149,6 +300,21 @@ class xfLz4 {
      */
     bool m_switch_flow;
 
+    /**
+     * Append xxHash32 of every block (FLG B.Checksum)
+     */
+    bool m_block_checksum;
+
+    /**
+     * Append xxHash32 of the original content (FLG C.Checksum)
+     */
+    bool m_content_checksum;
+
+    /**
+     * Append a block index so the frame can be read with decompressRange
+     */
+    bool m_block_index;
+
     /**
      * @brief Class constructor
      *
@@ -161,6 +327,40 @@ class xfLz4 {
     ~xfLz4();
 
    private:
+    // Returns a device buffer over [ptr, ptr + size) if the range belongs to a
+    // registered buffer and meets the alignment rules, otherwise nullptr
+    cl::Buffer* getBufferView(uint8_t* ptr, uint32_t size, cl_mem_flags flags);
+
+    struct registeredBuffer {
+        uint8_t* ptr;
+        uint64_t size;
+    };
+
+    // Location of one block within a frame
+    struct blockInfo {
+        uint64_t in_offset;
+        uint32_t compressed_size;
+        uint32_t block_size;
+    };
+
+    // Original size of a frame without the content size field, 0 if the
+    // frame is malformed or has short blocks other than the last one
+    uint64_t frameContentSize(const uint8_t* in, uint64_t input_size);
+
+    // Walks the block headers of a frame, returns -1 if it is malformed
+    int indexFrame(uint8_t* in, uint64_t input_size, uint64_t original_size, std::vector<blockInfo>& blocks);
+
+    // Serializes the block index frame from the stored size of each block
+    std::vector<uint8_t> packBlockIndex(const std::vector<uint32_t>& block_bytes, uint64_t original_size);
+
+    // (Re)creates the per compute unit dictionary buffers
+    void createDictBuffers();
+
+    // Streaming: launch the chunk staged in the current slot
+    void streamSubmit();
+    // Streaming: wait for the oldest chunk and hand its blocks to sink
+    void streamRetire();
+
     cl::Program* m_program;
     cl::Context* m_context;
     cl::CommandQueue* m_q;
@@ -172,12 +372,42 @@ class xfLz4 {
     std::vector<uint8_t, aligned_allocator<uint8_t> > h_buf_out[MAX_COMPUTE_UNITS][OVERLAP_BUF_COUNT];
     std::vector<uint32_t, aligned_allocator<uint8_t> > h_blksize[MAX_COMPUTE_UNITS][OVERLAP_BUF_COUNT];
     std::vector<uint32_t, aligned_allocator<uint8_t> > h_compressSize[MAX_COMPUTE_UNITS][OVERLAP_BUF_COUNT];
+    std::vector<uint32_t, aligned_allocator<uint8_t> > h_blkChecksum[MAX_COMPUTE_UNITS][OVERLAP_BUF_COUNT];
 
     // Device buffers
     cl::Buffer* buffer_input[MAX_COMPUTE_UNITS][OVERLAP_BUF_COUNT];
     cl::Buffer* buffer_output[MAX_COMPUTE_UNITS][OVERLAP_BUF_COUNT];
     cl::Buffer* buffer_compressed_size[MAX_COMPUTE_UNITS][OVERLAP_BUF_COUNT];
     cl::Buffer* buffer_block_size[MAX_COMPUTE_UNITS][OVERLAP_BUF_COUNT];
+    cl::Buffer* buffer_block_checksum[MAX_COMPUTE_UNITS][OVERLAP_BUF_COUNT];
+
+    // Content checksum of the last compress call
+    uint32_t m_content_hash;
+
+    // Preset dictionary, resident on every compute unit
+    std::vector<uint8_t, aligned_allocator<uint8_t> > h_dict[MAX_COMPUTE_UNITS];
+    cl::Buffer* buffer_dict[MAX_COMPUTE_UNITS];
+    uint32_t m_dict_size;
+    uint32_t m_dict_id;
+
+    // Streaming related, chunks rotate over [cu][flag] slots
+    streamSink m_sink;
+    bool m_stream_active;
+    uint32_t m_stream_chunk;
+    uint32_t m_stream_fill;
+    uint32_t m_stream_slot;
+    uint32_t m_stream_inflight;
+    uint64_t m_stream_total;
+    uint64_t m_stream_raw;
+    std::vector<uint32_t> m_stream_index;
+    uint32_t m_stream_size[MAX_COMPUTE_UNITS][OVERLAP_BUF_COUNT];
+    cl::Event m_stream_event[MAX_COMPUTE_UNITS][OVERLAP_BUF_COUNT];
+    XXH32_state_t* m_stream_state;
+    std::vector<uint8_t> m_stream_out;
+
+    // Zero-copy related
+    std::vector<registeredBuffer> m_registered;
+    cl::Buffer* buffer_view[MAX_COMPUTE_UNITS][OVERLAP_BUF_COUNT];
 
     // Decompression related
     std::vector<uint32_t> m_blkSize[MAX_COMPUTE_UNITS][OVERLAP_BUF_COUNT];
@@ -25,6 +25,7 @@
 #include <time.h>
 #include <string>
 #include <fstream>
+#include <functional>
 #include "xcl2.hpp"
 
 const int gz_max_literal_count = 4096;
@@ -86,6 +87,12 @@ const int gz_max_literal_count = 4096;
 // Maximum number of blocks based on host buffer size
 #define MAX_NUMBER_BLOCKS (HOST_BUFFER_SIZE / (BLOCK_SIZE_IN_KB * 1024))
 
+// Blocks smaller than this bypass the LZ77 engines
+#define MIN_BLOCK_SIZE 128
+
+// Compression level used by the default xclbin
+#define DEFAULT_COMPRESSION_LEVEL 6
+
 int validate(std::string& inFile_name, std::string& outFile_name);
 
 uint32_t get_file_size(std::ifstream& file);
@@ -137,7 +144,9 @@ class xfZlib {
 
     /**
      * @brief This module does serial execution of decompression
-     * where data transfers and kernel execution in serial manner
+     * where data transfers and kernel execution in serial manner.
+     * gzip input made of several members, such as pigz or BGZF
+     * output, is decompressed on all CUs concurrently instead.
      *
      * @param in input byte sequence
      * @param out output byte sequence
@@ -194,6 +203,43 @@ class xfZlib {
 
     uint32_t decompress_file(std::string& inFile_name, std::string& outFile_name, uint64_t input_size, int cu_run);
 
+    /**
+     * Receives the compressed stream produced by the streaming API
+     */
+    typedef std::function<void(const uint8_t* data, uint64_t size)> streamSink;
+
+    /**
+     * @brief Start compression of a stream of unknown length. The stream
+     * header is handed to sink right away.
+     *
+     * @param sink receives the compressed stream as it is produced
+     */
+    int begin(streamSink sink);
+
+    /**
+     * @brief Push input to the stream. Every filled chunk is dispatched
+     * to the next compute unit, its deflate blocks are handed to sink as
+     * soon as the chunk completes.
+     *
+     * @param in input byte sequence
+     * @param size input size
+     */
+    int write(const uint8_t* in, uint64_t size);
+
+    /**
+     * @brief Compress the partially filled chunk and wait until every
+     * byte written so far has been handed to sink.
+     */
+    int flush();
+
+    /**
+     * @brief Flush the stream, close the deflate stream and hand the
+     * trailer to sink.
+     *
+     * @return total size of the compressed stream
+     */
+    uint64_t end();
+
     /**
      * @brief This module is used for profiling by using kernel events
      *
@@ -203,10 +249,15 @@ class xfZlib {
     uint64_t get_event_duration_ns(const cl::Event& event);
 
     /**
-     * @brief Class constructor
+     * @brief Class constructor. Levels 1-3 load the fast build of the
+     * xclbin (binaryFile with a _fast suffix) and levels 7-9 the best
+     * build (_best suffix), the given xclbin is used when the build for
+     * the level is missing.
      *
+     * @param binaryFile xclbin of the default level
+     * @param level compression level 1-9
      */
-    xfZlib(const std::string& binaryFile);
+    xfZlib(const std::string& binaryFile, int level = DEFAULT_COMPRESSION_LEVEL);
 
     /**
      * @brief Class destructor.
@@ -214,6 +265,38 @@ class xfZlib {
     ~xfZlib();
 
    private:
+    // gzip member located by the host
+    struct gzipMember {
+        uint32_t offset; // first byte of the deflate data
+        uint32_t size;   // deflate data and trailer
+        uint32_t isize;  // uncompressed size from the trailer
+        bool tentative;  // end not given by a BGZF block size
+    };
+
+    // Splits gzip input from start into members appended to members,
+    // false when in is not gzip
+    static bool gzipMembers(const uint8_t* in,
+                            uint32_t input_size,
+                            std::vector<gzipMember>& members,
+                            uint32_t start = 0);
+
+    // Decompresses gzip members concurrently on all decompress CUs
+    uint32_t decompressMembers(const uint8_t* in, uint8_t* out, uint32_t input_size, std::vector<gzipMember>& members);
+
+    // Decompresses one deflate stream on cu, output_size bounds its output.
+    // end receives the input size up to the end of the final block, 0 when
+    // the input ends before it
+    uint32_t decompressSingle(
+        uint8_t* in, uint8_t* out, uint32_t input_size, uint64_t output_size, int cu, uint32_t* end = nullptr);
+
+    // xclbin built for the compression level, level is set to the one loaded
+    static std::string levelBinary(const std::string& binaryFile, int& level);
+
+    // Streaming: launch the chunk staged in the current slot
+    void streamSubmit();
+    // Streaming: wait for the oldest chunk and hand its blocks to sink
+    void streamRetire();
+
     cl::Program* m_program;
     cl::Context* m_context;
     cl::CommandQueue* m_q[C_COMPUTE_UNIT * OVERLAP_BUF_COUNT];
@@ -231,11 +314,31 @@ class xfZlib {
     std::vector<uint8_t, aligned_allocator<uint8_t> > h_buf_zlibout[MAX_CCOMP_UNITS][OVERLAP_BUF_COUNT];
     std::vector<uint32_t, aligned_allocator<uint32_t> > h_blksize[MAX_CCOMP_UNITS][OVERLAP_BUF_COUNT];
     std::vector<uint32_t, aligned_allocator<uint32_t> > h_compressSize[MAX_CCOMP_UNITS][OVERLAP_BUF_COUNT];
+    std::vector<uint32_t, aligned_allocator<uint32_t> > h_checksum[MAX_CCOMP_UNITS][OVERLAP_BUF_COUNT];
+
+    // CRC32 of the data processed by last compress call
+    uint32_t m_crc32;
+
+    // Compression level 1-9
+    int m_level;
+
+    // Streaming related, chunks rotate over [cu][flag] slots
+    streamSink m_sink;
+    bool m_stream_active;
+    uint32_t m_stream_fill;
+    uint32_t m_stream_slot;
+    uint32_t m_stream_inflight;
+    uint64_t m_stream_total;
+    uint64_t m_stream_isize;
+    uint32_t m_stream_adler;
+    uint32_t m_stream_size[MAX_CCOMP_UNITS][OVERLAP_BUF_COUNT];
+    cl::Event m_stream_event[MAX_CCOMP_UNITS][OVERLAP_BUF_COUNT];
 
     // Decompression Related
     std::vector<uint8_t, aligned_allocator<uint8_t> > h_dbuf_in[MAX_DDCOMP_UNITS];
     std::vector<uint8_t, aligned_allocator<uint8_t> > h_dbuf_zlibout[MAX_DDCOMP_UNITS];
     std::vector<uint32_t, aligned_allocator<uint32_t> > h_dcompressSize[MAX_DDCOMP_UNITS];
+    std::vector<uint32_t, aligned_allocator<uint32_t> > h_dcompressEnd[MAX_DDCOMP_UNITS];
 
 
     // Literal & length frequency tree
@@ -267,6 +370,7 @@ class xfZlib {
     cl::Buffer* buffer_zlib_output[MAX_CCOMP_UNITS][OVERLAP_BUF_COUNT];
     cl::Buffer* buffer_compress_size[MAX_CCOMP_UNITS][OVERLAP_BUF_COUNT];
     cl::Buffer* buffer_inblk_size[MAX_CCOMP_UNITS][OVERLAP_BUF_COUNT];
+    cl::Buffer* buffer_checksum[MAX_CCOMP_UNITS][OVERLAP_BUF_COUNT];
 
     cl::Buffer* buffer_dyn_ltree_freq[MAX_CCOMP_UNITS][OVERLAP_BUF_COUNT];
     cl::Buffer* buffer_dyn_dtree_freq[MAX_CCOMP_UNITS][OVERLAP_BUF_COUNT];
@@ -0,0 +1,155 @@
+/*
+ * (c) Copyright 2019 Xilinx, Inc. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef _XFCOMPRESSION_ZSTD_HPP_
+#define _XFCOMPRESSION_ZSTD_HPP_
+
+#include <iomanip>
+#include <iostream>
+#include <stdint.h>
+#include <vector>
+#include <string>
+#include <fstream>
+#include "xcl2.hpp"
+#include "xxhash.h"
+
+#define MAX_DDCOMP_UNITS D_COMPUTE_UNIT
+
+// Frame magic numbers
+#define ZSTD_MAGIC 0xFD2FB528
+#define ZSTD_SKIPPABLE_MAGIC 0x184D2A50
+#define ZSTD_SKIPPABLE_MASK 0xFFFFFFF0
+
+// Kernel status codes, see zstd_decompress.hpp
+#define ZSTD_OK 0
+#define ZSTD_ERR_MAGIC 1
+#define ZSTD_ERR_WINDOW 2
+#define ZSTD_ERR_DICTIONARY 3
+#define ZSTD_ERR_CORRUPT 4
+#define ZSTD_ERR_OVERFLOW 5
+
+// Output is sized by this ratio when frames do not carry their content size
+#define ZSTD_DEFAULT_RATIO 10
+
+// Largest buffer a kernel invocation can address
+#define ZSTD_MAX_KERNEL_BUFFER 0xFFFFFFFFULL
+
+namespace xf {
+namespace compression {
+
+/**
+ *  xfZstd class. Class containing methods for zstd
+ * decompression to be executed on host side.
+ */
+class xfZstd {
+   public:
+    /**
+     * @brief Initialize the class object.
+     *
+     * @param binaryFile file to be read
+     */
+    int init(const std::string& binaryFile);
+
+    /**
+     * @brief release
+     *
+     */
+    int release();
+
+    /**
+     * @brief This module does serial execution of decompression
+     * where data transfers and kernel execution in serial manner.
+     * Content checksums of the frames are verified on the host.
+     *
+     * @param in input byte sequence
+     * @param out output byte sequence
+     * @param input_size input size
+     * @param output_size capacity of out
+     * @param cu_run compute unit number
+     *
+     * @return decompressed size, 0 on error
+     */
+    uint64_t decompress(uint8_t* in, uint8_t* out, uint64_t input_size, uint64_t output_size, int cu_run);
+
+    /**
+     * @brief This module does file operations and invokes decompress API which
+     * internally does zstd decompression on FPGA. The output buffer is sized
+     * from the frame content sizes and grown if the kernel runs out of space.
+     *
+     * @param inFile_name input file name
+     * @param outFile_name output file name
+     * @param input_size input size
+     * @param cu_run compute unit number
+     */
+    uint64_t decompress_file(std::string& inFile_name, std::string& outFile_name, uint64_t input_size, int cu_run);
+
+    /**
+     * @brief Sum of the content sizes declared by the frame headers.
+     *
+     * @param in input byte sequence
+     * @param input_size input size
+     *
+     * @return decompressed size, 0 if any frame omits its content size
+     */
+    static uint64_t getDecompressedSize(const uint8_t* in, uint64_t input_size);
+
+    /**
+     * @brief Class constructor
+     *
+     */
+    xfZstd(const std::string& binaryFile);
+
+    /**
+     * @brief Class destructor.
+     */
+    ~xfZstd();
+
+   private:
+    struct frameInfo {
+        uint64_t content_size;
+        bool has_size;
+        bool has_checksum;
+        uint32_t checksum;
+    };
+
+    // Walks frame and block headers of the input
+    static bool parseFrames(const uint8_t* in, uint64_t input_size, std::vector<frameInfo>& frames);
+
+    // Checks XXH64 content checksums of every frame which can be located in out
+    static bool verifyChecksum(const uint8_t* in, uint64_t input_size, const uint8_t* out, uint64_t output_size);
+
+    // Status of the last kernel run
+    uint32_t m_status;
+
+    cl::Program* m_program;
+    cl::Context* m_context;
+    cl::CommandQueue* m_q_dec[D_COMPUTE_UNIT];
+
+    // Kernel declaration
+    cl::Kernel* decompress_kernel[D_COMPUTE_UNIT];
+
+    // Decompression Related
+    std::vector<uint8_t, aligned_allocator<uint8_t> > h_dbuf_in[MAX_DDCOMP_UNITS];
+    std::vector<uint8_t, aligned_allocator<uint8_t> > h_dbuf_zstdout[MAX_DDCOMP_UNITS];
+    std::vector<uint32_t, aligned_allocator<uint32_t> > h_dcompressSize[MAX_DDCOMP_UNITS];
+    std::vector<uint32_t, aligned_allocator<uint32_t> > h_dstatus[MAX_DDCOMP_UNITS];
+
+    // Kernel names
+    std::vector<std::string> decompress_kernel_names = {"xilZstdDecompress"};
+};
+}
+}
+#endif
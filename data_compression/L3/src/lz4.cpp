@@ -15,8 +15,11 @@
  *
  */
 #include "xxhash.h"
+#include <algorithm>
 #include <iostream>
+#include <atomic>
 #include <cassert>
+#include <thread>
 #include <vector>
 #include "lz4.hpp"
 #include "lz4_specs.hpp"
@@ -43,6 +46,68 @@ uint64_t getEventDurationNs(const cl::Event& event) {
     return (end_time - start_time);
 }
 
+// Decoded size of an LZ4 compressed block, sums the literal and match
+// lengths of its sequences without decoding them
+static uint32_t blockContentSize(const uint8_t* src, uint32_t size) {
+    uint32_t idx = 0;
+    uint32_t out = 0;
+    while (idx < size) {
+        uint8_t token = src[idx++];
+        uint32_t literals = token >> 4;
+        if (literals == 15) {
+            uint8_t b = 255;
+            while (b == 255 && idx < size) {
+                b = src[idx++];
+                literals += b;
+            }
+        }
+        out += literals;
+        idx += literals;
+        // Last sequence has literals only
+        if (idx + 2 > size) break;
+        idx += 2;
+
+        uint32_t match = token & 0xF;
+        if (match == 15) {
+            uint8_t b = 255;
+            while (b == 255 && idx < size) {
+                b = src[idx++];
+                match += b;
+            }
+        }
+        out += match + 4;
+    }
+    return out;
+}
+
+// Size of the block index frame ending at in + size, 0 if there is none.
+// The trailing magic alone may occur in compressed data, so the skippable
+// frame header at the start the footer implies has to match as well.
+static uint64_t seekIndexSize(const uint8_t* in, uint64_t size) {
+    if (size < 8 + lz4_specs::SEEK_FOOTER_SIZE) return 0;
+    const uint8_t* footer = in + size - lz4_specs::SEEK_FOOTER_SIZE;
+    uint32_t seek_magic = 0;
+    std::memcpy(&seek_magic, &footer[12], 4);
+    if (seek_magic != lz4_specs::SEEK_INDEX_MAGIC) return 0;
+
+    uint64_t original_size = 0;
+    uint32_t block_size_in_kb = 0;
+    std::memcpy(&original_size, &footer[0], 8);
+    std::memcpy(&block_size_in_kb, &footer[8], 4);
+    if (original_size == 0 || block_size_in_kb == 0) return 0;
+    uint64_t total_blocks = (original_size - 1) / ((uint64_t)block_size_in_kb * 1024) + 1;
+    uint64_t frame_size = total_blocks * 4 + lz4_specs::SEEK_FOOTER_SIZE;
+    if (frame_size > size - 8) return 0;
+
+    const uint8_t* start = in + size - 8 - frame_size;
+    uint32_t magic = 0;
+    uint32_t stored_size = 0;
+    std::memcpy(&magic, &start[0], 4);
+    std::memcpy(&stored_size, &start[4], 4);
+    if (magic != lz4_specs::SKIPPABLE_MAGIC || stored_size != frame_size) return 0;
+    return 8 + frame_size;
+}
+
 uint64_t xfLz4::compressFile(std::string& inFile_name,
                              std::string& outFile_name,
                              uint64_t input_size,
@@ -56,8 +121,11 @@ uint64_t xfLz4::compressFile(std::string& inFile_name,
             exit(1);
         }
 
+        // Block size and checksum fields may exceed the gain on
+        // incompressible input
+        uint64_t frame_overhead = ((input_size - 1) / (m_block_size_in_kb * 1024) + 1) * 8;
         std::vector<uint8_t, aligned_allocator<uint8_t> > in(input_size);
-        std::vector<uint8_t, aligned_allocator<uint8_t> > out(input_size);
+        std::vector<uint8_t, aligned_allocator<uint8_t> > out(input_size + frame_overhead);
 
         inFile.read((char*)in.data(), input_size);
 
@@ -68,9 +136,13 @@ uint64_t xfLz4::compressFile(std::string& inFile_name,
         outFile.put(MAGIC_BYTE_4);
 
         // FLG & BD bytes
-        // --no-frame-crc flow
+        // --no-frame-crc flow unless checksums are requested
         // --content-size
-        outFile.put(FLG_BYTE);
+        uint8_t flg = FLG_BYTE;
+        if (m_block_checksum) flg |= lz4_specs::FLG_BLOCK_CHECKSUM;
+        if (m_content_checksum) flg |= lz4_specs::FLG_CONTENT_CHECKSUM;
+        if (m_dict_size) flg |= lz4_specs::FLG_DICT_ID;
+        outFile.put(flg);
 
         // Default value 64K
         uint8_t block_size_header = 0;
@@ -100,7 +172,7 @@ uint64_t xfLz4::compressFile(std::string& inFile_name,
 
         if ((m_block_size_in_kb * 1024) > input_size) host_buffer_size = m_block_size_in_kb * 1024;
 
-        uint64_t temp_buff[10] = {FLG_BYTE,         block_size_header, input_size,       input_size >> 8,
+        uint64_t temp_buff[10] = {flg,              block_size_header, input_size,       input_size >> 8,
                                   input_size >> 16, input_size >> 24,  input_size >> 32, input_size >> 40,
                                   input_size >> 48, input_size >> 56};
 
@@ -109,10 +181,16 @@ uint64_t xfLz4::compressFile(std::string& inFile_name,
         uint64_t enbytes;
         outFile.write((char*)&temp_buff[2], 8);
 
+        // Dictionary ID follows the content size
+        if (m_dict_size) outFile.write((char*)&m_dict_id, 4);
+
         // Header CRC
         outFile.put((uint8_t)(xxh >> 8));
         // LZ4 overlap & multiple compute unit compress
+        // Input is page aligned, let the kernels read it in place
+        registerBuffer(in.data(), input_size);
         enbytes = compress(in.data(), out.data(), input_size, host_buffer_size, file_list_flag);
+        unregisterBuffer(in.data());
         // Writing compressed data
         outFile.write((char*)out.data(), enbytes);
 
@@ -121,6 +199,21 @@ uint64_t xfLz4::compressFile(std::string& inFile_name,
         outFile.put(0);
         outFile.put(0);
 
+        // Content checksum follows the EndMark
+        if (m_content_checksum) outFile.write((char*)&m_content_hash, 4);
+
+        // Block index for random access, blocks are walked by header only
+        if (m_block_index) {
+            std::vector<blockInfo> blocks;
+            if (indexFrame(out.data(), enbytes, input_size, blocks) == 0) {
+                std::vector<uint32_t> block_bytes(blocks.size());
+                for (uint32_t b = 0; b < blocks.size(); b++)
+                    block_bytes[b] = 4 + blocks[b].compressed_size + (m_block_checksum ? 4 : 0);
+                std::vector<uint8_t> index = packBlockIndex(block_bytes, input_size);
+                outFile.write((char*)index.data(), index.size());
+            }
+        }
+
         // Close file
         inFile.close();
         outFile.close();
@@ -145,11 +238,24 @@ xfLz4::xfLz4() {
             h_buf_out[i][j].resize(HOST_BUFFER_SIZE);
             h_blksize[i][j].resize(MAX_NUMBER_BLOCKS);
             h_compressSize[i][j].resize(MAX_NUMBER_BLOCKS);
+            h_blkChecksum[i][j].resize(2 * MAX_NUMBER_BLOCKS);
 
             m_compressSize[i][j].reserve(MAX_NUMBER_BLOCKS);
             m_blkSize[i][j].reserve(MAX_NUMBER_BLOCKS);
+
+            buffer_view[i][j] = nullptr;
         }
+        h_dict[i].resize(64);
+        buffer_dict[i] = nullptr;
     }
+    m_block_checksum = false;
+    m_content_checksum = false;
+    m_content_hash = 0;
+    m_block_index = false;
+    m_stream_active = false;
+    m_stream_state = nullptr;
+    m_dict_size = 0;
+    m_dict_id = 0;
 }
 
 // Destructor
@@ -195,6 +301,7 @@ int xfLz4::init(const std::string& binaryFile) {
             decompress_kernel_lz4[i] = new cl::Kernel(*m_program, krnl_name_full.c_str());
         }
     }
+    createDictBuffers();
 
     return 0;
 }
@@ -205,6 +312,12 @@ int xfLz4::release() {
     } else {
         for (uint32_t i = 0; i < D_COMPUTE_UNIT; i++) delete (decompress_kernel_lz4[i]);
     }
+    m_registered.clear();
+    for (uint32_t i = 0; i < MAX_COMPUTE_UNITS; i++) {
+        delete (buffer_dict[i]);
+        buffer_dict[i] = nullptr;
+    }
+
     delete (m_program);
     delete (m_q);
     delete (m_context);
@@ -212,6 +325,87 @@ int xfLz4::release() {
     return 0;
 }
 
+void xfLz4::createDictBuffers() {
+    uint32_t num_cu = m_bin_flow ? C_COMPUTE_UNIT : D_COMPUTE_UNIT;
+    for (uint32_t cu = 0; cu < num_cu; cu++) {
+        delete (buffer_dict[cu]);
+        buffer_dict[cu] = new cl::Buffer(*m_context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, h_dict[cu].size(),
+                                         h_dict[cu].data());
+        // Binding the argument places the buffer in the bank of the
+        // compute unit, it is migrated once here and stays resident
+        if (m_bin_flow)
+            compress_kernel_lz4[cu]->setArg(5, *(buffer_dict[cu]));
+        else
+            decompress_kernel_lz4[cu]->setArg(4, *(buffer_dict[cu]));
+        m_q->enqueueMigrateMemObjects({*(buffer_dict[cu])}, 0);
+    }
+    m_q->finish();
+}
+
+int xfLz4::setDictionary(const uint8_t* dict, uint32_t size) {
+    if (size > 0 && dict == nullptr) return -1;
+    // Offsets reach back MAX_DICT_SIZE bytes, older content is useless
+    if (size > MAX_DICT_SIZE) {
+        dict += size - MAX_DICT_SIZE;
+        size = MAX_DICT_SIZE;
+    }
+    uint32_t dict_buf_size = (size == 0) ? 64 : ((size - 1) / 64 + 1) * 64;
+    for (uint32_t cu = 0; cu < MAX_COMPUTE_UNITS; cu++) {
+        h_dict[cu].assign(dict_buf_size, 0);
+        if (size) std::memcpy(h_dict[cu].data(), dict, size);
+    }
+    m_dict_size = size;
+    m_dict_id = size ? XXH32(dict, size, 0) : 0;
+    createDictBuffers();
+    return 0;
+}
+
+int xfLz4::registerBuffer(uint8_t* ptr, uint64_t size) {
+    if (ptr == nullptr || size == 0) return -1;
+    if (((uintptr_t)ptr) % ZERO_COPY_ALIGN) {
+        std::cout << "registerBuffer: buffer is not " << ZERO_COPY_ALIGN << " byte aligned" << std::endl;
+        return -1;
+    }
+    for (auto& reg : m_registered) {
+        if (ptr < reg.ptr + reg.size && reg.ptr < ptr + size) {
+            std::cout << "registerBuffer: buffer overlaps a registered buffer" << std::endl;
+            return -1;
+        }
+    }
+
+    // Device buffers are made per chunk by getBufferView, a single buffer over
+    // the whole range would sit in one bank and may exceed the allocation limit
+    m_registered.push_back({ptr, size});
+    return 0;
+}
+
+int xfLz4::unregisterBuffer(uint8_t* ptr) {
+    for (auto it = m_registered.begin(); it != m_registered.end(); it++) {
+        if (it->ptr == ptr) {
+            m_registered.erase(it);
+            return 0;
+        }
+    }
+    return -1;
+}
+
+cl::Buffer* xfLz4::getBufferView(uint8_t* ptr, uint32_t size, cl_mem_flags flags) {
+    for (auto& reg : m_registered) {
+        if (ptr < reg.ptr || ptr >= reg.ptr + reg.size) continue;
+
+        uint64_t offset = ptr - reg.ptr;
+        // Kernels access global memory in 64 byte words, the view must
+        // cover the last partial word and start on a device aligned origin
+        uint64_t view_size = ((size - 1) / 64 + 1) * 64;
+        if ((offset % ZERO_COPY_ALIGN) || (offset + view_size > reg.size)) return nullptr;
+
+        // The view shares the caller memory, binding it to the kernel of a
+        // compute unit before migration places it in the bank of that unit
+        return new cl::Buffer(*m_context, CL_MEM_USE_HOST_PTR | flags, view_size, ptr);
+    }
+    return nullptr;
+}
+
 uint64_t xfLz4::decompressFile(std::string& inFile_name,
                                std::string& outFile_name,
                                uint64_t input_size,
@@ -240,8 +434,13 @@ uint64_t xfLz4::decompressFile(std::string& inFile_name,
             }
         }
 
-        // Header Checksum
+        // FLG byte, checksum flags of the frame
         inFile.get(c);
+        m_block_checksum = (c & lz4_specs::FLG_BLOCK_CHECKSUM);
+        m_content_checksum = (c & lz4_specs::FLG_CONTENT_CHECKSUM);
+        bool has_content_size = (c & lz4_specs::FLG_CONTENT_SIZE);
+        bool has_dict_id = (c & lz4_specs::FLG_DICT_ID);
+        uint64_t header_size = MAGIC_HEADER_SIZE + 3;
 
         // Check if block size is 64 KB
         inFile.get(c);
@@ -266,17 +465,38 @@ uint64_t xfLz4::decompressFile(std::string& inFile_name,
         }
         // printf("m_block_size_in_kb %d \n", m_block_size_in_kb);
 
-        // Original size
+        // Original size, optional in the frame header
         uint64_t original_size = 0;
-        inFile.read((char*)&original_size, 8);
+        if (has_content_size) {
+            inFile.read((char*)&original_size, 8);
+            header_size += 8;
+        }
+
+        // Frames compressed against a dictionary name it
+        if (has_dict_id) {
+            uint32_t dict_id = 0;
+            inFile.read((char*)&dict_id, 4);
+            header_size += 4;
+            if (m_dict_size == 0 || dict_id != m_dict_id) {
+                std::cout << "Dictionary " << std::hex << dict_id << std::dec << " is not loaded" << std::endl;
+                return 0;
+            }
+        }
         inFile.get(c);
-        // printf("original_size %d \n", original_size);
+
+        // Read block data from compressed stream .lz4
+        inFile.read((char*)in.data(), (input_size - header_size));
+        uint64_t frame_size = input_size - header_size;
+
+        // Without a content size the blocks tell the original size
+        if (!has_content_size) original_size = frameContentSize(in.data(), frame_size);
+        if (original_size == 0) return 0;
 
         // Allocat output size
         std::vector<uint8_t, aligned_allocator<uint8_t> > out(original_size);
 
-        // Read block data from compressed stream .lz4
-        inFile.read((char*)in.data(), (input_size - 15));
+        // A trailing block index is not part of the frame
+        frame_size -= seekIndexSize(in.data(), frame_size);
 
         uint32_t host_buffer_size = (m_block_size_in_kb * 1024) * 32;
 
@@ -284,7 +504,20 @@ uint64_t xfLz4::decompressFile(std::string& inFile_name,
 
         uint64_t debytes;
         // Decompression Overlapped multiple cu solution
-        debytes = decompress(in.data(), out.data(), (input_size - 15), original_size, host_buffer_size, file_list_flag);
+        // Output is page aligned, let the kernels write it in place
+        registerBuffer(out.data(), original_size);
+        debytes = decompress(in.data(), out.data(), frame_size, original_size, host_buffer_size, file_list_flag);
+        unregisterBuffer(out.data());
+
+        // Content checksum is the last field of the frame
+        if (m_content_checksum && debytes) {
+            uint32_t content_hash = 0;
+            std::memcpy(&content_hash, &in[frame_size - 4], 4);
+            if (content_hash != XXH32(out.data(), debytes, 0)) {
+                std::cout << "Content checksum mismatch" << std::endl;
+                debytes = 0;
+            }
+        }
         outFile.write((char*)out.data(), debytes);
         // Close file
         inFile.close();
@@ -297,6 +530,76 @@ uint64_t xfLz4::decompressFile(std::string& inFile_name,
     }
 }
 
+uint64_t xfLz4::frameContentSize(const uint8_t* in, uint64_t input_size) {
+    uint32_t block_size_in_bytes = m_block_size_in_kb * 1024;
+    uint32_t trailer = m_block_checksum ? 4 : 0;
+    uint64_t content_size = 0;
+    uint64_t inIdx = 0;
+
+    while (inIdx + 4 <= input_size) {
+        uint32_t compressed_size = 0;
+        std::memcpy(&compressed_size, &in[inIdx], 4);
+        inIdx += 4;
+
+        // EndMark closes the frame
+        if (compressed_size == 0) return content_size;
+
+        bool stored = ((compressed_size >> 24) == lz4_specs::NO_COMPRESS_BIT);
+        if (stored) compressed_size &= 0xFFFFFF;
+        uint64_t next = inIdx + compressed_size + trailer;
+        if (next + 4 > input_size) break;
+
+        // Only the last block may be short, so only its sequences are walked
+        uint32_t next_header = 0;
+        std::memcpy(&next_header, &in[next], 4);
+        uint32_t block_size = block_size_in_bytes;
+        if (stored)
+            block_size = compressed_size;
+        else if (next_header == 0)
+            block_size = blockContentSize(&in[inIdx], compressed_size);
+        if (block_size > block_size_in_bytes || (block_size < block_size_in_bytes && next_header != 0)) break;
+
+        content_size += block_size;
+        inIdx = next;
+    }
+    std::cout << "Invalid LZ4 frame, content size unknown" << std::endl;
+    return 0;
+}
+
+int xfLz4::indexFrame(uint8_t* in, uint64_t input_size, uint64_t original_size, std::vector<blockInfo>& blocks) {
+    uint32_t block_size_in_bytes = m_block_size_in_kb * 1024;
+    uint32_t total_block_cnt = (original_size - 1) / block_size_in_bytes + 1;
+    uint32_t trailer = m_block_checksum ? 4 : 0;
+    uint64_t inIdx = 0;
+
+    blocks.resize(total_block_cnt);
+    for (uint32_t b = 0; b < total_block_cnt; b++) {
+        uint32_t block_size = block_size_in_bytes;
+        if (b == (total_block_cnt - 1)) block_size = original_size - (uint64_t)b * block_size_in_bytes;
+
+        if (inIdx + 4 > input_size) {
+            std::cout << "Truncated LZ4 frame" << std::endl;
+            return -1;
+        }
+        uint32_t compressed_size = 0;
+        std::memcpy(&compressed_size, &in[inIdx], 4);
+        inIdx += 4;
+
+        // Uncompressed block, the high bit flags it
+        if ((compressed_size >> 24) == lz4_specs::NO_COMPRESS_BIT) compressed_size &= 0xFFFFFF;
+        if (compressed_size > block_size || inIdx + compressed_size + trailer > input_size) {
+            std::cout << "Invalid LZ4 block " << b << std::endl;
+            return -1;
+        }
+
+        blocks[b].in_offset = inIdx;
+        blocks[b].compressed_size = compressed_size;
+        blocks[b].block_size = block_size;
+        inIdx += compressed_size + trailer;
+    }
+    return 0;
+}
+
 uint64_t xfLz4::decompress(uint8_t* in,
                            uint8_t* out,
                            uint64_t input_size,
@@ -312,9 +615,6 @@ uint64_t xfLz4::decompress(uint8_t* in,
             h_buf_out[i][j].resize(host_buffer_size);
             h_blksize[i][j].resize(max_num_blks);
             h_compressSize[i][j].resize(max_num_blks);
-
-            m_compressSize[i][j].reserve(max_num_blks);
-            m_blkSize[i][j].reserve(max_num_blks);
         }
     }
 
@@ -322,11 +622,6 @@ uint64_t xfLz4::decompress(uint8_t* in,
     uint64_t total_write_time = 0;
     uint64_t total_read_time = 0;
     uint64_t total_kernel_time = 0;
-
-    // Total number of blocks exist for this file
-    uint32_t total_block_cnt = (original_size - 1) / block_size_in_bytes + 1;
-    uint32_t block_cntr = 0;
-    uint32_t done_block_cntr = 0;
     uint32_t overlap_buf_count = OVERLAP_BUF_COUNT;
 
     // Read, Write and Kernel events
@@ -334,6 +629,13 @@ uint64_t xfLz4::decompress(uint8_t* in,
     cl::Event read_events[MAX_COMPUTE_UNITS][OVERLAP_BUF_COUNT];
     cl::Event write_events[MAX_COMPUTE_UNITS][OVERLAP_BUF_COUNT];
 
+    auto total_start = std::chrono::high_resolution_clock::now();
+
+    // Index all blocks of the frame up front, only the block headers
+    // are touched so this is cheap compared to the block copies below
+    std::vector<blockInfo> blocks;
+    if (indexFrame(in, input_size, original_size, blocks)) return 0;
+
     // Total chunks in input file
     // For example: Input file size is 12MB and Host buffer size is 2MB
     // Then we have 12/2 = 6 chunks exists
@@ -351,7 +653,9 @@ uint64_t xfLz4::decompress(uint8_t* in,
     uint32_t sizeOfChunk[total_chunks];
     uint32_t blocksPerChunk[total_chunks];
     uint32_t computeBlocksPerChunk[total_chunks];
+    uint32_t firstBlockOfChunk[total_chunks];
     uint64_t idx = 0;
+    uint32_t block_cntr = 0;
     for (uint64_t i = 0; i < original_size; i += host_buffer_size, idx++) {
         uint32_t chunk_size = host_buffer_size;
         if (chunk_size + i > original_size) {
@@ -364,9 +668,17 @@ uint64_t xfLz4::decompress(uint8_t* in,
         // Figure out blocks per chunk
         uint32_t nblocks = (chunk_size - 1) / block_size_in_bytes + 1;
         blocksPerChunk[idx] = nblocks;
-        computeBlocksPerChunk[idx] = nblocks;
+        firstBlockOfChunk[idx] = block_cntr;
+
+        // Stored blocks are passed through by the host
+        computeBlocksPerChunk[idx] = 0;
+        for (uint32_t b = 0; b < nblocks; b++, block_cntr++) {
+            if (blocks[block_cntr].compressed_size < blocks[block_cntr].block_size) computeBlocksPerChunk[idx]++;
+        }
     }
 
+    // Output offset of chunk i is i * chunk_stride
+    uint64_t chunk_stride = host_buffer_size;
     uint32_t temp_nblocks = (host_buffer_size - 1) / block_size_in_bytes + 1;
     host_buffer_size = ((host_buffer_size - 1) / 64 + 1) * 64;
 
@@ -392,9 +704,6 @@ uint64_t xfLz4::decompress(uint8_t* in,
         }
     }
 
-    // Counter which helps in tracking output buffer index
-    uint64_t outIdx = 0;
-
     // Track the flags of remaining chunks
     uint32_t chunk_flags[total_chunks];
     uint32_t cu_order[total_chunks];
@@ -404,93 +713,79 @@ uint64_t xfLz4::decompress(uint8_t* in,
 
     int flag = 0;
     int lcl_cu = 0;
-    uint64_t inIdx = 0;
     uint64_t total_decompression_size = 0;
-
-    uint32_t init_itr = 0;
-    if (total_chunks < 2 * D_COMPUTE_UNIT)
-        init_itr = total_chunks;
-    else
-        init_itr = 2 * D_COMPUTE_UNIT;
-
-    auto total_start = std::chrono::high_resolution_clock::now();
-    // Copy first few buffers
-    for (uint32_t itr = 0, brick = 0; brick < init_itr; brick += D_COMPUTE_UNIT, itr++, flag = !flag) {
-        lcl_cu = D_COMPUTE_UNIT;
-        if (brick + lcl_cu > total_chunks) lcl_cu = total_chunks - brick;
-
-        for (uint32_t cu = 0; cu < lcl_cu; cu++) {
-            uint32_t total_size = 0;
-            uint32_t compressed_size = 0;
-            uint32_t block_size = 0;
-            uint32_t nblocks = 0;
-            uint32_t bufblocks = 0;
-            uint32_t buf_size = 0;
-            uint32_t no_compress_size = 0;
-
-            for (uint32_t cIdx = 0; cIdx < sizeOfChunk[brick + cu];
-                 cIdx += block_size_in_bytes, total_size += block_size) {
-                if (block_cntr == (total_block_cnt - 1)) {
-                    block_size = original_size - done_block_cntr * block_size_in_bytes;
-                } else {
-                    block_size = block_size_in_bytes;
-                }
-
-                std::memcpy(&compressed_size, &in[inIdx], 4);
-                inIdx += 4;
-
-                uint32_t tmp = compressed_size;
-                tmp >>= 24;
-
-                if (tmp == lz4_specs::NO_COMPRESS_BIT) {
-                    uint8_t b1 = compressed_size;
-                    uint8_t b2 = compressed_size >> 8;
-                    uint8_t b3 = compressed_size >> 16;
-
-                    if (b3 == lz4_specs::BSIZE_NCOMP_64 || b3 == lz4_specs::BSIZE_NCOMP_4096 ||
-                        b3 == lz4_specs::BSIZE_NCOMP_256 || b3 == lz4_specs::BSIZE_NCOMP_1024) {
-                        compressed_size = block_size_in_bytes;
-                    } else {
-                        uint32_t size = 0;
-                        size = b3;
-                        size <<= 16;
-                        uint32_t temp = b2;
-                        temp <<= 8;
-                        size |= temp;
-                        temp = b1;
-                        size |= temp;
-                        compressed_size = size;
-                    }
-                }
-
-                m_blkSize[cu][flag].data()[nblocks] = block_size;
-                m_compressSize[cu][flag].data()[nblocks] = compressed_size;
-                nblocks++;
-
-                if (compressed_size < block_size) {
-                    h_compressSize[cu][flag].data()[bufblocks] = compressed_size;
-                    h_blksize[cu][flag].data()[bufblocks] = block_size;
-                    std::memcpy(&(h_buf_in[cu][flag].data()[buf_size]), &in[inIdx], compressed_size);
-                    inIdx += compressed_size;
-                    buf_size += block_size_in_bytes;
-                    bufblocks++;
-                } else if (compressed_size == block_size) {
-                    no_compress_size++;
-
-                    int outChunkIdx = brick + cu;
-                    // No compression block
-                    std::memcpy(&(out[outChunkIdx * host_buffer_size + cIdx]), &in[inIdx], block_size);
-                    inIdx += block_size;
-                    computeBlocksPerChunk[outChunkIdx]--;
-                } else {
-                    assert(0);
-                }
-                block_cntr++;
-                done_block_cntr++;
+    std::atomic<uint32_t> checksum_errors(0);
+
+    // Gather compressed blocks of a chunk into the slot input buffer and
+    // pass stored blocks straight through to the output
+    auto prepareChunk = [&](uint32_t chunk, uint32_t cu, uint32_t slot) {
+        uint32_t bufblocks = 0;
+        uint64_t outOffset = chunk * chunk_stride;
+        for (uint32_t bIdx = 0; bIdx < blocksPerChunk[chunk]; bIdx++) {
+            const blockInfo& blk = blocks[firstBlockOfChunk[chunk] + bIdx];
+            if (blk.compressed_size < blk.block_size) {
+                h_compressSize[cu][slot].data()[bufblocks] = blk.compressed_size;
+                h_blksize[cu][slot].data()[bufblocks] = blk.block_size;
+                std::memcpy(&(h_buf_in[cu][slot].data()[bufblocks * block_size_in_bytes]), &in[blk.in_offset],
+                            blk.compressed_size);
+                bufblocks++;
+            } else {
+                // No compression block
+                std::memcpy(&out[outOffset + bIdx * block_size_in_bytes], &in[blk.in_offset], blk.block_size);
+            }
+            if (m_block_checksum) {
+                uint32_t blk_hash = 0;
+                std::memcpy(&blk_hash, &in[blk.in_offset + blk.compressed_size], 4);
+                if (blk_hash != XXH32(&in[blk.in_offset], blk.compressed_size, 0)) checksum_errors++;
             }
         }
+    };
+
+    // Copy decompressed blocks of a finished chunk to the output
+    auto copyOutChunk = [&](uint32_t chunk, uint32_t cu, uint32_t slot) {
+        // Zero-copy chunks are already in place
+        bool in_place = (buffer_view[cu][slot] != nullptr);
+        delete (buffer_view[cu][slot]);
+        buffer_view[cu][slot] = nullptr;
+        uint32_t bufIdx = 0;
+        uint64_t outOffset = chunk * chunk_stride;
+        for (uint32_t bIdx = 0; bIdx < blocksPerChunk[chunk]; bIdx++) {
+            const blockInfo& blk = blocks[firstBlockOfChunk[chunk] + bIdx];
+            if (blk.compressed_size < blk.block_size) {
+                if (!in_place)
+                    std::memcpy(&out[outOffset + bIdx * block_size_in_bytes], &h_buf_out[cu][slot].data()[bufIdx],
+                                blk.block_size);
+                bufIdx += block_size_in_bytes;
+            }
+            total_decompression_size += blk.block_size;
+        }
+    };
+
+    // One parser thread per compute unit feeds its slots through a
+    // lock-free ring of depth OVERLAP_BUF_COUNT: prepared counts chunks
+    // ready to enqueue, enqueued counts chunks handed to the device. A
+    // slot is refilled as soon as the kernel of its previous chunk is
+    // done, so parsing chunk N + 1 overlaps device work on chunk N.
+    std::atomic<uint32_t> prepared[D_COMPUTE_UNIT];
+    std::atomic<uint32_t> enqueued[D_COMPUTE_UNIT];
+    for (uint32_t cu = 0; cu < D_COMPUTE_UNIT; cu++) {
+        prepared[cu] = 0;
+        enqueued[cu] = 0;
     }
-    flag = 0;
+    auto parser = [&](uint32_t cu) {
+        for (uint32_t itr = 0, chunk = cu; chunk < total_chunks; itr++, chunk += D_COMPUTE_UNIT) {
+            uint32_t slot = itr % OVERLAP_BUF_COUNT;
+            if (itr >= OVERLAP_BUF_COUNT) {
+                while (enqueued[cu].load(std::memory_order_acquire) < itr - 1) std::this_thread::yield();
+                kernel_events[cu][slot].wait();
+            }
+            prepareChunk(chunk, cu, slot);
+            prepared[cu].store(itr + 1, std::memory_order_release);
+        }
+    };
+    std::vector<std::thread> parsers;
+    for (uint32_t cu = 0; cu < D_COMPUTE_UNIT; cu++) parsers.push_back(std::thread(parser, cu));
+
     // Main loop of overlap execution
     // Loop below runs over total bricks i.e., host buffer size chunks
     for (uint32_t brick = 0, itr = 0; brick < total_chunks; brick += D_COMPUTE_UNIT, itr++, flag = !flag) {
@@ -516,96 +811,31 @@ uint64_t xfLz4::decompress(uint8_t* in,
 #endif
 
                 int brick_flag_idx = brick - (D_COMPUTE_UNIT * overlap_buf_count - cu);
-                uint32_t bufIdx = 0;
-                for (uint32_t bIdx = 0; bIdx < blocksPerChunk[brick_flag_idx]; bIdx++, idx += block_size_in_bytes) {
-                    uint32_t block_size = m_blkSize[cu][flag].data()[bIdx];
-                    uint32_t compressed_size = m_compressSize[cu][flag].data()[bIdx];
-                    if (compressed_size < block_size) {
-                        std::memcpy(&out[outIdx], &h_buf_out[cu][flag].data()[bufIdx], block_size);
-                        outIdx += block_size;
-                        bufIdx += block_size_in_bytes;
-                        total_decompression_size += block_size;
-                    } else if (compressed_size == block_size) {
-                        outIdx += block_size;
-                        total_decompression_size += block_size;
-                    }
-                } // For loop ends here
-
-                uint32_t total_size = 0;
-                uint32_t compressed_size = 0;
-                uint32_t block_size = 0;
-                uint32_t nblocks = 0;
-                uint32_t bufblocks = 0;
-                uint32_t buf_size = 0;
-                uint32_t no_compress_size = 0;
-                for (uint32_t cIdx = 0; cIdx < sizeOfChunk[brick + cu];
-                     cIdx += block_size_in_bytes, total_size += block_size) {
-                    if (block_cntr == (total_block_cnt - 1)) {
-                        block_size = original_size - done_block_cntr * block_size_in_bytes;
-                    } else {
-                        block_size = block_size_in_bytes;
-                    }
-
-                    std::memcpy(&compressed_size, &in[inIdx], 4);
-                    inIdx += 4;
-
-                    uint32_t tmp = compressed_size;
-                    tmp >>= 24;
-
-                    if (tmp == lz4_specs::NO_COMPRESS_BIT) {
-                        uint8_t b1 = compressed_size;
-                        uint8_t b2 = compressed_size >> 8;
-                        uint8_t b3 = compressed_size >> 16;
-
-                        if (b3 == lz4_specs::BSIZE_NCOMP_64 || b3 == lz4_specs::BSIZE_NCOMP_4096 ||
-                            b3 == lz4_specs::BSIZE_NCOMP_256 || b3 == lz4_specs::BSIZE_NCOMP_1024) {
-                            compressed_size = block_size_in_bytes;
-                        } else {
-                            uint32_t size = 0;
-                            size = b3;
-                            size <<= 16;
-                            uint32_t temp = b2;
-                            temp <<= 8;
-                            size |= temp;
-                            temp = b1;
-                            size |= temp;
-                            compressed_size = size;
-                        }
-                    }
-
-                    m_blkSize[cu][flag].data()[nblocks] = block_size;
-                    m_compressSize[cu][flag].data()[nblocks] = compressed_size;
-                    nblocks++;
-                    if (compressed_size < block_size) {
-                        h_compressSize[cu][flag].data()[bufblocks] = compressed_size;
-                        h_blksize[cu][flag].data()[bufblocks] = block_size;
-                        std::memcpy(&(h_buf_in[cu][flag].data()[buf_size]), &in[inIdx], compressed_size);
-                        inIdx += compressed_size;
-                        buf_size += block_size_in_bytes;
-                        bufblocks++;
-                    } else if (compressed_size == block_size) {
-                        no_compress_size++;
-                        int outChunkIdx = brick + cu;
-                        // No compression block
-                        std::memcpy(&(out[outChunkIdx * host_buffer_size + cIdx]), &in[inIdx], block_size);
-                        inIdx += block_size;
-                        computeBlocksPerChunk[outChunkIdx]--;
-                    } else {
-                        assert(0);
-                    }
-                    block_cntr++;
-                    done_block_cntr++;
-                } // Input forloop ends here
-            }     // If condition ends here
+                copyOutChunk(brick_flag_idx, cu, flag);
+            } // If condition ends here
+
+            // Wait for the parser of this compute unit
+            while (prepared[cu].load(std::memory_order_acquire) < itr + 1) std::this_thread::yield();
+
+            // Chunks without stored blocks are written straight into a
+            // registered output buffer
+            cl::Buffer* outBuf = buffer_output[cu][flag];
+            if (computeBlocksPerChunk[brick + cu] == blocksPerChunk[brick + cu]) {
+                buffer_view[cu][flag] =
+                    getBufferView(&out[(brick + cu) * chunk_stride], sizeOfChunk[brick + cu], CL_MEM_WRITE_ONLY);
+                if (buffer_view[cu][flag] != nullptr) outBuf = buffer_view[cu][flag];
+            }
 
             // Set kernel arguments
             uint32_t narg = 0;
             decompress_kernel_lz4[cu]->setArg(narg++, *(buffer_input[cu][flag]));
-            decompress_kernel_lz4[cu]->setArg(narg++, *(buffer_output[cu][flag]));
+            decompress_kernel_lz4[cu]->setArg(narg++, *outBuf);
             decompress_kernel_lz4[cu]->setArg(narg++, *(buffer_block_size[cu][flag]));
             decompress_kernel_lz4[cu]->setArg(narg++, *(buffer_compressed_size[cu][flag]));
+            decompress_kernel_lz4[cu]->setArg(narg++, *(buffer_dict[cu]));
             decompress_kernel_lz4[cu]->setArg(narg++, m_block_size_in_kb);
             decompress_kernel_lz4[cu]->setArg(narg++, computeBlocksPerChunk[brick + cu]);
+            decompress_kernel_lz4[cu]->setArg(narg++, m_dict_size);
 
             // Kernel wait events for writing & compute
             std::vector<cl::Event> kernelWriteWait;
@@ -626,15 +856,20 @@ uint64_t xfLz4::decompress(uint8_t* in,
             kernelComputeWait.push_back(kernel_events[cu][flag]);
 
             // Migrate memory - Map device to host buffers
-            m_q->enqueueMigrateMemObjects({*(buffer_output[cu][flag])}, CL_MIGRATE_MEM_OBJECT_HOST, &kernelComputeWait,
+            m_q->enqueueMigrateMemObjects({*outBuf}, CL_MIGRATE_MEM_OBJECT_HOST, &kernelComputeWait,
                                           &(read_events[cu][flag]));
+            m_q->flush();
 
+            // Parser may refill the other slot of this compute unit
+            enqueued[cu].store(itr + 1, std::memory_order_release);
         } // Compute unit loop
 
     } // End of main loop
     m_q->flush();
     m_q->finish();
 
+    for (auto& t : parsers) t.join();
+
     uint32_t leftover = total_chunks - completed_bricks;
     uint32_t stride = 0;
 
@@ -654,9 +889,6 @@ uint64_t xfLz4::decompress(uint8_t* in,
             int cu = cu_order[brick + j];
             int flag = chunk_flags[brick + j];
 
-            // Run over each block within brick
-            int brick_flag_idx = brick + j;
-
             // Accumulate Kernel time
             total_kernel_time += getEventDurationNs(kernel_events[cu][flag]);
 #ifdef EVENT_PROFILE
@@ -665,23 +897,9 @@ uint64_t xfLz4::decompress(uint8_t* in,
             // Accumulate Read time
             total_read_time += getEventDurationNs(read_events[cu][flag]);
 #endif
-            uint32_t bufIdx = 0;
-            for (uint32_t bIdx = 0, idx = 0; bIdx < blocksPerChunk[brick_flag_idx];
-                 bIdx++, idx += block_size_in_bytes) {
-                uint32_t block_size = m_blkSize[cu][flag].data()[bIdx];
-                uint32_t compressed_size = m_compressSize[cu][flag].data()[bIdx];
-                if (compressed_size < block_size) {
-                    std::memcpy(&out[outIdx], &h_buf_out[cu][flag].data()[bufIdx], block_size);
-                    outIdx += block_size;
-                    bufIdx += block_size_in_bytes;
-                    total_decompression_size += block_size;
-                } else if (compressed_size == block_size) {
-                    outIdx += block_size;
-                    total_decompression_size += block_size;
-                }
-            } // For loop ends here
-        }     // End of multiple CUs
-    }         // End of leftover bricks
+            copyOutChunk(brick + j, cu, flag);
+        } // End of multiple CUs
+    }     // End of leftover bricks
     // Delete device buffers
 
     auto total_end = std::chrono::high_resolution_clock::now();
@@ -709,6 +927,10 @@ uint64_t xfLz4::decompress(uint8_t* in,
             delete (buffer_block_size[dBuf][flag]);
         }
     }
+    if (checksum_errors) {
+        std::cout << "Block checksum mismatch in " << checksum_errors << " blocks" << std::endl;
+        return 0;
+    }
     return original_size;
 } // Decompress Overlap
 
@@ -727,12 +949,21 @@ uint64_t xfLz4::compress(
             h_buf_out[i][j].resize(host_buffer_size);
             h_blksize[i][j].resize(max_num_blks);
             h_compressSize[i][j].resize(max_num_blks);
+            h_blkChecksum[i][j].resize(2 * max_num_blks);
 
             m_compressSize[i][j].reserve(max_num_blks);
             m_blkSize[i][j].reserve(max_num_blks);
         }
     }
 
+    // xxHash32 does not combine across blocks, content checksum is
+    // accumulated here chunk by chunk while the kernels run
+    XXH32_state_t* content_state = nullptr;
+    if (m_content_checksum) {
+        content_state = XXH32_createState();
+        XXH32_reset(content_state, 0);
+    }
+
     uint32_t block_size_in_bytes = m_block_size_in_kb * 1024;
     uint32_t overlap_buf_count = OVERLAP_BUF_COUNT;
     uint64_t total_kernel_time = 0;
@@ -796,6 +1027,11 @@ uint64_t xfLz4::compress(
             // Input:- This buffer contains origianl input block sizes
             buffer_block_size[cu][flag] = new cl::Buffer(*m_context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY,
                                                          temp_nblocks * sizeof(uint32_t), h_blksize[cu][flag].data());
+
+            // Output:- This buffer contains raw & compressed block checksums
+            buffer_block_checksum[cu][flag] =
+                new cl::Buffer(*m_context, CL_MEM_USE_HOST_PTR | CL_MEM_WRITE_ONLY,
+                               2 * temp_nblocks * sizeof(uint32_t), h_blkChecksum[cu][flag].data());
         }
     }
     // Counter which helps in tracking
@@ -842,6 +1078,8 @@ uint64_t xfLz4::compress(
                 // Run over each block of the within brick
                 uint32_t index = 0;
                 int brick_flag_idx = brick - (C_COMPUTE_UNIT * overlap_buf_count - cu);
+                if (content_state)
+                    XXH32_update(content_state, &in[brick_flag_idx * host_buffer_size], sizeOfChunk[brick_flag_idx]);
                 for (uint32_t bIdx = 0; bIdx < blocksPerChunk[brick_flag_idx]; bIdx++, index += block_size_in_bytes) {
                     uint32_t block_size = block_size_in_bytes;
                     if (index + block_size > sizeOfChunk[brick_flag_idx]) {
@@ -857,12 +1095,14 @@ uint64_t xfLz4::compress(
 
                     // If compressed size is less than original block size
                     // It means better to dump encoded bytes
+                    uint32_t blk_hash = 0;
                     if (compressed_size < block_size && perc_cal >= 10) {
                         std::memcpy(&out[outIdx], &compressed_size, 4);
                         outIdx += 4;
                         std::memcpy(&out[outIdx], (h_buf_out[cu][flag]).data() + bIdx * block_size_in_bytes,
                                     compressed_size);
                         outIdx += compressed_size;
+                        blk_hash = h_blkChecksum[cu][flag].data()[2 * bIdx + 1];
                     } else {
                         if (block_size == block_size_in_bytes) {
                             out[outIdx++] = 0;
@@ -885,7 +1125,15 @@ uint64_t xfLz4::compress(
                         }
                         std::memcpy(&out[outIdx], &in[brick_flag_idx * host_buffer_size + index], block_size);
                         outIdx += block_size;
+                        if (block_size < MIN_BLOCK_SIZE)
+                            blk_hash = XXH32(&in[brick_flag_idx * host_buffer_size + index], block_size, 0);
+                        else
+                            blk_hash = h_blkChecksum[cu][flag].data()[2 * bIdx];
                     } // End of else - uncompressed stream update
+                    if (m_block_checksum) {
+                        std::memcpy(&out[outIdx], &blk_hash, 4);
+                        outIdx += 4;
+                    }
                 }
             }
             // Figure out block sizes per brick
@@ -898,21 +1146,31 @@ uint64_t xfLz4::compress(
                 (h_blksize[cu][flag]).data()[bIdx++] = block_size;
             }
 
-            // Copy data from input buffer to host
-            std::memcpy(h_buf_in[cu][flag].data(), &in[(brick + cu) * host_buffer_size], sizeOfChunk[brick + cu]);
+            // Read the chunk in place from a registered input buffer,
+            // otherwise copy data from input buffer to host
+            delete (buffer_view[cu][flag]);
+            buffer_view[cu][flag] =
+                getBufferView(&in[(brick + cu) * host_buffer_size], sizeOfChunk[brick + cu], CL_MEM_READ_ONLY);
+            cl::Buffer* inBuf = buffer_view[cu][flag];
+            if (inBuf == nullptr) {
+                std::memcpy(h_buf_in[cu][flag].data(), &in[(brick + cu) * host_buffer_size], sizeOfChunk[brick + cu]);
+                inBuf = buffer_input[cu][flag];
+            }
 
             // Set kernel arguments
             uint32_t narg = 0;
-            compress_kernel_lz4[cu]->setArg(narg++, *(buffer_input[cu][flag]));
+            compress_kernel_lz4[cu]->setArg(narg++, *inBuf);
             compress_kernel_lz4[cu]->setArg(narg++, *(buffer_output[cu][flag]));
             compress_kernel_lz4[cu]->setArg(narg++, *(buffer_compressed_size[cu][flag]));
             compress_kernel_lz4[cu]->setArg(narg++, *(buffer_block_size[cu][flag]));
+            compress_kernel_lz4[cu]->setArg(narg++, *(buffer_block_checksum[cu][flag]));
+            compress_kernel_lz4[cu]->setArg(narg++, *(buffer_dict[cu]));
             compress_kernel_lz4[cu]->setArg(narg++, m_block_size_in_kb);
             compress_kernel_lz4[cu]->setArg(narg++, sizeOfChunk[brick + cu]);
+            compress_kernel_lz4[cu]->setArg(narg++, m_dict_size);
 
             // Transfer data from host to device
-            m_q->enqueueMigrateMemObjects({*(buffer_input[cu][flag]), *(buffer_block_size[cu][flag])}, 0, NULL,
-                                          &(write_events[cu][flag]));
+            m_q->enqueueMigrateMemObjects({*inBuf, *(buffer_block_size[cu][flag])}, 0, NULL, &(write_events[cu][flag]));
 
             // Kernel wait events for writing & compute
             std::vector<cl::Event> kernelWriteWait;
@@ -927,7 +1185,8 @@ uint64_t xfLz4::compress(
             kernelComputeWait.push_back(kernel_events[cu][flag]);
 
             // Transfer data from device to host
-            m_q->enqueueMigrateMemObjects({*(buffer_output[cu][flag]), *(buffer_compressed_size[cu][flag])},
+            m_q->enqueueMigrateMemObjects({*(buffer_output[cu][flag]), *(buffer_compressed_size[cu][flag]),
+                                           *(buffer_block_checksum[cu][flag])},
                                           CL_MIGRATE_MEM_OBJECT_HOST, &kernelComputeWait, &(read_events[cu][flag]));
         } // Compute unit loop ends here
 
@@ -956,6 +1215,8 @@ uint64_t xfLz4::compress(
             // Run over each block of the within brick
             uint32_t index = 0;
             uint32_t brick_flag_idx = brick + j;
+            if (content_state)
+                XXH32_update(content_state, &in[brick_flag_idx * host_buffer_size], sizeOfChunk[brick_flag_idx]);
 
             // Accumulate Kernel time
             total_kernel_time += getEventDurationNs(kernel_events[cu][flag]);
@@ -981,11 +1242,13 @@ uint64_t xfLz4::compress(
 
                 // If compressed size is less than original block size
                 // It means better to dump encoded bytes
+                uint32_t blk_hash = 0;
                 if (compressed_size < block_size && perc_cal >= 10) {
                     std::memcpy(&out[outIdx], &compressed_size, 4);
                     outIdx += 4;
                     std::memcpy(&out[outIdx], &h_buf_out[cu][flag].data()[bIdx * block_size_in_bytes], compressed_size);
                     outIdx += compressed_size;
+                    blk_hash = h_blkChecksum[cu][flag].data()[2 * bIdx + 1];
                 } else {
                     if (block_size == block_size_in_bytes) {
                         out[outIdx++] = 0;
@@ -1013,7 +1276,15 @@ uint64_t xfLz4::compress(
                     }
                     std::memcpy(&out[outIdx], &in[brick_flag_idx * host_buffer_size + index], block_size);
                     outIdx += block_size;
+                    if (block_size < MIN_BLOCK_SIZE)
+                        blk_hash = XXH32(&in[brick_flag_idx * host_buffer_size + index], block_size, 0);
+                    else
+                        blk_hash = h_blkChecksum[cu][flag].data()[2 * bIdx];
                 } // End of else - uncompressed stream update
+                if (m_block_checksum) {
+                    std::memcpy(&out[outIdx], &blk_hash, 4);
+                    outIdx += 4;
+                }
 
             } // For loop ends
         }     // cu loop ends here
@@ -1038,12 +1309,596 @@ uint64_t xfLz4::compress(
 
     for (uint32_t cu = 0; cu < C_COMPUTE_UNIT; cu++) {
         for (uint32_t flag = 0; flag < overlap_buf_count; flag++) {
+            delete (buffer_view[cu][flag]);
+            buffer_view[cu][flag] = nullptr;
             delete (buffer_input[cu][flag]);
             delete (buffer_output[cu][flag]);
             delete (buffer_compressed_size[cu][flag]);
             delete (buffer_block_size[cu][flag]);
+            delete (buffer_block_checksum[cu][flag]);
         }
     }
 
+    if (content_state) {
+        m_content_hash = XXH32_digest(content_state);
+        XXH32_freeState(content_state);
+    }
+
     return outIdx;
 } // Overlap end
+
+// Streaming compression keeps every [cu][flag] slot busy across write()
+// calls. Slots are used round robin, so the oldest in flight chunk is
+// always the next one to emit and the frame stays in order.
+int xfLz4::begin(streamSink sink) {
+    if (m_stream_active) return -1;
+
+    uint32_t block_size_in_bytes = m_block_size_in_kb * 1024;
+    uint8_t block_size_header = 0;
+    switch (m_block_size_in_kb) {
+        case 64:
+            block_size_header = lz4_specs::BSIZE_STD_64KB;
+            break;
+        case 256:
+            block_size_header = lz4_specs::BSIZE_STD_256KB;
+            break;
+        case 1024:
+            block_size_header = lz4_specs::BSIZE_STD_1024KB;
+            break;
+        case 4096:
+            block_size_header = lz4_specs::BSIZE_STD_4096KB;
+            break;
+        default:
+            std::cout << "Invalid Block Size" << std::endl;
+            return -1;
+    }
+
+    // Chunks hold whole blocks only
+    m_stream_chunk = (HOST_BUFFER_SIZE / block_size_in_bytes) * block_size_in_bytes;
+    if (m_stream_chunk == 0) m_stream_chunk = block_size_in_bytes;
+    uint32_t nblocks = m_stream_chunk / block_size_in_bytes;
+
+    for (uint32_t cu = 0; cu < C_COMPUTE_UNIT; cu++) {
+        for (uint32_t flag = 0; flag < OVERLAP_BUF_COUNT; flag++) {
+            h_buf_in[cu][flag].resize(m_stream_chunk);
+            h_buf_out[cu][flag].resize(m_stream_chunk);
+            h_blksize[cu][flag].resize(nblocks);
+            h_compressSize[cu][flag].resize(nblocks);
+            h_blkChecksum[cu][flag].resize(2 * nblocks);
+
+            buffer_input[cu][flag] = new cl::Buffer(*m_context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY,
+                                                    m_stream_chunk, h_buf_in[cu][flag].data());
+            buffer_output[cu][flag] = new cl::Buffer(*m_context, CL_MEM_USE_HOST_PTR | CL_MEM_WRITE_ONLY,
+                                                     m_stream_chunk, h_buf_out[cu][flag].data());
+            buffer_compressed_size[cu][flag] =
+                new cl::Buffer(*m_context, CL_MEM_USE_HOST_PTR | CL_MEM_WRITE_ONLY, nblocks * sizeof(uint32_t),
+                               h_compressSize[cu][flag].data());
+            buffer_block_size[cu][flag] = new cl::Buffer(*m_context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY,
+                                                         nblocks * sizeof(uint32_t), h_blksize[cu][flag].data());
+            buffer_block_checksum[cu][flag] =
+                new cl::Buffer(*m_context, CL_MEM_USE_HOST_PTR | CL_MEM_WRITE_ONLY, 2 * nblocks * sizeof(uint32_t),
+                               h_blkChecksum[cu][flag].data());
+        }
+    }
+    // Worst case of one chunk: every block stored with size & checksum
+    m_stream_out.resize(m_stream_chunk + nblocks * 8);
+
+    m_stream_state = nullptr;
+    if (m_content_checksum) {
+        m_stream_state = XXH32_createState();
+        XXH32_reset(m_stream_state, 0);
+    }
+
+    // Frame header, length is unknown so content size is left out
+    uint8_t flg = FLG_BYTE & ~lz4_specs::FLG_CONTENT_SIZE;
+    if (m_block_checksum) flg |= lz4_specs::FLG_BLOCK_CHECKSUM;
+    if (m_content_checksum) flg |= lz4_specs::FLG_CONTENT_CHECKSUM;
+    if (m_dict_size) flg |= lz4_specs::FLG_DICT_ID;
+    uint8_t header[11] = {MAGIC_BYTE_1, MAGIC_BYTE_2, MAGIC_BYTE_3, MAGIC_BYTE_4, flg, block_size_header};
+    uint32_t header_size = 6;
+    if (m_dict_size) {
+        std::memcpy(&header[header_size], &m_dict_id, 4);
+        header_size += 4;
+    }
+    header[header_size] = (uint8_t)(XXH32(&header[4], header_size - 4, 0) >> 8);
+    header_size++;
+
+    m_sink = sink;
+    m_sink(header, header_size);
+    m_stream_total = header_size;
+    m_stream_raw = 0;
+    m_stream_index.clear();
+    m_stream_fill = 0;
+    m_stream_slot = 0;
+    m_stream_inflight = 0;
+    m_stream_active = true;
+    return 0;
+}
+
+int xfLz4::write(const uint8_t* in, uint64_t size) {
+    if (!m_stream_active) return -1;
+    const uint32_t total_slots = C_COMPUTE_UNIT * OVERLAP_BUF_COUNT;
+
+    while (size) {
+        // Staging into a slot requires its previous chunk to be emitted
+        if (m_stream_fill == 0 && m_stream_inflight == total_slots) streamRetire();
+
+        uint32_t cu = m_stream_slot % C_COMPUTE_UNIT;
+        uint32_t flag = m_stream_slot / C_COMPUTE_UNIT;
+        uint32_t len = m_stream_chunk - m_stream_fill;
+        if (len > size) len = size;
+
+        std::memcpy(h_buf_in[cu][flag].data() + m_stream_fill, in, len);
+        m_stream_fill += len;
+        in += len;
+        size -= len;
+
+        if (m_stream_fill == m_stream_chunk) streamSubmit();
+    }
+
+    // Hand over chunks which already completed
+    while (m_stream_inflight) {
+        uint32_t oldest = (m_stream_slot + total_slots - m_stream_inflight) % total_slots;
+        cl::Event& event = m_stream_event[oldest % C_COMPUTE_UNIT][oldest / C_COMPUTE_UNIT];
+        if (event.getInfo<CL_EVENT_COMMAND_EXECUTION_STATUS>() != CL_COMPLETE) break;
+        streamRetire();
+    }
+    return 0;
+}
+
+int xfLz4::flush() {
+    if (!m_stream_active) return -1;
+    // Blocks are independent, a partial chunk just ends in a short block
+    if (m_stream_fill) streamSubmit();
+    while (m_stream_inflight) streamRetire();
+    return 0;
+}
+
+uint64_t xfLz4::end() {
+    if (!m_stream_active) return 0;
+    flush();
+
+    // EndMark followed by the optional content checksum
+    uint8_t footer[8] = {0};
+    uint32_t footer_size = 4;
+    if (m_stream_state) {
+        uint32_t content_hash = XXH32_digest(m_stream_state);
+        std::memcpy(&footer[4], &content_hash, 4);
+        footer_size += 4;
+        XXH32_freeState(m_stream_state);
+        m_stream_state = nullptr;
+    }
+    m_sink(footer, footer_size);
+    m_stream_total += footer_size;
+
+    if (m_block_index && m_stream_raw) {
+        std::vector<uint8_t> index = packBlockIndex(m_stream_index, m_stream_raw);
+        m_sink(index.data(), index.size());
+        m_stream_total += index.size();
+    }
+
+    for (uint32_t cu = 0; cu < C_COMPUTE_UNIT; cu++) {
+        for (uint32_t flag = 0; flag < OVERLAP_BUF_COUNT; flag++) {
+            delete (buffer_input[cu][flag]);
+            delete (buffer_output[cu][flag]);
+            delete (buffer_compressed_size[cu][flag]);
+            delete (buffer_block_size[cu][flag]);
+            delete (buffer_block_checksum[cu][flag]);
+        }
+    }
+    m_stream_active = false;
+    return m_stream_total;
+}
+
+void xfLz4::streamSubmit() {
+    uint32_t cu = m_stream_slot % C_COMPUTE_UNIT;
+    uint32_t flag = m_stream_slot / C_COMPUTE_UNIT;
+    uint32_t chunk_size = m_stream_fill;
+    uint32_t block_size_in_bytes = m_block_size_in_kb * 1024;
+
+    // Figure out block sizes of the chunk
+    uint32_t bIdx = 0;
+    for (uint32_t i = 0; i < chunk_size; i += block_size_in_bytes) {
+        uint32_t block_size = block_size_in_bytes;
+        if (i + block_size > chunk_size) block_size = chunk_size - i;
+        (h_blksize[cu][flag]).data()[bIdx++] = block_size;
+    }
+
+    // Content checksum is accumulated in stream order
+    if (m_stream_state) XXH32_update(m_stream_state, h_buf_in[cu][flag].data(), chunk_size);
+
+    // Set kernel arguments
+    uint32_t narg = 0;
+    compress_kernel_lz4[cu]->setArg(narg++, *(buffer_input[cu][flag]));
+    compress_kernel_lz4[cu]->setArg(narg++, *(buffer_output[cu][flag]));
+    compress_kernel_lz4[cu]->setArg(narg++, *(buffer_compressed_size[cu][flag]));
+    compress_kernel_lz4[cu]->setArg(narg++, *(buffer_block_size[cu][flag]));
+    compress_kernel_lz4[cu]->setArg(narg++, *(buffer_block_checksum[cu][flag]));
+    compress_kernel_lz4[cu]->setArg(narg++, *(buffer_dict[cu]));
+    compress_kernel_lz4[cu]->setArg(narg++, m_block_size_in_kb);
+    compress_kernel_lz4[cu]->setArg(narg++, chunk_size);
+    compress_kernel_lz4[cu]->setArg(narg++, m_dict_size);
+
+    cl::Event write_event;
+    cl::Event kernel_event;
+    std::vector<cl::Event> kernelWriteWait;
+    std::vector<cl::Event> kernelComputeWait;
+
+    // Transfer data from host to device
+    m_q->enqueueMigrateMemObjects({*(buffer_input[cu][flag]), *(buffer_block_size[cu][flag])}, 0, NULL,
+                                  &write_event);
+    kernelWriteWait.push_back(write_event);
+
+    // Fire the kernel
+    m_q->enqueueTask(*compress_kernel_lz4[cu], &kernelWriteWait, &kernel_event);
+    kernelComputeWait.push_back(kernel_event);
+
+    // Transfer data from device to host
+    m_q->enqueueMigrateMemObjects({*(buffer_output[cu][flag]), *(buffer_compressed_size[cu][flag]),
+                                   *(buffer_block_checksum[cu][flag])},
+                                  CL_MIGRATE_MEM_OBJECT_HOST, &kernelComputeWait, &(m_stream_event[cu][flag]));
+    m_q->flush();
+
+    m_stream_size[cu][flag] = chunk_size;
+    m_stream_raw += chunk_size;
+    m_stream_slot = (m_stream_slot + 1) % (C_COMPUTE_UNIT * OVERLAP_BUF_COUNT);
+    m_stream_inflight++;
+    m_stream_fill = 0;
+}
+
+void xfLz4::streamRetire() {
+    const uint32_t total_slots = C_COMPUTE_UNIT * OVERLAP_BUF_COUNT;
+    uint32_t oldest = (m_stream_slot + total_slots - m_stream_inflight) % total_slots;
+    uint32_t cu = oldest % C_COMPUTE_UNIT;
+    uint32_t flag = oldest / C_COMPUTE_UNIT;
+    uint32_t chunk_size = m_stream_size[cu][flag];
+    uint32_t block_size_in_bytes = m_block_size_in_kb * 1024;
+
+    m_stream_event[cu][flag].wait();
+
+    uint8_t* out = m_stream_out.data();
+    uint8_t* raw = h_buf_in[cu][flag].data();
+    uint64_t outIdx = 0;
+    uint32_t bIdx = 0;
+    for (uint32_t index = 0; index < chunk_size; index += block_size_in_bytes, bIdx++) {
+        uint32_t block_size = block_size_in_bytes;
+        if (index + block_size > chunk_size) block_size = chunk_size - index;
+
+        uint32_t compressed_size = (h_compressSize[cu][flag]).data()[bIdx];
+        uint32_t blk_hash = 0;
+        uint64_t blkStart = outIdx;
+        if (compressed_size < block_size) {
+            std::memcpy(&out[outIdx], &compressed_size, 4);
+            outIdx += 4;
+            std::memcpy(&out[outIdx], (h_buf_out[cu][flag]).data() + bIdx * block_size_in_bytes, compressed_size);
+            outIdx += compressed_size;
+            blk_hash = h_blkChecksum[cu][flag].data()[2 * bIdx + 1];
+        } else {
+            // Uncompressed block, size with the high bit set
+            uint32_t stored_size = block_size | ((uint32_t)lz4_specs::NO_COMPRESS_BIT << 24);
+            std::memcpy(&out[outIdx], &stored_size, 4);
+            outIdx += 4;
+            std::memcpy(&out[outIdx], &raw[index], block_size);
+            outIdx += block_size;
+            if (block_size < MIN_BLOCK_SIZE)
+                blk_hash = XXH32(&raw[index], block_size, 0);
+            else
+                blk_hash = h_blkChecksum[cu][flag].data()[2 * bIdx];
+        }
+        if (m_block_checksum) {
+            std::memcpy(&out[outIdx], &blk_hash, 4);
+            outIdx += 4;
+        }
+        if (m_block_index) m_stream_index.push_back(outIdx - blkStart);
+    }
+
+    m_sink(out, outIdx);
+    m_stream_total += outIdx;
+    m_stream_inflight--;
+}
+
+std::vector<uint8_t> xfLz4::packBlockIndex(const std::vector<uint32_t>& block_bytes, uint64_t original_size) {
+    uint32_t frame_size = block_bytes.size() * 4 + lz4_specs::SEEK_FOOTER_SIZE;
+    std::vector<uint8_t> index(8 + frame_size);
+    uint8_t* ptr = index.data();
+
+    std::memcpy(ptr, &lz4_specs::SKIPPABLE_MAGIC, 4);
+    std::memcpy(ptr + 4, &frame_size, 4);
+    ptr += 8;
+    for (uint32_t b = 0; b < block_bytes.size(); b++, ptr += 4) std::memcpy(ptr, &block_bytes[b], 4);
+
+    // Footer
+    std::memcpy(ptr, &original_size, 8);
+    std::memcpy(ptr + 8, &m_block_size_in_kb, 4);
+    std::memcpy(ptr + 12, &lz4_specs::SEEK_INDEX_MAGIC, 4);
+    return index;
+}
+
+uint64_t xfLz4::decompressRange(
+    std::string& inFile_name, uint8_t* out, uint64_t offset, uint64_t length, bool file_list_flag) {
+    std::ifstream inFile(inFile_name.c_str(), std::ifstream::binary);
+    if (!inFile) {
+        std::cout << "Unable to open file";
+        return 0;
+    }
+    inFile.seekg(0, inFile.end);
+    uint64_t file_size = inFile.tellg();
+
+    // Block index footer is at the very end of the file
+    uint8_t footer[lz4_specs::SEEK_FOOTER_SIZE] = {0};
+    uint32_t seek_magic = 0;
+    if (file_size >= 15 + 8 + lz4_specs::SEEK_FOOTER_SIZE) {
+        inFile.seekg(file_size - lz4_specs::SEEK_FOOTER_SIZE);
+        inFile.read((char*)footer, lz4_specs::SEEK_FOOTER_SIZE);
+        std::memcpy(&seek_magic, &footer[12], 4);
+    }
+    uint64_t original_size = 0;
+    uint32_t block_size_in_kb = 0;
+    std::memcpy(&original_size, &footer[0], 8);
+    std::memcpy(&block_size_in_kb, &footer[8], 4);
+    uint64_t total_blocks = 0;
+    if (seek_magic == lz4_specs::SEEK_INDEX_MAGIC && original_size && block_size_in_kb)
+        total_blocks = (original_size - 1) / ((uint64_t)block_size_in_kb * 1024) + 1;
+
+    // Whole index frame, its skippable frame header is checked too
+    uint64_t index_size = 8 + total_blocks * 4 + lz4_specs::SEEK_FOOTER_SIZE;
+    std::vector<uint8_t> index;
+    if (total_blocks && index_size <= file_size - 15) {
+        index.resize(index_size);
+        inFile.seekg(file_size - index_size);
+        inFile.read((char*)index.data(), index_size);
+    }
+    if (index.empty() || seekIndexSize(index.data(), index_size) != index_size) {
+        std::cout << "No block index in " << inFile_name << std::endl;
+        return 0;
+    }
+    m_block_size_in_kb = block_size_in_kb;
+    uint32_t block_size_in_bytes = m_block_size_in_kb * 1024;
+
+    std::vector<uint32_t> block_bytes(total_blocks);
+    std::memcpy(block_bytes.data(), &index[8], total_blocks * 4);
+
+    // Frame header carries the checksum flags and optional content size
+    char c = 0;
+    inFile.seekg(MAGIC_HEADER_SIZE);
+    inFile.get(c);
+    m_block_checksum = (c & lz4_specs::FLG_BLOCK_CHECKSUM);
+    m_content_checksum = (c & lz4_specs::FLG_CONTENT_CHECKSUM);
+    uint64_t header_size = MAGIC_HEADER_SIZE + 3 + ((c & lz4_specs::FLG_CONTENT_SIZE) ? 8 : 0);
+
+    // Frames compressed against a dictionary name it
+    if (c & lz4_specs::FLG_DICT_ID) {
+        uint32_t dict_id = 0;
+        inFile.seekg(header_size - 1);
+        inFile.read((char*)&dict_id, 4);
+        header_size += 4;
+        if (m_dict_size == 0 || dict_id != m_dict_id) {
+            std::cout << "Dictionary " << std::hex << dict_id << std::dec << " is not loaded" << std::endl;
+            return 0;
+        }
+    }
+
+    if (offset >= original_size || length == 0) return 0;
+    if (length > original_size - offset) length = original_size - offset;
+
+    // Blocks covering the range are contiguous in the file
+    uint32_t first_block = offset / block_size_in_bytes;
+    uint32_t last_block = (offset + length - 1) / block_size_in_bytes;
+    uint64_t in_offset = header_size;
+    for (uint32_t b = 0; b < first_block; b++) in_offset += block_bytes[b];
+    uint64_t in_size = 0;
+    for (uint32_t b = first_block; b <= last_block; b++) in_size += block_bytes[b];
+
+    uint64_t range_start = (uint64_t)first_block * block_size_in_bytes;
+    uint64_t range_size = (uint64_t)(last_block + 1) * block_size_in_bytes;
+    if (range_size > original_size) range_size = original_size;
+    range_size -= range_start;
+
+    std::vector<uint8_t, aligned_allocator<uint8_t> > in(in_size);
+    std::vector<uint8_t, aligned_allocator<uint8_t> > range(range_size);
+    inFile.seekg(in_offset);
+    inFile.read((char*)in.data(), in_size);
+    inFile.close();
+
+    uint32_t host_buffer_size = block_size_in_bytes * 32;
+    if (block_size_in_bytes > range_size) host_buffer_size = block_size_in_bytes;
+
+    // Decompression Overlapped multiple cu solution over the range blocks
+    registerBuffer(range.data(), range_size);
+    uint64_t debytes = decompress(in.data(), range.data(), in_size, range_size, host_buffer_size, file_list_flag);
+    unregisterBuffer(range.data());
+    if (debytes != range_size) return 0;
+
+    std::memcpy(out, &range[offset - range_start], length);
+    return length;
+}
+
+// Batched messages: every message takes a slot of whole KBs in the chunk
+// buffer so the kernel handles it as one block, slots are sized for the
+// LZ4 worst case so compressed output never spills into the next slot
+uint64_t xfLz4::compressBatch(
+    const uint8_t* in, const uint32_t* msg_sizes, uint32_t msg_count, uint8_t* out, uint64_t* out_offsets, int cu) {
+    if (!m_bin_flow || cu < 0 || cu >= C_COMPUTE_UNIT) return 0;
+    uint32_t max_msg = 0;
+    for (uint32_t m = 0; m < msg_count; m++) max_msg = std::max(max_msg, msg_sizes[m]);
+    if (max_msg > MAX_BATCH_MSG_SIZE) {
+        std::cout << "compressBatch: messages are limited to " << MAX_BATCH_MSG_SIZE << " bytes" << std::endl;
+        return 0;
+    }
+    uint32_t slot_kb = (max_msg + max_msg / 255 + 16) / KB + 1;
+    uint32_t slot_size = slot_kb * KB;
+    uint32_t batch_max = HOST_BUFFER_SIZE / slot_size;
+
+    h_buf_in[cu][0].resize(batch_max * slot_size);
+    h_buf_out[cu][0].resize(batch_max * slot_size);
+    h_blksize[cu][0].resize(batch_max);
+    h_compressSize[cu][0].resize(batch_max);
+    h_blkChecksum[cu][0].resize(2 * batch_max);
+
+    cl::Buffer* bufInput = new cl::Buffer(*m_context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, batch_max * slot_size,
+                                          h_buf_in[cu][0].data());
+    cl::Buffer* bufOutput = new cl::Buffer(*m_context, CL_MEM_USE_HOST_PTR | CL_MEM_WRITE_ONLY,
+                                           batch_max * slot_size, h_buf_out[cu][0].data());
+    cl::Buffer* bufCompressSize = new cl::Buffer(*m_context, CL_MEM_USE_HOST_PTR | CL_MEM_WRITE_ONLY,
+                                                 batch_max * sizeof(uint32_t), h_compressSize[cu][0].data());
+    cl::Buffer* bufBlockSize = new cl::Buffer(*m_context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY,
+                                              batch_max * sizeof(uint32_t), h_blksize[cu][0].data());
+    cl::Buffer* bufChecksum = new cl::Buffer(*m_context, CL_MEM_USE_HOST_PTR | CL_MEM_WRITE_ONLY,
+                                             2 * batch_max * sizeof(uint32_t), h_blkChecksum[cu][0].data());
+
+    uint64_t inIdx = 0;
+    uint64_t outIdx = 0;
+    for (uint32_t first = 0; first < msg_count; first += batch_max) {
+        uint32_t nmsg = std::min(batch_max, msg_count - first);
+        uint64_t batchIdx = inIdx;
+
+        // Pack the messages of this batch into their slots
+        for (uint32_t m = 0; m < nmsg; m++) {
+            std::memcpy(&(h_buf_in[cu][0].data()[m * slot_size]), &in[inIdx], msg_sizes[first + m]);
+            h_blksize[cu][0].data()[m] = msg_sizes[first + m];
+            inIdx += msg_sizes[first + m];
+        }
+
+        // Set kernel arguments
+        uint32_t narg = 0;
+        uint32_t batch_size = nmsg * slot_size;
+        compress_kernel_lz4[cu]->setArg(narg++, *bufInput);
+        compress_kernel_lz4[cu]->setArg(narg++, *bufOutput);
+        compress_kernel_lz4[cu]->setArg(narg++, *bufCompressSize);
+        compress_kernel_lz4[cu]->setArg(narg++, *bufBlockSize);
+        compress_kernel_lz4[cu]->setArg(narg++, *bufChecksum);
+        compress_kernel_lz4[cu]->setArg(narg++, *(buffer_dict[cu]));
+        compress_kernel_lz4[cu]->setArg(narg++, slot_kb);
+        compress_kernel_lz4[cu]->setArg(narg++, batch_size);
+        compress_kernel_lz4[cu]->setArg(narg++, m_dict_size);
+
+        // One migration and one launch for the whole batch
+        m_q->enqueueMigrateMemObjects({*bufInput, *bufBlockSize}, 0);
+        m_q->enqueueTask(*compress_kernel_lz4[cu]);
+        m_q->enqueueMigrateMemObjects({*bufOutput, *bufCompressSize}, CL_MIGRATE_MEM_OBJECT_HOST);
+        m_q->finish();
+
+        // Messages which do not shrink are stored
+        uint64_t msgIdx = batchIdx;
+        for (uint32_t m = 0; m < nmsg; m++) {
+            uint32_t msg_size = msg_sizes[first + m];
+            uint32_t compressed_size = h_compressSize[cu][0].data()[m];
+            out_offsets[first + m] = outIdx;
+            if (compressed_size < msg_size) {
+                std::memcpy(&out[outIdx], &compressed_size, 4);
+                std::memcpy(&out[outIdx + 4], &(h_buf_out[cu][0].data()[m * slot_size]), compressed_size);
+                outIdx += 4 + compressed_size;
+            } else {
+                uint32_t stored_size = msg_size | ((uint32_t)lz4_specs::NO_COMPRESS_BIT << 24);
+                std::memcpy(&out[outIdx], &stored_size, 4);
+                std::memcpy(&out[outIdx + 4], &in[msgIdx], msg_size);
+                outIdx += 4 + msg_size;
+            }
+            msgIdx += msg_size;
+        }
+    }
+    out_offsets[msg_count] = outIdx;
+
+    delete (bufInput);
+    delete (bufOutput);
+    delete (bufCompressSize);
+    delete (bufBlockSize);
+    delete (bufChecksum);
+    return outIdx;
+}
+
+uint64_t xfLz4::decompressBatch(const uint8_t* in,
+                                const uint64_t* in_offsets,
+                                const uint32_t* msg_sizes,
+                                uint32_t msg_count,
+                                uint8_t* out,
+                                int cu) {
+    if (m_bin_flow || cu < 0 || cu >= D_COMPUTE_UNIT) return 0;
+    uint32_t max_msg = 0;
+    for (uint32_t m = 0; m < msg_count; m++) max_msg = std::max(max_msg, msg_sizes[m]);
+    if (max_msg > MAX_BATCH_MSG_SIZE) {
+        std::cout << "decompressBatch: messages are limited to " << MAX_BATCH_MSG_SIZE << " bytes" << std::endl;
+        return 0;
+    }
+    uint32_t slot_kb = (max_msg + max_msg / 255 + 16) / KB + 1;
+    uint32_t slot_size = slot_kb * KB;
+    uint32_t batch_max = HOST_BUFFER_SIZE / slot_size;
+
+    h_buf_in[cu][0].resize(batch_max * slot_size);
+    h_buf_out[cu][0].resize(batch_max * slot_size);
+    h_blksize[cu][0].resize(batch_max);
+    h_compressSize[cu][0].resize(batch_max);
+
+    cl::Buffer* bufInput = new cl::Buffer(*m_context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, batch_max * slot_size,
+                                          h_buf_in[cu][0].data());
+    cl::Buffer* bufOutput = new cl::Buffer(*m_context, CL_MEM_USE_HOST_PTR | CL_MEM_WRITE_ONLY,
+                                           batch_max * slot_size, h_buf_out[cu][0].data());
+    cl::Buffer* bufCompressSize = new cl::Buffer(*m_context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY,
+                                                 batch_max * sizeof(uint32_t), h_compressSize[cu][0].data());
+    cl::Buffer* bufBlockSize = new cl::Buffer(*m_context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY,
+                                              batch_max * sizeof(uint32_t), h_blksize[cu][0].data());
+
+    uint64_t outIdx = 0;
+    bool malformed = false;
+    std::vector<uint64_t> slot_out(batch_max);
+    for (uint32_t first = 0; first < msg_count && !malformed; first += batch_max) {
+        uint32_t nmsg = std::min(batch_max, msg_count - first);
+
+        // Stored messages are copied, compressed ones go to the next slot
+        uint32_t nblocks = 0;
+        for (uint32_t m = 0; m < nmsg; m++) {
+            uint32_t msg_size = msg_sizes[first + m];
+            const uint8_t* record = &in[in_offsets[first + m]];
+            uint32_t compressed_size = 0;
+            std::memcpy(&compressed_size, record, 4);
+            if ((compressed_size >> 24) == lz4_specs::NO_COMPRESS_BIT) {
+                if ((compressed_size & 0xFFFFFF) != msg_size) {
+                    malformed = true;
+                    break;
+                }
+                std::memcpy(&out[outIdx], record + 4, msg_size);
+            } else {
+                if (compressed_size >= msg_size) {
+                    malformed = true;
+                    break;
+                }
+                std::memcpy(&(h_buf_in[cu][0].data()[nblocks * slot_size]), record + 4, compressed_size);
+                h_compressSize[cu][0].data()[nblocks] = compressed_size;
+                h_blksize[cu][0].data()[nblocks] = msg_size;
+                slot_out[nblocks++] = outIdx;
+            }
+            outIdx += msg_size;
+        }
+        if (malformed || nblocks == 0) continue;
+
+        // Set kernel arguments
+        uint32_t narg = 0;
+        decompress_kernel_lz4[cu]->setArg(narg++, *bufInput);
+        decompress_kernel_lz4[cu]->setArg(narg++, *bufOutput);
+        decompress_kernel_lz4[cu]->setArg(narg++, *bufBlockSize);
+        decompress_kernel_lz4[cu]->setArg(narg++, *bufCompressSize);
+        decompress_kernel_lz4[cu]->setArg(narg++, *(buffer_dict[cu]));
+        decompress_kernel_lz4[cu]->setArg(narg++, slot_kb);
+        decompress_kernel_lz4[cu]->setArg(narg++, nblocks);
+        decompress_kernel_lz4[cu]->setArg(narg++, m_dict_size);
+
+        // One migration and one launch for the whole batch
+        m_q->enqueueMigrateMemObjects({*bufInput, *bufCompressSize, *bufBlockSize}, 0);
+        m_q->enqueueTask(*decompress_kernel_lz4[cu]);
+        m_q->enqueueMigrateMemObjects({*bufOutput}, CL_MIGRATE_MEM_OBJECT_HOST);
+        m_q->finish();
+
+        for (uint32_t b = 0; b < nblocks; b++)
+            std::memcpy(&out[slot_out[b]], &(h_buf_out[cu][0].data()[b * slot_size]), h_blksize[cu][0].data()[b]);
+    }
+
+    delete (bufInput);
+    delete (bufOutput);
+    delete (bufCompressSize);
+    delete (bufBlockSize);
+    if (malformed) {
+        std::cout << "decompressBatch: malformed block" << std::endl;
+        return 0;
+    }
+    return outIdx;
+}
@@ -172,6 +172,7 @@ void xflz4::compress_in_line_multiple_files(std::vector<char*>& inVec,
     std::vector<cl::Buffer*> buflz4OutSizeVec;
     std::vector<cl::Buffer*> bufblockSizeVec;
     std::vector<cl::Buffer*> bufCompSizeVec;
+    std::vector<cl::Buffer*> bufChecksumVec;
     std::vector<cl::Buffer*> bufheadVec;
     std::vector<uint8_t*> bufp2pOutVec;
     std::vector<int> fd_p2p_vec;
@@ -277,6 +278,10 @@ void xflz4::compress_in_line_multiple_files(std::vector<char*>& inVec,
             new cl::Buffer(*m_context, CL_MEM_WRITE_ONLY, num_blocks * sizeof(uint32_t));
         bufCompSizeVec.push_back(buffer_compressed_size);
 
+        // K1 Output:- Block checksums, not used in the P2P frame
+        cl::Buffer* buffer_checksum = new cl::Buffer(*m_context, CL_MEM_WRITE_ONLY, 2 * num_blocks * sizeof(uint32_t));
+        bufChecksumVec.push_back(buffer_checksum);
+
         // Input:- This buffer contains original input block sizes
         cl::Buffer* buffer_block_size = new cl::Buffer(*m_context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY,
                                                        num_blocks * sizeof(uint32_t), h_blkSizeVec[i]);
@@ -334,8 +339,13 @@ void xflz4::compress_in_line_multiple_files(std::vector<char*>& inVec,
         compress_kernel_lz4[cu_num]->setArg(narg++, *(bufOutputVec[i]));
         compress_kernel_lz4[cu_num]->setArg(narg++, *(bufCompSizeVec[i]));
         compress_kernel_lz4[cu_num]->setArg(narg++, *(bufblockSizeVec[i]));
+        compress_kernel_lz4[cu_num]->setArg(narg++, *(bufChecksumVec[i]));
+        // No preset dictionary, any buffer on the same port will do
+        const uint32_t c_noDictSize = 0;
+        compress_kernel_lz4[cu_num]->setArg(narg++, *(bufChecksumVec[i]));
         compress_kernel_lz4[cu_num]->setArg(narg++, m_block_size_in_kb);
         compress_kernel_lz4[cu_num]->setArg(narg++, inSizeVec[i]);
+        compress_kernel_lz4[cu_num]->setArg(narg++, c_noDictSize);
 
         uint32_t offset = 0;
         uint32_t tail_bytes = 0;
@@ -426,6 +436,7 @@ void xflz4::compress_in_line_multiple_files(std::vector<char*>& inVec,
         delete (bufOutputVec[i]);
         delete (buflz4OutVec[i]);
         delete (bufCompSizeVec[i]);
+        delete (bufChecksumVec[i]);
         delete (bufblockSizeVec[i]);
         delete (buflz4OutSizeVec[i]);
     }
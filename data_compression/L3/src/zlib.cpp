@@ -15,6 +15,8 @@
  *
  */
 #include "zlib.hpp"
+#include <sys/stat.h>
+#include <algorithm>
 #define FORMAT_0 31
 #define FORMAT_1 139
 #define VARIANT 8
@@ -31,7 +33,354 @@ uint32_t get_file_size(std::ifstream& file) {
     return file_size;
 }
 
-void zip(std::string& inFile_name, std::ofstream& outFile, uint8_t* zip_out, uint32_t enbytes) {
+// CRC32 of a host buffer, used for blocks which bypass the kernel
+static uint32_t crc32Sw(uint32_t crc, const uint8_t* buf, uint32_t len) {
+    crc = ~crc;
+    for (uint32_t i = 0; i < len; i++) {
+        crc ^= buf[i];
+        for (int k = 0; k < 8; k++) crc = (crc & 1) ? ((crc >> 1) ^ 0xEDB88320) : (crc >> 1);
+    }
+    return ~crc;
+}
+
+// gzip header flags
+#define GZ_FHCRC 0x02
+#define GZ_FEXTRA 0x04
+#define GZ_FNAME 0x08
+#define GZ_FCOMMENT 0x10
+#define GZ_FRESERVED 0xE0
+
+// Size of the gzip member header at the start of in, 0 when in does not
+// start a member. bsize receives the BGZF block size minus one, 0 when
+// the header carries no BGZF subfield.
+static uint32_t gzipHeaderSize(const uint8_t* in, uint64_t avail, uint32_t& bsize) {
+    bsize = 0;
+    // Header, shortest deflate block and trailer
+    if (avail < 20) return 0;
+    if (in[0] != FORMAT_0 || in[1] != FORMAT_1 || in[2] != VARIANT) return 0;
+    uint8_t flg = in[3];
+    if (flg & GZ_FRESERVED) return 0;
+
+    uint64_t pos = 10;
+    if (flg & GZ_FEXTRA) {
+        uint32_t xlen = in[pos] | (in[pos + 1] << 8);
+        pos += 2;
+        if (pos + xlen > avail) return 0;
+        // Subfields are SI1, SI2, 2 byte length and data, BGZF uses "BC"
+        for (uint64_t i = pos; i + 4 <= pos + xlen;) {
+            uint32_t slen = in[i + 2] | (in[i + 3] << 8);
+            if (in[i] == 'B' && in[i + 1] == 'C' && slen == 2 && i + 6 <= pos + xlen) {
+                bsize = in[i + 4] | (in[i + 5] << 8);
+            }
+            i += 4 + slen;
+        }
+        pos += xlen;
+    }
+    if (flg & GZ_FNAME) {
+        while (pos < avail && in[pos]) pos++;
+        pos++;
+    }
+    if (flg & GZ_FCOMMENT) {
+        while (pos < avail && in[pos]) pos++;
+        pos++;
+    }
+    if (flg & GZ_FHCRC) pos += 2;
+
+    if (pos + 10 > avail) return 0;
+    return pos;
+}
+
+// Bit reader and canonical Huffman decoding for deflateWalk
+struct deflateBits {
+    const uint8_t* in;
+    uint64_t avail;
+    uint64_t pos;
+    uint32_t bitbuf;
+    uint32_t bitcnt;
+    bool error;
+};
+
+struct deflateHuffman {
+    uint16_t count[16];
+    uint16_t symbol[288];
+};
+
+static uint32_t deflateGetBits(deflateBits& s, uint32_t need) {
+    uint32_t val = s.bitbuf;
+    while (s.bitcnt < need) {
+        if (s.pos >= s.avail) {
+            s.error = true;
+            return 0;
+        }
+        val |= (uint32_t)s.in[s.pos++] << s.bitcnt;
+        s.bitcnt += 8;
+    }
+    s.bitbuf = val >> need;
+    s.bitcnt -= need;
+    return val & ((1U << need) - 1);
+}
+
+// Returns 0 for a complete code, > 0 incomplete and < 0 over-subscribed
+static int deflateBuildCode(deflateHuffman& h, const uint16_t* length, uint32_t n) {
+    uint16_t offs[16];
+    for (uint32_t len = 0; len < 16; len++) h.count[len] = 0;
+    for (uint32_t sym = 0; sym < n; sym++) h.count[length[sym]]++;
+    if (h.count[0] == n) return 0;
+
+    int left = 1;
+    for (uint32_t len = 1; len < 16; len++) {
+        left <<= 1;
+        left -= h.count[len];
+        if (left < 0) return left;
+    }
+    offs[1] = 0;
+    for (uint32_t len = 1; len < 15; len++) offs[len + 1] = offs[len] + h.count[len];
+    for (uint32_t sym = 0; sym < n; sym++) {
+        if (length[sym]) h.symbol[offs[length[sym]]++] = sym;
+    }
+    return left;
+}
+
+static int deflateDecode(deflateBits& s, const deflateHuffman& h) {
+    int code = 0;
+    int first = 0;
+    int index = 0;
+    for (uint32_t len = 1; len < 16; len++) {
+        code |= deflateGetBits(s, 1);
+        if (s.error) return -1;
+        int count = h.count[len];
+        if (code - count < first) return h.symbol[index + (code - first)];
+        index += count;
+        first += count;
+        first <<= 1;
+        code <<= 1;
+    }
+    return -1;
+}
+
+static bool deflateCodes(deflateBits& s, const deflateHuffman& lencode, const deflateHuffman& distcode, uint64_t& raw) {
+    static const uint16_t lbase[29] = {3,  4,  5,  6,  7,  8,  9,  10, 11,  13,  15,  17,  19,  23, 27,
+                                       31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+    static const uint16_t lext[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+    static const uint16_t dbase[30] = {1,   2,   3,   4,   5,   7,    9,    13,   17,   25,   33,   49,   65,    97,    129,
+                                       193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+    static const uint16_t dext[30] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+    while (true) {
+        int symbol = deflateDecode(s, lencode);
+        if (symbol < 0) return false;
+        if (symbol == 256) return true;
+        if (symbol < 256) {
+            raw++;
+            continue;
+        }
+        symbol -= 257;
+        if (symbol >= 29) return false;
+        uint32_t len = lbase[symbol] + deflateGetBits(s, lext[symbol]);
+        symbol = deflateDecode(s, distcode);
+        if (symbol < 0 || symbol >= 30) return false;
+        uint32_t dist = dbase[symbol] + deflateGetBits(s, dext[symbol]);
+        if (s.error || dist > raw) return false;
+        raw += len;
+    }
+}
+
+// Walks a deflate stream on the host without producing output. Returns
+// the size of the stream up to the end of its final block, 0 when it is
+// malformed. raw receives the size of the decoded data.
+static uint64_t deflateWalk(const uint8_t* in, uint64_t avail, uint64_t& raw) {
+    static const uint8_t order[19] = {16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+    deflateBits s = {in, avail, 0, 0, 0, false};
+    deflateHuffman lencode;
+    deflateHuffman distcode;
+    uint16_t lengths[320];
+    raw = 0;
+
+    uint32_t last = 0;
+    while (!last) {
+        last = deflateGetBits(s, 1);
+        uint32_t type = deflateGetBits(s, 2);
+        if (s.error) return 0;
+
+        if (type == 0) {
+            // Stored block, LEN and NLEN start at the next byte
+            s.bitbuf = 0;
+            s.bitcnt = 0;
+            if (s.pos + 4 > avail) return 0;
+            uint32_t len = in[s.pos] | (in[s.pos + 1] << 8);
+            uint32_t nlen = in[s.pos + 2] | (in[s.pos + 3] << 8);
+            if (len != (~nlen & 0xFFFF) || s.pos + 4 + len > avail) return 0;
+            s.pos += 4 + len;
+            raw += len;
+            continue;
+        }
+
+        if (type == 1) {
+            uint32_t sym = 0;
+            for (; sym < 144; sym++) lengths[sym] = 8;
+            for (; sym < 256; sym++) lengths[sym] = 9;
+            for (; sym < 280; sym++) lengths[sym] = 7;
+            for (; sym < 288; sym++) lengths[sym] = 8;
+            deflateBuildCode(lencode, lengths, 288);
+            for (sym = 0; sym < 30; sym++) lengths[sym] = 5;
+            deflateBuildCode(distcode, lengths, 30);
+        } else if (type == 2) {
+            uint32_t nlen = deflateGetBits(s, 5) + 257;
+            uint32_t ndist = deflateGetBits(s, 5) + 1;
+            uint32_t ncode = deflateGetBits(s, 4) + 4;
+            if (s.error || nlen > 286 || ndist > 30) return 0;
+
+            uint32_t idx = 0;
+            for (; idx < ncode; idx++) lengths[order[idx]] = deflateGetBits(s, 3);
+            for (; idx < 19; idx++) lengths[order[idx]] = 0;
+            if (s.error || deflateBuildCode(lencode, lengths, 19) != 0) return 0;
+
+            idx = 0;
+            while (idx < nlen + ndist) {
+                int symbol = deflateDecode(s, lencode);
+                if (symbol < 0) return 0;
+                if (symbol < 16) {
+                    lengths[idx++] = symbol;
+                    continue;
+                }
+                uint16_t len = 0;
+                uint32_t repeat = 0;
+                if (symbol == 16) {
+                    if (idx == 0) return 0;
+                    len = lengths[idx - 1];
+                    repeat = 3 + deflateGetBits(s, 2);
+                } else if (symbol == 17) {
+                    repeat = 3 + deflateGetBits(s, 3);
+                } else {
+                    repeat = 11 + deflateGetBits(s, 7);
+                }
+                if (s.error || idx + repeat > nlen + ndist) return 0;
+                while (repeat--) lengths[idx++] = len;
+            }
+            // End of block code is required, incomplete codes only with a single symbol
+            if (lengths[256] == 0) return 0;
+            int left = deflateBuildCode(lencode, lengths, nlen);
+            if (left < 0 || (left > 0 && nlen - lencode.count[0] != 1)) return 0;
+            left = deflateBuildCode(distcode, lengths + nlen, ndist);
+            if (left < 0 || (left > 0 && ndist - distcode.count[0] != 1)) return 0;
+        } else {
+            return 0;
+        }
+
+        if (!deflateCodes(s, lencode, distcode, raw)) return 0;
+    }
+    return s.pos;
+}
+
+// Whether the last 8 bytes of size can be the gzip trailer of the deflate
+// data before them. Bounded below by 258 bytes per 2 bit match, above by
+// 9 bit fixed literals and a dynamic header per 16 KB block.
+static bool gzipTrailerFits(const uint8_t* in, uint32_t size) {
+    uint64_t deflate_size = size - 8;
+    const uint8_t* trailer = in + size - 4;
+    uint64_t isize = trailer[0] | (trailer[1] << 8) | (trailer[2] << 16) | ((uint32_t)trailer[3] << 24);
+    return isize <= deflate_size * 1032 && deflate_size <= isize + (isize >> 3) + 320 * (isize / 16384 + 1);
+}
+
+// Size of the gzip member at offset through its trailer, from the end of
+// its deflate stream as reported by the kernel, whose input starts 2 bytes
+// early. 0 when the stream is incomplete or the trailer does not match raw.
+static uint32_t gzipMemberEnd(const uint8_t* in, uint32_t input_size, uint32_t offset, uint32_t raw, uint32_t end) {
+    if (end <= 2) return 0;
+    uint64_t size = (uint64_t)end - 2 + 8;
+    if (offset + size > input_size) return 0;
+    const uint8_t* trailer = in + offset + size - 4;
+    uint32_t isize = trailer[0] | (trailer[1] << 8) | (trailer[2] << 16) | ((uint32_t)trailer[3] << 24);
+    return (isize == raw) ? size : 0;
+}
+
+static uint32_t gf2MatrixTimes(const uint32_t* mat, uint32_t vec) {
+    uint32_t sum = 0;
+    for (; vec; vec >>= 1, mat++) {
+        if (vec & 1) sum ^= *mat;
+    }
+    return sum;
+}
+
+static void gf2MatrixSquare(uint32_t* square, const uint32_t* mat) {
+    for (int n = 0; n < 32; n++) square[n] = gf2MatrixTimes(mat, mat[n]);
+}
+
+// CRC32 of two concatenated blocks from their individual CRCs,
+// same semantics as zlib crc32_combine
+static uint32_t crc32Combine(uint32_t crc1, uint32_t crc2, uint64_t len2) {
+    uint32_t even[32];
+    uint32_t odd[32];
+
+    if (len2 == 0) return crc1;
+
+    // Operator for one zero bit
+    odd[0] = 0xEDB88320;
+    uint32_t row = 1;
+    for (int n = 1; n < 32; n++) {
+        odd[n] = row;
+        row <<= 1;
+    }
+
+    // Operators for two and four zero bits
+    gf2MatrixSquare(even, odd);
+    gf2MatrixSquare(odd, even);
+
+    // Apply len2 zero bytes to crc1
+    do {
+        gf2MatrixSquare(even, odd);
+        if (len2 & 1) crc1 = gf2MatrixTimes(even, crc1);
+        len2 >>= 1;
+        if (len2 == 0) break;
+
+        gf2MatrixSquare(odd, even);
+        if (len2 & 1) crc1 = gf2MatrixTimes(odd, crc1);
+        len2 >>= 1;
+    } while (len2 != 0);
+
+    return crc1 ^ crc2;
+}
+
+// Adler32 of a host buffer, zlib stream trailer
+static uint32_t adler32Sw(uint32_t adler, const uint8_t* buf, uint64_t len) {
+    const uint32_t base = 65521;
+    // Largest n such that sums do not overflow 32 bit
+    const uint32_t nmax = 5552;
+    uint32_t s1 = adler & 0xFFFF;
+    uint32_t s2 = adler >> 16;
+    while (len) {
+        uint32_t n = (len < nmax) ? len : nmax;
+        len -= n;
+        while (n--) {
+            s1 += *buf++;
+            s2 += s1;
+        }
+        s1 %= base;
+        s2 %= base;
+    }
+    return (s2 << 16) | s1;
+}
+
+// zlib header FLG byte, FLEVEL records the compression level
+static uint8_t zlibFlag(int level) {
+    uint8_t flevel = (level < 2) ? 0 : (level < 6) ? 1 : (level == 6) ? 2 : 3;
+    uint8_t flg = flevel << 6;
+    // FCHECK makes CMF * 256 + FLG a multiple of 31
+    flg += 31 - ((120 * 256 + flg) % 31);
+    return flg;
+}
+
+// gzip header XFL byte, 2 for best and 4 for fast compression
+static uint8_t gzipExtraFlag(int level) {
+    return (level >= 7) ? 2 : (level <= 3) ? 4 : 0;
+}
+
+void zip(std::string& inFile_name,
+         std::ofstream& outFile,
+         uint8_t* zip_out,
+         uint32_t enbytes,
+         uint32_t checksum,
+         int level) {
 #ifdef zlib_FLOW
     // printme("In zlib FLOW \n");
     // 2 bytes of magic header
@@ -63,7 +412,7 @@ void zip(std::string& inFile_name, std::ofstream& outFile, uint8_t* zip_out, uin
     outFile.put(time_byte);
 
     // 1 byte extra flag (depend on compression method)
-    uint8_t deflate_flags = 0;
+    uint8_t deflate_flags = gzipExtraFlag(level);
     outFile.put(deflate_flags);
 
     // 1 byte OPCODE - 0x03 for Unix
@@ -77,20 +426,19 @@ void zip(std::string& inFile_name, std::ofstream& outFile, uint8_t* zip_out, uin
 #else
     ////printme("In ZLIB flow");
     outFile.put(120);
-    outFile.put(1);
+    outFile.put(zlibFlag(level));
 #endif
     outFile.write((char*)zip_out, enbytes);
 #ifdef zlib_FLOW
     unsigned long ifile_size = istat.st_size;
     uint8_t crc_byte = 0;
-    long crc_val = 0;
-    crc_byte = crc_val;
+    crc_byte = checksum;
     outFile.put(crc_byte);
-    crc_byte = crc_val >> 8;
+    crc_byte = checksum >> 8;
     outFile.put(crc_byte);
-    crc_byte = crc_val >> 16;
+    crc_byte = checksum >> 16;
     outFile.put(crc_byte);
-    crc_byte = crc_val >> 24;
+    crc_byte = checksum >> 24;
     outFile.put(crc_byte);
 
     uint8_t len_byte = 0;
@@ -102,12 +450,10 @@ void zip(std::string& inFile_name, std::ofstream& outFile, uint8_t* zip_out, uin
     outFile.put(len_byte);
     len_byte = ifile_size >> 24;
     outFile.put(len_byte);
+#else
+    // 4 bytes Adler32, most significant byte first
+    for (int i = 3; i >= 0; i--) outFile.put((uint8_t)(checksum >> (8 * i)));
 #endif
-    outFile.put(0);
-    outFile.put(0);
-    outFile.put(0);
-    outFile.put(0);
-    outFile.put(0);
 }
 
 uint32_t xfZlib::compress_file(std::string& inFile_name, std::string& outFile_name, uint64_t input_size) {
@@ -138,7 +484,12 @@ uint32_t xfZlib::compress_file(std::string& inFile_name, std::string& outFile_na
     std::cout << std::fixed << std::setprecision(2) << throughput_in_mbps_1;
 
     // Pack zlib encoded stream .gz file
-    zip(inFile_name, outFile, zlib_out.data(), enbytes);
+#ifdef zlib_FLOW
+    uint32_t checksum = m_crc32;
+#else
+    uint32_t checksum = adler32Sw(1, zlib_in.data(), input_size);
+#endif
+    zip(inFile_name, outFile, zlib_out.data(), enbytes, checksum, m_level);
 
     // Close file
     inFile.close();
@@ -153,9 +504,15 @@ int validate(std::string& inFile_name, std::string& outFile_name) {
 }
 
 // Constructor
-xfZlib::xfZlib(const std::string& binaryFileName) {
-    // Zlib Compression Binary Name
-    init(binaryFileName);
+xfZlib::xfZlib(const std::string& binaryFileName, int level) {
+    if (level < 1 || level > 9) {
+        std::cout << "Invalid compression level " << level << ", using " << DEFAULT_COMPRESSION_LEVEL << std::endl;
+        level = DEFAULT_COMPRESSION_LEVEL;
+    }
+
+    // Zlib Compression Binary Name, headers record the level it is built for
+    init(levelBinary(binaryFileName, level));
+    m_level = level;
 
     uint32_t block_size_in_kb = BLOCK_SIZE_IN_KB;
     uint32_t block_size_in_bytes = block_size_in_kb * 1024;
@@ -172,6 +529,7 @@ xfZlib::xfZlib(const std::string& binaryFileName) {
             h_buf_zlibout[i][j].resize(PARALLEL_ENGINES * HOST_BUFFER_SIZE * 2);
             h_blksize[i][j].resize(MAX_NUMBER_BLOCKS);
             h_compressSize[i][j].resize(MAX_NUMBER_BLOCKS);
+            h_checksum[i][j].resize(MAX_NUMBER_BLOCKS);
             h_dyn_ltree_freq[i][j].resize(PARALLEL_ENGINES * LTREE_SIZE);
             h_dyn_dtree_freq[i][j].resize(PARALLEL_ENGINES * DTREE_SIZE);
             h_dyn_bltree_freq[i][j].resize(PARALLEL_ENGINES * BLTREE_SIZE);
@@ -205,6 +563,10 @@ xfZlib::xfZlib(const std::string& binaryFileName) {
             buffer_inblk_size[cu][flag] = new cl::Buffer(*m_context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY,
                                                          temp_nblocks * sizeof(uint32_t), h_blksize[cu][flag].data());
 
+            buffer_checksum[cu][flag] =
+                new cl::Buffer(*m_context, CL_MEM_USE_HOST_PTR | CL_MEM_WRITE_ONLY, temp_nblocks * sizeof(uint32_t),
+                               h_checksum[cu][flag].data());
+
             buffer_dyn_ltree_freq[cu][flag] =
                 new cl::Buffer(*m_context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_WRITE,
                                PARALLEL_ENGINES * sizeof(uint32_t) * LTREE_SIZE, h_dyn_ltree_freq[cu][flag].data());
@@ -251,7 +613,10 @@ xfZlib::xfZlib(const std::string& binaryFileName) {
         h_dbuf_in[i].resize(PARALLEL_ENGINES * HOST_BUFFER_SIZE);
         h_dbuf_zlibout[i].resize(PARALLEL_ENGINES * HOST_BUFFER_SIZE * 10);
         h_dcompressSize[i].resize(MAX_NUMBER_BLOCKS);
+        h_dcompressEnd[i].resize(1);
     }
+
+    m_stream_active = false;
 }
 
 // Destructor
@@ -265,6 +630,7 @@ xfZlib::~xfZlib() {
             delete (buffer_zlib_output[cu][flag]);
             delete (buffer_compress_size[cu][flag]);
             delete (buffer_inblk_size[cu][flag]);
+            delete (buffer_checksum[cu][flag]);
 
             delete (buffer_dyn_ltree_freq[cu][flag]);
             delete (buffer_dyn_dtree_freq[cu][flag]);
@@ -297,7 +663,7 @@ int xfZlib::compress_buffer(uint8_t* in, uint8_t* out, uint64_t input_size) {
     uint32_t host_buffer_size = HOST_BUFFER_SIZE;
 
     out[0] = 120;
-    out[1] = 1;
+    out[1] = zlibFlag(m_level);
 
     // Call to compress
     // Zlib Compress
@@ -314,6 +680,27 @@ int xfZlib::compress_buffer(uint8_t* in, uint8_t* out, uint64_t input_size) {
     return enbytes;
 }
 
+// Fast and best builds of the xclbin sit next to the default one,
+// level falls back to the default one along with the binary
+std::string xfZlib::levelBinary(const std::string& binaryFile, int& level) {
+    std::string suffix = (level <= 3) ? "_fast" : (level >= 7) ? "_best" : "";
+    if (suffix.empty()) return binaryFile;
+
+    std::string levelFile = binaryFile;
+    size_t ext = levelFile.rfind(".xclbin");
+    if (ext == std::string::npos) ext = levelFile.size();
+    levelFile.insert(ext, suffix);
+
+    std::ifstream binFile(levelFile.c_str(), std::ifstream::binary);
+    if (!binFile) {
+        std::cout << "No xclbin for level " << level << ", using " << binaryFile << " at level "
+                  << DEFAULT_COMPRESSION_LEVEL << std::endl;
+        level = DEFAULT_COMPRESSION_LEVEL;
+        return binaryFile;
+    }
+    return levelFile;
+}
+
 int xfZlib::init(const std::string& binaryFileName) {
     // The get_xil_devices will return vector of Xilinx Devices
     std::vector<cl::Device> devices = xcl::get_xil_devices();
@@ -418,10 +805,19 @@ uint32_t xfZlib::decompress_file(std::string& inFile_name, std::string& outFile_
     // Allocat output size
     // 8 - Max CR per file expected, if this size is big
     // Decompression crashes
-    std::vector<uint8_t, aligned_allocator<uint8_t> > out(input_size * 10);
     uint32_t debytes = 0;
     // READ ZLIB header 2 bytes
     inFile.read((char*)in.data(), input_size);
+
+    // gzip trailers give the size of every member
+    uint64_t output_size = input_size * 10;
+    std::vector<gzipMember> members;
+    if (gzipMembers(in.data(), input_size, members)) {
+        uint64_t total = 0;
+        for (auto& member : members) total += member.isize;
+        output_size = std::max(output_size, total);
+    }
+    std::vector<uint8_t, aligned_allocator<uint8_t> > out(output_size);
     // printme("Call to zlib_decompress \n");
     // Call decompress
     auto decompress_API_start = std::chrono::high_resolution_clock::now();
@@ -442,9 +838,220 @@ uint32_t xfZlib::decompress_file(std::string& inFile_name, std::string& outFile_
     return debytes;
 }
 
+// Members are cut at BGZF block sizes when present. Otherwise a member is
+// cut at the next gzip header whose preceding bytes fit as a trailer, or
+// at the end of the input. These cuts are tentative, decompressMembers
+// checks each one against the end of the deflate stream reported by the
+// kernel and splits again from there.
+bool xfZlib::gzipMembers(const uint8_t* in, uint32_t input_size, std::vector<gzipMember>& members, uint32_t start) {
+    while (start < input_size) {
+        uint32_t bsize = 0;
+        uint32_t hdr = gzipHeaderSize(in + start, input_size - start, bsize);
+        if (hdr == 0) return false;
+
+        uint32_t end = input_size;
+        if (bsize) {
+            if ((uint64_t)start + bsize + 1 > input_size) return false;
+            end = start + bsize + 1;
+        } else {
+            bool more = false;
+            for (uint32_t i = start + hdr + 10; i + 20 <= input_size && !more; i++) {
+                uint32_t nextBsize;
+                more = (in[i] == FORMAT_0 && in[i + 1] == FORMAT_1 && gzipHeaderSize(in + i, input_size - i, nextBsize) &&
+                        gzipTrailerFits(in + start + hdr, i - start - hdr));
+                if (more) end = i;
+            }
+        }
+        if (end < start + hdr + 10) return false;
+
+        gzipMember member;
+        member.offset = start + hdr;
+        member.size = end - member.offset;
+        const uint8_t* trailer = in + end - 4;
+        member.isize = trailer[0] | (trailer[1] << 8) | (trailer[2] << 16) | ((uint32_t)trailer[3] << 24);
+        member.tentative = (bsize == 0);
+        members.push_back(member);
+        start = end;
+    }
+    return !members.empty();
+}
+
+// Every round hands one member to each decompress CU, results are
+// retired in order so the output is contiguous. Members too large for
+// the per CU buffers are decompressed on their own through the single
+// CU path. A member whose deflate stream ends before its cut is kept and
+// the input is split again after it, one whose stream does not end
+// within its cut is walked on the host for its end and decompressed again.
+uint32_t xfZlib::decompressMembers(const uint8_t* in,
+                                   uint8_t* out,
+                                   uint32_t input_size,
+                                   std::vector<gzipMember>& members) {
+    const uint32_t in_capacity = h_dbuf_in[0].size();
+    const uint32_t out_capacity = h_dbuf_zlibout[0].size();
+
+    // Output is sized like decompress_file does, the trailers may be wrong
+    uint64_t out_limit = (uint64_t)input_size * 10;
+    uint64_t total = 0;
+    for (auto& member : members) total += member.isize;
+    out_limit = std::max(out_limit, total);
+
+    cl::Buffer* buffer_in[D_COMPUTE_UNIT];
+    cl::Buffer* buffer_out[D_COMPUTE_UNIT];
+    cl::Buffer* buffer_size[D_COMPUTE_UNIT];
+    cl::Buffer* buffer_end[D_COMPUTE_UNIT];
+    for (uint32_t cu = 0; cu < D_COMPUTE_UNIT; cu++) {
+        buffer_in[cu] =
+            new cl::Buffer(*m_context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, in_capacity, h_dbuf_in[cu].data());
+        buffer_out[cu] = new cl::Buffer(*m_context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_WRITE, out_capacity,
+                                        h_dbuf_zlibout[cu].data());
+        buffer_size[cu] = new cl::Buffer(*m_context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_WRITE, 10 * sizeof(uint32_t),
+                                         h_dcompressSize[cu].data());
+        buffer_end[cu] = new cl::Buffer(*m_context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_WRITE, sizeof(uint32_t),
+                                        h_dcompressEnd[cu].data());
+    }
+
+    uint32_t outIdx = 0;
+    uint32_t next = 0;
+    bool failed = false;
+    while (next < members.size() && !failed) {
+        uint32_t count = 0;
+        uint32_t raw[D_COMPUTE_UNIT];
+        uint32_t end[D_COMPUTE_UNIT];
+        bool direct = false;
+        gzipMember& first = members[next];
+        if (first.size + 2 > in_capacity || first.isize > out_capacity) {
+            raw[0] = 0;
+            end[0] = 0;
+            if (outIdx + (uint64_t)first.isize <= out_limit) {
+                // Kernel skips a 2 byte zlib header, feed the last 2 bytes of the gzip header instead
+                raw[0] = decompressSingle((uint8_t*)in + first.offset - 2, out + outIdx, first.size + 2, first.isize,
+                                          0, &end[0]);
+            } else if (!first.tentative) {
+                std::cout << "Output buffer too small for gzip member at " << first.offset << std::endl;
+                failed = true;
+                break;
+            }
+            count = 1;
+            direct = true;
+        }
+
+        for (; !direct && count < D_COMPUTE_UNIT && next + count < members.size(); count++) {
+            uint32_t cu = count;
+            gzipMember& member = members[next + count];
+            if (member.size + 2 > in_capacity || member.isize > out_capacity) break;
+            raw[cu] = 0;
+            end[cu] = 0;
+            if (member.isize == 0) {
+                // Empty members need no kernel, their few bytes are checked on the host
+                uint64_t walked = 0;
+                uint64_t deflate_size = deflateWalk(in + member.offset, member.size - 8, walked);
+                if (deflate_size && walked == 0) end[cu] = deflate_size + 2;
+                continue;
+            }
+
+            // Kernel skips a 2 byte zlib header, feed the last 2 bytes of the gzip header instead
+            uint32_t kernel_input_size = member.size + 2;
+            std::memcpy(h_dbuf_in[cu].data(), in + member.offset - 2, kernel_input_size);
+
+            int narg = 0;
+            (decompress_kernel[cu])->setArg(narg++, *(buffer_in[cu]));
+            (decompress_kernel[cu])->setArg(narg++, *(buffer_out[cu]));
+            (decompress_kernel[cu])->setArg(narg++, *(buffer_size[cu]));
+            (decompress_kernel[cu])->setArg(narg++, *(buffer_end[cu]));
+            (decompress_kernel[cu])->setArg(narg++, kernel_input_size);
+
+            m_q_dec[cu]->enqueueMigrateMemObjects({*(buffer_in[cu])}, 0);
+            m_q_dec[cu]->enqueueTask(*decompress_kernel[cu]);
+            m_q_dec[cu]->enqueueMigrateMemObjects({*(buffer_size[cu]), *(buffer_end[cu])}, CL_MIGRATE_MEM_OBJECT_HOST);
+        }
+        for (uint32_t cu = 0; !direct && cu < count; cu++) {
+            m_q_dec[cu]->finish();
+            if (members[next + cu].isize) {
+                raw[cu] = h_dcompressSize[cu][0];
+                end[cu] = h_dcompressEnd[cu][0];
+            }
+        }
+
+        uint32_t done = 0;
+        for (; done < count && !failed; done++) {
+            gzipMember& member = members[next + done];
+            uint32_t offset = member.offset;
+            uint32_t size = gzipMemberEnd(in, input_size, offset, raw[done], end[done]);
+            if (size == 0) {
+                // Cut inside compressed data, find the end on the host and redo the member
+                uint64_t walked = 0;
+                uint64_t deflate_size =
+                    member.tentative ? deflateWalk(in + offset, input_size - offset, walked) : 0;
+                size = (deflate_size && walked <= UINT32_MAX)
+                           ? gzipMemberEnd(in, input_size, offset, walked, deflate_size + 2)
+                           : 0;
+                if (size == 0) {
+                    std::cout << "Corrupt gzip member at " << offset << std::endl;
+                    failed = true;
+                    break;
+                }
+                member.size = size;
+                member.isize = walked;
+                member.tentative = false;
+                members.resize(next + done + 1);
+                failed = !gzipMembers(in, input_size, members, offset + size);
+                break;
+            }
+
+            if (outIdx + (uint64_t)raw[done] > out_limit) {
+                std::cout << "Output buffer too small for gzip member at " << offset << std::endl;
+                failed = true;
+                break;
+            }
+            if (raw[done] && !direct)
+                m_q_dec[done]->enqueueReadBuffer(*(buffer_out[done]), CL_TRUE, 0, raw[done], out + outIdx);
+            outIdx += raw[done];
+
+            if (size != member.size) {
+                // Stream ends before the cut, split again after it
+                member.size = size;
+                member.isize = raw[done];
+                members.resize(next + done + 1);
+                failed = !gzipMembers(in, input_size, members, offset + size);
+                done++;
+                break;
+            }
+        }
+        next += done;
+    }
+
+    for (uint32_t cu = 0; cu < D_COMPUTE_UNIT; cu++) {
+        delete (buffer_in[cu]);
+        delete (buffer_out[cu]);
+        delete (buffer_size[cu]);
+        delete (buffer_end[cu]);
+    }
+    return failed ? 0 : outIdx;
+}
+
 uint32_t xfZlib::decompress(uint8_t* in, uint8_t* out, uint32_t input_size, int cu) {
+    // Independent gzip members are spread over all decompress CUs,
+    // a single member goes to cu without its gzip framing
+    uint64_t output_size = (uint64_t)input_size * 10;
+    std::vector<gzipMember> members;
+    if (gzipMembers(in, input_size, members)) {
+        if (members.size() > 1) return decompressMembers(in, out, input_size, members);
+        gzipMember& member = members[0];
+        uint32_t end = 0;
+        uint32_t raw_size = decompressSingle(in + member.offset - 2, out, member.size + 2,
+                                             std::max(output_size, (uint64_t)member.isize), cu, &end);
+        if (gzipMemberEnd(in, input_size, member.offset, raw_size, end) == member.size) return raw_size;
+        // More members follow the stream or it is corrupt, split again
+        return decompressMembers(in, out, input_size, members);
+    }
+    return decompressSingle(in, out, input_size, output_size, cu);
+}
+
+uint32_t xfZlib::decompressSingle(
+    uint8_t* in, uint8_t* out, uint32_t input_size, uint64_t output_size, int cu, uint32_t* end) {
+    // Inputs beyond the per CU host buffers get device buffers of their own
     bool flag = false;
-    if (input_size > 128 * 1024 * 1024) flag = true;
+    if (input_size > h_dbuf_in[cu].size() || output_size > h_dbuf_zlibout[cu].size()) flag = true;
     // printme("Entered zlib decop \n");
 
     std::chrono::duration<double, std::nano> kernel_time_ns_1(0);
@@ -455,13 +1062,14 @@ uint32_t xfZlib::decompress(uint8_t* in, uint8_t* out, uint32_t input_size, int
     cl::Buffer* buffer_in;
     cl::Buffer* buffer_out;
     cl::Buffer* buffer_size;
+    cl::Buffer* buffer_end = new cl::Buffer(*m_context, CL_MEM_READ_WRITE, sizeof(uint32_t));
     if (flag) {
         // printme("before buffer creation \n");
         buffer_in = new cl::Buffer(*m_context, CL_MEM_READ_ONLY, input_size);
-        buffer_out = new cl::Buffer(*m_context, CL_MEM_READ_WRITE, input_size * 10);
+        buffer_out = new cl::Buffer(*m_context, CL_MEM_READ_WRITE, output_size);
         buffer_size = new cl::Buffer(*m_context, CL_MEM_READ_WRITE, 10 * sizeof(uint32_t));
         inP = (uint8_t*)m_q_dec[cu]->enqueueMapBuffer(*(buffer_in), CL_TRUE, CL_MAP_READ, 0, input_size);
-        outP = (uint8_t*)m_q_dec[cu]->enqueueMapBuffer(*(buffer_out), CL_TRUE, CL_MAP_WRITE, 0, input_size * 10);
+        outP = (uint8_t*)m_q_dec[cu]->enqueueMapBuffer(*(buffer_out), CL_TRUE, CL_MAP_WRITE, 0, output_size);
         outSize =
             (uint32_t*)m_q_dec[cu]->enqueueMapBuffer(*(buffer_size), CL_TRUE, CL_MAP_WRITE, 0, 10 * sizeof(uint32_t));
     } else {
@@ -469,7 +1077,7 @@ uint32_t xfZlib::decompress(uint8_t* in, uint8_t* out, uint32_t input_size, int
         buffer_in =
             new cl::Buffer(*m_context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, input_size, h_dbuf_in[cu].data());
 
-        buffer_out = new cl::Buffer(*m_context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_WRITE, input_size * 10,
+        buffer_out = new cl::Buffer(*m_context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_WRITE, output_size,
                                     h_dbuf_zlibout[cu].data());
 
         buffer_size = new cl::Buffer(*m_context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_WRITE, 10 * sizeof(uint32_t),
@@ -489,6 +1097,7 @@ uint32_t xfZlib::decompress(uint8_t* in, uint8_t* out, uint32_t input_size, int
     (decompress_kernel[cu])->setArg(narg++, *(buffer_in));
     (decompress_kernel[cu])->setArg(narg++, *(buffer_out));
     (decompress_kernel[cu])->setArg(narg++, *(buffer_size));
+    (decompress_kernel[cu])->setArg(narg++, *(buffer_end));
     (decompress_kernel[cu])->setArg(narg++, input_size);
 
     // Migrate Memory - Map host to device buffers
@@ -508,8 +1117,10 @@ uint32_t xfZlib::decompress(uint8_t* in, uint8_t* out, uint32_t input_size, int
     // If raw size is greater than 3GB
     // Limit it to 3GB
     if (raw_size > (3U << (3 * 10))) raw_size = (3U << (3 * 10));
+    if (raw_size > output_size) raw_size = output_size;
 
     m_q_dec[cu]->enqueueReadBuffer(*(buffer_out), CL_TRUE, 0, raw_size * sizeof(uint8_t), &out[0]);
+    if (end) m_q_dec[cu]->enqueueReadBuffer(*(buffer_end), CL_TRUE, 0, sizeof(uint32_t), end);
 
     if (flag) {
         m_q_dec[cu]->enqueueUnmapMemObject(*buffer_in, inP, nullptr, nullptr);
@@ -519,6 +1130,7 @@ uint32_t xfZlib::decompress(uint8_t* in, uint8_t* out, uint32_t input_size, int
     delete (buffer_in);
     delete (buffer_out);
     delete (buffer_size);
+    delete (buffer_end);
 
     // printme("Done with decompress \n");
     return raw_size;
@@ -577,6 +1189,9 @@ uint32_t xfZlib::compress(uint8_t* in, uint8_t* out, uint32_t input_size, uint32
     int flag = 0;
     uint32_t lcl_cu = 0;
 
+    // Running CRC32 of the blocks written so far
+    m_crc32 = 0;
+
     uint8_t cunits = (uint8_t)C_COMPUTE_UNIT;
     uint8_t queue_idx = 0;
 overlap:
@@ -620,6 +1235,12 @@ overlap:
                     std::memcpy(&out[outIdx], &h_buf_zlibout[cu][flag].data()[bIdx * block_size_in_bytes],
                                 compressed_size);
                     outIdx += compressed_size;
+
+                    // Fold block checksum into the stream checksum
+                    uint32_t block_crc = (h_checksum[cu][flag].data())[bIdx];
+                    if (block_size < MIN_BLOCK_SIZE)
+                        block_crc = crc32Sw(0, &in[brick_flag_idx * host_buffer_size + index], block_size);
+                    m_crc32 = crc32Combine(m_crc32, block_crc, block_size);
                 }
             } // If condition which reads huffman output for 0 or 1 location
 
@@ -646,6 +1267,7 @@ overlap:
             (compress_kernel[cu])->setArg(narg++, *(buffer_inblk_size[cu][flag]));
             (compress_kernel[cu])->setArg(narg++, *(buffer_dyn_ltree_freq[cu][flag]));
             (compress_kernel[cu])->setArg(narg++, *(buffer_dyn_dtree_freq[cu][flag]));
+            (compress_kernel[cu])->setArg(narg++, *(buffer_checksum[cu][flag]));
             (compress_kernel[cu])->setArg(narg++, block_size_in_kb);
             (compress_kernel[cu])->setArg(narg++, sizeOfChunk[brick + cu]);
 
@@ -694,7 +1316,8 @@ overlap:
             m_q[queue_idx + cu]->enqueueTask(*huffman_kernel[cu]);
 
             m_q[queue_idx + cu]->enqueueMigrateMemObjects(
-                {*(buffer_zlib_output[cu][flag]), *(buffer_compress_size[cu][flag])}, CL_MIGRATE_MEM_OBJECT_HOST);
+                {*(buffer_zlib_output[cu][flag]), *(buffer_compress_size[cu][flag]), *(buffer_checksum[cu][flag])},
+                CL_MIGRATE_MEM_OBJECT_HOST);
         } // Internal loop runs on compute units
 
         if (total_chunks > 2)
@@ -743,6 +1366,12 @@ overlap:
                 uint32_t compressed_size = (h_compressSize[cu][flag].data())[bIdx];
                 std::memcpy(&out[outIdx], &h_buf_zlibout[cu][flag].data()[bIdx * block_size_in_bytes], compressed_size);
                 outIdx += compressed_size;
+
+                // Fold block checksum into the stream checksum
+                uint32_t block_crc = (h_checksum[cu][flag].data())[bIdx];
+                if (block_size < MIN_BLOCK_SIZE)
+                    block_crc = crc32Sw(0, &in[brick_flag_idx * host_buffer_size + index], block_size);
+                m_crc32 = crc32Combine(m_crc32, block_crc, block_size);
             }
         }
     }
@@ -757,3 +1386,195 @@ overlap:
     outIdx += xarg;
     return outIdx;
 } // Overlap end
+
+// Streaming compression keeps every [cu][flag] slot busy across write()
+// calls. Slots are used round robin, so the oldest in flight chunk is
+// always the next one to emit and the deflate stream stays in order.
+int xfZlib::begin(streamSink sink) {
+    if (m_stream_active) return -1;
+    m_sink = sink;
+
+#ifdef zlib_FLOW
+    // gzip header without file name or modification time
+    uint8_t header[10] = {FORMAT_0, FORMAT_1, VARIANT, 0, 0, 0, 0, 0, gzipExtraFlag(m_level), OPCODE};
+#else
+    uint8_t header[2] = {120, zlibFlag(m_level)};
+#endif
+    m_sink(header, sizeof(header));
+
+    m_stream_total = sizeof(header);
+    m_stream_isize = 0;
+    m_stream_adler = 1;
+    m_crc32 = 0;
+    m_stream_fill = 0;
+    m_stream_slot = 0;
+    m_stream_inflight = 0;
+    m_stream_active = true;
+    return 0;
+}
+
+int xfZlib::write(const uint8_t* in, uint64_t size) {
+    if (!m_stream_active) return -1;
+    const uint32_t total_slots = C_COMPUTE_UNIT * OVERLAP_BUF_COUNT;
+
+#ifndef zlib_FLOW
+    m_stream_adler = adler32Sw(m_stream_adler, in, size);
+#endif
+    m_stream_isize += size;
+
+    while (size) {
+        // Staging into a slot requires its previous chunk to be emitted
+        if (m_stream_fill == 0 && m_stream_inflight == total_slots) streamRetire();
+
+        uint32_t cu = m_stream_slot % C_COMPUTE_UNIT;
+        uint32_t flag = m_stream_slot / C_COMPUTE_UNIT;
+        uint32_t len = HOST_BUFFER_SIZE - m_stream_fill;
+        if (len > size) len = size;
+
+        std::memcpy(h_buf_in[cu][flag].data() + m_stream_fill, in, len);
+        m_stream_fill += len;
+        in += len;
+        size -= len;
+
+        if (m_stream_fill == HOST_BUFFER_SIZE) {
+            // Hand over chunks which already completed before queueing more
+            while (m_stream_inflight) {
+                uint32_t oldest = (m_stream_slot + total_slots - m_stream_inflight) % total_slots;
+                cl::Event& event = m_stream_event[oldest % C_COMPUTE_UNIT][oldest / C_COMPUTE_UNIT];
+                if (event.getInfo<CL_EVENT_COMMAND_EXECUTION_STATUS>() != CL_COMPLETE) break;
+                streamRetire();
+            }
+            streamSubmit();
+        }
+    }
+    return 0;
+}
+
+int xfZlib::flush() {
+    if (!m_stream_active) return -1;
+    // Deflate blocks are byte aligned, a partial chunk ends in short blocks
+    if (m_stream_fill) streamSubmit();
+    while (m_stream_inflight) streamRetire();
+    return 0;
+}
+
+uint64_t xfZlib::end() {
+    if (!m_stream_active) return 0;
+    flush();
+
+    // zlib special block based on Z_SYNC_FLUSH closes the deflate stream
+    uint8_t trailer[13] = {0x01, 0x00, 0x00, 0xff, 0xff};
+    uint32_t tIdx = 5;
+#ifdef zlib_FLOW
+    for (int i = 0; i < 4; i++) trailer[tIdx++] = m_crc32 >> (8 * i);
+    for (int i = 0; i < 4; i++) trailer[tIdx++] = m_stream_isize >> (8 * i);
+#else
+    for (int i = 3; i >= 0; i--) trailer[tIdx++] = m_stream_adler >> (8 * i);
+#endif
+    m_sink(trailer, tIdx);
+    m_stream_total += tIdx;
+
+    m_stream_active = false;
+    return m_stream_total;
+}
+
+void xfZlib::streamSubmit() {
+    uint32_t cu = m_stream_slot % C_COMPUTE_UNIT;
+    uint32_t flag = m_stream_slot / C_COMPUTE_UNIT;
+    uint32_t queue_idx = flag * C_COMPUTE_UNIT + cu;
+    uint32_t chunk_size = m_stream_fill;
+    uint32_t block_size_in_kb = BLOCK_SIZE_IN_KB;
+    uint32_t block_size_in_bytes = block_size_in_kb * 1024;
+
+    // Figure out block sizes of the chunk
+    uint32_t nblocks = 0;
+    for (uint32_t i = 0; i < chunk_size; i += block_size_in_bytes) {
+        uint32_t block_size = block_size_in_bytes;
+        if (i + block_size > chunk_size) block_size = chunk_size - i;
+        (h_blksize[cu][flag]).data()[nblocks++] = block_size;
+    }
+
+    // Set kernel arguments
+    int narg = 0;
+    (compress_kernel[cu])->setArg(narg++, *(buffer_input[cu][flag]));
+    (compress_kernel[cu])->setArg(narg++, *(buffer_lz77_output[cu][flag]));
+    (compress_kernel[cu])->setArg(narg++, *(buffer_compress_size[cu][flag]));
+    (compress_kernel[cu])->setArg(narg++, *(buffer_inblk_size[cu][flag]));
+    (compress_kernel[cu])->setArg(narg++, *(buffer_dyn_ltree_freq[cu][flag]));
+    (compress_kernel[cu])->setArg(narg++, *(buffer_dyn_dtree_freq[cu][flag]));
+    (compress_kernel[cu])->setArg(narg++, *(buffer_checksum[cu][flag]));
+    (compress_kernel[cu])->setArg(narg++, block_size_in_kb);
+    (compress_kernel[cu])->setArg(narg++, chunk_size);
+
+    narg = 0;
+    (treegen_kernel[cu])->setArg(narg++, *(buffer_dyn_ltree_freq[cu][flag]));
+    (treegen_kernel[cu])->setArg(narg++, *(buffer_dyn_dtree_freq[cu][flag]));
+    (treegen_kernel[cu])->setArg(narg++, *(buffer_dyn_bltree_freq[cu][flag]));
+    (treegen_kernel[cu])->setArg(narg++, *(buffer_dyn_ltree_codes[cu][flag]));
+    (treegen_kernel[cu])->setArg(narg++, *(buffer_dyn_dtree_codes[cu][flag]));
+    (treegen_kernel[cu])->setArg(narg++, *(buffer_dyn_bltree_codes[cu][flag]));
+    (treegen_kernel[cu])->setArg(narg++, *(buffer_dyn_ltree_blen[cu][flag]));
+    (treegen_kernel[cu])->setArg(narg++, *(buffer_dyn_dtree_blen[cu][flag]));
+    (treegen_kernel[cu])->setArg(narg++, *(buffer_dyn_bltree_blen[cu][flag]));
+    (treegen_kernel[cu])->setArg(narg++, *(buffer_max_codes[cu][flag]));
+    (treegen_kernel[cu])->setArg(narg++, block_size_in_kb);
+    (treegen_kernel[cu])->setArg(narg++, chunk_size);
+    (treegen_kernel[cu])->setArg(narg++, nblocks);
+
+    narg = 0;
+    (huffman_kernel[cu])->setArg(narg++, *(buffer_lz77_output[cu][flag]));
+    (huffman_kernel[cu])->setArg(narg++, *(buffer_zlib_output[cu][flag]));
+    (huffman_kernel[cu])->setArg(narg++, *(buffer_compress_size[cu][flag]));
+    (huffman_kernel[cu])->setArg(narg++, *(buffer_inblk_size[cu][flag]));
+    (huffman_kernel[cu])->setArg(narg++, *(buffer_dyn_ltree_codes[cu][flag]));
+    (huffman_kernel[cu])->setArg(narg++, *(buffer_dyn_dtree_codes[cu][flag]));
+    (huffman_kernel[cu])->setArg(narg++, *(buffer_dyn_bltree_codes[cu][flag]));
+    (huffman_kernel[cu])->setArg(narg++, *(buffer_dyn_ltree_blen[cu][flag]));
+    (huffman_kernel[cu])->setArg(narg++, *(buffer_dyn_dtree_blen[cu][flag]));
+    (huffman_kernel[cu])->setArg(narg++, *(buffer_dyn_bltree_blen[cu][flag]));
+    (huffman_kernel[cu])->setArg(narg++, *(buffer_max_codes[cu][flag]));
+    (huffman_kernel[cu])->setArg(narg++, block_size_in_kb);
+    (huffman_kernel[cu])->setArg(narg++, chunk_size);
+
+    // Each slot owns an in-order queue
+    m_q[queue_idx]->enqueueMigrateMemObjects({*(buffer_input[cu][flag]), *(buffer_inblk_size[cu][flag])}, 0);
+    m_q[queue_idx]->enqueueTask(*compress_kernel[cu]);
+    m_q[queue_idx]->enqueueTask(*treegen_kernel[cu]);
+    m_q[queue_idx]->enqueueTask(*huffman_kernel[cu]);
+    m_q[queue_idx]->enqueueMigrateMemObjects(
+        {*(buffer_zlib_output[cu][flag]), *(buffer_compress_size[cu][flag]), *(buffer_checksum[cu][flag])},
+        CL_MIGRATE_MEM_OBJECT_HOST, NULL, &(m_stream_event[cu][flag]));
+    m_q[queue_idx]->flush();
+
+    m_stream_size[cu][flag] = chunk_size;
+    m_stream_slot = (m_stream_slot + 1) % (C_COMPUTE_UNIT * OVERLAP_BUF_COUNT);
+    m_stream_inflight++;
+    m_stream_fill = 0;
+}
+
+void xfZlib::streamRetire() {
+    const uint32_t total_slots = C_COMPUTE_UNIT * OVERLAP_BUF_COUNT;
+    uint32_t oldest = (m_stream_slot + total_slots - m_stream_inflight) % total_slots;
+    uint32_t cu = oldest % C_COMPUTE_UNIT;
+    uint32_t flag = oldest / C_COMPUTE_UNIT;
+    uint32_t chunk_size = m_stream_size[cu][flag];
+    uint32_t block_size_in_bytes = BLOCK_SIZE_IN_KB * 1024;
+
+    m_q[flag * C_COMPUTE_UNIT + cu]->finish();
+
+    uint32_t bIdx = 0;
+    for (uint32_t index = 0; index < chunk_size; index += block_size_in_bytes, bIdx++) {
+        uint32_t block_size = block_size_in_bytes;
+        if (index + block_size > chunk_size) block_size = chunk_size - index;
+
+        uint32_t compressed_size = (h_compressSize[cu][flag].data())[bIdx];
+        m_sink(&h_buf_zlibout[cu][flag].data()[bIdx * block_size_in_bytes], compressed_size);
+        m_stream_total += compressed_size;
+
+        // Fold block checksum into the stream checksum
+        uint32_t block_crc = (h_checksum[cu][flag].data())[bIdx];
+        if (block_size < MIN_BLOCK_SIZE) block_crc = crc32Sw(0, &h_buf_in[cu][flag].data()[index], block_size);
+        m_crc32 = crc32Combine(m_crc32, block_crc, block_size);
+    }
+    m_stream_inflight--;
+}
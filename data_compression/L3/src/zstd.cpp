@@ -0,0 +1,308 @@
+/*
+ * (c) Copyright 2019 Xilinx, Inc. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#include "zstd.hpp"
+#include <chrono>
+#include <cstring>
+#include <algorithm>
+
+using namespace xf::compression;
+
+static uint32_t readLE32(const uint8_t* p) {
+    return p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static const char* statusMessage(uint32_t status) {
+    switch (status) {
+        case ZSTD_ERR_MAGIC:
+            return "unknown frame magic";
+        case ZSTD_ERR_WINDOW:
+            return "match offset beyond the kernel history window";
+        case ZSTD_ERR_DICTIONARY:
+            return "frames using a dictionary are not supported";
+        case ZSTD_ERR_CORRUPT:
+            return "corrupted input";
+        case ZSTD_ERR_OVERFLOW:
+            return "output buffer too small";
+        default:
+            return "unknown error";
+    }
+}
+
+// Constructor
+xfZstd::xfZstd(const std::string& binaryFileName) {
+    init(binaryFileName);
+
+    for (int i = 0; i < MAX_DDCOMP_UNITS; i++) {
+        h_dcompressSize[i].resize(16);
+        h_dstatus[i].resize(16);
+    }
+    m_status = ZSTD_OK;
+}
+
+// Destructor
+xfZstd::~xfZstd() {
+    release();
+}
+
+int xfZstd::init(const std::string& binaryFileName) {
+    // The get_xil_devices will return vector of Xilinx Devices
+    std::vector<cl::Device> devices = xcl::get_xil_devices();
+    cl::Device device = devices[0];
+
+    // Creating Context and Command Queue for selected Device
+    m_context = new cl::Context(device);
+
+    for (uint8_t flag = 0; flag < D_COMPUTE_UNIT; flag++) {
+        m_q_dec[flag] = new cl::CommandQueue(*m_context, device, CL_QUEUE_PROFILING_ENABLE);
+    }
+    std::string device_name = device.getInfo<CL_DEVICE_NAME>();
+    std::cout << "Found Device=" << device_name.c_str() << std::endl;
+
+    auto fileBuf = xcl::read_binary_file(binaryFileName);
+    cl::Program::Binaries bins{{fileBuf.data(), fileBuf.size()}};
+    devices.resize(1);
+    m_program = new cl::Program(*m_context, devices, bins);
+
+    std::string cu_id;
+    std::string decomp_krnl_name = decompress_kernel_names[0].c_str();
+
+    // Create Decompress Kernel
+    for (uint32_t i = 0; i < D_COMPUTE_UNIT; i++) {
+        cu_id = std::to_string(i + 1);
+        std::string krnl_name_full = decomp_krnl_name + ":{" + decomp_krnl_name + "_" + cu_id + "}";
+        decompress_kernel[i] = new cl::Kernel(*m_program, krnl_name_full.c_str());
+    }
+
+    return 0;
+}
+
+int xfZstd::release() {
+    delete (m_program);
+    for (uint8_t flag = 0; flag < D_COMPUTE_UNIT; flag++) {
+        delete (m_q_dec[flag]);
+    }
+    delete (m_context);
+
+    for (int i = 0; i < D_COMPUTE_UNIT; i++) delete (decompress_kernel[i]);
+
+    return 0;
+}
+
+bool xfZstd::parseFrames(const uint8_t* in, uint64_t input_size, std::vector<frameInfo>& frames) {
+    uint64_t pos = 0;
+    while (pos < input_size) {
+        if (input_size - pos < 4) return false;
+        uint32_t magic = readLE32(&in[pos]);
+        if ((magic & ZSTD_SKIPPABLE_MASK) == ZSTD_SKIPPABLE_MAGIC) {
+            if (input_size - pos < 8) return false;
+            pos += 8 + (uint64_t)readLE32(&in[pos + 4]);
+            if (pos > input_size) return false;
+            continue;
+        }
+        if (magic != ZSTD_MAGIC || input_size - pos < 5) return false;
+
+        uint8_t descriptor = in[pos + 4];
+        pos += 5;
+        uint32_t fcsFlag = descriptor >> 6;
+        uint32_t singleSegment = (descriptor >> 5) & 1;
+        uint32_t dictFlag = descriptor & 3;
+        uint32_t dictBytes = (dictFlag == 3) ? 4 : dictFlag;
+        uint32_t fcsBytes = (fcsFlag == 0) ? singleSegment : (1 << fcsFlag);
+        uint32_t headerBytes = (singleSegment ? 0 : 1) + dictBytes + fcsBytes;
+        if (input_size - pos < headerBytes) return false;
+        pos += headerBytes - fcsBytes;
+
+        frameInfo frame;
+        frame.content_size = 0;
+        for (uint32_t i = 0; i < fcsBytes; i++) frame.content_size |= (uint64_t)in[pos + i] << (8 * i);
+        if (fcsBytes == 2) frame.content_size += 256;
+        frame.has_size = (fcsBytes != 0);
+        pos += fcsBytes;
+
+        // Block sizes give the frame length, not its content size
+        bool lastBlock = false;
+        while (!lastBlock) {
+            if (input_size - pos < 3) return false;
+            uint32_t blockHeader = in[pos] | ((uint32_t)in[pos + 1] << 8) | ((uint32_t)in[pos + 2] << 16);
+            lastBlock = blockHeader & 1;
+            uint32_t blockType = (blockHeader >> 1) & 3;
+            uint32_t blockSize = blockHeader >> 3;
+            if (blockType == 3) return false;
+            pos += 3 + ((blockType == 1) ? 1 : blockSize);
+            if (pos > input_size) return false;
+        }
+
+        frame.has_checksum = (descriptor >> 2) & 1;
+        frame.checksum = 0;
+        if (frame.has_checksum) {
+            if (input_size - pos < 4) return false;
+            frame.checksum = readLE32(&in[pos]);
+            pos += 4;
+        }
+        frames.push_back(frame);
+    }
+    return true;
+}
+
+uint64_t xfZstd::getDecompressedSize(const uint8_t* in, uint64_t input_size) {
+    std::vector<frameInfo> frames;
+    if (!parseFrames(in, input_size, frames)) return 0;
+
+    uint64_t total = 0;
+    for (auto& frame : frames) {
+        if (!frame.has_size) return 0;
+        total += frame.content_size;
+    }
+    return total;
+}
+
+bool xfZstd::verifyChecksum(const uint8_t* in, uint64_t input_size, const uint8_t* out, uint64_t output_size) {
+    std::vector<frameInfo> frames;
+    if (!parseFrames(in, input_size, frames)) return false;
+
+    uint64_t offset = 0;
+    for (uint32_t i = 0; i < frames.size(); i++) {
+        bool last = (i + 1 == frames.size());
+        // Frames past one without content size can not be located
+        if (!frames[i].has_size && !last) break;
+        uint64_t size = frames[i].has_size ? frames[i].content_size : output_size - offset;
+        if (offset + size > output_size) return false;
+        if (frames[i].has_checksum && (uint32_t)XXH64(&out[offset], size, 0) != frames[i].checksum) return false;
+        offset += size;
+    }
+    return true;
+}
+
+uint64_t xfZstd::decompress_file(std::string& inFile_name,
+                                 std::string& outFile_name,
+                                 uint64_t input_size,
+                                 int cu) {
+    std::chrono::duration<double, std::nano> decompress_API_time_ns_1(0);
+    std::ifstream inFile(inFile_name.c_str(), std::ifstream::binary);
+    std::ofstream outFile(outFile_name.c_str(), std::ofstream::binary);
+
+    if (!inFile) {
+        std::cout << "Unable to open file";
+        exit(1);
+    }
+
+    std::vector<uint8_t, aligned_allocator<uint8_t> > in(input_size);
+    inFile.read((char*)in.data(), input_size);
+
+    // Size the output from the frame headers, guess when they do not tell
+    uint64_t output_size = getDecompressedSize(in.data(), input_size);
+    if (output_size == 0) output_size = input_size * ZSTD_DEFAULT_RATIO;
+    if (output_size > ZSTD_MAX_KERNEL_BUFFER) output_size = ZSTD_MAX_KERNEL_BUFFER;
+
+    std::vector<uint8_t, aligned_allocator<uint8_t> > out;
+    uint64_t debytes = 0;
+    auto decompress_API_start = std::chrono::high_resolution_clock::now();
+    while (true) {
+        out.resize(output_size);
+        debytes = decompress(in.data(), out.data(), input_size, output_size, cu);
+        if (m_status != ZSTD_ERR_OVERFLOW || output_size == ZSTD_MAX_KERNEL_BUFFER) break;
+        output_size = std::min(output_size * 2, (uint64_t)ZSTD_MAX_KERNEL_BUFFER);
+    }
+    auto decompress_API_end = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration<double, std::nano>(decompress_API_end - decompress_API_start);
+    decompress_API_time_ns_1 += duration;
+
+    float throughput_in_mbps_1 = (float)debytes * 1000 / decompress_API_time_ns_1.count();
+    std::cout << std::fixed << std::setprecision(2) << throughput_in_mbps_1;
+
+    outFile.write((char*)out.data(), debytes);
+
+    // Close file
+    inFile.close();
+    outFile.close();
+
+    return debytes;
+}
+
+uint64_t xfZstd::decompress(uint8_t* in, uint8_t* out, uint64_t input_size, uint64_t output_size, int cu) {
+    if (input_size > ZSTD_MAX_KERNEL_BUFFER) {
+        std::cout << "Input larger than 4GB is not supported" << std::endl;
+        m_status = ZSTD_ERR_CORRUPT;
+        return 0;
+    }
+    if (output_size > ZSTD_MAX_KERNEL_BUFFER) output_size = ZSTD_MAX_KERNEL_BUFFER;
+
+    // Device buffers can not be empty
+    uint64_t in_alloc = std::max(input_size, (uint64_t)64);
+    uint64_t out_alloc = std::max(output_size, (uint64_t)64);
+    h_dbuf_in[cu].resize(in_alloc);
+    h_dbuf_zstdout[cu].resize(out_alloc);
+
+    cl::Buffer* buffer_in =
+        new cl::Buffer(*m_context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, in_alloc, h_dbuf_in[cu].data());
+    cl::Buffer* buffer_out =
+        new cl::Buffer(*m_context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_WRITE, out_alloc, h_dbuf_zstdout[cu].data());
+    cl::Buffer* buffer_size = new cl::Buffer(*m_context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_WRITE,
+                                             16 * sizeof(uint32_t), h_dcompressSize[cu].data());
+    cl::Buffer* buffer_status = new cl::Buffer(*m_context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_WRITE,
+                                               16 * sizeof(uint32_t), h_dstatus[cu].data());
+
+    // Copy compressed input to h_dbuf_in
+    std::memcpy(h_dbuf_in[cu].data(), in, input_size);
+
+    uint32_t in_size = input_size;
+    uint32_t out_size = output_size;
+    int narg = 0;
+    // Set Kernel Args
+    (decompress_kernel[cu])->setArg(narg++, *(buffer_in));
+    (decompress_kernel[cu])->setArg(narg++, *(buffer_out));
+    (decompress_kernel[cu])->setArg(narg++, *(buffer_size));
+    (decompress_kernel[cu])->setArg(narg++, *(buffer_status));
+    (decompress_kernel[cu])->setArg(narg++, in_size);
+    (decompress_kernel[cu])->setArg(narg++, out_size);
+
+    // Migrate Memory - Map host to device buffers
+    m_q_dec[cu]->enqueueMigrateMemObjects({*(buffer_in)}, 0);
+    m_q_dec[cu]->finish();
+
+    // Kernel invocation
+    m_q_dec[cu]->enqueueTask(*decompress_kernel[cu]);
+    m_q_dec[cu]->finish();
+
+    // Migrate memory - Map device to host buffers
+    m_q_dec[cu]->enqueueMigrateMemObjects({*(buffer_size), *(buffer_status)}, CL_MIGRATE_MEM_OBJECT_HOST);
+    m_q_dec[cu]->finish();
+
+    m_status = h_dstatus[cu][0];
+    uint64_t raw_size = h_dcompressSize[cu][0];
+
+    if (m_status == ZSTD_OK && raw_size > 0)
+        m_q_dec[cu]->enqueueReadBuffer(*(buffer_out), CL_TRUE, 0, raw_size * sizeof(uint8_t), &out[0]);
+
+    delete (buffer_in);
+    delete (buffer_out);
+    delete (buffer_size);
+    delete (buffer_status);
+
+    if (m_status != ZSTD_OK) {
+        // Overflow is handled by the caller growing the output buffer
+        if (m_status != ZSTD_ERR_OVERFLOW) std::cout << "Zstd decompression failed: " << statusMessage(m_status) << std::endl;
+        return 0;
+    }
+
+    if (!verifyChecksum(in, input_size, out, raw_size)) {
+        std::cout << "Zstd content checksum mismatch" << std::endl;
+        m_status = ZSTD_ERR_CORRUPT;
+        return 0;
+    }
+    return raw_size;
+}
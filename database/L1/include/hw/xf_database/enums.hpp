@@ -73,12 +73,46 @@ enum FilterOp {
  */
 enum JoinType { JT_INNER, JT_SEMI, JT_ANTI, JT_LEFT, JT_RIGHT };
 
+/**
+ * @brief Hash join stages to run in one call
+ *
+ * With JS_BUILD the hash table is left in HBM/DDR, so later JS_PROBE calls
+ * can probe it without feeding the small table again.
+ */
+enum JoinStage { JS_BUILD_PROBE, JS_BUILD, JS_PROBE };
+
 /// @brief width of comparison operator in bits.
 enum { FilterOpWidth = 4 };
 
 /// @brief Sort Order enum.
 enum SortOrder { SORT_ASCENDING = 1, SORT_DESCENDING = 0 };
 
+/**
+ * @brief Encoding of a 32-bit column, as read by scanEncodedCol.
+ *
+ * Packed encodings store each value in a fixed number of bits, never across
+ * two 512-bit words. RLE stores 8 runs of value and length per word.
+ */
+enum ColEncoding {
+    CE_PLAIN = 0, ///< 32 bits per value.
+    CE_BITPACK,   ///< non-negative values, packed in the bit width of the largest.
+    CE_FOR,       ///< frame-of-reference, packed offsets from the smallest value.
+    CE_RLE        ///< run-length, 32-bit value and 32-bit run length.
+};
+
+/**
+ * @brief String pattern match operator, as used by scanMatchStrCol.
+ *
+ * SM_NOT can be or-ed to any of the others to invert the result.
+ */
+enum StrMatchOp {
+    SM_EQ = 0,   ///< whole string equals the pattern.
+    SM_PREFIX,   ///< string starts with the pattern, as LIKE 'pat%'.
+    SM_SUFFIX,   ///< string ends with the pattern, as LIKE '%pat'.
+    SM_CONTAINS, ///< pattern appears anywhere in the string, as LIKE '%pat%'.
+    SM_NOT = 4   ///< invert the result, as NOT LIKE.
+};
+
 } // namespace enums
 
 using namespace enums;
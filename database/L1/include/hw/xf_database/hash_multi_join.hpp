@@ -313,11 +313,21 @@ void multi_probe_wrapper(ap_uint<32>& depth,
 
 //----------------------------------------------build+merge+probe------------------------------------------------
 
+/// @brief Read hash depth and join stage
+template <int PU>
+void read_status(hls::stream<ap_uint<32> >& pu_begin_status_strms, ap_uint<32>& depth, ap_uint<2>& stage) {
+    // get depth
+    depth = pu_begin_status_strms.read();
+    // get join stage, JS_BUILD_PROBE by default
+    stage = pu_begin_status_strms.read();
+}
+
 /// @brief Top function of hash multi join PU
 template <int HASH_MODE, int HASHWH, int HASHWL, int KEYW, int S_PW, int T_PW, int ARW>
 void build_merge_multi_probe_wrapper(
     // input status
     ap_uint<32>& depth,
+    ap_uint<2>& stage,
 
     // input table
     hls::stream<ap_uint<HASHWL> >& i_hash_strm,
@@ -364,8 +374,19 @@ void build_merge_multi_probe_wrapper(
 
     ap_uint<32> overflow_length = 0;
 
-    // initilize uram by previous hash build or probe
-    join_v3::sc::initiate_uram<HASHWL, ARW>(bit_vector0, bit_vector1);
+    // hash counters of a resident table are kept in stb_buf, in place of the
+    // overflow srows which are no longer needed once merged into htb_buf
+    const int RW = (KEYW + S_PW + 63) / 64;
+    ap_uint<64> save_addr = ((ap_uint<64>)(1 << HASHWL) * depth * RW + 1) / 2;
+
+    if (stage == JS_PROBE) {
+        // reload hash table left by JS_BUILD
+        join_v3::sc::read_htb<HASHWL, ARW>(stb_buf, save_addr, bit_vector0);
+        join_v3::sc::read_htb<HASHWL, ARW>(stb_buf, save_addr + HASH_DEPTH, bit_vector1);
+    } else {
+        // initilize uram by previous hash build or probe
+        join_v3::sc::initiate_uram<HASHWL, ARW>(bit_vector0, bit_vector1);
+    }
 
 #ifndef __SYNTHESIS__
     std::cout << "----------------------build------------------------" << std::endl;
@@ -396,6 +417,12 @@ void build_merge_multi_probe_wrapper(
             htb_buf, stb_buf, bit_vector1);
     }
 
+    if (stage == JS_BUILD) {
+        // keep hash table for JS_PROBE
+        join_v3::sc::write_htb<HASHWL, ARW>(stb_buf, save_addr, bit_vector0);
+        join_v3::sc::write_htb<HASHWL, ARW>(stb_buf, save_addr + HASH_DEPTH, bit_vector1);
+    }
+
 // probe
 #ifndef __SYNTHESIS__
     std::cout << "-----------------------Probe------------------------" << std::endl;
@@ -813,6 +840,12 @@ namespace database {
  * This primitive shares most of the structure of ``hashJoinV3``.
  * The inner table should be fed once, followed by the outer table once.
  *
+ * The second word of begin status selects the ``JoinStage``. ``JS_BUILD``
+ * additionally stores the hash counters behind the base rows in ``stb_buf``,
+ * so that ``JS_PROBE`` calls can probe the same hash table with an empty inner
+ * table. ``stb_buf`` then needs room for two ``(1 << HASHWL) / 3 + 1`` tables
+ * of 128-bit entries after the base rows.
+ *
  * @tparam HASH_MODE 0 for radix and 1 for Jenkin's Lookup3 hash.
  * @tparam KEYW width of key, in bit.
  * @tparam PW width of max payload, in bit.
@@ -847,7 +880,7 @@ namespace database {
  * @param stb6_buf HBM/DDR buffer of PU6
  * @param stb7_buf HBM/DDR buffer of PU7
  *
- * @param pu_begin_status_strms constains depth of hash, row number of join result
+ * @param pu_begin_status_strms constains depth of hash, join stage as ``JoinStage``
  * @param pu_end_status_strms constains depth of hash, row number of join result
  *
  * @param j_strm output of joined result
@@ -895,6 +928,7 @@ void hashMultiJoin(
     details::hash_multi_join::dup_join_flag<8>(join_flag_strm, join_flag_strms);
 
     ap_uint<32> depth;
+    ap_uint<2> stage;
     ap_uint<32> join_num;
 
     // dispatch k0_strm_arry, p0_strm_arry, e0strm_arry to channel1-4
@@ -1033,7 +1067,7 @@ void hashMultiJoin(
     std::cout << "------------------------read status------------------------" << std::endl;
 #endif
 #endif
-    details::join_v3::sc::read_status<PU>(pu_begin_status_strms, depth);
+    details::hash_multi_join::read_status<PU>(pu_begin_status_strms, depth, stage);
 
 //---------------------------------dispatch PU-------------------------------
 #ifndef __SYNTHESIS__
@@ -1111,7 +1145,7 @@ void hashMultiJoin(
 #endif
         details::hash_multi_join::build_merge_multi_probe_wrapper<HASH_MODE, HASHWH, HASHWL, KEYW, S_PW, B_PW, ARW>(
             // input status
-            depth,
+            depth, stage,
 
             // input table
             hash_strm_arry[0], k1_strm_arry[0], p1_strm_arry[0], e1_strm_arry[0],
@@ -1132,7 +1166,7 @@ void hashMultiJoin(
 #endif
         details::hash_multi_join::build_merge_multi_probe_wrapper<HASH_MODE, HASHWH, HASHWL, KEYW, S_PW, B_PW, ARW>(
             // input status
-            depth,
+            depth, stage,
 
             // input t-table
             hash_strm_arry[1], k1_strm_arry[1], p1_strm_arry[1], e1_strm_arry[1],
@@ -1153,7 +1187,7 @@ void hashMultiJoin(
 #endif
         details::hash_multi_join::build_merge_multi_probe_wrapper<HASH_MODE, HASHWH, HASHWL, KEYW, S_PW, B_PW, ARW>(
             // input status
-            depth,
+            depth, stage,
 
             // input t-table
             hash_strm_arry[2], k1_strm_arry[2], p1_strm_arry[2], e1_strm_arry[2],
@@ -1172,7 +1206,7 @@ void hashMultiJoin(
 #endif
         details::hash_multi_join::build_merge_multi_probe_wrapper<HASH_MODE, HASHWH, HASHWL, KEYW, S_PW, B_PW, ARW>(
             // input status
-            depth,
+            depth, stage,
 
             // input t-table
             hash_strm_arry[3], k1_strm_arry[3], p1_strm_arry[3], e1_strm_arry[3],
@@ -1193,7 +1227,7 @@ void hashMultiJoin(
 #endif
         details::hash_multi_join::build_merge_multi_probe_wrapper<HASH_MODE, HASHWH, HASHWL, KEYW, S_PW, B_PW, ARW>(
             // input status
-            depth,
+            depth, stage,
 
             // input t-table
             hash_strm_arry[4], k1_strm_arry[4], p1_strm_arry[4], e1_strm_arry[4],
@@ -1212,7 +1246,7 @@ void hashMultiJoin(
 #endif
         details::hash_multi_join::build_merge_multi_probe_wrapper<HASH_MODE, HASHWH, HASHWL, KEYW, S_PW, B_PW, ARW>(
             // input status
-            depth,
+            depth, stage,
 
             // input t-table
             hash_strm_arry[5], k1_strm_arry[5], p1_strm_arry[5], e1_strm_arry[5],
@@ -1231,7 +1265,7 @@ void hashMultiJoin(
 #endif
         details::hash_multi_join::build_merge_multi_probe_wrapper<HASH_MODE, HASHWH, HASHWL, KEYW, S_PW, B_PW, ARW>(
             // input status
-            depth,
+            depth, stage,
 
             // input t-table
             hash_strm_arry[6], k1_strm_arry[6], p1_strm_arry[6], e1_strm_arry[6],
@@ -1250,7 +1284,7 @@ void hashMultiJoin(
 #endif
         details::hash_multi_join::build_merge_multi_probe_wrapper<HASH_MODE, HASHWH, HASHWL, KEYW, S_PW, B_PW, ARW>(
             // input status
-            depth,
+            depth, stage,
 
             // input t-table
             hash_strm_arry[7], k1_strm_arry[7], p1_strm_arry[7], e1_strm_arry[7],
@@ -0,0 +1,181 @@
+/*
+ * Copyright 2019 Xilinx, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file hyper_log_log.hpp
+ * @brief HyperLogLog sketch template function implementation.
+ *
+ * This file is part of Vitis Database Library.
+ */
+
+#ifndef XF_DATABASE_HYPER_LOG_LOG_HPP
+#define XF_DATABASE_HYPER_LOG_LOG_HPP
+
+#ifndef __cplusplus
+#error "xf_database_hyper_log_log hls::stream<> interface, and thus requires C++"
+#endif
+
+#include <ap_int.h>
+#include <hls_stream.h>
+
+#include "xf_database/hash_murmur3.hpp"
+#include "xf_database/utils.hpp"
+
+namespace xf {
+namespace database {
+namespace details {
+
+// position of the first set bit counted from the MSB, starting at 1,
+// or RW + 1 when no bit is set.
+template <int RW>
+inline ap_uint<8> hll_rank(ap_uint<RW> w) {
+#pragma HLS INLINE
+    ap_uint<8> rank = RW + 1;
+    for (int i = 0; i < RW; i++) {
+#pragma HLS UNROLL
+        if (w[i]) rank = RW - i;
+    }
+    return rank;
+}
+
+// hash each key and keep the largest rank seen by each register of its group.
+template <int W, int GRPW, int P>
+void hll_update(hls::stream<ap_uint<W> >& key_strm,
+                hls::stream<ap_uint<GRPW> >& grp_strm,
+                hls::stream<bool>& in_e_strm,
+                ap_uint<8> regs[(1 << (GRPW + P))]) {
+    ap_uint<8> state_c, state_r0, state_r1, state_r2;
+    ap_uint<GRPW + P> addr_c, addr_r0, addr_r1, addr_r2;
+    addr_r0 = addr_r1 = addr_r2 = -1;
+    state_r0 = state_r1 = state_r2 = 0;
+
+    hls::stream<ap_uint<W> > key_strm_in;
+#pragma HLS STREAM variable = key_strm_in depth = 2
+    hls::stream<ap_uint<32> > hash_strm_out;
+#pragma HLS STREAM variable = hash_strm_out depth = 2
+
+    bool e = in_e_strm.read();
+HLL_UPDATE_LOOP:
+    while (!e) {
+#pragma HLS dependence variable = regs inter false
+#pragma HLS PIPELINE II = 1
+        ap_uint<W> key = key_strm.read();
+        ap_uint<GRPW> grp = grp_strm.read();
+        e = in_e_strm.read();
+
+        // 32-bit murmur3, low P bits select the register, the rest gives the rank
+        key_strm_in.write(key);
+        hashMurmur3<W, 32>(key_strm_in, hash_strm_out);
+        ap_uint<32> h = hash_strm_out.read();
+        ap_uint<8> rank = hll_rank<32 - P>(h.range(31, P));
+
+        addr_c.range(GRPW + P - 1, P) = grp;
+        addr_c.range(P - 1, 0) = h.range(P - 1, 0);
+
+        // forward the registers still in flight
+        if (addr_c == addr_r0)
+            state_c = state_r0;
+        else if (addr_c == addr_r1)
+            state_c = state_r1;
+        else if (addr_c == addr_r2)
+            state_c = state_r2;
+        else
+            state_c = regs[addr_c];
+
+        state_c = (state_c > rank) ? state_c : rank;
+        regs[addr_c] = state_c;
+
+        state_r2 = state_r1;
+        state_r1 = state_r0;
+        state_r0 = state_c;
+        addr_r2 = addr_r1;
+        addr_r1 = addr_r0;
+        addr_r0 = addr_c;
+    }
+}
+
+} // namespace details
+} // namespace database
+} // namespace xf
+
+namespace xf {
+namespace database {
+
+/**
+ * @brief HyperLogLog sketch of distinct keys, kept for each group.
+ *
+ * Every key is hashed by ``hashMurmur3`` into 32 bits. The low P bits select one of
+ * the 2^P registers of the sketch of its group, and the register keeps the largest
+ * count of leading zeros plus one seen in the other 32 - P bits. Memory is fixed at
+ * 2^(GRPW + P) bytes whatever the number of rows or distinct keys.
+ *
+ * When the input ends, the sketches of all groups are emitted in group order, as
+ * 2^(P - 3) words of 8 one-byte registers each, register i in bits 8i+7 to 8i.
+ * Sketches of the same group are merged by taking the byte-wise max, so partial
+ * results of different kernels or runs can be combined on host before estimating
+ * the distinct count, see ``hyper_log_log_host.hpp`` in L3.
+ *
+ * The relative standard error of the estimate is about 1.04 / sqrt(2^P).
+ *
+ * @tparam W width of key, multiple of 32.
+ * @tparam GRPW width of group id, 2^GRPW sketches are kept.
+ * @tparam P log2 of the number of registers per sketch, from 4 to 16.
+ *
+ * @param key_strm input of keys.
+ * @param grp_strm input of the group id of each key.
+ * @param in_e_strm end flag of input.
+ * @param sketch_strm output of sketch registers, 8 per word.
+ * @param out_e_strm end flag of output.
+ */
+template <int W, int GRPW, int P>
+void hyperLogLog(hls::stream<ap_uint<W> >& key_strm,
+                 hls::stream<ap_uint<GRPW> >& grp_strm,
+                 hls::stream<bool>& in_e_strm,
+                 hls::stream<ap_uint<64> >& sketch_strm,
+                 hls::stream<bool>& out_e_strm) {
+    XF_DATABASE_STATIC_ASSERT(W % 32 == 0, "key width of hyperLogLog must be multiple of 32");
+    XF_DATABASE_STATIC_ASSERT(P >= 4 && P <= 16, "hyperLogLog supports 2^4 to 2^16 registers per sketch");
+
+    ap_uint<8> regs[(1 << (GRPW + P))];
+#pragma HLS array_partition variable = regs cyclic factor = 8
+#pragma HLS resource variable = regs core = RAM_2P_URAM
+
+HLL_INIT_LOOP:
+    for (int i = 0; i < (1 << (GRPW + P)); i++) {
+#pragma HLS PIPELINE II = 1
+        regs[i] = 0;
+    }
+
+    details::hll_update<W, GRPW, P>(key_strm, grp_strm, in_e_strm, regs);
+
+HLL_OUTPUT_LOOP:
+    for (int i = 0; i < (1 << (GRPW + P - 3)); i++) {
+#pragma HLS PIPELINE II = 1
+        ap_uint<64> w;
+        for (int j = 0; j < 8; j++) {
+#pragma HLS UNROLL
+            w.range(8 * j + 7, 8 * j) = regs[8 * i + j];
+        }
+        sketch_strm.write(w);
+        out_e_strm.write(false);
+    }
+    out_e_strm.write(true);
+}
+
+} // namespace database
+} // namespace xf
+
+#endif // XF_DATABASE_HYPER_LOG_LOG_HPP
@@ -32,6 +32,9 @@
 #include "ap_int.h"
 #include "hls_stream.h"
 
+#include "xf_database/enums.hpp"
+#include "xf_database/utils.hpp"
+
 #ifndef __SYNTHESIS__
 #include <iostream>
 #endif
@@ -310,6 +313,118 @@ main_loop:
     e_str_o << true;
 }
 
+/**
+ * @brief      match a string stream against multiple patterns with shift-and
+ *
+ * Each string is matched in one cycle: the shift-and state of every pattern is
+ * unrolled over the 63 chars of the padding-zero format, so that hit[i] tells
+ * whether the pattern ends at char i.
+ *
+ * @tparam     NP           number of patterns.
+ * @tparam     PL           max length of pattern.
+ *
+ * @param      str_stream   input string stream, 512 bits in heading-length and
+ *                          padding-zero format.
+ * @param      e_str_i      end flag stream for input data.
+ * @param      pat_stream   input pattern stream, NP patterns in the same format.
+ * @param      op_stream    input match operator of each pattern.
+ * @param      out_stream   output match result, bit p for pattern p.
+ * @param      e_str_o      end flag stream for output data.
+ */
+template <int NP, int PL>
+void str_match(hls::stream<ap_uint<512> >& str_stream,
+               hls::stream<bool>& e_str_i,
+               hls::stream<ap_uint<512> >& pat_stream,
+               hls::stream<ap_uint<8> >& op_stream,
+               hls::stream<ap_uint<NP> >& out_stream,
+               hls::stream<bool>& e_str_o) {
+    ap_uint<8> pat[NP][PL];
+#pragma HLS ARRAY_PARTITION variable = pat complete dim = 0
+    ap_uint<PL> last[NP];
+#pragma HLS ARRAY_PARTITION variable = last complete dim = 1
+    ap_uint<6> plen[NP];
+#pragma HLS ARRAY_PARTITION variable = plen complete dim = 1
+    ap_uint<8> op[NP];
+#pragma HLS ARRAY_PARTITION variable = op complete dim = 1
+
+// read patterns once as configuration
+pattern_read_loop:
+    for (int p = 0; p < NP; p++) {
+#pragma HLS PIPELINE II = 1
+        ap_uint<512> pw = pat_stream.read();
+        op[p] = op_stream.read();
+        plen[p] = pw.range(509, 504);
+#ifndef __SYNTHESIS__
+        if (plen[p] > PL) std::cout << "ERROR: pattern " << p << " is longer than " << PL << " chars." << std::endl;
+#endif
+        for (int j = 0; j < PL; j++) {
+#pragma HLS UNROLL
+            pat[p][j] = pw.range(503 - 8 * j, 496 - 8 * j);
+        }
+        last[p] = 0;
+        if (plen[p] > 0 && plen[p] <= PL) last[p][plen[p] - 1] = 1;
+    }
+
+    bool is_end = e_str_i.read();
+// start read and match process
+input_stream_loop:
+    while (!is_end) {
+#pragma HLS LOOP_TRIPCOUNT min = 1 max = 64
+#pragma HLS PIPELINE II = 1
+        is_end = e_str_i.read();
+        ap_uint<512> str = str_stream.read();
+        ap_uint<6> len = str.range(509, 504);
+        ap_uint<NP> result;
+
+    pattern_loop:
+        for (int p = 0; p < NP; p++) {
+#pragma HLS UNROLL
+            ap_uint<PL> d = 0;
+            ap_uint<63> hit = 0;
+        char_loop:
+            for (int i = 0; i < 63; i++) {
+#pragma HLS UNROLL
+                ap_uint<8> c = str.range(503 - 8 * i, 496 - 8 * i);
+                ap_uint<PL> b;
+                for (int j = 0; j < PL; j++) {
+#pragma HLS UNROLL
+                    b[j] = (c == pat[p][j]);
+                }
+                d = ((d << 1) | 1) & b;
+                hit[i] = (d & last[p]) != 0;
+            }
+
+            bool m;
+            if (plen[p] == 0) {
+                m = (op[p].range(1, 0) != SM_EQ) || (len == 0);
+            } else {
+                switch (op[p].range(1, 0)) {
+                    case SM_EQ:
+                        m = (len == plen[p]) && hit[plen[p] - 1];
+                        break;
+                    case SM_PREFIX:
+                        m = hit[plen[p] - 1];
+                        break;
+                    case SM_SUFFIX:
+                        m = (len >= plen[p]) && hit[len - 1];
+                        break;
+                    default:
+                        m = (hit & ((ap_uint<64>(1) << (int)len) - 1)) != 0;
+                        break;
+                }
+            }
+            result[p] = (op[p] & SM_NOT) ? !m : m;
+        }
+
+        // write out result
+        out_stream << result;
+        e_str_o << false;
+    }
+
+    // End of transfer
+    e_str_o << true;
+}
+
 } // namespace details
 } // namespace database
 } // namespace xf
@@ -353,6 +468,56 @@ void scanCmpStrCol(ap_uint<512>* ddr_ptr,
     details::str_equal(stream_t2, stream_f2, cnst_stream, out_stream, e_str_o);
 }
 
+/**
+ * @brief      scan multiple columns of string in global memory, and match each
+ *             of them with multiple patterns, as SQL LIKE does
+ *
+ * Each pattern is matched as a whole string, a prefix, a suffix, or anywhere
+ * in the string, see ``StrMatchOp``. The result of all patterns is emitted as
+ * one bitmap per string, and can be fed to ``dynamicFilter`` as a condition
+ * column, so that only valid rows are kept on device. A LIKE with more wildcards
+ * can be narrowed by matching each of its fixed parts with ``SM_CONTAINS``.
+ *
+ * @tparam     NP           number of patterns.
+ * @tparam     PL           max length of pattern, from 1 to 63.
+ *
+ * @param      ddr_ptr      input string array stored in global memory.
+ * @param      size         the number of times reading global memory
+ * @param      num_str      the number of actual strings
+ * @param      pat_stream   input pattern stream, NP patterns of at most PL chars,
+ *                          512 bits in heading-length and padding-zero format,
+ *                          read only once as configuration.
+ * @param      op_stream    input ``StrMatchOp`` of each pattern, read only once
+ *                          as configuration.
+ * @param      out_stream   output bitmap of each string, bit p is set when
+ *                          pattern p matches.
+ * @param      e_str_o      end flag stream for output stream.
+ */
+template <int NP, int PL>
+void scanMatchStrCol(ap_uint<512>* ddr_ptr,
+                     hls::stream<int>& size,
+                     hls::stream<int>& num_str,
+                     hls::stream<ap_uint<512> >& pat_stream,
+                     hls::stream<ap_uint<8> >& op_stream,
+                     hls::stream<ap_uint<NP> >& out_stream,
+                     hls::stream<bool>& e_str_o) {
+    XF_DATABASE_STATIC_ASSERT(NP >= 1, "scanMatchStrCol needs at least one pattern");
+    XF_DATABASE_STATIC_ASSERT(PL >= 1 && PL <= 63, "pattern of scanMatchStrCol holds 1 to 63 chars");
+
+#pragma HLS DATAFLOW
+    hls::stream<ap_uint<512> > stream_t1, stream_t2;
+#pragma HLS STREAM variable = stream_t1 depth = 8 dim = 1
+#pragma HLS STREAM variable = stream_t2 depth = 8 dim = 1
+
+    hls::stream<bool> stream_f1, stream_f2;
+#pragma HLS STREAM variable = stream_f1 depth = 8 dim = 1
+#pragma HLS STREAM variable = stream_f2 depth = 8 dim = 1
+
+    details::read_ddr(ddr_ptr, size, stream_t1, stream_f1);
+    details::padding_stream_out(stream_t1, stream_f1, num_str, stream_t2, stream_f2);
+    details::str_match<NP, PL>(stream_t2, stream_f2, pat_stream, op_stream, out_stream, e_str_o);
+}
+
 } // namespace database
 } // namespace xf
 
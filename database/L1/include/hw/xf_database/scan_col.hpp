@@ -31,6 +31,7 @@
 
 #include <hls_stream.h>
 
+#include "xf_database/enums.hpp"
 #include "xf_database/types.hpp"
 #include "xf_database/utils.hpp"
 
@@ -1185,6 +1186,146 @@ void scanCol(                                         //
 } // namespace database
 } // namespace xf
 
+// ---------------------- scan encoded col ---------------------------------
+
+namespace xf {
+namespace database {
+namespace details {
+template <int burst_len>
+void read_enc_col(                //
+    ap_uint<512>* enc_ptr,        //
+    hls::stream<ap_uint<512> >& enc_strm) {
+    // header goes first, so the decoder knows the encoding
+    ap_uint<512> hd = enc_ptr[0];
+    enc_strm.write(hd);
+    int nread = hd.range(127, 96).to_int();
+
+READ_ENC_COL:
+    for (int i = 0; i < nread; i += burst_len) {
+#pragma HLS dataflow
+        const int len = ((i + burst_len) > nread) ? (nread - i) : burst_len;
+    READ_ENC_VEC:
+        for (int j = 0; j < len; ++j) {
+#pragma HLS pipeline II = 1
+            enc_strm.write(enc_ptr[1 + i + j]);
+        }
+    }
+}
+
+template <int vec_len, int size0>
+void decode_col_vec(                      //
+    hls::stream<ap_uint<512> >& enc_strm, //
+    const int nrow,                       //
+    hls::stream<ap_uint<8 * size0 * vec_len> >& c0vec_strm) {
+    //
+    ap_uint<512> hd = enc_strm.read();
+    const int enc = hd.range(39, 32).to_int();
+    const int bw = hd.range(47, 40).to_int();
+    const ap_int<32> base = hd.range(95, 64);
+    const bool is_rle = (enc == CE_RLE);
+    const int per_word = is_rle ? 8 : 512 / bw;
+    ap_uint<32> mask = 0;
+    for (int b = 0; b < 32; ++b) {
+#pragma HLS unroll
+        mask[b] = (b < bw) ? 1 : 0;
+    }
+
+    ap_uint<512> w = 0;
+    ap_int<32> run_val = 0;
+    int left = 0; // values left in word, or rows left in run
+    int slot = 0; // next run in word
+    ap_uint<8 * size0 * vec_len> vec = 0;
+DECODE_COL_VEC:
+    for (int i = 0; i < nrow; ++i) {
+#pragma HLS pipeline II = 1
+        ap_int<32> v;
+        if (is_rle) {
+            if (left == 0) {
+                if (slot == 0) w = enc_strm.read();
+                run_val = w.range(64 * slot + 31, 64 * slot);
+                left = w.range(64 * slot + 63, 64 * slot + 32).to_int();
+                slot = (slot == per_word - 1) ? 0 : slot + 1;
+            }
+            v = run_val;
+        } else {
+            if (left == 0) {
+                w = enc_strm.read();
+                left = per_word;
+            }
+            ap_uint<32> u = w.range(31, 0);
+            w >>= bw;
+            v = base + (u & mask);
+        }
+        --left;
+        const int j = i % vec_len;
+        ap_int<8 * size0> vx = v;
+        vec.range(8 * size0 * (j + 1) - 1, 8 * size0 * j) = vx;
+        if (j == vec_len - 1 || i == nrow - 1) c0vec_strm.write(vec);
+    }
+}
+
+} // namespace details
+} // namespace database
+} // namespace xf
+
+namespace xf {
+namespace database {
+/**
+ * @brief Scan 1 encoded column from DDR/HBM buffers.
+ *
+ * The column is made of one header word and the encoded words, as written by
+ * the host encoder in ``column_encode_host.hpp``. The header holds the encoding
+ * (``ColEncoding``) in bits 39:32, the bit width of packed values in bits 47:40,
+ * the frame-of-reference base in bits 95:64 and the number of encoded words in
+ * bits 127:96. Values are decoded back to 32-bit signed integers, sign-extended
+ * to size0 bytes, and then emitted as ``scanCol`` does, so that downstream
+ * operators see the same rows as with a plain column.
+ *
+ * This is a single-column primitive. The multi-column ``scanCol`` overloads and
+ * the GQE kernels still read plain columns, so only kernels built around
+ * ``scanEncodedCol`` read fewer words.
+ *
+ * @tparam burst_len burst read length, must be supported by MC.
+ * @tparam vec_len number of items to be emitted as a vector by the decoder.
+ * @tparam size0 size of column 0, in byte, 4 or 8.
+ *
+ * @param enc_ptr buffer pointer to the encoded column.
+ * @param nrow number of row to scan.
+ * @param c0_strm column 0 stream.
+ * @param e_row_strm output end flag stream.
+ */
+template <int burst_len, int vec_len, int size0>
+void scanEncodedCol(                           //
+    ap_uint<512>* enc_ptr,                     //
+    const int nrow,                            //
+    hls::stream<ap_uint<8 * size0> >& c0_strm, //
+    hls::stream<bool>& e_row_strm) {
+//
+#pragma HLS dataflow
+    XF_DATABASE_STATIC_ASSERT(size0 == 4 || size0 == 8, "scanEncodedCol only supports 4 or 8 byte columns");
+    const int fifo_depth = burst_len * 2;
+
+    hls::stream<ap_uint<512> > enc_strm("enc_strm");
+#pragma HLS stream variable = enc_strm depth = fifo_depth
+    hls::stream<ap_uint<8 * size0 * vec_len> > c0vec_strm("c0vec_strm");
+#pragma HLS stream variable = c0vec_strm depth = 2
+
+    details::read_enc_col<burst_len>( //
+        enc_ptr,                      //
+        enc_strm);
+
+    details::decode_col_vec<vec_len, size0>( //
+        enc_strm, nrow,                      //
+        c0vec_strm);
+
+    details::split_col_vec<vec_len, size0>( //
+        c0vec_strm, nrow,                   //
+        c0_strm, e_row_strm);
+}
+
+} // namespace database
+} // namespace xf
+
 // -----------------------------------------------------------------------
 
 #endif // XF_DATABASE_SCAN_COL_H
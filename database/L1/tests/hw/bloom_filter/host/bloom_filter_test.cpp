@@ -0,0 +1,132 @@
+/*
+ * Copyright 2019 Xilinx, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <hls_stream.h>
+#include <iostream>
+#include <stdlib.h>
+#include <vector>
+
+#define INPUT_WIDTH 64
+#define HASH_WIDTH 14
+#define BRAM_MEM_SPACE (1 << (HASH_WIDTH - 4))
+
+#include "xf_database/bloom_filter.hpp"
+#ifndef __SYNTHESIS__
+#include "xf_database/bloom_filter_host.hpp"
+#endif
+
+void syn_bloom_filter_gen_bram(hls::stream<ap_uint<INPUT_WIDTH> >& gen_msg_strm,
+                               hls::stream<bool>& gen_in_e_strm,
+                               hls::stream<ap_uint<INPUT_WIDTH> >& check_msg_strm,
+                               hls::stream<bool>& check_in_e_strm,
+                               hls::stream<bool>& res_msg_strm,
+                               hls::stream<bool>& res_in_e_strm,
+                               ap_uint<16> bit_vector_ptr0[BRAM_MEM_SPACE],
+                               ap_uint<16> bit_vector_ptr1[BRAM_MEM_SPACE],
+                               ap_uint<16> bit_vector_ptr2[BRAM_MEM_SPACE]) {
+    for (int i = 0; i < BRAM_MEM_SPACE; i++) {
+#pragma HLS pipeline II = 1
+        bit_vector_ptr0[i] = 0;
+        bit_vector_ptr1[i] = 0;
+        bit_vector_ptr2[i] = 0;
+    }
+
+    xf::database::bfGen<true, INPUT_WIDTH, HASH_WIDTH>(gen_msg_strm, gen_in_e_strm, bit_vector_ptr0, bit_vector_ptr1,
+                                                       bit_vector_ptr2);
+
+    xf::database::bfCheck<true, INPUT_WIDTH, HASH_WIDTH>(check_msg_strm, check_in_e_strm, bit_vector_ptr0,
+                                                         bit_vector_ptr1, bit_vector_ptr2, res_msg_strm, res_in_e_strm);
+}
+
+#ifndef __SYNTHESIS__
+
+int main(int argc, char* argv[]) {
+    const int ngen = 1000;
+    const int nchk = 10000;
+    int nerr = 0;
+
+    // 32-bit and 64-bit keys hash the same on host and in the primitive
+    for (int i = 0; i < 1000; i++) {
+        uint64_t k = ((uint64_t)rand() << 32) ^ rand();
+        ap_uint<64> h32, h64;
+        xf::database::details::hashlookup3_core<32>(ap_uint<32>(k & 0xffffffff), h32);
+        xf::database::details::hashlookup3_core<64>(ap_uint<64>(k), h64);
+        if ((uint64_t)h32 != xf::database::details::bfHostHash<32>(k & 0xffffffff)) nerr++;
+        if ((uint64_t)h64 != xf::database::details::bfHostHash<64>(k)) nerr++;
+    }
+    if (nerr) std::cout << "ERROR: " << nerr << " host hash values differ from hashLookup3." << std::endl;
+
+    hls::stream<ap_uint<INPUT_WIDTH> > gen_msg_strm;
+    hls::stream<bool> gen_in_e_strm;
+    hls::stream<ap_uint<INPUT_WIDTH> > check_msg_strm;
+    hls::stream<bool> check_in_e_strm;
+    hls::stream<bool> res_msg_strm;
+    hls::stream<bool> res_in_e_strm;
+
+    std::vector<uint64_t> gen_list(ngen), check_list(nchk);
+    for (int i = 0; i < ngen; i++) {
+        gen_list[i] = ((uint64_t)rand() << 20) ^ rand();
+        gen_msg_strm.write(gen_list[i]);
+        gen_in_e_strm.write(0);
+    }
+    gen_in_e_strm.write(1);
+    for (int i = 0; i < nchk; i++) {
+        check_list[i] = (i % 4 == 0) ? gen_list[rand() % ngen] : ((uint64_t)rand() << 20) ^ rand();
+        check_msg_strm.write(check_list[i]);
+        check_in_e_strm.write(0);
+    }
+    check_in_e_strm.write(1);
+
+    ap_uint<16> bv0[BRAM_MEM_SPACE], bv1[BRAM_MEM_SPACE], bv2[BRAM_MEM_SPACE];
+    syn_bloom_filter_gen_bram(gen_msg_strm, gen_in_e_strm, check_msg_strm, check_in_e_strm, res_msg_strm,
+                              res_in_e_strm, bv0, bv1, bv2);
+
+    // the host filter has the same bits as the one built on card
+    std::vector<uint16_t> hbv0(xf::database::bfHostVecSize<HASH_WIDTH>(), 0);
+    std::vector<uint16_t> hbv1(hbv0), hbv2(hbv0);
+    xf::database::bfHostGen<INPUT_WIDTH, HASH_WIDTH>(gen_list.data(), ngen, hbv0.data(), hbv1.data(), hbv2.data());
+    int nbad = 0;
+    for (int i = 0; i < BRAM_MEM_SPACE; i++) {
+        if (bv0[i].to_uint() != hbv0[i] || bv1[i].to_uint() != hbv1[i] || bv2[i].to_uint() != hbv2[i]) nbad++;
+    }
+    if (nbad) std::cout << "ERROR: " << nbad << " words of the host filter differ from bfGen." << std::endl;
+    nerr += nbad;
+
+    // and gives the same answer as bfCheck
+    std::vector<uint8_t> hit(nchk);
+    xf::database::bfHostCheck<INPUT_WIDTH, HASH_WIDTH>(check_list.data(), nchk, hbv0.data(), hbv1.data(), hbv2.data(),
+                                                       hit.data());
+    int cnt = 0, npass = 0;
+    nbad = 0;
+    while (!res_in_e_strm.read()) {
+        bool res = res_msg_strm.read();
+        if (cnt < nchk && res != (bool)hit[cnt]) nbad++;
+        npass += res;
+        cnt++;
+    }
+    if (cnt != nchk) nbad++;
+    if (nbad) std::cout << "ERROR: " << nbad << " host checks differ from bfCheck." << std::endl;
+    nerr += nbad;
+    std::cout << npass << " of " << nchk << " keys passed the filter." << std::endl;
+
+    if (nerr)
+        std::cout << "FAIL: ";
+    else
+        std::cout << "PASS: ";
+    std::cout << "Bloom filter host testcase." << std::endl;
+    return nerr;
+}
+
+#endif
@@ -20,6 +20,7 @@
 #include <stdlib.h>
 #include <stdint.h>
 #include <algorithm>
+#include <string.h>
 
 #include "hls_stream.h"
 
@@ -101,6 +102,22 @@ void generate_data(
     scan(t_unit, num_t, o_t_key_strm, o_t_pld_strm, o_e1_strm);
 }
 
+//-------------------------generate probe data----------------------------
+// refill t-table only, with keys drawn from the same range as generate_data
+void generate_probe_data(ap_uint<(WKEY + WPAY) * VEC_LEN> t_unit[T_MAX_DEPTH], int num_s, int num_t) {
+    for (int i = 0; i < num_t; i++) {
+        for (int j = 0; j < VEC_LEN; j++) {
+            ap_uint<WKEY> t_key;
+            t_key = rand() % (int(num_s / 10 / (1 - ANTI_RATE)));
+            ap_uint<WPAY> t_pld = rand();
+
+            ap_uint<WKEY + WPAY> trow = (t_key, t_pld);
+
+            t_unit[i]((j + 1) * (WKEY + WPAY) - 1, j * (WKEY + WPAY)) = trow;
+        }
+    }
+}
+
 //-------------------------generate golden data-----------------------------
 template <int test_num>
 void hash_join_golden(xf::database::enums::JoinType join_flag,
@@ -186,7 +203,7 @@ int check_data(xf::database::enums::JoinType join_type,
                hls::stream<bool>& o_e_strm,
 
                ap_uint<512> j_res[J_MAX_DEPTH]) {
-    int nerror;
+    int nerror = 0;
     int error;
     ap_uint<512> j_temp;
     int datacount = 0;
@@ -213,7 +230,82 @@ int check_data(xf::database::enums::JoinType join_type,
 
         if (error) std::cout << std::hex << "Unit Not Found: " << j_temp << std::endl;
     }
-    return error;
+    return nerror;
+}
+
+//------------------------------staged build/probe-------------------------------
+static void call_kernel(xf::database::enums::JoinType join_type,
+                        xf::database::enums::JoinStage stage,
+                        int nrow_s,
+                        ap_uint<(WKEY + WPAY) * VEC_LEN>* s_unit,
+                        int nrow_t,
+                        ap_uint<(WKEY + WPAY) * VEC_LEN>* t_unit,
+                        ap_uint<64>* pu_ht[NPU],
+                        ap_uint<64>* pu_s[NPU],
+                        ap_uint<32> hj_end_status[BUILD_CFG_DEPTH],
+                        ap_uint<512>* j_res) {
+    ap_uint<32> hj_begin_status[BUILD_CFG_DEPTH];
+    hj_begin_status[0] = 4;     // depth
+    hj_begin_status[1] = stage; // join stage
+
+    memset(j_res, 0, J_MAX_DEPTH * sizeof(ap_uint<512>));
+
+    mjkernel((uint32_t)join_type, nrow_s, s_unit, nrow_t, t_unit, pu_ht[0], pu_ht[1], pu_ht[2], pu_ht[3], pu_ht[4],
+             pu_ht[5], pu_ht[6], pu_ht[7], pu_s[0], pu_s[1], pu_s[2], pu_s[3], pu_s[4], pu_s[5], pu_s[6], pu_s[7],
+             hj_begin_status, hj_end_status, j_res);
+}
+
+// build the hash table of s_unit once with JS_BUILD, then probe two different
+// t-tables against it with JS_PROBE and an empty s-table.
+template <int test_num>
+int check_build_once_probe_twice(ap_uint<(WKEY + WPAY) * VEC_LEN>* s_unit,
+                                 int nrow_s,
+                                 ap_uint<(WKEY + WPAY) * VEC_LEN>* t_unit,
+                                 int nrow_t,
+                                 ap_uint<64>* pu_ht[NPU],
+                                 ap_uint<64>* pu_s[NPU],
+                                 ap_uint<512>* j_res) {
+    xf::database::enums::JoinType join_type = xf::database::enums::JT_INNER;
+    ap_uint<32> hj_end_status[BUILD_CFG_DEPTH];
+    int nerror = 0;
+
+    std::cout << "------------------------build only--------------------------" << std::endl;
+    call_kernel(join_type, xf::database::enums::JS_BUILD, nrow_s, s_unit, 0, t_unit, pu_ht, pu_s, hj_end_status,
+                j_res);
+    if (hj_end_status[1] != 0) {
+        std::cout << "JS_BUILD returned " << hj_end_status[1] << " rows" << std::endl;
+        nerror++;
+    }
+
+    for (int p = 0; p < 2; p++) {
+        generate_probe_data(t_unit, nrow_s, nrow_t);
+
+        std::cout << "------------------------probe " << p << "--------------------------" << std::endl;
+        call_kernel(join_type, xf::database::enums::JS_PROBE, 0, s_unit, nrow_t, t_unit, pu_ht, pu_s, hj_end_status,
+                    j_res);
+
+        hls::stream<ap_uint<WKEY> > s_key_strm;
+        hls::stream<ap_uint<WPAY> > s_pld_strm;
+        hls::stream<bool> s_e_strm;
+        hls::stream<ap_uint<WKEY> > t_key_strm;
+        hls::stream<ap_uint<WPAY> > t_pld_strm;
+        hls::stream<bool> t_e_strm;
+        scan(s_unit, nrow_s, s_key_strm, s_pld_strm, s_e_strm);
+        scan(t_unit, nrow_t, t_key_strm, t_pld_strm, t_e_strm);
+
+        hls::stream<ap_uint<WKEY + 2 * WPAY> > j_strm;
+        hls::stream<bool> j_e_strm;
+        hash_join_golden<test_num>(join_type, s_key_strm, s_pld_strm, s_e_strm, t_key_strm, t_pld_strm, t_e_strm,
+                                   j_strm, j_e_strm);
+
+        unsigned golden_num = j_strm.size();
+        if (hj_end_status[1] != golden_num) {
+            std::cout << "probe " << p << ": " << hj_end_status[1] << " rows, expect " << golden_num << std::endl;
+            nerror++;
+        }
+        nerror += check_data<test_num>(join_type, j_strm, j_e_strm, j_res);
+    }
+    return nerror;
 }
 
 int main() {
@@ -302,6 +394,9 @@ int main() {
     int nerror;
     nerror = check_data<nrow_s>(join_type, j_strm, j_e_strm, j_res0);
 
+    // build once, probe twice
+    nerror += check_build_once_probe_twice<nrow_s>(s_unit, nrow_s, t_unit, nrow_t, pu_ht, pu_s, j_res0);
+
     for (int i = 0; i < PU_NM; i++) {
         free(pu_ht[i]);
         free(pu_s[i]);
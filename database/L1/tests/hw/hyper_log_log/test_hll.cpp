@@ -0,0 +1,131 @@
+/*
+ * Copyright 2019 Xilinx, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#include "xf_database/hyper_log_log.hpp"
+#ifndef __SYNTHESIS__
+#include "xf_database/hyper_log_log_host.hpp"
+#endif
+
+#define KEY_W 64
+#define GRP_W 2
+#define HLL_P 12
+
+#define NGRP (1 << GRP_W)
+#define NREG (1 << HLL_P)
+
+void hll_W64_G2_P12(hls::stream<ap_uint<KEY_W> >& key_strm,
+                    hls::stream<ap_uint<GRP_W> >& grp_strm,
+                    hls::stream<bool>& in_e_strm,
+                    hls::stream<ap_uint<64> >& sketch_strm,
+                    hls::stream<bool>& out_e_strm) {
+    xf::database::hyperLogLog<KEY_W, GRP_W, HLL_P>(key_strm, grp_strm, in_e_strm, sketch_strm, out_e_strm);
+}
+
+#ifndef __SYNTHESIS__
+
+struct Row {
+    uint64_t key;
+    int grp;
+};
+
+// runs the primitive over rows [begin, end) and unpacks the sketches of all groups
+void run_hll(const std::vector<Row>& rows, size_t begin, size_t end, std::vector<uint8_t>& sketch) {
+    hls::stream<ap_uint<KEY_W> > key_strm("key_strm");
+    hls::stream<ap_uint<GRP_W> > grp_strm("grp_strm");
+    hls::stream<bool> in_e_strm("in_e_strm");
+    hls::stream<ap_uint<64> > sketch_strm("sketch_strm");
+    hls::stream<bool> out_e_strm("out_e_strm");
+
+    for (size_t i = begin; i < end; ++i) {
+        key_strm.write(rows[i].key);
+        grp_strm.write(rows[i].grp);
+        in_e_strm.write(false);
+    }
+    in_e_strm.write(true);
+
+    hll_W64_G2_P12(key_strm, grp_strm, in_e_strm, sketch_strm, out_e_strm);
+
+    sketch.assign(NGRP * NREG, 0);
+    size_t n = 0;
+    while (!out_e_strm.read()) {
+        ap_uint<64> w = sketch_strm.read();
+        for (int j = 0; j < 8; ++j) sketch[n++] = w.range(8 * j + 7, 8 * j);
+    }
+    if (n != sketch.size()) std::cout << "ERROR: " << n << " registers emitted, " << sketch.size() << " expected.\n";
+}
+
+int main() {
+    // distinct keys of each group, the last group stays empty
+    const int ndistinct[NGRP] = {1000, 20000, 100000, 0};
+
+    std::vector<Row> rows;
+    srand(11);
+    for (int g = 0; g < NGRP; ++g) {
+        for (int k = 0; k < ndistinct[g]; ++k) {
+            uint64_t key = ((uint64_t)(g + 1) << 40) + (uint64_t)k * 2654435761ULL;
+            // every key shows up one to three times
+            int dup = 1 + rand() % 3;
+            for (int d = 0; d < dup; ++d) rows.push_back(Row{key, g});
+        }
+    }
+    for (size_t i = rows.size() - 1; i > 0; --i) {
+        size_t j = (size_t)rand() % (i + 1);
+        Row t = rows[i];
+        rows[i] = rows[j];
+        rows[j] = t;
+    }
+    std::cout << rows.size() << " rows generated.\n";
+
+    int nerror = 0;
+
+    std::vector<uint8_t> full, part0, part1;
+    run_hll(rows, 0, rows.size(), full);
+    run_hll(rows, 0, rows.size() / 2, part0);
+    run_hll(rows, rows.size() / 2, rows.size(), part1);
+
+    // allow four times the standard error
+    const double tol = 4 * 1.04 / std::sqrt((double)NREG);
+    for (int g = 0; g < NGRP; ++g) {
+        xf::database::hllMerge(&part0[g * NREG], &part1[g * NREG], HLL_P);
+        if (memcmp(&part0[g * NREG], &full[g * NREG], NREG)) {
+            std::cout << "ERROR: merged sketch of group " << g << " differs from the single pass.\n";
+            ++nerror;
+        }
+
+        double est = xf::database::hllEstimate(&full[g * NREG], HLL_P);
+        double err = ndistinct[g] ? std::fabs(est - ndistinct[g]) / ndistinct[g] : est;
+        std::cout << "group " << g << ": " << ndistinct[g] << " distinct, estimated " << est << "\n";
+        if (err > tol) {
+            std::cout << "ERROR: estimate of group " << g << " is off by " << err << ".\n";
+            ++nerror;
+        }
+    }
+
+    if (nerror) {
+        std::cout << "\nFAIL: " << nerror << " errors found.\n";
+    } else {
+        std::cout << "\nPASS: no error found.\n";
+    }
+    return nerror;
+}
+
+#endif
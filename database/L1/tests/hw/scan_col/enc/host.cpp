@@ -0,0 +1,91 @@
+/*
+ * Copyright 2019 Xilinx, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "kernel.hpp"
+
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#include "xf_database/column_encode_host.hpp"
+#include "xhostutils.hpp"
+
+// encodes the column, scans it back and compares every row
+int check_col(const char* name, const std::vector<int32_t>& col, xf::database::ColEncoding enc) {
+    std::vector<ap_uint<512> > words;
+    if (xf::database::encodeCol(col.data(), col.size(), enc, words)) {
+        std::cout << "ERROR: " << name << " cannot be encoded as " << enc << "\n";
+        return 1;
+    }
+    if (words.size() > BUF_DEPTH) {
+        std::cout << "ERROR: " << name << " takes " << words.size() << " words, more than the buffer.\n";
+        return 1;
+    }
+    ap_uint<512>* buf0 = aligned_alloc<ap_uint<512> >(BUF_DEPTH);
+    ap_uint<32>* bufo = aligned_alloc<ap_uint<32> >(NROW_MAX);
+    for (size_t i = 0; i < words.size(); ++i) buf0[i] = words[i];
+
+    int nrow = col.size();
+    Test(buf0, nrow, bufo);
+
+    int nerror = 0;
+    for (int i = 0; i < nrow; ++i) {
+        if ((int32_t)bufo[i].to_uint() != col[i]) {
+            if (nerror < 8)
+                std::cout << "ERROR: row " << i << " is " << (int32_t)bufo[i].to_uint() << ", expected " << col[i]
+                          << "\n";
+            ++nerror;
+        }
+    }
+    std::cout << name << ": encoding " << enc << ", " << words.size() << " words for " << nrow << " rows, "
+              << (double)((nrow + 15) / 16) / words.size() << "x smaller, " << nerror << " errors\n";
+    free(buf0);
+    free(bufo);
+    return nerror ? 1 : 0;
+}
+
+int main(int argc, const char* argv[]) {
+    const int nrow = 50000;
+    std::vector<int32_t> flag(nrow), qty(nrow), date(nrow), discount(nrow), price(nrow);
+    srand(3);
+    for (int i = 0; i < nrow; ++i) {
+        flag[i] = "ANR"[i * 3 / nrow];
+        qty[i] = 1 + rand() % 50;
+        date[i] = 8035 + rand() % 2526;
+        discount[i] = -10 + rand() % 21;
+        price[i] = rand() - RAND_MAX / 2;
+    }
+
+    int nerror = 0;
+    nerror += check_col("returnflag", flag, xf::database::pickColEncoding(flag.data(), nrow));
+    nerror += check_col("quantity", qty, xf::database::pickColEncoding(qty.data(), nrow));
+    nerror += check_col("shipdate", date, xf::database::pickColEncoding(date.data(), nrow));
+    nerror += check_col("discount", discount, xf::database::pickColEncoding(discount.data(), nrow));
+    nerror += check_col("price", price, xf::database::pickColEncoding(price.data(), nrow));
+    // every encoding on the same column, including a short one
+    for (int e = xf::database::CE_PLAIN; e <= xf::database::CE_RLE; ++e) {
+        nerror += check_col("returnflag", flag, (xf::database::ColEncoding)e);
+        std::vector<int32_t> few(qty.begin(), qty.begin() + 37);
+        nerror += check_col("few", few, (xf::database::ColEncoding)e);
+    }
+    nerror += (xf::database::encodedColSize(price.data(), nrow, xf::database::CE_BITPACK) != 0);
+
+    if (nerror) {
+        std::cout << "FAIL: " << nerror << " case(s) failed.\n";
+        return 1;
+    }
+    std::cout << "PASS" << std::endl;
+    return 0;
+}
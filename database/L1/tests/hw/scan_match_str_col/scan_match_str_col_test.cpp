@@ -0,0 +1,168 @@
+/*
+ * Copyright 2019 Xilinx, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdlib.h>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "xf_database/scan_cmp_str_col.hpp"
+
+#define NUM_PAT 5
+#define PAT_LEN 16
+#define STR_NUM 512
+#define COL_NUM 1024
+#define MAX_LEN 63
+
+// top-function
+void dut(ap_uint<512>* ddr_ptr,
+         hls::stream<int>& size,
+         hls::stream<int>& num_str,
+         hls::stream<ap_uint<512> >& pat_stream,
+         hls::stream<ap_uint<8> >& op_stream,
+         hls::stream<ap_uint<NUM_PAT> >& out_stream,
+         hls::stream<bool>& e_str_o) {
+#pragma HLS INTERFACE s_axilite port = ddr_ptr
+#pragma HLS INTERFACE m_axi depth = 1024 port = ddr_ptr
+    xf::database::scanMatchStrCol<NUM_PAT, PAT_LEN>(ddr_ptr, size, num_str, //
+                                                    pat_stream, op_stream, out_stream, e_str_o);
+}
+
+#ifndef __SYNTHESIS__
+
+// golden reference of one pattern
+bool ref_match(const std::string& s, const std::string& pat, int op) {
+    bool m;
+    switch (op & 3) {
+        case xf::database::SM_EQ:
+            m = (s == pat);
+            break;
+        case xf::database::SM_PREFIX:
+            m = s.compare(0, pat.size(), pat) == 0 && s.size() >= pat.size();
+            break;
+        case xf::database::SM_SUFFIX:
+            m = s.size() >= pat.size() && s.compare(s.size() - pat.size(), pat.size(), pat) == 0;
+            break;
+        default:
+            m = s.find(pat) != std::string::npos;
+            break;
+    }
+    return (op & xf::database::SM_NOT) ? !m : m;
+}
+
+// string in heading-length and padding-zero format
+ap_uint<512> pad_str(const std::string& s) {
+    ap_uint<512> w = 0;
+    w.range(511, 504) = s.size();
+    for (size_t j = 0; j < s.size(); j++) w.range(503 - 8 * j, 496 - 8 * j) = (unsigned char)s[j];
+    return w;
+}
+
+// strings in semi-pact format, each takes length and chars aligned to 8 bytes
+int pack_str(const std::vector<std::string>& strs, ap_uint<512>* ddr_mem) {
+    std::vector<unsigned char> bytes;
+    for (size_t i = 0; i < strs.size(); i++) {
+        bytes.push_back(strs[i].size());
+        for (size_t j = 0; j < strs[i].size(); j++) bytes.push_back(strs[i][j]);
+        while (bytes.size() % 8) bytes.push_back(0);
+    }
+    int nword = (bytes.size() + 63) / 64;
+    for (int i = 0; i < nword; i++) ddr_mem[i] = 0;
+    for (size_t k = 0; k < bytes.size(); k++) {
+        int b = 63 - k % 64;
+        ddr_mem[k / 64].range(8 * b + 7, 8 * b) = bytes[k];
+    }
+    return nword;
+}
+
+int main() {
+    int nerror = 0;
+
+    const char* words[] = {"PROMO", "STANDARD", "ECONOMY", "MEDIUM",   "POLISHED", "BRUSHED", "BRASS", "TIN",
+                           "green", "forest",   "special", "requests", "almond",   "ivory",   "",      "LARGE"};
+    const int nwords = sizeof(words) / sizeof(words[0]);
+
+    const std::string pats[NUM_PAT] = {"PROMO", "green", "BRASS", "MEDIUM POLISHED", "TIN"};
+    const int ops[NUM_PAT] = {xf::database::SM_PREFIX, xf::database::SM_CONTAINS, xf::database::SM_SUFFIX,
+                              xf::database::SM_PREFIX | xf::database::SM_NOT, xf::database::SM_EQ};
+
+    // random phrases of words, from empty to the longest string
+    std::vector<std::string> strs;
+    srand(7);
+    for (int i = 0; i < STR_NUM; i++) {
+        std::string s;
+        int n = rand() % 5;
+        for (int k = 0; k < n; k++) {
+            if (k) s += ' ';
+            s += words[rand() % nwords];
+        }
+        if (i % 61 == 3) s = "MEDIUM POLISHED " + s;
+        if (i % 97 == 5) s = std::string(MAX_LEN - 5, 'x') + "green";
+        if (s.size() > MAX_LEN) s.resize(MAX_LEN);
+        strs.push_back(s);
+    }
+
+    ap_uint<512>* ddr_content = new ap_uint<512>[COL_NUM];
+    int real_col = pack_str(strs, ddr_content);
+    std::cout << "Number of column:" << real_col << std::endl;
+
+    hls::stream<int> size, num_str;
+    hls::stream<ap_uint<512> > pat_stream("pat_stream");
+    hls::stream<ap_uint<8> > op_stream("op_stream");
+    hls::stream<ap_uint<NUM_PAT> > out_stream("out_stream");
+    hls::stream<bool> e_str_o("e_str_o");
+    size.write(real_col);
+    num_str.write(STR_NUM);
+    for (int p = 0; p < NUM_PAT; p++) {
+        pat_stream.write(pad_str(pats[p]));
+        op_stream.write(ops[p]);
+    }
+
+    dut(ddr_content, size, num_str, pat_stream, op_stream, out_stream, e_str_o);
+
+    int n = 0;
+    int nmatch[NUM_PAT] = {0};
+    while (!e_str_o.read()) {
+        ap_uint<NUM_PAT> r = out_stream.read();
+        for (int p = 0; p < NUM_PAT && n < STR_NUM; p++) {
+            bool ref = ref_match(strs[n], pats[p], ops[p]);
+            if (r[p]) nmatch[p]++;
+            if (r[p] != ref) {
+                if (nerror < 10)
+                    std::cout << "ERROR: string " << n << " \"" << strs[n] << "\" pattern " << p << " got " << r[p]
+                              << std::endl;
+                nerror++;
+            }
+        }
+        n++;
+    }
+    if (n != STR_NUM) {
+        std::cout << "ERROR: " << n << " results emitted, " << STR_NUM << " expected." << std::endl;
+        nerror++;
+    }
+    for (int p = 0; p < NUM_PAT; p++) std::cout << "Pattern \"" << pats[p] << "\": " << nmatch[p] << " matches\n";
+
+    delete[] ddr_content;
+
+    if (nerror) {
+        std::cout << "\nFAIL: " << nerror << " errors found.\n";
+    } else {
+        std::cout << "\nPASS: no error found.\n";
+    }
+    return nerror;
+}
+
+#endif
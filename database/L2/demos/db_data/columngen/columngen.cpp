@@ -15,12 +15,14 @@
  */
 #include "tpch_read_2.hpp"
 #include "utils.hpp"
+#include "col_file.hpp"
 
 #include <cstdio>
 #include <fstream>
 // C++11 thread
 #include <thread>
 #include <cstring>
+#include <array>
 
 // ------------------------------------------------------------
 
@@ -247,6 +249,23 @@ int write_to_file(const std::string& fn, const std::vector<std::array<char, N> >
     return n;
 }
 
+template <typename T>
+int write_to_col(const std::string& fn, const std::vector<T>& d) {
+    return write_col_file(fn, d.data(), d.size(), sizeof(T));
+}
+
+template <int N>
+int write_to_col(const std::string& fn, const std::vector<std::array<char, N> >& d) {
+    // std::array<char, N> is packed, so the rows are already contiguous
+    return write_col_file(fn, d.data(), d.size(), N);
+}
+
+template <typename V>
+void write_column(const std::string& out_dir, const std::string& name, const V& d, bool dat, bool col) {
+    if (dat) write_to_file(out_dir + "/" + name + ".dat", d);
+    if (col) write_to_col(out_dir + "/" + name + ".col", d);
+}
+
 int main(int argc, const char* argv[]) {
     // cmd arg parser.
     ArgParser parser(argc, argv);
@@ -310,6 +329,16 @@ int main(int argc, const char* argv[]) {
         ++err;
     }
 
+    // dat: raw rows for load_dat, col: mmap-able column files for Table::mapHost
+    std::string fmt = "dat";
+    parser.getCmdOption("-fmt", fmt);
+    bool out_dat = (fmt == "dat" || fmt == "both");
+    bool out_col = (fmt == "col" || fmt == "both");
+    if (!out_dat && !out_col) {
+        printf("ERROR: \"%s\" is not a format, use dat, col or both!\n", fmt.c_str());
+        ++err;
+    }
+
     if (err) return err;
 
     // set up input data and buffers
@@ -488,76 +517,107 @@ int main(int argc, const char* argv[]) {
     printf("Time to columnize tables: %d usec.\n", usec);
 
     // ************************************************************
-    // done and write data to file.
-
-    write_to_file(out_dir + "/r_regionkey.dat", col_r_regionkey);
-    write_to_file(out_dir + "/r_name.dat", col_r_name);
-    write_to_file(out_dir + "/r_comment.dat", col_r_comment);
-
-    write_to_file(out_dir + "/n_nationkey.dat", col_n_nationkey);
-    write_to_file(out_dir + "/n_regionkey.dat", col_n_regionkey);
-    write_to_file(out_dir + "/n_name.dat", col_n_name);
-    write_to_file(out_dir + "/n_comment.dat", col_n_comment);
-
-    write_to_file(out_dir + "/c_custkey.dat", col_c_custkey);
-    write_to_file(out_dir + "/c_name.dat", col_c_name);
-    write_to_file(out_dir + "/c_address.dat", col_c_address);
-    write_to_file(out_dir + "/c_nationkey.dat", col_c_nationkey);
-    write_to_file(out_dir + "/c_phone.dat", col_c_phone);
-    write_to_file(out_dir + "/c_acctbal.dat", col_c_acctbal);
-    write_to_file(out_dir + "/c_mktsegment.dat", col_c_mktsegment);
-    write_to_file(out_dir + "/c_commet.dat", col_c_comment);
-
-    write_to_file(out_dir + "/o_orderkey.dat", col_o_orderkey);
-    write_to_file(out_dir + "/o_custkey.dat", col_o_custkey);
-    write_to_file(out_dir + "/o_orderstatus.dat", col_o_orderstatus);
-    write_to_file(out_dir + "/o_totalprice.dat", col_o_totalprice);
-    write_to_file(out_dir + "/o_orderdate.dat", col_o_orderdate);
-    write_to_file(out_dir + "/o_orderpriority.dat", col_o_orderpriority);
-    write_to_file(out_dir + "/o_clerk.dat", col_o_clerk);
-    write_to_file(out_dir + "/o_shippriority.dat", col_o_shippriority);
-    write_to_file(out_dir + "/o_comment.dat", col_o_comment);
-
-    write_to_file(out_dir + "/l_orderkey.dat", col_l_orderkey);
-    write_to_file(out_dir + "/l_partkey.dat", col_l_partkey);
-    write_to_file(out_dir + "/l_suppkey.dat", col_l_suppkey);
-    write_to_file(out_dir + "/l_linenumber.dat", col_l_linenumber);
-    write_to_file(out_dir + "/l_quantity.dat", col_l_quantity);
-    write_to_file(out_dir + "/l_extendedprice.dat", col_l_extendedprice);
-    write_to_file(out_dir + "/l_discount.dat", col_l_discount);
-    write_to_file(out_dir + "/l_tax.dat", col_l_tax);
-    write_to_file(out_dir + "/l_returnflag.dat", col_l_returnflag);
-    write_to_file(out_dir + "/l_linestatus.dat", col_l_linestatus);
-    write_to_file(out_dir + "/l_shipdate.dat", col_l_shipdate);
-    write_to_file(out_dir + "/l_commitdate.dat", col_l_commitdate);
-    write_to_file(out_dir + "/l_receiptdate.dat", col_l_receiptdate);
-    write_to_file(out_dir + "/l_shipinstruct.dat", col_l_shipinstruct);
-    write_to_file(out_dir + "/l_shipmode.dat", col_l_shipmode);
-    write_to_file(out_dir + "/l_comment.dat", col_l_comment);
-
-    write_to_file(out_dir + "/s_suppkey.dat", col_s_suppkey);
-    write_to_file(out_dir + "/s_name.dat", col_s_name);
-    write_to_file(out_dir + "/s_address.dat", col_s_address);
-    write_to_file(out_dir + "/s_nationkey.dat", col_s_nationkey);
-    write_to_file(out_dir + "/s_phone.dat", col_s_phone);
-    write_to_file(out_dir + "/s_acctbal.dat", col_s_acctbal);
-    write_to_file(out_dir + "/s_comment.dat", col_s_comment);
-
-    write_to_file(out_dir + "/p_partkey.dat", col_p_partkey);
-    write_to_file(out_dir + "/p_name.dat", col_p_name);
-    write_to_file(out_dir + "/p_mfgr.dat", col_p_mfgr);
-    write_to_file(out_dir + "/p_brand.dat", col_p_brand);
-    write_to_file(out_dir + "/p_type.dat", col_p_type);
-    write_to_file(out_dir + "/p_size.dat", col_p_size);
-    write_to_file(out_dir + "/p_container.dat", col_p_container);
-    write_to_file(out_dir + "/p_retailprice.dat", col_p_retailprice);
-    write_to_file(out_dir + "/p_comment.dat", col_p_comment);
-
-    write_to_file(out_dir + "/ps_partkey.dat", col_ps_partkey);
-    write_to_file(out_dir + "/ps_suppkey.dat", col_ps_suppkey);
-    write_to_file(out_dir + "/ps_availqty.dat", col_ps_availqty);
-    write_to_file(out_dir + "/ps_supplycost.dat", col_ps_supplycost);
-    write_to_file(out_dir + "/ps_comment.dat", col_ps_comment);
+    // done and write data to file, one thread per table.
+
+    gettimeofday(&tv0, 0);
+
+    r_thread = std::thread([&] {
+        write_column(out_dir, "r_regionkey", col_r_regionkey, out_dat, out_col);
+        write_column(out_dir, "r_name", col_r_name, out_dat, out_col);
+        write_column(out_dir, "r_comment", col_r_comment, out_dat, out_col);
+    });
+
+    n_thread = std::thread([&] {
+        write_column(out_dir, "n_nationkey", col_n_nationkey, out_dat, out_col);
+        write_column(out_dir, "n_regionkey", col_n_regionkey, out_dat, out_col);
+        write_column(out_dir, "n_name", col_n_name, out_dat, out_col);
+        write_column(out_dir, "n_comment", col_n_comment, out_dat, out_col);
+    });
+
+    c_thread = std::thread([&] {
+        write_column(out_dir, "c_custkey", col_c_custkey, out_dat, out_col);
+        write_column(out_dir, "c_name", col_c_name, out_dat, out_col);
+        write_column(out_dir, "c_address", col_c_address, out_dat, out_col);
+        write_column(out_dir, "c_nationkey", col_c_nationkey, out_dat, out_col);
+        write_column(out_dir, "c_phone", col_c_phone, out_dat, out_col);
+        write_column(out_dir, "c_acctbal", col_c_acctbal, out_dat, out_col);
+        write_column(out_dir, "c_mktsegment", col_c_mktsegment, out_dat, out_col);
+        write_column(out_dir, "c_commet", col_c_comment, out_dat, out_col);
+    });
+
+    o_thread = std::thread([&] {
+        write_column(out_dir, "o_orderkey", col_o_orderkey, out_dat, out_col);
+        write_column(out_dir, "o_custkey", col_o_custkey, out_dat, out_col);
+        write_column(out_dir, "o_orderstatus", col_o_orderstatus, out_dat, out_col);
+        write_column(out_dir, "o_totalprice", col_o_totalprice, out_dat, out_col);
+        write_column(out_dir, "o_orderdate", col_o_orderdate, out_dat, out_col);
+        write_column(out_dir, "o_orderpriority", col_o_orderpriority, out_dat, out_col);
+        write_column(out_dir, "o_clerk", col_o_clerk, out_dat, out_col);
+        write_column(out_dir, "o_shippriority", col_o_shippriority, out_dat, out_col);
+        write_column(out_dir, "o_comment", col_o_comment, out_dat, out_col);
+    });
+
+    l_thread = std::thread([&] {
+        write_column(out_dir, "l_orderkey", col_l_orderkey, out_dat, out_col);
+        write_column(out_dir, "l_partkey", col_l_partkey, out_dat, out_col);
+        write_column(out_dir, "l_suppkey", col_l_suppkey, out_dat, out_col);
+        write_column(out_dir, "l_linenumber", col_l_linenumber, out_dat, out_col);
+        write_column(out_dir, "l_quantity", col_l_quantity, out_dat, out_col);
+        write_column(out_dir, "l_extendedprice", col_l_extendedprice, out_dat, out_col);
+        write_column(out_dir, "l_discount", col_l_discount, out_dat, out_col);
+        write_column(out_dir, "l_tax", col_l_tax, out_dat, out_col);
+        write_column(out_dir, "l_returnflag", col_l_returnflag, out_dat, out_col);
+        write_column(out_dir, "l_linestatus", col_l_linestatus, out_dat, out_col);
+        write_column(out_dir, "l_shipdate", col_l_shipdate, out_dat, out_col);
+        write_column(out_dir, "l_commitdate", col_l_commitdate, out_dat, out_col);
+        write_column(out_dir, "l_receiptdate", col_l_receiptdate, out_dat, out_col);
+        write_column(out_dir, "l_shipinstruct", col_l_shipinstruct, out_dat, out_col);
+        write_column(out_dir, "l_shipmode", col_l_shipmode, out_dat, out_col);
+        write_column(out_dir, "l_comment", col_l_comment, out_dat, out_col);
+    });
+
+    s_thread = std::thread([&] {
+        write_column(out_dir, "s_suppkey", col_s_suppkey, out_dat, out_col);
+        write_column(out_dir, "s_name", col_s_name, out_dat, out_col);
+        write_column(out_dir, "s_address", col_s_address, out_dat, out_col);
+        write_column(out_dir, "s_nationkey", col_s_nationkey, out_dat, out_col);
+        write_column(out_dir, "s_phone", col_s_phone, out_dat, out_col);
+        write_column(out_dir, "s_acctbal", col_s_acctbal, out_dat, out_col);
+        write_column(out_dir, "s_comment", col_s_comment, out_dat, out_col);
+    });
+
+    p_thread = std::thread([&] {
+        write_column(out_dir, "p_partkey", col_p_partkey, out_dat, out_col);
+        write_column(out_dir, "p_name", col_p_name, out_dat, out_col);
+        write_column(out_dir, "p_mfgr", col_p_mfgr, out_dat, out_col);
+        write_column(out_dir, "p_brand", col_p_brand, out_dat, out_col);
+        write_column(out_dir, "p_type", col_p_type, out_dat, out_col);
+        write_column(out_dir, "p_size", col_p_size, out_dat, out_col);
+        write_column(out_dir, "p_container", col_p_container, out_dat, out_col);
+        write_column(out_dir, "p_retailprice", col_p_retailprice, out_dat, out_col);
+        write_column(out_dir, "p_comment", col_p_comment, out_dat, out_col);
+    });
+
+    ps_thread = std::thread([&] {
+        write_column(out_dir, "ps_partkey", col_ps_partkey, out_dat, out_col);
+        write_column(out_dir, "ps_suppkey", col_ps_suppkey, out_dat, out_col);
+        write_column(out_dir, "ps_availqty", col_ps_availqty, out_dat, out_col);
+        write_column(out_dir, "ps_supplycost", col_ps_supplycost, out_dat, out_col);
+        write_column(out_dir, "ps_comment", col_ps_comment, out_dat, out_col);
+    });
+
+    r_thread.join();
+    n_thread.join();
+    c_thread.join();
+    o_thread.join();
+    l_thread.join();
+    s_thread.join();
+    p_thread.join();
+    ps_thread.join();
+
+    gettimeofday(&tv1, 0);
+    usec = tvdiff(&tv0, &tv1);
+    printf("Time to write columns: %d usec.\n", usec);
 
     return 0;
 }
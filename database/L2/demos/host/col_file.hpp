@@ -0,0 +1,98 @@
+/*
+ * Copyright 2019 Xilinx, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef COL_FILE_H
+#define COL_FILE_H
+
+// A .col file holds one column in the layout Table keeps in host memory, so
+// that it can be mmap'ed in place instead of parsed:
+//
+//   page 0       col_file_header_t, zero padded to COL_FILE_PAGE bytes
+//   page 1..     one 512-bit word with the row count in bits 31:0,
+//                then nrow * width bytes of rows, zero padded to whole pages
+
+#include <stdint.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <unistd.h>
+
+#define COL_FILE_MAGIC "XFDBCOL"
+#define COL_FILE_VERSION 1
+#define COL_FILE_PAGE 4096
+
+struct col_file_header_t {
+    char magic[8];
+    uint32_t version;
+    uint32_t width;  // bytes per row
+    uint64_t nrow;   // rows stored
+    uint64_t nblock; // 512-bit words after the header page
+};
+
+// number of 512-bit words of the column payload, rounded up to whole pages
+inline uint64_t col_file_nblock(uint64_t nrow, uint32_t width) {
+    const uint64_t page_blk = COL_FILE_PAGE / 64;
+    uint64_t nblk = 1 + (nrow * width + 63) / 64;
+    return (nblk + page_blk - 1) / page_blk * page_blk;
+}
+
+inline int write_col_file(const std::string& fn, const void* rows, uint64_t nrow, uint32_t width) {
+    FILE* f = fopen(fn.c_str(), "wb");
+    if (!f) {
+        printf("ERROR: %s cannot be opened for write.\n", fn.c_str());
+        return -1;
+    }
+    char page[COL_FILE_PAGE];
+    memset(page, 0, sizeof(page));
+    col_file_header_t h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, COL_FILE_MAGIC, sizeof(h.magic));
+    h.version = COL_FILE_VERSION;
+    h.width = width;
+    h.nrow = nrow;
+    h.nblock = col_file_nblock(nrow, width);
+    memcpy(page, &h, sizeof(h));
+    bool ok = fwrite(page, COL_FILE_PAGE, 1, f) == 1;
+
+    // the row count word, then the rows and the tail padding
+    memset(page, 0, sizeof(page));
+    uint32_t nrow32 = (uint32_t)nrow;
+    memcpy(page, &nrow32, sizeof(nrow32));
+    ok = ok && fwrite(page, 64, 1, f) == 1;
+    ok = ok && fwrite(rows, width, nrow, f) == nrow;
+    memset(page, 0, 64);
+    uint64_t pad = h.nblock * 64 - 64 - nrow * width;
+    for (; ok && pad > 0; pad -= std::min<uint64_t>(pad, COL_FILE_PAGE))
+        ok = fwrite(page, std::min<uint64_t>(pad, COL_FILE_PAGE), 1, f) == 1;
+    fclose(f);
+    if (!ok) {
+        printf("ERROR: failed to write %s.\n", fn.c_str());
+        return -1;
+    }
+    return 0;
+}
+
+// reads and checks the header of an open .col file, returns 0 if it is usable
+inline int read_col_file_header(int fd, col_file_header_t& h) {
+    if (pread(fd, &h, sizeof(h), 0) != (ssize_t)sizeof(h)) return -1;
+    if (memcmp(h.magic, COL_FILE_MAGIC, sizeof(h.magic)) || h.version != COL_FILE_VERSION) return -1;
+    if (h.nblock != col_file_nblock(h.nrow, h.width)) return -1;
+    off_t end = lseek(fd, 0, SEEK_END);
+    if (end < (off_t)(COL_FILE_PAGE + h.nblock * 64)) return -1;
+    return 0;
+}
+
+#endif // COL_FILE_H
@@ -0,0 +1,494 @@
+/*
+ * Copyright 2019 Xilinx, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file cpu_ops.hpp
+ * @brief Multi-threaded relational operators for the CPU path of the TPC-H demos.
+ *
+ * The operators work on the column layout of Table, so the CPU queries can
+ * read the same host tables as the FPGA ones. Rows are processed in chunks
+ * by a shared thread pool, and every operator writes its output rows in the
+ * same order as a single-threaded scan would.
+ */
+
+#ifndef CPU_OPS_H
+#define CPU_OPS_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace cpu_ops {
+
+/**
+ * @brief Fixed set of worker threads running one batch of tasks at a time.
+ *
+ * The calling thread takes part in the batch, so a pool of size one runs
+ * everything in the caller. Batches must not be nested.
+ */
+class ThreadPool {
+   public:
+    explicit ThreadPool(int nthread) : nthread_(nthread < 1 ? 1 : nthread), stop_(false), gen_(0), cur_(NULL) {
+        for (int i = 1; i < nthread_; i++) workers_.emplace_back([this] { loop(); });
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lk(mtx_);
+            stop_ = true;
+        }
+        cv_.notify_all();
+        for (auto& w : workers_) w.join();
+    }
+
+    int size() const { return nthread_; }
+
+    //! Run f(t) for t in [0, ntask) and wait until all tasks are done
+    void run(int ntask, const std::function<void(int)>& f) {
+        if (ntask <= 0) return;
+        std::lock_guard<std::mutex> one(run_mtx_);
+        Batch b(f, ntask);
+        {
+            std::lock_guard<std::mutex> lk(mtx_);
+            cur_ = &b;
+            ++gen_;
+        }
+        cv_.notify_all();
+        b.work();
+        std::unique_lock<std::mutex> lk(mtx_);
+        cur_ = NULL;
+        done_.wait(lk, [&] { return b.active == 0; });
+    }
+
+   private:
+    struct Batch {
+        const std::function<void(int)>& f;
+        int ntask;
+        std::atomic<int> next;
+        int active; // workers inside work(), guarded by mtx_
+        Batch(const std::function<void(int)>& f_, int n) : f(f_), ntask(n), next(0), active(0) {}
+        void work() {
+            for (int t = next++; t < ntask; t = next++) f(t);
+        }
+    };
+
+    void loop() {
+        uint64_t seen = 0;
+        std::unique_lock<std::mutex> lk(mtx_);
+        for (;;) {
+            cv_.wait(lk, [&] { return stop_ || (cur_ != NULL && gen_ != seen); });
+            if (stop_) return;
+            seen = gen_;
+            Batch* b = cur_;
+            b->active++;
+            lk.unlock();
+            b->work();
+            lk.lock();
+            if (--b->active == 0) done_.notify_all();
+        }
+    }
+
+    int nthread_;
+    bool stop_;
+    uint64_t gen_;
+    Batch* cur_;
+    std::vector<std::thread> workers_;
+    std::mutex run_mtx_;
+    std::mutex mtx_;
+    std::condition_variable cv_;
+    std::condition_variable done_;
+};
+
+//! Pool shared by all operators, one thread per hardware thread unless CPU_OPS_THREAD_NUM is defined
+inline ThreadPool& defaultPool() {
+#ifdef CPU_OPS_THREAD_NUM
+    static ThreadPool pool(CPU_OPS_THREAD_NUM);
+#else
+    static ThreadPool pool(std::thread::hardware_concurrency());
+#endif
+    return pool;
+}
+
+//! Number of chunks [0, n) is cut into, at least grain rows per chunk
+inline int chunkNum(int n, int grain = 16384) {
+    int nchunk = (n + grain - 1) / grain;
+    return std::max(1, std::min(nchunk, defaultPool().size() * 4));
+}
+
+//! First row of chunk c when [0, n) is cut into nchunk chunks
+inline int chunkBegin(int n, int nchunk, int c) {
+    return (int)((int64_t)n * c / nchunk);
+}
+
+/**
+ * @brief Run f(begin, end) over chunks of [0, n) on the shared pool.
+ */
+template <class F>
+void parallelFor(int n, F f) {
+    int nchunk = chunkNum(n);
+    defaultPool().run(nchunk, [&](int c) { f(chunkBegin(n, nchunk, c), chunkBegin(n, nchunk, c + 1)); });
+}
+
+/// @brief Pair of input rows forming one output row, j is -1 for filters.
+struct RowMatch {
+    int32_t i;
+    int32_t j;
+};
+
+/**
+ * @brief Collect matches chunk by chunk and write them out in scan order.
+ *
+ * match(i, out) appends the RowMatch entries of input row i, then
+ * emit(r, i, j) writes output row r. Both run in parallel, emit is called
+ * once per output row.
+ *
+ * @return number of output rows.
+ */
+template <class Match, class Emit>
+int parallelJoin(int n, Match match, Emit emit) {
+    int nchunk = chunkNum(n);
+    std::vector<std::vector<RowMatch> > out(nchunk);
+    defaultPool().run(nchunk, [&](int c) {
+        for (int i = chunkBegin(n, nchunk, c); i < chunkBegin(n, nchunk, c + 1); i++) match(i, out[c]);
+    });
+    std::vector<int> base(nchunk + 1, 0);
+    for (int c = 0; c < nchunk; c++) base[c + 1] = base[c] + out[c].size();
+    defaultPool().run(nchunk, [&](int c) {
+        int r = base[c];
+        for (auto& m : out[c]) emit(r++, m.i, m.j);
+    });
+    return base[nchunk];
+}
+
+/**
+ * @brief Columnar filter, emit(r, i) is called for each row i where pred(i) holds.
+ *
+ * Selected rows of a chunk are first gathered into a selection vector with a
+ * branch-free loop, then written out.
+ *
+ * @return number of output rows.
+ */
+template <class Pred, class Emit>
+int parallelFilter(int n, Pred pred, Emit emit) {
+    int nchunk = chunkNum(n);
+    std::vector<std::vector<int32_t> > sel(nchunk);
+    defaultPool().run(nchunk, [&](int c) {
+        int b = chunkBegin(n, nchunk, c);
+        int e = chunkBegin(n, nchunk, c + 1);
+        std::vector<int32_t>& s = sel[c];
+        s.resize(e - b);
+        int cnt = 0;
+        for (int i = b; i < e; i++) {
+            s[cnt] = i;
+            cnt += pred(i) ? 1 : 0;
+        }
+        s.resize(cnt);
+    });
+    std::vector<int> base(nchunk + 1, 0);
+    for (int c = 0; c < nchunk; c++) base[c + 1] = base[c] + sel[c].size();
+    defaultPool().run(nchunk, [&](int c) {
+        int r = base[c];
+        for (int32_t i : sel[c]) emit(r++, i);
+    });
+    return base[nchunk];
+}
+
+//! Sum of f(i) over [0, n), partial sums are added in chunk order
+template <class T, class F>
+T parallelSum(int n, F f) {
+    int nchunk = chunkNum(n);
+    std::vector<T> part(nchunk, T());
+    defaultPool().run(nchunk, [&](int c) {
+        T s = T();
+        for (int i = chunkBegin(n, nchunk, c); i < chunkBegin(n, nchunk, c + 1); i++) s += f(i);
+        part[c] = s;
+    });
+    T s = T();
+    for (int c = 0; c < nchunk; c++) s += part[c];
+    return s;
+}
+
+//! Two 32-bit key columns as one 64-bit join key
+inline int64_t packKey(int32_t a, int32_t b) {
+    return (int64_t)(((uint64_t)(uint32_t)a << 32) | (uint32_t)b);
+}
+
+//! 64-bit finalizer of MurmurHash3
+inline uint64_t hashKey(int64_t k) {
+    uint64_t h = (uint64_t)k;
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+/**
+ * @brief Radix-partitioned hash index over the rows of a build table.
+ *
+ * Build rows are scattered into partitions by the top bits of the key hash,
+ * each partition small enough to stay in cache, then every partition is
+ * bucketed by the low hash bits in parallel. Rows with equal keys are
+ * visited in build order.
+ */
+class HashIndex {
+   public:
+    /**
+     * @brief Build the index.
+     *
+     * @param n number of build rows.
+     * @param key key(i, k) sets the key of row i, returning false skips the row.
+     */
+    template <class KeyFn>
+    HashIndex(int n, KeyFn key) {
+        int nchunk = chunkNum(n);
+        // gather the keys of the selected rows
+        std::vector<std::vector<int64_t> > ck(nchunk);
+        std::vector<std::vector<int32_t> > cr(nchunk);
+        defaultPool().run(nchunk, [&](int c) {
+            for (int i = chunkBegin(n, nchunk, c); i < chunkBegin(n, nchunk, c + 1); i++) {
+                int64_t k;
+                if (key(i, k)) {
+                    ck[c].push_back(k);
+                    cr[c].push_back(i);
+                }
+            }
+        });
+        size_t total = 0;
+        for (int c = 0; c < nchunk; c++) total += ck[c].size();
+        pbits_ = 0;
+        while (pbits_ < 10 && (total >> pbits_) > 4096) pbits_++;
+        int npart = 1 << pbits_;
+
+        // partition, chunk-major offsets keep build order within a partition
+        std::vector<std::vector<size_t> > hist(nchunk, std::vector<size_t>(npart + 1, 0));
+        defaultPool().run(nchunk, [&](int c) {
+            for (int64_t k : ck[c]) hist[c][part(hashKey(k))]++;
+        });
+        part_.assign(npart + 1, 0);
+        size_t off = 0;
+        for (int p = 0; p < npart; p++) {
+            part_[p] = off;
+            for (int c = 0; c < nchunk; c++) {
+                size_t cnt = hist[c][p];
+                hist[c][p] = off;
+                off += cnt;
+            }
+        }
+        part_[npart] = off;
+        std::vector<int64_t> pkey(total);
+        std::vector<int32_t> prow(total);
+        defaultPool().run(nchunk, [&](int c) {
+            std::vector<size_t>& pos = hist[c];
+            for (size_t e = 0; e < ck[c].size(); e++) {
+                size_t d = pos[part(hashKey(ck[c][e]))]++;
+                pkey[d] = ck[c][e];
+                prow[d] = cr[c][e];
+            }
+            std::vector<int64_t>().swap(ck[c]);
+            std::vector<int32_t>().swap(cr[c]);
+        });
+
+        // bucket each partition by the low hash bits, nb buckets take nb + 1 bounds
+        bucket_base_.assign(npart + 1, 0);
+        bucket_mask_.assign(npart, 0);
+        for (int p = 0; p < npart; p++) {
+            size_t nb = 1;
+            while (nb < part_[p + 1] - part_[p]) nb <<= 1;
+            bucket_mask_[p] = nb - 1;
+            bucket_base_[p + 1] = bucket_base_[p] + nb + 1;
+        }
+        bucket_.assign(bucket_base_[npart], 0);
+        key_.resize(total);
+        row_.resize(total);
+        defaultPool().run(npart, [&](int p) {
+            size_t* bk = &bucket_[bucket_base_[p]];
+            uint64_t mask = bucket_mask_[p];
+            for (size_t e = part_[p]; e < part_[p + 1]; e++) bk[(hashKey(pkey[e]) & mask) + 1]++;
+            bk[0] = part_[p];
+            for (uint64_t b = 0; b <= mask; b++) bk[b + 1] += bk[b];
+            std::vector<size_t> pos(bk, bk + mask + 1);
+            for (size_t e = part_[p]; e < part_[p + 1]; e++) {
+                size_t d = pos[hashKey(pkey[e]) & mask]++;
+                key_[d] = pkey[e];
+                row_[d] = prow[e];
+            }
+        });
+    }
+
+    //! Call f(j) for every build row j with key k
+    template <class F>
+    void forEach(int64_t k, F f) const {
+        uint64_t h = hashKey(k);
+        int p = part(h);
+        const size_t* bk = &bucket_[bucket_base_[p] + (h & bucket_mask_[p])];
+        for (size_t e = bk[0]; e < bk[1]; e++)
+            if (key_[e] == k) f(row_[e]);
+    }
+
+    //! First build row with key k, -1 when there is none
+    int32_t first(int64_t k) const {
+        int32_t j = -1;
+        uint64_t h = hashKey(k);
+        int p = part(h);
+        const size_t* bk = &bucket_[bucket_base_[p] + (h & bucket_mask_[p])];
+        for (size_t e = bk[0]; e < bk[1] && j < 0; e++)
+            if (key_[e] == k) j = row_[e];
+        return j;
+    }
+
+    //! Last build row with key k, -1 when there is none
+    int32_t last(int64_t k) const {
+        int32_t j = -1;
+        forEach(k, [&](int32_t r) { j = r; });
+        return j;
+    }
+
+    bool contains(int64_t k) const { return first(k) >= 0; }
+
+    //! Number of build rows with key k
+    int count(int64_t k) const {
+        int c = 0;
+        forEach(k, [&](int32_t) { c++; });
+        return c;
+    }
+
+    size_t size() const { return key_.size(); }
+
+   private:
+    int part(uint64_t h) const { return pbits_ ? (int)(h >> (64 - pbits_)) : 0; }
+
+    int pbits_;
+    std::vector<size_t> part_;
+    std::vector<size_t> bucket_base_;
+    std::vector<uint64_t> bucket_mask_;
+    std::vector<size_t> bucket_;
+    std::vector<int64_t> key_;
+    std::vector<int32_t> row_;
+};
+
+/**
+ * @brief Inner hash join, one output row per matching (probe, build) pair.
+ *
+ * @param ht index over the build table.
+ * @param n number of probe rows.
+ * @param key key(i, k) sets the key of probe row i, returning false skips the row.
+ * @param emit emit(r, i, j) writes output row r from probe row i and build row j.
+ *
+ * @return number of output rows.
+ */
+template <class KeyFn, class Emit>
+int hashJoin(const HashIndex& ht, int n, KeyFn key, Emit emit) {
+    return parallelJoin(n,
+                        [&](int i, std::vector<RowMatch>& out) {
+                            int64_t k;
+                            if (key(i, k)) ht.forEach(k, [&](int32_t j) { out.push_back(RowMatch{i, j}); });
+                        },
+                        emit);
+}
+
+/**
+ * @brief Inner hash join against the first build row of each key.
+ *
+ * Gives the result of probing a std::unordered_map filled by insert(), which
+ * drops later build rows with a key already present.
+ */
+template <class KeyFn, class Emit>
+int hashJoinFirst(const HashIndex& ht, int n, KeyFn key, Emit emit) {
+    return parallelJoin(n,
+                        [&](int i, std::vector<RowMatch>& out) {
+                            int64_t k;
+                            if (!key(i, k)) return;
+                            int32_t j = ht.first(k);
+                            if (j >= 0) out.push_back(RowMatch{i, j});
+                        },
+                        emit);
+}
+
+/**
+ * @brief Semi join (anti join when anti is true), emit(r, i) for each kept probe row.
+ */
+template <class KeyFn, class Emit>
+int hashSemiJoin(const HashIndex& ht, int n, KeyFn key, Emit emit, bool anti = false) {
+    return parallelFilter(n,
+                          [&](int i) {
+                              int64_t k;
+                              if (!key(i, k)) return false;
+                              return ht.contains(k) != anti;
+                          },
+                          emit);
+}
+
+/**
+ * @brief Hash group-by aggregate.
+ *
+ * row(i, k, v) gives the group key and the partial aggregate of row i,
+ * returning false skips the row. merge(a, b) folds b into a. Each thread
+ * aggregates its rows into maps partitioned by key hash, the partitions are
+ * then merged in parallel.
+ *
+ * @return one (key, aggregate) pair per group.
+ */
+template <class K, class V, class H = std::hash<K>, class RowFn, class Merge>
+std::vector<std::pair<K, V> > parallelGroupBy(int n, RowFn row, Merge merge) {
+    typedef std::unordered_map<K, V, H> Map;
+    // one chunk per thread, more chunks only add merge work
+    int npart = defaultPool().size();
+    int nchunk = std::min(chunkNum(n), npart);
+    std::vector<std::vector<Map> > local(nchunk, std::vector<Map>(npart));
+    defaultPool().run(nchunk, [&](int c) {
+        H hash;
+        K k;
+        V v;
+        for (int i = chunkBegin(n, nchunk, c); i < chunkBegin(n, nchunk, c + 1); i++) {
+            if (!row(i, k, v)) continue;
+            Map& m = local[c][npart > 1 ? hashKey((int64_t)hash(k)) % npart : 0];
+            auto it = m.find(k);
+            if (it != m.end())
+                merge(it->second, v);
+            else
+                m.insert(std::make_pair(k, v));
+        }
+    });
+    defaultPool().run(npart, [&](int p) {
+        Map& m = local[0][p];
+        for (int c = 1; c < nchunk; c++) {
+            for (auto& e : local[c][p]) {
+                auto it = m.find(e.first);
+                if (it != m.end())
+                    merge(it->second, e.second);
+                else
+                    m.insert(e);
+            }
+            Map().swap(local[c][p]);
+        }
+    });
+    std::vector<std::pair<K, V> > res;
+    for (int p = 0; p < npart; p++) res.insert(res.end(), local[0][p].begin(), local[0][p].end());
+    return res;
+}
+
+} // namespace cpu_ops
+
+#endif // CPU_OPS_H
@@ -27,6 +27,13 @@
 #include <CL/cl_ext_xilinx.h>
 #include <xcl2.hpp>
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <thread>
+#include "col_file.hpp"
+#include "xf_database/bloom_filter_host.hpp"
+
 #define XCL_BANK(n) (((unsigned int)(n)) | XCL_MEM_TOPOLOGY)
 
 #define XCL_BANK0 XCL_BANK(0)
@@ -114,6 +121,122 @@ void print_d_time(cl::Event s, cl::Event e, int64_t base, const std::string kinf
     std::cout << std::dec << kinfo << " end time of Device " << etime << " ms" << std::endl;
     std::cout << std::dec << kinfo << " duration time of Device " << duration << " ms" << std::endl;
 }
+
+//! Timeline of a run, for finding bubbles in multi-kernel pipelines. Host stages and device events
+//! (H2D migrates, kernel runs, D2H migrates) are recorded on named tracks, and written as Chrome
+//! trace_event JSON that can be opened in chrome://tracing or Perfetto.
+class TimeTrace {
+   public:
+    //! Host stages are timed from tv_s.
+    TimeTrace(struct timeval tv_s) : tv_start(tv_s), dev_offset(0){};
+
+    //! Place the first device event at host time tv_d, as the offset of print_d_time does.
+    void alignDevice(struct timeval tv_d) { dev_offset = tvdiff(&tv_start, &tv_d); };
+
+    //! Record a host stage from tv_0 to tv_1.
+    void addHost(const std::string& name, struct timeval tv_0, struct timeval tv_1, const std::string& track = "host") {
+        host_stage hs = {name, track, tvdiff(&tv_start, &tv_0), tvdiff(&tv_0, &tv_1)};
+        host_stages.push_back(hs);
+        getTrack(track, 0);
+    };
+
+    //! Record a device event, its CL_PROFILING_COMMAND_* timestamps are read when dumping.
+    void addEvent(const cl::Event& e, const std::string& name, const std::string& track) {
+        dev_event de = {e, name, track};
+        dev_events.push_back(de);
+        getTrack(track, 1);
+    };
+    void addEvents(const std::vector<cl::Event>& es, const std::string& name, const std::string& track) {
+        for (size_t i = 0; i < es.size(); i++) addEvent(es[i], name, track);
+    };
+
+    //! Write the timeline to file once all device events have completed, returns 0 on success.
+    int dump(const std::string& file) {
+        std::ofstream ofs(file.c_str());
+        if (!ofs) {
+            std::cout << "ERROR: cannot open trace file " << file << std::endl;
+            return -1;
+        }
+        cl_ulong base = 0;
+        for (size_t i = 0; i < dev_events.size(); i++) {
+            cl_ulong start;
+            dev_events[i].e.getProfilingInfo(CL_PROFILING_COMMAND_START, &start);
+            if (i == 0 || start < base) base = start;
+        }
+
+        ofs << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+        ofs << "{\"name\": \"process_name\", \"ph\": \"M\", \"pid\": 0, \"args\": {\"name\": \"Host\"}},\n";
+        ofs << "{\"name\": \"process_name\", \"ph\": \"M\", \"pid\": 1, \"args\": {\"name\": \"Device\"}}";
+        for (size_t i = 0; i < tracks.size(); i++) {
+            ofs << ",\n{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": " << track_pid[i] << ", \"tid\": " << i
+                << ", \"args\": {\"name\": \"" << escape(tracks[i]) << "\"}}";
+        }
+        for (size_t i = 0; i < host_stages.size(); i++) {
+            const host_stage& hs = host_stages[i];
+            writeEvent(ofs, hs.name, 0, getTrack(hs.track, 0), hs.ts, hs.dur, 0);
+        }
+        for (size_t i = 0; i < dev_events.size(); i++) {
+            cl_ulong queued, start, end;
+            dev_events[i].e.getProfilingInfo(CL_PROFILING_COMMAND_QUEUED, &queued);
+            dev_events[i].e.getProfilingInfo(CL_PROFILING_COMMAND_START, &start);
+            dev_events[i].e.getProfilingInfo(CL_PROFILING_COMMAND_END, &end);
+            writeEvent(ofs, dev_events[i].name, 1, getTrack(dev_events[i].track, 1),
+                       (long)((start - base) / 1000) + dev_offset, (long)((end - start) / 1000),
+                       (long)((start - queued) / 1000));
+        }
+        ofs << "\n]}\n";
+        std::cout << "Timeline of " << host_stages.size() << " host stages and " << dev_events.size()
+                  << " device events written to " << file << std::endl;
+        return 0;
+    };
+
+   private:
+    struct host_stage {
+        std::string name;
+        std::string track;
+        long ts;
+        long dur;
+    };
+    struct dev_event {
+        cl::Event e;
+        std::string name;
+        std::string track;
+    };
+
+    // tid of a track, added on first use
+    int getTrack(const std::string& track, int pid) {
+        for (size_t i = 0; i < tracks.size(); i++) {
+            if (tracks[i] == track && track_pid[i] == pid) return i;
+        }
+        tracks.push_back(track);
+        track_pid.push_back(pid);
+        return tracks.size() - 1;
+    };
+
+    // name as a JSON string body
+    static std::string escape(const std::string& str) {
+        std::string r;
+        for (size_t i = 0; i < str.size(); i++) {
+            if (str[i] == '"' || str[i] == '\\') r.push_back('\\');
+            if ((unsigned char)str[i] >= 0x20) r.push_back(str[i]);
+        }
+        return r;
+    };
+
+    void writeEvent(std::ofstream& ofs, const std::string& name, int pid, int tid, long ts, long dur, long wait) {
+        ofs << ",\n{\"name\": \"" << escape(name) << "\", \"ph\": \"X\", \"pid\": " << pid << ", \"tid\": " << tid
+            << ", \"ts\": " << ts << ", \"dur\": " << dur;
+        if (pid == 1) ofs << ", \"args\": {\"queued_us\": " << wait << "}";
+        ofs << "}";
+    };
+
+    struct timeval tv_start;
+    long dev_offset;
+    std::vector<host_stage> host_stages;
+    std::vector<dev_event> dev_events;
+    std::vector<std::string> tracks;
+    std::vector<int> track_pid;
+};
 template <typename T>
 int load_dat(T* data, const std::string& name, const std::string& dir, size_t n, size_t sizeT) {
     if (!data) {
@@ -141,6 +264,44 @@ void load_dat(T* data, const std::string& name, const std::string& dir, size_t n
     load_dat(data, name, dir, n, sizeof(T));
 };
 
+//! Number of 512-bit words in the zone map of a column of nrow rows,
+//! with one zone per burst of zone_rows rows and 8 zones per word.
+size_t zone_map_size(size_t nrow, size_t zone_rows = 32 * VEC_LEN) {
+    size_t nzone = (nrow + zone_rows - 1) / zone_rows;
+    return (nzone + 7) / 8;
+}
+
+//! Build the zone map of a 32-bit column for the zone-map mode of the GQE table scanner.
+//! Zone k of a word keeps its min in bits 64k+31:64k and its max in bits 64k+63:64k+32.
+//! The map is placed after the columns, and bits 127:96 of the column header point to it.
+size_t build_zone_map(const int32_t* col, size_t nrow, ap_uint<512>* zm, size_t zone_rows = 32 * VEC_LEN) {
+    size_t nword = zone_map_size(nrow, zone_rows);
+    for (size_t w = 0; w < nword; w++) zm[w] = 0;
+    for (size_t r = 0, z = 0; r < nrow; r += zone_rows, z++) {
+        size_t end = std::min(nrow, r + zone_rows);
+        int32_t zmin = col[r], zmax = col[r];
+        for (size_t i = r + 1; i < end; i++) {
+            zmin = std::min(zmin, col[i]);
+            zmax = std::max(zmax, col[i]);
+        }
+        zm[z / 8].range(64 * (z % 8) + 31, 64 * (z % 8)) = zmin;
+        zm[z / 8].range(64 * (z % 8) + 63, 64 * (z % 8) + 32) = zmax;
+    }
+    return nword;
+}
+
+//! Set range predicate k (0 to 3) of the zone-map scan, lo <= column col <= hi, in the
+//! gqeAggr command config; the first predicate turns the zone-map scan on.
+void set_zone_map_cfg(ap_uint<32>* config, int k, int col, int32_t lo, int32_t hi) {
+    if (config[83] == 0) {
+        config[83] = 1;
+        config[84] = 0xffffffff;
+    }
+    config[84].range(8 * k + 7, 8 * k) = col;
+    config[85 + 2 * k] = lo;
+    config[86 + 2 * k] = hi;
+}
+
 class Table {
    public:
     std::string name;
@@ -161,7 +322,7 @@ class Table {
     ap_uint<512>* datak;
     cl::Buffer buffer;
 
-    Table(){};
+    Table() { zm512 = 0; };
 
     Table(std::string name_, size_t nrow_, size_t ncol_, std::string dir_) {
         name = name_;
@@ -171,11 +332,15 @@ class Table {
         dir = dir_;
         size512.push_back(0);
         mode = 2;
+        mapped = 0;
+        zm512 = 0;
     };
 
     Table(size_t size) {
         size512.push_back(size / 64);
         mode = 3;
+        mapped = 0;
+        zm512 = 0;
     };
 
     //! Add column
@@ -195,7 +360,9 @@ class Table {
         // std::cout<<"load host"<<std::endl;
         for (size_t i = 0; i < ncol; i++) {
             // std::cout<<isrowid[i]<<std::endl;
-            if (isrowid[i] == 0) {
+            if (isrowid[i] == 0 && mapped) {
+                // rows are already in place from the .col file
+            } else if (isrowid[i] == 0) {
                 // std::cout<<colsname[i]<<dir<<nrow<<colswidth[i]<<std::endl;
                 int err = load_dat(data + size512[i] + 1, colsname[i], dir, nrow, colswidth[i]);
                 if (err) {
@@ -210,10 +377,50 @@ class Table {
         };
     };
 
+    //! Reserve the zone maps of columns cols after the columns, call after addCol
+    //! and before allocateHost. 8 empty column headers come first, as the scan reads 8.
+    void addZoneMap(const std::vector<int>& cols) {
+        zmcols = cols;
+        zm512 = 8;
+        for (size_t i = 0; i < cols.size(); i++) zm512 += zone_map_size(nrow);
+    };
+
+    //! Write the column headers and zone maps after loadHost, returns 0 on success.
+    //! Each column header gets its rows, its words after the header and the offset
+    //! of its zone map in bits 127:96, as the zone-map scan of gqeAggr reads them;
+    //! the table is then only scanned with the zone-map scan on.
+    int buildZoneMap() {
+        bool kdata = true;
+        for (size_t i = 0; i < ncol; i++) kdata &= (iskdata[i] == 1);
+        if (zm512 == 0 || zmcols.size() > 4 || !kdata) {
+            std::cout << "ERROR: " << name << " has no zone map reserved for up to 4 columns, or copies columns"
+                      << std::endl;
+            return -1;
+        }
+        std::vector<size_t> zm_off(ncol, 0);
+        size_t off = size512[ncol];
+        for (size_t j = 0; j < 8; j++) data[off + j] = 0;
+        off += 8;
+        for (size_t k = 0; k < zmcols.size(); k++) {
+            if (zmcols[k] < 0 || zmcols[k] >= (int)ncol) {
+                std::cout << "ERROR: " << name << " has no column " << zmcols[k] << std::endl;
+                return -1;
+            }
+            zm_off[zmcols[k]] = off;
+            off += build_zone_map(getColPtr<int32_t>(zmcols[k]), nrow, data + off);
+        }
+        for (size_t i = 0; i < ncol; i++) {
+            ap_uint<512> h = get_table_header(size512[i + 1] - size512[i] - 1, nrow);
+            h.range(127, 96) = zm_off[i];
+            data[size512[i]] = h;
+        }
+        return 0;
+    };
+
     //! CPU memory allocation
     void allocateHost() { // col added manually
         if (mode == 1) {
-            data = aligned_alloc<ap_uint<512> >(size512.back());
+            if (mapHost()) data = aligned_alloc<ap_uint<512> >(size512.back() + zm512);
             data[0] = get_table_header(size512[1], nrow); // TO CHECK
             for (size_t j = 1; j < ncol; j++) {
                 data[size512[j]] = 0;
@@ -234,6 +441,44 @@ class Table {
         }
     };
 
+    //! Map the columns from their .col files instead of allocating, returns 0 on success.
+    //! Each column is placed on a 4 KB boundary, so the mapping can back a
+    //! CL_MEM_USE_HOST_PTR buffer directly; pages are private, writes stay in memory.
+    int mapHost() {
+        const size_t page_blk = COL_FILE_PAGE / 64;
+        std::vector<size_t> msize512(1, 0);
+        for (size_t i = 0; i < ncol; i++) {
+            size_t sizeonecol = (size512[i + 1] - size512[i] + page_blk - 1) / page_blk * page_blk;
+            msize512.push_back(msize512.back() + sizeonecol);
+        }
+        size_t nbyte = 64 * (msize512.back() + zm512);
+        char* base = (char*)mmap(NULL, nbyte, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (base == MAP_FAILED) return -1;
+        for (size_t i = 0; i < ncol; i++) {
+            if (isrowid[i] == 1) continue;
+            std::string fn = dir + "/" + colsname[i] + ".col";
+            int fd = open(fn.c_str(), O_RDONLY);
+            col_file_header_t h;
+            bool ok = fd >= 0 && read_col_file_header(fd, h) == 0 && h.width == colswidth[i] && h.nrow >= nrow;
+            if (ok) {
+                size_t len = 64 * std::min<size_t>(h.nblock, msize512[i + 1] - msize512[i]);
+                void* p = mmap(base + 64 * msize512[i], len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, fd,
+                               COL_FILE_PAGE);
+                ok = p != MAP_FAILED;
+            }
+            if (fd >= 0) close(fd);
+            if (!ok) {
+                munmap(base, nbyte);
+                return -1;
+            }
+        }
+        size512 = msize512;
+        data = (ap_uint<512>*)base;
+        mapped = 1;
+        std::cout << name << " mapped from .col files" << std::endl;
+        return 0;
+    };
+
     void allocateHost(float f, int p_num) { // col added manually
         if ((f == 0) || (p_num == 0))
             std::cout << "ERROR: p_num (" << p_num << ")should be bigger than 1,"
@@ -306,6 +551,11 @@ class Table {
         memcpy(&d, (char*)(data + size512[l] + 1) + r * sizeof(uint32_t), sizeof(uint32_t));
         return d;
     };
+    //! Raw pointer to the rows of column l, for columnar access
+    template <class T>
+    T* getColPtr(int l) {
+        return (T*)(data + size512[l] + 1);
+    };
     int64_t combineInt64(int r, int l0, int l1) {
         ap_uint<32> h; // h
         ap_uint<32> l; // l
@@ -372,8 +622,9 @@ class Table {
         } else {
             mext = {XCL_MEM_TOPOLOGY | (unsigned int)(bank), data, 0};
             buffer = cl::Buffer(context, CL_MEM_EXT_PTR_XILINX | CL_MEM_USE_HOST_PTR | CL_MEM_READ_WRITE,
-                                (size_t)(64 * size512.back()), &mext);
-            std::cout << name << " XBuffer size: " << (64 * size512.back() / (1024 * 1024)) << " MByte " << std::endl;
+                                (size_t)(64 * (size512.back() + zm512)), &mext);
+            std::cout << name << " XBuffer size: " << (64 * (size512.back() + zm512) / (1024 * 1024)) << " MByte "
+                      << std::endl;
         }
     };
 
@@ -475,6 +726,9 @@ class Table {
     }
 
     int mode;
+    int mapped;
+    std::vector<int> zmcols;
+    size_t zm512;
 };
 
 void gatherTable_col(Table& tin1, Table& tin2, Table& tout) {
@@ -509,6 +763,94 @@ void gatherTable_row(Table& tin1, Table& tin2, Table& tout) {
     tout.setNumRow(nrow1 + nrow2);
 }
 
+//! Width in bytes of column c, columns added by allocateHost without addCol are 4 bytes
+inline size_t col_width(Table& t, size_t c) {
+    return t.colswidth.empty() ? 4 : t.colswidth[c];
+}
+
+//! Copy the rows of tin whose key in column key_col may be in the Bloom filter of the build side into tout,
+//! and return the number of rows kept, or -1 when the columns do not fit. The filter is built by bfHostGen,
+//! with the same hashing and bit layout as bfGen, so the vectors can also be loaded for bfCheck as a second
+//! stage on card. The key column is 4 or 8 bytes wide, hashed as a 32-bit or 64-bit key, and tout must have
+//! the columns of tin with the same widths and room for all its rows. The rows are split among nthread
+//! threads, each checks its keys first, and then copies its kept rows of every column at its offset in tout.
+template <int BV_W>
+int64_t bloom_prefilter_table(
+    Table& tin, int key_col, const uint16_t* bv0, const uint16_t* bv1, const uint16_t* bv2, Table& tout, int nthread) {
+    const size_t nrow = tin.getNumRow();
+    const size_t ncol = tin.ncol;
+    const size_t key_w = col_width(tin, key_col);
+    if (key_w != 4 && key_w != 8) {
+        std::cout << "ERROR: key column " << key_col << " of " << tin.name << " is " << key_w
+                  << " bytes wide, the Bloom pre-filter hashes 4-byte or 8-byte keys" << std::endl;
+        return -1;
+    }
+    if (tout.ncol < ncol) {
+        std::cout << "ERROR: " << tout.name << " has fewer columns than " << tin.name << std::endl;
+        return -1;
+    }
+    for (size_t c = 0; c < ncol; c++) {
+        if (col_width(tout, c) != col_width(tin, c)) {
+            std::cout << "ERROR: column " << c << " of " << tout.name << " and " << tin.name << " differ in width"
+                      << std::endl;
+            return -1;
+        }
+    }
+    if (nthread < 1) nthread = 1;
+    std::vector<uint8_t> hit(nrow);
+    std::vector<size_t> offset(nthread + 1, 0);
+    std::vector<std::thread> th;
+
+    for (int t = 0; t < nthread; t++) {
+        th.push_back(std::thread([&, t]() {
+            size_t b = nrow * t / nthread, e = nrow * (t + 1) / nthread;
+            if (key_w == 4)
+                xf::database::bfHostCheck<32, BV_W>(tin.getColPtr<int32_t>(key_col) + b, e - b, bv0, bv1, bv2,
+                                                    hit.data() + b);
+            else
+                xf::database::bfHostCheck<64, BV_W>(tin.getColPtr<int64_t>(key_col) + b, e - b, bv0, bv1, bv2,
+                                                    hit.data() + b);
+            size_t n = 0;
+            for (size_t r = b; r < e; r++) n += hit[r];
+            offset[t + 1] = n;
+        }));
+    }
+    for (int t = 0; t < nthread; t++) th[t].join();
+    th.clear();
+    for (int t = 0; t < nthread; t++) offset[t + 1] += offset[t];
+
+    for (int t = 0; t < nthread; t++) {
+        th.push_back(std::thread([&, t]() {
+            size_t b = nrow * t / nthread, e = nrow * (t + 1) / nthread;
+            for (size_t c = 0; c < ncol; c++) {
+                const size_t w = col_width(tin, c);
+                if (w == 4) {
+                    const int32_t* src = tin.getColPtr<int32_t>(c);
+                    int32_t* dst = tout.getColPtr<int32_t>(c) + offset[t];
+                    for (size_t r = b; r < e; r++) {
+                        if (hit[r]) *dst++ = src[r];
+                    }
+                } else {
+                    const char* src = tin.getColPtr<char>(c);
+                    char* dst = tout.getColPtr<char>(c) + w * offset[t];
+                    for (size_t r = b; r < e; r++) {
+                        if (hit[r]) {
+                            memcpy(dst, src + w * r, w);
+                            dst += w;
+                        }
+                    }
+                }
+            }
+        }));
+    }
+    for (int t = 0; t < nthread; t++) th[t].join();
+
+    const size_t nkeep = offset[nthread];
+    tout.setNumRow(nkeep);
+    std::cout << tin.name << " Bloom pre-filter kept " << nkeep << " of " << nrow << " rows" << std::endl;
+    return nkeep;
+}
+
 class cfgCmd {
    public:
     ap_uint<512>* cmd;
@@ -744,6 +1086,23 @@ class krnlEngine {
         krnl.setArg(j++, (cfgcmd->buffer));
     };
 
+    //! gqeSort, tmp holds 16 bytes per row of tbin with the rows rounded up
+    //! to a multiple of 16, it is given to all temporary ports
+    void setup_sort(const int col_id, const int order, const int top_k, Table& tbin, Table& tbout, cl::Buffer& tmp) {
+        in1 = &tbin;
+        out = &tbout;
+
+        int j = 0;
+        krnl.setArg(j++, col_id);
+        krnl.setArg(j++, order);
+        krnl.setArg(j++, top_k);
+        krnl.setArg(j++, (in1->buffer));
+        krnl.setArg(j++, (out->buffer));
+        for (int r = 0; r < 9; r++) {
+            krnl.setArg(j++, tmp);
+        }
+    };
+
     void run(int rc, std::vector<cl::Event>* waitevt, cl::Event* outevt) { clq.enqueueTask(krnl, waitevt, outevt); };
 };
 
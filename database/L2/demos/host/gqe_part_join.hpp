@@ -0,0 +1,348 @@
+/*
+ * Copyright 2019 Xilinx, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef GQE_PART_JOIN_H
+#define GQE_PART_JOIN_H
+
+// PartJoin runs a JoinSpec on tables of any size by hash partitioning both
+// sides with gqePart and joining the partition pairs with gqeJoin.
+//
+//   - The partition number is the smallest power of 2 that keeps every
+//     partition under 1 << log_rows rows, and every partition pair with its
+//     result under half of dev_mem, so that two pairs fit on the device.
+//   - When the tables, their partitions and the result fit in dev_mem, one
+//     QueryPlan runs everything on the device without host round trips.
+//   - Otherwise each table is partitioned in chunks that fit the device, two
+//     chunks in flight, and the partitions are gathered in host memory. The
+//     pairs are then streamed through gqeJoin: pair i + 1 is sent while pair
+//     i runs, and results are read back and appended as they finish.
+//
+// ta and tb only need host memory. tout is a plain host table whose row
+// count is the capacity for the result; its rows come in partition order.
+
+#include "gqe_plan.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace part_join_details {
+
+inline char* col_ptr(Table& t, int c) {
+    return (char*)(t.data + t.size512[c] + 1);
+}
+
+// partition p of a table allocated with allocateHost(f, p_num)
+inline char* part_col_ptr(Table& t, int p, int c) {
+    size_t blk = t.size512[1] - t.size512[0];
+    return (char*)(t.data + t.size512[t.ncol] * p + blk * c + 1);
+}
+
+inline int part_nrow(Table& t, int p) {
+    return t.data[t.size512[t.ncol] * p].range(31, 0).to_int();
+}
+
+// rows one partition column of t can hold, less its header word
+inline size_t part_cap(Table& t) {
+    return (t.size512[1] - t.size512[0] - 1) * 16;
+}
+
+// headroom of partitions of n rows: 1.2 as in the demos, plus four standard
+// deviations of a partition's row count and the two 512-bit words a partition
+// column loses to rounding and to the header of the next partition
+inline float part_factor(size_t n, int npart) {
+    double m = std::max<size_t>(n, 1);
+    return 1.2 + 4 * sqrt(npart / m) + 32 * npart / m;
+}
+
+inline size_t table_bytes(Table& t) {
+    return 64 * t.size512.back();
+}
+
+// number of scanned columns and the largest column id of table A or B
+inline void scan_cols(ap_uint<512>* cmd, int index, int& nscan, int& maxid) {
+    nscan = 0;
+    maxid = -1;
+    for (int c = 0; c < 8; c++) {
+        int id = (int)(signed char)cmd[0].range(64 * index + 56 + 8 * c + 7, 64 * index + 56 + 8 * c).to_int();
+        if (id >= 0) {
+            nscan++;
+            maxid = std::max(maxid, id);
+        }
+    }
+}
+
+} // part_join_details
+
+class PartJoin {
+    cl::Context ctx;
+    cl::CommandQueue q;
+    cl::Program prog;
+    size_t dev_mem;
+    int log_rows;
+
+    // appends the rows of src to tout, returns -1 when tout is full
+    int append(Table& src, int nrow, Table& tout, size_t& fill, int ncol) {
+        using namespace part_join_details;
+        if (fill + nrow > tout.nrow) {
+            printf("ERROR: join result exceeds the %ld rows of %s.\n", (long)tout.nrow, tout.name.c_str());
+            return -1;
+        }
+        for (int c = 0; c < ncol; c++) memcpy(col_ptr(tout, c) + 4 * fill, col_ptr(src, c), 4 * (size_t)nrow);
+        fill += nrow;
+        return 0;
+    }
+
+    // partitions table t (A when index is 0) into parts on the host, feeding
+    // the device chunk by chunk through two sets of buffers
+    int partition(Table& t, int index, cfgCmd& cmd, int log_part, std::vector<Table>& parts) {
+        using namespace part_join_details;
+        const int npart = 1 << log_part;
+        int nscan, maxid;
+        scan_cols(cmd.cmd, index, nscan, maxid);
+        size_t nrow = t.getNumRow();
+        size_t chunk = std::min(nrow, dev_mem / 2 / (4 * (maxid + 1) + (size_t)(1.2 * 4 * nscan)));
+        float f = part_factor(chunk, npart);
+        chunk = std::min(nrow, (size_t)(dev_mem / 2 / (4 * (maxid + 1) + f * 4 * nscan)));
+        if (chunk < std::min(nrow, (size_t)16 * npart)) {
+            printf("ERROR: %ld bytes of device memory are too few for %d partitions.\n", (long)dev_mem, npart);
+            return -1;
+        }
+        int nchunk = (nrow + chunk - 1) / chunk;
+
+        size_t cap = (size_t)(part_factor(nrow, npart) * nrow / npart) + VEC_LEN;
+        std::vector<size_t> fill(npart, 0);
+        parts.clear();
+        for (int p = 0; p < npart; p++) {
+            parts.push_back(Table("part" + std::to_string(index) + "_" + std::to_string(p), cap, nscan, ""));
+            parts.back().allocateHost();
+        }
+
+        Table tin[2], tpart[2];
+        krnlEngine krnl[2];
+        cl::Event evt_w[2], evt_k[2], evt_r[2];
+        for (int s = 0; s < 2 && s < nchunk; s++) {
+            if (nchunk > 1) {
+                tin[s] = Table("chunk" + std::to_string(s), chunk, maxid + 1, "");
+                tin[s].allocateHost();
+                tin[s].allocateDevBuffer(ctx, 32);
+            }
+            tpart[s] = Table("chunk_part" + std::to_string(s), chunk, nscan, "");
+            tpart[s].allocateHost(f, npart);
+            tpart[s].allocateDevBuffer(ctx, 32);
+            krnl[s] = krnlEngine(prog, q, "gqePart");
+        }
+        if (nchunk == 1) t.allocateDevBuffer(ctx, 32);
+
+        // the partitions of chunk k - 2 are gathered while chunk k - 1 runs
+        for (int k = 0; k < nchunk + 2; k++) {
+            int s = k % 2;
+            if (k >= 2) {
+                evt_r[s].wait();
+                for (int p = 0; p < npart; p++) {
+                    int n = part_nrow(tpart[s], p);
+                    if ((size_t)n > part_cap(tpart[s])) {
+                        printf("ERROR: partition %d of a chunk of table %c overflows, keys are too skewed.\n", p,
+                               'A' + index);
+                        q.finish();
+                        return -1;
+                    }
+                    if (fill[p] + n > cap) {
+                        printf("ERROR: partition %d of table %c overflows, keys are too skewed.\n", p, 'A' + index);
+                        q.finish();
+                        return -1;
+                    }
+                    for (int c = 0; c < nscan; c++)
+                        memcpy(col_ptr(parts[p], c) + 4 * fill[p], part_col_ptr(tpart[s], p, c), 4 * (size_t)n);
+                    fill[p] += n;
+                }
+            }
+            if (k >= nchunk) continue;
+
+            Table* src = &t;
+            if (nchunk > 1) {
+                size_t r0 = chunk * k;
+                size_t n = std::min(chunk, nrow - r0);
+                for (int c = 0; c <= maxid; c++) memcpy(col_ptr(tin[s], c), col_ptr(t, c) + 4 * r0, 4 * n);
+                tin[s].setNumRow(n);
+                src = &tin[s];
+            }
+            transEngine trans(q);
+            trans.add(src);
+            trans.host2dev(0, nullptr, &evt_w[s]);
+            std::vector<cl::Event> w(1, evt_w[s]);
+            krnl[s].setup_hp(512, index, log_part, *src, tpart[s], cmd);
+            krnl[s].run(0, &w, &evt_k[s]);
+            transEngine trans_out(q);
+            trans_out.add(&tpart[s]);
+            std::vector<cl::Event> wk(1, evt_k[s]);
+            trans_out.dev2host(0, &wk, &evt_r[s]);
+        }
+        for (int p = 0; p < npart; p++) parts[p].setNumRow(fill[p]);
+        std::cout << "PartJoin: table " << (char)('A' + index) << " partitioned in " << nchunk << " chunks"
+                  << std::endl;
+        return 0;
+    }
+
+   public:
+    //! dev_mem is the device memory the join may use, log_rows the log2 of the
+    //! largest partition gqeJoin is given, 22 as in the demos.
+    PartJoin(cl::Context& context,
+             cl::CommandQueue& clq,
+             cl::Program& program,
+             size_t dev_mem_ = (size_t)16 << 30,
+             int log_rows_ = 22) {
+        ctx = context;
+        q = clq;
+        prog = program;
+        dev_mem = dev_mem_;
+        log_rows = log_rows_;
+    };
+
+    //! tout = spec(ta join tb), returns 0 on success.
+    int join(Table& ta, Table& tb, Table& tout, const JoinSpec& spec) {
+        using namespace part_join_details;
+        cfgCmd pcmd, jcmd;
+        pcmd.allocateHost();
+        jcmd.allocateHost();
+        if (!spec.join_on || gen_join_cmd(spec, pcmd.cmd, jcmd.cmd)) {
+            printf("ERROR: PartJoin needs a valid join spec.\n");
+            return -1;
+        }
+        int nscan[2], maxid[2];
+        scan_cols(pcmd.cmd, 0, nscan[0], maxid[0]);
+        scan_cols(pcmd.cmd, 1, nscan[1], maxid[1]);
+        size_t nrow[2] = {(size_t)ta.getNumRow(), (size_t)tb.getNumRow()};
+        int nout = spec.out.size();
+
+        size_t in_bytes = table_bytes(ta) + table_bytes(tb);
+        size_t part_bytes = (size_t)(1.2 * 4 * (nrow[0] * nscan[0] + nrow[1] * nscan[1]));
+        size_t out_bytes = (size_t)(1.2 * 4 * tout.nrow * nout);
+        int log_part = 1;
+        while (log_part < 8 && ((std::max(nrow[0], nrow[1]) >> log_part) > ((size_t)1 << log_rows) ||
+                                (part_bytes + 2 * out_bytes) >> log_part > dev_mem / 2))
+            log_part++;
+        const int npart = 1 << log_part;
+        if ((std::max(nrow[0], nrow[1]) >> log_part) > ((size_t)1 << log_rows)) {
+            printf("ERROR: %d partitions are not enough for %ld rows.\n", npart, (long)std::max(nrow[0], nrow[1]));
+            return -1;
+        }
+        std::cout << "PartJoin: " << npart << " partitions" << std::endl;
+
+        size_t fill = 0;
+        if (in_bytes + part_bytes + out_bytes <= dev_mem) {
+            // everything fits, partition and join on the device in one go
+            Table pa("pa", nrow[0], nscan[0], ""), pb("pb", nrow[1], nscan[1], ""), po("po", tout.nrow, nout, "");
+            pa.allocateHost(part_factor(nrow[0], npart), npart);
+            pb.allocateHost(part_factor(nrow[1], npart), npart);
+            po.allocateHost(part_factor(tout.nrow, npart), npart);
+            Table* tbs[] = {&ta, &tb, &pa, &pb, &po};
+            for (int i = 0; i < 5; i++) tbs[i]->allocateDevBuffer(ctx, 32);
+            QueryPlan plan(ctx, q, prog);
+            if (plan.partJoin(ta, tb, pa, pb, po, spec, log_part) < 0) return -1;
+            plan.output(po);
+            plan.setup();
+            plan.run();
+            for (int p = 0; p < npart; p++) {
+                int n = part_nrow(po, p);
+                if ((size_t)n > part_cap(po)) {
+                    printf("ERROR: partition %d joins to %d rows, its output holds %ld.\n", p, n, (long)part_cap(po));
+                    return -1;
+                }
+                if (fill + n > tout.nrow) {
+                    printf("ERROR: join result exceeds the %ld rows of %s.\n", (long)tout.nrow, tout.name.c_str());
+                    return -1;
+                }
+                for (int c = 0; c < nout; c++) memcpy(col_ptr(tout, c) + 4 * fill, part_col_ptr(po, p, c), 4 * (size_t)n);
+                fill += n;
+            }
+            tout.setNumRow(fill);
+            return 0;
+        }
+
+        pcmd.allocateDevBuffer(ctx, 32);
+        jcmd.allocateDevBuffer(ctx, 32);
+        transEngine trans_cmd(q);
+        trans_cmd.add(&pcmd);
+        trans_cmd.add(&jcmd);
+        trans_cmd.host2dev(0, nullptr, nullptr);
+        q.finish();
+
+        std::vector<Table> pa, pb;
+        if (partition(ta, 0, pcmd, log_part, pa) || partition(tb, 1, pcmd, log_part, pb)) return -1;
+
+        // stream the pairs, pair i - 2 is read back and appended while pair
+        // i - 1 runs and pair i is sent
+        size_t ocap = std::min(tout.nrow, (size_t)(2 * 1.2 * tout.nrow / npart) + VEC_LEN);
+        Table to[2];
+        for (int s = 0; s < 2; s++) {
+            to[s] = Table("pair_out" + std::to_string(s), ocap, nout, "");
+            to[s].allocateHost();
+            to[s].allocateDevBuffer(ctx, 32);
+        }
+        bufferTmp buftmp(ctx);
+        buftmp.initBuffer(q);
+        q.finish();
+        krnlEngine krnl[2];
+        krnl[0] = krnlEngine(prog, q, "gqeJoin");
+        krnl[1] = krnlEngine(prog, q, "gqeJoin");
+        cl::Event evt_w[2], evt_k[2], evt_r[2];
+        for (int i = 0; i < npart + 2; i++) {
+            int s = i % 2;
+            if (i >= 2) {
+                evt_r[s].wait();
+                // gqeJoin does not bound its output, a larger count means the
+                // pair has already written past to[s]
+                int n = to[s].getNumRow();
+                if ((size_t)n > ocap) {
+                    printf("ERROR: partition pair %d joins to %d rows, its output holds %ld.\n", i - 2, n, (long)ocap);
+                    q.finish();
+                    return -1;
+                }
+                if (append(to[s], n, tout, fill, nout)) {
+                    q.finish();
+                    return -1;
+                }
+                pa[i - 2].buffer = cl::Buffer();
+                pb[i - 2].buffer = cl::Buffer();
+            }
+            if (i >= npart) continue;
+
+            pa[i].allocateDevBuffer(ctx, 32);
+            pb[i].allocateDevBuffer(ctx, 32);
+            transEngine trans(q);
+            trans.add(&pa[i]);
+            trans.add(&pb[i]);
+            std::vector<cl::Event> ww;
+            if (i > 0) ww.push_back(evt_w[1 - s]);
+            trans.host2dev(0, ww.empty() ? nullptr : &ww, &evt_w[s]);
+
+            // pairs share buftmp, so the joins run one after the other
+            std::vector<cl::Event> wk(1, evt_w[s]);
+            if (i > 0) wk.push_back(evt_k[1 - s]);
+            krnl[s].setup(pa[i], pb[i], to[s], jcmd, buftmp);
+            krnl[s].run(0, &wk, &evt_k[s]);
+
+            transEngine trans_out(q);
+            trans_out.add(&to[s]);
+            std::vector<cl::Event> wr(1, evt_k[s]);
+            trans_out.dev2host(0, &wr, &evt_r[s]);
+        }
+        tout.setNumRow(fill);
+        return 0;
+    };
+};
+
+#endif // GQE_PART_JOIN_H
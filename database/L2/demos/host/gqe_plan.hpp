@@ -0,0 +1,344 @@
+/*
+ * Copyright 2019 Xilinx, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef GQE_PLAN_H
+#define GQE_PLAN_H
+
+// QueryPlan strings gqeJoin / gqeAggr / gqePart steps into one device
+// pipeline. Each step is described with a JoinSpec or AggrSpec (see
+// gqe_plan_cfg.hpp), the plan generates the commands, and run() enqueues
+// everything on the out-of-order queue with events derived from the data
+// flow, the same way the hand-written demos chain them:
+//
+//   - input tables are sent in the order the steps first use them, each
+//     transfer after the previous one, so loading overlaps the kernels;
+//   - a step waits for the steps producing its inputs, for the readers of
+//     the table it overwrites, and for the last step on its bufferTmp;
+//   - tables passed to output() are read back when their producer is done.
+//
+// All tables must have host and device buffers before setup(); partitioned
+// tables are allocated with allocateHost(1.2, number of partitions).
+
+#include "gqe_api.hpp"
+#include "gqe_plan_cfg.hpp"
+
+#include <deque>
+#include <map>
+#include <string>
+#include <vector>
+
+class QueryPlan {
+    enum { STEP_JOIN = 0, STEP_AGGR, STEP_PART };
+
+    struct Step {
+        int kind;
+        Table* in[2];
+        Table* out;
+        int sub;   // partition of in/out to work on, -1 for the whole table
+        int index; // gqePart: 0 partitions table A, 1 table B
+        int log_part;
+        int cmd;  // index into cmds, or acmds for gqeAggr
+        int slot; // bufferTmp / AggrBufferTmp slot
+        std::vector<int> dep;
+        cl::Event evt;
+    };
+
+    cl::Context ctx;
+    cl::CommandQueue q;
+    cl::Program prog;
+    int nbuf;
+
+    std::vector<Step> steps;
+    std::deque<cfgCmd> cmds;
+    std::deque<AggrCfgCmd> acmds; // in and out command of each gqeAggr step
+    std::deque<Table> subs;
+    std::vector<krnlEngine> jkrnl;
+    std::vector<AggrKrnlEngine> akrnl;
+    std::vector<bufferTmp*> buf;
+    std::vector<AggrBufferTmp*> abuf;
+    std::vector<Table*> outs;
+
+    // data flow tracking, per table: last writers and readers since then
+    std::map<Table*, std::vector<int> > writers;
+    std::map<Table*, std::vector<int> > readers;
+    int last_slot[2][8];
+    int nslot[2];
+
+    std::vector<cl::Event> h2d_evt;
+    std::vector<cl::Event> d2h_evt;
+
+    static void depend(Step& s, int id) {
+        for (size_t i = 0; i < s.dep.size(); i++)
+            if (s.dep[i] == id) return;
+        s.dep.push_back(id);
+    }
+
+    static void depend(Step& s, const std::vector<int>& ids) {
+        for (size_t i = 0; i < ids.size(); i++) depend(s, ids[i]);
+    }
+
+    // orders s after the previous step on its temporary buffers and after the
+    // steps producing its inputs, then records it as a reader of them
+    void prepare(Step& s, Table* a, Table* b) {
+        int k = s.kind == STEP_AGGR ? 1 : 0;
+        if (s.kind != STEP_PART) {
+            s.slot = nslot[k]++ % nbuf;
+            if (last_slot[k][s.slot] >= 0) depend(s, last_slot[k][s.slot]);
+            last_slot[k][s.slot] = steps.size();
+        }
+        depend(s, writers[a]);
+        readers[a].push_back(steps.size());
+        if (b) {
+            depend(s, writers[b]);
+            readers[b].push_back(steps.size());
+        }
+    }
+
+    int add(Step& s, Table* a, Table* b, Table* out) {
+        prepare(s, a, b);
+        depend(s, writers[out]);
+        depend(s, readers[out]);
+        readers[out].clear();
+        writers[out] = std::vector<int>(1, steps.size());
+        steps.push_back(s);
+        return steps.size() - 1;
+    }
+
+    Step step(int kind, Table* a, Table* b, Table* out, int cmd) {
+        Step s;
+        s.kind = kind;
+        s.in[0] = a;
+        s.in[1] = b;
+        s.out = out;
+        s.sub = -1;
+        s.index = 0;
+        s.log_part = 0;
+        s.cmd = cmd;
+        s.slot = 0;
+        return s;
+    }
+
+   public:
+    //! nbuf bufferTmp sets are used in turn by the join (and aggregate) steps.
+    //! Each set takes 16 HBM buffers of HT_BUFF_DEPTH / S_BUFF_DEPTH words, so
+    //! more than one only fits with smaller buffer depths.
+    QueryPlan(cl::Context& context, cl::CommandQueue& clq, cl::Program& program, int nbuf_ = 1) {
+        ctx = context;
+        q = clq;
+        prog = program;
+        nbuf = nbuf_ < 1 ? 1 : (nbuf_ > 8 ? 8 : nbuf_);
+        nslot[0] = nslot[1] = 0;
+        for (int i = 0; i < 8; i++) last_slot[0][i] = last_slot[1][i] = -1;
+    };
+
+    ~QueryPlan() {
+        for (size_t i = 0; i < buf.size(); i++) delete buf[i];
+        for (size_t i = 0; i < abuf.size(); i++) delete abuf[i];
+    };
+
+    //! Adds a gqeJoin step, tout = spec(ta join tb), returns the step id or -1.
+    int join(Table& ta, Table& tb, Table& tout, const JoinSpec& spec) {
+        cmds.push_back(cfgCmd());
+        cmds.back().allocateHost();
+        if (gen_join_cmd(spec, cmds.back().cmd)) return -1;
+        Step s = step(STEP_JOIN, &ta, &tb, &tout, cmds.size() - 1);
+        return add(s, &ta, &tb, &tout);
+    };
+
+    //! Adds a gqeJoin step with join off: tout = filter and ALUs of spec on tin.
+    int filter(Table& tin, Table& tout, const JoinSpec& spec) {
+        JoinSpec f = spec;
+        f.join_on = false;
+        cmds.push_back(cfgCmd());
+        cmds.back().allocateHost();
+        if (gen_join_cmd(f, cmds.back().cmd)) return -1;
+        // table B is not scanned with join off, tin stands in for it
+        Step s = step(STEP_JOIN, &tin, &tin, &tout, cmds.size() - 1);
+        return add(s, &tin, 0, &tout);
+    };
+
+    //! Adds a gqeAggr step, tout = spec(tin), see aggr_layout() for its columns.
+    int aggregate(Table& tin, Table& tout, const AggrSpec& spec) {
+        acmds.push_back(AggrCfgCmd());
+        acmds.back().allocateHost();
+        if (gen_aggr_cmd(spec, acmds.back().cmd)) return -1;
+        acmds.push_back(AggrCfgCmd());
+        acmds.back().allocateHost();
+        Step s = step(STEP_AGGR, &tin, 0, &tout, acmds.size() - 2);
+        return add(s, &tin, 0, &tout);
+    };
+
+    //! Adds a partitioned join: gqePart splits ta into pa and tb into pb by
+    //! key, then one gqeJoin step per partition writes partition i of tout.
+    //! pa, pb and tout have 1 << log_part partitions. Returns the id of the
+    //! last step or -1.
+    int partJoin(Table& ta, Table& tb, Table& pa, Table& pb, Table& tout, const JoinSpec& spec, int log_part) {
+        if (!spec.join_on) {
+            printf("ERROR: partitioned join needs join on.\n");
+            return -1;
+        }
+        cmds.push_back(cfgCmd());
+        cmds.back().allocateHost();
+        cmds.push_back(cfgCmd());
+        cmds.back().allocateHost();
+        int c = cmds.size() - 2;
+        if (gen_join_cmd(spec, cmds[c].cmd, cmds[c + 1].cmd)) return -1;
+
+        Step s = step(STEP_PART, &ta, 0, &pa, c);
+        s.log_part = log_part;
+        add(s, &ta, 0, &pa);
+        s = step(STEP_PART, &tb, 0, &pb, c);
+        s.index = 1;
+        s.log_part = log_part;
+        add(s, &tb, 0, &pb);
+
+        // the partitions of tout are disjoint, the joins only wait for the
+        // earlier users of tout and can overlap each other
+        std::vector<int> prior = writers[&tout];
+        prior.insert(prior.end(), readers[&tout].begin(), readers[&tout].end());
+        readers[&tout].clear();
+        writers[&tout].clear();
+        for (int i = 0; i < (1 << log_part); i++) {
+            s = step(STEP_JOIN, &pa, &pb, &tout, c + 1);
+            s.sub = i;
+            prepare(s, &pa, &pb);
+            depend(s, prior);
+            writers[&tout].push_back(steps.size());
+            steps.push_back(s);
+        }
+        return steps.size() - 1;
+    };
+
+    //! Reads tout back to host memory at the end of run().
+    void output(Table& tout) { outs.push_back(&tout); };
+
+    //! Allocates the command and temporary buffers and creates the kernels.
+    int setup() {
+        for (size_t i = 0; i < cmds.size(); i++) cmds[i].allocateDevBuffer(ctx, 32);
+        for (size_t i = 0; i < acmds.size(); i++) acmds[i].allocateDevBuffer(ctx, 32);
+
+        jkrnl.resize(steps.size());
+        akrnl.resize(steps.size());
+        for (size_t i = 0; i < steps.size(); i++) {
+            Step& s = steps[i];
+            if (s.kind == STEP_JOIN) {
+                while ((int)buf.size() <= s.slot) {
+                    buf.push_back(new bufferTmp(ctx));
+                    buf.back()->initBuffer(q);
+                }
+                jkrnl[i] = krnlEngine(prog, q, "gqeJoin");
+                if (s.sub >= 0) {
+                    subs.push_back(s.in[0]->createSubTable(s.sub));
+                    Table& a = subs.back();
+                    subs.push_back(s.in[1]->createSubTable(s.sub));
+                    Table& b = subs.back();
+                    subs.push_back(s.out->createSubTable(s.sub));
+                    jkrnl[i].setup(a, b, subs.back(), cmds[s.cmd], *buf[s.slot]);
+                } else {
+                    jkrnl[i].setup(*s.in[0], *s.in[1], *s.out, cmds[s.cmd], *buf[s.slot]);
+                }
+            } else if (s.kind == STEP_PART) {
+                jkrnl[i] = krnlEngine(prog, q, "gqePart");
+                jkrnl[i].setup_hp(512, s.index, s.log_part, *s.in[0], *s.out, cmds[s.cmd]);
+            } else {
+                while ((int)abuf.size() <= s.slot) {
+                    abuf.push_back(new AggrBufferTmp(ctx));
+                    abuf.back()->BufferInitial(q);
+                }
+                akrnl[i] = AggrKrnlEngine(prog, q, "gqeAggr");
+                akrnl[i].setup(*s.in[0], *s.out, acmds[s.cmd], acmds[s.cmd + 1], *abuf[s.slot]);
+            }
+        }
+        q.finish();
+        std::cout << "QueryPlan: " << steps.size() << " steps have been setup" << std::endl;
+        return 0;
+    };
+
+    //! Runs all steps and waits for the outputs.
+    int run() {
+        h2d_evt.clear();
+        d2h_evt.clear();
+        std::map<Table*, bool> sent;
+        for (size_t i = 0; i < steps.size(); i++) {
+            Step& s = steps[i];
+            transEngine trans(q);
+            bool any = false;
+            if (i == 0) {
+                for (size_t c = 0; c < cmds.size(); c++) trans.add(&cmds[c]);
+                for (size_t c = 0; c < acmds.size(); c += 2) trans.add(&acmds[c]);
+                any = true;
+            }
+            int nin = s.kind == STEP_JOIN && s.in[1] != s.in[0] ? 2 : 1;
+            for (int k = 0; k < nin; k++) {
+                Table* t = s.in[k];
+                if (!sent[t] && source(t, i)) {
+                    trans.add(t);
+                    sent[t] = true;
+                    any = true;
+                }
+            }
+            if (any) {
+                cl::Event e;
+                std::vector<cl::Event> w;
+                if (!h2d_evt.empty()) w.push_back(h2d_evt.back());
+                trans.host2dev(0, w.empty() ? nullptr : &w, &e);
+                h2d_evt.push_back(e);
+            }
+
+            std::vector<cl::Event> w;
+            w.push_back(h2d_evt.back());
+            for (size_t d = 0; d < s.dep.size(); d++) w.push_back(steps[s.dep[d]].evt);
+            if (s.kind == STEP_AGGR)
+                akrnl[i].run(0, &w, &s.evt);
+            else
+                jkrnl[i].run(0, &w, &s.evt);
+        }
+
+        for (size_t o = 0; o < outs.size(); o++) {
+            std::vector<cl::Event> w;
+            for (size_t i = 0; i < steps.size(); i++)
+                if (steps[i].out == outs[o]) w.push_back(steps[i].evt);
+            if (w.empty()) continue;
+            transEngine trans(q);
+            trans.add(outs[o]);
+            cl::Event e;
+            trans.dev2host(0, &w, &e);
+            d2h_evt.push_back(e);
+        }
+        q.finish();
+        return 0;
+    };
+
+    //! Prints the device time of each step of the last run().
+    void printTime() {
+        if (h2d_evt.empty()) return;
+        cl_ulong kstart;
+        h2d_evt[0].getProfilingInfo(CL_PROFILING_COMMAND_START, &kstart);
+        const char* kname[] = {"gqeJoin", "gqeAggr", "gqePart"};
+        for (size_t i = 0; i < steps.size(); i++)
+            print_d_time(steps[i].evt, steps[i].evt, kstart, "step " + std::to_string(i) + " " + kname[steps[i].kind]);
+        if (!d2h_evt.empty()) print_d_time(h2d_evt[0], d2h_evt.back(), kstart, "all steps");
+    };
+
+   private:
+    // true when t is not produced by any step before step i
+    bool source(Table* t, size_t i) {
+        for (size_t j = 0; j < i; j++)
+            if (steps[j].out == t) return false;
+        return true;
+    }
+};
+
+#endif // GQE_PLAN_H
@@ -0,0 +1,477 @@
+/*
+ * Copyright 2019 Xilinx, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef GQE_PLAN_CFG_H
+#define GQE_PLAN_CFG_H
+
+// Generates the gqeJoin / gqePart command words (9 x 512b) and the gqeAggr
+// command words (128 x 32b) from a declarative description of one step, so
+// that queries do not need a hand-written cfg.hpp.
+//
+// Columns are referred to by where they come from: a_col(i) / b_col(i) are
+// column i of table A (build side, or the only input) and table B (probe
+// side), key_col(k) is join key k, eval0_col() / eval1_col() are the results
+// of the two dynamic ALUs. The generators lay the columns out through the
+// scan, shuffle and ALU stages and fill in the matching shuffle configs.
+
+#include "ap_int.h"
+
+#include "xf_database/dynamic_alu_host.hpp"
+#include "xf_database/enums.hpp"
+
+#include <stdint.h>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+enum { PLAN_A = 0, PLAN_B, PLAN_KEY, PLAN_EVAL0, PLAN_EVAL1 };
+
+struct PlanCol {
+    int src;
+    int col;
+    bool operator==(const PlanCol& o) const { return src == o.src && col == o.col; }
+};
+
+inline PlanCol a_col(int c) {
+    return PlanCol{PLAN_A, c};
+}
+inline PlanCol b_col(int c) {
+    return PlanCol{PLAN_B, c};
+}
+inline PlanCol key_col(int k) {
+    return PlanCol{PLAN_KEY, k};
+}
+inline PlanCol eval0_col() {
+    return PlanCol{PLAN_EVAL0, 0};
+}
+inline PlanCol eval1_col() {
+    return PlanCol{PLAN_EVAL1, 0};
+}
+
+// one filter condition, passes when (lo lop col) and (col rop hi), e.g.
+// {col, 19940101, FOP_GEU, 19950101, FOP_LTU} for a half-open date range.
+struct PlanCond {
+    PlanCol col;
+    uint32_t lo;
+    int lop;
+    uint32_t hi;
+    int rop;
+};
+
+// dynamic ALU, in[k] feeds strm(k+1) of expr, c[] are its constants and
+// scale the output scaling, which only gqeAggr supports
+struct PlanEval {
+    std::string expr;
+    int32_t c[4];
+    int scale;
+    std::vector<PlanCol> in;
+
+    PlanEval() : scale(0) { memset(c, 0, sizeof(c)); }
+    PlanEval(const std::string& e, std::vector<PlanCol> i, int32_t c1 = 0, int32_t c2 = 0, int32_t c3 = 0,
+             int32_t c4 = 0, int s = 0)
+        : expr(e), scale(s), in(i) {
+        c[0] = c1;
+        c[1] = c2;
+        c[2] = c3;
+        c[3] = c4;
+    }
+};
+
+struct JoinSpec {
+    bool join_on;               // false runs table A through filter and ALUs only
+    int type;                   // 0 for normal, 1 for semi, 2 for anti
+    std::vector<int> key_a;     // one or two key columns of table A
+    std::vector<int> key_b;     // the matching key columns of table B
+    std::vector<PlanCond> cond; // at most 4 per table, on a_col / b_col
+    PlanEval eval[2];
+    std::vector<PlanCol> out; // at most 8 output columns, in order
+
+    JoinSpec() : join_on(true), type(0) {}
+};
+
+struct AggrPld {
+    PlanCol col;
+    int op; // xf::database::enums::AggregateOp
+};
+
+struct AggrSpec {
+    std::vector<PlanCond> cond; // at most 4, on a_col / eval0_col / eval1_col
+    PlanEval eval[2];
+    std::vector<PlanCol> key; // at most 8 group keys
+    std::vector<AggrPld> pld; // at most 8 aggregated payloads
+};
+
+// where the aggregate results land in the output table: pld j is column j
+// (average, sum low word, count, min or max), group key k is column 8 + k,
+// and the high word of a sum or average on pld j is column 8 + j when that
+// column is not taken by key j, -1 otherwise.
+struct AggrLayout {
+    int key[8];
+    int pld[8];
+    int pld_hi[8];
+};
+
+namespace plan_details {
+
+inline int find_col(const std::vector<PlanCol>& v, const PlanCol& c) {
+    for (size_t i = 0; i < v.size(); i++)
+        if (v[i] == c) return i;
+    return -1;
+}
+
+inline void add_col(std::vector<PlanCol>& v, const PlanCol& c) {
+    if (find_col(v, c) < 0) v.push_back(c);
+}
+
+inline bool has_eval(const PlanEval& e) {
+    return !e.expr.empty();
+}
+
+// shuffle config selecting lanes lane[0..n-1], -1 for the unused ones
+inline ap_int<64> shuffle_cfg(const std::vector<int>& lane) {
+    ap_int<64> s;
+    for (int i = 0; i < 8; i++) s(8 * i + 7, 8 * i) = i < (int)lane.size() ? lane[i] : -1;
+    return s;
+}
+
+// maps each column of dst to its lane in src, where src_eval sits at lane 8
+inline int map_lanes(const std::vector<PlanCol>& src,
+                     const PlanCol& src_eval,
+                     const std::vector<PlanCol>& dst,
+                     std::vector<int>& lane,
+                     const char* stage) {
+    lane.clear();
+    for (size_t i = 0; i < dst.size(); i++) {
+        int l = dst[i] == src_eval ? 8 : find_col(src, dst[i]);
+        if (l < 0) {
+            printf("ERROR: plan column (%d, %d) is not available at %s.\n", dst[i].src, dst[i].col, stage);
+            return -1;
+        }
+        lane.push_back(l);
+    }
+    return 0;
+}
+
+inline int compile_eval(const PlanEval& e, ap_uint<289>& op) {
+    op = 0;
+    if (!has_eval(e)) return 0;
+    if (!xf::database::dynamicALUOPCompiler<uint32_t, uint32_t, uint32_t, uint32_t>(e.expr.c_str(), e.c[0], e.c[1],
+                                                                                    e.c[2], e.c[3], op)) {
+        printf("ERROR: failed to compile %s.\n", e.expr.c_str());
+        return -1;
+    }
+    return 0;
+}
+
+// filter config for conditions on lanes 0..3 of lanes, all ANDed
+inline int gen_fcfg(const std::vector<PlanCond>& cond, const std::vector<PlanCol>& lanes, uint32_t cfg[45]) {
+    using namespace xf::database;
+    memset(cfg, 0, sizeof(uint32_t) * 45);
+    for (int c = 0; c < 4; c++) cfg[3 * c + 2] = 0UL | (FOP_DC << FilterOpWidth) | (FOP_DC);
+    for (size_t i = 0; i < cond.size(); i++) {
+        int l = find_col(lanes, cond[i].col);
+        if (l < 0 || l > 3) {
+            printf("ERROR: filter column (%d, %d) is not in the first 4 lanes.\n", cond[i].col.src, cond[i].col.col);
+            return -1;
+        }
+        if (cfg[3 * l + 2] != 0UL) {
+            printf("ERROR: more than one condition on filter lane %d.\n", l);
+            return -1;
+        }
+        cfg[3 * l] = cond[i].lo;
+        cfg[3 * l + 1] = cond[i].hi;
+        cfg[3 * l + 2] = 0UL | (cond[i].lop << FilterOpWidth) | (cond[i].rop);
+    }
+    // no var-var comparison, only the all-true entry of the truth table
+    cfg[12] = 0;
+    cfg[44] = (uint32_t)(1UL << 31);
+    return 0;
+}
+
+// a table column used as join key is carried by the key lanes of the join
+inline PlanCol join_col(const JoinSpec& s, const PlanCol& c) {
+    for (size_t k = 0; s.join_on && k < s.key_a.size(); k++)
+        if (c == PlanCol{PLAN_A, s.key_a[k]} || c == PlanCol{PLAN_B, s.key_b[k]}) return key_col(k);
+    return c;
+}
+
+// scan layout of one join input: keys, filtered columns, then the payload
+inline int join_scan(const JoinSpec& s, int src, std::vector<PlanCol>& scan, int& npld) {
+    const std::vector<int>& key = src == PLAN_A ? s.key_a : s.key_b;
+    scan.clear();
+    for (size_t k = 0; s.join_on && k < key.size(); k++) scan.push_back(PlanCol{src, key[k]});
+    size_t nkey = scan.size();
+    for (size_t i = 0; i < s.cond.size(); i++)
+        if (s.cond[i].col.src == src) add_col(scan, s.cond[i].col);
+    for (int e = 0; e < 2; e++)
+        for (size_t i = 0; i < s.eval[e].in.size(); i++)
+            if (s.eval[e].in[i].src == src) add_col(scan, s.eval[e].in[i]);
+    for (size_t i = 0; i < s.out.size(); i++)
+        if (s.out[i].src == src) add_col(scan, s.out[i]);
+    npld = scan.size() - nkey;
+    int max_pld = s.join_on ? (nkey == 2 ? 5 : 6) : 8;
+    if (npld > max_pld) {
+        printf("ERROR: table %c needs %d payload columns, at most %d are supported.\n", 'A' + src, npld, max_pld);
+        return -1;
+    }
+    return 0;
+}
+
+} // plan_details
+
+//! Generates the gqeJoin command for spec into b[9]. For a partitioned join,
+//! also pass join_b: b then is the gqePart command (column ids and filters of
+//! the original tables) and join_b the gqeJoin command for the partitions.
+inline int gen_join_cmd(const JoinSpec& s, ap_uint<512>* b, ap_uint<512>* join_b = 0) {
+    using namespace plan_details;
+    memset(b, 0, sizeof(ap_uint<512>) * 9);
+    if (s.join_on && (s.key_a.empty() || s.key_a.size() > 2 || s.key_a.size() != s.key_b.size())) {
+        printf("ERROR: join needs one or two key columns on both tables.\n");
+        return -1;
+    }
+    if (s.out.empty() || s.out.size() > 8) {
+        printf("ERROR: %d output columns, 1 to 8 are supported.\n", (int)s.out.size());
+        return -1;
+    }
+    for (int e = 0; e < 2; e++) {
+        if (s.eval[e].in.size() > 4) {
+            printf("ERROR: %s takes %d inputs, the ALU has 4.\n", s.eval[e].expr.c_str(), (int)s.eval[e].in.size());
+            return -1;
+        }
+    }
+    for (size_t i = 0; i < s.cond.size(); i++) {
+        if (s.cond[i].col.src != PLAN_A && (s.cond[i].col.src != PLAN_B || !s.join_on)) {
+            printf("ERROR: filters apply to columns of the input tables only.\n");
+            return -1;
+        }
+    }
+
+    std::vector<PlanCol> scan[2];
+    int npld[2] = {0, 0};
+    if (join_scan(s, PLAN_A, scan[0], npld[0])) return -1;
+    if (s.join_on && join_scan(s, PLAN_B, scan[1], npld[1])) return -1;
+
+    // stage 2, after the join: eval0 reads lanes 0..3
+    std::vector<PlanCol> st2;
+    for (size_t i = 0; i < s.eval[0].in.size(); i++) st2.push_back(join_col(s, s.eval[0].in[i]));
+    for (size_t i = 0; i < s.eval[1].in.size(); i++)
+        if (!(s.eval[1].in[i] == eval0_col())) add_col(st2, join_col(s, s.eval[1].in[i]));
+    for (size_t i = 0; i < s.out.size(); i++)
+        if (s.out[i].src != PLAN_EVAL0 && s.out[i].src != PLAN_EVAL1) add_col(st2, join_col(s, s.out[i]));
+    // stage 3, after eval0: eval1 reads lanes 0..3
+    std::vector<PlanCol> st3, out;
+    for (size_t i = 0; i < s.eval[1].in.size(); i++) st3.push_back(join_col(s, s.eval[1].in[i]));
+    for (size_t i = 0; i < s.out.size(); i++) out.push_back(join_col(s, s.out[i]));
+    for (size_t i = 0; i < out.size(); i++)
+        if (!(out[i] == eval1_col())) add_col(st3, out[i]);
+    if (st2.size() > 8 || st3.size() > 8) {
+        printf("ERROR: more than 8 columns are needed after the join.\n");
+        return -1;
+    }
+
+    std::vector<int> l1a, l1b, l2, l3, l4;
+    if (s.join_on) {
+        // the join emits table B payload on lanes 0..5, table A payload on
+        // lanes 6..11 and the keys on lanes 12..13
+        int nkey = s.key_a.size();
+        std::vector<PlanCol> jn(14, PlanCol{-1, -1});
+        for (int i = 0; i < npld[1]; i++) jn[i] = scan[1][nkey + i];
+        for (int i = 0; i < npld[0]; i++) jn[6 + i] = scan[0][nkey + i];
+        for (int k = 0; k < nkey; k++) jn[12 + k] = key_col(k);
+        for (size_t i = 0; i < scan[0].size(); i++) l1a.push_back(i);
+        for (size_t i = 0; i < scan[1].size(); i++) l1b.push_back(i);
+        if (map_lanes(jn, PlanCol{-1, -1}, st2, l2, "the join")) return -1;
+    } else {
+        // no join: shuffle1a builds stage 2 directly from the scan
+        if (map_lanes(scan[0], PlanCol{-1, -1}, st2, l1a, "the scan")) return -1;
+    }
+    if (map_lanes(st2, eval0_col(), st3, l3, "the first ALU")) return -1;
+    if (map_lanes(st3, eval1_col(), out, l4, "the second ALU")) return -1;
+
+    ap_uint<512> t = s.join_on ? 1 : 0;
+    t.set_bit(1, 0);                                // aggr off
+    t.set_bit(2, s.join_on && s.key_a.size() == 2); // dual-key
+    t.range(5, 3) = s.type;                         // 0 for normal, 1 for semi, 2 for anti
+    for (int c = 0; c < 8; ++c) {
+        t.range(56 + 8 * c + 7, 56 + 8 * c) = c < (int)scan[0].size() ? scan[0][c].col : -1;
+        t.range(120 + 8 * c + 7, 120 + 8 * c) = c < (int)scan[1].size() ? scan[1][c].col : -1;
+    }
+    t.range(191, 184) = (1 << out.size()) - 1;
+    t.range(255, 192) = shuffle_cfg(l1a);
+    t.range(319, 256) = shuffle_cfg(l1b);
+    t.range(383, 320) = shuffle_cfg(l2);
+    t.range(447, 384) = shuffle_cfg(l3);
+    t.range(511, 448) = shuffle_cfg(l4);
+    b[0] = t;
+
+    ap_uint<289> op;
+    if (compile_eval(s.eval[0], op)) return -1;
+    b[1] = op;
+    if (compile_eval(s.eval[1], op)) return -1;
+    b[2] = op;
+
+    std::vector<PlanCond> cond[2];
+    for (size_t i = 0; i < s.cond.size(); i++) cond[s.cond[i].col.src].push_back(s.cond[i]);
+    uint32_t cfg[45];
+    if (gen_fcfg(cond[0], scan[0], cfg)) return -1;
+    memcpy(&b[3], cfg, sizeof(uint32_t) * 45);
+    if (gen_fcfg(cond[1], scan[1], cfg)) return -1;
+    memcpy(&b[6], cfg, sizeof(uint32_t) * 45);
+
+    if (join_b) {
+        // partitions hold the scanned columns in scan order and are already
+        // filtered, so the join reads them by position without filters
+        memcpy(join_b, b, sizeof(ap_uint<512>) * 9);
+        for (int c = 0; c < 8; ++c) {
+            join_b[0].range(56 + 8 * c + 7, 56 + 8 * c) = c < (int)scan[0].size() ? c : -1;
+            join_b[0].range(120 + 8 * c + 7, 120 + 8 * c) = c < (int)scan[1].size() ? c : -1;
+        }
+        gen_fcfg(std::vector<PlanCond>(), scan[0], cfg);
+        memcpy(&join_b[3], cfg, sizeof(uint32_t) * 45);
+        memcpy(&join_b[6], cfg, sizeof(uint32_t) * 45);
+    }
+    return 0;
+}
+
+//! Result columns of gen_aggr_cmd for spec.
+inline AggrLayout aggr_layout(const AggrSpec& s) {
+    using namespace xf::database::enums;
+    AggrLayout o;
+    for (int i = 0; i < 8; i++) {
+        o.key[i] = i < (int)s.key.size() ? 8 + i : -1;
+        o.pld[i] = i < (int)s.pld.size() ? i : -1;
+        bool wide = i < (int)s.pld.size() && (s.pld[i].op == AOP_SUM || s.pld[i].op == AOP_MEAN);
+        o.pld_hi[i] = wide && i >= (int)s.key.size() ? 8 + i : -1;
+    }
+    return o;
+}
+
+//! Generates the gqeAggr command for spec into config[128].
+inline int gen_aggr_cmd(const AggrSpec& s, ap_uint<32>* config) {
+    using namespace plan_details;
+    using namespace xf::database::enums;
+    memset(config, 0, sizeof(ap_uint<32>) * 128);
+    if (s.key.empty() || s.key.size() > 8 || s.pld.empty() || s.pld.size() > 8 || s.cond.size() > 4) {
+        printf("ERROR: aggregate takes 1 to 8 keys, 1 to 8 payloads and at most 4 conditions.\n");
+        return -1;
+    }
+
+    // columns needed after the scan, the first ALU reads lanes 0..3
+    std::vector<PlanCol> scan = s.eval[0].in;
+    std::vector<PlanCol> need;
+    for (size_t i = 0; i < s.eval[1].in.size(); i++) add_col(need, s.eval[1].in[i]);
+    for (size_t i = 0; i < s.cond.size(); i++) add_col(need, s.cond[i].col);
+    for (size_t i = 0; i < s.key.size(); i++) add_col(need, s.key[i]);
+    for (size_t i = 0; i < s.pld.size(); i++) add_col(need, s.pld[i].col);
+    for (size_t i = 0; i < need.size(); i++)
+        if (need[i].src == PLAN_A) add_col(scan, need[i]);
+    if (scan.size() > 8) {
+        printf("ERROR: aggregate reads %d columns, at most 8 are supported.\n", (int)scan.size());
+        return -1;
+    }
+    for (size_t i = 0; i < scan.size(); i++) {
+        if (scan[i].src != PLAN_A) {
+            printf("ERROR: the first ALU reads table columns only.\n");
+            return -1;
+        }
+    }
+
+    // after eval0: eval1 inputs first, then the rest
+    std::vector<PlanCol> st1 = s.eval[1].in;
+    for (size_t i = 0; i < need.size(); i++)
+        if (!(need[i] == eval1_col())) add_col(st1, need[i]);
+    // after eval1: filtered columns first, then keys and payloads
+    std::vector<PlanCol> st2;
+    for (size_t i = 0; i < s.cond.size(); i++) st2.push_back(s.cond[i].col);
+    for (size_t i = 0; i < s.key.size(); i++) add_col(st2, s.key[i]);
+    for (size_t i = 0; i < s.pld.size(); i++) add_col(st2, s.pld[i].col);
+    if (st1.size() > 8 || st2.size() > 8) {
+        printf("ERROR: more than 8 columns are needed after the ALUs.\n");
+        return -1;
+    }
+
+    std::vector<int> l1, l2, l3, l4;
+    if (map_lanes(scan, eval0_col(), st1, l1, "the first ALU")) return -1;
+    if (map_lanes(st1, eval1_col(), st2, l2, "the second ALU")) return -1;
+    if (map_lanes(st2, PlanCol{-1, -1}, s.key, l3, "the filter")) return -1;
+    std::vector<PlanCol> pld;
+    for (size_t i = 0; i < s.pld.size(); i++) pld.push_back(s.pld[i].col);
+    if (map_lanes(st2, PlanCol{-1, -1}, pld, l4, "the filter")) return -1;
+
+    ap_uint<32> t = 0;
+    for (int c = 0; c < 8; ++c) {
+        t.range(8 * (c % 4) + 7, 8 * (c % 4)) = c < (int)scan.size() ? scan[c].col : -1;
+        if (c % 4 == 3) config[c / 4] = t;
+    }
+
+    ap_uint<289> op;
+    if (compile_eval(s.eval[0], op)) return -1;
+    for (int i = 0; i < 9; i++) config[i + 2] = op(32 * (i + 1) - 1, 32 * i);
+    config[11][0] = op[288];
+    config[11](3, 1) = s.eval[0].scale;
+    if (compile_eval(s.eval[1], op)) return -1;
+    for (int i = 0; i < 9; i++) config[i + 12] = op(32 * (i + 1) - 1, 32 * i);
+    config[21][0] = op[288];
+    config[21](3, 1) = s.eval[1].scale;
+
+    uint32_t fcfg[45];
+    if (gen_fcfg(s.cond, st2, fcfg)) return -1;
+    memcpy(&config[22], fcfg, sizeof(uint32_t) * 45);
+
+    ap_int<64> sh;
+    sh = shuffle_cfg(l1);
+    config[67] = sh(31, 0);
+    config[68] = sh(63, 32);
+    sh = shuffle_cfg(l2);
+    config[69] = sh(31, 0);
+    config[70] = sh(63, 32);
+    sh = shuffle_cfg(l3);
+    config[71] = sh(31, 0);
+    config[72] = sh(63, 32);
+    sh = shuffle_cfg(l4);
+    config[73] = sh(31, 0);
+    config[74] = sh(63, 32);
+
+    ap_uint<32> aggr_op = 0;
+    for (size_t i = 0; i < s.pld.size(); i++) aggr_op.range(4 * i + 3, 4 * i) = s.pld[i].op;
+    config[75] = aggr_op;
+    config[76] = s.key.size();
+    config[77] = s.pld.size();
+    config[78] = 0; // aggr num
+
+    // column merge, see AggrLayout: pld j takes column j from pld0 (count,
+    // min, max) or pld1 (sum, average low word), column 8 + j takes key j or
+    // the high word from pld2
+    AggrLayout o = aggr_layout(s);
+    ap_uint<8> key_to_hi = 0, pld0_to_lo = 0;
+    ap_uint<16> wr = 0;
+    for (int j = 0; j < 8; j++) {
+        if (o.pld[j] >= 0) {
+            int aop = s.pld[j].op;
+            if (aop != AOP_SUM && aop != AOP_MEAN) pld0_to_lo[j] = 1;
+            wr[j] = 1;
+        }
+        if (o.key[j] >= 0) key_to_hi[j] = 1;
+        if (o.key[j] >= 0 || o.pld_hi[j] >= 0) wr[8 + j] = 1;
+    }
+    config[79] = (ap_uint<8>(0), key_to_hi, ap_uint<8>(0), ap_uint<8>(0));
+    config[80] = (ap_uint<16>(0), ap_uint<8>(0), pld0_to_lo);
+    config[81] = 0; // hash mode, no direct aggregate
+    config[82] = wr;
+    return 0;
+}
+
+#endif // GQE_PLAN_CFG_H
@@ -13,30 +13,16 @@
  * See the License for the specific language governing permissions and
  * limitations under the License.
  */
+#include "cpu_ops.hpp"
 // l_returnflag, l_linestatus, l_quantity  l_extendedprice l_discount l_tax l_shipdate
 void q1FilterL(Table& tin, Table& tout) {
-    int r = 0;
     int nrow = tin.getNumRow();
-    for (int i = 0; i < nrow; ++i) {
-        int32_t l_shipdate = tin.getInt32(i, 6);
-        // if(i<10) std::cout<<std::dec<<l_shipdate<<std::endl;
-        if (l_shipdate <= 19980902) {
-            int32_t l_returnflag = tin.getInt32(i, 0);
-            int32_t l_linestatus = tin.getInt32(i, 1);
-            int32_t l_quantity = tin.getInt32(i, 2);
-            int32_t l_extendedprice = tin.getInt32(i, 3);
-            int32_t l_discount = tin.getInt32(i, 4);
-            int32_t l_tax = tin.getInt32(i, 5);
-            tout.setInt32(r, 0, l_returnflag);
-            tout.setInt32(r, 1, l_linestatus);
-            tout.setInt32(r, 2, l_quantity);
-            tout.setInt32(r, 3, l_extendedprice);
-            tout.setInt32(r, 4, l_discount);
-            tout.setInt32(r, 5, l_tax);
-            tout.setInt32(r, 6, l_shipdate);
-            ++r;
-        }
-    }
+    const int32_t* l_shipdate = tin.getColPtr<int32_t>(6);
+    auto pred = [&](int i) { return l_shipdate[i] <= 19980902; };
+    auto emit = [&](int r, int i) {
+        for (int c = 0; c < 7; c++) tout.setInt32(r, c, tin.getInt32(i, c));
+    };
+    int r = cpu_ops::parallelFilter(nrow, pred, emit);
     tout.setNumRow(r);
     std::cout << std::dec << r << " in q1FilterL" << std::endl;
 }
@@ -71,35 +57,29 @@ struct Q1GroupValue {
 };
 
 void q1GroupBy(Table& tin, Table& tout) {
-    std::unordered_map<Q1GroupKey, Q1GroupValue> m;
-
     int nrow = tin.getNumRow();
-    for (int i = 0; i < nrow; ++i) {
-        int32_t l_returnflag = tin.getInt32(i, 0);
-        int32_t l_linestatus = tin.getInt32(i, 1);
-        int32_t l_quantity = tin.getInt32(i, 2); // index much patMatch YAML
-        int32_t l_extendedprice = tin.getInt32(i, 3);
-        int32_t l_discount = tin.getInt32(i, 4);
-        int32_t l_tax = tin.getInt32(i, 5);
-
-        int32_t eval0 = l_extendedprice * (100 - l_discount);
-        int64_t eval1 = eval0 / 100 * (100 + l_tax);
-        Q1GroupKey k{l_returnflag, l_linestatus};
-        auto it = m.find(k);
-        if (it != m.end()) {
-            int64_t sum_qty = it->second.sum_qty + l_quantity;
-            int64_t sum_price = it->second.sum_price + l_extendedprice;
-            int64_t sum_disc_price = it->second.sum_disc_price + eval0;
-            int64_t sum_charge = it->second.sum_charge + eval1;
-            int64_t sum_disc = it->second.sum_disc + l_discount;
-            int64_t sum_count = it->second.sum_count + 1;
-            Q1GroupValue s{sum_qty, sum_price, sum_disc_price, sum_charge, sum_disc, sum_count};
-            m[k] = s;
-        } else {
-            Q1GroupValue s{l_quantity, l_extendedprice, eval0, eval1, l_discount, 1};
-            m.insert(std::make_pair(k, s));
-        }
-    }
+    const int32_t* l_returnflag = tin.getColPtr<int32_t>(0);
+    const int32_t* l_linestatus = tin.getColPtr<int32_t>(1);
+    const int32_t* l_quantity = tin.getColPtr<int32_t>(2); // index much patMatch YAML
+    const int32_t* l_extendedprice = tin.getColPtr<int32_t>(3);
+    const int32_t* l_discount = tin.getColPtr<int32_t>(4);
+    const int32_t* l_tax = tin.getColPtr<int32_t>(5);
+    auto row = [&](int i, Q1GroupKey& k, Q1GroupValue& v) {
+        int32_t eval0 = l_extendedprice[i] * (100 - l_discount[i]);
+        int64_t eval1 = eval0 / 100 * (100 + l_tax[i]);
+        k = Q1GroupKey{l_returnflag[i], l_linestatus[i]};
+        v = Q1GroupValue{l_quantity[i], l_extendedprice[i], eval0, eval1, l_discount[i], 1};
+        return true;
+    };
+    auto merge = [](Q1GroupValue& a, const Q1GroupValue& b) {
+        a.sum_qty += b.sum_qty;
+        a.sum_price += b.sum_price;
+        a.sum_disc_price += b.sum_disc_price;
+        a.sum_charge += b.sum_charge;
+        a.sum_disc += b.sum_disc;
+        a.sum_count += b.sum_count;
+    };
+    auto m = cpu_ops::parallelGroupBy<Q1GroupKey, Q1GroupValue>(nrow, row, merge);
 
     int r = 0;
     for (auto& it : m) {
@@ -14,34 +14,28 @@
  * limitations under the License.
  */
 #include <regex>
+#include "cpu_ops.hpp"
 // t1:5
 void q2Join_r_n(Table& tin1, Table& tin2, Table& tout) {
     int nrow1 = tin1.getNumRow();
     int nrow2 = tin2.getNumRow();
-    std::unordered_multimap<int32_t, int32_t> ht1;
-    for (int i = 0; i < nrow1; i++) {
-        std::array<char, TPCH_READ_REGION_LEN + 1> r_name = tin1.getcharN<char, TPCH_READ_REGION_LEN + 1>(i, 1);
-        if (!strcmp("EUROPE", r_name.data())) {
-            int32_t r_regionkey = tin1.getInt32(i, 0);
-            ht1.insert(std::make_pair(r_regionkey, 0));
-        }
-    }
-    int r = 0;
-    for (int i = 0; i < nrow2; i++) {
-        int32_t n_regionkey = tin2.getInt32(i, 0);
-        auto its = ht1.equal_range(n_regionkey);
-        auto it = its.first;
-        while (it != its.second) {
-            int32_t n_nationkey = tin2.getInt32(i, 1);
-            int32_t n_rowid = i;
-            // std::array<char,TPCH_READ_NATION_LEN+1>n_name = tin2.getcharN<char,TPCH_READ_NATION_LEN+1>(i,2);
-            tout.setInt32(r, 0, n_nationkey);
-            tout.setInt32(r, 1, n_rowid);
-            //  tout.setcharN<char,TPCH_READ_NATION_LEN+1>(r,1,n_name.data());
-            it++;
-            r++;
-        }
-    }
+    const int32_t* r_regionkey = tin1.getColPtr<int32_t>(0);
+    const char* r_name = tin1.getColPtr<char>(1);
+    cpu_ops::HashIndex ht1(nrow1, [&](int i, int64_t& k) {
+        k = r_regionkey[i];
+        return !strcmp("EUROPE", r_name + i * (TPCH_READ_REGION_LEN + 1));
+    });
+    const int32_t* n_regionkey = tin2.getColPtr<int32_t>(0);
+    const int32_t* n_nationkey = tin2.getColPtr<int32_t>(1);
+    auto key = [&](int i, int64_t& k) {
+        k = n_regionkey[i];
+        return true;
+    };
+    auto emit = [&](int r, int i, int j) {
+        tout.setInt32(r, 0, n_nationkey[i]);
+        tout.setInt32(r, 1, i); // n_rowid
+    };
+    int r = cpu_ops::hashJoin(ht1, nrow2, key, emit);
     tout.setNumRow(r);
     std::cout << std::dec << r << " In q2Join_r_n" << std::endl;
 }
@@ -50,29 +44,26 @@ void q2Join_r_n(Table& tin1, Table& tin2, Table& tout) {
 // s_nationkey,s_suppkey,s_rowid(s_acctbal,s_name,s_address,s_phone,s_comment)
 void q2Join_t1_s(Table& tin1, Table& tin2, Table& tout) {
     int nrow1 = tin1.getNumRow();
-    std::unordered_multimap<int32_t, int32_t> ht1;
-    for (int i = 0; i < nrow1; i++) {
-        int32_t n_nationkey = tin1.getInt32(i, 0);
-        int32_t n_rowid = tin1.getInt32(i, 1);
-        ht1.insert(std::make_pair(n_nationkey, n_rowid));
-    }
-    int r = 0;
     int nrow2 = tin2.getNumRow();
-    for (int i = 0; i < nrow2; i++) {
-        int32_t s_nationkey = tin2.getInt32(i, 0);
-        auto its = ht1.equal_range(s_nationkey);
-        auto it = its.first;
-        while (it != its.second) {
-            int32_t s_suppkey = tin2.getInt32(i, 1);
-            int32_t s_rowid = tin2.getInt32(i, 7);
-            int32_t n_rowid = it->second;
-            tout.setInt32(r, 0, s_suppkey);
-            tout.setInt32(r, 1, s_rowid);
-            tout.setInt32(r, 2, n_rowid);
-            it++;
-            r++;
-        }
-    }
+    const int32_t* n_nationkey = tin1.getColPtr<int32_t>(0);
+    const int32_t* n_rowid = tin1.getColPtr<int32_t>(1);
+    cpu_ops::HashIndex ht1(nrow1, [&](int i, int64_t& k) {
+        k = n_nationkey[i];
+        return true;
+    });
+    const int32_t* s_nationkey = tin2.getColPtr<int32_t>(0);
+    const int32_t* s_suppkey = tin2.getColPtr<int32_t>(1);
+    const int32_t* s_rowid = tin2.getColPtr<int32_t>(7);
+    auto key = [&](int i, int64_t& k) {
+        k = s_nationkey[i];
+        return true;
+    };
+    auto emit = [&](int r, int i, int j) {
+        tout.setInt32(r, 0, s_suppkey[i]);
+        tout.setInt32(r, 1, s_rowid[i]);
+        tout.setInt32(r, 2, n_rowid[j]);
+    };
+    int r = cpu_ops::hashJoin(ht1, nrow2, key, emit);
     tout.setNumRow(r);
     std::cout << std::dec << r << " In q2Join_t1_s" << std::endl;
 }
@@ -81,35 +72,27 @@ void q2Join_t1_s(Table& tin1, Table& tin2, Table& tout) {
 void q2Join_t2_p(Table& tin1, Table& tin2, Table& tout) {
     int nrow1 = tin1.getNumRow();
     int nrow2 = tin2.getNumRow();
-    struct KeyA {
-        int32_t s_rowid;
-        int32_t n_rowid;
+    const int32_t* s_suppkey = tin1.getColPtr<int32_t>(0);
+    const int32_t* s_rowid = tin1.getColPtr<int32_t>(1);
+    const int32_t* n_rowid = tin1.getColPtr<int32_t>(2);
+    cpu_ops::HashIndex ht1(nrow1, [&](int i, int64_t& k) {
+        k = s_suppkey[i];
+        return true;
+    });
+    const int32_t* ps_partkey = tin2.getColPtr<int32_t>(0);
+    const int32_t* ps_suppkey = tin2.getColPtr<int32_t>(1);
+    const int32_t* ps_supplycost = tin2.getColPtr<int32_t>(2);
+    auto key = [&](int i, int64_t& k) {
+        k = ps_suppkey[i];
+        return true;
     };
-    std::unordered_multimap<int32_t, KeyA> ht1;
-    for (int i = 0; i < nrow1; i++) {
-        int32_t s_suppkey = tin1.getInt32(i, 0);
-        int32_t s_rowid = tin1.getInt32(i, 1);
-        int32_t n_rowid = tin1.getInt32(i, 2);
-        ht1.insert(std::make_pair(s_suppkey, KeyA{s_rowid, n_rowid}));
-    }
-    int r = 0;
-    for (int i = 0; i < nrow2; i++) {
-        int32_t ps_suppkey = tin2.getInt32(i, 1);
-        auto its = ht1.equal_range(ps_suppkey);
-        auto it = its.first;
-        while (it != its.second) {
-            int32_t ps_partkey = tin2.getInt32(i, 0);
-            int32_t ps_supplycost = tin2.getInt32(i, 2);
-            int32_t s_rowid = it->second.s_rowid;
-            int32_t n_rowid = it->second.n_rowid;
-            tout.setInt32(r, 0, ps_partkey);
-            tout.setInt32(r, 1, ps_supplycost);
-            tout.setInt32(r, 2, s_rowid);
-            tout.setInt32(r, 3, n_rowid);
-            it++;
-            r++;
-        }
-    }
+    auto emit = [&](int r, int i, int j) {
+        tout.setInt32(r, 0, ps_partkey[i]);
+        tout.setInt32(r, 1, ps_supplycost[i]);
+        tout.setInt32(r, 2, s_rowid[j]);
+        tout.setInt32(r, 3, n_rowid[j]);
+    };
+    int r = cpu_ops::hashJoin(ht1, nrow2, key, emit);
     tout.setNumRow(r);
     std::cout << std::dec << r << " In q2Join_t2_p" << std::endl;
 }
@@ -118,20 +101,20 @@ void q2Join_t2_p(Table& tin1, Table& tin2, Table& tout) {
 
 void q2Filter_p(Table& tin1, Table& tout) {
     int nrow = tin1.getNumRow();
-    int r = 0;
-    for (int i = 0; i < nrow; i++) {
-        std::array<char, TPCH_READ_P_TYPE_LEN + 1> p_type = tin1.getcharN<char, TPCH_READ_P_TYPE_LEN + 1>(i, 2);
-        int32_t p_size = tin1.getInt32(i, 3);
+    const int32_t* p_partkey = tin1.getColPtr<int32_t>(0);
+    const char* p_type = tin1.getColPtr<char>(2);
+    const int32_t* p_size = tin1.getColPtr<int32_t>(3);
+    auto pred = [&](int i) {
+        if (p_size[i] != 15) return false;
         // if( p_size==15&& std::regex_match(p_type.data(), std::regex("(.*)(BRASS)"))){
-        if (p_size == 15 && std::string(p_type.data()).find("BRASS") == std::string(p_type.data()).length() - 5) {
-            int32_t p_partkey = tin1.getInt32(i, 0);
-            int32_t p_rowid = i;
-            tout.setInt32(r, 0, p_partkey);
-            tout.setInt32(r, 1, p_rowid);
-            //  tout.setcharN<char,TPCH_READ_P_MFG_LEN+1>(r,1,p_mfgr);
-            r++;
-        }
-    }
+        std::string t(p_type + i * (TPCH_READ_P_TYPE_LEN + 1));
+        return t.find("BRASS") == t.length() - 5;
+    };
+    auto emit = [&](int r, int i) {
+        tout.setInt32(r, 0, p_partkey[i]);
+        tout.setInt32(r, 1, i); // p_rowid
+    };
+    int r = cpu_ops::parallelFilter(nrow, pred, emit);
     tout.setNumRow(r);
     std::cout << std::dec << r << " In q2Filter_p" << std::endl;
 }
@@ -140,49 +123,42 @@ void q2Filter_p(Table& tin1, Table& tout) {
 void q2Join_t4_t3(Table& tin1, Table& tin2, Table& tout) {
     int nrow1 = tin1.getNumRow();
     int nrow2 = tin2.getNumRow();
-    std::unordered_multimap<int32_t, int32_t> ht1;
-    for (int i = 0; i < nrow1; i++) {
-        int32_t p_partkey = tin1.getInt32(i, 0);
-        int32_t p_rowid = tin1.getInt32(i, 1);
-        ht1.insert(std::make_pair(p_partkey, p_rowid));
-    }
-    int r = 0;
-    for (int i = 0; i < nrow2; i++) {
-        int32_t ps_partkey = tin2.getInt32(i, 0);
-        auto its = ht1.equal_range(ps_partkey);
-        auto it = its.first;
-        while (it != its.second) {
-            int32_t ps_supplycost = tin2.getInt32(i, 1);
-            int32_t s_rowid = tin2.getInt32(i, 2);
-            int32_t n_rowid = tin2.getInt32(i, 3);
-            int32_t p_rowid = it->second;
-            tout.setInt32(r, 0, ps_partkey);
-            tout.setInt32(r, 1, ps_supplycost);
-            tout.setInt32(r, 2, p_rowid);
-            tout.setInt32(r, 3, s_rowid);
-            tout.setInt32(r, 4, n_rowid);
-            it++;
-            r++;
-        }
-    }
+    const int32_t* p_partkey = tin1.getColPtr<int32_t>(0);
+    const int32_t* p_rowid = tin1.getColPtr<int32_t>(1);
+    cpu_ops::HashIndex ht1(nrow1, [&](int i, int64_t& k) {
+        k = p_partkey[i];
+        return true;
+    });
+    const int32_t* ps_partkey = tin2.getColPtr<int32_t>(0);
+    const int32_t* ps_supplycost = tin2.getColPtr<int32_t>(1);
+    const int32_t* s_rowid = tin2.getColPtr<int32_t>(2);
+    const int32_t* n_rowid = tin2.getColPtr<int32_t>(3);
+    auto key = [&](int i, int64_t& k) {
+        k = ps_partkey[i];
+        return true;
+    };
+    auto emit = [&](int r, int i, int j) {
+        tout.setInt32(r, 0, ps_partkey[i]);
+        tout.setInt32(r, 1, ps_supplycost[i]);
+        tout.setInt32(r, 2, p_rowid[j]);
+        tout.setInt32(r, 3, s_rowid[i]);
+        tout.setInt32(r, 4, n_rowid[i]);
+    };
+    int r = cpu_ops::hashJoin(ht1, nrow2, key, emit);
     tout.setNumRow(r);
     std::cout << std::dec << r << " In q2Join_t4_t3" << std::endl;
 }
 // t6:460
 void q2GroupBy(Table& tin, Table& tout) {
-    std::unordered_map<int32_t, int32_t> ht1;
-    for (int i = 0; i < tin.getNumRow(); i++) {
-        int32_t ps_partkey = tin.getInt32(i, 0);
-        int32_t ps_supplycost = tin.getInt32(i, 1);
-        ;
-        auto it = ht1.find(ps_partkey);
-        if (it != ht1.end()) {
-            int64_t s = it->second < ps_supplycost ? it->second : ps_supplycost;
-            ht1[ps_partkey] = s;
-        } else {
-            ht1.insert(std::make_pair(ps_partkey, ps_supplycost));
-        }
-    }
+    const int32_t* ps_partkey = tin.getColPtr<int32_t>(0);
+    const int32_t* ps_supplycost = tin.getColPtr<int32_t>(1);
+    auto row = [&](int i, int32_t& k, int32_t& v) {
+        k = ps_partkey[i];
+        v = ps_supplycost[i];
+        return true;
+    };
+    auto merge = [](int32_t& a, const int32_t& b) { a = a < b ? a : b; };
+    auto ht1 = cpu_ops::parallelGroupBy<int32_t, int32_t>(tin.getNumRow(), row, merge);
     int r = 0;
     for (auto& it : ht1) {
         tout.setInt32(r, 0, it.first);
@@ -194,94 +170,59 @@ void q2GroupBy(Table& tin, Table& tout) {
     std::cout << std::dec << r << " In q2GroupBy" << std::endl;
 }
 // t7
-struct KeyA {
-    int32_t p_partkey;
-    int32_t ps_supplycost;
-    bool operator==(const KeyA& other) const {
-        return (p_partkey == other.p_partkey) && (ps_supplycost == other.ps_supplycost);
-    }
-};
-namespace std {
-template <>
-struct hash<KeyA> {
-    std::size_t operator()(const KeyA& k) const {
-        using std::size_t;
-        using std::hash;
-        return (hash<int>()(k.p_partkey)) + (hash<int>()(k.ps_supplycost));
-    }
-};
-};
-struct KeyV1 {
-    int32_t p_rowid; // pmf
-    int32_t s_rowid;
-    int32_t n_rowid;
-};
 void q2Join_t5_t6(Table& tin1, Table& tin2, Table& tout) {
     int nrow1 = tin1.getNumRow();
     int nrow2 = tin2.getNumRow();
-    std::unordered_multimap<KeyA, KeyV1> ht1;
-    for (int i = 0; i < nrow1; i++) {
-        int32_t p_partkey = tin1.getInt32(i, 0);
-        int32_t ps_supplycost = tin1.getInt32(i, 1);
-        int32_t p_rowid = tin1.getInt32(i, 2);
-        int32_t s_rowid = tin1.getInt32(i, 3);
-        int32_t n_rowid = tin1.getInt32(i, 4);
-        //        std::cout<<p_partkey<<" "<<ps_supplycost<<std::endl;
-        KeyA keya{p_partkey, ps_supplycost};
-        KeyV1 keyv1{p_rowid, s_rowid, n_rowid};
-        ht1.insert(std::make_pair(keya, keyv1));
-    }
-    int r = 0;
-    for (int i = 0; i < nrow2; i++) {
-        int32_t ps_partkey = tin2.getInt32(i, 0);
-        int32_t min_ps_supplycost = tin2.getInt32(i, 1);
-        // std::cout<<ps_partkey<<" "<<min_ps_supplycost<<std::endl;
-        auto its = ht1.equal_range(KeyA{ps_partkey, min_ps_supplycost});
-        auto it = its.first;
-        while (it != its.second) {
-            int32_t p_rowid = it->second.p_rowid;
-            int32_t s_rowid = it->second.s_rowid;
-            int32_t n_rowid = it->second.n_rowid;
-            tout.setInt32(r, 0, ps_partkey);
-            tout.setInt32(r, 1, p_rowid);
-            tout.setInt32(r, 2, s_rowid);
-            tout.setInt32(r, 3, n_rowid);
-            it++;
-            r++;
-        }
-    }
+    const int32_t* p_partkey = tin1.getColPtr<int32_t>(0);
+    const int32_t* ps_supplycost = tin1.getColPtr<int32_t>(1);
+    const int32_t* p_rowid = tin1.getColPtr<int32_t>(2);
+    const int32_t* s_rowid = tin1.getColPtr<int32_t>(3);
+    const int32_t* n_rowid = tin1.getColPtr<int32_t>(4);
+    cpu_ops::HashIndex ht1(nrow1, [&](int i, int64_t& k) {
+        k = cpu_ops::packKey(p_partkey[i], ps_supplycost[i]);
+        return true;
+    });
+    const int32_t* ps_partkey = tin2.getColPtr<int32_t>(0);
+    const int32_t* min_ps_supplycost = tin2.getColPtr<int32_t>(1);
+    auto key = [&](int i, int64_t& k) {
+        k = cpu_ops::packKey(ps_partkey[i], min_ps_supplycost[i]);
+        return true;
+    };
+    auto emit = [&](int r, int i, int j) {
+        tout.setInt32(r, 0, ps_partkey[i]);
+        tout.setInt32(r, 1, p_rowid[j]);
+        tout.setInt32(r, 2, s_rowid[j]);
+        tout.setInt32(r, 3, n_rowid[j]);
+    };
+    int r = cpu_ops::hashJoin(ht1, nrow2, key, emit);
     tout.setNumRow(r);
     std::cout << std::dec << r << " In q2Join_t5_t6" << std::endl;
 }
 void q2Join_t6_t5(Table& tin1, Table& tin2, Table& tout) {
     int nrow1 = tin1.getNumRow();
     int nrow2 = tin2.getNumRow();
-    std::unordered_multimap<KeyA, int32_t> ht1;
-    for (int i = 0; i < nrow1; i++) {
-        int32_t ps_partkey = tin1.getInt32(i, 0);
-        int32_t min_ps_supplycost = tin1.getInt32(i, 1);
-
-        KeyA keya{ps_partkey, min_ps_supplycost};
-        ht1.insert(std::make_pair(keya, 0));
-    }
-    int r = 0;
-    for (int i = 0; i < nrow2; i++) {
-        int32_t p_partkey = tin2.getInt32(i, 0);
-        int32_t ps_supplycost = tin2.getInt32(i, 1);
-        int32_t p_rowid = tin2.getInt32(i, 2);
-        int32_t s_rowid = tin2.getInt32(i, 3);
-        int32_t n_rowid = tin2.getInt32(i, 4);
-        auto its = ht1.equal_range(KeyA{p_partkey, ps_supplycost});
-        auto it = its.first;
-        while (it != its.second) {
-            tout.setInt32(r, 0, p_partkey);
-            tout.setInt32(r, 1, p_rowid);
-            tout.setInt32(r, 2, s_rowid);
-            tout.setInt32(r, 3, n_rowid);
-            it++;
-            r++;
-        }
-    }
+    const int32_t* ps_partkey = tin1.getColPtr<int32_t>(0);
+    const int32_t* min_ps_supplycost = tin1.getColPtr<int32_t>(1);
+    cpu_ops::HashIndex ht1(nrow1, [&](int i, int64_t& k) {
+        k = cpu_ops::packKey(ps_partkey[i], min_ps_supplycost[i]);
+        return true;
+    });
+    const int32_t* p_partkey = tin2.getColPtr<int32_t>(0);
+    const int32_t* ps_supplycost = tin2.getColPtr<int32_t>(1);
+    const int32_t* p_rowid = tin2.getColPtr<int32_t>(2);
+    const int32_t* s_rowid = tin2.getColPtr<int32_t>(3);
+    const int32_t* n_rowid = tin2.getColPtr<int32_t>(4);
+    auto key = [&](int i, int64_t& k) {
+        k = cpu_ops::packKey(p_partkey[i], ps_supplycost[i]);
+        return true;
+    };
+    auto emit = [&](int r, int i, int j) {
+        tout.setInt32(r, 0, p_partkey[i]);
+        tout.setInt32(r, 1, p_rowid[i]);
+        tout.setInt32(r, 2, s_rowid[i]);
+        tout.setInt32(r, 3, n_rowid[i]);
+    };
+    int r = cpu_ops::hashJoin(ht1, nrow2, key, emit);
     tout.setNumRow(r);
     std::cout << std::dec << r << " In q2Join_t5_t6" << std::endl;
 }
@@ -13,17 +13,14 @@
  * See the License for the specific language governing permissions and
  * limitations under the License.
  */
+#include "cpu_ops.hpp"
 void q3FilterC(Table& tin, Table& tout) {
-    int r = 0;
     int nrow = tin.getNumRow();
-    for (int i = 0; i < nrow; ++i) {
-        int32_t c_custkey = tin.getInt32(i, 0);
-        std::array<char, TPCH_READ_MAXAGG_LEN + 1> c_mktsegment = tin.getcharN<char, TPCH_READ_MAXAGG_LEN + 1>(i, 1);
-        if (!strcmp(c_mktsegment.data(), "BUILDING")) {
-            tout.setInt32(r, 0, c_custkey);
-            ++r;
-        }
-    }
+    const int32_t* c_custkey = tin.getColPtr<int32_t>(0);
+    const char* c_mktsegment = tin.getColPtr<char>(1);
+    auto pred = [&](int i) { return !strcmp(c_mktsegment + i * (TPCH_READ_MAXAGG_LEN + 1), "BUILDING"); };
+    auto emit = [&](int r, int i) { tout.setInt32(r, 0, c_custkey[i]); };
+    int r = cpu_ops::parallelFilter(nrow, pred, emit);
     tout.setNumRow(r);
 }
 
@@ -47,24 +44,18 @@ struct hash<Q3GroupKey> {
 };
 }
 void q3GroupBy(Table& tin, Table& tout) {
-    std::unordered_map<Q3GroupKey, int64_t> m;
-
     unsigned nrow = tin.getNumRow();
-    for (size_t i = 0; i < nrow; ++i) {
-        int32_t l_orderkey = tin.getInt32(i, 0); // index much patMatch YAML
-        int32_t o_orderdate = tin.getInt32(i, 1);
-        int32_t o_shippriority = tin.getInt32(i, 2);
-        int32_t eval0 = tin.getInt32(i, 3);
-        int32_t r = eval0;
-        Q3GroupKey k{l_orderkey, o_orderdate, o_shippriority};
-        auto it = m.find(k);
-        if (it != m.end()) {
-            int64_t s = it->second + r;
-            m[k] = s; // update
-        } else {
-            m.insert(std::make_pair(k, r));
-        }
-    }
+    const int32_t* l_orderkey = tin.getColPtr<int32_t>(0); // index much patMatch YAML
+    const int32_t* o_orderdate = tin.getColPtr<int32_t>(1);
+    const int32_t* o_shippriority = tin.getColPtr<int32_t>(2);
+    const int32_t* eval0 = tin.getColPtr<int32_t>(3);
+    auto row = [&](int i, Q3GroupKey& k, int64_t& v) {
+        k = Q3GroupKey{l_orderkey[i], o_orderdate[i], o_shippriority[i]};
+        v = eval0[i];
+        return true;
+    };
+    auto merge = [](int64_t& a, const int64_t& b) { a += b; };
+    auto m = cpu_ops::parallelGroupBy<Q3GroupKey, int64_t>(nrow, row, merge);
 
     int r = 0;
     for (auto& it : m) {
@@ -126,92 +117,59 @@ void q3Print(Table& tin) {
 }
 void q3Join_C_O1(Table& tin1, Table& tin2, Table& tout) {
     int nrow1 = tin1.getNumRow();
-    std::unordered_map<int32_t, int32_t> ht1;
-    for (int i = 0; i < nrow1; i++) {
-        ht1.insert(std::make_pair(tin1.getInt32(i, 0), 0));
-    }
+    const int32_t* c_custkey = tin1.getColPtr<int32_t>(0);
+    cpu_ops::HashIndex ht1(nrow1, [&](int i, int64_t& k) {
+        k = c_custkey[i];
+        return true;
+    });
     std::cout << std::dec << ht1.size() << "  q3Join_C_O1" << std::endl;
-    struct KeyC {
-        int32_t o_orderkey;
-        int32_t o_custkey;
-        int32_t o_orderdate;
-        int32_t o_shippriority;
-    };
-    std::vector<KeyC> ht2;
     int nrow2 = tin2.getNumRow();
-    for (int i = 0; i < nrow2; ++i) {
-        int o_orderdate = tin2.getInt32(i, 2);
-        if (o_orderdate < 19950315) {
-            int o_orderkey = tin2.getInt32(i, 0);
-            int o_custkey = tin2.getInt32(i, 1);
-            int o_shippriority = tin2.getInt32(i, 3);
-            ht2.push_back(KeyC{o_orderkey, o_custkey, o_orderdate, o_shippriority});
-        }
-    }
-    // std::cout<<std::dec<<ht2.size()<<"  q3Join_C_O1"<<std::endl;
-    int r = 0;
-    for (size_t i = 0; i < ht2.size(); i++) {
-        int o_custkey = ht2[i].o_custkey;
-        auto it = ht1.find(o_custkey);
-        if (it != ht1.end()) {
-            int o_orderdate = ht2[i].o_orderdate;
-            int o_shippriority = ht2[i].o_shippriority;
-            int o_orderkey = ht2[i].o_orderkey;
-            tout.setInt32(r, 0, o_orderdate);
-            tout.setInt32(r, 1, o_shippriority);
-            tout.setInt32(r, 2, o_orderkey);
-            r++;
-        }
-    }
+    const int32_t* o_orderkey = tin2.getColPtr<int32_t>(0);
+    const int32_t* o_custkey = tin2.getColPtr<int32_t>(1);
+    const int32_t* o_orderdate = tin2.getColPtr<int32_t>(2);
+    const int32_t* o_shippriority = tin2.getColPtr<int32_t>(3);
+    auto key = [&](int i, int64_t& k) {
+        k = o_custkey[i];
+        return o_orderdate[i] < 19950315;
+    };
+    auto emit = [&](int r, int i) {
+        tout.setInt32(r, 0, o_orderdate[i]);
+        tout.setInt32(r, 1, o_shippriority[i]);
+        tout.setInt32(r, 2, o_orderkey[i]);
+    };
+    int r = cpu_ops::hashSemiJoin(ht1, nrow2, key, emit);
     tout.setNumRow(r);
     std::cout << std::dec << r << " out q3Join_C_O1" << std::endl;
 }
 
 void q3Join_C_O2(Table& tin1, Table& tin2, Table& tout) {
-    struct KeyA {
-        int32_t o_orderdate;
-        int32_t o_shippriority;
-    };
     int nrow1 = tin1.getNumRow();
-    std::unordered_map<int32_t, KeyA> ht1;
-    for (int i = 0; i < nrow1; i++) {
-        ht1.insert(std::make_pair(tin1.getInt32(i, 2), KeyA{tin1.getInt32(i, 0), tin1.getInt32(i, 1)}));
-    }
-    struct KeyC {
-        int32_t l_orderkey;
-        int32_t l_extendedprice;
-        int32_t l_discount;
-        int32_t l_shipdate;
-    };
-    std::vector<KeyC> ht2;
+    const int32_t* o_orderdate = tin1.getColPtr<int32_t>(0);
+    const int32_t* o_shippriority = tin1.getColPtr<int32_t>(1);
+    const int32_t* o_orderkey = tin1.getColPtr<int32_t>(2);
+    cpu_ops::HashIndex ht1(nrow1, [&](int i, int64_t& k) {
+        k = o_orderkey[i];
+        return true;
+    });
     int nrow2 = tin2.getNumRow();
-    for (int i = 0; i < nrow2; ++i) {
-        int l_shipdate = tin2.getInt32(i, 3);
-        if (l_shipdate > 19950315) {
-            int l_orderkey = tin2.getInt32(i, 0);
-            int l_extendedprice = tin2.getInt32(i, 1);
-            int l_discount = tin2.getInt32(i, 2);
-            ht2.push_back(KeyC{l_orderkey, l_extendedprice, l_discount, l_shipdate});
-        }
-    }
-    std::cout << std::dec << ht2.size() << " q3Join_C_O2" << std::endl;
-    int r = 0;
-    for (size_t i = 0; i < ht2.size(); i++) {
-        int l_orderkey = ht2[i].l_orderkey;
-        auto it = ht1.find(l_orderkey);
-        if (it != ht1.end()) {
-            int o_orderdate = it->second.o_orderdate;
-            int o_shippriority = it->second.o_shippriority;
-            int32_t l_extendedprice = ht2[i].l_extendedprice;
-            int32_t l_discount = ht2[i].l_discount;
-            int eval0 = (-l_discount + 100) * l_extendedprice;
-            tout.setInt32(r, 0, l_orderkey);
-            tout.setInt32(r, 1, o_orderdate);
-            tout.setInt32(r, 2, o_shippriority);
-            tout.setInt32(r, 3, eval0);
-            r++;
-        }
-    }
+    const int32_t* l_orderkey = tin2.getColPtr<int32_t>(0);
+    const int32_t* l_extendedprice = tin2.getColPtr<int32_t>(1);
+    const int32_t* l_discount = tin2.getColPtr<int32_t>(2);
+    const int32_t* l_shipdate = tin2.getColPtr<int32_t>(3);
+    int nship = cpu_ops::parallelSum<int>(nrow2, [&](int i) { return l_shipdate[i] > 19950315 ? 1 : 0; });
+    std::cout << std::dec << nship << " q3Join_C_O2" << std::endl;
+    auto key = [&](int i, int64_t& k) {
+        k = l_orderkey[i];
+        return l_shipdate[i] > 19950315;
+    };
+    auto emit = [&](int r, int i, int j) {
+        int eval0 = (-l_discount[i] + 100) * l_extendedprice[i];
+        tout.setInt32(r, 0, l_orderkey[i]);
+        tout.setInt32(r, 1, o_orderdate[j]);
+        tout.setInt32(r, 2, o_shippriority[j]);
+        tout.setInt32(r, 3, eval0);
+    };
+    int r = cpu_ops::hashJoinFirst(ht1, nrow2, key, emit);
     tout.setNumRow(r);
     std::cout << std::dec << r << " out q3Join_C_O2" << std::endl;
 }
@@ -13,31 +13,28 @@
  * See the License for the specific language governing permissions and
  * limitations under the License.
  */
+#include "cpu_ops.hpp"
 // t1 //t6
 void q4SemiJoin_o_l(Table& tin1, Table& tin2, Table& tout) {
     int nrow1 = tin1.getNumRow();
     int nrow2 = tin2.getNumRow();
-    std::unordered_map<int32_t, int32_t> ht1;
     std::cout << std::dec << nrow1 << " " << std::endl;
-    for (int i = 0; i < nrow1; i++) {
-        int32_t l_commitdate = tin1.getInt32(i, 1);
-        int32_t l_receiptdate = tin1.getInt32(i, 2);
-        int32_t l_orderkey = tin1.getInt32(i, 0);
-        if (l_commitdate < l_receiptdate) {
-            ht1.insert(std::make_pair(l_orderkey, 0));
-        }
-    }
-    // std::cout<<std::dec<<ht1.size()<<" In q4"<<std::endl;
-    int r = 0;
-    for (int i = 0; i < nrow2; i++) {
-        int32_t o_orderkey = tin2.getInt32(i, 1);
-        int32_t o_orderdate = tin2.getInt32(i, 2);
-        if ((o_orderdate >= 19930701 && o_orderdate < 19931001) && ht1.find(o_orderkey) != ht1.end()) {
-            int32_t o_rowid = tin2.getInt32(i, 3);
-            tout.setInt32(r, 0, o_rowid);
-            r++;
-        }
-    }
+    const int32_t* l_orderkey = tin1.getColPtr<int32_t>(0);
+    const int32_t* l_commitdate = tin1.getColPtr<int32_t>(1);
+    const int32_t* l_receiptdate = tin1.getColPtr<int32_t>(2);
+    cpu_ops::HashIndex ht1(nrow1, [&](int i, int64_t& k) {
+        k = l_orderkey[i];
+        return l_commitdate[i] < l_receiptdate[i];
+    });
+    const int32_t* o_orderkey = tin2.getColPtr<int32_t>(1);
+    const int32_t* o_orderdate = tin2.getColPtr<int32_t>(2);
+    const int32_t* o_rowid = tin2.getColPtr<int32_t>(3);
+    auto key = [&](int i, int64_t& k) {
+        k = o_orderkey[i];
+        return o_orderdate[i] >= 19930701 && o_orderdate[i] < 19931001;
+    };
+    auto emit = [&](int r, int i) { tout.setInt32(r, 0, o_rowid[i]); };
+    int r = cpu_ops::hashSemiJoin(ht1, nrow2, key, emit);
     tout.setNumRow(r);
     std::cout << std::dec << r << " In q4SemiJoin_o_l" << std::endl;
 }
@@ -58,21 +55,15 @@ struct hash<q4GroupKey> {
 };
 }
 void q4GroupBy(Table& tin, Table& origin, Table& tout) {
-    std::unordered_map<q4GroupKey, int64_t> ht1;
-    for (int i = 0; i < tin.getNumRow(); i++) {
-        int32_t o_rowid = tin.getInt32(i, 0);
-        std::array<char, TPCH_READ_MAXAGG_LEN + 1> orderpriority =
-            origin.getcharN<char, TPCH_READ_MAXAGG_LEN + 1>(o_rowid, 0);
-        // if(i<10) std::cout<<std::dec<<o_rowid<<" "<<orderpriority.data()<<std::endl;
-        q4GroupKey k{std::string(orderpriority.data())};
-        auto it = ht1.find(k);
-        if (it != ht1.end()) {
-            int64_t s = it->second + 1;
-            ht1[k] = s;
-        } else {
-            ht1.insert(std::make_pair(k, 1));
-        }
-    }
+    const int32_t* o_rowid = tin.getColPtr<int32_t>(0);
+    const char* orderpriority = origin.getColPtr<char>(0);
+    auto row = [&](int i, q4GroupKey& k, int64_t& v) {
+        k.o_orderpriority = orderpriority + (size_t)o_rowid[i] * (TPCH_READ_MAXAGG_LEN + 1);
+        v = 1;
+        return true;
+    };
+    auto merge = [](int64_t& a, const int64_t& b) { a += b; };
+    auto ht1 = cpu_ops::parallelGroupBy<q4GroupKey, int64_t>(tin.getNumRow(), row, merge);
     int r = 0;
     for (auto& it : ht1) {
         std::array<char, TPCH_READ_MAXAGG_LEN + 1> orderpriority{};
@@ -14,31 +14,26 @@
  * limitations under the License.
  */
 #include <regex>
+#include "cpu_ops.hpp"
 // t1:5
 void q5Join_r_n(Table& tin1, Table& tin2, Table& tout) {
     int nrow1 = tin1.getNumRow();
     int nrow2 = tin2.getNumRow();
-    std::unordered_multimap<int32_t, int32_t> ht1;
-    for (int i = 0; i < nrow1; i++) {
-        std::array<char, TPCH_READ_REGION_LEN + 1> r_name = tin1.getcharN<char, TPCH_READ_REGION_LEN + 1>(i, 1);
-        if (!strcmp("MIDDLE EAST", r_name.data())) {
-            // if(!strcmp("ASIA",r_name.data())){
-            int32_t r_regionkey = tin1.getInt32(i, 0);
-            ht1.insert(std::make_pair(r_regionkey, 0));
-        }
-    }
-    int r = 0;
-    for (int i = 0; i < nrow2; i++) {
-        int32_t n_regionkey = tin2.getInt32(i, 0);
-        auto its = ht1.equal_range(n_regionkey);
-        auto it = its.first;
-        while (it != its.second) {
-            int32_t n_nationkey = tin2.getInt32(i, 1);
-            tout.setInt32(r, 0, n_nationkey);
-            it++;
-            r++;
-        }
-    }
+    const int32_t* r_regionkey = tin1.getColPtr<int32_t>(0);
+    const char* r_name = tin1.getColPtr<char>(1);
+    cpu_ops::HashIndex ht1(nrow1, [&](int i, int64_t& k) {
+        k = r_regionkey[i];
+        // return !strcmp("ASIA", r_name + i * (TPCH_READ_REGION_LEN + 1));
+        return !strcmp("MIDDLE EAST", r_name + i * (TPCH_READ_REGION_LEN + 1));
+    });
+    const int32_t* n_regionkey = tin2.getColPtr<int32_t>(0);
+    const int32_t* n_nationkey = tin2.getColPtr<int32_t>(1);
+    auto key = [&](int i, int64_t& k) {
+        k = n_regionkey[i];
+        return true;
+    };
+    auto emit = [&](int r, int i, int j) { tout.setInt32(r, 0, n_nationkey[i]); };
+    int r = cpu_ops::hashJoin(ht1, nrow2, key, emit);
     tout.setNumRow(r);
     std::cout << std::dec << r << " In q5Join_r_n" << std::endl;
 }
@@ -47,25 +42,23 @@ void q5Join_r_n(Table& tin1, Table& tin2, Table& tout) {
 // s_nationkey,s_suppkey,s_rowid(s_acctbal,s_name,s_address,s_phone,s_comment)
 void q5Join_t1_c(Table& tin1, Table& tin2, Table& tout) {
     int nrow1 = tin1.getNumRow();
-    std::unordered_multimap<int32_t, int32_t> ht1;
-    for (int i = 0; i < nrow1; i++) {
-        int32_t n_nationkey = tin1.getInt32(i, 0);
-        ht1.insert(std::make_pair(n_nationkey, 0));
-    }
-    int r = 0;
     int nrow2 = tin2.getNumRow();
-    for (int i = 0; i < nrow2; i++) {
-        int32_t c_nationkey = tin2.getInt32(i, 0);
-        auto its = ht1.equal_range(c_nationkey);
-        auto it = its.first;
-        while (it != its.second) {
-            int32_t c_custkey = tin2.getInt32(i, 1);
-            tout.setInt32(r, 0, c_custkey);
-            tout.setInt32(r, 1, c_nationkey);
-            it++;
-            r++;
-        }
-    }
+    const int32_t* n_nationkey = tin1.getColPtr<int32_t>(0);
+    cpu_ops::HashIndex ht1(nrow1, [&](int i, int64_t& k) {
+        k = n_nationkey[i];
+        return true;
+    });
+    const int32_t* c_nationkey = tin2.getColPtr<int32_t>(0);
+    const int32_t* c_custkey = tin2.getColPtr<int32_t>(1);
+    auto key = [&](int i, int64_t& k) {
+        k = c_nationkey[i];
+        return true;
+    };
+    auto emit = [&](int r, int i, int j) {
+        tout.setInt32(r, 0, c_custkey[i]);
+        tout.setInt32(r, 1, c_nationkey[i]);
+    };
+    int r = cpu_ops::hashJoin(ht1, nrow2, key, emit);
     tout.setNumRow(r);
     std::cout << std::dec << r << " In q5Join_t1_c" << std::endl;
 }
@@ -74,28 +67,24 @@ void q5Join_t1_c(Table& tin1, Table& tin2, Table& tout) {
 void q5Join_t2_o(Table& tin1, Table& tin2, Table& tout) {
     int nrow1 = tin1.getNumRow();
     int nrow2 = tin2.getNumRow();
-    std::unordered_multimap<int32_t, int32_t> ht1;
-    for (int i = 0; i < nrow1; i++) {
-        int32_t c_custkey = tin1.getInt32(i, 0);
-        int32_t c_nationkey = tin1.getInt32(i, 1);
-        ht1.insert(std::make_pair(c_custkey, c_nationkey));
-    }
-    int r = 0;
-    for (int i = 0; i < nrow2; i++) {
-        int32_t o_custkey = tin2.getInt32(i, 0);
-        int32_t o_orderkey = tin2.getInt32(i, 1);
-        int32_t o_orderdate = tin2.getInt32(i, 2);
-        if (o_orderdate >= 19940101 && o_orderdate < 19950101) {
-            auto its = ht1.equal_range(o_custkey);
-            auto it = its.first;
-            while (it != its.second) {
-                tout.setInt32(r, 0, o_orderkey);
-                tout.setInt32(r, 1, it->second);
-                it++;
-                r++;
-            }
-        }
-    }
+    const int32_t* c_custkey = tin1.getColPtr<int32_t>(0);
+    const int32_t* c_nationkey = tin1.getColPtr<int32_t>(1);
+    cpu_ops::HashIndex ht1(nrow1, [&](int i, int64_t& k) {
+        k = c_custkey[i];
+        return true;
+    });
+    const int32_t* o_custkey = tin2.getColPtr<int32_t>(0);
+    const int32_t* o_orderkey = tin2.getColPtr<int32_t>(1);
+    const int32_t* o_orderdate = tin2.getColPtr<int32_t>(2);
+    auto key = [&](int i, int64_t& k) {
+        k = o_custkey[i];
+        return o_orderdate[i] >= 19940101 && o_orderdate[i] < 19950101;
+    };
+    auto emit = [&](int r, int i, int j) {
+        tout.setInt32(r, 0, o_orderkey[i]);
+        tout.setInt32(r, 1, c_nationkey[j]);
+    };
+    int r = cpu_ops::hashJoin(ht1, nrow2, key, emit);
     tout.setNumRow(r);
     std::cout << std::dec << r << " In q5Join_t2_o" << std::endl;
 }
@@ -103,101 +92,74 @@ void q5Join_t2_o(Table& tin1, Table& tin2, Table& tout) {
 void q5Join_t3_l(Table& tin1, Table& tin2, Table& tout) {
     int nrow1 = tin1.getNumRow();
     int nrow2 = tin2.getNumRow();
-    std::unordered_multimap<int32_t, int32_t> ht1;
-    for (int i = 0; i < nrow1; i++) {
-        int32_t o_orderkey = tin1.getInt32(i, 0);
-        int32_t c_nationkey = tin1.getInt32(i, 1);
-        ht1.insert(std::make_pair(o_orderkey, c_nationkey));
-    }
-    int r = 0;
-    for (int i = 0; i < nrow2; i++) {
-        int32_t l_orderkey = tin2.getInt32(i, 0);
-        auto its = ht1.equal_range(l_orderkey);
-        auto it = its.first;
-        while (it != its.second) {
-            int32_t l_suppkey = tin2.getInt32(i, 1);
-            int32_t l_extendedprice = tin2.getInt32(i, 2);
-            int32_t l_discount = tin2.getInt32(i, 3);
-            int32_t c_nationkey = it->second;
-            int32_t e = l_extendedprice * (-l_discount + 100);
-            tout.setInt32(r, 0, l_suppkey);
-            tout.setInt32(r, 1, e);
-            tout.setInt32(r, 2, c_nationkey);
-            it++;
-            r++;
-        }
-    }
+    const int32_t* o_orderkey = tin1.getColPtr<int32_t>(0);
+    const int32_t* c_nationkey = tin1.getColPtr<int32_t>(1);
+    cpu_ops::HashIndex ht1(nrow1, [&](int i, int64_t& k) {
+        k = o_orderkey[i];
+        return true;
+    });
+    const int32_t* l_orderkey = tin2.getColPtr<int32_t>(0);
+    const int32_t* l_suppkey = tin2.getColPtr<int32_t>(1);
+    const int32_t* l_extendedprice = tin2.getColPtr<int32_t>(2);
+    const int32_t* l_discount = tin2.getColPtr<int32_t>(3);
+    auto key = [&](int i, int64_t& k) {
+        k = l_orderkey[i];
+        return true;
+    };
+    auto emit = [&](int r, int i, int j) {
+        int32_t e = l_extendedprice[i] * (-l_discount[i] + 100);
+        tout.setInt32(r, 0, l_suppkey[i]);
+        tout.setInt32(r, 1, e);
+        tout.setInt32(r, 2, c_nationkey[j]);
+    };
+    int r = cpu_ops::hashJoin(ht1, nrow2, key, emit);
     tout.setNumRow(r);
     std::cout << std::dec << r << " In q5Join_t3_l" << std::endl;
 }
-struct KeyA {
-    int32_t s_suppkey;
-    int32_t s_nationkey;
-    bool operator==(const KeyA& other) const {
-        return (s_suppkey == other.s_suppkey) && (s_nationkey == other.s_nationkey);
-    }
-};
-namespace std {
-template <>
-struct hash<KeyA> {
-    std::size_t operator()(const KeyA& k) const {
-        using std::size_t;
-        using std::hash;
-        using std::string;
-        return (hash<int>()(k.s_suppkey)) + (hash<int>()(k.s_nationkey));
-    }
-};
-}
 void q5Join_s_t4(Table& tin1, Table& tin2, Table& tout) {
     int nrow1 = tin1.getNumRow();
     int nrow2 = tin2.getNumRow();
     std::cout << "s_t4:" << nrow1 << " " << nrow2 << std::endl;
-    std::unordered_multimap<KeyA, int32_t> ht1;
-    for (int i = 0; i < nrow1; i++) {
-        int32_t s_suppkey = tin1.getInt32(i, 0);
-        int32_t s_nationkey = tin1.getInt32(i, 1);
-        KeyA keya{s_suppkey, s_nationkey};
-        ht1.insert(std::make_pair(keya, 0));
-    }
-    int r = 0;
-    for (int i = 0; i < nrow2; i++) {
-        int32_t l_suppkey = tin2.getInt32(i, 0);
-        int32_t e = tin2.getInt32(i, 1);
-        int32_t c_nationkey = tin2.getInt32(i, 2);
-        auto its = ht1.equal_range(KeyA{l_suppkey, c_nationkey});
-        auto it = its.first;
-        while (it != its.second) {
-            tout.setInt32(r, 0, e);
-            tout.setInt32(r, 1, c_nationkey);
-            it++;
-            r++;
-        }
-    }
+    const int32_t* s_suppkey = tin1.getColPtr<int32_t>(0);
+    const int32_t* s_nationkey = tin1.getColPtr<int32_t>(1);
+    cpu_ops::HashIndex ht1(nrow1, [&](int i, int64_t& k) {
+        k = cpu_ops::packKey(s_suppkey[i], s_nationkey[i]);
+        return true;
+    });
+    const int32_t* l_suppkey = tin2.getColPtr<int32_t>(0);
+    const int32_t* e = tin2.getColPtr<int32_t>(1);
+    const int32_t* c_nationkey = tin2.getColPtr<int32_t>(2);
+    auto key = [&](int i, int64_t& k) {
+        k = cpu_ops::packKey(l_suppkey[i], c_nationkey[i]);
+        return true;
+    };
+    auto emit = [&](int r, int i, int j) {
+        tout.setInt32(r, 0, e[i]);
+        tout.setInt32(r, 1, c_nationkey[i]);
+    };
+    int r = cpu_ops::hashJoin(ht1, nrow2, key, emit);
     tout.setNumRow(r);
     std::cout << std::dec << r << " In q5Join_s_t4" << std::endl;
 }
 void q5Join_t5_n(Table& tin1, Table& tin2, Table& tout) {
     int nrow1 = tin1.getNumRow();
     int nrow2 = tin2.getNumRow();
-    std::unordered_multimap<int32_t, int32_t> ht1;
-    for (int i = 0; i < nrow1; i++) {
-        int32_t e = tin1.getInt32(i, 0);
-        int32_t s_nationkey = tin1.getInt32(i, 1);
-        ht1.insert(std::make_pair(s_nationkey, e));
-    }
-    int r = 0;
-    for (int i = 0; i < nrow2; i++) {
-        int32_t n_nationkey = tin2.getInt32(i, 1);
-        auto its = ht1.equal_range(n_nationkey);
-        auto it = its.first;
-        while (it != its.second) {
-            std::array<char, TPCH_READ_NATION_LEN + 1> n_name = tin2.getcharN<char, TPCH_READ_NATION_LEN + 1>(i, 2);
-            tout.setInt32(r, 0, it->second);
-            tout.setcharN<char, TPCH_READ_NATION_LEN + 1>(r, 1, n_name);
-            it++;
-            r++;
-        }
-    }
+    const int32_t* e = tin1.getColPtr<int32_t>(0);
+    const int32_t* s_nationkey = tin1.getColPtr<int32_t>(1);
+    cpu_ops::HashIndex ht1(nrow1, [&](int i, int64_t& k) {
+        k = s_nationkey[i];
+        return true;
+    });
+    const int32_t* n_nationkey = tin2.getColPtr<int32_t>(1);
+    auto key = [&](int i, int64_t& k) {
+        k = n_nationkey[i];
+        return true;
+    };
+    auto emit = [&](int r, int i, int j) {
+        tout.setInt32(r, 0, e[j]);
+        tout.setcharN<char, TPCH_READ_NATION_LEN + 1>(r, 1, tin2.getcharN<char, TPCH_READ_NATION_LEN + 1>(i, 2));
+    };
+    int r = cpu_ops::hashJoin(ht1, nrow2, key, emit);
     tout.setNumRow(r);
     std::cout << std::dec << r << " In q5Join_t5_n" << std::endl;
 }
@@ -218,19 +180,15 @@ struct hash<q5GroupKey> {
 };
 }
 void q5GroupBy(Table& tin, Table& tout) {
-    std::unordered_map<q5GroupKey, int64_t> ht1;
-    for (int i = 0; i < tin.getNumRow(); i++) {
-        int32_t e = tin.getInt32(i, 0);
-        std::array<char, TPCH_READ_NATION_LEN + 1> n_name = tin.getcharN<char, TPCH_READ_NATION_LEN + 1>(i, 1);
-        q5GroupKey k{std::string(n_name.data())};
-        auto it = ht1.find(k);
-        if (it != ht1.end()) {
-            int64_t s = it->second + e;
-            ht1[k] = s;
-        } else {
-            ht1.insert(std::make_pair(k, e));
-        }
-    }
+    const int32_t* e = tin.getColPtr<int32_t>(0);
+    const char* n_name = tin.getColPtr<char>(1);
+    auto row = [&](int i, q5GroupKey& k, int64_t& v) {
+        k.n_name = n_name + (size_t)i * (TPCH_READ_NATION_LEN + 1);
+        v = e[i];
+        return true;
+    };
+    auto merge = [](int64_t& a, const int64_t& b) { a += b; };
+    auto ht1 = cpu_ops::parallelGroupBy<q5GroupKey, int64_t>(tin.getNumRow(), row, merge);
     int r = 0;
     for (auto& it : ht1) {
         std::array<char, TPCH_READ_NATION_LEN + 1> n_name{};
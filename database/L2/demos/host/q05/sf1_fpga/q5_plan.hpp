@@ -0,0 +1,137 @@
+/*
+ * Copyright 2019 Xilinx, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef Q5_PLAN_H
+#define Q5_PLAN_H
+
+// Q5 with the four gqeJoin steps of cfg.hpp described as a QueryPlan. The
+// plan and its temporary buffers are released on return, so the hand-written
+// flow can run afterwards on the same device. The lineitem join is also run
+// through PartJoin, with too little device memory to hold lineitem, and
+// checked against the plan.
+
+#include "gqe_part_join.hpp"
+#include "gqe_plan.hpp"
+
+#include <algorithm>
+#include <vector>
+
+// sorted rows of the first ncol columns of t
+std::vector<std::vector<int32_t> > q5Rows(Table& t, int ncol) {
+    std::vector<std::vector<int32_t> > rows(t.getNumRow(), std::vector<int32_t>(ncol));
+    for (int i = 0; i < t.getNumRow(); i++)
+        for (int c = 0; c < ncol; c++) rows[i][c] = t.getInt32(i, c);
+    std::sort(rows.begin(), rows.end());
+    return rows;
+}
+
+// tbs and th0 are the tables of test_q5.cpp, tout gets the sorted result
+int q5PlanRun(cl::Context& context,
+              cl::CommandQueue& q,
+              cl::Program& program,
+              Table* tbs,
+              Table& th0,
+              Table& tout,
+              int scale) {
+    Table pk0("pk0", 190000 * scale, 8, "");
+    Table pk1("pk1", 60000 * scale, 8, "");
+    Table pk2("pk2", 7500 * scale, 2, "");
+    pk0.allocateHost();
+    pk1.allocateHost();
+    pk2.allocateHost();
+    pk0.allocateDevBuffer(context, 32);
+    pk1.allocateDevBuffer(context, 32);
+    pk2.allocateDevBuffer(context, 32);
+
+    JoinSpec s1; // th0(n_nationkey) join customer(c_nationkey, c_custkey)
+    s1.key_a = {0};
+    s1.key_b = {0};
+    s1.out = {b_col(1), key_col(0)};
+
+    JoinSpec s2; // pk0 join orders(o_custkey, o_orderkey, o_orderdate)
+    s2.key_a = {0};
+    s2.key_b = {0};
+    s2.cond = {{b_col(2), 19940101, xf::database::FOP_GEU, 19950101, xf::database::FOP_LTU}};
+    s2.out = {b_col(1), a_col(1)};
+
+    JoinSpec s3; // pk1 join lineitem(l_orderkey, l_suppkey, l_extendedprice, l_discount)
+    s3.key_a = {0};
+    s3.key_b = {0};
+    s3.eval[0] = PlanEval("strm1*(-strm2+c2)", {b_col(2), b_col(3)}, 0, 100);
+    s3.out = {b_col(1), eval0_col(), a_col(1)};
+
+    JoinSpec s4; // supplier(s_suppkey, s_nationkey) join pk0 on both keys
+    s4.key_a = {0, 1};
+    s4.key_b = {0, 2};
+    s4.out = {b_col(1), key_col(1)};
+
+    {
+        QueryPlan plan(context, q, program);
+        if (plan.join(th0, tbs[2], pk0, s1) < 0 || plan.join(pk0, tbs[3], pk1, s2) < 0 ||
+            plan.join(pk1, tbs[4], pk0, s3) < 0 || plan.join(tbs[5], pk0, pk2, s4) < 0)
+            return -1;
+        // pk1 and the lineitem join result in pk0 are kept for PartJoin
+        plan.output(pk1);
+        plan.output(pk0);
+        plan.output(pk2);
+        plan.setup();
+
+        struct timeval tv_s, tv_e;
+        gettimeofday(&tv_s, 0);
+        q5Join_r_n(tbs[0], tbs[1], th0);
+        plan.run();
+        gettimeofday(&tv_e, 0);
+        plan.printTime();
+        std::cout << "QueryPlan: CPU execution time of Host " << tvdiff(&tv_s, &tv_e) / 1000 << " ms" << std::endl;
+    }
+
+    // same join, with lineitem partitioned in chunks of a 64 MB device budget
+    Table tpj("tpj", 190000 * scale, 3, "");
+    tpj.allocateHost();
+    PartJoin pj(context, q, program, (size_t)64 << 20);
+    if (pj.join(pk1, tbs[4], tpj, s3)) return -1;
+    if (q5Rows(tpj, 3) != q5Rows(pk0, 3)) {
+        std::cout << "ERROR: PartJoin returns " << tpj.getNumRow() << " rows, QueryPlan " << pk0.getNumRow()
+                  << " rows, or their rows differ." << std::endl;
+        return -1;
+    }
+    std::cout << "PartJoin: " << tpj.getNumRow() << " rows, same as QueryPlan" << std::endl;
+
+    q5Join_t5_n(pk2, tbs[1], pk0);
+    q5GroupBy(pk0, pk1);
+    q5Sort(pk1, tout);
+    return 0;
+}
+
+// compares the sorted results of q5Sort, returns the number of differences
+int q5Compare(Table& ta, Table& tb) {
+    int nerror = 0;
+    if (ta.getNumRow() != tb.getNumRow()) {
+        std::cout << "ERROR: " << ta.getNumRow() << " rows vs " << tb.getNumRow() << " rows" << std::endl;
+        return 1;
+    }
+    for (int i = 0; i < ta.getNumRow(); i++) {
+        std::array<char, TPCH_READ_NATION_LEN + 1> na = ta.getcharN<char, TPCH_READ_NATION_LEN + 1>(i, 0);
+        std::array<char, TPCH_READ_NATION_LEN + 1> nb = tb.getcharN<char, TPCH_READ_NATION_LEN + 1>(i, 0);
+        if (strcmp(na.data(), nb.data()) || ta.getInt64(i, 1) != tb.getInt64(i, 1)) {
+            std::cout << "ERROR: row " << i << ": " << na.data() << " " << ta.getInt64(i, 1) << " vs " << nb.data()
+                      << " " << tb.getInt64(i, 1) << std::endl;
+            nerror++;
+        }
+    }
+    return nerror;
+}
+
+#endif // Q5_PLAN_H
@@ -30,6 +30,7 @@
 const int PU_NM = 8;
 #include "gqe_api.hpp"
 #include "q5.hpp"
+#include "q5_plan.hpp"
 int main(int argc, const char* argv[]) {
     std::cout << "\n------------ TPC-H GQE (1G) -------------\n";
 
@@ -81,6 +82,11 @@ int main(int argc, const char* argv[]) {
         }
     }
     std::cout << "NOTE:running in sf" << scale << " data\n.";
+    std::string trace_file;
+    parser.getCmdOption("-trace", trace_file);
+    // also run the query as a QueryPlan and compare the results
+    std::string plan_str;
+    bool use_plan = parser.getCmdOption("-plan", plan_str);
     int32_t lineitem_n = SF1_LINEITEM;
     int32_t supplier_n = SF1_SUPPLIER;
     int32_t nation_n = SF1_NATION;
@@ -202,6 +208,15 @@ int main(int argc, const char* argv[]) {
 
     std::cout << "Table allocation device done." << std::endl;
 
+    Table tp("tp", 190000 * scale, 8, "");
+    if (use_plan) {
+        tp.allocateHost();
+        if (q5PlanRun(context, q, program, tbs, th0, tp, scale)) {
+            std::cout << "ERROR: QueryPlan failed." << std::endl;
+            return 1;
+        }
+    }
+
     /**
      * 5.kernels (host and device)
      */
@@ -273,7 +288,7 @@ int main(int argc, const char* argv[]) {
     transin.add(&th0);
     transin.host2dev(0, nullptr, &(eventsh2d_write[0][0]));
     //  q5Join_t1_c(th0,tbs[2],tk0);
-    krnlstep[0].run(0, &(eventsh2d_write[0]), &(events[1][0]));
+    krnlstep[0].run(0, &(eventsh2d_write[0]), &(events[0][0]));
     kernelInd++;
 
     // step3 : t2 order -> t3
@@ -281,8 +296,8 @@ int main(int argc, const char* argv[]) {
     transin1.add(&tbs[3]);
     transin1.host2dev(0, &(eventsh2d_write[0]), &(eventsh2d_write[1][0]));
     events_grp[1].push_back(eventsh2d_write[1][0]);
-    events_grp[1].push_back(events[1][0]);
-    krnlstep[1].run(0, &(events_grp[1]), &(events[2][0]));
+    events_grp[1].push_back(events[0][0]);
+    krnlstep[1].run(0, &(events_grp[1]), &(events[1][0]));
     kernelInd++;
 
     // step4 : t3 line -> t4
@@ -290,17 +305,17 @@ int main(int argc, const char* argv[]) {
     transin2.add(&tbs[4]);
     transin2.host2dev(0, &(eventsh2d_write[1]), &(eventsh2d_write[2][0]));
     events_grp[2].push_back(eventsh2d_write[2][0]);
-    events_grp[2].push_back(events[2][0]);
-    krnlstep[2].run(0, &(events_grp[2]), &(events[3][0]));
+    events_grp[2].push_back(events[1][0]);
+    krnlstep[2].run(0, &(events_grp[2]), &(events[2][0]));
     kernelInd++;
 
     // supplier t4-> t5
     //  q5Join_s_t4(tbs[5],tk0,tk2);
-    krnlstep[3].run(0, &(events[3]), &(events[4][0]));
+    krnlstep[3].run(0, &(events[2]), &(events[3][0]));
     kernelInd++;
 
     transout.add(&tk2);
-    transout.dev2host(0, &(events[4]), &(eventsd2h_read[0][0]));
+    transout.dev2host(0, &(events[3]), &(eventsd2h_read[0][0]));
     q.finish();
 
     gettimeofday(&tv_r_1, 0);
@@ -315,13 +330,33 @@ int main(int argc, const char* argv[]) {
     eventsh2d_write[0][0].getProfilingInfo(CL_PROFILING_COMMAND_START, &kstart);
     print_d_time(eventsh2d_write[0][0], eventsd2h_read[0][0], kstart, "all kernels", offset);
     print_d_time(eventsh2d_write[0][0], eventsh2d_write[0][0], kstart, "data trans kernel0", offset);
-    print_d_time(events[1][0], events[1][0], kstart, "kernel0", offset);
+    print_d_time(events[0][0], events[0][0], kstart, "kernel0", offset);
     print_d_time(eventsh2d_write[1][0], eventsh2d_write[1][0], kstart, "data trans kernel1", offset);
-    print_d_time(events[2][0], events[2][0], kstart, "kernel1", offset);
+    print_d_time(events[1][0], events[1][0], kstart, "kernel1", offset);
     print_d_time(eventsh2d_write[2][0], eventsh2d_write[2][0], kstart, "data trans kernel2", offset);
-    print_d_time(events[3][0], eventsd2h_read[0][0], kstart, "kernel2/3...", offset);
+    print_d_time(events[2][0], eventsd2h_read[0][0], kstart, "kernel2/3...", offset);
     print_h_time(tv_r_s, tv_r_1, tv_r_e, "Group&Sort..");
     std::cout << "CPU execution time of Host " << tvdiff(&tv_r_s, &tv_r_e) / 1000 << " ms" << std::endl;
 
+    if (!trace_file.empty()) {
+        TimeTrace trace(tv_r_s);
+        trace.alignDevice(tv_r_0);
+        trace.addHost("NationFilter", tv_r_s, tv_r_0);
+        for (int i = 0; i < 3; i++) trace.addEvents(eventsh2d_write[i], "h2d kernel" + std::to_string(i), "H2D");
+        for (int i = 0; i < NumSweep; i++) trace.addEvents(events[i], "kernel" + std::to_string(i), "kernel");
+        trace.addEvents(eventsd2h_read[0], "d2h kernel3", "D2H");
+        trace.addHost("Group&Sort", tv_r_1, tv_r_e);
+        trace.dump(trace_file);
+    }
+
+    if (use_plan) {
+        int nerror = q5Compare(tk0, tp);
+        if (nerror) {
+            std::cout << "FAIL: QueryPlan result differs in " << nerror << " rows." << std::endl;
+            return 1;
+        }
+        std::cout << "PASS: QueryPlan result matches." << std::endl;
+    }
+
     return 0;
 }
@@ -14,20 +14,27 @@
  * limitations under the License.
  */
 
+#include "cpu_ops.hpp"
+struct Q6Sum {
+    long long sum;
+    int r;
+    Q6Sum& operator+=(const Q6Sum& o) {
+        sum += o.sum;
+        r += o.r;
+        return *this;
+    }
+};
 void q6(Table& tin1, Table& tout) {
     int nrow = tin1.getNumRow();
-    long long sum = 0;
-    int r = 0;
-    for (int i = 0; i < nrow; i++) {
-        int32_t l_extendedprice = tin1.getInt32(i, 0);
-        int32_t l_discount = tin1.getInt32(i, 1);
-        int32_t l_shipdate = tin1.getInt32(i, 2);
-        int32_t l_quantity = tin1.getInt32(i, 3);
-        if (l_shipdate >= 19940101 && l_shipdate < 19950101 && l_discount >= 5 && l_discount <= 7 && l_quantity < 24) {
-            sum += (l_extendedprice * l_discount);
-            r++;
-        }
-    }
-    std::cout << std::dec << sum << " In q6" << std::endl;
-    printf("%d\n", r);
+    const int32_t* l_extendedprice = tin1.getColPtr<int32_t>(0);
+    const int32_t* l_discount = tin1.getColPtr<int32_t>(1);
+    const int32_t* l_shipdate = tin1.getColPtr<int32_t>(2);
+    const int32_t* l_quantity = tin1.getColPtr<int32_t>(3);
+    Q6Sum s = cpu_ops::parallelSum<Q6Sum>(nrow, [&](int i) {
+        bool hit = l_shipdate[i] >= 19940101 && l_shipdate[i] < 19950101 && l_discount[i] >= 5 && l_discount[i] <= 7 &&
+                   l_quantity[i] < 24;
+        return hit ? Q6Sum{l_extendedprice[i] * l_discount[i], 1} : Q6Sum{0, 0};
+    });
+    std::cout << std::dec << s.sum << " In q6" << std::endl;
+    printf("%d\n", s.r);
 }
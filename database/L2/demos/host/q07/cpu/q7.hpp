@@ -13,21 +13,21 @@
  * See the License for the specific language governing permissions and
  * limitations under the License.
  */
+#include "cpu_ops.hpp"
 // t1 //t6
 void NationFilter(Table& tin, Table& tout) {
     int nrow = tin.getNumRow();
-    int r = 0;
-    for (int i = 0; i < nrow; i++) {
-        std::array<char, TPCH_READ_NATION_LEN + 1> n_name = tin.getcharN<char, TPCH_READ_NATION_LEN + 1>(i, 1);
-        if (!strcmp("FRANCE", n_name.data()) || !strcmp("GERMANY", n_name.data())) {
-            int32_t n_nationkey = tin.getInt32(i, 0);
-            int32_t n_rowid = i;
-            tout.setInt32(r, 0, n_nationkey);
-            tout.setInt32(r, 1, n_rowid);
-            // tout.setcharN<char,TPCH_READ_NATION_LEN + 1>(r,1,n_name);
-            r++;
-        }
-    }
+    const int32_t* n_nationkey = tin.getColPtr<int32_t>(0);
+    const char* n_name = tin.getColPtr<char>(1);
+    auto pred = [&](int i) {
+        const char* name = n_name + i * (TPCH_READ_NATION_LEN + 1);
+        return !strcmp("FRANCE", name) || !strcmp("GERMANY", name);
+    };
+    auto emit = [&](int r, int i) {
+        tout.setInt32(r, 0, n_nationkey[i]);
+        tout.setInt32(r, 1, i); // n_rowid
+    };
+    int r = cpu_ops::parallelFilter(nrow, pred, emit);
     tout.setNumRow(r);
     std::cout << std::dec << r << " In NationFilter" << std::endl;
 }
@@ -36,23 +36,24 @@ void NationFilter(Table& tin, Table& tout) {
 void q7Join_t1_s(Table& tin1, Table& tin2, Table& tout) {
     int nrow1 = tin1.getNumRow();
     int nrow2 = tin2.getNumRow();
-    std::unordered_map<int32_t, int32_t> ht1;
-    for (int i = 0; i < nrow1; i++) {
-        ht1.insert(std::make_pair(tin1.getInt32(i, 0), tin1.getInt32(i, 1)));
-    }
-    int r = 0;
-    for (int i = 0; i < nrow2; i++) {
-        int32_t s_nationkey = tin2.getInt32(i, 0);
-        auto it = ht1.find(s_nationkey);
-        if (it != ht1.end()) {
-            int32_t s_suppkey = tin2.getInt32(i, 1);
-            int32_t n_rowid = it->second;
-            tout.setInt32(r, 0, s_nationkey);
-            tout.setInt32(r, 1, n_rowid);
-            tout.setInt32(r, 2, s_suppkey);
-            r++;
-        }
-    }
+    const int32_t* n_nationkey = tin1.getColPtr<int32_t>(0);
+    const int32_t* n_rowid = tin1.getColPtr<int32_t>(1);
+    cpu_ops::HashIndex ht1(nrow1, [&](int i, int64_t& k) {
+        k = n_nationkey[i];
+        return true;
+    });
+    const int32_t* s_nationkey = tin2.getColPtr<int32_t>(0);
+    const int32_t* s_suppkey = tin2.getColPtr<int32_t>(1);
+    auto key = [&](int i, int64_t& k) {
+        k = s_nationkey[i];
+        return true;
+    };
+    auto emit = [&](int r, int i, int j) {
+        tout.setInt32(r, 0, s_nationkey[i]);
+        tout.setInt32(r, 1, n_rowid[j]);
+        tout.setInt32(r, 2, s_suppkey[i]);
+    };
+    int r = cpu_ops::hashJoinFirst(ht1, nrow2, key, emit);
     tout.setNumRow(r);
     std::cout << std::dec << r << " In q7Join_t1_s" << std::endl;
 }
@@ -61,41 +62,31 @@ void q7Join_t1_s(Table& tin1, Table& tin2, Table& tout) {
 void q7Join_t2_l(Table& tin1, Table& tin2, Table& tout) {
     int nrow1 = tin1.getNumRow();
     int nrow2 = tin2.getNumRow();
-    struct Key {
-        int32_t n_nationkey;
-        int32_t n_rowid;
+    const int32_t* n_nationkey = tin1.getColPtr<int32_t>(0);
+    const int32_t* n_rowid = tin1.getColPtr<int32_t>(1);
+    const int32_t* s_suppkey = tin1.getColPtr<int32_t>(2);
+    cpu_ops::HashIndex ht1(nrow1, [&](int i, int64_t& k) {
+        k = s_suppkey[i];
+        return true;
+    });
+    const int32_t* l_orderkey = tin2.getColPtr<int32_t>(0);
+    const int32_t* l_suppkey = tin2.getColPtr<int32_t>(1);
+    const int32_t* l_shipdate = tin2.getColPtr<int32_t>(2);
+    const int32_t* l_extendedprice = tin2.getColPtr<int32_t>(3);
+    const int32_t* l_discount = tin2.getColPtr<int32_t>(4);
+    auto key = [&](int i, int64_t& k) {
+        k = l_suppkey[i];
+        return l_shipdate[i] >= 19950101 && l_shipdate[i] <= 19961231;
     };
-
-    std::unordered_map<int32_t, Key> ht1;
-    for (int i = 0; i < nrow1; i++) {
-        int32_t n_nationkey = tin1.getInt32(i, 0);
-        int32_t n_rowid = tin1.getInt32(i, 1);
-        int32_t s_suppkey = tin1.getInt32(i, 2);
-        ht1.insert(std::make_pair(s_suppkey, Key{n_nationkey, n_rowid}));
-    }
-
-    int r = 0;
-    for (int i = 0; i < nrow2; i++) {
-        int32_t l_orderkey = tin2.getInt32(i, 0);
-        int32_t l_suppkey = tin2.getInt32(i, 1);
-        int32_t l_shipdate = tin2.getInt32(i, 2);
-        int32_t l_extendedprice = tin2.getInt32(i, 3);
-        int32_t l_discount = tin2.getInt32(i, 4);
-        if (l_shipdate >= 19950101 && l_shipdate <= 19961231) {
-            auto it = ht1.find(l_suppkey);
-            if (it != ht1.end()) {
-                int32_t n_nationkey = it->second.n_nationkey;
-                int32_t n_rowid = it->second.n_rowid;
-                int32_t e = l_extendedprice * (100 - l_discount);
-                tout.setInt32(r, 0, n_nationkey);
-                tout.setInt32(r, 1, n_rowid);
-                tout.setInt32(r, 2, l_orderkey);
-                tout.setInt32(r, 3, l_shipdate);
-                tout.setInt32(r, 4, e);
-                r++;
-            }
-        }
-    }
+    auto emit = [&](int r, int i, int j) {
+        int32_t e = l_extendedprice[i] * (100 - l_discount[i]);
+        tout.setInt32(r, 0, n_nationkey[j]);
+        tout.setInt32(r, 1, n_rowid[j]);
+        tout.setInt32(r, 2, l_orderkey[i]);
+        tout.setInt32(r, 3, l_shipdate[i]);
+        tout.setInt32(r, 4, e);
+    };
+    int r = cpu_ops::hashJoinFirst(ht1, nrow2, key, emit);
     tout.setNumRow(r);
     std::cout << std::dec << r << " In q7Join_t2_l" << std::endl;
 }
@@ -104,31 +95,29 @@ void q7Join_t2_l(Table& tin1, Table& tin2, Table& tout) {
 void q7Join_o_t3(Table& tin1, Table& tin2, Table& tout) {
     int nrow1 = tin1.getNumRow();
     int nrow2 = tin2.getNumRow();
-    std::unordered_map<int32_t, int32_t> ht1;
-    for (int i = 0; i < nrow1; i++) {
-        int32_t o_orderkey = tin1.getInt32(i, 0);
-        int32_t o_custkey = tin1.getInt32(i, 1);
-        ht1.insert(std::make_pair(o_orderkey, o_custkey));
-    }
-
-    int r = 0;
-    for (int i = 0; i < nrow2; i++) {
-        int32_t l_orderkey = tin2.getInt32(i, 2);
-        auto it = ht1.find(l_orderkey);
-        if (it != ht1.end()) {
-            int32_t n_nationkey = tin2.getInt32(i, 0);
-            int32_t n_rowid = tin2.getInt32(i, 1);
-            int32_t o_custkey = it->second;
-            int32_t l_shipdate = tin2.getInt32(i, 3);
-            int32_t e = tin2.getInt32(i, 4);
-            tout.setInt32(r, 0, n_nationkey);
-            tout.setInt32(r, 1, n_rowid);
-            tout.setInt32(r, 2, o_custkey);
-            tout.setInt32(r, 3, l_shipdate);
-            tout.setInt32(r, 4, e);
-            r++;
-        }
-    }
+    const int32_t* o_orderkey = tin1.getColPtr<int32_t>(0);
+    const int32_t* o_custkey = tin1.getColPtr<int32_t>(1);
+    cpu_ops::HashIndex ht1(nrow1, [&](int i, int64_t& k) {
+        k = o_orderkey[i];
+        return true;
+    });
+    const int32_t* n_nationkey = tin2.getColPtr<int32_t>(0);
+    const int32_t* n_rowid = tin2.getColPtr<int32_t>(1);
+    const int32_t* l_orderkey = tin2.getColPtr<int32_t>(2);
+    const int32_t* l_shipdate = tin2.getColPtr<int32_t>(3);
+    const int32_t* e = tin2.getColPtr<int32_t>(4);
+    auto key = [&](int i, int64_t& k) {
+        k = l_orderkey[i];
+        return true;
+    };
+    auto emit = [&](int r, int i, int j) {
+        tout.setInt32(r, 0, n_nationkey[i]);
+        tout.setInt32(r, 1, n_rowid[i]);
+        tout.setInt32(r, 2, o_custkey[j]);
+        tout.setInt32(r, 3, l_shipdate[i]);
+        tout.setInt32(r, 4, e[i]);
+    };
+    int r = cpu_ops::hashJoinFirst(ht1, nrow2, key, emit);
     tout.setNumRow(r);
     std::cout << std::dec << r << " In q7Join_o_t3" << std::endl;
 }
@@ -136,31 +125,29 @@ void q7Join_o_t3(Table& tin1, Table& tin2, Table& tout) {
 void q7Join_c_t4(Table& tin1, Table& tin2, Table& tout) {
     int nrow1 = tin1.getNumRow();
     int nrow2 = tin2.getNumRow();
-    std::unordered_map<int32_t, int32_t> ht1;
-    for (int i = 0; i < nrow1; i++) {
-        int32_t c_custkey = tin1.getInt32(i, 0);
-        int32_t c_nationkey = tin1.getInt32(i, 1);
-        ht1.insert(std::make_pair(c_custkey, c_nationkey));
-    }
-
-    int r = 0;
-    for (int i = 0; i < nrow2; i++) {
-        int32_t o_custkey = tin2.getInt32(i, 2);
-        auto it = ht1.find(o_custkey);
-        if (it != ht1.end()) {
-            int32_t n_nationkey = tin2.getInt32(i, 0);
-            int32_t n_rowid = tin2.getInt32(i, 1);
-            int32_t c_nationkey = it->second;
-            int32_t l_shipdate = tin2.getInt32(i, 3);
-            int32_t e = tin2.getInt32(i, 4);
-            tout.setInt32(r, 0, n_nationkey);
-            tout.setInt32(r, 1, n_rowid);
-            tout.setInt32(r, 2, c_nationkey);
-            tout.setInt32(r, 3, l_shipdate);
-            tout.setInt32(r, 4, e);
-            r++;
-        }
-    }
+    const int32_t* c_custkey = tin1.getColPtr<int32_t>(0);
+    const int32_t* c_nationkey = tin1.getColPtr<int32_t>(1);
+    cpu_ops::HashIndex ht1(nrow1, [&](int i, int64_t& k) {
+        k = c_custkey[i];
+        return true;
+    });
+    const int32_t* n_nationkey = tin2.getColPtr<int32_t>(0);
+    const int32_t* n_rowid = tin2.getColPtr<int32_t>(1);
+    const int32_t* o_custkey = tin2.getColPtr<int32_t>(2);
+    const int32_t* l_shipdate = tin2.getColPtr<int32_t>(3);
+    const int32_t* e = tin2.getColPtr<int32_t>(4);
+    auto key = [&](int i, int64_t& k) {
+        k = o_custkey[i];
+        return true;
+    };
+    auto emit = [&](int r, int i, int j) {
+        tout.setInt32(r, 0, n_nationkey[i]);
+        tout.setInt32(r, 1, n_rowid[i]);
+        tout.setInt32(r, 2, c_nationkey[j]);
+        tout.setInt32(r, 3, l_shipdate[i]);
+        tout.setInt32(r, 4, e[i]);
+    };
+    int r = cpu_ops::hashJoinFirst(ht1, nrow2, key, emit);
     tout.setNumRow(r);
     std::cout << std::dec << r << " In q7Join_o_t3" << std::endl;
 }
@@ -169,33 +156,28 @@ void q7Join_c_t4(Table& tin1, Table& tin2, Table& tout) {
 void q7Join_t6_t5(Table& tin1, Table& tin2, Table& tout) {
     int nrow1 = tin1.getNumRow();
     int nrow2 = tin2.getNumRow();
-    std::unordered_map<int32_t, int32_t> ht1;
-    for (int i = 0; i < nrow1; i++) {
-        int32_t n_nationkey = tin1.getInt32(i, 0);
-        int32_t n_rowid = tin1.getInt32(i, 1);
-        ;
-        ht1.insert(std::make_pair(n_nationkey, n_rowid));
-    }
-
-    int r = 0;
-    for (int i = 0; i < nrow2; i++) {
-        int32_t n_nationkey = tin2.getInt32(i, 0);
-        int32_t n_rowid_t5 = tin2.getInt32(i, 1);
-        int32_t c_nationkey = tin2.getInt32(i, 2);
-        int32_t l_shipdate = tin2.getInt32(i, 3);
-        int32_t e = tin2.getInt32(i, 4);
-        if (n_nationkey != c_nationkey) {
-            auto it = ht1.find(c_nationkey);
-            if (it != ht1.end()) {
-                int32_t n_rowid_t6 = it->second;
-                tout.setInt32(r, 0, n_rowid_t5);
-                tout.setInt32(r, 1, n_rowid_t6);
-                tout.setInt32(r, 2, l_shipdate);
-                tout.setInt32(r, 3, e);
-                r++;
-            }
-        }
-    }
+    const int32_t* n_nationkey = tin1.getColPtr<int32_t>(0);
+    const int32_t* n_rowid = tin1.getColPtr<int32_t>(1);
+    cpu_ops::HashIndex ht1(nrow1, [&](int i, int64_t& k) {
+        k = n_nationkey[i];
+        return true;
+    });
+    const int32_t* n_nationkey_t5 = tin2.getColPtr<int32_t>(0);
+    const int32_t* n_rowid_t5 = tin2.getColPtr<int32_t>(1);
+    const int32_t* c_nationkey = tin2.getColPtr<int32_t>(2);
+    const int32_t* l_shipdate = tin2.getColPtr<int32_t>(3);
+    const int32_t* e = tin2.getColPtr<int32_t>(4);
+    auto key = [&](int i, int64_t& k) {
+        k = c_nationkey[i];
+        return n_nationkey_t5[i] != c_nationkey[i];
+    };
+    auto emit = [&](int r, int i, int j) {
+        tout.setInt32(r, 0, n_rowid_t5[i]);
+        tout.setInt32(r, 1, n_rowid[j]);
+        tout.setInt32(r, 2, l_shipdate[i]);
+        tout.setInt32(r, 3, e[i]);
+    };
+    int r = cpu_ops::hashJoinFirst(ht1, nrow2, key, emit);
     tout.setNumRow(r);
     std::cout << std::dec << r << " In q7Join_t6_t5" << std::endl;
 }
@@ -222,25 +204,20 @@ struct hash<q7GroupBy> {
 };
 }
 void q7Group(Table& tin, Table& origin, Table& tout) {
-    std::unordered_map<q7GroupBy, int64_t> ht1;
-    for (int i = 0; i < tin.getNumRow(); i++) {
-        int32_t n_rowid_t5 = tin.getInt32(i, 0);
-        int32_t n_rowid_t6 = tin.getInt32(i, 1);
-        int32_t l_shipdate = tin.getInt32(i, 2) / 10000;
-        int32_t e = tin.getInt32(i, 3);
-        std::array<char, TPCH_READ_NATION_LEN + 1> supp_nation =
-            origin.getcharN<char, TPCH_READ_NATION_LEN + 1>(n_rowid_t5, 1);
-        std::array<char, TPCH_READ_NATION_LEN + 1> cust_nation =
-            origin.getcharN<char, TPCH_READ_NATION_LEN + 1>(n_rowid_t6, 1);
-        q7GroupBy k{std::string(supp_nation.data()), std::string(cust_nation.data()), l_shipdate};
-        auto it = ht1.find(k);
-        if (it != ht1.end()) {
-            int64_t s = it->second + e;
-            ht1[k] = s;
-        } else {
-            ht1.insert(std::make_pair(k, e));
-        }
-    }
+    const int32_t* n_rowid_t5 = tin.getColPtr<int32_t>(0);
+    const int32_t* n_rowid_t6 = tin.getColPtr<int32_t>(1);
+    const int32_t* l_shipdate = tin.getColPtr<int32_t>(2);
+    const int32_t* e = tin.getColPtr<int32_t>(3);
+    const char* n_name = origin.getColPtr<char>(1);
+    auto row = [&](int i, q7GroupBy& k, int64_t& v) {
+        k.supp_nation = n_name + n_rowid_t5[i] * (TPCH_READ_NATION_LEN + 1);
+        k.cust_nation = n_name + n_rowid_t6[i] * (TPCH_READ_NATION_LEN + 1);
+        k.l_shipdate = l_shipdate[i] / 10000;
+        v = e[i];
+        return true;
+    };
+    auto merge = [](int64_t& a, const int64_t& b) { a += b; };
+    auto ht1 = cpu_ops::parallelGroupBy<q7GroupBy, int64_t>(tin.getNumRow(), row, merge);
     int r = 0;
     for (auto& it : ht1) {
         std::array<char, TPCH_READ_NATION_LEN + 1> supp_nation{};
@@ -13,30 +13,27 @@
  * See the License for the specific language governing permissions and
  * limitations under the License.
  */
+#include "cpu_ops.hpp"
 // t1:5 rows
 // select count(*) from region,nation,customer where n_regionkey = r_regionkey and r_name = 'AMERICA' and c_nationkey =
 // n_nationkey
 void q8Join_r_n(Table& tin1, Table& tin2, Table& tout) {
     int nrow1 = tin1.getNumRow();
     int nrow2 = tin2.getNumRow();
-    std::unordered_map<int32_t, int32_t> ht1;
-    for (int i = 0; i < nrow1; i++) {
-        std::array<char, TPCH_READ_REGION_LEN + 1> r_name = tin1.getcharN<char, TPCH_READ_REGION_LEN + 1>(i, 1);
-        if (!strcmp("AMERICA", r_name.data())) {
-            int32_t r_regionkey = tin1.getInt32(i, 0);
-            ht1.insert(std::make_pair(r_regionkey, 0));
-        }
-    }
-    int r = 0;
-    for (int i = 0; i < nrow2; i++) {
-        int32_t n_regionkey = tin2.getInt32(i, 0);
-        auto it = ht1.find(n_regionkey);
-        if (it != ht1.end()) {
-            int32_t n_nationkey = tin2.getInt32(i, 1);
-            tout.setInt32(r, 0, n_nationkey);
-            r++;
-        }
-    }
+    const int32_t* r_regionkey = tin1.getColPtr<int32_t>(0);
+    const char* r_name = tin1.getColPtr<char>(1);
+    cpu_ops::HashIndex ht1(nrow1, [&](int i, int64_t& k) {
+        k = r_regionkey[i];
+        return !strcmp("AMERICA", r_name + i * (TPCH_READ_REGION_LEN + 1));
+    });
+    const int32_t* n_regionkey = tin2.getColPtr<int32_t>(0);
+    const int32_t* n_nationkey = tin2.getColPtr<int32_t>(1);
+    auto key = [&](int i, int64_t& k) {
+        k = n_regionkey[i];
+        return true;
+    };
+    auto emit = [&](int r, int i) { tout.setInt32(r, 0, n_nationkey[i]); };
+    int r = cpu_ops::hashSemiJoin(ht1, nrow2, key, emit);
     tout.setNumRow(r);
     std::cout << std::dec << r << " q8Join_r_n" << std::endl;
 }
@@ -46,21 +43,20 @@ void q8Join_r_n(Table& tin1, Table& tin2, Table& tout) {
 // n_nationkey;
 void q8Join_t1_c(Table& tin1, Table& tin2, Table& tout) {
     int nrow1 = tin1.getNumRow();
-    std::unordered_map<int32_t, int32_t> ht1;
-    for (int i = 0; i < nrow1; i++) {
-        ht1.insert(std::make_pair(tin1.getInt32(i, 0), 0));
-    }
-    int r = 0;
     int nrow2 = tin2.getNumRow();
-    for (int i = 0; i < nrow2; i++) {
-        int32_t c_nationkey = tin2.getInt32(i, 0);
-        auto it = ht1.find(c_nationkey);
-        if (it != ht1.end()) {
-            int32_t c_custkey = tin2.getInt32(i, 1);
-            tout.setInt32(r, 0, c_custkey);
-            r++;
-        }
-    }
+    const int32_t* n_nationkey = tin1.getColPtr<int32_t>(0);
+    cpu_ops::HashIndex ht1(nrow1, [&](int i, int64_t& k) {
+        k = n_nationkey[i];
+        return true;
+    });
+    const int32_t* c_nationkey = tin2.getColPtr<int32_t>(0);
+    const int32_t* c_custkey = tin2.getColPtr<int32_t>(1);
+    auto key = [&](int i, int64_t& k) {
+        k = c_nationkey[i];
+        return true;
+    };
+    auto emit = [&](int r, int i) { tout.setInt32(r, 0, c_custkey[i]); };
+    int r = cpu_ops::hashSemiJoin(ht1, nrow2, key, emit);
     tout.setNumRow(r);
     std::cout << std::dec << r << " q8Join_t1_c" << std::endl;
 }
@@ -71,30 +67,24 @@ void q8Join_t1_c(Table& tin1, Table& tin2, Table& tout) {
 void q8Join_t2_o(Table& tin1, Table& tin2, Table& tout) {
     int nrow1 = tin1.getNumRow();
     int nrow2 = tin2.getNumRow();
-    std::unordered_map<int32_t, int32_t> ht1;
     std::cout << std::dec << nrow1 << " " << nrow2 << std::endl;
-    for (int i = 0; i < nrow1; i++) {
-        int32_t c_custkey = tin1.getInt32(i, 0);
-        ht1.insert(std::make_pair(c_custkey, 0));
-    }
-
-    int r = 0;
-    for (int i = 0; i < nrow2; i++) {
-        //        std::cout<<i<<std::endl;
-        int32_t o_orderdate = tin2.getInt32(i, 2);
-        if (o_orderdate >= 19950101 && o_orderdate <= 19961231) {
-            int32_t o_custkey = tin2.getInt32(i, 0);
-            int32_t o_orderkey = tin2.getInt32(i, 1);
-            auto it = ht1.find(o_custkey);
-            if (it != ht1.end()) {
-                tout.setInt32(r, 0, o_orderkey);
-                tout.setInt32(r, 1, o_orderdate);
-                // if(r<10) std::cout<<std::dec<<tout.getInt32(r,0)<<" "<<tout.getInt32(r,1)<<std::endl;
-                r++;
-            }
-        }
-    }
-
+    const int32_t* c_custkey = tin1.getColPtr<int32_t>(0);
+    cpu_ops::HashIndex ht1(nrow1, [&](int i, int64_t& k) {
+        k = c_custkey[i];
+        return true;
+    });
+    const int32_t* o_custkey = tin2.getColPtr<int32_t>(0);
+    const int32_t* o_orderkey = tin2.getColPtr<int32_t>(1);
+    const int32_t* o_orderdate = tin2.getColPtr<int32_t>(2);
+    auto key = [&](int i, int64_t& k) {
+        k = o_custkey[i];
+        return o_orderdate[i] >= 19950101 && o_orderdate[i] <= 19961231;
+    };
+    auto emit = [&](int r, int i) {
+        tout.setInt32(r, 0, o_orderkey[i]);
+        tout.setInt32(r, 1, o_orderdate[i]);
+    };
+    int r = cpu_ops::hashSemiJoin(ht1, nrow2, key, emit);
     tout.setNumRow(r);
     std::cout << std::dec << r << " q8Join_t2_o" << std::endl;
 }
@@ -111,32 +101,29 @@ void q8Join_t2_o(Table& tin1, Table& tin2, Table& tout) {
 void q8Join_t3_l(Table& tin1, Table& tin2, Table& tout) {
     int nrow1 = tin1.getNumRow();
     int nrow2 = tin2.getNumRow();
-    std::unordered_map<int32_t, int32_t> ht1;
-    for (int i = 0; i < nrow1; i++) {
-        int32_t o_orderkey = tin1.getInt32(i, 0);
-        int32_t o_orderdate = tin1.getInt32(i, 1);
-        ht1.insert(std::make_pair(o_orderkey, o_orderdate));
-    }
-
-    int r = 0;
-    for (int i = 0; i < nrow2; i++) {
-        int32_t l_orderkey = tin2.getInt32(i, 0);
-        auto it = ht1.find(l_orderkey);
-        if (it != ht1.end()) {
-            int32_t l_partkey = tin2.getInt32(i, 1);
-            int32_t l_suppkey = tin2.getInt32(i, 2);
-            int32_t l_extendedprice = tin2.getInt32(i, 3);
-            int32_t l_discount = tin2.getInt32(i, 4);
-            int32_t o_orderdate = it->second;
-            int32_t e = l_extendedprice * (100 - l_discount);
-            tout.setInt32(r, 0, l_partkey);
-            tout.setInt32(r, 1, l_suppkey);
-            tout.setInt32(r, 2, e);
-            tout.setInt32(r, 3, o_orderdate);
-            // if(r<10) std::cout<<std::dec<<tout.getInt32(r,0)<<std::endl;
-            r++;
-        }
-    }
+    const int32_t* o_orderkey = tin1.getColPtr<int32_t>(0);
+    const int32_t* o_orderdate = tin1.getColPtr<int32_t>(1);
+    cpu_ops::HashIndex ht1(nrow1, [&](int i, int64_t& k) {
+        k = o_orderkey[i];
+        return true;
+    });
+    const int32_t* l_orderkey = tin2.getColPtr<int32_t>(0);
+    const int32_t* l_partkey = tin2.getColPtr<int32_t>(1);
+    const int32_t* l_suppkey = tin2.getColPtr<int32_t>(2);
+    const int32_t* l_extendedprice = tin2.getColPtr<int32_t>(3);
+    const int32_t* l_discount = tin2.getColPtr<int32_t>(4);
+    auto key = [&](int i, int64_t& k) {
+        k = l_orderkey[i];
+        return true;
+    };
+    auto emit = [&](int r, int i, int j) {
+        int32_t e = l_extendedprice[i] * (100 - l_discount[i]);
+        tout.setInt32(r, 0, l_partkey[i]);
+        tout.setInt32(r, 1, l_suppkey[i]);
+        tout.setInt32(r, 2, e);
+        tout.setInt32(r, 3, o_orderdate[j]);
+    };
+    int r = cpu_ops::hashJoinFirst(ht1, nrow2, key, emit);
     tout.setNumRow(r);
     std::cout << std::dec << r << " q8Join_t3_l" << std::endl;
 }
@@ -144,15 +131,11 @@ void q8Join_t3_l(Table& tin1, Table& tin2, Table& tout) {
 // select count(*) from part where p_type = 'ECONOMY ANODIZED STEEL';
 void q8Filter_p(Table& tin, Table& tout) {
     int nrow = tin.getNumRow();
-    int r = 0;
-    for (int i = 0; i < nrow; i++) {
-        std::array<char, TPCH_READ_P_TYPE_LEN + 1> p_type = tin.getcharN<char, TPCH_READ_P_TYPE_LEN + 1>(i, 1);
-        if (!strcmp("ECONOMY ANODIZED STEEL", p_type.data())) {
-            int32_t p_partkey = tin.getInt32(i, 0);
-            tout.setInt32(r, 0, p_partkey);
-            r++;
-        }
-    }
+    const int32_t* p_partkey = tin.getColPtr<int32_t>(0);
+    const char* p_type = tin.getColPtr<char>(1);
+    auto pred = [&](int i) { return !strcmp("ECONOMY ANODIZED STEEL", p_type + i * (TPCH_READ_P_TYPE_LEN + 1)); };
+    auto emit = [&](int r, int i) { tout.setInt32(r, 0, p_partkey[i]); };
+    int r = cpu_ops::parallelFilter(nrow, pred, emit);
     tout.setNumRow(r);
     std::cout << std::dec << r << " q8Filter_p" << std::endl;
 }
@@ -164,26 +147,27 @@ void q8Filter_p(Table& tin, Table& tout) {
 void q8Join_t5_t4(Table& tin1, Table& tin2, Table& tout) {
     int nrow1 = tin1.getNumRow();
     int nrow2 = tin2.getNumRow();
-    std::unordered_map<int32_t, int32_t> ht1;
-    for (int i = 0; i < nrow1; i++) {
-        int32_t p_partkey = tin1.getInt32(i, 0);
-        ht1.insert(std::make_pair(p_partkey, 0));
-    }
-    int r = 0;
-    for (int i = 0; i < nrow2; i++) {
-        int32_t l_partkey = tin2.getInt32(i, 0);
-        auto it = ht1.find(l_partkey);
-        if (it != ht1.end()) {
-            int32_t l_suppkey = tin2.getInt32(i, 1);
-            int32_t e = tin2.getInt32(i, 2);
-            int32_t o_orderdate = tin2.getInt32(i, 3);
-            tout.setInt32(r, 0, l_suppkey);
-            tout.setInt32(r, 1, e);
-            tout.setInt32(r, 2, o_orderdate);
-            if (r < 10) std::cout << std::dec << l_suppkey << " " << o_orderdate << std::endl;
-            r++;
-        }
-    }
+    const int32_t* p_partkey = tin1.getColPtr<int32_t>(0);
+    cpu_ops::HashIndex ht1(nrow1, [&](int i, int64_t& k) {
+        k = p_partkey[i];
+        return true;
+    });
+    const int32_t* l_partkey = tin2.getColPtr<int32_t>(0);
+    const int32_t* l_suppkey = tin2.getColPtr<int32_t>(1);
+    const int32_t* e = tin2.getColPtr<int32_t>(2);
+    const int32_t* o_orderdate = tin2.getColPtr<int32_t>(3);
+    auto key = [&](int i, int64_t& k) {
+        k = l_partkey[i];
+        return true;
+    };
+    auto emit = [&](int r, int i) {
+        tout.setInt32(r, 0, l_suppkey[i]);
+        tout.setInt32(r, 1, e[i]);
+        tout.setInt32(r, 2, o_orderdate[i]);
+    };
+    int r = cpu_ops::hashSemiJoin(ht1, nrow2, key, emit);
+    for (int i = 0; i < r && i < 10; i++)
+        std::cout << std::dec << tout.getInt32(i, 0) << " " << tout.getInt32(i, 2) << std::endl;
     tout.setNumRow(r);
     std::cout << std::dec << r << " q8Join_t5_t4" << std::endl;
 }
@@ -192,27 +176,27 @@ void q8Join_t5_t4(Table& tin1, Table& tin2, Table& tout) {
 void q8Join_s_t6(Table& tin1, Table& tin2, Table& tout) {
     int nrow1 = tin1.getNumRow();
     int nrow2 = tin2.getNumRow();
-    std::unordered_map<int32_t, int32_t> ht1;
-    for (int i = 0; i < nrow1; i++) {
-        int32_t s_suppkey = tin1.getInt32(i, 0);
-        int32_t s_nationkey = tin1.getInt32(i, 1);
-        ht1.insert(std::make_pair(s_suppkey, s_nationkey));
-    }
-    int r = 0;
-    for (int i = 0; i < nrow2; i++) {
-        int32_t l_suppkey = tin2.getInt32(i, 0);
-        auto it = ht1.find(l_suppkey);
-        if (it != ht1.end()) {
-            int32_t s_nationkey = it->second;
-            int32_t e = tin2.getInt32(i, 1);
-            int32_t o_orderdate = tin2.getInt32(i, 2);
-            tout.setInt32(r, 0, s_nationkey);
-            tout.setInt32(r, 1, e);
-            tout.setInt32(r, 2, o_orderdate);
-            if (r < 10) std::cout << std::dec << s_nationkey << " " << o_orderdate << std::endl;
-            r++;
-        }
-    }
+    const int32_t* s_suppkey = tin1.getColPtr<int32_t>(0);
+    const int32_t* s_nationkey = tin1.getColPtr<int32_t>(1);
+    cpu_ops::HashIndex ht1(nrow1, [&](int i, int64_t& k) {
+        k = s_suppkey[i];
+        return true;
+    });
+    const int32_t* l_suppkey = tin2.getColPtr<int32_t>(0);
+    const int32_t* e = tin2.getColPtr<int32_t>(1);
+    const int32_t* o_orderdate = tin2.getColPtr<int32_t>(2);
+    auto key = [&](int i, int64_t& k) {
+        k = l_suppkey[i];
+        return true;
+    };
+    auto emit = [&](int r, int i, int j) {
+        tout.setInt32(r, 0, s_nationkey[j]);
+        tout.setInt32(r, 1, e[i]);
+        tout.setInt32(r, 2, o_orderdate[i]);
+    };
+    int r = cpu_ops::hashJoinFirst(ht1, nrow2, key, emit);
+    for (int i = 0; i < r && i < 10; i++)
+        std::cout << std::dec << tout.getInt32(i, 0) << " " << tout.getInt32(i, 2) << std::endl;
     tout.setNumRow(r);
     std::cout << std::dec << r << " q8Join_s_t6" << std::endl;
 }
@@ -220,44 +204,40 @@ void q8Join_s_t6(Table& tin1, Table& tin2, Table& tout) {
 void q8Join_n_t7(Table& tin1, Table& tin2, Table& tout) {
     int nrow1 = tin1.getNumRow();
     int nrow2 = tin2.getNumRow();
-    std::unordered_map<int32_t, int32_t> ht1;
-    for (int i = 0; i < nrow1; i++) {
-        int32_t n_nationkey = tin1.getInt32(i, 1);
-        // int32_t n_rowid = i;//tin1.getInt32(i,1);
-        int32_t n_rowid = tin1.getInt32(i, 3);
-        ht1.insert(std::make_pair(n_nationkey, n_rowid));
-    }
-    int r = 0;
-    for (int i = 0; i < nrow2; i++) {
-        int32_t s_nationkey = tin2.getInt32(i, 0);
-        auto it = ht1.find(s_nationkey);
-        if (it != ht1.end()) {
-            int32_t e = tin2.getInt32(i, 1);
-            int32_t o_orderdate = tin2.getInt32(i, 2);
-            int32_t n_rowid = it->second;
-            tout.setInt32(r, 0, e);
-            tout.setInt32(r, 1, o_orderdate / 10000);
-            tout.setInt32(r, 2, n_rowid);
-            r++;
-        }
-    }
+    const int32_t* n_nationkey = tin1.getColPtr<int32_t>(1);
+    // int32_t n_rowid = i;//tin1.getInt32(i,1);
+    const int32_t* n_rowid = tin1.getColPtr<int32_t>(3);
+    cpu_ops::HashIndex ht1(nrow1, [&](int i, int64_t& k) {
+        k = n_nationkey[i];
+        return true;
+    });
+    const int32_t* s_nationkey = tin2.getColPtr<int32_t>(0);
+    const int32_t* e = tin2.getColPtr<int32_t>(1);
+    const int32_t* o_orderdate = tin2.getColPtr<int32_t>(2);
+    auto key = [&](int i, int64_t& k) {
+        k = s_nationkey[i];
+        return true;
+    };
+    auto emit = [&](int r, int i, int j) {
+        tout.setInt32(r, 0, e[i]);
+        tout.setInt32(r, 1, o_orderdate[i] / 10000);
+        tout.setInt32(r, 2, n_rowid[j]);
+    };
+    int r = cpu_ops::hashJoinFirst(ht1, nrow2, key, emit);
     tout.setNumRow(r);
     std::cout << std::dec << r << " q8Join_n_t7" << std::endl;
 }
 // for siyang tow group_bys
 void q8GroupBy(Table& tin, Table& tout) {
-    std::unordered_map<int32_t, int64_t> ht1;
-    for (int i = 0; i < tin.getNumRow(); i++) {
-        int32_t e = tin.getInt32(i, 0);
-        int32_t o_year = tin.getInt32(i, 1);
-        auto it = ht1.find(o_year);
-        if (it != ht1.end()) {
-            int64_t s = it->second + e;
-            ht1[o_year] = s;
-        } else {
-            ht1.insert(std::make_pair(o_year, e));
-        }
-    }
+    const int32_t* e = tin.getColPtr<int32_t>(0);
+    const int32_t* o_year = tin.getColPtr<int32_t>(1);
+    auto row = [&](int i, int32_t& k, int64_t& v) {
+        k = o_year[i];
+        v = e[i];
+        return true;
+    };
+    auto merge = [](int64_t& a, const int64_t& b) { a += b; };
+    auto ht1 = cpu_ops::parallelGroupBy<int32_t, int64_t>(tin.getNumRow(), row, merge);
     int r = 0;
     for (auto& it : ht1) {
         tout.setInt32(r, 0, it.first);
@@ -268,23 +248,17 @@ void q8GroupBy(Table& tin, Table& tout) {
 }
 
 void q8GroupBy_filtern(Table& tin, Table& origin, Table& tout) {
-    std::unordered_map<int32_t, int64_t> ht1;
-    for (int i = 0; i < tin.getNumRow(); i++) {
-        int32_t e = tin.getInt32(i, 0);
-        int32_t o_year = tin.getInt32(i, 1);
-        int32_t n_rowid = tin.getInt32(i, 2);
-        std::array<char, TPCH_READ_NATION_LEN + 1> n_name = origin.getcharN<char, TPCH_READ_NATION_LEN + 1>(n_rowid, 2);
-        if (strcmp("BRAZIL", n_name.data())) {
-            e = 0;
-        }
-        auto it = ht1.find(o_year);
-        if (it != ht1.end()) {
-            int64_t s = it->second + e;
-            ht1[o_year] = s;
-        } else {
-            ht1.insert(std::make_pair(o_year, e));
-        }
-    }
+    const int32_t* e = tin.getColPtr<int32_t>(0);
+    const int32_t* o_year = tin.getColPtr<int32_t>(1);
+    const int32_t* n_rowid = tin.getColPtr<int32_t>(2);
+    const char* n_name = origin.getColPtr<char>(2);
+    auto row = [&](int i, int32_t& k, int64_t& v) {
+        k = o_year[i];
+        v = strcmp("BRAZIL", n_name + n_rowid[i] * (TPCH_READ_NATION_LEN + 1)) ? 0 : e[i];
+        return true;
+    };
+    auto merge = [](int64_t& a, const int64_t& b) { a += b; };
+    auto ht1 = cpu_ops::parallelGroupBy<int32_t, int64_t>(tin.getNumRow(), row, merge);
     int r = 0;
     for (auto& it : ht1) {
         tout.setInt32(r, 0, it.first);
@@ -300,26 +274,21 @@ void q8GroupBy_all(Table& tin, Table& origin, Table& tout) {
         int64_t all;
         int64_t filter;
     };
-
-    std::unordered_map<int32_t, Values> ht1;
-    for (int i = 0; i < tin.getNumRow(); i++) {
-        int32_t e = tin.getInt32(i, 0);
-        int32_t e0 = e;
-        int32_t o_year = tin.getInt32(i, 1);
-        int32_t n_rowid = tin.getInt32(i, 2);
-        std::array<char, TPCH_READ_NATION_LEN + 1> n_name = origin.getcharN<char, TPCH_READ_NATION_LEN + 1>(n_rowid, 2);
-        if (strcmp("BRAZIL", n_name.data())) {
-            e0 = 0;
-        }
-        auto it = ht1.find(o_year);
-        if (it != ht1.end()) {
-            int64_t s = it->second.all + e;
-            int64_t s0 = it->second.filter + e0;
-            ht1[o_year] = Values{s, s0};
-        } else {
-            ht1.insert(std::make_pair(o_year, Values{e, e0}));
-        }
-    }
+    const int32_t* e = tin.getColPtr<int32_t>(0);
+    const int32_t* o_year = tin.getColPtr<int32_t>(1);
+    const int32_t* n_rowid = tin.getColPtr<int32_t>(2);
+    const char* n_name = origin.getColPtr<char>(2);
+    auto row = [&](int i, int32_t& k, Values& v) {
+        int32_t e0 = strcmp("BRAZIL", n_name + n_rowid[i] * (TPCH_READ_NATION_LEN + 1)) ? 0 : e[i];
+        k = o_year[i];
+        v = Values{e[i], e0};
+        return true;
+    };
+    auto merge = [](Values& a, const Values& b) {
+        a.all += b.all;
+        a.filter += b.filter;
+    };
+    auto ht1 = cpu_ops::parallelGroupBy<int32_t, Values>(tin.getNumRow(), row, merge);
     int r = 0;
     for (auto& it : ht1) {
         tout.setInt32(r, 0, it.first);
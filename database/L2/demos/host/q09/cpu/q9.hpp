@@ -13,19 +13,16 @@
  * See the License for the specific language governing permissions and
  * limitations under the License.
  */
+#include "cpu_ops.hpp"
 // t1 //t6
 void PartFilter(Table& tin, Table& tout) {
     int nrow = tin.getNumRow();
-    int r = 0;
-    for (int i = 0; i < nrow; i++) {
-        std::array<char, TPCH_READ_P_NAME_LEN + 1> p_name = tin.getcharN<char, TPCH_READ_P_NAME_LEN + 1>(i, 1);
-        //        if(std::regex_match(p_name.data(), std::regex("(.*)(green)(.*)"))){
-        if (std::string(p_name.data()).find("green") != std::string::npos) {
-            int32_t p_partkey = tin.getInt32(i, 0);
-            tout.setInt32(r, 0, p_partkey);
-            r++;
-        }
-    }
+    const int32_t* p_partkey = tin.getColPtr<int32_t>(0);
+    const char* p_name = tin.getColPtr<char>(1);
+    //        if(std::regex_match(p_name.data(), std::regex("(.*)(green)(.*)"))){
+    auto pred = [&](int i) { return strstr(p_name + i * (TPCH_READ_P_NAME_LEN + 1), "green") != nullptr; };
+    auto emit = [&](int r, int i) { tout.setInt32(r, 0, p_partkey[i]); };
+    int r = cpu_ops::parallelFilter(nrow, pred, emit);
     tout.setNumRow(r);
     std::cout << std::dec << r << " after PartFilter" << std::endl;
 }
@@ -33,27 +30,26 @@ void PartFilter(Table& tin, Table& tout) {
 // t2
 void q9Join_t1_ps(Table& tin1, Table& tin2, Table& tout) {
     int nrow1 = tin1.getNumRow();
-    std::unordered_multimap<int32_t, int32_t> ht1;
-    for (int i = 0; i < nrow1; i++) {
-        ht1.insert(std::make_pair(tin1.getInt32(i, 0), 0));
-    }
+    const int32_t* p_partkey = tin1.getColPtr<int32_t>(0);
+    cpu_ops::HashIndex ht1(nrow1, [&](int i, int64_t& k) {
+        k = p_partkey[i];
+        return true;
+    });
     std::cout << std::dec << ht1.size() << " " << std::endl;
-    int r = 0;
     int nrow2 = tin2.getNumRow();
-    for (int i = 0; i < nrow2; i++) {
-        int32_t ps_partkey = tin2.getInt32(i, 0);
-        auto its = ht1.equal_range(ps_partkey);
-        auto it = its.first;
-        while (it != its.second) {
-            int32_t ps_suppkey = tin2.getInt32(i, 1);
-            int32_t ps_supplycost = tin2.getInt32(i, 2);
-            tout.setInt32(r, 0, ps_suppkey);
-            tout.setInt32(r, 1, ps_partkey);
-            tout.setInt32(r, 2, ps_supplycost);
-            it++;
-            r++;
-        }
-    }
+    const int32_t* ps_partkey = tin2.getColPtr<int32_t>(0);
+    const int32_t* ps_suppkey = tin2.getColPtr<int32_t>(1);
+    const int32_t* ps_supplycost = tin2.getColPtr<int32_t>(2);
+    auto key = [&](int i, int64_t& k) {
+        k = ps_partkey[i];
+        return true;
+    };
+    auto emit = [&](int r, int i, int j) {
+        tout.setInt32(r, 0, ps_suppkey[i]);
+        tout.setInt32(r, 1, ps_partkey[i]);
+        tout.setInt32(r, 2, ps_supplycost[i]);
+    };
+    int r = cpu_ops::hashJoin(ht1, nrow2, key, emit);
     tout.setNumRow(r);
     std::cout << std::dec << r << " after q9Join_t1_ps" << std::endl;
 }
@@ -62,93 +58,59 @@ void q9Join_t1_ps(Table& tin1, Table& tin2, Table& tout) {
 void q9Join_s_t2(Table& tin1, Table& tin2, Table& tout) {
     int nrow1 = tin1.getNumRow();
     int nrow2 = tin2.getNumRow();
-    std::unordered_multimap<int32_t, int32_t> ht1;
-    for (int i = 0; i < nrow1; i++) {
-        int32_t s_suppkey = tin1.getInt32(i, 0);
-        int32_t s_nationkey = tin1.getInt32(i, 1);
-        ht1.insert(std::make_pair(s_suppkey, s_nationkey));
-    }
-    int r = 0;
-    for (int i = 0; i < nrow2; i++) {
-        int32_t ps_suppkey = tin2.getInt32(i, 0);
-        auto its = ht1.equal_range(ps_suppkey);
-        auto it = its.first;
-        while (it != its.second) {
-            int32_t ps_partkey = tin2.getInt32(i, 1);
-            int32_t ps_supplycost = tin2.getInt32(i, 2);
-            int32_t s_nationkey = it->second;
-            tout.setInt32(r, 0, ps_suppkey);
-            tout.setInt32(r, 1, ps_partkey);
-            tout.setInt32(r, 2, s_nationkey);
-            tout.setInt32(r, 3, ps_supplycost);
-            it++;
-            r++;
-        }
-    }
+    const int32_t* s_suppkey = tin1.getColPtr<int32_t>(0);
+    const int32_t* s_nationkey = tin1.getColPtr<int32_t>(1);
+    cpu_ops::HashIndex ht1(nrow1, [&](int i, int64_t& k) {
+        k = s_suppkey[i];
+        return true;
+    });
+    const int32_t* ps_suppkey = tin2.getColPtr<int32_t>(0);
+    const int32_t* ps_partkey = tin2.getColPtr<int32_t>(1);
+    const int32_t* ps_supplycost = tin2.getColPtr<int32_t>(2);
+    auto key = [&](int i, int64_t& k) {
+        k = ps_suppkey[i];
+        return true;
+    };
+    auto emit = [&](int r, int i, int j) {
+        tout.setInt32(r, 0, ps_suppkey[i]);
+        tout.setInt32(r, 1, ps_partkey[i]);
+        tout.setInt32(r, 2, s_nationkey[j]);
+        tout.setInt32(r, 3, ps_supplycost[i]);
+    };
+    int r = cpu_ops::hashJoin(ht1, nrow2, key, emit);
     tout.setNumRow(r);
     std::cout << std::dec << r << " after q9Join_s_t2" << std::endl;
 }
 
 // t4
-struct q9hashkey {
-    int32_t s_suppkey;
-    int32_t ps_partkey;
-    bool operator==(const q9hashkey& other) const {
-        return (s_suppkey == other.s_suppkey) && (ps_partkey == other.ps_partkey);
-    }
-};
-namespace std {
-template <>
-struct hash<q9hashkey> {
-    std::size_t operator()(const q9hashkey& k) const {
-        using std::size_t;
-        using std::hash;
-        return (hash<int>()(k.s_suppkey)) + (hash<int>()(k.ps_partkey));
-    }
-};
-}
 void q9Join_t3_l(Table& tin1, Table& tin2, Table& tout) {
     int nrow1 = tin1.getNumRow();
     int nrow2 = tin2.getNumRow();
-
-    struct q9hashvalue {
-        int32_t s_nationkey;
-        int32_t ps_supplycost;
+    const int32_t* s_suppkey = tin1.getColPtr<int32_t>(0);
+    const int32_t* ps_partkey = tin1.getColPtr<int32_t>(1);
+    const int32_t* s_nationkey = tin1.getColPtr<int32_t>(2);
+    const int32_t* ps_supplycost = tin1.getColPtr<int32_t>(3);
+    cpu_ops::HashIndex ht1(nrow1, [&](int i, int64_t& k) {
+        k = cpu_ops::packKey(s_suppkey[i], ps_partkey[i]);
+        return true;
+    });
+    const int32_t* l_suppkey = tin2.getColPtr<int32_t>(0);
+    const int32_t* l_partkey = tin2.getColPtr<int32_t>(1);
+    const int32_t* l_orderkey = tin2.getColPtr<int32_t>(2);
+    const int32_t* l_extendedprice = tin2.getColPtr<int32_t>(3);
+    const int32_t* l_discount = tin2.getColPtr<int32_t>(4);
+    const int32_t* l_quantity = tin2.getColPtr<int32_t>(5);
+    auto key = [&](int i, int64_t& k) {
+        k = cpu_ops::packKey(l_suppkey[i], l_partkey[i]);
+        return true;
     };
-
-    std::unordered_multimap<q9hashkey, q9hashvalue> ht1;
-    for (int i = 0; i < nrow1; i++) {
-        int32_t s_suppkey = tin1.getInt32(i, 0);
-        int32_t ps_partkey = tin1.getInt32(i, 1);
-        int32_t s_nationkey = tin1.getInt32(i, 2);
-        int32_t ps_supplycost = tin1.getInt32(i, 3);
-        ht1.insert(std::make_pair(q9hashkey{s_suppkey, ps_partkey}, q9hashvalue{s_nationkey, ps_supplycost}));
-    }
-    int r = 0;
-    for (int i = 0; i < nrow2; i++) {
-        int32_t l_suppkey = tin2.getInt32(i, 0);
-        int32_t l_partkey = tin2.getInt32(i, 1);
-        auto its = ht1.equal_range(q9hashkey{l_suppkey, l_partkey});
-        auto it = its.first;
-        while (it != its.second) {
-            int32_t ps_supplycost = it->second.ps_supplycost;
-            int32_t s_nationkey = it->second.s_nationkey;
-            int32_t l_orderkey = tin2.getInt32(i, 2);
-            int32_t l_extendedprice = tin2.getInt32(i, 3);
-            int32_t l_discount = tin2.getInt32(i, 4);
-            int32_t l_quantity = tin2.getInt32(i, 5);
-            int32_t e = l_extendedprice * (100 - l_discount) - 100 * ps_supplycost * l_quantity;
-            // if(r<10) std::cout<<s_nationkey<<" "<<l_orderkey<<std::endl;
-            // if(r<10) std::cout<<l_extendedprice<<" "<<l_discount<<" "<<l_quantity<<" "<<ps_supplycost<<"
-            // "<<e<<std::endl;
-
-            tout.setInt32(r, 0, l_orderkey);
-            tout.setInt32(r, 1, s_nationkey);
-            tout.setInt32(r, 2, e);
-            it++;
-            r++;
-        }
-    }
+    auto emit = [&](int r, int i, int j) {
+        int32_t e = l_extendedprice[i] * (100 - l_discount[i]) - 100 * ps_supplycost[j] * l_quantity[i];
+        tout.setInt32(r, 0, l_orderkey[i]);
+        tout.setInt32(r, 1, s_nationkey[j]);
+        tout.setInt32(r, 2, e);
+    };
+    int r = cpu_ops::hashJoin(ht1, nrow2, key, emit);
     tout.setNumRow(r);
     std::cout << std::dec << r << " after q9Join_t3_l" << std::endl;
 }
@@ -156,29 +118,25 @@ void q9Join_t3_l(Table& tin1, Table& tin2, Table& tout) {
 void q9Join_o_t4(Table& tin1, Table& tin2, Table& tout) {
     int nrow1 = tin1.getNumRow();
     int nrow2 = tin2.getNumRow();
-    std::unordered_multimap<int32_t, int32_t> ht1;
-    for (int i = 0; i < nrow1; i++) {
-        int32_t o_orderkey = tin1.getInt32(i, 0);
-        int32_t o_orderdate = tin1.getInt32(i, 1);
-        ht1.insert(std::make_pair(o_orderkey, o_orderdate));
-    }
-
-    int r = 0;
-    for (int i = 0; i < nrow2; i++) {
-        int32_t l_orderkey = tin2.getInt32(i, 0);
-        auto its = ht1.equal_range(l_orderkey);
-        auto it = its.first;
-        while (it != its.second) {
-            int32_t s_nationkey = tin2.getInt32(i, 1);
-            int32_t eval0 = tin2.getInt32(i, 2);
-            int32_t o_orderdate = it->second;
-            tout.setInt32(r, 0, s_nationkey);
-            tout.setInt32(r, 1, o_orderdate);
-            tout.setInt32(r, 2, eval0);
-            it++;
-            r++;
-        }
-    }
+    const int32_t* o_orderkey = tin1.getColPtr<int32_t>(0);
+    const int32_t* o_orderdate = tin1.getColPtr<int32_t>(1);
+    cpu_ops::HashIndex ht1(nrow1, [&](int i, int64_t& k) {
+        k = o_orderkey[i];
+        return true;
+    });
+    const int32_t* l_orderkey = tin2.getColPtr<int32_t>(0);
+    const int32_t* s_nationkey = tin2.getColPtr<int32_t>(1);
+    const int32_t* eval0 = tin2.getColPtr<int32_t>(2);
+    auto key = [&](int i, int64_t& k) {
+        k = l_orderkey[i];
+        return true;
+    };
+    auto emit = [&](int r, int i, int j) {
+        tout.setInt32(r, 0, s_nationkey[i]);
+        tout.setInt32(r, 1, o_orderdate[j]);
+        tout.setInt32(r, 2, eval0[i]);
+    };
+    int r = cpu_ops::hashJoin(ht1, nrow2, key, emit);
     tout.setNumRow(r);
     std::cout << std::dec << r << " after q9Join_o_t4" << std::endl;
 }
@@ -186,32 +144,25 @@ void q9Join_o_t4(Table& tin1, Table& tin2, Table& tout) {
 void q9Join_n_t5(Table& tin1, Table& tin2, Table& tout) {
     int nrow1 = tin1.getNumRow();
     int nrow2 = tin2.getNumRow();
-    std::unordered_multimap<int32_t, int32_t> ht1;
-    for (int i = 0; i < nrow1; i++) {
-        int32_t n_nationkey = tin1.getInt32(i, 0);
-        int32_t n_rowid = tin1.getInt32(i, 2);
-        // std::array<char,TPCH_READ_NATION_LEN+1> n_name = tin1.getcharN<char,TPCH_READ_NATION_LEN+1>(i,0);
-        ht1.insert(std::make_pair(n_nationkey, n_rowid));
-    }
-
-    int r = 0;
-    for (int i = 0; i < nrow2; i++) {
-        int32_t s_nationkey = tin2.getInt32(i, 0);
-        auto its = ht1.equal_range(s_nationkey);
-        auto it = its.first;
-        while (it != its.second) {
-            int32_t o_orderdate = tin2.getInt32(i, 1);
-            int32_t eval0 = tin2.getInt32(i, 2);
-            int32_t n_rowid = it->second;
-            //  std::array<char,TPCH_READ_NATION_LEN+1> n_name = it->second;
-            //  tout.setcharN<char,TPCH_READ_NATION_LEN+1>(i,0,n_name);
-            tout.setInt32(r, 0, n_rowid);
-            tout.setInt32(r, 1, o_orderdate);
-            tout.setInt32(r, 2, eval0);
-            it++;
-            r++;
-        }
-    }
+    const int32_t* n_nationkey = tin1.getColPtr<int32_t>(0);
+    const int32_t* n_rowid = tin1.getColPtr<int32_t>(2);
+    cpu_ops::HashIndex ht1(nrow1, [&](int i, int64_t& k) {
+        k = n_nationkey[i];
+        return true;
+    });
+    const int32_t* s_nationkey = tin2.getColPtr<int32_t>(0);
+    const int32_t* o_orderdate = tin2.getColPtr<int32_t>(1);
+    const int32_t* eval0 = tin2.getColPtr<int32_t>(2);
+    auto key = [&](int i, int64_t& k) {
+        k = s_nationkey[i];
+        return true;
+    };
+    auto emit = [&](int r, int i, int j) {
+        tout.setInt32(r, 0, n_rowid[j]);
+        tout.setInt32(r, 1, o_orderdate[i]);
+        tout.setInt32(r, 2, eval0[i]);
+    };
+    int r = cpu_ops::hashJoin(ht1, nrow2, key, emit);
     tout.setNumRow(r);
     std::cout << std::dec << r << " after q9Join_n_t5" << std::endl;
 }
@@ -236,22 +187,18 @@ struct hash<q9GroupByKey> {
 };
 }
 void q9GroupBy(Table& tin, Table& origin, Table& tout) {
-    std::unordered_map<q9GroupByKey, int64_t> ht1;
-    for (int i = 0; i < tin.getNumRow(); i++) {
-        int32_t n_rowid = tin.getInt32(i, 0);
-        std::array<char, TPCH_READ_NATION_LEN + 1> n_name = origin.getcharN<char, TPCH_READ_NATION_LEN + 1>(n_rowid, 1);
-        //       if(i<30) std::cout<<n_name.data()<<" "<<std::endl;
-        int32_t o_orderdate = tin.getInt32(i, 1) / 10000; // get the year
-        int32_t e = tin.getInt32(i, 2);
-        q9GroupByKey k{std::string(n_name.data()), o_orderdate};
-        auto it = ht1.find(k);
-        if (it != ht1.end()) {
-            int64_t s = it->second + e;
-            ht1[k] = s;
-        } else {
-            ht1.insert(std::make_pair(k, e));
-        }
-    }
+    const int32_t* n_rowid = tin.getColPtr<int32_t>(0);
+    const int32_t* o_orderdate = tin.getColPtr<int32_t>(1);
+    const int32_t* e = tin.getColPtr<int32_t>(2);
+    const char* n_name = origin.getColPtr<char>(1);
+    auto row = [&](int i, q9GroupByKey& k, int64_t& v) {
+        // get the year
+        k = q9GroupByKey{std::string(n_name + n_rowid[i] * (TPCH_READ_NATION_LEN + 1)), o_orderdate[i] / 10000};
+        v = e[i];
+        return true;
+    };
+    auto merge = [](int64_t& a, const int64_t& b) { a += b; };
+    auto ht1 = cpu_ops::parallelGroupBy<q9GroupByKey, int64_t>(tin.getNumRow(), row, merge);
     int r = 0;
     for (auto& it : ht1) {
         std::string n_name = it.first.n_name;
@@ -14,111 +14,86 @@
  * limitations under the License.
  */
 #include <unordered_map>
+#include "cpu_ops.hpp"
 // order and lineitem
 void q10Join_O_L(Table& tin1, Table& tin2, Table& tout) {
-    std::unordered_map<int32_t, int32_t> ht1;
     int nrow1 = tin1.getNumRow();
-    for (int i = 0; i < nrow1; ++i) {
-        int o_orderdate = tin1.getInt32(i, 0);
-        if (19931001 <= o_orderdate && o_orderdate < 19940101) {
-            int o_orderkey = tin1.getInt32(i, 1);
-            int o_custkey = tin1.getInt32(i, 2);
-            ht1.insert(std::make_pair(o_orderkey, o_custkey));
-        }
-    }
-    struct lineitem {
-        int32_t l_orderkey;
-        int32_t l_extendedprice;
-        int32_t l_discount;
-    };
-    std::vector<lineitem> ht2;
+    const int32_t* o_orderdate = tin1.getColPtr<int32_t>(0);
+    const int32_t* o_orderkey = tin1.getColPtr<int32_t>(1);
+    const int32_t* o_custkey = tin1.getColPtr<int32_t>(2);
+    cpu_ops::HashIndex ht1(nrow1, [&](int i, int64_t& k) {
+        k = o_orderkey[i];
+        return 19931001 <= o_orderdate[i] && o_orderdate[i] < 19940101;
+    });
     int nrow2 = tin2.getNumRow();
-    for (int i = 0; i < nrow2; ++i) {
-        int l_returnflag = tin2.getInt32(i, 0);
-        if (l_returnflag == 'R') { // 82
-            // l_orderkey,l_extendedprice,l_discount
-            int l_orderkey = tin2.getInt32(i, 1);
-            int l_extendedprice = tin2.getInt32(i, 2);
-            int l_discount = tin2.getInt32(i, 3);
-            ht2.push_back(lineitem{l_orderkey, l_extendedprice, l_discount});
-        }
-    }
-    int r = 0;
-    for (size_t i = 0; i < ht2.size(); i++) {
-        int32_t l_orderkey = ht2[i].l_orderkey;
-        auto it1 = ht1.find(l_orderkey);
-        if (it1 != ht1.end()) {
-            int o_custkey = it1->second;
-            int l_extendedprice = ht2[i].l_extendedprice;
-            int l_discount = ht2[i].l_discount;
-            int32_t revenue = (-l_discount + 100) * l_extendedprice;
-            tout.setInt32(r, 0, o_custkey);
-            tout.setInt32(r, 1, revenue);
-            r++;
-        }
-    }
+    const int32_t* l_returnflag = tin2.getColPtr<int32_t>(0);
+    const int32_t* l_orderkey = tin2.getColPtr<int32_t>(1);
+    const int32_t* l_extendedprice = tin2.getColPtr<int32_t>(2);
+    const int32_t* l_discount = tin2.getColPtr<int32_t>(3);
+    auto key = [&](int i, int64_t& k) {
+        k = l_orderkey[i];
+        return l_returnflag[i] == 'R'; // 82
+    };
+    auto emit = [&](int r, int i, int j) {
+        int32_t revenue = (-l_discount[i] + 100) * l_extendedprice[i];
+        tout.setInt32(r, 0, o_custkey[j]);
+        tout.setInt32(r, 1, revenue);
+    };
+    int r = cpu_ops::hashJoinFirst(ht1, nrow2, key, emit);
     tout.setNumRow(r);
     std::cout << std::dec << r << " out q10Join_O_L" << std::endl;
 }
 void q10Join_C_O1(Table& tin1, Table& tin2, Table& tout) {
-    struct KeyC {
-        int32_t c_nationkey;
-        int32_t c_rowid;
-    };
-
-    std::unordered_map<int32_t, KeyC> ht1;
     int nrow1 = tin1.getNumRow();
-    for (int i = 0; i < nrow1; ++i) {
-        int c_custkey = tin1.getInt32(i, 0);
-        int c_nationkey = tin1.getInt32(i, 1);
-        int c_rowid = tin1.getInt32(i, 2);
-        ht1.insert(std::make_pair(c_custkey, KeyC{c_nationkey, c_rowid}));
-    }
-    int r = 0;
+    const int32_t* c_custkey = tin1.getColPtr<int32_t>(0);
+    const int32_t* c_nationkey = tin1.getColPtr<int32_t>(1);
+    const int32_t* c_rowid = tin1.getColPtr<int32_t>(2);
+    cpu_ops::HashIndex ht1(nrow1, [&](int i, int64_t& k) {
+        k = c_custkey[i];
+        return true;
+    });
     int nrow2 = tin2.getNumRow();
-    for (int i = 0; i < nrow2; i++) {
-        int o_custkey = tin2.getInt32(i, 0);
-        auto it = ht1.find(o_custkey);
-        if (it != ht1.end()) {
-            int c_nationkey = it->second.c_nationkey;
-            int c_rowid = it->second.c_rowid;
-            int revenue = tin2.getInt32(i, 1);
-            tout.setInt32(r, 0, c_nationkey);
-            tout.setInt32(r, 1, o_custkey);
-            tout.setInt32(r, 2, c_rowid);
-            tout.setInt32(r, 3, revenue);
-            r++;
-        }
-    }
+    const int32_t* o_custkey = tin2.getColPtr<int32_t>(0);
+    const int32_t* revenue = tin2.getColPtr<int32_t>(1);
+    auto key = [&](int i, int64_t& k) {
+        k = o_custkey[i];
+        return true;
+    };
+    auto emit = [&](int r, int i, int j) {
+        tout.setInt32(r, 0, c_nationkey[j]);
+        tout.setInt32(r, 1, o_custkey[i]);
+        tout.setInt32(r, 2, c_rowid[j]);
+        tout.setInt32(r, 3, revenue[i]);
+    };
+    int r = cpu_ops::hashJoinFirst(ht1, nrow2, key, emit);
     tout.setNumRow(r);
     std::cout << std::dec << r << " out q10Join_C_O1" << std::endl;
 }
 void q10Join_N_O2(Table& tin1, Table& tin2, Table& tout) {
-    std::unordered_map<int32_t, int32_t> ht1;
     int nrow1 = tin1.getNumRow();
-    for (int i = 0; i < nrow1; ++i) {
-        int n_nationkey = tin1.getInt32(i, 0);
-        int n_rowid = tin1.getInt32(i, 1);
-        ht1.insert(std::make_pair(n_nationkey, n_rowid));
-    }
-    int r = 0;
+    const int32_t* n_nationkey = tin1.getColPtr<int32_t>(0);
+    const int32_t* n_rowid = tin1.getColPtr<int32_t>(1);
+    cpu_ops::HashIndex ht1(nrow1, [&](int i, int64_t& k) {
+        k = n_nationkey[i];
+        return true;
+    });
     int nrow2 = tin2.getNumRow();
-    for (int i = 0; i < nrow2; i++) {
-        int c_nationkey = tin2.getInt32(i, 0);
-        auto it = ht1.find(c_nationkey);
-        if (it != ht1.end()) {
-            int o_custkey = tin2.getInt32(i, 1);
-            int c_rowid = tin2.getInt32(i, 2);
-            int n_rowid = it->second;
-            int revenue = tin2.getInt32(i, 3);
-            tout.setInt32(r, 0, o_custkey);
-            tout.setInt32(r, 1, c_nationkey);
-            tout.setInt32(r, 2, n_rowid);
-            tout.setInt32(r, 3, c_rowid);
-            tout.setInt32(r, 4, revenue);
-            r++;
-        }
-    }
+    const int32_t* c_nationkey = tin2.getColPtr<int32_t>(0);
+    const int32_t* o_custkey = tin2.getColPtr<int32_t>(1);
+    const int32_t* c_rowid = tin2.getColPtr<int32_t>(2);
+    const int32_t* revenue = tin2.getColPtr<int32_t>(3);
+    auto key = [&](int i, int64_t& k) {
+        k = c_nationkey[i];
+        return true;
+    };
+    auto emit = [&](int r, int i, int j) {
+        tout.setInt32(r, 0, o_custkey[i]);
+        tout.setInt32(r, 1, c_nationkey[i]);
+        tout.setInt32(r, 2, n_rowid[j]);
+        tout.setInt32(r, 3, c_rowid[i]);
+        tout.setInt32(r, 4, revenue[i]);
+    };
+    int r = cpu_ops::hashJoinFirst(ht1, nrow2, key, emit);
     tout.setNumRow(r);
     std::cout << std::dec << r << " out q10Join_N_O2" << std::endl;
 }
@@ -144,24 +119,19 @@ struct hash<Q10GroupKey> {
 }
 
 void q10GroupBy(Table& tin, Table& tout) {
-    std::unordered_map<Q10GroupKey, int64_t> m;
-    unsigned nrow = tin.getNumRow();
-    for (size_t i = 0; i < nrow; ++i) {
-        int32_t c_custkey = tin.getInt32(i, 0);   // index much patMatch YAML
-        int32_t n_nationkey = tin.getInt32(i, 1); // index much patMatch YAML
-        int32_t n_rowid = tin.getInt32(i, 2);
-        int32_t c_rowid = tin.getInt32(i, 3);
-        int32_t revenue = tin.getInt32(i, 4);
-
-        Q10GroupKey k{c_custkey, n_nationkey, n_rowid, c_rowid};
-        auto it = m.find(k);
-        if (it != m.end()) {
-            int64_t s = it->second + revenue;
-            m[k] = s; // update
-        } else {
-            m.insert(std::make_pair(k, revenue));
-        }
-    }
+    int nrow = tin.getNumRow();
+    const int32_t* c_custkey = tin.getColPtr<int32_t>(0);   // index much patMatch YAML
+    const int32_t* n_nationkey = tin.getColPtr<int32_t>(1); // index much patMatch YAML
+    const int32_t* n_rowid = tin.getColPtr<int32_t>(2);
+    const int32_t* c_rowid = tin.getColPtr<int32_t>(3);
+    const int32_t* revenue = tin.getColPtr<int32_t>(4);
+    auto row = [&](int i, Q10GroupKey& k, int64_t& v) {
+        k = Q10GroupKey{c_custkey[i], n_nationkey[i], n_rowid[i], c_rowid[i]};
+        v = revenue[i];
+        return true;
+    };
+    auto merge = [](int64_t& a, const int64_t& b) { a += b; };
+    auto m = cpu_ops::parallelGroupBy<Q10GroupKey, int64_t>(nrow, row, merge);
     int r = 0;
     for (auto& it : m) {
         tout.setInt32(r, 0, it.first.c_custkey);
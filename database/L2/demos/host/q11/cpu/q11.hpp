@@ -13,19 +13,15 @@
  * See the License for the specific language governing permissions and
  * limitations under the License.
  */
+#include "cpu_ops.hpp"
 // n_nationkey:3
 void NationFilter(Table& tin, Table& tout) {
     int nrow = tin.getNumRow();
-    int r = 0;
-    for (int i = 0; i < nrow; i++) {
-        std::array<char, TPCH_READ_NATION_LEN + 1> n_name = tin.getcharN<char, TPCH_READ_NATION_LEN + 1>(i, 1);
-        if (!strcmp("GERMANY", n_name.data())) {
-            int32_t n_nationkey = tin.getInt32(i, 0);
-            tout.setInt32(r, 0, n_nationkey);
-            // tout.setcharN<char,TPCH_READ_NATION_LEN + 1>(r,1,n_name);
-            r++;
-        }
-    }
+    const int32_t* n_nationkey = tin.getColPtr<int32_t>(0);
+    const char* n_name = tin.getColPtr<char>(1);
+    auto pred = [&](int i) { return !strcmp("GERMANY", n_name + i * (TPCH_READ_NATION_LEN + 1)); };
+    auto emit = [&](int r, int i) { tout.setInt32(r, 0, n_nationkey[i]); };
+    int r = cpu_ops::parallelFilter(nrow, pred, emit);
     tout.setNumRow(r);
     std::cout << std::dec << r << " In NationFilter" << std::endl;
 }
@@ -33,21 +29,20 @@ void NationFilter(Table& tin, Table& tout) {
 // select count(*) from nation,supplier where n_name = 'GERMANY' and s_nationkey = n_nationkey;
 void q11Join_t1_s(Table& tin1, Table& tin2, Table& tout) {
     int nrow1 = tin1.getNumRow();
-    std::unordered_map<int32_t, int32_t> ht1;
-    for (int i = 0; i < nrow1; i++) {
-        ht1.insert(std::make_pair(tin1.getInt32(i, 0), 0));
-    }
-    int r = 0;
+    const int32_t* n_nationkey = tin1.getColPtr<int32_t>(0);
+    cpu_ops::HashIndex ht1(nrow1, [&](int i, int64_t& k) {
+        k = n_nationkey[i];
+        return true;
+    });
     int nrow2 = tin2.getNumRow();
-    for (int i = 0; i < nrow2; i++) {
-        int32_t s_nationkey = tin2.getInt32(i, 0);
-        auto it = ht1.find(s_nationkey);
-        if (it != ht1.end()) {
-            int32_t s_suppkey = tin2.getInt32(i, 1);
-            tout.setInt32(r, 0, s_suppkey);
-            r++;
-        }
-    }
+    const int32_t* s_nationkey = tin2.getColPtr<int32_t>(0);
+    const int32_t* s_suppkey = tin2.getColPtr<int32_t>(1);
+    auto key = [&](int i, int64_t& k) {
+        k = s_nationkey[i];
+        return true;
+    };
+    auto emit = [&](int r, int i) { tout.setInt32(r, 0, s_suppkey[i]); };
+    int r = cpu_ops::hashSemiJoin(ht1, nrow2, key, emit);
     tout.setNumRow(r);
     std::cout << std::dec << r << " In q11Join_t1_s" << std::endl;
 }
@@ -59,25 +54,26 @@ void q11Join_t1_s(Table& tin1, Table& tin2, Table& tout) {
 
 void q11Join_t2_p(Table& tin1, Table& tin2, Table& tout) {
     int nrow1 = tin1.getNumRow();
-    std::unordered_map<int32_t, int32_t> ht1;
-    for (int i = 0; i < nrow1; i++) {
-        ht1.insert(std::make_pair(tin1.getInt32(i, 0), 0));
-    }
-    int r = 0;
+    const int32_t* s_suppkey = tin1.getColPtr<int32_t>(0);
+    cpu_ops::HashIndex ht1(nrow1, [&](int i, int64_t& k) {
+        k = s_suppkey[i];
+        return true;
+    });
     int nrow2 = tin2.getNumRow();
-    for (int i = 0; i < nrow2; i++) {
-        int32_t ps_suppkey = tin2.getInt32(i, 0);
-        auto it = ht1.find(ps_suppkey);
-        if (it != ht1.end()) {
-            int32_t ps_partkey = tin2.getInt32(i, 1);
-            int32_t ps_supplycost = tin2.getInt32(i, 2);
-            int32_t ps_availqty = tin2.getInt32(i, 3);
-            int32_t e = ps_supplycost * ps_availqty;
-            tout.setInt32(r, 0, ps_partkey);
-            tout.setInt32(r, 1, e);
-            r++;
-        }
-    }
+    const int32_t* ps_suppkey = tin2.getColPtr<int32_t>(0);
+    const int32_t* ps_partkey = tin2.getColPtr<int32_t>(1);
+    const int32_t* ps_supplycost = tin2.getColPtr<int32_t>(2);
+    const int32_t* ps_availqty = tin2.getColPtr<int32_t>(3);
+    auto key = [&](int i, int64_t& k) {
+        k = ps_suppkey[i];
+        return true;
+    };
+    auto emit = [&](int r, int i) {
+        int32_t e = ps_supplycost[i] * ps_availqty[i];
+        tout.setInt32(r, 0, ps_partkey[i]);
+        tout.setInt32(r, 1, e);
+    };
+    int r = cpu_ops::hashSemiJoin(ht1, nrow2, key, emit);
     tout.setNumRow(r);
     std::cout << std::dec << r << " In q11Join_t2_p" << std::endl;
 }
@@ -85,13 +81,8 @@ void q11Join_t2_p(Table& tin1, Table& tin2, Table& tout) {
 // n_nationkey and ps_suppkey = s_suppkey;
 // 7874103.109405
 int64_t sq11Sum(Table& tin1) {
-    int nrow1 = tin1.getNumRow();
-    int64_t sum = 0;
-    for (int i = 0; i < nrow1; i++) {
-        int32_t e = tin1.getInt32(i, 1);
-        sum += e;
-    }
-    return sum;
+    const int32_t* e = tin1.getColPtr<int32_t>(1);
+    return cpu_ops::parallelSum<int64_t>(tin1.getNumRow(), [&](int i) { return e[i]; });
 }
 int64_t q14scalsum(Table& tin) {
     int64_t sum = sq11Sum(tin);
@@ -102,18 +93,15 @@ int64_t q14scalsum(Table& tin) {
 // and s_nationkey = n_nationkey and ps_suppkey = s_suppkey group by ps_partkey)ff;
 void q11Groupby(Table& tin1, Table& tout) {
     int nrow1 = tin1.getNumRow();
-    std::unordered_map<int32_t, int32_t> ht1;
-    for (int i = 0; i < nrow1; i++) {
-        int32_t ps_partkey = tin1.getInt32(i, 0);
-        int32_t e = tin1.getInt32(i, 1);
-        auto it = ht1.find(ps_partkey);
-        if (it != ht1.end()) {
-            int64_t t = it->second + e;
-            ht1[ps_partkey] = t;
-        } else {
-            ht1.insert(std::make_pair(ps_partkey, e));
-        }
-    }
+    const int32_t* ps_partkey = tin1.getColPtr<int32_t>(0);
+    const int32_t* e = tin1.getColPtr<int32_t>(1);
+    auto row = [&](int i, int32_t& k, int32_t& v) {
+        k = ps_partkey[i];
+        v = e[i];
+        return true;
+    };
+    auto merge = [](int32_t& a, const int32_t& b) { a += b; };
+    auto ht1 = cpu_ops::parallelGroupBy<int32_t, int32_t>(nrow1, row, merge);
     int r = 0;
     for (auto& it : ht1) {
         tout.setInt32(r, 0, it.first);
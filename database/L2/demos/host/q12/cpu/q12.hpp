@@ -13,28 +13,32 @@
  * See the License for the specific language governing permissions and
  * limitations under the License.
  */
+#include "cpu_ops.hpp"
 // t1:1715437
 void LineFilter(Table& tin, Table& tout) {
     int nrow = tin.getNumRow();
-    int r = 0;
     std::cout << std::dec << nrow << " " << std::endl;
-    for (int i = 0; i < nrow; i++) {
-        std::array<char, TPCH_READ_MAXAGG_LEN + 1> l_shipmode = tin.getcharN<char, TPCH_READ_MAXAGG_LEN + 1>(i, 1);
-        if ((!strcmp(l_shipmode.data(), "MAIL")) || (!strcmp(l_shipmode.data(), "SHIP"))) {
-            int32_t l_orderkey = tin.getInt32(i, 0);
-            int32_t l_commitdate = tin.getInt32(i, 2);
-            int32_t l_receiptdate = tin.getInt32(i, 3);
-            int32_t l_shipdate = tin.getInt32(i, 4);
-            int32_t l_rowid = i;
-            if (r < 50 && l_orderkey > 174576000) std::cout << l_orderkey << "  " << l_shipmode.data() << std::endl;
-            tout.setInt32(r, 0, l_orderkey);
-            tout.setInt32(r, 1, l_rowid);
-            // tout.setcharN<char,TPCH_READ_MAXAGG_LEN + 1>(r,1,l_shipmode);
-            tout.setInt32(r, 2, l_commitdate);
-            tout.setInt32(r, 3, l_receiptdate);
-            tout.setInt32(r, 4, l_shipdate);
-            r++;
-        }
+    const int32_t* l_orderkey = tin.getColPtr<int32_t>(0);
+    const char* l_shipmode = tin.getColPtr<char>(1);
+    const int32_t* l_commitdate = tin.getColPtr<int32_t>(2);
+    const int32_t* l_receiptdate = tin.getColPtr<int32_t>(3);
+    const int32_t* l_shipdate = tin.getColPtr<int32_t>(4);
+    auto pred = [&](int i) {
+        const char* mode = l_shipmode + i * (TPCH_READ_MAXAGG_LEN + 1);
+        return !strcmp(mode, "MAIL") || !strcmp(mode, "SHIP");
+    };
+    auto emit = [&](int r, int i) {
+        tout.setInt32(r, 0, l_orderkey[i]);
+        tout.setInt32(r, 1, i); // l_rowid
+        tout.setInt32(r, 2, l_commitdate[i]);
+        tout.setInt32(r, 3, l_receiptdate[i]);
+        tout.setInt32(r, 4, l_shipdate[i]);
+    };
+    int r = cpu_ops::parallelFilter(nrow, pred, emit);
+    for (int j = 0; j < r && j < 50; j++) {
+        int32_t i = tout.getInt32(j, 1);
+        if (l_orderkey[i] > 174576000)
+            std::cout << l_orderkey[i] << "  " << l_shipmode + i * (TPCH_READ_MAXAGG_LEN + 1) << std::endl;
     }
     tout.setNumRow(r);
     std::cout << std::dec << r << " in LineFilter" << std::endl;
@@ -44,28 +48,27 @@ void LineFilter(Table& tin, Table& tout) {
 void q12Join_o_t1(Table& tin1, Table& tin2, Table& tout) {
     int nrow1 = tin1.getNumRow();
     int nrow2 = tin2.getNumRow();
-    std::unordered_map<int32_t, int32_t> ht1;
-    for (int i = 0; i < nrow1; i++) {
-        int32_t o_orderkey = tin1.getInt32(i, 0);
-        int32_t o_rowid = tin1.getInt32(i, 1);
-        ht1.insert(std::make_pair(o_orderkey, o_rowid));
-    }
-    int r = 0;
-    for (int i = 0; i < nrow2; i++) {
-        int32_t l_orderkey = tin2.getInt32(i, 0);
-        int32_t l_commitdate = tin2.getInt32(i, 2);
-        int32_t l_receiptdate = tin2.getInt32(i, 3);
-        int32_t l_shipdate = tin2.getInt32(i, 4);
-        auto it = ht1.find(l_orderkey);
-        if (l_commitdate < l_receiptdate && l_shipdate < l_commitdate && l_receiptdate >= 19940101 &&
-            l_receiptdate < 19950101 && it != ht1.end()) {
-            int32_t l_rowid = tin2.getInt32(i, 1);
-            int32_t o_rowid = it->second;
-            tout.setInt32(r, 0, o_rowid);
-            tout.setInt32(r, 1, l_rowid);
-            r++;
-        }
-    }
+    const int32_t* o_orderkey = tin1.getColPtr<int32_t>(0);
+    const int32_t* o_rowid = tin1.getColPtr<int32_t>(1);
+    cpu_ops::HashIndex ht1(nrow1, [&](int i, int64_t& k) {
+        k = o_orderkey[i];
+        return true;
+    });
+    const int32_t* l_orderkey = tin2.getColPtr<int32_t>(0);
+    const int32_t* l_rowid = tin2.getColPtr<int32_t>(1);
+    const int32_t* l_commitdate = tin2.getColPtr<int32_t>(2);
+    const int32_t* l_receiptdate = tin2.getColPtr<int32_t>(3);
+    const int32_t* l_shipdate = tin2.getColPtr<int32_t>(4);
+    auto key = [&](int i, int64_t& k) {
+        k = l_orderkey[i];
+        return l_commitdate[i] < l_receiptdate[i] && l_shipdate[i] < l_commitdate[i] && l_receiptdate[i] >= 19940101 &&
+               l_receiptdate[i] < 19950101;
+    };
+    auto emit = [&](int r, int i, int j) {
+        tout.setInt32(r, 0, o_rowid[j]);
+        tout.setInt32(r, 1, l_rowid[i]);
+    };
+    int r = cpu_ops::hashJoinFirst(ht1, nrow2, key, emit);
     tout.setNumRow(r);
     std::cout << std::dec << r << " in q12Join_o_t1" << std::endl;
 }
@@ -92,36 +95,25 @@ struct sumVs {
 
 void q12Groupby(Table& tin1, Table& origint1, Table& origint2, Table& tout) {
     int nrow1 = tin1.getNumRow();
-    std::unordered_map<q12GroupKey, sumVs> ht1;
-    for (int i = 0; i < nrow1; i++) {
-        int32_t l_rowid = tin1.getInt32(i, 1);
-        std::array<char, TPCH_READ_MAXAGG_LEN + 1> l_shipmode =
-            origint1.getcharN<char, TPCH_READ_MAXAGG_LEN + 1>(l_rowid, 1);
-        int32_t o_rowid = tin1.getInt32(i, 0);
-        std::array<char, TPCH_READ_MAXAGG_LEN + 1> o_orderpriority =
-            origint2.getcharN<char, TPCH_READ_MAXAGG_LEN + 1>(o_rowid, 2);
-        q12GroupKey k{std::string(l_shipmode.data())};
-        auto it = ht1.find(k);
-        if (it != ht1.end()) {
-            if (!strcmp(o_orderpriority.data(), "1-URGENT") || !strcmp(o_orderpriority.data(), "2-HIGH")) {
-                int64_t t = it->second.sum1 + 1;
-                ht1[k].sum1 = t;
-            } else {
-                int64_t t = it->second.sum2 + 1;
-                ht1[k].sum2 = t;
-            }
-
-        } else {
-            if (!strcmp(o_orderpriority.data(), "1-URGENT") || !strcmp(o_orderpriority.data(), "2-HIGH")) {
-                ht1.insert(std::make_pair(k, sumVs{1, 0}));
-            } else {
-                ht1.insert(std::make_pair(k, sumVs{0, 1}));
-            }
-        }
-    }
+    const int32_t* o_rowid = tin1.getColPtr<int32_t>(0);
+    const int32_t* l_rowid = tin1.getColPtr<int32_t>(1);
+    const char* l_shipmode = origint1.getColPtr<char>(1);
+    const char* o_orderpriority = origint2.getColPtr<char>(2);
+    auto row = [&](int i, q12GroupKey& k, sumVs& v) {
+        const char* prio = o_orderpriority + o_rowid[i] * (TPCH_READ_MAXAGG_LEN + 1);
+        bool high = !strcmp(prio, "1-URGENT") || !strcmp(prio, "2-HIGH");
+        k = q12GroupKey{std::string(l_shipmode + l_rowid[i] * (TPCH_READ_MAXAGG_LEN + 1))};
+        v = high ? sumVs{1, 0} : sumVs{0, 1};
+        return true;
+    };
+    auto merge = [](sumVs& a, const sumVs& b) {
+        a.sum1 += b.sum1;
+        a.sum2 += b.sum2;
+    };
+    auto ht1 = cpu_ops::parallelGroupBy<q12GroupKey, sumVs>(nrow1, row, merge);
     int r = 0;
     for (auto& it : ht1) {
-        std::array<char, TPCH_READ_MAXAGG_LEN + 1> l_shipmode;
+        std::array<char, TPCH_READ_MAXAGG_LEN + 1> l_shipmode{};
         memcpy(l_shipmode.data(), (it.first.l_shipmode).data(), (it.first.l_shipmode).length());
         tout.setcharN<char, TPCH_READ_MAXAGG_LEN + 1>(r, 0, l_shipmode);
         tout.setInt64(r, 1, it.second.sum1);
@@ -157,7 +149,7 @@ void q12Sort(Table& tin, Table& tout) {
 
     int r = 0;
     for (auto& it : rows) {
-        std::array<char, TPCH_READ_MAXAGG_LEN + 1> l_shipmode;
+        std::array<char, TPCH_READ_MAXAGG_LEN + 1> l_shipmode{};
         std::string l_shipmode_ = it.l_shipmode;
         memcpy(l_shipmode.data(), l_shipmode_.data(), l_shipmode_.length());
         tout.setcharN<char, TPCH_READ_MAXAGG_LEN + 1>(r, 0, l_shipmode);
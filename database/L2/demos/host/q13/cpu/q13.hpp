@@ -14,6 +14,7 @@
  * limitations under the License.
  */
 #include <regex>
+#include "cpu_ops.hpp"
 // 1479964 t1
 bool strm_pattern(std::string sub1, std::string sub2, std::string s, int len = 7) {
     std::string::size_type spe_f = s.find(sub1);
@@ -28,18 +29,16 @@ bool strm_pattern(std::string sub1, std::string sub2, std::string s, int len = 7
 }
 void OrderFilter(Table& tin, Table& tout) {
     int nrow = tin.getNumRow();
-    int r = 0;
-    for (int i = 0; i < nrow; i++) {
-        std::array<char, TPCH_READ_O_CMNT_MAX + 1> o_comment = tin.getcharN<char, TPCH_READ_O_CMNT_MAX + 1>(i, 2);
-        // if(!std::regex_match(o_comment.data(), std::regex("(.*)(special)(.*)(requests)(.*)"))){
-        if (!strm_pattern("special", "requests", o_comment.data())) {
-            int32_t o_custkey = tin.getInt32(i, 0);
-            int32_t o_orderkey = tin.getInt32(i, 1);
-            tout.setInt32(r, 0, o_custkey);
-            tout.setInt32(r, 1, o_orderkey);
-            r++;
-        }
-    }
+    const int32_t* o_custkey = tin.getColPtr<int32_t>(0);
+    const int32_t* o_orderkey = tin.getColPtr<int32_t>(1);
+    const char* o_comment = tin.getColPtr<char>(2);
+    // if(!std::regex_match(o_comment.data(), std::regex("(.*)(special)(.*)(requests)(.*)"))){
+    auto pred = [&](int i) { return !strm_pattern("special", "requests", o_comment + i * (TPCH_READ_O_CMNT_MAX + 1)); };
+    auto emit = [&](int r, int i) {
+        tout.setInt32(r, 0, o_custkey[i]);
+        tout.setInt32(r, 1, o_orderkey[i]);
+    };
+    int r = cpu_ops::parallelFilter(nrow, pred, emit);
     tout.setNumRow(r);
     std::cout << std::dec << r << " after OrderFilter" << std::endl;
 }
@@ -47,23 +46,24 @@ void OrderFilter(Table& tin, Table& tout) {
 // 1479964 t2
 void q13Join_c_t1(Table& tin1, Table& tin2, Table& tout) {
     int nrow1 = tin1.getNumRow();
-    std::unordered_map<int32_t, int32_t> ht1;
-    for (int i = 0; i < nrow1; i++) {
-        ht1.insert(std::make_pair(tin1.getInt32(i, 0), 0));
-    }
-    int r = 0;
+    const int32_t* c_custkey = tin1.getColPtr<int32_t>(0);
+    cpu_ops::HashIndex ht1(nrow1, [&](int i, int64_t& k) {
+        k = c_custkey[i];
+        return true;
+    });
     int nrow2 = tin2.getNumRow();
     //    std::cout<<std::dec<<nrow1<<" "<<nrow2<<std::endl;
-    for (int i = 0; i < nrow2; i++) {
-        int32_t o_custkey = tin2.getInt32(i, 0);
-        auto it = ht1.find(o_custkey);
-        if (it != ht1.end()) {
-            int32_t o_orderkey = tin2.getInt32(i, 1);
-            tout.setInt32(r, 0, o_custkey);
-            tout.setInt32(r, 1, o_orderkey);
-            r++;
-        }
-    }
+    const int32_t* o_custkey = tin2.getColPtr<int32_t>(0);
+    const int32_t* o_orderkey = tin2.getColPtr<int32_t>(1);
+    auto key = [&](int i, int64_t& k) {
+        k = o_custkey[i];
+        return true;
+    };
+    auto emit = [&](int r, int i) {
+        tout.setInt32(r, 0, o_custkey[i]);
+        tout.setInt32(r, 1, o_orderkey[i]);
+    };
+    int r = cpu_ops::hashSemiJoin(ht1, nrow2, key, emit);
     tout.setNumRow(r);
     std::cout << std::dec << r << " after q13Join_c_t1" << std::endl;
 }
@@ -72,37 +72,33 @@ void q13Join_c_t1(Table& tin1, Table& tin2, Table& tout) {
 void q13AntiJoin_t2_c(Table& tin1, Table& tin2, Table& tout) {
     int nrow1 = tin1.getNumRow();
     int nrow2 = tin2.getNumRow();
-    std::unordered_map<int32_t, int32_t> ht1;
-    for (int i = 0; i < nrow1; i++) {
-        int32_t o_custkey = tin1.getInt32(i, 0);
-        int32_t o_orderkey = tin1.getInt32(i, 1);
-        ht1.insert(std::make_pair(o_custkey, o_orderkey));
-    }
-    int r = 0;
-    for (int i = 0; i < nrow2; i++) {
-        int32_t c_custkey = tin2.getInt32(i, 0);
-        auto it = ht1.find(c_custkey);
-        if (it == ht1.end()) {
-            tout.setInt32(r, 0, c_custkey);
-            tout.setInt32(r, 1, 0);
-            r++;
-        }
-    }
+    const int32_t* o_custkey = tin1.getColPtr<int32_t>(0);
+    cpu_ops::HashIndex ht1(nrow1, [&](int i, int64_t& k) {
+        k = o_custkey[i];
+        return true;
+    });
+    const int32_t* c_custkey = tin2.getColPtr<int32_t>(0);
+    auto key = [&](int i, int64_t& k) {
+        k = c_custkey[i];
+        return true;
+    };
+    auto emit = [&](int r, int i) {
+        tout.setInt32(r, 0, c_custkey[i]);
+        tout.setInt32(r, 1, 0);
+    };
+    int r = cpu_ops::hashSemiJoin(ht1, nrow2, key, emit, true);
     tout.setNumRow(r);
     std::cout << std::dec << r << " after q13AntiJoin_t2_c" << std::endl;
 }
 void q13GroupBy_t2(Table& tin, Table& tout) {
-    std::unordered_map<int32_t, int32_t> ht1;
-    for (int i = 0; i < tin.getNumRow(); i++) {
-        int32_t c_custkey = tin.getInt32(i, 0);
-        auto it = ht1.find(c_custkey);
-        if (it != ht1.end()) {
-            int64_t s = it->second + 1;
-            ht1[c_custkey] = s;
-        } else {
-            ht1.insert(std::make_pair(c_custkey, 1));
-        }
-    }
+    const int32_t* c_custkey = tin.getColPtr<int32_t>(0);
+    auto row = [&](int i, int32_t& k, int32_t& v) {
+        k = c_custkey[i];
+        v = 1;
+        return true;
+    };
+    auto merge = [](int32_t& a, const int32_t& b) { a += b; };
+    auto ht1 = cpu_ops::parallelGroupBy<int32_t, int32_t>(tin.getNumRow(), row, merge);
     int r = 0;
     for (auto& it : ht1) {
         tout.setInt32(r, 0, it.first);
@@ -113,14 +109,14 @@ void q13GroupBy_t2(Table& tin, Table& tout) {
     std::cout << std::dec << r << " after q13GroupBy3" << std::endl;
 }
 void q13GroupBy_t3(Table& tin, Table& tout) {
-    std::unordered_map<int32_t, int32_t> ht1;
-    for (int i = 0; i < tin.getNumRow(); i++) {
-        int32_t o_custkey = tin.getInt32(i, 0);
-        auto it = ht1.find(o_custkey);
-        if (it == ht1.end()) {
-            ht1.insert(std::make_pair(o_custkey, 0));
-        }
-    }
+    const int32_t* o_custkey = tin.getColPtr<int32_t>(0);
+    auto row = [&](int i, int32_t& k, int32_t& v) {
+        k = o_custkey[i];
+        v = 0;
+        return true;
+    };
+    auto merge = [](int32_t& a, const int32_t& b) {};
+    auto ht1 = cpu_ops::parallelGroupBy<int32_t, int32_t>(tin.getNumRow(), row, merge);
     int r = 0;
     for (auto& it : ht1) {
         tout.setInt32(r, 0, it.first);
@@ -148,17 +144,14 @@ void combile_t4_t5(Table& tin1, Table& tin2, Table& tout) {
     std::cout << std::dec << i << " after combile_t4_t5" << std::endl;
 }
 void q13GroupBy(Table& tin, Table& tout) {
-    std::unordered_map<int32_t, int32_t> ht1;
-    for (int i = 0; i < tin.getNumRow(); i++) {
-        int32_t c_count = tin.getInt32(i, 1);
-        auto it = ht1.find(c_count);
-        if (it != ht1.end()) {
-            int32_t s = it->second + 1;
-            ht1[c_count] = s;
-        } else {
-            ht1.insert(std::make_pair(c_count, 1));
-        }
-    }
+    const int32_t* c_count = tin.getColPtr<int32_t>(1);
+    auto row = [&](int i, int32_t& k, int32_t& v) {
+        k = c_count[i];
+        v = 1;
+        return true;
+    };
+    auto merge = [](int32_t& a, const int32_t& b) { a += b; };
+    auto ht1 = cpu_ops::parallelGroupBy<int32_t, int32_t>(tin.getNumRow(), row, merge);
     int r = 0;
     for (auto& it : ht1) {
         tout.setInt32(r, 0, it.first);
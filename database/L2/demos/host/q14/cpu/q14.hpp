@@ -14,20 +14,16 @@
  * limitations under the License.
  */
 #include <regex>
+#include "cpu_ops.hpp"
 // t1 //t6
 void PartFilter(Table& tin, Table& tout) {
     int nrow = tin.getNumRow();
-    int r = 0;
-    for (int i = 0; i < nrow; i++) {
-        std::array<char, TPCH_READ_P_TYPE_LEN + 1> p_type = tin.getcharN<char, TPCH_READ_P_TYPE_LEN + 1>(i, 1);
-        // if(std::regex_match(p_type.data(), std::regex("(PROMO)(.*)"))){
-        if (std::string(p_type.data()).find("PROMO") == 0) {
-            int32_t p_partkey = tin.getInt32(i, 0);
-            tout.setInt32(r, 0, p_partkey);
-
-            r++;
-        }
-    }
+    const int32_t* p_partkey = tin.getColPtr<int32_t>(0);
+    const char* p_type = tin.getColPtr<char>(1);
+    // if(std::regex_match(p_type.data(), std::regex("(PROMO)(.*)"))){
+    auto pred = [&](int i) { return !strncmp(p_type + i * (TPCH_READ_P_TYPE_LEN + 1), "PROMO", 5); };
+    auto emit = [&](int r, int i) { tout.setInt32(r, 0, p_partkey[i]); };
+    int r = cpu_ops::parallelFilter(nrow, pred, emit);
     tout.setNumRow(r);
     std::cout << std::dec << r << " In PartFilter" << std::endl;
 }
@@ -36,51 +32,41 @@ void PartFilter(Table& tin, Table& tout) {
 int64_t q14Join_t1_l(Table& tin1, Table& tin2, Table& tout) {
     int nrow1 = tin1.getNumRow();
     int nrow2 = tin2.getNumRow();
-    std::unordered_map<int32_t, int32_t> ht1;
-    for (int i = 0; i < nrow1; i++) {
-        ht1.insert(std::make_pair(tin1.getInt32(i, 0), 0));
-    }
+    const int32_t* p_partkey = tin1.getColPtr<int32_t>(0);
+    cpu_ops::HashIndex ht1(nrow1, [&](int i, int64_t& k) {
+        k = p_partkey[i];
+        return true;
+    });
     std::cout << std::dec << nrow1 << " " << ht1.size() << " 0In PartFilter" << std::endl;
-    int64_t sum = 0;
-    for (int i = 0; i < nrow2; i++) {
-        int32_t l_shipdate = tin2.getInt32(i, 3);
-        if (l_shipdate >= 19950901 && l_shipdate < 19951001) {
-            int32_t l_partkey = tin2.getInt32(i, 0);
-            auto it = ht1.find(l_partkey);
-            if (it != ht1.end()) {
-                int32_t l_extendedprice = tin2.getInt32(i, 1);
-                int32_t l_discount = tin2.getInt32(i, 2);
-                int32_t e = l_extendedprice * (100 - l_discount);
-                sum += e;
-            }
-        }
-    }
-    return sum;
+    const int32_t* l_partkey = tin2.getColPtr<int32_t>(0);
+    const int32_t* l_extendedprice = tin2.getColPtr<int32_t>(1);
+    const int32_t* l_discount = tin2.getColPtr<int32_t>(2);
+    const int32_t* l_shipdate = tin2.getColPtr<int32_t>(3);
+    return cpu_ops::parallelSum<int64_t>(nrow2, [&](int i) {
+        if (l_shipdate[i] < 19950901 || l_shipdate[i] >= 19951001 || !ht1.contains(l_partkey[i])) return 0;
+        int32_t e = l_extendedprice[i] * (100 - l_discount[i]);
+        return e;
+    });
 }
 
 int64_t q14Join_p_l(Table& tin1, Table& tin2, Table& tout) {
     int nrow1 = tin1.getNumRow();
     int nrow2 = tin2.getNumRow();
-    std::unordered_map<int32_t, int32_t> ht1;
-    for (int i = 0; i < nrow1; i++) {
-        ht1.insert(std::make_pair(tin1.getInt32(i, 0), 0));
-    }
+    const int32_t* p_partkey = tin1.getColPtr<int32_t>(0);
+    cpu_ops::HashIndex ht1(nrow1, [&](int i, int64_t& k) {
+        k = p_partkey[i];
+        return true;
+    });
     std::cout << std::dec << ht1.size() << " In PartFilter" << std::endl;
-    int64_t sum = 0;
-    for (int i = 0; i < nrow2; i++) {
-        int32_t l_shipdate = tin2.getInt32(i, 3);
-        if (l_shipdate >= 19950901 && l_shipdate < 19951001) {
-            int32_t l_partkey = tin2.getInt32(i, 0);
-            auto it = ht1.find(l_partkey);
-            if (it != ht1.end()) {
-                int32_t l_extendedprice = tin2.getInt32(i, 1);
-                int32_t l_discount = tin2.getInt32(i, 2);
-                int32_t e = l_extendedprice * (100 - l_discount);
-                sum += e;
-            }
-        }
-    }
-    return sum;
+    const int32_t* l_partkey = tin2.getColPtr<int32_t>(0);
+    const int32_t* l_extendedprice = tin2.getColPtr<int32_t>(1);
+    const int32_t* l_discount = tin2.getColPtr<int32_t>(2);
+    const int32_t* l_shipdate = tin2.getColPtr<int32_t>(3);
+    return cpu_ops::parallelSum<int64_t>(nrow2, [&](int i) {
+        if (l_shipdate[i] < 19950901 || l_shipdate[i] >= 19951001 || !ht1.contains(l_partkey[i])) return 0;
+        int32_t e = l_extendedprice[i] * (100 - l_discount[i]);
+        return e;
+    });
 }
 // t3
 // q14Join_p_l/q14Join_t1_l
@@ -13,28 +13,23 @@
  * See the License for the specific language governing permissions and
  * limitations under the License.
  */
+#include "cpu_ops.hpp"
 // order and lineitem
 
 void q15GroupBy(Table& tin, Table& tout) {
-    std::unordered_map<int32_t, int64_t> m;
-    unsigned nrow = tin.getNumRow();
-    for (size_t i = 0; i < nrow; ++i) {
-        int32_t l_shipdate = tin.getInt32(i, 3);
-        //        if(i<10) std::cout<<std::dec<<l_shipdate<<std::endl;
-        if (l_shipdate >= 19960101 && l_shipdate < 19960401) {
-            int32_t l_suppkey = tin.getInt32(i, 0);       // index much patMatch YAML
-            int32_t l_extendedprice = tin.getInt32(i, 1); // index much patMatch YAML
-            int32_t l_discount = tin.getInt32(i, 2);
-            int32_t revenue = l_extendedprice * (100 - l_discount);
-            auto it = m.find(l_suppkey);
-            if (it != m.end()) {
-                int64_t s = it->second + revenue;
-                m[l_suppkey] = s; // update
-            } else {
-                m.insert(std::make_pair(l_suppkey, revenue));
-            }
-        }
-    }
+    int nrow = tin.getNumRow();
+    const int32_t* l_suppkey = tin.getColPtr<int32_t>(0);       // index much patMatch YAML
+    const int32_t* l_extendedprice = tin.getColPtr<int32_t>(1); // index much patMatch YAML
+    const int32_t* l_discount = tin.getColPtr<int32_t>(2);
+    const int32_t* l_shipdate = tin.getColPtr<int32_t>(3);
+    auto row = [&](int i, int32_t& k, int64_t& v) {
+        int32_t revenue = l_extendedprice[i] * (100 - l_discount[i]);
+        k = l_suppkey[i];
+        v = revenue;
+        return l_shipdate[i] >= 19960101 && l_shipdate[i] < 19960401;
+    };
+    auto merge = [](int64_t& a, const int64_t& b) { a += b; };
+    auto m = cpu_ops::parallelGroupBy<int32_t, int64_t>(nrow, row, merge);
     int r = 0;
     for (auto& it : m) {
         int64_t sumv = it.second;
@@ -80,33 +75,27 @@ void q15_filter(Table& tin1, Table& tout, int64_t maxv) {
     std::cout << std::dec << r << " out q15_filter" << std::endl;
 }
 void q15Join_t1_s(Table& tin1, Table& tin2, Table& tout) {
-    std::unordered_multimap<int32_t, int64_t> ht1;
     int nrow1 = tin1.getNumRow();
-    for (int i = 0; i < nrow1; ++i) {
-        int32_t l_suppkey = tin1.getInt32(i, 0);
-        int32_t eval_l = tin1.getInt32(i, 1);
-        int32_t eval_h = tin1.getInt32(i, 2);
-        int64_t eval = tin1.mergeInt64(eval_l, eval_h);
-        //       std::cout<<"test eval:"<<eval_l<<" "<<eval_h<<std::endl;
-        ht1.insert(std::make_pair(l_suppkey, eval));
-    }
-    int r = 0;
+    const int32_t* l_suppkey = tin1.getColPtr<int32_t>(0);
+    cpu_ops::HashIndex ht1(nrow1, [&](int i, int64_t& k) {
+        k = l_suppkey[i];
+        return true;
+    });
     int nrow2 = tin2.getNumRow();
-    for (int i = 0; i < nrow2; i++) {
-        int s_suppkey = tin2.getInt32(i, 0);
-        auto its = ht1.equal_range(s_suppkey);
-        auto it = its.first;
-        while (it != its.second) {
-            int s_rowid = tin2.getInt32(i, 4);
-            int64_t eval = it->second;
-            tout.setInt32(r, 0, s_suppkey);
-            tout.setInt64_l(r, 1, eval);
-            tout.setInt64_h(r, 2, eval);
-            tout.setInt32(r, 3, s_rowid);
-            it++;
-            r++;
-        }
-    }
+    const int32_t* s_suppkey = tin2.getColPtr<int32_t>(0);
+    const int32_t* s_rowid = tin2.getColPtr<int32_t>(4);
+    auto key = [&](int i, int64_t& k) {
+        k = s_suppkey[i];
+        return true;
+    };
+    auto emit = [&](int r, int i, int j) {
+        int64_t eval = tin1.mergeInt64(tin1.getInt32(j, 1), tin1.getInt32(j, 2));
+        tout.setInt32(r, 0, s_suppkey[i]);
+        tout.setInt64_l(r, 1, eval);
+        tout.setInt64_h(r, 2, eval);
+        tout.setInt32(r, 3, s_rowid[i]);
+    };
+    int r = cpu_ops::hashJoin(ht1, nrow2, key, emit);
     tout.setNumRow(r);
     std::cout << std::dec << r << " out q15Join_t1_s" << std::endl;
 }
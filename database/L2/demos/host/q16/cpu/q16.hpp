@@ -14,52 +14,50 @@
  * limitations under the License.
  */
 #include <regex>
+#include "cpu_ops.hpp"
 // t1 //t6
 void q16Filter_p(Table& tin, Table& tout) {
     int nrow = tin.getNumRow();
-    int r = 0;
-    for (int i = 0; i < nrow; i++) {
-        std::array<char, TPCH_READ_P_BRND_LEN + 1> p_brand = tin.getcharN<char, TPCH_READ_P_BRND_LEN + 1>(i, 1);
-        std::array<char, TPCH_READ_P_TYPE_LEN + 1> p_type = tin.getcharN<char, TPCH_READ_P_TYPE_LEN + 1>(i, 2);
-        // if(!std::regex_match(p_type.data(), std::regex("(MEDIUM POLISHED)(.*)"))&&strcmp(p_brand.data(),"Brand#45")){
-        if (strcmp(p_brand.data(), "Brand#45") && std::string(p_type.data()).find("MEDIUM POLISHED") != 0) {
-            // if(std::string(p_type.data()).find("MEDIUM POLISHED")!=0&&strcmp(p_brand.data(),"Brand#45")){
-            int32_t p_partkey = tin.getInt32(i, 0);
-            int32_t p_size = tin.getInt32(i, 3);
-            int32_t p_rowid = i; // tin.getInt32(i,4);
-            tout.setInt32(r, 0, p_partkey);
-            tout.setInt32(r, 1, p_size);
-            tout.setInt32(r, 2, p_rowid);
-            //            tout.setcharN<char,TPCH_READ_P_BRND_LEN+1>(r,3,p_brand);
-            //            tout.setcharN<char,TPCH_READ_P_TYPE_LEN+1>(r,4,p_type);
-            r++;
-        }
-    }
+    const int32_t* p_partkey = tin.getColPtr<int32_t>(0);
+    const char* p_brand = tin.getColPtr<char>(1);
+    const char* p_type = tin.getColPtr<char>(2);
+    const int32_t* p_size = tin.getColPtr<int32_t>(3);
+    // if(!std::regex_match(p_type.data(), std::regex("(MEDIUM POLISHED)(.*)"))&&strcmp(p_brand.data(),"Brand#45")){
+    auto pred = [&](int i) {
+        return strcmp(p_brand + i * (TPCH_READ_P_BRND_LEN + 1), "Brand#45") &&
+               strncmp(p_type + i * (TPCH_READ_P_TYPE_LEN + 1), "MEDIUM POLISHED", 15);
+    };
+    auto emit = [&](int r, int i) {
+        tout.setInt32(r, 0, p_partkey[i]);
+        tout.setInt32(r, 1, p_size[i]);
+        tout.setInt32(r, 2, i); // p_rowid
+    };
+    int r = cpu_ops::parallelFilter(nrow, pred, emit);
     tout.setNumRow(r);
     std::cout << std::dec << r << " q16Filter_p" << std::endl;
 }
 
 void q16Join_c_t1(Table& tin1, Table& tin2, Table& tout) {
     int nrow1 = tin1.getNumRow();
-
-    std::unordered_map<int32_t, int32_t> ht1;
-    for (int i = 0; i < nrow1; i++) {
-        ht1.insert(std::make_pair(tin1.getInt32(i, 0), 0));
-    }
-    int r = 0;
+    const int32_t* c_size = tin1.getColPtr<int32_t>(0);
+    cpu_ops::HashIndex ht1(nrow1, [&](int i, int64_t& k) {
+        k = c_size[i];
+        return true;
+    });
     int nrow2 = tin2.getNumRow();
-    for (int i = 0; i < nrow2; i++) {
-        int32_t p_size = tin2.getInt32(i, 1);
-        auto it = ht1.find(p_size);
-        if (it != ht1.end()) {
-            int32_t p_partkey = tin2.getInt32(i, 0);
-            int32_t p_rowid = tin2.getInt32(i, 2);
-            tout.setInt32(r, 0, p_partkey);
-            tout.setInt32(r, 1, p_rowid);
-            tout.setInt32(r, 2, p_size);
-            r++;
-        }
-    }
+    const int32_t* p_partkey = tin2.getColPtr<int32_t>(0);
+    const int32_t* p_size = tin2.getColPtr<int32_t>(1);
+    const int32_t* p_rowid = tin2.getColPtr<int32_t>(2);
+    auto key = [&](int i, int64_t& k) {
+        k = p_size[i];
+        return true;
+    };
+    auto emit = [&](int r, int i) {
+        tout.setInt32(r, 0, p_partkey[i]);
+        tout.setInt32(r, 1, p_rowid[i]);
+        tout.setInt32(r, 2, p_size[i]);
+    };
+    int r = cpu_ops::hashSemiJoin(ht1, nrow2, key, emit);
     tout.setNumRow(r);
     std::cout << std::dec << r << " q16Join_c_t1" << std::endl;
 }
@@ -78,17 +76,14 @@ bool strm_pattern(std::string sub1, std::string sub2, std::string s, int len = 7
 // t3
 void q16Filter_s(Table& tin, Table& tout) {
     int nrow = tin.getNumRow();
-    int r = 0;
-    for (int i = 0; i < nrow; i++) {
-        std::array<char, TPCH_READ_S_CMNT_MAX + 1> s_comment = tin.getcharN<char, TPCH_READ_S_CMNT_MAX + 1>(i, 1);
-        // if(!std::regex_match (s_comment.data(), std::regex("(.*)(Customer)(.*)(Complaint)(.*)"))){
-        if (!strm_pattern("Customer", "Complaint", s_comment.data(), 8)) {
-            int32_t s_suppkey = tin.getInt32(i, 0);
-            // std::cout<<s_suppkey<<"   "<<s_comment.data()<<std::endl;
-            tout.setInt32(r, 0, s_suppkey);
-            r++;
-        }
-    }
+    const int32_t* s_suppkey = tin.getColPtr<int32_t>(0);
+    const char* s_comment = tin.getColPtr<char>(1);
+    // if(!std::regex_match (s_comment.data(), std::regex("(.*)(Customer)(.*)(Complaint)(.*)"))){
+    auto pred = [&](int i) {
+        return !strm_pattern("Customer", "Complaint", s_comment + i * (TPCH_READ_S_CMNT_MAX + 1), 8);
+    };
+    auto emit = [&](int r, int i) { tout.setInt32(r, 0, s_suppkey[i]); };
+    int r = cpu_ops::parallelFilter(nrow, pred, emit);
     tout.setNumRow(r);
     std::cout << std::dec << r << " q16Filter_s" << std::endl;
 }
@@ -96,22 +91,22 @@ void q16Filter_s(Table& tin, Table& tout) {
 void q16Join_t3_p(Table& tin1, Table& tin2, Table& tout) {
     int nrow1 = tin1.getNumRow();
     int nrow2 = tin2.getNumRow();
-    std::unordered_map<int32_t, int32_t> ht1;
-    for (int i = 0; i < nrow1; i++) {
-        int32_t s_suppkey = tin1.getInt32(i, 0);
-        ht1.insert(std::make_pair(s_suppkey, 0));
-    }
-    int r = 0;
-    for (int i = 0; i < nrow2; i++) {
-        int32_t ps_suppkey = tin2.getInt32(i, 0);
-        auto it = ht1.find(ps_suppkey);
-        if (it != ht1.end()) {
-            int32_t ps_partkey = tin2.getInt32(i, 1);
-            tout.setInt32(r, 0, ps_partkey);
-            tout.setInt32(r, 1, ps_suppkey);
-            r++;
-        }
-    }
+    const int32_t* s_suppkey = tin1.getColPtr<int32_t>(0);
+    cpu_ops::HashIndex ht1(nrow1, [&](int i, int64_t& k) {
+        k = s_suppkey[i];
+        return true;
+    });
+    const int32_t* ps_suppkey = tin2.getColPtr<int32_t>(0);
+    const int32_t* ps_partkey = tin2.getColPtr<int32_t>(1);
+    auto key = [&](int i, int64_t& k) {
+        k = ps_suppkey[i];
+        return true;
+    };
+    auto emit = [&](int r, int i) {
+        tout.setInt32(r, 0, ps_partkey[i]);
+        tout.setInt32(r, 1, ps_suppkey[i]);
+    };
+    int r = cpu_ops::hashSemiJoin(ht1, nrow2, key, emit);
     tout.setNumRow(r);
     std::cout << std::dec << r << " q16Join_t3_p" << std::endl;
 }
@@ -123,29 +118,25 @@ void q16Join_t4_t2(Table& tin1, Table& tin2, Table& tout) {
     std::cout << tin2.getInt32(1, 2) << std::endl;
     int nrow1 = tin1.getNumRow();
     int nrow2 = tin2.getNumRow();
-    std::unordered_multimap<int32_t, int32_t> ht1;
-    for (int i = 0; i < nrow1; i++) {
-        int32_t ps_partkey = tin1.getInt32(i, 0);
-        int32_t ps_suppkey = tin1.getInt32(i, 1);
-        ht1.insert(std::make_pair(ps_partkey, ps_suppkey));
-    }
-
-    int r = 0;
-    for (int i = 0; i < nrow2; i++) {
-        int32_t p_partkey = tin2.getInt32(i, 0);
-        auto its = ht1.equal_range(p_partkey);
-        auto it = its.first;
-        while (it != its.second) {
-            int32_t p_rowid = tin2.getInt32(i, 1);
-            int32_t p_size = tin2.getInt32(i, 2);
-            int32_t ps_suppkey = it->second;
-            tout.setInt32(r, 0, p_rowid);
-            tout.setInt32(r, 1, p_size);
-            tout.setInt32(r, 2, ps_suppkey);
-            it++;
-            r++;
-        }
-    }
+    const int32_t* ps_partkey = tin1.getColPtr<int32_t>(0);
+    const int32_t* ps_suppkey = tin1.getColPtr<int32_t>(1);
+    cpu_ops::HashIndex ht1(nrow1, [&](int i, int64_t& k) {
+        k = ps_partkey[i];
+        return true;
+    });
+    const int32_t* p_partkey = tin2.getColPtr<int32_t>(0);
+    const int32_t* p_rowid = tin2.getColPtr<int32_t>(1);
+    const int32_t* p_size = tin2.getColPtr<int32_t>(2);
+    auto key = [&](int i, int64_t& k) {
+        k = p_partkey[i];
+        return true;
+    };
+    auto emit = [&](int r, int i, int j) {
+        tout.setInt32(r, 0, p_rowid[i]);
+        tout.setInt32(r, 1, p_size[i]);
+        tout.setInt32(r, 2, ps_suppkey[j]);
+    };
+    int r = cpu_ops::hashJoin(ht1, nrow2, key, emit);
     tout.setNumRow(r);
     std::cout << std::dec << r << " q16Join_t4_t2" << std::endl;
 }
@@ -173,25 +164,20 @@ struct hash<Q16GroupKey> {
 }
 
 void q16GroupBy(Table& tin, Table& origin, Table& tout) {
-    std::unordered_map<Q16GroupKey, std::set<int> > m;
     unsigned nrow = tin.getNumRow();
-    for (size_t i = 0; i < nrow; ++i) {
-        int32_t p_rowid = tin.getInt32(i, 0); // index much patMatch YAML
-        int32_t p_size = tin.getInt32(i, 1);  // index much patMatch YAML
-        int32_t ps_suppkey = tin.getInt32(i, 2);
-        std::array<char, TPCH_READ_P_BRND_LEN + 1> p_brand =
-            origin.getcharN<char, TPCH_READ_P_BRND_LEN + 1>(p_rowid, 1);
-        std::array<char, TPCH_READ_P_TYPE_LEN + 1> p_type = origin.getcharN<char, TPCH_READ_P_TYPE_LEN + 1>(p_rowid, 2);
-        Q16GroupKey k{std::string(p_brand.data()), std::string(p_type.data()), p_size};
-        auto it = m.find(k);
-        if (it != m.end()) {
-            m[k].insert(ps_suppkey); // update
-        } else {
-            std::set<int> myset;
-            myset.insert(ps_suppkey);
-            m.insert(std::make_pair(k, myset));
-        }
-    }
+    const int32_t* p_rowid = tin.getColPtr<int32_t>(0); // index much patMatch YAML
+    const int32_t* p_size = tin.getColPtr<int32_t>(1);  // index much patMatch YAML
+    const int32_t* ps_suppkey = tin.getColPtr<int32_t>(2);
+    const char* p_brand = origin.getColPtr<char>(1);
+    const char* p_type = origin.getColPtr<char>(2);
+    auto row = [&](int i, Q16GroupKey& k, std::set<int>& v) {
+        k = Q16GroupKey{std::string(p_brand + p_rowid[i] * (TPCH_READ_P_BRND_LEN + 1)),
+                        std::string(p_type + p_rowid[i] * (TPCH_READ_P_TYPE_LEN + 1)), p_size[i]};
+        v = std::set<int>{ps_suppkey[i]};
+        return true;
+    };
+    auto merge = [](std::set<int>& a, const std::set<int>& b) { a.insert(b.begin(), b.end()); };
+    auto m = cpu_ops::parallelGroupBy<Q16GroupKey, std::set<int> >(nrow, row, merge);
     int r = 0;
     for (auto& it : m) {
         std::array<char, TPCH_READ_P_BRND_LEN + 1> p_brand_s{};
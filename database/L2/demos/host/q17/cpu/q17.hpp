@@ -13,65 +13,67 @@
  * See the License for the specific language governing permissions and
  * limitations under the License.
  */
+#include "cpu_ops.hpp"
 // no use
 void q17Join_t3_l(Table& tin1, Table& tin2, Table& tout) {
     int nrow1 = tin1.getNumRow();
-    std::unordered_map<int32_t, int32_t> ht1;
-    for (int i = 0; i < nrow1; i++) {
-        ht1.insert(std::make_pair(tin1.getInt32(i, 0), tin1.getInt32(i, 1)));
-    }
-    int r = 0;
+    const int32_t* p_partkey = tin1.getColPtr<int32_t>(0);
+    cpu_ops::HashIndex ht1(nrow1, [&](int i, int64_t& k) {
+        k = p_partkey[i];
+        return true;
+    });
     int nrow2 = tin2.getNumRow();
-    for (int i = 0; i < nrow2; i++) {
-        int32_t l_partkey = tin2.getInt32(i, 0);
-        int32_t l_quantity = tin2.getInt32(i, 1);
-        auto it = ht1.find(l_partkey);
-        if (it != ht1.end()) {
-            tout.setInt32(r, 0, l_partkey);
-            tout.setInt32(r, 1, l_quantity);
-            r++;
-        }
-    }
+    const int32_t* l_partkey = tin2.getColPtr<int32_t>(0);
+    const int32_t* l_quantity = tin2.getColPtr<int32_t>(1);
+    auto key = [&](int i, int64_t& k) {
+        k = l_partkey[i];
+        return true;
+    };
+    auto emit = [&](int r, int i) {
+        tout.setInt32(r, 0, l_partkey[i]);
+        tout.setInt32(r, 1, l_quantity[i]);
+    };
+    int r = cpu_ops::hashSemiJoin(ht1, nrow2, key, emit);
     tout.setNumRow(r);
     std::cout << std::dec << r << " q17Join_t3_l" << std::endl;
 }
 // t2
 void PartFilter(Table& tin, Table& tout) {
     int nrow = tin.getNumRow();
-    int r = 0;
-    for (int i = 0; i < nrow; i++) {
-        std::array<char, TPCH_READ_P_BRND_LEN + 1> p_brand = tin.getcharN<char, TPCH_READ_P_BRND_LEN + 1>(i, 1);
-        std::array<char, TPCH_READ_P_CNTR_LEN + 1> p_container = tin.getcharN<char, TPCH_READ_P_CNTR_LEN + 1>(i, 2);
-        if (!strcmp(p_container.data(), "MED BOX") && !strcmp(p_brand.data(), "Brand#23")) {
-            int32_t p_partkey = tin.getInt32(i, 0);
-            tout.setInt32(r, 0, p_partkey);
-            r++;
-        }
-    }
+    const int32_t* p_partkey = tin.getColPtr<int32_t>(0);
+    const char* p_brand = tin.getColPtr<char>(1);
+    const char* p_container = tin.getColPtr<char>(2);
+    auto pred = [&](int i) {
+        return !strcmp(p_container + i * (TPCH_READ_P_CNTR_LEN + 1), "MED BOX") &&
+               !strcmp(p_brand + i * (TPCH_READ_P_BRND_LEN + 1), "Brand#23");
+    };
+    auto emit = [&](int r, int i) { tout.setInt32(r, 0, p_partkey[i]); };
+    int r = cpu_ops::parallelFilter(nrow, pred, emit);
     tout.setNumRow(r);
     std::cout << std::dec << r << " q17PartFiler" << std::endl;
 }
 // t3
 void q17Join_t2_l(Table& tin1, Table& tin2, Table& tout) {
     int nrow1 = tin1.getNumRow();
-    std::unordered_map<int32_t, int32_t> ht1;
-    for (int i = 0; i < nrow1; i++) {
-        ht1.insert(std::make_pair(tin1.getInt32(i, 0), 0));
-    }
-    int r = 0;
+    const int32_t* p_partkey = tin1.getColPtr<int32_t>(0);
+    cpu_ops::HashIndex ht1(nrow1, [&](int i, int64_t& k) {
+        k = p_partkey[i];
+        return true;
+    });
     int nrow2 = tin2.getNumRow();
-    for (int i = 0; i < nrow2; i++) {
-        int32_t l_partkey = tin2.getInt32(i, 0);
-        auto it = ht1.find(l_partkey);
-        if (it != ht1.end()) {
-            int32_t l_quantity = tin2.getInt32(i, 1);
-            int32_t l_extendedprice = tin2.getInt32(i, 2);
-            tout.setInt32(r, 0, l_partkey);
-            tout.setInt32(r, 1, l_quantity);
-            tout.setInt32(r, 2, l_extendedprice);
-            r++;
-        }
-    }
+    const int32_t* l_partkey = tin2.getColPtr<int32_t>(0);
+    const int32_t* l_quantity = tin2.getColPtr<int32_t>(1);
+    const int32_t* l_extendedprice = tin2.getColPtr<int32_t>(2);
+    auto key = [&](int i, int64_t& k) {
+        k = l_partkey[i];
+        return true;
+    };
+    auto emit = [&](int r, int i) {
+        tout.setInt32(r, 0, l_partkey[i]);
+        tout.setInt32(r, 1, l_quantity[i]);
+        tout.setInt32(r, 2, l_extendedprice[i]);
+    };
+    int r = cpu_ops::hashSemiJoin(ht1, nrow2, key, emit);
     tout.setNumRow(r);
     std::cout << std::dec << r << " q17Join_t2_l" << std::endl;
 }
@@ -83,21 +85,18 @@ void q17GroupBy(Table& tin, Table& tout) {
     };
 
     int nrow = tin.getNumRow();
-    std::unordered_map<int32_t, Values> ht1;
-    for (int i = 0; i < nrow; i++) {
-        int32_t l_partkey = tin.getInt32(i, 0);
-        int32_t l_quantity = tin.getInt32(i, 1);
-        auto it = ht1.find(l_partkey);
-        if (it != ht1.end()) {
-            int64_t sum_ = it->second.sum + l_quantity;
-            int64_t count_ = it->second.count + 1;
-            Values v{sum_, count_};
-            ht1[l_partkey] = v;
-        } else {
-            Values v{l_quantity, 1};
-            ht1.insert(std::make_pair(l_partkey, v));
-        }
-    }
+    const int32_t* l_partkey = tin.getColPtr<int32_t>(0);
+    const int32_t* l_quantity = tin.getColPtr<int32_t>(1);
+    auto row = [&](int i, int32_t& k, Values& v) {
+        k = l_partkey[i];
+        v = Values{l_quantity[i], 1};
+        return true;
+    };
+    auto merge = [](Values& a, const Values& b) {
+        a.sum += b.sum;
+        a.count += b.count;
+    };
+    auto ht1 = cpu_ops::parallelGroupBy<int32_t, Values>(nrow, row, merge);
     int r = 0;
     for (auto it : ht1) {
         int64_t sum = it.second.sum;
@@ -115,43 +114,50 @@ void q17GroupBy(Table& tin, Table& tout) {
 }
 void q17Join_t1_t3(Table& tin1, Table& tin2, Table& tout) {
     int nrow1 = tin1.getNumRow();
-    std::unordered_map<int32_t, int32_t> ht1;
-    for (int i = 0; i < nrow1; i++) {
-        ht1.insert(std::make_pair(tin1.getInt32(i, 0), tin1.getInt32(i, 1)));
-    }
-    int r = 0;
+    const int32_t* p_partkey = tin1.getColPtr<int32_t>(0);
+    const int32_t* avg = tin1.getColPtr<int32_t>(1);
+    cpu_ops::HashIndex ht1(nrow1, [&](int i, int64_t& k) {
+        k = p_partkey[i];
+        return true;
+    });
     int nrow2 = tin2.getNumRow();
-    for (int i = 0; i < nrow2; i++) {
-        int32_t l_partkey = tin2.getInt32(i, 0);
-        auto it = ht1.find(l_partkey);
-        if (it != ht1.end()) {
-            int32_t l_quantity = tin2.getInt32(i, 1);
-            int32_t l_extendedprice = tin2.getInt32(i, 2);
-            tout.setInt32(r, 0, l_partkey);
-            tout.setInt32(r, 1, it->second);
-            tout.setInt32(r, 2, l_quantity);
-            tout.setInt32(r, 3, l_extendedprice);
-            //       if(l_partkey==135991)std::cout<<l_partkey<<" "<<it->second<<" "<<l_extendedprice<<std::endl;
-            r++;
-        }
-    }
+    const int32_t* l_partkey = tin2.getColPtr<int32_t>(0);
+    const int32_t* l_quantity = tin2.getColPtr<int32_t>(1);
+    const int32_t* l_extendedprice = tin2.getColPtr<int32_t>(2);
+    auto key = [&](int i, int64_t& k) {
+        k = l_partkey[i];
+        return true;
+    };
+    auto emit = [&](int r, int i, int j) {
+        tout.setInt32(r, 0, l_partkey[i]);
+        tout.setInt32(r, 1, avg[j]);
+        tout.setInt32(r, 2, l_quantity[i]);
+        tout.setInt32(r, 3, l_extendedprice[i]);
+    };
+    int r = cpu_ops::hashJoinFirst(ht1, nrow2, key, emit);
     tout.setNumRow(r);
     std::cout << std::dec << r << " q17Join_t1_t3" << std::endl;
 }
 
+struct Q17Sum {
+    int64_t sum;
+    int r;
+    Q17Sum& operator+=(const Q17Sum& o) {
+        sum += o.sum;
+        r += o.r;
+        return *this;
+    }
+};
 void q17GroupBy_l(Table& tin, Table& tout) {
-    int64_t sum = 0;
     int nrow = tin.getNumRow();
-    int r = 0;
-    for (int i = 0; i < nrow; i++) {
-        int32_t avg_l_quantity = tin.getInt32(i, 1);
-        int32_t l_quantity = tin.getInt32(i, 2);
-        int32_t l_extendedprice = tin.getInt32(i, 3);
-        // if((float)l_quantity <avg_l_quantity*0.2){
-        if (1000 * l_quantity < avg_l_quantity) {
-            sum += l_extendedprice;
-            r++;
-        }
-    }
+    const int32_t* avg_l_quantity = tin.getColPtr<int32_t>(1);
+    const int32_t* l_quantity = tin.getColPtr<int32_t>(2);
+    const int32_t* l_extendedprice = tin.getColPtr<int32_t>(3);
+    // if((float)l_quantity <avg_l_quantity*0.2){
+    Q17Sum s = cpu_ops::parallelSum<Q17Sum>(nrow, [&](int i) {
+        return 1000 * l_quantity[i] < avg_l_quantity[i] ? Q17Sum{l_extendedprice[i], 1} : Q17Sum{0, 0};
+    });
+    int64_t sum = s.sum;
+    int r = s.r;
     std::cout << std::dec << sum / 7 << " SUMi, " << r << " NUM" << std::endl;
 }
@@ -13,22 +13,19 @@
  * See the License for the specific language governing permissions and
  * limitations under the License.
  */
+#include "cpu_ops.hpp"
 // t1:1500000
 void q18GroupBy(Table& tin, Table& tout) {
-    std::unordered_map<int32_t, int64_t> m;
     unsigned nrow = tin.getNumRow();
-    for (size_t i = 0; i < nrow; ++i) {
-        int32_t l_orderkey = tin.getInt32(i, 0); // index much patMatch YAML
-        int32_t l_quantity = tin.getInt32(i, 1); // index much patMatch YAML
-        auto it = m.find(l_orderkey);
-        if (it != m.end()) {
-            int64_t s = it->second + l_quantity;
-            m[l_orderkey] = s; // update
-            if (l_orderkey == 1) std::cout << std::dec << s << std::endl;
-        } else {
-            m.insert(std::make_pair(l_orderkey, l_quantity));
-        }
-    }
+    const int32_t* l_orderkey = tin.getColPtr<int32_t>(0); // index much patMatch YAML
+    const int32_t* l_quantity = tin.getColPtr<int32_t>(1); // index much patMatch YAML
+    auto row = [&](int i, int32_t& k, int64_t& v) {
+        k = l_orderkey[i];
+        v = l_quantity[i];
+        return true;
+    };
+    auto merge = [](int64_t& a, const int64_t& b) { a += b; };
+    auto m = cpu_ops::parallelGroupBy<int32_t, int64_t>(nrow, row, merge);
     int r = 0;
     for (auto& it : m) {
         tout.setInt32(r, 0, it.first);
@@ -42,113 +39,87 @@ void q18GroupBy(Table& tin, Table& tout) {
 // t1 order
 void q18Join_t1_o(Table& tin1, Table& tin2, Table& tout) {
     int nrow1 = tin1.getNumRow();
-    std::unordered_map<int32_t, int64_t> ht1;
-    for (int i = 0; i < nrow1; i++) {
-        int32_t l_orderkey = tin1.getInt32(i, 0);
-        int32_t sum_l = tin1.getInt32(i, 1);
-        int32_t sum_h = tin1.getInt32(i, 2);
-        int64_t sum = tin1.mergeInt64(sum_l, sum_h);
-        if (sum > 300) {
-            ht1.insert(std::make_pair(l_orderkey, sum));
-        }
-    }
-    int r = 0;
+    const int32_t* l_orderkey = tin1.getColPtr<int32_t>(0);
+    const int32_t* sum_l = tin1.getColPtr<int32_t>(1);
+    const int32_t* sum_h = tin1.getColPtr<int32_t>(2);
+    cpu_ops::HashIndex ht1(nrow1, [&](int i, int64_t& k) {
+        k = l_orderkey[i];
+        return tin1.mergeInt64(sum_l[i], sum_h[i]) > 300;
+    });
     int nrow2 = tin2.getNumRow();
-    for (int i = 0; i < nrow2; i++) {
-        int32_t o_orderkey = tin2.getInt32(i, 0);
-        auto it = ht1.find(o_orderkey);
-        if (it != ht1.end()) {
-            int32_t o_custkey = tin2.getInt32(i, 1);
-            int32_t o_orderdate = tin2.getInt32(i, 2);
-            int32_t o_totalprice = tin2.getInt32(i, 3);
-            tout.setInt32(r, 0, o_orderkey);
-            tout.setInt32(r, 1, o_custkey);
-            tout.setInt32(r, 2, o_orderdate);
-            tout.setInt32(r, 3, o_totalprice);
-            r++;
-        }
-    }
+    const int32_t* o_orderkey = tin2.getColPtr<int32_t>(0);
+    const int32_t* o_custkey = tin2.getColPtr<int32_t>(1);
+    const int32_t* o_orderdate = tin2.getColPtr<int32_t>(2);
+    const int32_t* o_totalprice = tin2.getColPtr<int32_t>(3);
+    auto key = [&](int i, int64_t& k) {
+        k = o_orderkey[i];
+        return true;
+    };
+    auto emit = [&](int r, int i) {
+        tout.setInt32(r, 0, o_orderkey[i]);
+        tout.setInt32(r, 1, o_custkey[i]);
+        tout.setInt32(r, 2, o_orderdate[i]);
+        tout.setInt32(r, 3, o_totalprice[i]);
+    };
+    int r = cpu_ops::hashSemiJoin(ht1, nrow2, key, emit);
     tout.setNumRow(r);
     std::cout << std::dec << r << " After q18Join_t1_o" << std::endl;
 }
 // c_name c_rowid
 void q18Join_t2_c(Table& tin1, Table& tin2, Table& tout) {
-    struct KeyA {
-        int32_t o_orderkey;
-        int32_t o_orderdate;
-        int32_t o_totalprice;
-    };
     int nrow1 = tin1.getNumRow();
-    std::unordered_multimap<int32_t, KeyA> ht1;
-    for (int i = 0; i < nrow1; i++) {
-        int32_t o_orderkey = tin1.getInt32(i, 0);
-        int32_t o_custkey = tin1.getInt32(i, 1);
-        int32_t o_orderdate = tin1.getInt32(i, 2);
-        int32_t o_totalprice = tin1.getInt32(i, 3);
-        ht1.insert(std::make_pair(o_custkey, KeyA{o_orderkey, o_orderdate, o_totalprice}));
-    }
-    int r = 0;
+    const int32_t* o_orderkey = tin1.getColPtr<int32_t>(0);
+    const int32_t* o_custkey = tin1.getColPtr<int32_t>(1);
+    const int32_t* o_orderdate = tin1.getColPtr<int32_t>(2);
+    const int32_t* o_totalprice = tin1.getColPtr<int32_t>(3);
+    cpu_ops::HashIndex ht1(nrow1, [&](int i, int64_t& k) {
+        k = o_custkey[i];
+        return true;
+    });
     int nrow2 = tin2.getNumRow();
-    for (int i = 0; i < nrow2; i++) {
-        int32_t c_custkey = tin2.getInt32(i, 0);
-        auto its = ht1.equal_range(c_custkey);
-        auto it = its.first;
-        while (it != its.second) {
-            int32_t c_rowid = i; // tin2.getInt32(i,2);
-            int32_t o_orderkey = it->second.o_orderkey;
-            int32_t o_orderdate = it->second.o_orderdate;
-            int32_t o_totalprice = it->second.o_totalprice;
-            tout.setInt32(r, 0, o_orderkey);
-            tout.setInt32(r, 1, o_orderdate);
-            tout.setInt32(r, 2, o_totalprice);
-            tout.setInt32(r, 3, c_rowid);
-            tout.setInt32(r, 4, c_custkey);
-            it++;
-            r++;
-        }
-    }
+    const int32_t* c_custkey = tin2.getColPtr<int32_t>(0);
+    auto key = [&](int i, int64_t& k) {
+        k = c_custkey[i];
+        return true;
+    };
+    auto emit = [&](int r, int i, int j) {
+        tout.setInt32(r, 0, o_orderkey[j]);
+        tout.setInt32(r, 1, o_orderdate[j]);
+        tout.setInt32(r, 2, o_totalprice[j]);
+        tout.setInt32(r, 3, i); // c_rowid
+        tout.setInt32(r, 4, c_custkey[i]);
+    };
+    int r = cpu_ops::hashJoin(ht1, nrow2, key, emit);
     tout.setNumRow(r);
     std::cout << std::dec << r << " After q18Join_t2_c" << std::endl;
 }
 void q18Join_t3_l(Table& tin1, Table& tin2, Table& tout) {
-    struct KeyA {
-        int32_t o_orderdate;
-        int32_t o_totalprice;
-        int32_t c_rowid;
-        int32_t c_custkey;
-    };
     int nrow1 = tin1.getNumRow();
-    std::unordered_multimap<int32_t, KeyA> ht1;
-    for (int i = 0; i < nrow1; i++) {
-        int32_t o_orderkey = tin1.getInt32(i, 0);
-        int32_t o_orderdate = tin1.getInt32(i, 1);
-        int32_t o_totalprice = tin1.getInt32(i, 2);
-        int32_t c_rowid = tin1.getInt32(i, 3);
-        int32_t c_custkey = tin1.getInt32(i, 4);
-        ht1.insert(std::make_pair(o_orderkey, KeyA{o_orderdate, o_totalprice, c_rowid, c_custkey}));
-    }
-    int r = 0;
+    const int32_t* o_orderkey = tin1.getColPtr<int32_t>(0);
+    const int32_t* o_orderdate = tin1.getColPtr<int32_t>(1);
+    const int32_t* o_totalprice = tin1.getColPtr<int32_t>(2);
+    const int32_t* c_rowid = tin1.getColPtr<int32_t>(3);
+    const int32_t* c_custkey = tin1.getColPtr<int32_t>(4);
+    cpu_ops::HashIndex ht1(nrow1, [&](int i, int64_t& k) {
+        k = o_orderkey[i];
+        return true;
+    });
     int nrow2 = tin2.getNumRow();
-    for (int i = 0; i < nrow2; i++) {
-        int32_t l_orderkey = tin2.getInt32(i, 0);
-        auto its = ht1.equal_range(l_orderkey);
-        auto it = its.first;
-        if (it != its.second) {
-            int32_t l_quantity = tin2.getInt32(i, 1);
-            int32_t o_orderdate = it->second.o_orderdate;
-            int32_t o_totalprice = it->second.o_totalprice;
-            int32_t c_rowid = it->second.c_rowid;
-            int32_t c_custkey = it->second.c_custkey;
-            tout.setInt32(r, 0, l_orderkey);
-            tout.setInt32(r, 1, o_orderdate);
-            tout.setInt32(r, 2, o_totalprice);
-            tout.setInt32(r, 3, c_rowid);
-            tout.setInt32(r, 4, c_custkey);
-            tout.setInt32(r, 5, l_quantity);
-            it++;
-            r++;
-        }
-    }
+    const int32_t* l_orderkey = tin2.getColPtr<int32_t>(0);
+    const int32_t* l_quantity = tin2.getColPtr<int32_t>(1);
+    auto key = [&](int i, int64_t& k) {
+        k = l_orderkey[i];
+        return true;
+    };
+    auto emit = [&](int r, int i, int j) {
+        tout.setInt32(r, 0, l_orderkey[i]);
+        tout.setInt32(r, 1, o_orderdate[j]);
+        tout.setInt32(r, 2, o_totalprice[j]);
+        tout.setInt32(r, 3, c_rowid[j]);
+        tout.setInt32(r, 4, c_custkey[j]);
+        tout.setInt32(r, 5, l_quantity[i]);
+    };
+    int r = cpu_ops::hashJoinFirst(ht1, nrow2, key, emit);
     tout.setNumRow(r);
     std::cout << std::dec << r << " After q18Join_t3_l" << std::endl;
 }
@@ -180,27 +151,22 @@ struct hash<Q18GroupKey> {
 
 void q18GroupBy(Table& tin, Table& origintb, Table& tout) {
     std::cout << "DEBUG" << std::endl;
-    std::unordered_map<Q18GroupKey, int64_t> m;
     unsigned nrow = tin.getNumRow();
-    for (size_t i = 0; i < nrow; ++i) {
-        int32_t o_orderkey = tin.getInt32(i, 0);
-        int32_t o_orderdate = tin.getInt32(i, 1);
-        int32_t o_totalprice = tin.getInt32(i, 2);
-        int32_t c_rowid = tin.getInt32(i, 3);
-        std::array<char, TPCH_READ_C_NAME_LEN + 1> c_name_array =
-            origintb.getcharN<char, TPCH_READ_C_NAME_LEN + 1>(c_rowid, 1);
-        std::string c_name = std::string(c_name_array.data());
-        int32_t c_custkey = tin.getInt32(i, 4);
-        int32_t l_quantity = tin.getInt32(i, 5);
-        Q18GroupKey k{o_orderkey, o_orderdate, o_totalprice, c_name, c_custkey};
-        auto it = m.find(k);
-        if (it != m.end()) {
-            int64_t s = it->second + l_quantity;
-            m[k] = s; // update
-        } else {
-            m.insert(std::make_pair(k, l_quantity));
-        }
-    }
+    const int32_t* o_orderkey = tin.getColPtr<int32_t>(0);
+    const int32_t* o_orderdate = tin.getColPtr<int32_t>(1);
+    const int32_t* o_totalprice = tin.getColPtr<int32_t>(2);
+    const int32_t* c_rowid = tin.getColPtr<int32_t>(3);
+    const int32_t* c_custkey = tin.getColPtr<int32_t>(4);
+    const int32_t* l_quantity = tin.getColPtr<int32_t>(5);
+    const char* c_name = origintb.getColPtr<char>(1);
+    auto row = [&](int i, Q18GroupKey& k, int64_t& v) {
+        k = Q18GroupKey{o_orderkey[i], o_orderdate[i], o_totalprice[i],
+                        std::string(c_name + c_rowid[i] * (TPCH_READ_C_NAME_LEN + 1)), c_custkey[i]};
+        v = l_quantity[i];
+        return true;
+    };
+    auto merge = [](int64_t& a, const int64_t& b) { a += b; };
+    auto m = cpu_ops::parallelGroupBy<Q18GroupKey, int64_t>(nrow, row, merge);
     int r = 0;
     for (auto& it : m) {
         tout.setInt32(r, 0, it.first.o_orderkey);
@@ -13,66 +13,70 @@
  * See the License for the specific language governing permissions and
  * limitations under the License.
  */
+#include "cpu_ops.hpp"
 // t1
 void PartFilter1(Table& tin, Table& tout) {
     int nrow = tin.getNumRow();
-    int r = 0;
-    for (int i = 0; i < nrow; i++) {
-        std::array<char, TPCH_READ_P_BRND_LEN + 1> p_brand = tin.getcharN<char, TPCH_READ_P_BRND_LEN + 1>(i, 1);
-        std::array<char, TPCH_READ_P_CNTR_LEN + 1> p_container = tin.getcharN<char, TPCH_READ_P_CNTR_LEN + 1>(i, 2);
-        if ((std::string(p_container.data()) == "SM CASE" || std::string(p_container.data()) == "SM BOX" ||
-             std::string(p_container.data()) == "SM PACK" || std::string(p_container.data()) == "SM PKG") &&
-            std::string(p_brand.data()) == "Brand#12") {
-            int32_t p_partkey = tin.getInt32(i, 0);
-            int32_t p_size = tin.getInt32(i, 3);
-            tout.setInt32(r, 0, p_partkey);
-            tout.setInt32(r, 1, p_size);
-            r++;
-        }
-    }
+    const int32_t* p_partkey = tin.getColPtr<int32_t>(0);
+    const char* p_brand = tin.getColPtr<char>(1);
+    const char* p_container = tin.getColPtr<char>(2);
+    const int32_t* p_size = tin.getColPtr<int32_t>(3);
+    auto pred = [&](int i) {
+        const char* c = p_container + i * (TPCH_READ_P_CNTR_LEN + 1);
+        return (!strcmp(c, "SM CASE") || !strcmp(c, "SM BOX") || !strcmp(c, "SM PACK") || !strcmp(c, "SM PKG")) &&
+               !strcmp(p_brand + i * (TPCH_READ_P_BRND_LEN + 1), "Brand#12");
+    };
+    auto emit = [&](int r, int i) {
+        tout.setInt32(r, 0, p_partkey[i]);
+        tout.setInt32(r, 1, p_size[i]);
+    };
+    int r = cpu_ops::parallelFilter(nrow, pred, emit);
     tout.setNumRow(r);
     std::cout << std::dec << r << " after PartFilter1" << std::endl;
 }
-void PartFilter_(Table& tin, Table& tout0, Table& tout1, Table& tout2) {
+// split the parts into tout0/1/2 by the group cls(i) of each row, -1 drops the row
+template <class Cls>
+void q19SplitParts(Table& tin, Cls cls, Table& tout0, Table& tout1, Table& tout2) {
     int nrow = tin.getNumRow();
-    int r0 = 0;
-    int r1 = 0;
-    int r2 = 0;
-    for (int i = 0; i < nrow; i++) {
-        std::array<char, TPCH_READ_P_BRND_LEN + 1> p_brand = tin.getcharN<char, TPCH_READ_P_BRND_LEN + 1>(i, 1);
-        std::array<char, TPCH_READ_P_CNTR_LEN + 1> p_container = tin.getcharN<char, TPCH_READ_P_CNTR_LEN + 1>(i, 2);
-        if (std::string(p_brand.data()) == "Brand#12" &&
-            (std::string(p_container.data()) == "SM CASE" || std::string(p_container.data()) == "SM BOX" ||
-             std::string(p_container.data()) == "SM PACK" || std::string(p_container.data()) == "SM PKG")) {
-            int32_t p_partkey = tin.getInt32(i, 0);
-            int32_t p_size = tin.getInt32(i, 3);
-            tout0.setInt32(r0, 0, p_partkey);
-            tout0.setInt32(r0, 1, p_size);
-            r0++;
-        } else if (std::string(p_brand.data()) == "Brand#23" &&
-                   (std::string(p_container.data()) == "MED BAG" || std::string(p_container.data()) == "MED BOX" ||
-                    std::string(p_container.data()) == "MED PKG" || std::string(p_container.data()) == "MED PACK")) {
-            int32_t p_partkey = tin.getInt32(i, 0);
-            int32_t p_size = tin.getInt32(i, 3);
-            tout1.setInt32(r1, 0, p_partkey);
-            tout1.setInt32(r1, 1, p_size);
-            r1++;
-        } else if (std::string(p_brand.data()) == "Brand#34" &&
-                   (std::string(p_container.data()) == "LG CASE" || std::string(p_container.data()) == "LG BOX" ||
-                    std::string(p_container.data()) == "LG PACK" || std::string(p_container.data()) == "LG PKG")) {
-            int32_t p_partkey = tin.getInt32(i, 0);
-            int32_t p_size = tin.getInt32(i, 3);
-            tout2.setInt32(r2, 0, p_partkey);
-            tout2.setInt32(r2, 1, p_size);
-            r2++;
-        }
+    const int32_t* p_partkey = tin.getColPtr<int32_t>(0);
+    const int32_t* p_size = tin.getColPtr<int32_t>(3);
+    std::vector<int8_t> g(nrow);
+    cpu_ops::parallelFor(nrow, [&](int begin, int end) {
+        for (int i = begin; i < end; i++) g[i] = cls(i);
+    });
+    Table* touts[3] = {&tout0, &tout1, &tout2};
+    int rs[3];
+    for (int t = 0; t < 3; t++) {
+        Table& tout = *touts[t];
+        auto emit = [&](int r, int i) {
+            tout.setInt32(r, 0, p_partkey[i]);
+            tout.setInt32(r, 1, p_size[i]);
+        };
+        rs[t] = cpu_ops::parallelFilter(nrow, [&](int i) { return g[i] == t; }, emit);
+        tout.setNumRow(rs[t]);
     }
-    tout0.setNumRow(r0);
-    tout1.setNumRow(r1);
-    tout2.setNumRow(r2);
-    std::cout << std::dec << r0 << " after_ PartFilter1" << std::endl;
-    std::cout << std::dec << r1 << " after_ PartFilter2" << std::endl;
-    std::cout << std::dec << r2 << " after_ PartFilter3" << std::endl;
+    std::cout << std::dec << rs[0] << " after_ PartFilter1" << std::endl;
+    std::cout << std::dec << rs[1] << " after_ PartFilter2" << std::endl;
+    std::cout << std::dec << rs[2] << " after_ PartFilter3" << std::endl;
+}
+void PartFilter_(Table& tin, Table& tout0, Table& tout1, Table& tout2) {
+    const char* p_brand = tin.getColPtr<char>(1);
+    const char* p_container = tin.getColPtr<char>(2);
+    auto cls = [&](int i) {
+        const char* b = p_brand + i * (TPCH_READ_P_BRND_LEN + 1);
+        const char* c = p_container + i * (TPCH_READ_P_CNTR_LEN + 1);
+        if (!strcmp(b, "Brand#12") &&
+            (!strcmp(c, "SM CASE") || !strcmp(c, "SM BOX") || !strcmp(c, "SM PACK") || !strcmp(c, "SM PKG")))
+            return 0;
+        if (!strcmp(b, "Brand#23") &&
+            (!strcmp(c, "MED BAG") || !strcmp(c, "MED BOX") || !strcmp(c, "MED PKG") || !strcmp(c, "MED PACK")))
+            return 1;
+        if (!strcmp(b, "Brand#34") &&
+            (!strcmp(c, "LG CASE") || !strcmp(c, "LG BOX") || !strcmp(c, "LG PACK") || !strcmp(c, "LG PKG")))
+            return 2;
+        return -1;
+    };
+    q19SplitParts(tin, cls, tout0, tout1, tout2);
 }
 void PartFilter(Table& tin, Table& tout0, Table& tout1, Table& tout2) {
     std::unordered_map<std::string, int32_t> ht1;
@@ -90,62 +94,39 @@ void PartFilter(Table& tin, Table& tout0, Table& tout1, Table& tout2) {
     ht3.insert(std::make_pair("LG BOX", 0));
     ht3.insert(std::make_pair("LG PACK", 0));
     ht3.insert(std::make_pair("LG PKG", 0));
-    int nrow = tin.getNumRow();
-    int r0 = 0;
-    int r1 = 0;
-    int r2 = 0;
-    for (int i = 0; i < nrow; i++) {
-        std::array<char, TPCH_READ_P_BRND_LEN + 1> p_brand = tin.getcharN<char, TPCH_READ_P_BRND_LEN + 1>(i, 1);
-        std::array<char, TPCH_READ_P_CNTR_LEN + 1> p_container = tin.getcharN<char, TPCH_READ_P_CNTR_LEN + 1>(i, 2);
-        if (std::string(p_brand.data()) == "Brand#12" && ht1.find(std::string(p_container.data())) != ht1.end()) {
-            int32_t p_partkey = tin.getInt32(i, 0);
-            int32_t p_size = tin.getInt32(i, 3);
-            tout0.setInt32(r0, 0, p_partkey);
-            tout0.setInt32(r0, 1, p_size);
-            r0++;
-        } else if (std::string(p_brand.data()) == "Brand#23" &&
-                   ht2.find(std::string(p_container.data())) != ht2.end()) {
-            int32_t p_partkey = tin.getInt32(i, 0);
-            int32_t p_size = tin.getInt32(i, 3);
-            tout1.setInt32(r1, 0, p_partkey);
-            tout1.setInt32(r1, 1, p_size);
-            r1++;
-        } else if (std::string(p_brand.data()) == "Brand#34" &&
-                   ht3.find(std::string(p_container.data())) != ht3.end()) {
-            int32_t p_partkey = tin.getInt32(i, 0);
-            int32_t p_size = tin.getInt32(i, 3);
-            tout2.setInt32(r2, 0, p_partkey);
-            tout2.setInt32(r2, 1, p_size);
-            r2++;
-        }
-    }
-    tout0.setNumRow(r0);
-    tout1.setNumRow(r1);
-    tout2.setNumRow(r2);
-    std::cout << std::dec << r0 << " after_ PartFilter1" << std::endl;
-    std::cout << std::dec << r1 << " after_ PartFilter2" << std::endl;
-    std::cout << std::dec << r2 << " after_ PartFilter3" << std::endl;
+    const char* p_brand = tin.getColPtr<char>(1);
+    const char* p_container = tin.getColPtr<char>(2);
+    auto cls = [&](int i) {
+        std::string b(p_brand + i * (TPCH_READ_P_BRND_LEN + 1));
+        std::string c(p_container + i * (TPCH_READ_P_CNTR_LEN + 1));
+        if (b == "Brand#12" && ht1.find(c) != ht1.end()) return 0;
+        if (b == "Brand#23" && ht2.find(c) != ht2.end()) return 1;
+        if (b == "Brand#34" && ht3.find(c) != ht3.end()) return 2;
+        return -1;
+    };
+    q19SplitParts(tin, cls, tout0, tout1, tout2);
 }
 // t2
 void LineFilter(Table& tin, Table& tout) {
     int nrow = tin.getNumRow();
-    int r = 0;
-    for (int i = 0; i < nrow; i++) {
-        std::array<char, TPCH_READ_MAXAGG_LEN + 1> l_shipmode = tin.getcharN<char, TPCH_READ_MAXAGG_LEN + 1>(i, 4);
-        std::array<char, TPCH_READ_MAXAGG_LEN + 1> l_shipinstruct = tin.getcharN<char, TPCH_READ_MAXAGG_LEN + 1>(i, 5);
-        if ((std::string(l_shipmode.data()) == "AIR" || std::string(l_shipmode.data()) == "AIR REG") &&
-            std::string(l_shipinstruct.data()) == "DELIVER IN PERSON") {
-            int32_t l_partkey = tin.getInt32(i, 0);
-            int32_t l_quantity = tin.getInt32(i, 1);
-            int32_t l_extendedprice = tin.getInt32(i, 2);
-            int32_t l_discount = tin.getInt32(i, 3);
-            tout.setInt32(r, 0, l_partkey);
-            tout.setInt32(r, 1, l_quantity);
-            tout.setInt32(r, 2, l_extendedprice);
-            tout.setInt32(r, 3, l_discount);
-            r++;
-        }
-    }
+    const int32_t* l_partkey = tin.getColPtr<int32_t>(0);
+    const int32_t* l_quantity = tin.getColPtr<int32_t>(1);
+    const int32_t* l_extendedprice = tin.getColPtr<int32_t>(2);
+    const int32_t* l_discount = tin.getColPtr<int32_t>(3);
+    const char* l_shipmode = tin.getColPtr<char>(4);
+    const char* l_shipinstruct = tin.getColPtr<char>(5);
+    auto pred = [&](int i) {
+        const char* mode = l_shipmode + i * (TPCH_READ_MAXAGG_LEN + 1);
+        return (!strcmp(mode, "AIR") || !strcmp(mode, "AIR REG")) &&
+               !strcmp(l_shipinstruct + i * (TPCH_READ_MAXAGG_LEN + 1), "DELIVER IN PERSON");
+    };
+    auto emit = [&](int r, int i) {
+        tout.setInt32(r, 0, l_partkey[i]);
+        tout.setInt32(r, 1, l_quantity[i]);
+        tout.setInt32(r, 2, l_extendedprice[i]);
+        tout.setInt32(r, 3, l_discount[i]);
+    };
+    int r = cpu_ops::parallelFilter(nrow, pred, emit);
     tout.setNumRow(r);
     std::cout << std::dec << r << " after LineFilter1" << std::endl;
 }
@@ -153,69 +134,65 @@ void LineFilter(Table& tin, Table& tout) {
 void q19Join_t1_t2(Table& tin1, Table& tin2, Table& tout) {
     int nrow1 = tin1.getNumRow();
     int nrow2 = tin2.getNumRow();
-    std::unordered_map<int32_t, int64_t> ht1;
-    for (int i = 0; i < nrow1; i++) {
-        int32_t p_partkey = tin1.getInt32(i, 0);
-        int32_t p_size = tin1.getInt32(i, 1);
-        if (p_size >= 1 && p_size <= 5) {
-            ht1.insert(std::make_pair(p_partkey, p_size));
-        }
-    }
-    int r = 0;
-    for (int i = 0; i < nrow2; i++) {
-        int32_t l_quantity = tin2.getInt32(i, 1);
-        int32_t l_partkey = tin2.getInt32(i, 0);
-        if (l_quantity >= 1 && l_quantity <= 11) {
-            auto it = ht1.find(l_partkey);
-            if (it != ht1.end()) {
-                int32_t l_extendedprice = tin2.getInt32(i, 2);
-                int32_t l_discount = tin2.getInt32(i, 3);
-                int32_t e = l_extendedprice * (100 - l_discount);
-                tout.setInt32(r, 0, e);
-                r++;
-            }
-        }
-    }
+    const int32_t* p_partkey = tin1.getColPtr<int32_t>(0);
+    const int32_t* p_size = tin1.getColPtr<int32_t>(1);
+    cpu_ops::HashIndex ht1(nrow1, [&](int i, int64_t& k) {
+        k = p_partkey[i];
+        return p_size[i] >= 1 && p_size[i] <= 5;
+    });
+    const int32_t* l_partkey = tin2.getColPtr<int32_t>(0);
+    const int32_t* l_quantity = tin2.getColPtr<int32_t>(1);
+    const int32_t* l_extendedprice = tin2.getColPtr<int32_t>(2);
+    const int32_t* l_discount = tin2.getColPtr<int32_t>(3);
+    auto key = [&](int i, int64_t& k) {
+        k = l_partkey[i];
+        return l_quantity[i] >= 1 && l_quantity[i] <= 11;
+    };
+    auto emit = [&](int r, int i) {
+        int32_t e = l_extendedprice[i] * (100 - l_discount[i]);
+        tout.setInt32(r, 0, e);
+    };
+    int r = cpu_ops::hashSemiJoin(ht1, nrow2, key, emit);
     tout.setNumRow(r);
     std::cout << std::dec << r << " after q19Join_t1_t2" << std::endl;
 }
 // t4
 void PartFilter2(Table& tin, Table& tout) {
     int nrow = tin.getNumRow();
-    int r = 0;
-    for (int i = 0; i < nrow; i++) {
-        std::array<char, TPCH_READ_P_BRND_LEN + 1> p_brand = tin.getcharN<char, TPCH_READ_P_BRND_LEN + 1>(i, 1);
-        std::array<char, TPCH_READ_P_CNTR_LEN + 1> p_container = tin.getcharN<char, TPCH_READ_P_CNTR_LEN + 1>(i, 2);
-        if ((std::string(p_container.data()) == "MED BAG" || std::string(p_container.data()) == "MED BOX" ||
-             std::string(p_container.data()) == "MED PKG" || std::string(p_container.data()) == "MED PACK") &&
-            std::string(p_brand.data()) == "Brand#23") {
-            int32_t p_partkey = tin.getInt32(i, 0);
-            int32_t p_size = tin.getInt32(i, 3);
-            tout.setInt32(r, 0, p_partkey);
-            tout.setInt32(r, 1, p_size);
-            r++;
-        }
-    }
+    const int32_t* p_partkey = tin.getColPtr<int32_t>(0);
+    const char* p_brand = tin.getColPtr<char>(1);
+    const char* p_container = tin.getColPtr<char>(2);
+    const int32_t* p_size = tin.getColPtr<int32_t>(3);
+    auto pred = [&](int i) {
+        const char* c = p_container + i * (TPCH_READ_P_CNTR_LEN + 1);
+        return (!strcmp(c, "MED BAG") || !strcmp(c, "MED BOX") || !strcmp(c, "MED PKG") || !strcmp(c, "MED PACK")) &&
+               !strcmp(p_brand + i * (TPCH_READ_P_BRND_LEN + 1), "Brand#23");
+    };
+    auto emit = [&](int r, int i) {
+        tout.setInt32(r, 0, p_partkey[i]);
+        tout.setInt32(r, 1, p_size[i]);
+    };
+    int r = cpu_ops::parallelFilter(nrow, pred, emit);
     tout.setNumRow(r);
     std::cout << std::dec << r << " after PartFilter2" << std::endl;
 }
 // t6
 void PartFilter3(Table& tin, Table& tout) {
     int nrow = tin.getNumRow();
-    int r = 0;
-    for (int i = 0; i < nrow; i++) {
-        std::array<char, TPCH_READ_P_BRND_LEN + 1> p_brand = tin.getcharN<char, TPCH_READ_P_BRND_LEN + 1>(i, 1);
-        std::array<char, TPCH_READ_P_CNTR_LEN + 1> p_container = tin.getcharN<char, TPCH_READ_P_CNTR_LEN + 1>(i, 2);
-        if ((std::string(p_container.data()) == "LG CASE" || std::string(p_container.data()) == "LG BOX" ||
-             std::string(p_container.data()) == "LG PACK" || std::string(p_container.data()) == "LG PKG") &&
-            std::string(p_brand.data()) == "Brand#34") {
-            int32_t p_partkey = tin.getInt32(i, 0);
-            int32_t p_size = tin.getInt32(i, 3);
-            tout.setInt32(r, 0, p_partkey);
-            tout.setInt32(r, 1, p_size);
-            r++;
-        }
-    }
+    const int32_t* p_partkey = tin.getColPtr<int32_t>(0);
+    const char* p_brand = tin.getColPtr<char>(1);
+    const char* p_container = tin.getColPtr<char>(2);
+    const int32_t* p_size = tin.getColPtr<int32_t>(3);
+    auto pred = [&](int i) {
+        const char* c = p_container + i * (TPCH_READ_P_CNTR_LEN + 1);
+        return (!strcmp(c, "LG CASE") || !strcmp(c, "LG BOX") || !strcmp(c, "LG PACK") || !strcmp(c, "LG PKG")) &&
+               !strcmp(p_brand + i * (TPCH_READ_P_BRND_LEN + 1), "Brand#34");
+    };
+    auto emit = [&](int r, int i) {
+        tout.setInt32(r, 0, p_partkey[i]);
+        tout.setInt32(r, 1, p_size[i]);
+    };
+    int r = cpu_ops::parallelFilter(nrow, pred, emit);
     tout.setNumRow(r);
     std::cout << std::dec << r << " after PartFilter3" << std::endl;
 }
@@ -223,29 +200,25 @@ void PartFilter3(Table& tin, Table& tout) {
 void q19Join_t4_t2(Table& tin1, Table& tin2, Table& tout) {
     int nrow1 = tin1.getNumRow();
     int nrow2 = tin2.getNumRow();
-    std::unordered_map<int32_t, int64_t> ht1;
-    for (int i = 0; i < nrow1; i++) {
-        int32_t p_partkey = tin1.getInt32(i, 0);
-        int32_t p_size = tin1.getInt32(i, 1);
-        if (p_size >= 1 && p_size <= 10) {
-            ht1.insert(std::make_pair(p_partkey, p_size));
-        }
-    }
-    int r = 0;
-    for (int i = 0; i < nrow2; i++) {
-        int32_t l_quantity = tin2.getInt32(i, 1);
-        int32_t l_partkey = tin2.getInt32(i, 0);
-        if (l_quantity >= 10 && l_quantity <= 20) {
-            auto it = ht1.find(l_partkey);
-            if (it != ht1.end()) {
-                int32_t l_extendedprice = tin2.getInt32(i, 2);
-                int32_t l_discount = tin2.getInt32(i, 3);
-                int32_t e = l_extendedprice * (100 - l_discount);
-                tout.setInt32(r, 0, e);
-                r++;
-            }
-        }
-    }
+    const int32_t* p_partkey = tin1.getColPtr<int32_t>(0);
+    const int32_t* p_size = tin1.getColPtr<int32_t>(1);
+    cpu_ops::HashIndex ht1(nrow1, [&](int i, int64_t& k) {
+        k = p_partkey[i];
+        return p_size[i] >= 1 && p_size[i] <= 10;
+    });
+    const int32_t* l_partkey = tin2.getColPtr<int32_t>(0);
+    const int32_t* l_quantity = tin2.getColPtr<int32_t>(1);
+    const int32_t* l_extendedprice = tin2.getColPtr<int32_t>(2);
+    const int32_t* l_discount = tin2.getColPtr<int32_t>(3);
+    auto key = [&](int i, int64_t& k) {
+        k = l_partkey[i];
+        return l_quantity[i] >= 10 && l_quantity[i] <= 20;
+    };
+    auto emit = [&](int r, int i) {
+        int32_t e = l_extendedprice[i] * (100 - l_discount[i]);
+        tout.setInt32(r, 0, e);
+    };
+    int r = cpu_ops::hashSemiJoin(ht1, nrow2, key, emit);
     tout.setNumRow(r);
     std::cout << std::dec << r << " after q19Join_t4_t2" << std::endl;
 }
@@ -254,41 +227,33 @@ void q19Join_t4_t2(Table& tin1, Table& tin2, Table& tout) {
 void q19Join_t6_t2(Table& tin1, Table& tin2, Table& tout) {
     int nrow1 = tin1.getNumRow();
     int nrow2 = tin2.getNumRow();
-    std::unordered_map<int32_t, int64_t> ht1;
-    for (int i = 0; i < nrow1; i++) {
-        int32_t p_partkey = tin1.getInt32(i, 0);
-        int32_t p_size = tin1.getInt32(i, 1);
-        if (p_size >= 1 && p_size <= 15) {
-            ht1.insert(std::make_pair(p_partkey, p_size));
-        }
-    }
-    int r = 0;
-    for (int i = 0; i < nrow2; i++) {
-        int32_t l_quantity = tin2.getInt32(i, 1);
-        int32_t l_partkey = tin2.getInt32(i, 0);
-        if (l_quantity >= 20 && l_quantity <= 30) {
-            auto it = ht1.find(l_partkey);
-            if (it != ht1.end()) {
-                int32_t l_extendedprice = tin2.getInt32(i, 2);
-                int32_t l_discount = tin2.getInt32(i, 3);
-                int32_t e = l_extendedprice * (100 - l_discount);
-                tout.setInt32(r, 0, e);
-                r++;
-            }
-        }
-    }
+    const int32_t* p_partkey = tin1.getColPtr<int32_t>(0);
+    const int32_t* p_size = tin1.getColPtr<int32_t>(1);
+    cpu_ops::HashIndex ht1(nrow1, [&](int i, int64_t& k) {
+        k = p_partkey[i];
+        return p_size[i] >= 1 && p_size[i] <= 15;
+    });
+    const int32_t* l_partkey = tin2.getColPtr<int32_t>(0);
+    const int32_t* l_quantity = tin2.getColPtr<int32_t>(1);
+    const int32_t* l_extendedprice = tin2.getColPtr<int32_t>(2);
+    const int32_t* l_discount = tin2.getColPtr<int32_t>(3);
+    auto key = [&](int i, int64_t& k) {
+        k = l_partkey[i];
+        return l_quantity[i] >= 20 && l_quantity[i] <= 30;
+    };
+    auto emit = [&](int r, int i) {
+        int32_t e = l_extendedprice[i] * (100 - l_discount[i]);
+        tout.setInt32(r, 0, e);
+    };
+    int r = cpu_ops::hashSemiJoin(ht1, nrow2, key, emit);
     tout.setNumRow(r);
     std::cout << std::dec << r << " after q19Join_t6_t2" << std::endl;
 }
 
 // t3 t5 t7
 int64_t q19GroupBy(Table& tin, Table& tout) {
-    int64_t sum = 0;
-    unsigned nrow = tin.getNumRow();
-    for (size_t i = 0; i < nrow; ++i) {
-        int32_t e = tin.getInt32(i, 0);
-        sum += e;
-    }
+    const int32_t* e = tin.getColPtr<int32_t>(0);
+    int64_t sum = cpu_ops::parallelSum<int64_t>(tin.getNumRow(), [&](int i) { return e[i]; });
     return sum;
     std::cout << std::dec << sum << " after q19Join_t6_t2" << std::endl;
 }
@@ -14,19 +14,16 @@
  * limitations under the License.
  */
 #include <regex>
+#include "cpu_ops.hpp"
 // 2388
 void PartFilter(Table& tin, Table& tout) {
     int nrow = tin.getNumRow();
-    int r = 0;
-    for (int i = 0; i < nrow; i++) {
-        std::array<char, TPCH_READ_P_NAME_LEN + 1> p_name = tin.getcharN<char, TPCH_READ_P_NAME_LEN + 1>(i, 1);
-        // if(std::regex_match(p_name.data(), std::regex("(forest)(.*)"))){
-        if (std::string(p_name.data()).find("forest") == 0) {
-            int32_t p_partkey = tin.getInt32(i, 0);
-            tout.setInt32(r, 0, p_partkey);
-            r++;
-        }
-    }
+    const int32_t* p_partkey = tin.getColPtr<int32_t>(0);
+    const char* p_name = tin.getColPtr<char>(1);
+    // if(std::regex_match(p_name.data(), std::regex("(forest)(.*)"))){
+    auto pred = [&](int i) { return !strncmp(p_name + i * (TPCH_READ_P_NAME_LEN + 1), "forest", 6); };
+    auto emit = [&](int r, int i) { tout.setInt32(r, 0, p_partkey[i]); };
+    int r = cpu_ops::parallelFilter(nrow, pred, emit);
     tout.setNumRow(r);
     std::cout << std::dec << r << " after PartFilter" << std::endl;
 }
@@ -34,24 +31,24 @@ void PartFilter(Table& tin, Table& tout) {
 void q20Join_t1_p(Table& tin1, Table& tin2, Table& tout) {
     int nrow1 = tin1.getNumRow();
     int nrow2 = tin2.getNumRow();
-    std::unordered_map<int32_t, int32_t> ht1;
-    for (int i = 0; i < nrow1; i++) {
-        int32_t p_partkey = tin1.getInt32(i, 0);
-        ht1.insert(std::make_pair(p_partkey, 0));
-    }
-    int r = 0;
-    for (int i = 0; i < nrow2; i++) {
-        int32_t ps_partkey = tin2.getInt32(i, 0);
-        auto it = ht1.find(ps_partkey);
-        if (it != ht1.end()) {
-            int32_t ps_suppkey = tin2.getInt32(i, 1);
-            int32_t ps_availqty = tin2.getInt32(i, 2);
-            tout.setInt32(r, 0, ps_partkey);
-            tout.setInt32(r, 1, ps_suppkey);
-            tout.setInt32(r, 2, ps_availqty);
-            r++;
-        }
-    }
+    const int32_t* p_partkey = tin1.getColPtr<int32_t>(0);
+    cpu_ops::HashIndex ht1(nrow1, [&](int i, int64_t& k) {
+        k = p_partkey[i];
+        return true;
+    });
+    const int32_t* ps_partkey = tin2.getColPtr<int32_t>(0);
+    const int32_t* ps_suppkey = tin2.getColPtr<int32_t>(1);
+    const int32_t* ps_availqty = tin2.getColPtr<int32_t>(2);
+    auto key = [&](int i, int64_t& k) {
+        k = ps_partkey[i];
+        return true;
+    };
+    auto emit = [&](int r, int i) {
+        tout.setInt32(r, 0, ps_partkey[i]);
+        tout.setInt32(r, 1, ps_suppkey[i]);
+        tout.setInt32(r, 2, ps_availqty[i]);
+    };
+    int r = cpu_ops::hashSemiJoin(ht1, nrow2, key, emit);
     tout.setNumRow(r);
     std::cout << std::dec << r << " after q20Join_t1_p" << std::endl;
 }
@@ -73,24 +70,18 @@ struct hash<Q20GroupKey> {
 };
 }
 void q20GroupBy(Table& tin, Table& tout) {
-    std::unordered_map<Q20GroupKey, int64_t> m;
     unsigned nrow = tin.getNumRow();
-    for (size_t i = 0; i < nrow; ++i) {
-        int32_t l_partkey = tin.getInt32(i, 0);
-        int32_t l_suppkey = tin.getInt32(i, 1);
-        int32_t l_shipdate = tin.getInt32(i, 2);
-        int32_t l_quantity = tin.getInt32(i, 3);
-        if (l_shipdate >= 19940101 && l_shipdate < 19950101) {
-            Q20GroupKey k{l_partkey, l_suppkey};
-            auto it = m.find(k);
-            if (it != m.end()) {
-                int64_t t = it->second + l_quantity;
-                m[k] = t;
-            } else {
-                m.insert(std::make_pair(k, l_quantity));
-            }
-        }
-    }
+    const int32_t* l_partkey = tin.getColPtr<int32_t>(0);
+    const int32_t* l_suppkey = tin.getColPtr<int32_t>(1);
+    const int32_t* l_shipdate = tin.getColPtr<int32_t>(2);
+    const int32_t* l_quantity = tin.getColPtr<int32_t>(3);
+    auto row = [&](int i, Q20GroupKey& k, int64_t& v) {
+        k = Q20GroupKey{l_partkey[i], l_suppkey[i]};
+        v = l_quantity[i];
+        return l_shipdate[i] >= 19940101 && l_shipdate[i] < 19950101;
+    };
+    auto merge = [](int64_t& a, const int64_t& b) { a += b; };
+    auto m = cpu_ops::parallelGroupBy<Q20GroupKey, int64_t>(nrow, row, merge);
     int r = 0;
     for (auto& it : m) {
         tout.setInt32(r, 0, it.first.l_partkey);
@@ -109,115 +100,95 @@ void q20GroupBy(Table& tin, Table& tout) {
 void q20Join_t2_t3(Table& tin1, Table& tin2, Table& tout) {
     int nrow1 = tin1.getNumRow();
     int nrow2 = tin2.getNumRow();
-    std::unordered_map<Q20GroupKey, int32_t> ht1;
-    for (int i = 0; i < nrow1; i++) {
-        int32_t p_partkey = tin1.getInt32(i, 0);
-        int32_t ps_suppkey = tin1.getInt32(i, 1);
-        int32_t ps_availqty = tin1.getInt32(i, 2);
-        Q20GroupKey k{p_partkey, ps_suppkey};
-        ht1.insert(std::make_pair(k, ps_availqty));
-    }
-    int r = 0;
-    for (int i = 0; i < nrow2; i++) {
-        int32_t l_partkey = tin2.getInt32(i, 0);
-        int32_t l_suppkey = tin2.getInt32(i, 1);
-        Q20GroupKey k = {l_partkey, l_suppkey};
-        auto it = ht1.find(k);
-        if (it != ht1.end()) {
-            int32_t ps_suppkey = it->first.l_suppkey;
-            int32_t ps_availqty = it->second;
-            // int64_t sum_t1 = tin2.getInt64(i,2);
-            int32_t sum_l = tin2.getInt32(i, 2);
-            int32_t sum_h = tin2.getInt32(i, 3);
-            tout.setInt32(r, 0, ps_suppkey);
-            tout.setInt32(r, 1, 10 * ps_availqty);
-            tout.setInt32(r, 2, sum_l);
-            tout.setInt32(r, 3, sum_h);
-            r++;
-        }
-    }
+    const int32_t* p_partkey = tin1.getColPtr<int32_t>(0);
+    const int32_t* ps_suppkey = tin1.getColPtr<int32_t>(1);
+    const int32_t* ps_availqty = tin1.getColPtr<int32_t>(2);
+    cpu_ops::HashIndex ht1(nrow1, [&](int i, int64_t& k) {
+        k = cpu_ops::packKey(p_partkey[i], ps_suppkey[i]);
+        return true;
+    });
+    const int32_t* l_partkey = tin2.getColPtr<int32_t>(0);
+    const int32_t* l_suppkey = tin2.getColPtr<int32_t>(1);
+    // int64_t sum_t1 = tin2.getInt64(i,2);
+    const int32_t* sum_l = tin2.getColPtr<int32_t>(2);
+    const int32_t* sum_h = tin2.getColPtr<int32_t>(3);
+    auto key = [&](int i, int64_t& k) {
+        k = cpu_ops::packKey(l_partkey[i], l_suppkey[i]);
+        return true;
+    };
+    auto emit = [&](int r, int i, int j) {
+        tout.setInt32(r, 0, ps_suppkey[j]);
+        tout.setInt32(r, 1, 10 * ps_availqty[j]);
+        tout.setInt32(r, 2, sum_l[i]);
+        tout.setInt32(r, 3, sum_h[i]);
+    };
+    int r = cpu_ops::hashJoinFirst(ht1, nrow2, key, emit);
     tout.setNumRow(r);
     std::cout << std::dec << r << " q20Join_t2_t3" << std::endl;
 }
 
 // filter table
 void q20Join_s_t4(Table& tin1, Table& tin2, Table& tout) {
-    struct q20KeyA {
-        int32_t s_nationkey;
-        int32_t s_rowid;
-    };
     int nrow1 = tin1.getNumRow();
     int nrow2 = tin2.getNumRow();
-    std::unordered_map<int32_t, q20KeyA> ht1;
-    for (int i = 0; i < nrow1; i++) {
-        int32_t s_suppkey = tin1.getInt32(i, 0);
-        int32_t s_nationkey = tin1.getInt32(i, 1);
-        int32_t s_rowid = i; // tin1.getInt32(i,1);
-        ht1.insert(std::make_pair(s_suppkey, q20KeyA{s_nationkey, s_rowid}));
-    }
-    int r = 0;
-    for (int i = 0; i < nrow2; i++) {
-        int32_t ps_suppkey = tin2.getInt32(i, 0);
-        int32_t ps_availqty = tin2.getInt32(i, 1);
-        int32_t sum_l = tin2.getInt32(i, 2);
-        int64_t sum_h = tin2.getInt32(i, 3);
-        int64_t sum = (sum_h << 32) + sum_l;
-        if (ps_availqty > sum) {
-            auto it = ht1.find(ps_suppkey);
-            if (it != ht1.end()) {
-                int32_t s_nationkey = it->second.s_nationkey;
-                int32_t s_rowid = it->second.s_rowid;
-                tout.setInt32(r, 0, s_nationkey);
-                tout.setInt32(r, 1, s_rowid);
-                r++;
-            }
-        }
-    }
+    const int32_t* s_suppkey = tin1.getColPtr<int32_t>(0);
+    const int32_t* s_nationkey = tin1.getColPtr<int32_t>(1);
+    cpu_ops::HashIndex ht1(nrow1, [&](int i, int64_t& k) {
+        k = s_suppkey[i];
+        return true;
+    });
+    const int32_t* ps_suppkey = tin2.getColPtr<int32_t>(0);
+    const int32_t* ps_availqty = tin2.getColPtr<int32_t>(1);
+    const int32_t* sum_l = tin2.getColPtr<int32_t>(2);
+    const int32_t* sum_h = tin2.getColPtr<int32_t>(3);
+    auto key = [&](int i, int64_t& k) {
+        int64_t sum = ((int64_t)sum_h[i] << 32) + sum_l[i];
+        k = ps_suppkey[i];
+        return ps_availqty[i] > sum;
+    };
+    auto emit = [&](int r, int i, int j) {
+        tout.setInt32(r, 0, s_nationkey[j]);
+        tout.setInt32(r, 1, j); // s_rowid
+    };
+    int r = cpu_ops::hashJoinFirst(ht1, nrow2, key, emit);
     tout.setNumRow(r);
     std::cout << std::dec << r << " q20Join_s_t4" << std::endl;
 }
 void q20Join_t4_s(Table& tin1, Table& tin2, Table& tout) {
     int nrow1 = tin1.getNumRow();
     int nrow2 = tin2.getNumRow();
-    std::unordered_map<int32_t, int32_t> ht1;
-    for (int i = 0; i < nrow1; i++) {
-        int32_t ps_suppkey = tin1.getInt32(i, 0);
-        int32_t ps_availqty = tin1.getInt32(i, 1);
-        int32_t sum_l = tin1.getInt32(i, 2);
-        int64_t sum_h = tin1.getInt32(i, 3);
-        int64_t sum = (sum_h << 32) + sum_l;
-        if (ps_availqty > sum) {
-            ht1.insert(std::make_pair(ps_suppkey, 0));
-        }
-    }
-    int r = 0;
-    for (int i = 0; i < nrow2; i++) {
-        int32_t s_suppkey = tin2.getInt32(i, 0);
-        int32_t s_nationkey = tin2.getInt32(i, 1);
-        int32_t s_rowid = i; // tin1.getInt32(i,1);
-        auto it = ht1.find(s_suppkey);
-        if (it != ht1.end()) {
-            tout.setInt32(r, 0, s_nationkey);
-            tout.setInt32(r, 1, s_rowid);
-            r++;
-        }
-    }
+    const int32_t* ps_suppkey = tin1.getColPtr<int32_t>(0);
+    const int32_t* ps_availqty = tin1.getColPtr<int32_t>(1);
+    const int32_t* sum_l = tin1.getColPtr<int32_t>(2);
+    const int32_t* sum_h = tin1.getColPtr<int32_t>(3);
+    cpu_ops::HashIndex ht1(nrow1, [&](int i, int64_t& k) {
+        int64_t sum = ((int64_t)sum_h[i] << 32) + sum_l[i];
+        k = ps_suppkey[i];
+        return ps_availqty[i] > sum;
+    });
+    const int32_t* s_suppkey = tin2.getColPtr<int32_t>(0);
+    const int32_t* s_nationkey = tin2.getColPtr<int32_t>(1);
+    auto key = [&](int i, int64_t& k) {
+        k = s_suppkey[i];
+        return true;
+    };
+    auto emit = [&](int r, int i) {
+        tout.setInt32(r, 0, s_nationkey[i]);
+        tout.setInt32(r, 1, i); // s_rowid
+    };
+    int r = cpu_ops::hashSemiJoin(ht1, nrow2, key, emit);
     tout.setNumRow(r);
     std::cout << std::dec << r << " q20Join_t4_s" << std::endl;
 }
 // n_filter
 // t6
 void Filter_n(Table& tin, Table& tout) {
-    int r = 0;
     int nrow = tin.getNumRow();
-    for (int i = 0; i < nrow; i++) {
-        int32_t n_nationkey = tin.getInt32(i, 0);
-        std::array<char, TPCH_READ_NATION_LEN + 1> n_name = tin.getcharN<char, TPCH_READ_NATION_LEN + 1>(i, 1);
-        if (std::string(n_name.data()) == "CANADA") {
-            tout.setInt32(r, 0, n_nationkey);
-            r++;
-        }
-    }
+    const int32_t* n_nationkey = tin.getColPtr<int32_t>(0);
+    const char* n_name = tin.getColPtr<char>(1);
+    auto pred = [&](int i) { return !strcmp(n_name + i * (TPCH_READ_NATION_LEN + 1), "CANADA"); };
+    auto emit = [&](int r, int i) { tout.setInt32(r, 0, n_nationkey[i]); };
+    int r = cpu_ops::parallelFilter(nrow, pred, emit);
     tout.setNumRow(r);
     std::cout << std::dec << r << " Filter_n" << std::endl;
 }
@@ -225,24 +196,19 @@ void Filter_n(Table& tin, Table& tout) {
 void q20Join_t5_t6(Table& tin1, Table& tin2, Table& tout) {
     int nrow1 = tin1.getNumRow();
     int nrow2 = tin2.getNumRow();
-    std::unordered_multimap<int32_t, int32_t> ht1;
-    for (int i = 0; i < nrow1; i++) {
-        int32_t s_nationkey = tin1.getInt32(i, 0);
-        int32_t s_rowid = tin1.getInt32(i, 1);
-        ht1.insert(std::make_pair(s_nationkey, s_rowid));
-    }
-    int r = 0;
-    for (int i = 0; i < nrow2; i++) {
-        int32_t n_nationkey = tin2.getInt32(i, 0);
-        auto its = ht1.equal_range(n_nationkey);
-        auto it = its.first;
-        while (it != its.second) {
-            int32_t s_rowid = it->second;
-            tout.setInt32(r, 0, s_rowid);
-            it++;
-            r++;
-        }
-    }
+    const int32_t* s_nationkey = tin1.getColPtr<int32_t>(0);
+    const int32_t* s_rowid = tin1.getColPtr<int32_t>(1);
+    cpu_ops::HashIndex ht1(nrow1, [&](int i, int64_t& k) {
+        k = s_nationkey[i];
+        return true;
+    });
+    const int32_t* n_nationkey = tin2.getColPtr<int32_t>(0);
+    auto key = [&](int i, int64_t& k) {
+        k = n_nationkey[i];
+        return true;
+    };
+    auto emit = [&](int r, int i, int j) { tout.setInt32(r, 0, s_rowid[j]); };
+    int r = cpu_ops::hashJoin(ht1, nrow2, key, emit);
     tout.setNumRow(r);
     std::cout << std::dec << r << " q20Join_t5_t6" << std::endl;
 }
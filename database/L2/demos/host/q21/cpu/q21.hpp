@@ -14,40 +14,37 @@
  * limitations under the License.
  */
 #include <set>
+#include "cpu_ops.hpp"
 // t0
 void NationFilter(Table& tin, Table& tout) {
     int nrow = tin.getNumRow();
-    int r = 0;
-    for (int i = 0; i < nrow; i++) {
-        int32_t n_nationkey = tin.getInt32(i, 0);
-        std::array<char, TPCH_READ_NATION_LEN + 1> n_name = tin.getcharN<char, TPCH_READ_NATION_LEN + 1>(i, 1);
-        if (std::string(n_name.data()) == "SAUDI ARABIA") {
-            tout.setInt32(r, 0, n_nationkey);
-            r++;
-        }
-    }
+    const int32_t* n_nationkey = tin.getColPtr<int32_t>(0);
+    const char* n_name = tin.getColPtr<char>(1);
+    auto pred = [&](int i) { return !strcmp(n_name + i * (TPCH_READ_NATION_LEN + 1), "SAUDI ARABIA"); };
+    auto emit = [&](int r, int i) { tout.setInt32(r, 0, n_nationkey[i]); };
+    int r = cpu_ops::parallelFilter(nrow, pred, emit);
     tout.setNumRow(r);
     std::cout << std::dec << r << " after NationFilter" << std::endl;
 }
 void q21Join_n_s(Table& tin1, Table& tin2, Table& tout) {
     int nrow1 = tin1.getNumRow();
     int nrow2 = tin2.getNumRow();
-    std::unordered_map<int32_t, int32_t> ht1;
-    for (int i = 0; i < nrow1; i++) {
-        int32_t n_nationkey = tin1.getInt32(i, 0);
-        ht1.insert(std::make_pair(n_nationkey, 0));
-    }
-    int r = 0;
-    for (int i = 0; i < nrow2; i++) {
-        int32_t s_suppkey = tin2.getInt32(i, 0);
-        int32_t s_nationkey = tin2.getInt32(i, 1);
-        auto it = ht1.find(s_nationkey);
-        if (it != ht1.end()) {
-            tout.setInt32(r, 0, s_suppkey);
-            tout.setInt32(r, 1, s_nationkey);
-            r++;
-        }
-    }
+    const int32_t* n_nationkey = tin1.getColPtr<int32_t>(0);
+    cpu_ops::HashIndex ht1(nrow1, [&](int i, int64_t& k) {
+        k = n_nationkey[i];
+        return true;
+    });
+    const int32_t* s_suppkey = tin2.getColPtr<int32_t>(0);
+    const int32_t* s_nationkey = tin2.getColPtr<int32_t>(1);
+    auto key = [&](int i, int64_t& k) {
+        k = s_nationkey[i];
+        return true;
+    };
+    auto emit = [&](int r, int i) {
+        tout.setInt32(r, 0, s_suppkey[i]);
+        tout.setInt32(r, 1, s_nationkey[i]);
+    };
+    int r = cpu_ops::hashSemiJoin(ht1, nrow2, key, emit);
     tout.setNumRow(r);
     std::cout << std::dec << r << " after q21Join_n_s" << std::endl;
 }
@@ -55,28 +52,26 @@ void q21Join_n_s(Table& tin1, Table& tin2, Table& tout) {
 void q21Join_t0_l(Table& tin1, Table& tin2, Table& tout) {
     int nrow1 = tin1.getNumRow();
     int nrow2 = tin2.getNumRow();
-    std::unordered_multimap<int32_t, int32_t> ht1;
-    for (int i = 0; i < nrow1; i++) {
-        int32_t s_suppkey = tin1.getInt32(i, 0);
-        int32_t s_nationkey = tin1.getInt32(i, 1);
-        ht1.insert(std::make_pair(s_suppkey, s_nationkey));
-    }
-    int r = 0;
-    for (int i = 0; i < nrow2; i++) {
-        int32_t l_orderkey = tin2.getInt32(i, 0);
-        int32_t l_suppkey = tin2.getInt32(i, 1);
-        int32_t l_receiptdate = tin2.getInt32(i, 2);
-        int32_t l_commitdate = tin2.getInt32(i, 3);
-        if (l_receiptdate > l_commitdate) {
-            auto it = ht1.find(l_suppkey);
-            if (it != ht1.end()) {
-                tout.setInt32(r, 0, l_orderkey);
-                tout.setInt32(r, 1, it->second);
-                tout.setInt32(r, 2, l_suppkey);
-                r++;
-            }
-        }
-    }
+    const int32_t* s_suppkey = tin1.getColPtr<int32_t>(0);
+    const int32_t* s_nationkey = tin1.getColPtr<int32_t>(1);
+    cpu_ops::HashIndex ht1(nrow1, [&](int i, int64_t& k) {
+        k = s_suppkey[i];
+        return true;
+    });
+    const int32_t* l_orderkey = tin2.getColPtr<int32_t>(0);
+    const int32_t* l_suppkey = tin2.getColPtr<int32_t>(1);
+    const int32_t* l_receiptdate = tin2.getColPtr<int32_t>(2);
+    const int32_t* l_commitdate = tin2.getColPtr<int32_t>(3);
+    auto key = [&](int i, int64_t& k) {
+        k = l_suppkey[i];
+        return l_receiptdate[i] > l_commitdate[i];
+    };
+    auto emit = [&](int r, int i, int j) {
+        tout.setInt32(r, 0, l_orderkey[i]);
+        tout.setInt32(r, 1, s_nationkey[j]);
+        tout.setInt32(r, 2, l_suppkey[i]);
+    };
+    int r = cpu_ops::hashJoinFirst(ht1, nrow2, key, emit);
     tout.setNumRow(r);
     std::cout << std::dec << r << " after q21Join_t0_l" << std::endl;
 }
@@ -84,196 +79,114 @@ void q21Join_t0_l(Table& tin1, Table& tin2, Table& tout) {
 void q21Join_o_t1(Table& tin1, Table& tin2, Table& tout) {
     int nrow1 = tin1.getNumRow();
     int nrow2 = tin2.getNumRow();
-    std::unordered_multimap<int32_t, int32_t> ht1;
-    for (int i = 0; i < nrow1; i++) {
-        int32_t o_orderkey = tin1.getInt32(i, 0);
-        int32_t o_orderstatus = tin1.getInt32(i, 1);
-        if (o_orderstatus == 'F') {
-            ht1.insert(std::make_pair(o_orderkey, 0));
-        }
-    }
-    int r = 0;
-    for (int i = 0; i < nrow2; i++) {
-        int32_t l_orderkey = tin2.getInt32(i, 0);
-        int32_t s_nationkey = tin2.getInt32(i, 1);
-        int32_t l_suppkey = tin2.getInt32(i, 2);
-        auto it = ht1.find(l_orderkey);
-        if (it != ht1.end()) {
-            tout.setInt32(r, 0, l_orderkey);
-            tout.setInt32(r, 1, s_nationkey);
-            tout.setInt32(r, 2, l_suppkey);
-            r++;
-        }
-    }
+    const int32_t* o_orderkey = tin1.getColPtr<int32_t>(0);
+    const int32_t* o_orderstatus = tin1.getColPtr<int32_t>(1);
+    cpu_ops::HashIndex ht1(nrow1, [&](int i, int64_t& k) {
+        k = o_orderkey[i];
+        return o_orderstatus[i] == 'F';
+    });
+    const int32_t* l_orderkey = tin2.getColPtr<int32_t>(0);
+    const int32_t* s_nationkey = tin2.getColPtr<int32_t>(1);
+    const int32_t* l_suppkey = tin2.getColPtr<int32_t>(2);
+    auto key = [&](int i, int64_t& k) {
+        k = l_orderkey[i];
+        return true;
+    };
+    auto emit = [&](int r, int i) {
+        tout.setInt32(r, 0, l_orderkey[i]);
+        tout.setInt32(r, 1, s_nationkey[i]);
+        tout.setInt32(r, 2, l_suppkey[i]);
+    };
+    int r = cpu_ops::hashSemiJoin(ht1, nrow2, key, emit);
     tout.setNumRow(r);
     std::cout << std::dec << r << " after q21Join_o_t1" << std::endl;
 }
-struct Q21AntiKey {
-    int32_t l_orderkey;
-    int32_t l_suppkey;
-    // std::array
-
-    bool operator==(const Q21AntiKey& other) const {
-        return (l_orderkey == other.l_orderkey) && (l_suppkey != other.l_suppkey);
-    }
-};
-namespace std {
-
-template <>
-struct hash<Q21AntiKey> {
-    std::size_t operator()(const Q21AntiKey& k) const {
-        using std::size_t;
-        using std::hash;
-        return (hash<int>()(k.l_orderkey));
-    }
-};
-}
-// t3
-void q21SemiJoin_l_t2(Table& tin1, Table& tin2, Table& tout) {
+// rows of tin2 whose order has a line from another supplier in tin1 (rows where sel(i)), anti keeps the rest
+template <class Sel>
+int q21OtherSupp(Table& tin1, Table& tin2, Table& tout, Sel sel, bool anti) {
     int nrow1 = tin1.getNumRow();
     int nrow2 = tin2.getNumRow();
-    std::unordered_multimap<Q21AntiKey, int32_t> ht1;
-    for (int i = 0; i < nrow1; i++) {
-        int32_t l_orderkey = tin1.getInt32(i, 0);
-        int32_t l_suppkey = tin1.getInt32(i, 1);
-        ht1.insert(std::make_pair(Q21AntiKey{l_orderkey, l_suppkey}, 0));
-    }
-    int r = 0;
-    for (int i = 0; i < nrow2; i++) {
-        int32_t l_orderkey = tin2.getInt32(i, 0);
-        int32_t s_nationkey = tin2.getInt32(i, 1);
-        int32_t s_suppkey = tin2.getInt32(i, 2);
-        Q21AntiKey k = {l_orderkey, s_suppkey};
-        auto it = ht1.find(k);
-        if (it != ht1.end()) {
-            //            if(r<10) std::cout<<l_orderkey<<" "<<it->first.l_orderkey<<std::endl;
-            //            if(r<10) std::cout<<s_suppkey<<" "<<it->first.l_suppkey<<std::endl;
-            tout.setInt32(r, 0, l_orderkey);
-            tout.setInt32(r, 1, s_nationkey);
-            tout.setInt32(r, 2, s_suppkey);
-            r++;
+    const int32_t* b_orderkey = tin1.getColPtr<int32_t>(0);
+    const int32_t* b_suppkey = tin1.getColPtr<int32_t>(1);
+    cpu_ops::HashIndex ht1(nrow1, [&](int i, int64_t& k) {
+        k = b_orderkey[i];
+        return sel(i);
+    });
+    const int32_t* l_orderkey = tin2.getColPtr<int32_t>(0);
+    const int32_t* s_nationkey = tin2.getColPtr<int32_t>(1);
+    const int32_t* s_suppkey = tin2.getColPtr<int32_t>(2);
+    auto pred = [&](int i) {
+        bool found = false;
+        ht1.forEach(l_orderkey[i], [&](int32_t j) { found |= b_suppkey[j] != s_suppkey[i]; });
+        return found != anti;
+    };
+    auto emit = [&](int r, int i) {
+        if (anti) {
+            tout.setInt32(r, 0, s_suppkey[i]);
+            tout.setInt32(r, 1, s_nationkey[i]);
+        } else {
+            tout.setInt32(r, 0, l_orderkey[i]);
+            tout.setInt32(r, 1, s_nationkey[i]);
+            tout.setInt32(r, 2, s_suppkey[i]);
         }
-    }
+    };
+    int r = cpu_ops::parallelFilter(nrow2, pred, emit);
     tout.setNumRow(r);
+    return r;
+}
+// t3
+void q21SemiJoin_l_t2(Table& tin1, Table& tin2, Table& tout) {
+    int r = q21OtherSupp(tin1, tin2, tout, [](int i) { return true; }, false);
     std::cout << std::dec << r << " after q21SemiJoin_l_t2" << std::endl;
 }
 // t4
 void q21SemiJoin_l_t3(Table& tin1, Table& tin2, Table& tout) {
-    int nrow1 = tin1.getNumRow();
-    int nrow2 = tin2.getNumRow();
-    std::unordered_multimap<Q21AntiKey, int32_t> ht1;
-    for (int i = 0; i < nrow1; i++) {
-        int32_t l_orderkey = tin1.getInt32(i, 0);
-        int32_t l_suppkey = tin1.getInt32(i, 1);
-        int32_t l_receiptdate = tin1.getInt32(i, 2);
-        int32_t l_commitdate = tin1.getInt32(i, 3);
-        if (l_receiptdate > l_commitdate) {
-            ht1.insert(std::make_pair(Q21AntiKey{l_orderkey, l_suppkey}, 0));
-        }
-    }
-    int r = 0;
-    for (int i = 0; i < nrow2; i++) {
-        int32_t l_orderkey = tin2.getInt32(i, 0);
-        int32_t s_nationkey = tin2.getInt32(i, 1);
-        int32_t s_suppkey = tin2.getInt32(i, 2);
-        Q21AntiKey k = {l_orderkey, s_suppkey};
-        auto it = ht1.find(k);
-        if (it != ht1.end()) {
-            tout.setInt32(r, 0, l_orderkey);
-            tout.setInt32(r, 1, s_nationkey);
-            tout.setInt32(r, 2, s_suppkey);
-            r++;
-        }
-    }
-    tout.setNumRow(r);
+    const int32_t* l_receiptdate = tin1.getColPtr<int32_t>(2);
+    const int32_t* l_commitdate = tin1.getColPtr<int32_t>(3);
+    int r = q21OtherSupp(tin1, tin2, tout, [&](int i) { return l_receiptdate[i] > l_commitdate[i]; }, false);
     std::cout << std::dec << r << " after q21SemiJoin_l_t3" << std::endl;
 }
-struct KeyA {
-    int32_t l_orderkey;
-    int32_t l_suppkey;
-    bool operator==(const KeyA& other) const {
-        return (l_orderkey == other.l_orderkey) && (l_suppkey == other.l_suppkey);
-    }
-};
-namespace std {
-
-template <>
-struct hash<KeyA> {
-    std::size_t operator()(const KeyA& k) const {
-        using std::size_t;
-        using std::hash;
-        return (hash<int>()(k.l_orderkey)) + (hash<int>()(k.l_suppkey));
-    }
-};
-}
 void q21AntiJoin_t4_t3(Table& tin1, Table& tin2, Table& tout) {
     int nrow1 = tin1.getNumRow();
     int nrow2 = tin2.getNumRow();
-    std::unordered_multimap<KeyA, int32_t> ht1;
-    for (int i = 0; i < nrow1; i++) {
-        int32_t l_orderkey = tin1.getInt32(i, 0);
-        int32_t l_suppkey = tin1.getInt32(i, 2);
-        ht1.insert(std::make_pair(KeyA{l_orderkey, l_suppkey}, 0));
-    }
-    int r = 0;
-    for (int i = 0; i < nrow2; i++) {
-        int32_t l_orderkey = tin2.getInt32(i, 0);
-        int32_t s_nationkey = tin2.getInt32(i, 1);
-        int32_t s_suppkey = tin2.getInt32(i, 2);
-        KeyA k = {l_orderkey, s_suppkey};
-        auto it = ht1.find(k);
-        if (it == ht1.end()) {
-            tout.setInt32(r, 0, s_suppkey);
-            tout.setInt32(r, 1, s_nationkey);
-            r++;
-        }
-    }
+    const int32_t* b_orderkey = tin1.getColPtr<int32_t>(0);
+    const int32_t* b_suppkey = tin1.getColPtr<int32_t>(2);
+    cpu_ops::HashIndex ht1(nrow1, [&](int i, int64_t& k) {
+        k = cpu_ops::packKey(b_orderkey[i], b_suppkey[i]);
+        return true;
+    });
+    const int32_t* l_orderkey = tin2.getColPtr<int32_t>(0);
+    const int32_t* s_nationkey = tin2.getColPtr<int32_t>(1);
+    const int32_t* s_suppkey = tin2.getColPtr<int32_t>(2);
+    auto key = [&](int i, int64_t& k) {
+        k = cpu_ops::packKey(l_orderkey[i], s_suppkey[i]);
+        return true;
+    };
+    auto emit = [&](int r, int i) {
+        tout.setInt32(r, 0, s_suppkey[i]);
+        tout.setInt32(r, 1, s_nationkey[i]);
+    };
+    int r = cpu_ops::hashSemiJoin(ht1, nrow2, key, emit, true);
     tout.setNumRow(r);
     std::cout << std::dec << r << " after q21AntiJoin_t4_t3" << std::endl;
 }
 // cancle in this file
 void q21AntiJoin_l_t3(Table& tin1, Table& tin2, Table& tout) {
-    int nrow1 = tin1.getNumRow();
-    int nrow2 = tin2.getNumRow();
-    std::unordered_multimap<Q21AntiKey, int32_t> ht1;
-    for (int i = 0; i < nrow1; i++) {
-        int32_t l_orderkey = tin1.getInt32(i, 0);
-        int32_t l_suppkey = tin1.getInt32(i, 1);
-        int32_t l_receiptdate = tin1.getInt32(i, 2);
-        int32_t l_commitdate = tin1.getInt32(i, 3);
-        if (l_receiptdate > l_commitdate) {
-            ht1.insert(std::make_pair(Q21AntiKey{l_orderkey, l_suppkey}, 0));
-        }
-    }
-    int r = 0;
-    for (int i = 0; i < nrow2; i++) {
-        int32_t l_orderkey = tin2.getInt32(i, 0);
-        int32_t s_nationkey = tin2.getInt32(i, 1);
-        int32_t s_suppkey = tin2.getInt32(i, 2);
-        Q21AntiKey k = {l_orderkey, s_suppkey};
-        auto it = ht1.find(k);
-        if (it == ht1.end()) {
-            tout.setInt32(r, 0, s_suppkey);
-            tout.setInt32(r, 1, s_nationkey);
-            r++;
-        }
-    }
-    tout.setNumRow(r);
+    const int32_t* l_receiptdate = tin1.getColPtr<int32_t>(2);
+    const int32_t* l_commitdate = tin1.getColPtr<int32_t>(3);
+    int r = q21OtherSupp(tin1, tin2, tout, [&](int i) { return l_receiptdate[i] > l_commitdate[i]; }, true);
     std::cout << std::dec << r << " after q21AntiJoin_l_t3" << std::endl;
 }
 void q21Group_t4(Table& tin, Table& tout) {
     int nrow = tin.getNumRow();
-    std::unordered_map<int32_t, int32_t> ht1;
-    for (int i = 0; i < nrow; i++) {
-        int32_t s_suppkey = tin.getInt32(i, 0);
-        auto it = ht1.find(s_suppkey);
-        if (it != ht1.end()) {
-            int32_t t = it->second + 1;
-            ht1[s_suppkey] = t;
-        } else {
-            ht1.insert(std::make_pair(s_suppkey, 1));
-        }
-    }
+    const int32_t* s_suppkey = tin.getColPtr<int32_t>(0);
+    auto row = [&](int i, int32_t& k, int32_t& v) {
+        k = s_suppkey[i];
+        v = 1;
+        return true;
+    };
+    auto merge = [](int32_t& a, const int32_t& b) { a += b; };
+    auto ht1 = cpu_ops::parallelGroupBy<int32_t, int32_t>(nrow, row, merge);
     int r = 0;
     for (auto& it : ht1) {
         tout.setInt32(r, 0, it.first);
@@ -13,6 +13,7 @@
  * See the License for the specific language governing permissions and
  * limitations under the License.
  */
+#include "cpu_ops.hpp"
 // only for host
 bool c_phone_int_in(int32_t c_phone_int) {
     if (c_phone_int == (('1' << 8) + ('3')) || c_phone_int == (('3' << 8) + ('1')) ||
@@ -26,19 +27,18 @@ bool c_phone_int_in(int32_t c_phone_int) {
 // customer->t1
 void Substring(Table& tin, Table& tout) {
     int nrow = tin.getNumRow();
-    for (int i = 0; i < nrow; i++) {
-        int32_t c_custkey = tin.getInt32(i, 0);
-        std::array<char, TPCH_READ_PHONE_LEN + 1> c_phone = tin.getcharN<char, TPCH_READ_PHONE_LEN + 1>(i, 1);
-        int32_t c_acctbal = tin.getInt32(i, 2);
-        int c_phone_int = 0;
-        for (int j = 1; j >= 0; j--) {
-            int subint = c_phone.at(1 - j) << (8 * j);
-            c_phone_int += subint;
+    const int32_t* c_custkey = tin.getColPtr<int32_t>(0);
+    const char* c_phone = tin.getColPtr<char>(1);
+    const int32_t* c_acctbal = tin.getColPtr<int32_t>(2);
+    cpu_ops::parallelFor(nrow, [&](int begin, int end) {
+        for (int i = begin; i < end; i++) {
+            const char* phone = c_phone + i * (TPCH_READ_PHONE_LEN + 1);
+            int c_phone_int = (phone[0] << 8) + phone[1];
+            tout.setInt32(i, 0, c_custkey[i]);
+            tout.setInt32(i, 1, c_phone_int);
+            tout.setInt32(i, 2, c_acctbal[i]);
         }
-        tout.setInt32(i, 0, c_custkey);
-        tout.setInt32(i, 1, c_phone_int);
-        tout.setInt32(i, 2, c_acctbal);
-    }
+    });
     tout.setNumRow(nrow);
     std::cout << std::dec << nrow << " after Substring of Customer" << std::endl;
 }
@@ -49,21 +49,28 @@ bool iswrong(int32_t c) {
     }
     return true;
 }
+struct Q22Sum {
+    int64_t sum;
+    int r;
+    Q22Sum& operator+=(const Q22Sum& o) {
+        sum += o.sum;
+        r += o.r;
+        return *this;
+    }
+};
 int32_t Group_AVG(Table& tin, Table& tout) {
     int nrow = tin.getNumRow();
-    int64_t sum = 0;
-    int r = 0;
-    for (int i = 0; i < nrow; i++) {
-        int32_t c_phone_int = tin.getInt32(i, 1);
-        int32_t c_acctbal = tin.getInt32(i, 2);
-        // if(c==1741||c==34434||c==36078||c==146548){
-        //    std::cout<<c_acctbal<<std::endl;
-        // }
-        if (c_acctbal > 0 && c_phone_int_in(c_phone_int)) { //&&iswrong(c)){
-            sum += c_acctbal;
-            r++;
-        }
-    }
+    const int32_t* c_phone_int = tin.getColPtr<int32_t>(1);
+    const int32_t* c_acctbal = tin.getColPtr<int32_t>(2);
+    // if(c==1741||c==34434||c==36078||c==146548){
+    //    std::cout<<c_acctbal<<std::endl;
+    // }
+    Q22Sum s = cpu_ops::parallelSum<Q22Sum>(nrow, [&](int i) {
+        bool hit = c_acctbal[i] > 0 && c_phone_int_in(c_phone_int[i]); //&&iswrong(c)){
+        return hit ? Q22Sum{c_acctbal[i], 1} : Q22Sum{0, 0};
+    });
+    int64_t sum = s.sum;
+    int r = s.r;
     std::cout << std::dec << "count:" << r << " avg is: " << 100 * sum / r << std::endl;
     return sum / r;
 }
@@ -71,18 +78,16 @@ int32_t Group_AVG(Table& tin, Table& tout) {
 // t1->t2
 void customerFilter_c_acctbal(Table& tin, Table& tout, int32_t avg_acct) {
     int nrow = tin.getNumRow();
-    int r = 0;
-    for (int i = 0; i < nrow; i++) {
-        int32_t c_custkey = tin.getInt32(i, 0);
-        int32_t c_phone_int = tin.getInt32(i, 1);
-        int32_t c_acctbal = tin.getInt32(i, 2);
-        if (c_acctbal > avg_acct) {
-            tout.setInt32(r, 0, c_custkey);
-            tout.setInt32(r, 1, c_phone_int);
-            tout.setInt32(r, 2, c_acctbal);
-            r++;
-        }
-    }
+    const int32_t* c_custkey = tin.getColPtr<int32_t>(0);
+    const int32_t* c_phone_int = tin.getColPtr<int32_t>(1);
+    const int32_t* c_acctbal = tin.getColPtr<int32_t>(2);
+    auto pred = [&](int i) { return c_acctbal[i] > avg_acct; };
+    auto emit = [&](int r, int i) {
+        tout.setInt32(r, 0, c_custkey[i]);
+        tout.setInt32(r, 1, c_phone_int[i]);
+        tout.setInt32(r, 2, c_acctbal[i]);
+    };
+    int r = cpu_ops::parallelFilter(nrow, pred, emit);
     tout.setNumRow(r);
     std::cout << std::dec << r << " after customerFilter_c_acctbal" << std::endl;
 }
@@ -90,23 +95,23 @@ void customerFilter_c_acctbal(Table& tin, Table& tout, int32_t avg_acct) {
 void q22AntiJoin_o_t2(Table& tin1, Table& tin2, Table& tout) {
     int nrow1 = tin1.getNumRow();
     int nrow2 = tin2.getNumRow();
-    std::unordered_map<int32_t, int32_t> ht1;
-    for (int i = 0; i < nrow1; i++) {
-        int32_t o_custkey = tin1.getInt32(i, 0);
-        ht1.insert(std::make_pair(o_custkey, 0));
-    }
-    int r = 0;
-    for (int i = 0; i < nrow2; i++) {
-        int32_t c_phone_int = tin2.getInt32(i, 1);
-        int32_t c_custkey = tin2.getInt32(i, 0);
-        int32_t c_acctbal = tin2.getInt32(i, 2);
-        auto it = ht1.find(c_custkey);
-        if (c_phone_int_in(c_phone_int) && it == ht1.end()) {
-            tout.setInt32(r, 0, c_phone_int);
-            tout.setInt32(r, 1, c_acctbal);
-            r++;
-        }
-    }
+    const int32_t* o_custkey = tin1.getColPtr<int32_t>(0);
+    cpu_ops::HashIndex ht1(nrow1, [&](int i, int64_t& k) {
+        k = o_custkey[i];
+        return true;
+    });
+    const int32_t* c_custkey = tin2.getColPtr<int32_t>(0);
+    const int32_t* c_phone_int = tin2.getColPtr<int32_t>(1);
+    const int32_t* c_acctbal = tin2.getColPtr<int32_t>(2);
+    auto key = [&](int i, int64_t& k) {
+        k = c_custkey[i];
+        return c_phone_int_in(c_phone_int[i]);
+    };
+    auto emit = [&](int r, int i) {
+        tout.setInt32(r, 0, c_phone_int[i]);
+        tout.setInt32(r, 1, c_acctbal[i]);
+    };
+    int r = cpu_ops::hashSemiJoin(ht1, nrow2, key, emit, true);
     tout.setNumRow(r);
     std::cout << std::dec << r << " after q22AntiJoin_t1_t2" << std::endl;
 }
@@ -115,21 +120,19 @@ void q22GroupBy(Table& tin, Table& tout) {
         int32_t numcust;
         int64_t sumacct;
     };
-    std::unordered_map<int32_t, q22Groupload> m;
     unsigned nrow = tin.getNumRow();
-    for (size_t i = 0; i < nrow; ++i) {
-        int32_t c_phone_int = tin.getInt32(i, 0);
-        int32_t c_acctbal = tin.getInt32(i, 1);
-        auto it = m.find(c_phone_int);
-        if (it != m.end()) {
-            int32_t s0 = it->second.numcust + 1;
-            int64_t s1 = it->second.sumacct + c_acctbal;
-            m[c_phone_int].numcust = s0; // update
-            m[c_phone_int].sumacct = s1; // update
-        } else {
-            m.insert(std::make_pair(c_phone_int, q22Groupload{1, c_acctbal}));
-        }
-    }
+    const int32_t* c_phone_int = tin.getColPtr<int32_t>(0);
+    const int32_t* c_acctbal = tin.getColPtr<int32_t>(1);
+    auto row = [&](int i, int32_t& k, q22Groupload& v) {
+        k = c_phone_int[i];
+        v = q22Groupload{1, c_acctbal[i]};
+        return true;
+    };
+    auto merge = [](q22Groupload& a, const q22Groupload& b) {
+        a.numcust += b.numcust;
+        a.sumacct += b.sumacct;
+    };
+    auto m = cpu_ops::parallelGroupBy<int32_t, q22Groupload>(nrow, row, merge);
     int r = 0;
     for (auto& it : m) {
         tout.setInt32(r, 0, it.first);
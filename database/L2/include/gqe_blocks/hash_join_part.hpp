@@ -179,6 +179,7 @@ void hash_join_plus_adapter(bool jn_on,
 
 template <int COL_IN_NM, int CH_NM, int COL_OUT_NM, int ROUND_NM>
 void hash_join_wrapper(hls::stream<ap_uint<3> >& join_flag_strm,
+                       hls::stream<ap_uint<2> >& join_stage_strm,
                        hls::stream<bool>& jn_on_strm,
                        hls::stream<bool>& mk_on_strm,
                        hls::stream<ap_uint<8 * TPCH_INT_SZ> > in_strm[CH_NM][COL_IN_NM],
@@ -209,8 +210,9 @@ void hash_join_wrapper(hls::stream<ap_uint<3> >& join_flag_strm,
 #pragma HLS stream variable = pu_end_status_strm depth = 2
 
     if (jn_on) {
+        ap_uint<2> join_stage = join_stage_strm.read();
         pu_begin_status_strm.write(31);
-        pu_begin_status_strm.write(0);
+        pu_begin_status_strm.write(join_stage);
         hash_join_plus_adapter<COL_IN_NM, CH_NM, COL_OUT_NM, ROUND_NM>(
             jn_on, mk_on, join_flag_strm, in_strm, e_in_strm, out_strm, e_out_strm, pu_begin_status_strm,
             pu_end_status_strm, htb_buf0, htb_buf1, htb_buf2, htb_buf3, htb_buf4, htb_buf5, htb_buf6, htb_buf7,
@@ -51,6 +51,7 @@ void load_config(ap_uint<8 * TPCH_INT_SZ * VEC_LEN> ptr[9],
                  hls::stream<bool>& join_dual_key_on_strm,
                  hls::stream<bool>& agg_on_strm,
                  hls::stream<ap_uint<3> >& join_flag_strm,
+                 hls::stream<ap_uint<2> >& join_stage_strm,
                  hls::stream<int8_t>& col_id_A_strm,
                  hls::stream<int8_t>& col_id_B_strm,
                  hls::stream<ap_uint<32> >& write_out_cfg_strm,
@@ -70,6 +71,7 @@ void load_config(ap_uint<8 * TPCH_INT_SZ * VEC_LEN> ptr[9],
     bool join_dual_key_on;
     bool agg_on;
     ap_uint<3> join_flag;
+    ap_uint<2> join_stage;
     int8_t col_id_A[8];
     int8_t col_id_B[8];
     ap_uint<32> write_out_cfg;
@@ -103,6 +105,7 @@ void load_config(ap_uint<8 * TPCH_INT_SZ * VEC_LEN> ptr[9],
     }
 
     join_flag = config[0].range(5, 3);
+    join_stage = config[0].range(8, 7);
 
     for (int i = 0; i < 8; i++) {
         col_id_A[i] = config[0].range(56 + 8 * i + 7, 56 + 8 * i);
@@ -186,6 +189,7 @@ void load_config(ap_uint<8 * TPCH_INT_SZ * VEC_LEN> ptr[9],
         }
 
         join_flag_strm.write(join_flag);
+        join_stage_strm.write(join_stage);
 
     } else {
         shuffle1_cfg_strm[0].write(shuffle_cfg1a);
@@ -207,6 +211,8 @@ void load_config(ap_uint<8 * TPCH_INT_SZ * VEC_LEN> ptr[9],
 template <int CHNM, int ColNM>
 void load_config(ap_uint<8 * TPCH_INT_SZ>* ptr,
                  hls::stream<int8_t>& col_id_strm,
+                 hls::stream<bool>& zone_map_on_strm,
+                 hls::stream<ap_int<64> >& scan_cfg_strm,
                  hls::stream<ap_uint<32> >& alu1_cfg_strm,
                  hls::stream<ap_uint<32> >& alu2_cfg_strm,
                  hls::stream<ap_uint<32> >& filter_cfg_strm,
@@ -306,13 +312,34 @@ void load_config(ap_uint<8 * TPCH_INT_SZ>* ptr,
     // write out
     write_out_cfg = config[82];
 
+    // zone-map scan
+    bool zone_map_on = config[83][0] == 1;
+
 #ifndef __SYNTHESIS__
     std::cout << std::hex << "write out config" << write_out_cfg << std::endl;
 #endif
 
     // output
-    for (int i = 0; i < 8; i++) {
-        col_id_strm.write(col_id[i]);
+    zone_map_on_strm.write(zone_map_on);
+    if (zone_map_on) {
+        // scan_table config: column ids, no string column, then the range predicates
+        ap_int<64> ccol_id = -1;
+        for (int i = 0; i < 8; i++) {
+            if (col_id[i] >= 0) ccol_id.range(8 * i + 7, 8 * i) = col_id[i];
+        }
+        scan_cfg_strm.write(ccol_id);
+        scan_cfg_strm.write(-1);
+        scan_cfg_strm.write(config[84]);
+        for (int i = 0; i < 4; i++) {
+            ap_int<64> r;
+            r.range(31, 0) = config[85 + 2 * i];
+            r.range(63, 32) = config[86 + 2 * i];
+            scan_cfg_strm.write(r);
+        }
+    } else {
+        for (int i = 0; i < 8; i++) {
+            col_id_strm.write(col_id[i]);
+        }
     }
 
     for (int i = 0; i < 4; i++) {
@@ -33,6 +33,8 @@
 #include <ap_int.h>
 #include <hls_stream.h>
 
+#include "gqe_blocks/gqe_types.hpp"
+#include "gqe_blocks/scan_to_channel.hpp"
 #include "xf_database/scan_cmp_str_col.hpp"
 #include "xf_database/types.hpp"
 #include "xf_database/utils.hpp"
@@ -41,10 +43,53 @@ namespace xf {
 namespace database {
 namespace gqe {
 
+/**
+ * @brief checks one zone against the range predicates of the zone-map mode
+ *
+ * The zone map of a column keeps the min and max of each burst of 32-bit rows,
+ * 8 zones in one 512-bit word, zone k in bits 64k+63 to 64k (min in the low half).
+ * The word of each predicate column is reloaded every 8 zones.
+ *
+ * @param buf_in pointer of DDR memory
+ * @param zm_off offset of the zone map of each predicate column, 0 for unused
+ * @param zm_lo lower bound of each predicate, inclusive
+ * @param zm_hi upper bound of each predicate, inclusive
+ * @param z index of the zone
+ * @param zm_w cached zone-map word of each predicate column
+ */
+inline bool _zone_may_match(ap_uint<512>* buf_in,
+                            const int zm_off[4],
+                            const ap_int<32> zm_lo[4],
+                            const ap_int<32> zm_hi[4],
+                            int z,
+                            ap_uint<512> zm_w[4]) {
+#pragma HLS INLINE
+    bool keep = true;
+    const int s = z % 8;
+    for (int k = 0; k < 4; k++) {
+        if (zm_off[k] > 0) {
+            if (s == 0) zm_w[k] = buf_in[zm_off[k] + z / 8];
+            ap_int<32> zmin = zm_w[k].range(64 * s + 31, 64 * s);
+            ap_int<32> zmax = zm_w[k].range(64 * s + 63, 64 * s + 32);
+            if (zmax < zm_lo[k] || zmin > zm_hi[k]) keep = false;
+        }
+    }
+    return keep;
+}
+
 /**
  * @brief burst read ddr and transform col data into stream
  *
+ * In zone-map mode, the config stream carries 5 more words after the string
+ * constants: up to 4 predicate column ids in bits 31:0 of the first word (8 bits
+ * each, -1 for unused), then one word per predicate with the inclusive lower bound
+ * in bits 31:0 and upper bound in bits 63:32. The zone map of a column is given by
+ * bits 127:96 of its header, and bursts whose zones cannot satisfy all predicates
+ * are not read. Pruning is turned off when a string column is scanned. Without string
+ * columns, only the words holding the rows are read, so that columns can be padded.
+ *
  * @tparam _NCol number of column in total
+ * @tparam _ZoneMap enable the zone-map mode
  *
  * @param buf_in pointer of DDR memory
  * @param config configuration context
@@ -55,7 +100,7 @@ namespace gqe {
  * @param nrow_strm_spliter number of row in one column
  * @param nrow_strm_filter number of row in one column
  */
-template <int _NCol>
+template <int _NCol, bool _ZoneMap>
 void _read_to_colvec(ap_uint<512>* buf_in,
                      hls::stream<ap_int<64> >& config,
 
@@ -77,7 +122,6 @@ void _read_to_colvec(ap_uint<512>* buf_in,
 
     // number of row in each column
     int nrow = bw.range(31, 0);
-    nrow_strm_spliter.write(nrow); // tells spliter
 
     /***********************Config parser********************************/
     ap_int<64> ccol_id = config.read();
@@ -154,15 +198,33 @@ config_parser_main_loop:
         e_cnst_strm[i] << true;
     }
 
+    // range predicates of the zone-map mode
+    ap_uint<32> zm_cid = -1;
+    ap_int<32> zm_lo[4], zm_hi[4];
+#pragma HLS ARRAY_PARTITION variable = zm_lo complete dim = 1
+#pragma HLS ARRAY_PARTITION variable = zm_hi complete dim = 1
+    if (_ZoneMap) {
+        ap_int<64> t = config.read();
+        zm_cid = t.range(31, 0);
+        for (int k = 0; k < 4; k++) {
+#pragma HLS PIPELINE II = 1
+            ap_int<64> r = config.read();
+            zm_lo[k] = r.range(31, 0);
+            zm_hi[k] = r.range(63, 32);
+        }
+    }
+
     /***********************Config parser end********************************/
 
     // calculate address and access times
     int c_idx = 0, cc_idx = 0;
-    int col_t[_NCol], nrd_t[_NCol];
+    int col_t[_NCol], nrd_t[_NCol], zm_t[_NCol];
 #pragma HLS ARRAY_PARTITION variable = col_t complete dim = 1
 #pragma HLS ARRAY_PARTITION variable = nrd_t complete dim = 1
+#pragma HLS ARRAY_PARTITION variable = zm_t complete dim = 1
     col_t[0] = 1;
     nrd_t[0] = bw.range(63, 32).to_int();
+    zm_t[0] = bw.range(127, 96).to_int();
     int common_nread = bw.range(63, 32).to_int();
     int str_col_nread = bw.range(63, 32).to_int();
     for (int i = 1; i < _NCol; i++) {
@@ -173,6 +235,7 @@ config_parser_main_loop:
         // incontinuous single read
         ap_uint<512> buf_t = buf_in[c_idx];
         nrd_t[i] = buf_t.range(63, 32);
+        zm_t[i] = buf_t.range(127, 96);
 #ifndef __SYNTHESIS__
         std::cout << "nrd_t[" << i << "]:" << nrd_t[i] << std::endl;
 #endif
@@ -237,6 +300,48 @@ config_parser_main_loop:
         }
     }
 
+    // the zone-map layout pads each column, only the words holding rows are read
+    if (_ZoneMap && !is_str01) {
+        const int nvec = (nrow + 15) / 16;
+        if (common_nread > nvec) common_nread = nvec;
+        for (int c = 0; c < _NCol; c++) {
+#pragma HLS unroll
+            if (nread[c] > nvec) nread[c] = nvec;
+        }
+    }
+
+    // zone-map offset of each predicate column, 0 when the predicate is unused
+    int zm_off[4];
+#pragma HLS ARRAY_PARTITION variable = zm_off complete dim = 1
+    bool zm_on = false;
+    for (int k = 0; k < 4; k++) {
+#pragma HLS unroll
+        ap_int<8> cid_t = zm_cid.range(8 * k + 7, 8 * k);
+        int cid = cid_t.to_int();
+        zm_off[k] = (_ZoneMap && !is_str01 && cid >= 0 && cid < _NCol) ? zm_t[cid] : 0;
+        zm_on |= (zm_off[k] > 0);
+    }
+
+    // count the rows of the zones to read, so that the spliter knows them up front
+    const int zone_rows = burst_len * 16;
+    const int nzone = (nrow + zone_rows - 1) / zone_rows;
+    int nrow_read = nrow;
+    if (zm_on) {
+        ap_uint<512> zm_w[4];
+#pragma HLS ARRAY_PARTITION variable = zm_w complete dim = 1
+        nrow_read = 0;
+        for (int z = 0; z < nzone; z++) {
+#pragma HLS PIPELINE II = 1
+            if (_zone_may_match(buf_in, zm_off, zm_lo, zm_hi, z, zm_w)) {
+                int n = nrow - z * zone_rows;
+                nrow_read += (n > zone_rows) ? zone_rows : n;
+            }
+        }
+#ifndef __SYNTHESIS__
+        std::cout << std::dec << "zone map: " << nrow_read << " of " << nrow << " rows to read" << std::endl;
+#endif
+    }
+    nrow_strm_spliter.write(nrow_read); // tells spliter
 #if !defined __SYNTHESIS__
     std::cout << "nrow:" << nrow << std::endl;
     for (int i = 0; i < _NCol; i++) {
@@ -251,7 +356,14 @@ config_parser_main_loop:
     int str_row_cnt0 = 0, str_row_cnt1 = 0;
     int base_addr = 0, len_wrapper = 0;
     // bool pact_end[2] = {true, true};
+    ap_uint<512> zm_w[4];
+#pragma HLS ARRAY_PARTITION variable = zm_w complete dim = 1
     for (int i = 0; i < common_nread; i += burst_len) {
+        // skip the burst of every column when its zone cannot match
+        if (zm_on) {
+            const int z = i / burst_len;
+            if (z >= nzone || !_zone_may_match(buf_in, zm_off, zm_lo, zm_hi, z, zm_w)) continue;
+        }
         // do a burst read for each col
         for (int c = 0; c < _NCol; c++) {
             bool is_str_col0 = is_str0 && (c == 0);
@@ -676,13 +788,14 @@ SPLIT_COL_VEC:
  * @tparam _WData element width in each row
  * @tparam _CH number of channel
  * @tparam _NCol number of column
+ * @tparam _ZoneMap skip the bursts pruned by the zone maps, only for 32-bit data
  *
  * @param config configuration input stream
  * @param buf_in pointer of DDR memory
  * @param out_strms output multi-channel for each column
  * @param e_out_strms end flag stream for out_strms
  */
-template <int _WData, int _CH, int _NCol>
+template <int _WData, int _CH, int _NCol, bool _ZoneMap = false>
 void scan_table(hls::stream<ap_int<64> >& config,
                 ap_uint<512>* buf_in,
 
@@ -692,6 +805,7 @@ void scan_table(hls::stream<ap_int<64> >& config,
                 hls::stream<bool> e_filter_out_strms[2]) {
 #pragma HLS INLINE off
 #pragma HLS DATAFLOW
+    XF_DATABASE_STATIC_ASSERT(!_ZoneMap || _WData == 32, "zone map of scan_table only supports 32-bit data");
     enum { col_fifo_depth = BURST_LEN, str_fifo_depth = BURST_LEN * 512 / _WData };
 
     // _read_to_colvec related
@@ -731,9 +845,10 @@ void scan_table(hls::stream<ap_int<64> >& config,
 #pragma HLS stream variable = read_num_str_col_strm depth = 2
 #pragma HLS RESOURCE variable = read_num_str_col_strm core = FIFO_LUTRAM
 
-    _read_to_colvec<_NCol>(buf_in, config, read_out_strm, read_cnst_strm, read_mask_cnst_strm, read_inv_ctr_strm,
-                           read_e_cnst_strm, read_pact_strm, read_e_pact_strm, read_num_cnst_str, read_nrow_strm_filter,
-                           read_nrow_strm_spliter, read_num_str_col_strm);
+    _read_to_colvec<_NCol, _ZoneMap>(buf_in, config, read_out_strm, read_cnst_strm, read_mask_cnst_strm,
+                                     read_inv_ctr_strm, read_e_cnst_strm, read_pact_strm, read_e_pact_strm,
+                                     read_num_cnst_str, read_nrow_strm_filter, read_nrow_strm_spliter,
+                                     read_num_str_col_strm);
 
     _proc_filter<_CH>(read_nrow_strm_filter, read_num_cnst_str, read_pact_strm, read_e_pact_strm, read_cnst_strm,
                       read_mask_cnst_strm, read_inv_ctr_strm, read_e_cnst_strm, filter_out_strms, e_filter_out_strms);
@@ -742,6 +857,48 @@ void scan_table(hls::stream<ap_int<64> >& config,
                                                  out_strms, e_out_strms);
 }
 
+/**
+ * @brief scan of gqeAggr, in the zone-map mode of scan_table when the command turns it on
+ *
+ * In the zone-map mode, the scan config comes from load_config in the protocol of
+ * scan_table without string columns, and row-id columns are read as dummy columns.
+ * Otherwise the columns are read by scan_to_channel.
+ *
+ * @tparam COL_NM number of column
+ * @tparam CH_NM number of channel
+ *
+ * @param ptr pointer of DDR memory
+ * @param zone_map_on_strm whether the zone-map mode is on
+ * @param col_id_strm column ids for scan_to_channel
+ * @param scan_cfg_strm config of scan_table
+ * @param out_strms output multi-channel for each column
+ * @param e_out_strms end flag stream for out_strms
+ */
+template <int COL_NM, int CH_NM>
+void scan_zone_map_wrapper(ap_uint<8 * TPCH_INT_SZ * VEC_LEN>* ptr,
+                           hls::stream<bool>& zone_map_on_strm,
+                           hls::stream<int8_t>& col_id_strm,
+                           hls::stream<ap_int<64> >& scan_cfg_strm,
+                           hls::stream<ap_uint<8 * TPCH_INT_SZ> > out_strms[CH_NM][COL_NM],
+                           hls::stream<bool> e_out_strms[CH_NM]) {
+    bool zone_map_on = zone_map_on_strm.read();
+    if (zone_map_on) {
+        hls::stream<ap_uint<CH_NM> > str_strms[2];
+#pragma HLS stream variable = str_strms depth = 2
+        hls::stream<bool> e_str_strms[2];
+#pragma HLS stream variable = e_str_strms depth = 2
+        scan_table<8 * TPCH_INT_SZ, CH_NM, COL_NM, true>(scan_cfg_strm, ptr, out_strms, e_out_strms, str_strms,
+                                                         e_str_strms);
+        // no string column, the string filter only gives its end flags
+        for (int i = 0; i < 2; i++) {
+#pragma HLS PIPELINE II = 1
+            e_str_strms[i].read();
+        }
+    } else {
+        scan_to_channel<COL_NM, CH_NM>(ptr, col_id_strm, out_strms, e_out_strms);
+    }
+}
+
 } // namespace gqe
 } // namespace database
 } // namespace xf
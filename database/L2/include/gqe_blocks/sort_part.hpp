@@ -0,0 +1,395 @@
+/*
+ * Copyright 2019 Xilinx, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef GQE_SORT_PART_HPP
+#define GQE_SORT_PART_HPP
+
+#ifndef __SYNTHESIS__
+#include <stdio.h>
+#include <iostream>
+#endif
+
+#include <ap_int.h>
+#include <hls_stream.h>
+
+#include "xf_database/bitonic_sort.hpp"
+#include "xf_database/merge_sort.hpp"
+
+namespace xf {
+namespace database {
+namespace gqe {
+
+// one row while sorting: the key with its sign bit flipped in 63:32, so that
+// unsigned compare orders signed keys, and the row id in 31:0, which also
+// makes every element unique
+typedef ap_uint<64> sort_elem_t;
+
+// fills a run up to a multiple of the network size, sorts after every row
+inline sort_elem_t sort_pad(bool order) {
+    return order ? sort_elem_t(-1) : sort_elem_t(0);
+}
+
+inline sort_elem_t sort_pack(ap_uint<32> key, ap_uint<32> rid) {
+    sort_elem_t e;
+    key[31] = !key[31];
+    e.range(63, 32) = key;
+    e.range(31, 0) = rid;
+    return e;
+}
+
+inline ap_uint<32> sort_key(sort_elem_t e) {
+    ap_uint<32> key = e.range(63, 32);
+    key[31] = !key[31];
+    return key;
+}
+
+template <int burst_len, int vec_len>
+void read_sort_col(const int col_id,
+                   ap_uint<512>* ptr,
+                   hls::stream<ap_uint<512> >& vec_strm,
+                   hls::stream<int>& nrow_strm) {
+    ap_uint<512> bw = ptr[0];
+    int nrow = bw.range(31, 0);
+    int col_naxi = bw.range(63, 32);
+    nrow_strm.write(nrow);
+
+    // +1 to skip col header to data offset
+    int offset = col_naxi * col_id + 1;
+    int nread = (nrow + vec_len - 1) / vec_len;
+    for (int i = 0; i < nread; i += burst_len) {
+        const int len = ((i + burst_len) > nread) ? (nread - i) : burst_len;
+        for (int j = 0; j < len; ++j) {
+#pragma HLS pipeline II = 1
+            vec_strm.write(ptr[offset + i + j]);
+        }
+    }
+}
+
+// emits npad elements, the rows then the padding
+template <int vec_len, int net_len>
+void split_sort_col(bool order,
+                    hls::stream<ap_uint<512> >& vec_strm,
+                    hls::stream<int>& nrow_strm,
+                    hls::stream<sort_elem_t>& elem_strm,
+                    hls::stream<bool>& e_strm) {
+    int nrow = nrow_strm.read();
+    int npad = (nrow + net_len - 1) / net_len * net_len;
+    ap_uint<512> vec = 0;
+    for (int r = 0; r < npad; ++r) {
+#pragma HLS pipeline II = 1
+        if (r % vec_len == 0 && r < nrow) vec = vec_strm.read();
+        ap_uint<32> key = vec.range(32 * (r % vec_len) + 31, 32 * (r % vec_len));
+        elem_strm.write(r < nrow ? sort_pack(key, r) : sort_pad(order));
+        e_strm.write(false);
+    }
+    e_strm.write(true);
+}
+
+// packs the sorted runs 8 elements per word, the runs fill whole words
+inline void write_runs(hls::stream<sort_elem_t>& elem_strm, hls::stream<bool>& e_strm, ap_uint<512>* ptr) {
+    ap_uint<512> w = 0;
+    int n = 0;
+    bool e = e_strm.read();
+    while (!e) {
+#pragma HLS pipeline II = 1
+        sort_elem_t d = elem_strm.read();
+        e = e_strm.read();
+        w.range(64 * (n % 8) + 63, 64 * (n % 8)) = d;
+        if (n % 8 == 7) ptr[n / 8] = w;
+        n++;
+    }
+}
+
+// the rows of the sorted run go to the key and row id columns of the output
+template <int vec_len>
+void write_sorted(int offset, int nrow, ap_uint<512>* tmp, ap_uint<512>* out) {
+    ap_uint<512> hd = out[0];
+    int col_naxi = hd.range(63, 32);
+    ap_uint<512> w = 0;
+    ap_uint<512> kv = 0;
+    ap_uint<512> rv = 0;
+    for (int n = 0; n < nrow; ++n) {
+#pragma HLS pipeline II = 1
+        if (n % 8 == 0) w = tmp[offset + n / 8];
+        sort_elem_t d = w.range(64 * (n % 8) + 63, 64 * (n % 8));
+        kv.range(32 * (n % vec_len) + 31, 32 * (n % vec_len)) = sort_key(d);
+        rv.range(32 * (n % vec_len) + 31, 32 * (n % vec_len)) = d.range(31, 0);
+        if (n % vec_len == vec_len - 1 || n == nrow - 1) {
+            out[1 + n / vec_len] = kv;
+            out[col_naxi + 1 + n / vec_len] = rv;
+        }
+    }
+    hd.range(31, 0) = nrow;
+    out[0] = hd;
+}
+
+template <int burst_len, int vec_len, int net_len>
+void sort_runs(const int col_id, bool order, ap_uint<512>* buf_in, ap_uint<512>* buf_tmp) {
+#pragma HLS dataflow
+
+    hls::stream<ap_uint<512> > vec_strm;
+#pragma HLS stream variable = vec_strm depth = 64
+    hls::stream<int> nrow_strm;
+#pragma HLS stream variable = nrow_strm depth = 2
+    hls::stream<sort_elem_t> elem_strm;
+#pragma HLS stream variable = elem_strm depth = 32
+    hls::stream<bool> e_strm;
+#pragma HLS stream variable = e_strm depth = 32
+    hls::stream<sort_elem_t> run_strm;
+#pragma HLS stream variable = run_strm depth = 32
+    hls::stream<bool> e_run_strm;
+#pragma HLS stream variable = e_run_strm depth = 32
+
+    read_sort_col<burst_len, vec_len>(col_id, buf_in, vec_strm, nrow_strm);
+    split_sort_col<vec_len, net_len>(order, vec_strm, nrow_strm, elem_strm, e_strm);
+    xf::database::bitonicSort<sort_elem_t, net_len>(elem_strm, e_strm, run_strm, e_run_strm, order);
+    write_runs(run_strm, e_run_strm, buf_tmp);
+}
+
+// keeps the best top_k elements in a shift register, an element not better
+// than the last one kept changes nothing
+template <int topk_max>
+void top_k_insert(bool order,
+                  const int top_k,
+                  hls::stream<sort_elem_t>& elem_strm,
+                  hls::stream<bool>& e_strm,
+                  hls::stream<int>& n_out_strm,
+                  hls::stream<sort_elem_t>& out_strm) {
+    sort_elem_t best[topk_max];
+#pragma HLS array_partition variable = best complete
+    for (int i = 0; i < topk_max; ++i) {
+#pragma HLS unroll
+        best[i] = sort_pad(order);
+    }
+
+    int nrow = 0;
+    bool e = e_strm.read();
+    while (!e) {
+#pragma HLS pipeline II = 1
+        sort_elem_t d = elem_strm.read();
+        e = e_strm.read();
+        nrow++;
+        bool better[topk_max];
+#pragma HLS array_partition variable = better complete
+        for (int i = 0; i < topk_max; ++i) {
+#pragma HLS unroll
+            better[i] = order ? (d < best[i]) : (d > best[i]);
+        }
+        for (int i = topk_max - 1; i >= 0; --i) {
+#pragma HLS unroll
+            if (better[i]) best[i] = (i > 0 && better[i - 1]) ? best[i - 1] : d;
+        }
+    }
+    n_out_strm.write(nrow < top_k ? nrow : top_k);
+    for (int i = 0; i < topk_max; ++i) {
+#pragma HLS pipeline II = 1
+        if (i < top_k) out_strm.write(best[i]);
+    }
+}
+
+template <int vec_len>
+void write_top_k(const int top_k, hls::stream<int>& n_out_strm, hls::stream<sort_elem_t>& elem_strm, ap_uint<512>* out) {
+    int n_out = n_out_strm.read();
+    ap_uint<512> hd = out[0];
+    int col_naxi = hd.range(63, 32);
+    ap_uint<512> kv = 0;
+    ap_uint<512> rv = 0;
+    for (int n = 0; n < top_k; ++n) {
+#pragma HLS pipeline II = 1
+        sort_elem_t d = elem_strm.read();
+        if (n < n_out) {
+            kv.range(32 * (n % vec_len) + 31, 32 * (n % vec_len)) = sort_key(d);
+            rv.range(32 * (n % vec_len) + 31, 32 * (n % vec_len)) = d.range(31, 0);
+            if (n % vec_len == vec_len - 1 || n == n_out - 1) {
+                out[1 + n / vec_len] = kv;
+                out[col_naxi + 1 + n / vec_len] = rv;
+            }
+        }
+    }
+    hd.range(31, 0) = n_out;
+    out[0] = hd;
+}
+
+template <int burst_len, int vec_len, int topk_max>
+void top_k_scan(const int col_id, bool order, const int top_k, ap_uint<512>* buf_in, ap_uint<512>* buf_out) {
+#pragma HLS dataflow
+
+    hls::stream<ap_uint<512> > vec_strm;
+#pragma HLS stream variable = vec_strm depth = 64
+    hls::stream<int> nrow_strm;
+#pragma HLS stream variable = nrow_strm depth = 2
+    hls::stream<sort_elem_t> elem_strm;
+#pragma HLS stream variable = elem_strm depth = 32
+    hls::stream<bool> e_strm;
+#pragma HLS stream variable = e_strm depth = 32
+    hls::stream<int> n_out_strm;
+#pragma HLS stream variable = n_out_strm depth = 2
+    hls::stream<sort_elem_t> top_strm;
+#pragma HLS stream variable = top_strm depth = topk_max
+
+    read_sort_col<burst_len, vec_len>(col_id, buf_in, vec_strm, nrow_strm);
+    split_sort_col<vec_len, 1>(order, vec_strm, nrow_strm, elem_strm, e_strm);
+    top_k_insert<topk_max>(order, top_k, elem_strm, e_strm, n_out_strm, top_strm);
+    write_top_k<vec_len>(top_k, n_out_strm, top_strm, buf_out);
+}
+
+// rows of run r when the runs of a pass are run_len apart, at most keep
+inline int sort_run_rows(int r, int nrun, int run_len, int npad, int keep) {
+    if (r >= nrun) return 0;
+    int n = npad - r * run_len;
+    if (n > run_len) n = run_len;
+    if (n > keep) n = keep;
+    return n;
+}
+
+// streams run way of merge group g, or a single padding element for a missing
+// run as mergeSort needs rows on both sides
+template <int merge_way>
+void read_run(bool order,
+              const int way,
+              int g,
+              int src,
+              int nrun,
+              int run_len,
+              int npad,
+              int keep,
+              ap_uint<512>* ptr,
+              hls::stream<ap_uint<32> >& rid_strm,
+              hls::stream<sort_elem_t>& elem_strm,
+              hls::stream<bool>& e_strm) {
+    int r = g * merge_way + way;
+    int offset = src + r * (run_len / 8);
+    int len = sort_run_rows(r, nrun, run_len, npad, keep);
+    if (len == 0) {
+        rid_strm.write(0);
+        elem_strm.write(sort_pad(order));
+        e_strm.write(false);
+    }
+    ap_uint<512> w = 0;
+    for (int n = 0; n < len; ++n) {
+#pragma HLS pipeline II = 1
+        if (n % 8 == 0) w = ptr[offset + n / 8];
+        sort_elem_t d = w.range(64 * (n % 8) + 63, 64 * (n % 8));
+        rid_strm.write(d.range(31, 0));
+        elem_strm.write(d);
+        e_strm.write(false);
+    }
+    e_strm.write(true);
+}
+
+// writes the merged run of group g, the rows of its runs up to keep
+template <int merge_way>
+void write_merged(int g,
+                  int dst,
+                  int nrun,
+                  int run_len,
+                  int npad,
+                  int keep,
+                  hls::stream<ap_uint<32> >& rid_strm,
+                  hls::stream<sort_elem_t>& elem_strm,
+                  hls::stream<bool>& e_strm,
+                  ap_uint<512>* ptr) {
+    int n_keep = 0;
+    for (int w = 0; w < merge_way; ++w) {
+        n_keep += sort_run_rows(g * merge_way + w, nrun, run_len, npad, keep);
+    }
+    if (n_keep > keep) n_keep = keep;
+    int offset = dst + g * (run_len / 8) * merge_way;
+
+    ap_uint<512> wd = 0;
+    int n = 0;
+    bool e = e_strm.read();
+    while (!e) {
+#pragma HLS pipeline II = 1
+        // the row ids are also in the elements
+        rid_strm.read();
+        sort_elem_t d = elem_strm.read();
+        e = e_strm.read();
+        if (n < n_keep) {
+            wd.range(64 * (n % 8) + 63, 64 * (n % 8)) = d;
+            if (n % 8 == 7 || n == n_keep - 1) ptr[offset + n / 8] = wd;
+        }
+        n++;
+    }
+}
+
+// merges the runs of group g through a tree of mergeSort carrying the row ids
+// as payload; runs of the pass are read from src, merged runs written at dst
+inline void merge_runs(bool order,
+                       int g,
+                       int src,
+                       int dst,
+                       int nrun,
+                       int run_len,
+                       int npad,
+                       int keep,
+                       ap_uint<512>* buf_t0,
+                       ap_uint<512>* buf_t1,
+                       ap_uint<512>* buf_t2,
+                       ap_uint<512>* buf_t3,
+                       ap_uint<512>* buf_t4,
+                       ap_uint<512>* buf_t5,
+                       ap_uint<512>* buf_t6,
+                       ap_uint<512>* buf_t7,
+                       ap_uint<512>* buf_tw) {
+#pragma HLS dataflow
+
+    // 0..7 are the runs, 8..11 and 12..13 the inner nodes, 14 the root
+    hls::stream<ap_uint<32> > rid_strm[15];
+#pragma HLS stream variable = rid_strm depth = 32
+    hls::stream<sort_elem_t> elem_strm[15];
+#pragma HLS stream variable = elem_strm depth = 32
+    hls::stream<bool> e_strm[15];
+#pragma HLS stream variable = e_strm depth = 32
+
+    read_run<8>(order, 0, g, src, nrun, run_len, npad, keep, buf_t0, rid_strm[0], elem_strm[0], e_strm[0]);
+    read_run<8>(order, 1, g, src, nrun, run_len, npad, keep, buf_t1, rid_strm[1], elem_strm[1], e_strm[1]);
+    read_run<8>(order, 2, g, src, nrun, run_len, npad, keep, buf_t2, rid_strm[2], elem_strm[2], e_strm[2]);
+    read_run<8>(order, 3, g, src, nrun, run_len, npad, keep, buf_t3, rid_strm[3], elem_strm[3], e_strm[3]);
+    read_run<8>(order, 4, g, src, nrun, run_len, npad, keep, buf_t4, rid_strm[4], elem_strm[4], e_strm[4]);
+    read_run<8>(order, 5, g, src, nrun, run_len, npad, keep, buf_t5, rid_strm[5], elem_strm[5], e_strm[5]);
+    read_run<8>(order, 6, g, src, nrun, run_len, npad, keep, buf_t6, rid_strm[6], elem_strm[6], e_strm[6]);
+    read_run<8>(order, 7, g, src, nrun, run_len, npad, keep, buf_t7, rid_strm[7], elem_strm[7], e_strm[7]);
+
+    xf::database::mergeSort<ap_uint<32>, sort_elem_t>(rid_strm[0], elem_strm[0], e_strm[0], rid_strm[1],
+                                                      elem_strm[1], e_strm[1], rid_strm[8], elem_strm[8],
+                                                      e_strm[8], order);
+    xf::database::mergeSort<ap_uint<32>, sort_elem_t>(rid_strm[2], elem_strm[2], e_strm[2], rid_strm[3],
+                                                      elem_strm[3], e_strm[3], rid_strm[9], elem_strm[9],
+                                                      e_strm[9], order);
+    xf::database::mergeSort<ap_uint<32>, sort_elem_t>(rid_strm[4], elem_strm[4], e_strm[4], rid_strm[5],
+                                                      elem_strm[5], e_strm[5], rid_strm[10], elem_strm[10],
+                                                      e_strm[10], order);
+    xf::database::mergeSort<ap_uint<32>, sort_elem_t>(rid_strm[6], elem_strm[6], e_strm[6], rid_strm[7],
+                                                      elem_strm[7], e_strm[7], rid_strm[11], elem_strm[11],
+                                                      e_strm[11], order);
+    xf::database::mergeSort<ap_uint<32>, sort_elem_t>(rid_strm[8], elem_strm[8], e_strm[8], rid_strm[9],
+                                                      elem_strm[9], e_strm[9], rid_strm[12], elem_strm[12],
+                                                      e_strm[12], order);
+    xf::database::mergeSort<ap_uint<32>, sort_elem_t>(rid_strm[10], elem_strm[10], e_strm[10], rid_strm[11],
+                                                      elem_strm[11], e_strm[11], rid_strm[13], elem_strm[13],
+                                                      e_strm[13], order);
+    xf::database::mergeSort<ap_uint<32>, sort_elem_t>(rid_strm[12], elem_strm[12], e_strm[12], rid_strm[13],
+                                                      elem_strm[13], e_strm[13], rid_strm[14], elem_strm[14],
+                                                      e_strm[14], order);
+
+    write_merged<8>(g, dst, nrun, run_len, npad, keep, rid_strm[14], elem_strm[14], e_strm[14], buf_tw);
+}
+
+} // namespace gqe
+} // namespace database
+} // namespace xf
+
+#endif // GQE_SORT_PART_HPP
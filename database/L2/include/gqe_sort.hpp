@@ -0,0 +1,92 @@
+/*
+ * Copyright 2019 Xilinx, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef _XF_DB_GQE_SORT_H_
+#define _XF_DB_GQE_SORT_H_
+
+/**
+ * @file gqe_sort.hpp
+ * @brief interface of GQE sort kernel.
+ */
+
+#include <ap_int.h>
+#include <hls_stream.h>
+
+#define TPCH_INT_SZ 4
+#define VEC_LEN 16
+#define BURST_LEN 32
+
+// rows sorted at once by the bitonic network into the first runs
+#define SORT_NET_LEN 16
+// runs merged together by the merge tree in one pass
+#define SORT_MERGE_WAY 8
+// largest K kept in registers by the Top-K mode
+#define SORT_TOPK_MAX 128
+
+#ifndef __SYNTHESIS__
+#include <iostream>
+#endif
+
+/**
+ * @brief GQE sort kernel
+ *
+ * Sorts one 32-bit signed column of table A and writes a table of two columns,
+ * the sorted keys and the row ids of table A they come from, so that other
+ * columns can be gathered by row id.
+ *
+ * The column is cut into runs of SORT_NET_LEN rows sorted by ``bitonicSort``,
+ * then the runs are merged SORT_MERGE_WAY at a time by a tree of ``mergeSort``
+ * until one run is left. Each pass goes through the temporary buffer, which
+ * takes 2 * ceil(nrow / SORT_NET_LEN) * SORT_NET_LEN * 8 bytes and is given
+ * to all of buf_T0 .. buf_T7 and buf_TW.
+ *
+ * When top_k is not 0, only the first top_k rows are written. Up to
+ * SORT_TOPK_MAX they are kept in registers and the column is read only once,
+ * beyond that every merge reads at most top_k rows of each run.
+ *
+ * @param col_id index of the column to sort in table A
+ * @param order 1 for ascending, 0 for descending
+ * @param top_k number of rows to keep, 0 to keep all
+ *
+ * @param buf_A input table buffer
+ * @param buf_B output table buffer, its header gives the size of one column
+ *
+ * @param buf_T0 temporary buffer, read by merge way 0
+ * @param buf_T1 temporary buffer, read by merge way 1
+ * @param buf_T2 temporary buffer, read by merge way 2
+ * @param buf_T3 temporary buffer, read by merge way 3
+ * @param buf_T4 temporary buffer, read by merge way 4
+ * @param buf_T5 temporary buffer, read by merge way 5
+ * @param buf_T6 temporary buffer, read by merge way 6
+ * @param buf_T7 temporary buffer, read by merge way 7
+ * @param buf_TW temporary buffer, written by the runs and merges
+ *
+ */
+extern "C" void gqeSort(const int col_id,
+                        const int order,
+                        const int top_k,
+                        ap_uint<8 * TPCH_INT_SZ * VEC_LEN> buf_A[],
+                        ap_uint<8 * TPCH_INT_SZ * VEC_LEN> buf_B[],
+                        ap_uint<8 * TPCH_INT_SZ * VEC_LEN> buf_T0[],
+                        ap_uint<8 * TPCH_INT_SZ * VEC_LEN> buf_T1[],
+                        ap_uint<8 * TPCH_INT_SZ * VEC_LEN> buf_T2[],
+                        ap_uint<8 * TPCH_INT_SZ * VEC_LEN> buf_T3[],
+                        ap_uint<8 * TPCH_INT_SZ * VEC_LEN> buf_T4[],
+                        ap_uint<8 * TPCH_INT_SZ * VEC_LEN> buf_T5[],
+                        ap_uint<8 * TPCH_INT_SZ * VEC_LEN> buf_T6[],
+                        ap_uint<8 * TPCH_INT_SZ * VEC_LEN> buf_T7[],
+                        ap_uint<8 * TPCH_INT_SZ * VEC_LEN> buf_TW[]);
+
+#endif // _XF_DB_GQE_SORT_H_
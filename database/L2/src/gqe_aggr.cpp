@@ -22,6 +22,7 @@
 #include "gqe_blocks/stream_helper.hpp"
 #include "gqe_blocks/load_config.hpp"
 #include "gqe_blocks/scan_to_channel.hpp"
+#include "gqe_blocks/scan_table.hpp"
 #include "gqe_blocks/eval_part.hpp"
 #include "gqe_blocks/filter_part.hpp"
 #include "gqe_blocks/group_aggregate_part.hpp"
@@ -117,6 +118,14 @@ extern "C" void gqeAggr(                                        //
 #pragma HLS stream variable = cid_strm depth = 8
 #pragma HLS resource variable = cid_strm core = FIFO_SRL
 
+    hls::stream<bool> zone_map_on_strm;
+#pragma HLS stream variable = zone_map_on_strm depth = 2
+#pragma HLS resource variable = zone_map_on_strm core = FIFO_SRL
+
+    hls::stream<ap_int<64> > scan_cfg_strm;
+#pragma HLS stream variable = scan_cfg_strm depth = 8
+#pragma HLS resource variable = scan_cfg_strm core = FIFO_SRL
+
     hls::stream<ap_uint<32> > filter_cfg_strm;
 #pragma HLS stream variable = filter_cfg_strm depth = 64
 #pragma HLS resource variable = filter_cfg_strm core = FIFO_SRL
@@ -181,7 +190,7 @@ extern "C" void gqeAggr(                                        //
     printf("******************************\n");
 #endif
 
-    load_config<n_channel, n_column>(buf_cfg, cid_strm, alu0_cfg_strm, alu1_cfg_strm, filter_cfg_strm,
+    load_config<n_channel, n_column>(buf_cfg, cid_strm, zone_map_on_strm, scan_cfg_strm, alu0_cfg_strm, alu1_cfg_strm, filter_cfg_strm,
                                      shuffle1_cfg_strm, shuffle2_cfg_strm, shuffle3_cfg_strm, shuffle4_cfg_strm,
                                      merge_column_cfg_strm, group_aggr_cfg_strm, direct_aggr_cfg_strm, write_cfg_strm);
 
@@ -191,7 +200,8 @@ extern "C" void gqeAggr(                                        //
     printf("******************************\n");
 #endif
 
-    scan_to_channel<n_column, n_channel>(buf_in, cid_strm, scan_strms, e_scan_strms);
+    scan_zone_map_wrapper<n_column, n_channel>(buf_in, zone_map_on_strm, cid_strm, scan_cfg_strm, scan_strms,
+                                               e_scan_strms);
 
 #ifndef __SYNTHESIS__
     {
@@ -380,6 +380,9 @@ extern "C" void gqeJoin(ap_uint<8 * TPCH_INT_SZ * VEC_LEN> buf_A[TEST_BUF_DEPTH]
     hls::stream<ap_uint<3> > join_flag_strm;
 #pragma HLS stream variable = join_flag_strm depth = 32
 #pragma HLS resource variable = join_flag_strm core = FIFO_LUTRAM
+    hls::stream<ap_uint<2> > join_stage_strm;
+#pragma HLS stream variable = join_stage_strm depth = 32
+#pragma HLS resource variable = join_stage_strm core = FIFO_LUTRAM
 
 #ifndef __SYNTHESIS__
     printf("************************************************************\n");
@@ -387,9 +390,9 @@ extern "C" void gqeJoin(ap_uint<8 * TPCH_INT_SZ * VEC_LEN> buf_A[TEST_BUF_DEPTH]
     printf("************************************************************\n");
 #endif
 
-    load_config<jn_on_nm>(buf_D, join_on_strm, join_dual_key_on_strm, agg_on_strm, join_flag_strm, cid_A_strm,
-                          cid_B_strm, write_cfg_strm, alu1_cfg_strm, alu2_cfg_strm, fcfg, shuffle1_cfg, shuffle2_cfg,
-                          shuffle3_cfg, shuffle4_cfg);
+    load_config<jn_on_nm>(buf_D, join_on_strm, join_dual_key_on_strm, agg_on_strm, join_flag_strm, join_stage_strm,
+                          cid_A_strm, cid_B_strm, write_cfg_strm, alu1_cfg_strm, alu2_cfg_strm, fcfg, shuffle1_cfg,
+                          shuffle2_cfg, shuffle3_cfg, shuffle4_cfg);
     /*
         int size512=buf_B[0].range(63,32);
         int rowNum=buf_B[0].range(31,0);
@@ -523,7 +526,8 @@ extern "C" void gqeJoin(ap_uint<8 * TPCH_INT_SZ * VEC_LEN> buf_A[TEST_BUF_DEPTH]
 #pragma HLS stream variable = e_jn_strm depth = 32 //
 
     hash_join_wrapper<8, nch, 14, scan_num>(
-        join_flag_strm, join_on_strm[3], join_dual_key_on_strm, flt_dm_strms_1, e_flt_dm_strms_1, jn_strm, e_jn_strm, //
+        join_flag_strm, join_stage_strm, join_on_strm[3], join_dual_key_on_strm, flt_dm_strms_1, e_flt_dm_strms_1,
+        jn_strm, e_jn_strm, //
         htb_buf0, htb_buf1, htb_buf2, htb_buf3, htb_buf4, htb_buf5, htb_buf6, htb_buf7, stb_buf0, stb_buf1, stb_buf2,
         stb_buf3, stb_buf4, stb_buf5, stb_buf6, stb_buf7);
 
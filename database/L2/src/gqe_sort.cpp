@@ -0,0 +1,163 @@
+/*
+ * Copyright 2019 Xilinx, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef __SYNTHESIS__
+#include <stdio.h>
+#include <iostream>
+#endif
+
+#include "gqe_sort.hpp"
+#include "gqe_blocks/sort_part.hpp"
+
+/**
+ * @breif GQE sort kernel
+ *
+ * @param col_id index of the column to sort in table A
+ * @param order 1 for ascending, 0 for descending
+ * @param top_k number of rows to keep, 0 to keep all
+ *
+ * @param buf_A input table buffer
+ * @param buf_B output table buffer
+ * @param buf_T0 ~ buf_T7 temporary buffer, read by the merge ways
+ * @param buf_TW temporary buffer, written by the runs and merges
+ *
+ */
+extern "C" void gqeSort(const int col_id,
+                        const int order,
+                        const int top_k,
+                        ap_uint<512> buf_A[],
+                        ap_uint<512> buf_B[],
+                        ap_uint<512> buf_T0[],
+                        ap_uint<512> buf_T1[],
+                        ap_uint<512> buf_T2[],
+                        ap_uint<512> buf_T3[],
+                        ap_uint<512> buf_T4[],
+                        ap_uint<512> buf_T5[],
+                        ap_uint<512> buf_T6[],
+                        ap_uint<512> buf_T7[],
+                        ap_uint<512> buf_TW[]) {
+// clang-format off
+#pragma HLS INTERFACE m_axi offset = slave latency = 64 \
+	num_write_outstanding = 16 num_read_outstanding = 16 \
+	max_write_burst_length = 64 max_read_burst_length = 64 \
+	bundle = gmem0_0 port = buf_A
+
+#pragma HLS INTERFACE m_axi offset = slave latency = 64 \
+	num_write_outstanding = 16 num_read_outstanding = 16 \
+	max_write_burst_length = 64 max_read_burst_length = 64 \
+	bundle = gmem0_1 port = buf_B
+
+#pragma HLS INTERFACE m_axi offset = slave latency = 64 \
+	num_write_outstanding = 16 num_read_outstanding = 16 \
+	max_write_burst_length = 64 max_read_burst_length = 64 \
+	bundle = gmem1_0 port = buf_T0
+
+#pragma HLS INTERFACE m_axi offset = slave latency = 64 \
+	num_write_outstanding = 16 num_read_outstanding = 16 \
+	max_write_burst_length = 64 max_read_burst_length = 64 \
+	bundle = gmem1_1 port = buf_T1
+
+#pragma HLS INTERFACE m_axi offset = slave latency = 64 \
+	num_write_outstanding = 16 num_read_outstanding = 16 \
+	max_write_burst_length = 64 max_read_burst_length = 64 \
+	bundle = gmem1_2 port = buf_T2
+
+#pragma HLS INTERFACE m_axi offset = slave latency = 64 \
+	num_write_outstanding = 16 num_read_outstanding = 16 \
+	max_write_burst_length = 64 max_read_burst_length = 64 \
+	bundle = gmem1_3 port = buf_T3
+
+#pragma HLS INTERFACE m_axi offset = slave latency = 64 \
+	num_write_outstanding = 16 num_read_outstanding = 16 \
+	max_write_burst_length = 64 max_read_burst_length = 64 \
+	bundle = gmem1_4 port = buf_T4
+
+#pragma HLS INTERFACE m_axi offset = slave latency = 64 \
+	num_write_outstanding = 16 num_read_outstanding = 16 \
+	max_write_burst_length = 64 max_read_burst_length = 64 \
+	bundle = gmem1_5 port = buf_T5
+
+#pragma HLS INTERFACE m_axi offset = slave latency = 64 \
+	num_write_outstanding = 16 num_read_outstanding = 16 \
+	max_write_burst_length = 64 max_read_burst_length = 64 \
+	bundle = gmem1_6 port = buf_T6
+
+#pragma HLS INTERFACE m_axi offset = slave latency = 64 \
+	num_write_outstanding = 16 num_read_outstanding = 16 \
+	max_write_burst_length = 64 max_read_burst_length = 64 \
+	bundle = gmem1_7 port = buf_T7
+
+#pragma HLS INTERFACE m_axi offset = slave latency = 64 \
+	num_write_outstanding = 16 num_read_outstanding = 16 \
+	max_write_burst_length = 64 max_read_burst_length = 64 \
+	bundle = gmem1_8 port = buf_TW
+
+#pragma HLS INTERFACE s_axilite port = col_id bundle = control
+#pragma HLS INTERFACE s_axilite port = order bundle = control
+#pragma HLS INTERFACE s_axilite port = top_k bundle = control
+#pragma HLS INTERFACE s_axilite port = buf_A bundle = control
+#pragma HLS INTERFACE s_axilite port = buf_B bundle = control
+#pragma HLS INTERFACE s_axilite port = buf_T0 bundle = control
+#pragma HLS INTERFACE s_axilite port = buf_T1 bundle = control
+#pragma HLS INTERFACE s_axilite port = buf_T2 bundle = control
+#pragma HLS INTERFACE s_axilite port = buf_T3 bundle = control
+#pragma HLS INTERFACE s_axilite port = buf_T4 bundle = control
+#pragma HLS INTERFACE s_axilite port = buf_T5 bundle = control
+#pragma HLS INTERFACE s_axilite port = buf_T6 bundle = control
+#pragma HLS INTERFACE s_axilite port = buf_T7 bundle = control
+#pragma HLS INTERFACE s_axilite port = buf_TW bundle = control
+#pragma HLS INTERFACE s_axilite port = return bundle = control
+
+    // clang-format on
+    using namespace xf::database::gqe;
+
+    bool ord = order ? true : false;
+
+    // small K, one read of the column through the registers
+    if (top_k > 0 && top_k <= SORT_TOPK_MAX) {
+        top_k_scan<BURST_LEN, VEC_LEN, SORT_TOPK_MAX>(col_id, ord, top_k, buf_A, buf_B);
+        return;
+    }
+
+    ap_uint<512> bw = buf_A[0];
+    int nrow = bw.range(31, 0);
+    int npad = (nrow + SORT_NET_LEN - 1) / SORT_NET_LEN * SORT_NET_LEN;
+    // no merged run needs more than top_k rows of each of its runs
+    int keep = top_k > 0 ? top_k : npad;
+
+    sort_runs<BURST_LEN, VEC_LEN, SORT_NET_LEN>(col_id, ord, buf_A, buf_TW);
+
+    // ping-pong between the two halves of the temporary buffer
+    const int half = npad / 8;
+    int src = 0;
+    int run_len = SORT_NET_LEN;
+    int nrun = npad / SORT_NET_LEN;
+    while (nrun > 1) {
+        int dst = half - src;
+        int ngroup = (nrun + SORT_MERGE_WAY - 1) / SORT_MERGE_WAY;
+        for (int g = 0; g < ngroup; ++g) {
+            merge_runs(ord, g, src, dst, nrun, run_len, npad, keep, buf_T0, buf_T1, buf_T2, buf_T3, buf_T4, buf_T5,
+                       buf_T6, buf_T7, buf_TW);
+        }
+#ifndef __SYNTHESIS__
+        printf("merge pass: %d runs of %d rows into %d\n", nrun, run_len, ngroup);
+#endif
+        src = dst;
+        run_len *= SORT_MERGE_WAY;
+        nrun = ngroup;
+    }
+
+    write_sorted<VEC_LEN>(src, nrow < keep ? nrow : keep, buf_T0, buf_B);
+}
@@ -155,6 +155,7 @@ void get_q5simple_cfg(ap_uint<512>* hbuf) {
     t.set_bit(1, 1);    // aggr on
     t.set_bit(2, 0);    // dura key off
     t.range(5, 3) = 0;  // hash join flag = 0 for normal, 1 for semi, 2 for anti
+    t.range(8, 7) = 0;  // join stage = 0 for build+probe, 1 for build only, 2 for probe only
 
     signed char id_a[] = {0, 1, -2, -2, -1, -1, -1, -1}; // Orders, 2col
     for (int c = 0; c < 8; ++c) {
@@ -0,0 +1,205 @@
+/*
+ * Copyright 2019 Xilinx, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "utils.hpp"
+
+#include <sys/time.h>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <vector>
+
+#include <ap_int.h>
+
+#define VEC_LEN 16
+#define SORT_NET_LEN 16
+
+#ifdef HLS_TEST
+extern "C" void gqeSort(const int col_id,
+                        const int order,
+                        const int top_k,
+                        ap_uint<512> buf_A[],
+                        ap_uint<512> buf_B[],
+                        ap_uint<512> buf_T0[],
+                        ap_uint<512> buf_T1[],
+                        ap_uint<512> buf_T2[],
+                        ap_uint<512> buf_T3[],
+                        ap_uint<512> buf_T4[],
+                        ap_uint<512> buf_T5[],
+                        ap_uint<512> buf_T6[],
+                        ap_uint<512> buf_T7[],
+                        ap_uint<512> buf_TW[]);
+#else
+#include <CL/cl_ext_xilinx.h>
+#include <xcl2.hpp>
+
+#define XCL_BANK(n) (((unsigned int)(n)) | XCL_MEM_TOPOLOGY)
+#endif
+
+ap_uint<512> get_table_header(int n512b, int nrow) {
+    ap_uint<512> th = 0;
+    th.range(31, 0) = nrow;
+    th.range(63, 32) = n512b;
+    return th;
+}
+
+// checks the keys against std::sort and that every row id points to its key
+int check_sorted(const std::vector<int>& keys, int order, int top_k, ap_uint<512>* table_out, int out_depth) {
+    std::vector<int> golden = keys;
+    if (order)
+        std::sort(golden.begin(), golden.end());
+    else
+        std::sort(golden.begin(), golden.end(), std::greater<int>());
+    int n_exp = (top_k > 0 && top_k < (int)keys.size()) ? top_k : (int)keys.size();
+
+    int n_out = table_out[0].range(31, 0);
+    if (n_out != n_exp) {
+        std::cout << "ERROR: " << n_out << " rows returned, " << n_exp << " expected.\n";
+        return 1;
+    }
+    std::vector<bool> seen(keys.size(), false);
+    for (int i = 0; i < n_out; i++) {
+        int key = (int)table_out[1 + i / VEC_LEN].range(32 * (i % VEC_LEN) + 31, 32 * (i % VEC_LEN));
+        int rid = (int)table_out[out_depth + 1 + i / VEC_LEN].range(32 * (i % VEC_LEN) + 31, 32 * (i % VEC_LEN));
+        if (key != golden[i] || rid < 0 || rid >= (int)keys.size() || keys[rid] != key || seen[rid]) {
+            std::cout << "ERROR: row " << i << " has key " << key << " and row id " << rid << ", expected key "
+                      << golden[i] << ".\n";
+            return 1;
+        }
+        seen[rid] = true;
+    }
+    return 0;
+}
+
+int main(int argc, const char* argv[]) {
+    std::cout << "\n------------ GQE Sort Test -------------\n";
+
+    // cmd arg parser.
+    ArgParser parser(argc, argv);
+
+#ifndef HLS_TEST
+    std::string xclbin_path; // eg. q5kernel_VCU1525_hw.xclbin
+    if (!parser.getCmdOption("-xclbin", xclbin_path)) {
+        std::cout << "ERROR: xclbin path is not set!\n";
+        return 1;
+    }
+#endif
+
+    int nrow = 20000;
+    std::string num_str;
+    if (parser.getCmdOption("-rows", num_str)) {
+        try {
+            nrow = std::stoi(num_str);
+        } catch (...) {
+            nrow = 20000;
+        }
+    }
+
+    std::vector<int> keys(nrow);
+    srand(7);
+    for (int i = 0; i < nrow; i++) keys[i] = (rand() % 200000) - 100000;
+
+    const size_t col_depth = size_t((sizeof(int) * (nrow + VEC_LEN * 2 - 1) + 64 - 1) / 64);
+    const size_t table_size = (col_depth + 1) * 2;
+    ap_uint<512>* table_in = aligned_alloc<ap_uint<512> >(table_size);
+    ap_uint<512>* table_out = aligned_alloc<ap_uint<512> >(table_size);
+    memset(table_in, 0, sizeof(ap_uint<512>) * table_size);
+    table_in[0] = get_table_header(col_depth, nrow);
+    memcpy(table_in + 1, keys.data(), sizeof(int) * nrow);
+
+    // two halves of the padded rows, 8 bytes each
+    const size_t npad = (nrow + SORT_NET_LEN - 1) / SORT_NET_LEN * SORT_NET_LEN;
+    const size_t tmp_size = npad / 4 + 1;
+    ap_uint<512>* table_tmp = aligned_alloc<ap_uint<512> >(tmp_size);
+
+    // full ascending sort, Top-K kept on chip, Top-K through the merges
+    const int n_case = 3;
+    const int orders[n_case] = {1, 0, 1};
+    const int top_ks[n_case] = {0, 100, 1000};
+
+#ifndef HLS_TEST
+    // Get CL devices.
+    std::vector<cl::Device> devices = xcl::get_xil_devices();
+    cl::Device device = devices[0];
+
+    // Create context and command queue for selected device
+    cl::Context context(device);
+    cl::CommandQueue q(context, device, CL_QUEUE_PROFILING_ENABLE | CL_QUEUE_OUT_OF_ORDER_EXEC_MODE_ENABLE);
+    std::string devName = device.getInfo<CL_DEVICE_NAME>();
+    std::cout << "Selected Device " << devName << "\n";
+
+    cl::Program::Binaries xclBins = xcl::import_binary_file(xclbin_path);
+    devices.resize(1);
+    cl::Program program(context, devices, xclBins);
+    cl::Kernel kernel(program, "gqeSort");
+    std::cout << "Kernel has been created\n";
+
+    cl_mem_ext_ptr_t mext_in = {XCL_BANK(33), table_in, 0};
+    cl_mem_ext_ptr_t mext_out = {XCL_BANK(32), table_out, 0};
+    cl_mem_ext_ptr_t mext_tmp = {XCL_BANK(32), table_tmp, 0};
+    cl::Buffer buf_in(context, CL_MEM_EXT_PTR_XILINX | CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY,
+                      (size_t)(sizeof(ap_uint<512>) * table_size), &mext_in);
+    cl::Buffer buf_out(context, CL_MEM_EXT_PTR_XILINX | CL_MEM_USE_HOST_PTR | CL_MEM_READ_WRITE,
+                       (size_t)(sizeof(ap_uint<512>) * table_size), &mext_out);
+    cl::Buffer buf_tmp(context, CL_MEM_EXT_PTR_XILINX | CL_MEM_USE_HOST_PTR | CL_MEM_READ_WRITE,
+                       (size_t)(sizeof(ap_uint<512>) * tmp_size), &mext_tmp);
+    std::cout << "DDR buffers have been mapped/copy-and-mapped\n";
+#endif
+
+    int nerror = 0;
+    for (int c = 0; c < n_case; c++) {
+        memset(table_out, 0, sizeof(ap_uint<512>) * table_size);
+        table_out[0] = get_table_header(col_depth, 0);
+
+        struct timeval tv0, tv1;
+        gettimeofday(&tv0, 0);
+#ifdef HLS_TEST
+        gqeSort(0, orders[c], top_ks[c], table_in, table_out, table_tmp, table_tmp, table_tmp, table_tmp, table_tmp,
+                table_tmp, table_tmp, table_tmp, table_tmp);
+#else
+        std::vector<cl::Memory> ib;
+        ib.push_back(buf_in);
+        ib.push_back(buf_out);
+        std::vector<cl::Memory> ob;
+        ob.push_back(buf_out);
+        std::vector<cl::Event> write_events(1), kernel_events(1), read_events(1);
+
+        int j = 0;
+        kernel.setArg(j++, 0);
+        kernel.setArg(j++, orders[c]);
+        kernel.setArg(j++, top_ks[c]);
+        kernel.setArg(j++, buf_in);
+        kernel.setArg(j++, buf_out);
+        for (int r = 0; r < 9; r++) kernel.setArg(j++, buf_tmp);
+
+        q.enqueueMigrateMemObjects(ib, 0, nullptr, &write_events[0]);
+        q.enqueueTask(kernel, &write_events, &kernel_events[0]);
+        q.enqueueMigrateMemObjects(ob, CL_MIGRATE_MEM_OBJECT_HOST, &kernel_events, &read_events[0]);
+        q.finish();
+#endif
+        gettimeofday(&tv1, 0);
+        std::cout << "Case " << c << ": order " << orders[c] << ", top_k " << top_ks[c] << ", " << tvdiff(&tv0, &tv1)
+                  << " us\n";
+        if (check_sorted(keys, orders[c], top_ks[c], table_out, col_depth)) nerror++;
+    }
+
+    if (nerror)
+        std::cout << nerror << " case(s) failed.\n";
+    else
+        std::cout << "All cases are checked.\nSuccessfully";
+    return nerror;
+}
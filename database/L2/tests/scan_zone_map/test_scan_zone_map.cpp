@@ -0,0 +1,191 @@
+/*
+ * Copyright 2019 Xilinx, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <iostream>
+#include <vector>
+
+#include "gqe_blocks/load_config.hpp"
+#include "gqe_blocks/scan_table.hpp"
+
+#define NROW 20000
+#define NCOL 3
+#define ZONE_ROWS (BURST_LEN * VEC_LEN)
+#define NZONE ((NROW + ZONE_ROWS - 1) / ZONE_ROWS)
+// words of one column with its header, as Table::addCol reserves them
+#define COL_SIZE ((4 * (NROW + VEC_LEN * 2 - 1) + 63) / 64)
+#define ZM_SIZE ((NZONE + 7) / 8)
+#define BUF_SIZE (COL_SIZE * NCOL + 8 + 2 * ZM_SIZE)
+
+// top-function
+void dut(ap_uint<512>* buf_in,
+         hls::stream<bool>& zone_map_on_strm,
+         hls::stream<int8_t>& cid_strm,
+         hls::stream<ap_int<64> >& scan_cfg_strm,
+         hls::stream<ap_uint<32> > out_strms[4][8],
+         hls::stream<bool> e_out_strms[4]) {
+#pragma HLS INTERFACE m_axi depth = BUF_SIZE port = buf_in
+    xf::database::gqe::scan_zone_map_wrapper<8, 4>(buf_in, zone_map_on_strm, cid_strm, scan_cfg_strm, out_strms,
+                                                   e_out_strms);
+}
+
+#ifndef __SYNTHESIS__
+
+// yyyymmdd of day d after 1992-01-01, in 12 months of 30 days, so rows are clustered by date
+int row_date(int r) {
+    int d = r * 2400 / NROW;
+    return (1992 + d / 360) * 10000 + (1 + d % 360 / 30) * 100 + 1 + d % 30;
+}
+
+// columns date, row id and row id * 3, then the zone maps of date and row id
+void gen_table(ap_uint<512>* buf) {
+    memset((void*)buf, 0, sizeof(ap_uint<512>) * BUF_SIZE);
+    int zm_off[NCOL] = {COL_SIZE * NCOL + 8, COL_SIZE * NCOL + 8 + ZM_SIZE, 0};
+    for (int c = 0; c < NCOL; c++) {
+        ap_uint<512> h = 0;
+        h.range(31, 0) = NROW;
+        h.range(63, 32) = COL_SIZE - 1;
+        h.range(127, 96) = zm_off[c];
+        buf[COL_SIZE * c] = h;
+    }
+    for (int r = 0; r < NROW; r++) {
+        int v[NCOL] = {row_date(r), r, r * 3};
+        for (int c = 0; c < NCOL; c++) buf[COL_SIZE * c + 1 + r / 16].range(32 * (r % 16) + 31, 32 * (r % 16)) = v[c];
+    }
+    for (int c = 0; c < 2; c++) {
+        for (int z = 0; z < NZONE; z++) {
+            int zmin = 0, zmax = 0;
+            for (int r = z * ZONE_ROWS; r < NROW && r < (z + 1) * ZONE_ROWS; r++) {
+                int v = c == 0 ? row_date(r) : r;
+                if (r == z * ZONE_ROWS || v < zmin) zmin = v;
+                if (r == z * ZONE_ROWS || v > zmax) zmax = v;
+            }
+            buf[zm_off[c] + z / 8].range(64 * (z % 8) + 31, 64 * (z % 8)) = zmin;
+            buf[zm_off[c] + z / 8].range(64 * (z % 8) + 63, 64 * (z % 8) + 32) = zmax;
+        }
+    }
+}
+
+// scans with lo[k] <= column col[k] <= hi[k], checks the rows read and the rows in range
+int check_scan(ap_uint<512>* buf, int npred, const int* col, const int* lo, const int* hi) {
+    // gqeAggr command, output columns 0, 1 and 2 with the zone-map scan on
+    ap_uint<32> config[128];
+    for (int i = 0; i < 128; i++) config[i] = 0;
+    config[0] = 0xff020100;
+    config[1] = 0xffffffff;
+    config[83] = 1;
+    config[84] = 0xffffffff;
+    for (int k = 0; k < npred; k++) {
+        config[84].range(8 * k + 7, 8 * k) = col[k];
+        config[85 + 2 * k] = lo[k];
+        config[86 + 2 * k] = hi[k];
+    }
+
+    hls::stream<int8_t> cid_strm;
+    hls::stream<bool> zone_map_on_strm;
+    hls::stream<ap_int<64> > scan_cfg_strm;
+    hls::stream<ap_uint<32> > alu1_cfg_strm, alu2_cfg_strm, filter_cfg_strm;
+    hls::stream<ap_uint<64> > shuffle1_cfg_strm[4], shuffle2_cfg_strm[4], shuffle3_cfg_strm[4], shuffle4_cfg_strm[4];
+    hls::stream<ap_uint<32> > merge_column_cfg_strm, group_aggr_cfg_strm, write_out_cfg_strm;
+    hls::stream<bool> direct_aggr_cfg_strm;
+    xf::database::gqe::load_config<4, 8>(config, cid_strm, zone_map_on_strm, scan_cfg_strm, alu1_cfg_strm,
+                                         alu2_cfg_strm, filter_cfg_strm, shuffle1_cfg_strm, shuffle2_cfg_strm,
+                                         shuffle3_cfg_strm, shuffle4_cfg_strm, merge_column_cfg_strm,
+                                         group_aggr_cfg_strm, direct_aggr_cfg_strm, write_out_cfg_strm);
+
+    hls::stream<ap_uint<32> > out_strms[4][8];
+    hls::stream<bool> e_out_strms[4];
+    dut(buf, zone_map_on_strm, cid_strm, scan_cfg_strm, out_strms, e_out_strms);
+
+    // rows of the zones that may match, and rows in range
+    std::vector<bool> ref_read(NROW, false);
+    int ref_nread = 0, ref_nmatch = 0;
+    for (int r = 0; r < NROW; r++) {
+        bool in_range = true;
+        for (int k = 0; k < npred; k++) {
+            int v = col[k] == 0 ? row_date(r) : r;
+            in_range &= (v >= lo[k] && v <= hi[k]);
+        }
+        if (in_range) {
+            ref_nmatch++;
+            int z = r / ZONE_ROWS;
+            for (int i = z * ZONE_ROWS; i < NROW && i < (z + 1) * ZONE_ROWS; i++) ref_read[i] = true;
+        }
+    }
+    for (int r = 0; r < NROW; r++) ref_nread += ref_read[r];
+
+    int nerror = 0, nread = 0, nmatch = 0;
+    std::vector<bool> got(NROW, false);
+    for (int ch = 0; ch < 4; ch++) {
+        while (!e_out_strms[ch].read()) {
+            int v[8];
+            for (int c = 0; c < 8; c++) v[c] = out_strms[ch][c].read();
+            int r = v[1];
+            nread++;
+            if (r < 0 || r >= NROW || got[r] || !ref_read[r] || v[0] != row_date(r) || v[2] != r * 3 ||
+                v[3] != 0) {
+                if (nerror < 10)
+                    std::cout << "ERROR: unexpected row " << v[0] << " " << v[1] << " " << v[2] << " " << v[3]
+                              << std::endl;
+                nerror++;
+                continue;
+            }
+            got[r] = true;
+            bool in_range = true;
+            for (int k = 0; k < npred; k++) in_range &= (v[col[k]] >= lo[k] && v[col[k]] <= hi[k]);
+            nmatch += in_range;
+        }
+    }
+    if (nread != ref_nread) {
+        std::cout << "ERROR: " << nread << " rows sent to the splitter, " << ref_nread << " expected." << std::endl;
+        nerror++;
+    }
+    if (nmatch != ref_nmatch) {
+        std::cout << "ERROR: " << nmatch << " rows in range after pruning, " << ref_nmatch << " expected."
+                  << std::endl;
+        nerror++;
+    }
+    std::cout << std::dec << "Scanned " << nread << " of " << NROW << " rows, " << nmatch << " rows in range." << std::endl;
+    return nerror;
+}
+
+int main() {
+    ap_uint<512>* buf = (ap_uint<512>*)malloc(sizeof(ap_uint<512>) * BUF_SIZE);
+    gen_table(buf);
+
+    int nerror = 0;
+    // one year of dates
+    int col0[1] = {0}, lo0[1] = {19940101}, hi0[1] = {19941230};
+    nerror += check_scan(buf, 1, col0, lo0, hi0);
+    // one quarter of dates and a row-id range cutting it
+    int col1[2] = {0, 1}, lo1[2] = {19950401, 0}, hi1[2] = {19950630, 10200};
+    nerror += check_scan(buf, 2, col1, lo1, hi1);
+    // dates out of the table
+    int col2[1] = {0}, lo2[1] = {19800101}, hi2[1] = {19801230};
+    nerror += check_scan(buf, 1, col2, lo2, hi2);
+
+    free(buf);
+
+    if (nerror) {
+        std::cout << "\nFAIL: " << nerror << " errors found.\n";
+    } else {
+        std::cout << "\nPASS: no error found.\n";
+    }
+    return nerror;
+}
+
+#endif
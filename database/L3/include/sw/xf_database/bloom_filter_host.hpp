@@ -0,0 +1,148 @@
+/*
+ * Copyright 2019 Xilinx, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef XF_DATABASE_BLOOM_FILTER_HOST_H
+#define XF_DATABASE_BLOOM_FILTER_HOST_H
+
+#include <stdint.h>
+#include <cstddef>
+
+namespace xf {
+namespace database {
+namespace details {
+
+inline uint32_t bfRot(uint32_t x, int k) {
+    return (x << k) | (x >> (32 - k));
+}
+
+// 64-bit lookup3 of a key of W bits, same as hashLookup3 in L1.
+template <int W>
+inline uint64_t bfHostHash(uint64_t key) {
+    uint32_t a, b, c;
+    a = b = c = 0xdeadbeef + (W / 8) + 1032032634u;
+    c += 2818135537u;
+    a += (uint32_t)key;
+    if (W == 64) b += (uint32_t)(key >> 32);
+
+    c ^= b;
+    c -= bfRot(b, 14);
+    a ^= c;
+    a -= bfRot(c, 11);
+    b ^= a;
+    b -= bfRot(a, 25);
+    c ^= b;
+    c -= bfRot(b, 16);
+    a ^= c;
+    a -= bfRot(c, 4);
+    b ^= a;
+    b -= bfRot(a, 14);
+    c ^= b;
+    c -= bfRot(b, 24);
+    return ((uint64_t)c << 32) | b;
+}
+
+// the three bit positions of a hash, as bv_update_bram splits it.
+template <int BV_W>
+inline void bfHostPos(uint64_t h, uint32_t& pl, uint32_t& ph, uint32_t& pa) {
+    // built in 64 bits, as BV_W may be 32
+    const uint32_t mask = (uint32_t)(((uint64_t)1 << BV_W) - 1);
+    pl = (uint32_t)h & mask;
+    ph = (uint32_t)(h >> 32) & mask;
+    pa = (pl + ph) & mask;
+}
+
+} // namespace details
+
+/**
+ * @brief Number of 16-bit words in each of the three vectors of a Bloom filter.
+ *
+ * @tparam BV_W width of the hash value, as in ``bfGen``.
+ */
+template <int BV_W>
+inline size_t bfHostVecSize() {
+    return (size_t)1 << (BV_W - 4);
+}
+
+/**
+ * @brief Adds keys to a Bloom filter on host.
+ *
+ * The filter is the same as ``bfGen`` builds in BRAM mode: one lookup3 hash per key
+ * marks one bit in each of the three vectors of 16-bit words, so the vectors can be
+ * loaded to the card and checked again by ``bfCheck``. Bits are only set, thus the
+ * vectors must be zeroed before the first call, and later calls add more keys.
+ *
+ * @tparam W width of key, 32 or 64.
+ * @tparam BV_W width of the hash value, each vector holds 2^BV_W bits.
+ * @tparam T type of key.
+ *
+ * @param keys keys to add.
+ * @param n number of keys.
+ * @param bv0 bit vector 0, bfHostVecSize words.
+ * @param bv1 bit vector 1, bfHostVecSize words.
+ * @param bv2 bit vector 2, bfHostVecSize words.
+ */
+template <int W, int BV_W, typename T>
+inline void bfHostGen(const T* keys, size_t n, uint16_t* bv0, uint16_t* bv1, uint16_t* bv2) {
+    static_assert(W == 32 || W == 64, "bfHostGen supports 32-bit or 64-bit keys");
+    static_assert(BV_W > 4 && BV_W <= 32, "hash value of bfHostGen is 5 to 32 bits");
+    for (size_t i = 0; i < n; ++i) {
+        uint32_t pl, ph, pa;
+        details::bfHostPos<BV_W>(details::bfHostHash<W>((uint64_t)keys[i]), pl, ph, pa);
+        bv0[pl >> 4] |= (uint16_t)(1u << (pl & 15));
+        bv1[ph >> 4] |= (uint16_t)(1u << (ph & 15));
+        bv2[pa >> 4] |= (uint16_t)(1u << (pa & 15));
+    }
+}
+
+/**
+ * @brief Checks keys against a Bloom filter on host.
+ *
+ * Gives the same result as ``bfCheck`` in BRAM mode with the same vectors. Keys are
+ * hashed in blocks, so that the compiler can vectorize the hash over the block.
+ *
+ * @tparam W width of key, 32 or 64.
+ * @tparam BV_W width of the hash value, each vector holds 2^BV_W bits.
+ * @tparam T type of key.
+ *
+ * @param keys keys to check.
+ * @param n number of keys.
+ * @param bv0 bit vector 0.
+ * @param bv1 bit vector 1.
+ * @param bv2 bit vector 2.
+ * @param hit set to 1 when the key may be in the filter, 0 when it is not.
+ */
+template <int W, int BV_W, typename T>
+inline void bfHostCheck(
+    const T* keys, size_t n, const uint16_t* bv0, const uint16_t* bv1, const uint16_t* bv2, uint8_t* hit) {
+    static_assert(W == 32 || W == 64, "bfHostCheck supports 32-bit or 64-bit keys");
+    static_assert(BV_W > 4 && BV_W <= 32, "hash value of bfHostCheck is 5 to 32 bits");
+    const size_t blk = 16;
+    uint64_t h[blk];
+    for (size_t i = 0; i < n; i += blk) {
+        const size_t m = (n - i < blk) ? n - i : blk;
+        for (size_t j = 0; j < m; ++j) h[j] = details::bfHostHash<W>((uint64_t)keys[i + j]);
+        for (size_t j = 0; j < m; ++j) {
+            uint32_t pl, ph, pa;
+            details::bfHostPos<BV_W>(h[j], pl, ph, pa);
+            hit[i + j] = ((bv0[pl >> 4] >> (pl & 15)) & (bv1[ph >> 4] >> (ph & 15)) & (bv2[pa >> 4] >> (pa & 15))) & 1;
+        }
+    }
+}
+
+} // namespace database
+} // namespace xf
+
+#endif // XF_DATABASE_BLOOM_FILTER_HOST_H
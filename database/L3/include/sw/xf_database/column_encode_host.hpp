@@ -0,0 +1,168 @@
+/*
+ * Copyright 2019 Xilinx, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef XF_DATABASE_COLUMN_ENCODE_HOST_H
+#define XF_DATABASE_COLUMN_ENCODE_HOST_H
+
+#include <ap_int.h>
+#include <stdint.h>
+#include <cstddef>
+#include <vector>
+
+#include "xf_database/enums.hpp"
+
+namespace xf {
+namespace database {
+namespace details {
+
+// number of bits to hold v, at least 1.
+inline int bitWidthOf(uint32_t v) {
+    int b = 1;
+    while (b < 32 && (v >> b) != 0) b++;
+    return b;
+}
+
+// base and bit width of a packed encoding, returns false if the column cannot be encoded so.
+inline bool packedParam(const int32_t* col, size_t nrow, ColEncoding enc, int32_t& base, int& bw) {
+    int32_t vmin = nrow ? col[0] : 0, vmax = vmin;
+    for (size_t i = 1; i < nrow; i++) {
+        if (col[i] < vmin) vmin = col[i];
+        if (col[i] > vmax) vmax = col[i];
+    }
+    if (enc == CE_PLAIN) {
+        base = 0;
+        bw = 32;
+    } else if (enc == CE_BITPACK) {
+        if (vmin < 0) return false;
+        base = 0;
+        bw = bitWidthOf((uint32_t)vmax);
+    } else if (enc == CE_FOR) {
+        base = vmin;
+        bw = bitWidthOf((uint32_t)((int64_t)vmax - vmin));
+    } else {
+        return false;
+    }
+    return true;
+}
+
+} // namespace details
+
+/**
+ * @brief Number of 512-bit words of a column encoded for scanEncodedCol, header included.
+ *
+ * @param col the 32-bit column.
+ * @param nrow number of rows.
+ * @param enc encoding to use.
+ * @return number of words, 0 if the column cannot be encoded with enc.
+ */
+inline size_t encodedColSize(const int32_t* col, size_t nrow, ColEncoding enc) {
+    if (enc == CE_RLE) {
+        size_t nrun = 0;
+        for (size_t i = 0; i < nrow; i++) {
+            if (i == 0 || col[i] != col[i - 1]) nrun++;
+        }
+        return 1 + (nrun + 7) / 8;
+    }
+    int32_t base;
+    int bw;
+    if (!details::packedParam(col, nrow, enc, base, bw)) return 0;
+    const size_t per_word = 512 / bw;
+    return 1 + (nrow + per_word - 1) / per_word;
+}
+
+/**
+ * @brief Picks the encoding that gives the fewest words for a column.
+ *
+ * @param col the 32-bit column.
+ * @param nrow number of rows.
+ * @return the smallest encoding, CE_PLAIN when nothing is smaller.
+ */
+inline ColEncoding pickColEncoding(const int32_t* col, size_t nrow) {
+    ColEncoding best = CE_PLAIN;
+    size_t best_size = encodedColSize(col, nrow, CE_PLAIN);
+    const ColEncoding cand[3] = {CE_BITPACK, CE_FOR, CE_RLE};
+    for (int i = 0; i < 3; i++) {
+        size_t s = encodedColSize(col, nrow, cand[i]);
+        if (s > 0 && s < best_size) {
+            best = cand[i];
+            best_size = s;
+        }
+    }
+    return best;
+}
+
+/**
+ * @brief Encodes a 32-bit column for scanEncodedCol.
+ *
+ * The output is only read by scanEncodedCol; the GQE Table does not store encoded columns.
+ *
+ * The first word is the header, with the number of rows in bits 31:0, the encoding
+ * in bits 39:32, the bit width in bits 47:40, the frame-of-reference base in bits 95:64
+ * and the number of encoded words in bits 127:96.
+ *
+ * @param col the 32-bit column.
+ * @param nrow number of rows.
+ * @param enc encoding to use.
+ * @param out encoded words, header first, left empty if the column cannot be encoded with enc.
+ * @return 0 on success, -1 otherwise.
+ */
+inline int encodeCol(const int32_t* col, size_t nrow, ColEncoding enc, std::vector<ap_uint<512> >& out) {
+    out.clear();
+    size_t nword = encodedColSize(col, nrow, enc);
+    if (nword == 0) return -1;
+    out.resize(nword, ap_uint<512>(0));
+
+    ap_uint<512> hd = 0;
+    hd.range(31, 0) = (uint32_t)nrow;
+    hd.range(39, 32) = (uint32_t)enc;
+    hd.range(127, 96) = (uint32_t)(nword - 1);
+
+    if (enc == CE_RLE) {
+        size_t r = 0;
+        for (size_t i = 0; i < nrow;) {
+            size_t j = i + 1;
+            while (j < nrow && col[j] == col[i]) j++;
+            ap_uint<512>& w = out[1 + r / 8];
+            int s = r % 8;
+            w.range(64 * s + 31, 64 * s) = (uint32_t)col[i];
+            w.range(64 * s + 63, 64 * s + 32) = (uint32_t)(j - i);
+            r++;
+            i = j;
+        }
+    } else {
+        int32_t base;
+        int bw;
+        if (!details::packedParam(col, nrow, enc, base, bw)) {
+            out.clear();
+            return -1;
+        }
+        hd.range(47, 40) = (uint32_t)bw;
+        hd.range(95, 64) = (uint32_t)base;
+        const size_t per_word = 512 / bw;
+        for (size_t i = 0; i < nrow; i++) {
+            uint32_t u = (uint32_t)((int64_t)col[i] - base);
+            int s = i % per_word;
+            out[1 + i / per_word].range(bw * s + bw - 1, bw * s) = u;
+        }
+    }
+    out[0] = hd;
+    return 0;
+}
+
+} // namespace database
+} // namespace xf
+
+#endif // XF_DATABASE_COLUMN_ENCODE_HOST_H
@@ -0,0 +1,87 @@
+/*
+ * Copyright 2019 Xilinx, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef XF_DATABASE_HYPER_LOG_LOG_HOST_H
+#define XF_DATABASE_HYPER_LOG_LOG_HOST_H
+
+#include <stdint.h>
+#include <cmath>
+#include <cstddef>
+
+namespace xf {
+namespace database {
+
+/**
+ * @brief Merges HyperLogLog sketch b into sketch a.
+ *
+ * Both sketches hold 2^p one-byte registers, as emitted for one group by the
+ * ``hyperLogLog`` primitive. The merged sketch is the sketch of the union of both
+ * inputs, so partial sketches can be merged in any order.
+ *
+ * @param a sketch to merge into.
+ * @param b sketch to merge from.
+ * @param p log2 of the number of registers.
+ */
+inline void hllMerge(uint8_t* a, const uint8_t* b, int p) {
+    const size_t m = (size_t)1 << p;
+    for (size_t i = 0; i < m; ++i) {
+        if (b[i] > a[i]) a[i] = b[i];
+    }
+}
+
+/**
+ * @brief Estimates the number of distinct keys from a HyperLogLog sketch.
+ *
+ * Uses linear counting while some registers are still empty and the raw estimate
+ * is small, and corrects the large range for the 32-bit hash.
+ *
+ * @param regs sketch of 2^p one-byte registers.
+ * @param p log2 of the number of registers.
+ * @return estimated number of distinct keys.
+ */
+inline double hllEstimate(const uint8_t* regs, int p) {
+    const size_t m = (size_t)1 << p;
+    double alpha;
+    if (m == 16)
+        alpha = 0.673;
+    else if (m == 32)
+        alpha = 0.697;
+    else if (m == 64)
+        alpha = 0.709;
+    else
+        alpha = 0.7213 / (1.0 + 1.079 / m);
+
+    double sum = 0;
+    size_t nzero = 0;
+    for (size_t i = 0; i < m; ++i) {
+        sum += std::ldexp(1.0, -(int)regs[i]);
+        if (regs[i] == 0) nzero++;
+    }
+    double e = alpha * m * m / sum;
+
+    const double two32 = 4294967296.0;
+    if (e <= 2.5 * m) {
+        if (nzero) e = m * std::log((double)m / nzero);
+    } else if (e > two32 / 30) {
+        e = -two32 * std::log(1.0 - e / two32);
+    }
+    return e;
+}
+
+} // namespace database
+} // namespace xf
+
+#endif // XF_DATABASE_HYPER_LOG_LOG_HOST_H
@@ -0,0 +1,113 @@
+/*
+ * Copyright 2019 Xilinx, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "table_dt.hpp"
+#include "utils.hpp"
+#include "gqe_blocks/gqe_types.hpp"
+using namespace xf::database::gqe;
+#include "gqe_api.hpp"
+#include <iostream>
+
+#define BV_W 20
+
+// the threaded pre-filter keeps the same rows, in the same order, as one pass over tin
+int check(Table& tin, int key_col, const uint16_t* bv0, const uint16_t* bv1, const uint16_t* bv2, int nthread) {
+    const size_t nrow = tin.getNumRow();
+    Table tout("tout", nrow, tin.ncol, "");
+    for (size_t c = 0; c < tin.ncol; c++) tout.addCol("c" + std::to_string(c), col_width(tin, c));
+    tout.allocateHost();
+    int64_t nkeep = bloom_prefilter_table<BV_W>(tin, key_col, bv0, bv1, bv2, tout, nthread);
+
+    int nerr = 0;
+    size_t k = 0;
+    for (size_t r = 0; r < nrow; r++) {
+        uint8_t hit;
+        if (col_width(tin, key_col) == 4)
+            xf::database::bfHostCheck<32, BV_W>(tin.getColPtr<int32_t>(key_col) + r, 1, bv0, bv1, bv2, &hit);
+        else
+            xf::database::bfHostCheck<64, BV_W>(tin.getColPtr<int64_t>(key_col) + r, 1, bv0, bv1, bv2, &hit);
+        if (!hit) continue;
+        for (size_t c = 0; c < tin.ncol; c++) {
+            size_t w = col_width(tin, c);
+            if ((int64_t)k < nkeep && memcmp(tin.getColPtr<char>(c) + w * r, tout.getColPtr<char>(c) + w * k, w))
+                nerr++;
+        }
+        k++;
+    }
+    if ((int64_t)k != nkeep || tout.getNumRow() != nkeep) {
+        std::cout << "ERROR: " << nkeep << " rows kept, " << k << " expected" << std::endl;
+        nerr++;
+    }
+    if (nerr) std::cout << "ERROR: " << nerr << " values differ from the serial filter" << std::endl;
+    return nerr;
+}
+
+int main(int argc, const char* argv[]) {
+    const int nbuild = 5000;
+    const int nprobe = 40000;
+    int nerr = 0;
+
+    // build side keys are even, half of the probe keys are in it
+    std::vector<int32_t> bkey32(nbuild);
+    std::vector<int64_t> bkey64(nbuild);
+    for (int i = 0; i < nbuild; i++) {
+        bkey32[i] = 2 * i;
+        bkey64[i] = ((int64_t)i << 33) | 2;
+    }
+    const size_t nvec = xf::database::bfHostVecSize<BV_W>();
+    std::vector<uint16_t> bv32[3], bv64[3];
+    for (int i = 0; i < 3; i++) {
+        bv32[i].assign(nvec, 0);
+        bv64[i].assign(nvec, 0);
+    }
+    xf::database::bfHostGen<32, BV_W>(bkey32.data(), nbuild, bv32[0].data(), bv32[1].data(), bv32[2].data());
+    xf::database::bfHostGen<64, BV_W>(bkey64.data(), nbuild, bv64[0].data(), bv64[1].data(), bv64[2].data());
+
+    // a 4-byte key, an 8-byte key, a 4-byte payload and a 12-byte string column
+    Table tin("tin", nprobe, 4, "");
+    tin.addCol("k32", 4);
+    tin.addCol("k64", 8);
+    tin.addCol("v", 4);
+    tin.addCol("s", 12);
+    tin.allocateHost();
+    for (int r = 0; r < nprobe; r++) {
+        int i = r % (2 * nbuild);
+        tin.getColPtr<int32_t>(0)[r] = i;
+        tin.getColPtr<int64_t>(1)[r] = ((int64_t)(i / 2) << 33) | (i & 1 ? 3 : 2);
+        tin.getColPtr<int32_t>(2)[r] = r;
+        snprintf(tin.getColPtr<char>(3) + 12 * r, 12, "row%07d", r);
+    }
+
+    for (int nthread = 1; nthread <= 4; nthread += 3) {
+        nerr += check(tin, 0, bv32[0].data(), bv32[1].data(), bv32[2].data(), nthread);
+        nerr += check(tin, 1, bv64[0].data(), bv64[1].data(), bv64[2].data(), nthread);
+    }
+
+    // a 12-byte key column is rejected
+    Table tout("tout", nprobe, 4, "");
+    for (int c = 0; c < 4; c++) tout.addCol("c" + std::to_string(c), col_width(tin, c));
+    tout.allocateHost();
+    if (bloom_prefilter_table<BV_W>(tin, 3, bv32[0].data(), bv32[1].data(), bv32[2].data(), tout, 2) != -1) {
+        std::cout << "ERROR: a 12-byte key column is accepted" << std::endl;
+        nerr++;
+    }
+
+    if (nerr)
+        std::cout << "\nTEST FAILED!" << std::endl;
+    else
+        std::cout << "\nTEST PASS!" << std::endl;
+    return nerr;
+}